@@ -20,6 +20,8 @@
  ******************************************************************************************************/
 #include "AnimatedTile.hpp"
 
+#include "Hash.hpp"
+
 AnimatedTile::AnimatedTile(const std::string& _name, int32_t _delay, Type _type, int32_t _times)
     : name(_name), delay(_delay), type(_type), times(_times)
 {
@@ -75,3 +77,12 @@ int32_t AnimatedTile::GetCurrentFrame(int clock) const
 
     return frames[frame];
 }
+
+uint64_t AnimatedTile::ContentHash() const
+{
+    uint64_t hash = HashString(0, name);
+    hash = HashCombine(hash, delay);
+    hash = HashCombine(hash, type);
+    hash = HashCombine(hash, times);
+    return XXHash64(frames.data(), frames.size() * sizeof(int32_t), HashCombine(hash, frames.size()));
+}
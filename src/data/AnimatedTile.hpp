@@ -83,6 +83,10 @@ public:
       * @param global_clock the current timestep.
       */
     int32_t GetCurrentFrame(int global_clock) const;
+    /** Hashes the properties and frames of this animated tile.
+      * @return 64 bit hash of the animated tile.
+      */
+    uint64_t ContentHash() const;
 
     const std::string& GetName() const { return name; }
     int32_t GetDelay() const { return delay; }
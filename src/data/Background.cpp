@@ -20,6 +20,8 @@
  ******************************************************************************************************/
 #include "Background.hpp"
 
+#include "Hash.hpp"
+
 Background::Background(const std::string& _name, const std::string& _filename, uint32_t _mode, float x, float y,
                        const DrawAttributes& attr)
     : DrawAttributes(attr), name(_name), filename(_filename), mode(_mode), speed_x(x), speed_y(y)
@@ -37,3 +39,12 @@ void Background::SetSpeed(float x, float y)
     speed_x = x;
     speed_y = y;
 }
+
+uint64_t Background::ContentHash() const
+{
+    uint64_t hash = HashString(DrawAttributes::ContentHash(), name);
+    hash = HashString(hash, filename);
+    hash = HashCombine(hash, mode);
+    hash = HashFloat(hash, speed_x);
+    return HashFloat(hash, speed_y);
+}
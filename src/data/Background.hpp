@@ -79,6 +79,11 @@ public:
     void SetMode(uint32_t _mode) { mode = _mode; }
     void SetSpeed(float x, float y);
 
+    /** Hashes the properties and draw attributes of this background.
+      * @return 64 bit hash of the background.
+      */
+    uint64_t ContentHash() const;
+
 private:
     /** The name of the Background */
     std::string name;
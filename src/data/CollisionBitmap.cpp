@@ -0,0 +1,333 @@
+/******************************************************************************************************
+ * Tile Map Editor
+ * Copyright (C) 2009-2017 Brandon Whitehead (tricksterguy87[AT]gmail[DOT]com)
+ *
+ * This software is provided 'as-is', without any express or implied warranty.
+ * In no event will the authors be held liable for any damages arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * excluding commercial applications, and to alter it and redistribute it freely,
+ * subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented;
+ *    you must not claim that you wrote the original software.
+ *    An acknowledgement in your documentation and link to the original version is required.
+ *
+ * 2. Altered source versions must be plainly marked as such,
+ *    and must not be misrepresented as being the original software.
+ *
+ * 3. This notice may not be removed or altered from any source distribution.
+ ******************************************************************************************************/
+#include "CollisionBitmap.hpp"
+
+#include <algorithm>
+#include <utility>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define COLLISION_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace
+{
+
+#ifdef COLLISION_SSE2
+bool HasSSE2()
+{
+    static const bool supported = __builtin_cpu_supports("sse2");
+    return supported;
+}
+#endif
+
+struct OrOp
+{
+    static uint64_t Apply(uint64_t dest, uint64_t src) { return dest | src; }
+#ifdef COLLISION_SSE2
+    __attribute__((target("sse2")))
+    static __m128i Apply(__m128i dest, __m128i src) { return _mm_or_si128(dest, src); }
+#endif
+};
+
+struct AndNotOp
+{
+    static uint64_t Apply(uint64_t dest, uint64_t src) { return dest & ~src; }
+#ifdef COLLISION_SSE2
+    __attribute__((target("sse2")))
+    static __m128i Apply(__m128i dest, __m128i src) { return _mm_andnot_si128(src, dest); }
+#endif
+};
+
+struct AndOp
+{
+    static uint64_t Apply(uint64_t dest, uint64_t src) { return dest & src; }
+#ifdef COLLISION_SSE2
+    __attribute__((target("sse2")))
+    static __m128i Apply(__m128i dest, __m128i src) { return _mm_and_si128(dest, src); }
+#endif
+};
+
+struct XorOp
+{
+    static uint64_t Apply(uint64_t dest, uint64_t src) { return dest ^ src; }
+#ifdef COLLISION_SSE2
+    __attribute__((target("sse2")))
+    static __m128i Apply(__m128i dest, __m128i src) { return _mm_xor_si128(dest, src); }
+#endif
+};
+
+template <typename Op>
+void RowScalar(uint64_t* dest, const uint64_t* src, uint32_t count)
+{
+    for (uint32_t i = 0; i < count; i++)
+        dest[i] = Op::Apply(dest[i], src[i]);
+}
+
+#ifdef COLLISION_SSE2
+/** Two words at a time */
+template <typename Op>
+__attribute__((target("sse2")))
+void RowSSE2(uint64_t* dest, const uint64_t* src, uint32_t count)
+{
+    uint32_t i = 0;
+    for (; i + 2 <= count; i += 2)
+    {
+        __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dest + i));
+        __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dest + i), Op::Apply(d, s));
+    }
+    RowScalar<Op>(dest + i, src + i, count - i);
+}
+#endif
+
+template <typename Op>
+void Row(uint64_t* dest, const uint64_t* src, uint32_t count)
+{
+#ifdef COLLISION_SSE2
+    if (HasSSE2())
+        return RowSSE2<Op>(dest, src, count);
+#endif
+    RowScalar<Op>(dest, src, count);
+}
+
+/** Reads the 64 bits of a row starting at bit, bits before the row or past its words read as 0 */
+inline uint64_t ReadBits(const uint64_t* row, uint32_t count, int64_t bit)
+{
+    // Arithmetic shift so negative positions land on word -1.
+    int64_t word = bit >> 6;
+    uint32_t shift = bit & 63;
+    uint64_t low = word >= 0 && word < count ? row[word] : 0;
+    if (shift == 0)
+        return low;
+    uint64_t high = word + 1 >= 0 && word + 1 < count ? row[word + 1] : 0;
+    return (low >> shift) | (high << (64 - shift));
+}
+
+/** Mask of bits [first, last) of a 64 bit word */
+inline uint64_t BitRange(uint32_t first, uint32_t last)
+{
+    uint64_t high = last >= 64 ? ~0ULL : (1ULL << last) - 1;
+    uint64_t low = (1ULL << first) - 1;
+    return high & ~low;
+}
+
+}
+
+CollisionBitmap::CollisionBitmap(const Rectangle& _bounds) : bounds(_bounds), stride(0)
+{
+    if (!bounds.IsValid())
+    {
+        bounds = Rectangle();
+        return;
+    }
+    stride = (bounds.width + 63) / 64;
+    words.assign((size_t) stride * bounds.height, 0);
+}
+
+CollisionBitmap::CollisionBitmap(const Region& region) : CollisionBitmap(region.Bounds())
+{
+    for (const auto& rectangle : region.GetData())
+        Fill(rectangle);
+}
+
+bool CollisionBitmap::operator==(const CollisionBitmap& other) const
+{
+    return bounds == other.bounds && words == other.words;
+}
+
+void CollisionBitmap::Set(int32_t x, int32_t y, bool value)
+{
+    uint32_t bx = (uint32_t) (x - bounds.x);
+    uint32_t by = (uint32_t) (y - bounds.y);
+    if (bx >= (uint32_t) bounds.width || by >= (uint32_t) bounds.height)
+        return;
+
+    uint64_t& word = words[by * stride + bx / 64];
+    uint64_t bit = 1ULL << (bx % 64);
+    word = value ? word | bit : word & ~bit;
+}
+
+void CollisionBitmap::Fill(const Rectangle& r, bool value)
+{
+    if (value)
+        FillRows(r, &Row<OrOp>);
+    else
+        FillRows(r, &Row<AndNotOp>);
+}
+
+void CollisionBitmap::Xor(const Rectangle& r)
+{
+    FillRows(r, &Row<XorOp>);
+}
+
+void CollisionBitmap::Add(const CollisionBitmap& other)
+{
+    Combine(other, &Row<OrOp>, false);
+}
+
+void CollisionBitmap::Subtract(const CollisionBitmap& other)
+{
+    Combine(other, &Row<AndNotOp>, false);
+}
+
+void CollisionBitmap::Intersect(const CollisionBitmap& other)
+{
+    Combine(other, &Row<AndOp>, true);
+}
+
+void CollisionBitmap::Xor(const CollisionBitmap& other)
+{
+    Combine(other, &Row<XorOp>, false);
+}
+
+void CollisionBitmap::Expand(const Rectangle& r)
+{
+    if (!r.IsValid())
+        return;
+
+    Rectangle covered = r;
+    if (bounds.IsValid())
+    {
+        int32_t x1 = std::min(bounds.x, r.x);
+        int32_t y1 = std::min(bounds.y, r.y);
+        int32_t x2 = std::max(bounds.x + bounds.width, r.x + r.width);
+        int32_t y2 = std::max(bounds.y + bounds.height, r.y + r.height);
+        covered = Rectangle(x1, y1, x2 - x1, y2 - y1);
+    }
+    if (covered == bounds)
+        return;
+
+    CollisionBitmap expanded(covered);
+    expanded.Add(*this);
+    *this = std::move(expanded);
+}
+
+void CollisionBitmap::Clear()
+{
+    std::fill(words.begin(), words.end(), 0);
+}
+
+int64_t CollisionBitmap::Count() const
+{
+    int64_t count = 0;
+    for (uint64_t word : words)
+        count += __builtin_popcountll(word);
+    return count;
+}
+
+Region CollisionBitmap::ToRegion() const
+{
+    std::vector<Rectangle> rectangles;
+    // Runs of the current band as [x1, x2) pairs and the runs of the row being scanned.
+    std::vector<int32_t> band, runs;
+    int32_t band_top = 0;
+
+    for (int32_t y = 0; y <= bounds.height; y++)
+    {
+        runs.clear();
+        if (y < bounds.height)
+        {
+            const uint64_t* row = GetRow(y);
+            bool inside = false;
+            for (uint32_t w = 0; w < stride; w++)
+            {
+                // Find each change between set and clear bits in the word.
+                uint64_t word = inside ? ~row[w] : row[w];
+                uint32_t bit = 0;
+                while (bit < 64 && (word >> bit) != 0)
+                {
+                    bit += __builtin_ctzll(word >> bit);
+                    runs.push_back(bounds.x + w * 64 + bit);
+                    inside = !inside;
+                    word = ~word;
+                }
+            }
+            if (inside)
+                runs.push_back(bounds.x + bounds.width);
+        }
+
+        if (runs == band)
+            continue;
+
+        for (uint32_t i = 0; i < band.size(); i += 2)
+            rectangles.push_back(Rectangle(band[i], bounds.y + band_top, band[i + 1] - band[i], y - band_top));
+        band.swap(runs);
+        band_top = y;
+    }
+
+    return Region(rectangles);
+}
+
+uint64_t CollisionBitmap::LastWordMask() const
+{
+    return BitRange(0, bounds.width - (stride - 1) * 64);
+}
+
+void CollisionBitmap::Combine(const CollisionBitmap& other, RowKernel kernel, bool zero_clears)
+{
+    if (!bounds.IsValid())
+        return;
+
+    std::vector<uint64_t> source(stride);
+    int64_t offset = (int64_t) bounds.x - other.bounds.x;
+    for (int32_t y = 0; y < bounds.height; y++)
+    {
+        int32_t other_y = y + bounds.y - other.bounds.y;
+        bool covered = other.bounds.IsValid() && other_y >= 0 && other_y < other.bounds.height;
+        if (!covered && !zero_clears)
+            continue;
+
+        // Line other's row up with this one, pixels other doesn't cover read as 0.
+        if (covered)
+        {
+            const uint64_t* other_row = other.GetRow(other_y);
+            for (uint32_t w = 0; w < stride; w++)
+                source[w] = ReadBits(other_row, other.stride, offset + w * 64);
+            source[stride - 1] &= LastWordMask();
+        }
+        else
+        {
+            std::fill(source.begin(), source.end(), 0);
+        }
+        kernel(&words[y * stride], source.data(), stride);
+    }
+}
+
+void CollisionBitmap::FillRows(const Rectangle& r, RowKernel kernel)
+{
+    Rectangle clipped;
+    if (!bounds.Intersects(r, clipped))
+        return;
+
+    // Every row gets the same mask, build it once.
+    uint32_t x1 = clipped.x - bounds.x;
+    uint32_t x2 = x1 + clipped.width;
+    uint32_t first = x1 / 64;
+    uint32_t last = (x2 - 1) / 64;
+    std::vector<uint64_t> mask(last - first + 1, ~0ULL);
+    mask.front() &= BitRange(x1 % 64, 64);
+    mask.back() &= BitRange(0, x2 - last * 64);
+
+    uint32_t top = clipped.y - bounds.y;
+    for (uint32_t y = top; y < top + clipped.height; y++)
+        kernel(&words[y * stride + first], mask.data(), mask.size());
+}
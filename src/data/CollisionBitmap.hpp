@@ -0,0 +1,143 @@
+/******************************************************************************************************
+ * Tile Map Editor
+ * Copyright (C) 2009-2017 Brandon Whitehead (tricksterguy87[AT]gmail[DOT]com)
+ *
+ * This software is provided 'as-is', without any express or implied warranty.
+ * In no event will the authors be held liable for any damages arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * excluding commercial applications, and to alter it and redistribute it freely,
+ * subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented;
+ *    you must not claim that you wrote the original software.
+ *    An acknowledgement in your documentation and link to the original version is required.
+ *
+ * 2. Altered source versions must be plainly marked as such,
+ *    and must not be misrepresented as being the original software.
+ *
+ * 3. This notice may not be removed or altered from any source distribution.
+ ******************************************************************************************************/
+#ifndef COLLISION_BITMAP_HPP
+#define COLLISION_BITMAP_HPP
+
+#include <cstdint>
+#include <vector>
+
+#include "Rectangle.hpp"
+#include "Region.hpp"
+
+/** Pixel collision stored as one bit per pixel.
+  * Covers a bounding rectangle, each row is a run of 64 bit words where bit i of word w is the pixel
+  * at x = bounds.x + w * 64 + i. Pixels outside the bounds are never set.
+  * Lookups are a single bit test and memory only depends on the bounds, not on the shape.
+  */
+class CollisionBitmap
+{
+public:
+    /** Creates an empty bitmap covering the bounds given.
+      * @param bounds Area the bitmap covers.
+      */
+    CollisionBitmap(const Rectangle& bounds = Rectangle());
+    /** Creates a bitmap covering the bounds of a region with the region's pixels set.
+      * @param region Region to rasterize.
+      */
+    CollisionBitmap(const Region& region);
+
+    bool operator==(const CollisionBitmap& other) const;
+    bool operator!=(const CollisionBitmap& other) const { return !(*this == other); }
+
+    /** Tests if the pixel (x, y) is set.
+      * @param x X coordinate.
+      * @param y Y coordinate.
+      * @return true if set, false if not or outside the bounds.
+      */
+    bool Get(int32_t x, int32_t y) const
+    {
+        uint32_t bx = (uint32_t) (x - bounds.x);
+        uint32_t by = (uint32_t) (y - bounds.y);
+        if (bx >= (uint32_t) bounds.width || by >= (uint32_t) bounds.height)
+            return false;
+        return (words[by * stride + bx / 64] >> (bx % 64)) & 1;
+    }
+    /** Sets or clears a pixel, pixels outside the bounds are ignored.
+      * @param x X coordinate.
+      * @param y Y coordinate.
+      * @param value true to set the pixel.
+      */
+    void Set(int32_t x, int32_t y, bool value);
+    /** Sets or clears every pixel in the rectangle, clipped to the bounds.
+      * @param r Rectangle to fill.
+      * @param value true to set the pixels.
+      */
+    void Fill(const Rectangle& r, bool value = true);
+    /** Flips every pixel in the rectangle, clipped to the bounds.
+      * @param r Rectangle to flip.
+      */
+    void Xor(const Rectangle& r);
+    /** Sets every pixel set in other.
+      * @param other Bitmap to add, only the part within these bounds is used.
+      */
+    void Add(const CollisionBitmap& other);
+    /** Clears every pixel set in other.
+      * @param other Bitmap to subtract.
+      */
+    void Subtract(const CollisionBitmap& other);
+    /** Clears every pixel not set in other.
+      * @param other Bitmap to intersect with.
+      */
+    void Intersect(const CollisionBitmap& other);
+    /** Flips every pixel set in other.
+      * @param other Bitmap to xor with, only the part within these bounds is used.
+      */
+    void Xor(const CollisionBitmap& other);
+
+    /** Grows the bounds to also cover the rectangle given keeping the pixels set.
+      * @param r Rectangle to cover.
+      */
+    void Expand(const Rectangle& r);
+    /** Moves the bitmap, nothing is copied.
+      * @param x Horizontal Movement.
+      * @param y Vertical Movement.
+      */
+    void Move(int32_t x, int32_t y) { bounds.Move(x, y); }
+    /** Clears every pixel keeping the bounds. */
+    void Clear();
+
+    /** Counts the pixels set.
+      * @return the number of pixels set.
+      */
+    int64_t Count() const;
+    /** Converts the bitmap to a region.
+      * Each row is split into runs of set pixels and neighbouring rows with the same runs are merged into one band.
+      * @return Region covering the pixels set.
+      */
+    Region ToRegion() const;
+
+    const Rectangle& GetBounds() const { return bounds; }
+    /** Number of words in each row */
+    uint32_t GetStride() const { return stride; }
+    const uint64_t* GetRow(uint32_t y) const { return words.data() + y * stride; }
+
+private:
+    /** Combines count words of src into dest */
+    typedef void (*RowKernel)(uint64_t* dest, const uint64_t* src, uint32_t count);
+
+    /** Applies a row kernel to every row with other's pixels lined up with these bounds.
+      * @param zero_clears true if the kernel clears pixels that are not set in other, so rows other doesn't cover are cleared too.
+      */
+    void Combine(const CollisionBitmap& other, RowKernel kernel, bool zero_clears);
+    /** Applies a row kernel to the rows the rectangle covers with the rectangle's pixels set */
+    void FillRows(const Rectangle& r, RowKernel kernel);
+    /** Mask of the bits in the last word of a row that are inside the bounds */
+    uint64_t LastWordMask() const;
+
+    /** Area the bitmap covers */
+    Rectangle bounds;
+    /** Words per row */
+    uint32_t stride;
+    /** Rows of bits */
+    std::vector<uint64_t> words;
+};
+
+#endif
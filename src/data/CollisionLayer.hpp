@@ -23,6 +23,21 @@
 
 #include <cstdint>
 
+/** Axis aligned box used by collision queries, in the units of the layer queried. */
+struct CollisionBox
+{
+    float x, y, width, height;
+};
+
+/** Where a swept box or ray first touches a collision layer. */
+struct CollisionHit
+{
+    /** Fraction of the movement done before touching, 0 if the query started overlapping */
+    float time;
+    /** Unit normal of the side hit, (0, 0) if the query started overlapping */
+    float normal_x, normal_y;
+};
+
 /**
   * This class defines a special type of layer called a collision layer.
   * This class is used internally by the Map class.
@@ -73,6 +88,48 @@ public:
       * @param copy if true then don't destroy the layer in the process if false then clear out the layer.
       */
     virtual void Resize(uint32_t width, uint32_t height, bool copy = true) = 0;
+    /** Hashes the type and collision data of this layer.
+      * @return 64 bit hash of the collision layer.
+      */
+    virtual uint64_t ContentHash() const = 0;
+    /** Builds anything queries would otherwise build lazily on first use after an edit.
+      * Queries on a layer are only safe from several threads at once after calling this once the edits are done.
+      */
+    virtual void Prepare() const {}
+
+    // Collision queries, coordinates are in tiles for tile and direction based layers and in pixels for
+    // pixel based layers. Tile (x, y) covers [x, x + 1) x [y, y + 1) and nothing outside a tiled layer collides.
+    // Queries don't allocate so they can be run many times per frame, except that the first query after an edit
+    // rebuilds what the layer builds lazily (the region and index of a pixel based layer). Call Prepare after
+    // editing to do that up front.
+    /** Tests if a point is blocked.
+      * @param x X coordinate.
+      * @param y Y coordinate.
+      * @return true if the point is in a blocked tile or pixel.
+      */
+    virtual bool Collides(float x, float y) const = 0;
+    /** Tests if a box overlaps anything blocked, touching edges don't overlap.
+      * @param box Box to test.
+      * @return true if the box overlaps a blocked tile or pixel.
+      */
+    virtual bool Overlaps(const CollisionBox& box) const = 0;
+    /** Moves a box and finds the first blocked tile or pixel it runs into.
+      * @param box Box at the start of the movement.
+      * @param dx Horizontal movement.
+      * @param dy Vertical movement.
+      * @param hit Set to the time of impact and normal if the box hits something.
+      * @return true if the box hits something before the movement ends.
+      */
+    virtual bool Sweep(const CollisionBox& box, float dx, float dy, CollisionHit& hit) const = 0;
+    /** Casts a ray from a point and finds the first blocked tile or pixel it enters.
+      * @param x X coordinate of the start.
+      * @param y Y coordinate of the start.
+      * @param dx Horizontal length of the ray.
+      * @param dy Vertical length of the ray.
+      * @param hit Set to the time of impact and normal if the ray hits something.
+      * @return true if the ray hits something.
+      */
+    virtual bool Raycast(float x, float y, float dx, float dy, CollisionHit& hit) const = 0;
 
     Type GetType() const { return type; }
 
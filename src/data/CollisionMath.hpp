@@ -0,0 +1,77 @@
+/******************************************************************************************************
+ * Tile Map Editor
+ * Copyright (C) 2009-2017 Brandon Whitehead (tricksterguy87[AT]gmail[DOT]com)
+ *
+ * This software is provided 'as-is', without any express or implied warranty.
+ * In no event will the authors be held liable for any damages arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * excluding commercial applications, and to alter it and redistribute it freely,
+ * subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented;
+ *    you must not claim that you wrote the original software.
+ *    An acknowledgement in your documentation and link to the original version is required.
+ *
+ * 2. Altered source versions must be plainly marked as such,
+ *    and must not be misrepresented as being the original software.
+ *
+ * 3. This notice may not be removed or altered from any source distribution.
+ ******************************************************************************************************/
+#ifndef COLLISION_MATH_HPP
+#define COLLISION_MATH_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+/** Helpers shared by the collision queries of the tiled and pixel based layers. */
+
+/** Coordinates are clamped well inside int32_t so queries far off the layer stay defined */
+const float COLLISION_COORD_LIMIT = 1 << 30;
+
+/** Rounds a query coordinate down to a tile or pixel coordinate. */
+inline int32_t FloorCoord(float value)
+{
+    return (int32_t) std::floor(std::max(-COLLISION_COORD_LIMIT, std::min(COLLISION_COORD_LIMIT, value)));
+}
+
+/** Rounds a query coordinate up to a tile or pixel coordinate. */
+inline int32_t CeilCoord(float value)
+{
+    return (int32_t) std::ceil(std::max(-COLLISION_COORD_LIMIT, std::min(COLLISION_COORD_LIMIT, value)));
+}
+
+/** Finds when a moving span first overlaps [lo, hi) on one axis.
+  * A span with no size is a point and overlaps when it is in [lo, hi), otherwise touching doesn't count.
+  * @param start Start of the span.
+  * @param size Size of the span.
+  * @param delta Distance the span moves.
+  * @param lo Start of the range.
+  * @param hi End of the range.
+  * @param enter Set to the fraction of the movement when the span starts overlapping.
+  * @param exit Set to the fraction of the movement when the span stops overlapping.
+  * @return false if the span never overlaps.
+  */
+inline bool SweepAxis(float start, float size, float delta, int32_t lo, int32_t hi, float& enter, float& exit)
+{
+    if (delta > 0)
+    {
+        enter = (lo - start - size) / delta;
+        exit = (hi - start) / delta;
+    }
+    else if (delta < 0)
+    {
+        enter = (hi - start) / delta;
+        exit = (lo - start - size) / delta;
+    }
+    else
+    {
+        enter = -INFINITY;
+        exit = INFINITY;
+        return size > 0 ? start < hi && start + size > lo : start >= lo && start < hi;
+    }
+    return true;
+}
+
+#endif
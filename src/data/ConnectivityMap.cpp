@@ -0,0 +1,197 @@
+/******************************************************************************************************
+ * Tile Map Editor
+ * Copyright (C) 2009-2017 Brandon Whitehead (tricksterguy87[AT]gmail[DOT]com)
+ *
+ * This software is provided 'as-is', without any express or implied warranty.
+ * In no event will the authors be held liable for any damages arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * excluding commercial applications, and to alter it and redistribute it freely,
+ * subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented;
+ *    you must not claim that you wrote the original software.
+ *    An acknowledgement in your documentation and link to the original version is required.
+ *
+ * 2. Altered source versions must be plainly marked as such,
+ *    and must not be misrepresented as being the original software.
+ *
+ * 3. This notice may not be removed or altered from any source distribution.
+ ******************************************************************************************************/
+#include "ConnectivityMap.hpp"
+
+#include <algorithm>
+
+constexpr int32_t ConnectivityMap::NONE;
+
+namespace
+{
+
+/** Marks tiles being relabelled */
+const int32_t PENDING = -2;
+
+}
+
+ConnectivityMap::ConnectivityMap(const PathGrid& grid) : width(0), height(0)
+{
+    Build(grid);
+}
+
+void ConnectivityMap::Build(const PathGrid& grid)
+{
+    width = grid.GetWidth();
+    height = grid.GetHeight();
+    labels.assign(width * height, NONE);
+    parents.resize(width * height);
+    bounds.clear();
+    free_labels.clear();
+    affected.clear();
+    Label(grid, 0, 0, width, height);
+}
+
+void ConnectivityMap::Update(const PathGrid& grid, const Rectangle& area)
+{
+    if (grid.GetWidth() != width || grid.GetHeight() != height)
+    {
+        Build(grid);
+        return;
+    }
+
+    // Moves into the tiles next to the area may have changed too.
+    int32_t x1, y1, x2, y2;
+    area.GetCoords(x1, y1, x2, y2);
+    x1 = std::max(x1 - 1, 0);
+    y1 = std::max(y1 - 1, 0);
+    x2 = std::min(x2 + 1, (int32_t) width);
+    y2 = std::min(y2 + 1, (int32_t) height);
+    if (x1 >= x2 || y1 >= y2)
+        return;
+
+    // Components touching the area may be split or joined, anything else keeps its label.
+    affected.resize(bounds.size(), 0);
+    std::vector<int32_t> components;
+    for (int32_t y = y1; y < y2; y++)
+    {
+        for (int32_t x = x1; x < x2; x++)
+        {
+            int32_t label = labels[y * width + x];
+            if (label != NONE && !affected[label])
+            {
+                affected[label] = 1;
+                components.push_back(label);
+            }
+        }
+    }
+
+    for (uint32_t i = 0; i < components.size(); i++)
+    {
+        const Bounds& b = bounds[components[i]];
+        x1 = std::min(x1, b.x1);
+        y1 = std::min(y1, b.y1);
+        x2 = std::max(x2, b.x2);
+        y2 = std::max(y2, b.y2);
+    }
+
+    Label(grid, x1, y1, x2, y2);
+    for (uint32_t i = 0; i < components.size(); i++)
+        affected[components[i]] = 0;
+}
+
+Rectangle ConnectivityMap::GetComponentBounds(int32_t component) const
+{
+    const Bounds& b = bounds[component];
+    return Rectangle(b.x1, b.y1, b.x2 - b.x1, b.y2 - b.y1);
+}
+
+void ConnectivityMap::Label(const PathGrid& grid, int32_t x1, int32_t y1, int32_t x2, int32_t y2)
+{
+    for (int32_t y = y1; y < y2; y++)
+    {
+        for (int32_t x = x1; x < x2; x++)
+        {
+            uint32_t tile = y * width + x;
+            int32_t& label = labels[tile];
+            if (!grid.IsOpen(x, y))
+                label = NONE;
+            else if (label == NONE || ((uint32_t) label < affected.size() && affected[label]))
+                label = PENDING;
+            parents[tile] = tile;
+        }
+    }
+
+    for (uint32_t i = 0; i < affected.size(); i++)
+    {
+        if (affected[i])
+        {
+            bounds[i] = Bounds{0, 0, 0, 0};
+            free_labels.push_back(i);
+        }
+    }
+
+    // Moves are two way so only joining east and south is needed. The lower index becomes the root so
+    // a set's root is the first of its tiles in row order.
+    for (int32_t y = y1; y < y2; y++)
+    {
+        for (int32_t x = x1; x < x2; x++)
+        {
+            uint32_t tile = y * width + x;
+            if (labels[tile] != PENDING)
+                continue;
+            if (x + 1 < x2 && labels[tile + 1] == PENDING && grid.CanMove(tile, 1))
+            {
+                uint32_t a = Find(tile), b = Find(tile + 1);
+                parents[std::max(a, b)] = std::min(a, b);
+            }
+            if (y + 1 < y2 && labels[tile + width] == PENDING && grid.CanMove(tile, 2))
+            {
+                uint32_t a = Find(tile), b = Find(tile + width);
+                parents[std::max(a, b)] = std::min(a, b);
+            }
+        }
+    }
+
+    for (int32_t y = y1; y < y2; y++)
+    {
+        for (int32_t x = x1; x < x2; x++)
+        {
+            uint32_t tile = y * width + x;
+            if (labels[tile] != PENDING)
+                continue;
+            uint32_t root = Find(tile);
+            if (root == tile)
+            {
+                labels[tile] = NewLabel();
+                bounds[labels[tile]] = Bounds{x, y, x + 1, y + 1};
+                continue;
+            }
+            int32_t label = labels[root];
+            labels[tile] = label;
+            Bounds& b = bounds[label];
+            b.x1 = std::min(b.x1, x);
+            b.x2 = std::max(b.x2, x + 1);
+            b.y2 = y + 1;
+        }
+    }
+}
+
+uint32_t ConnectivityMap::Find(uint32_t tile)
+{
+    while (parents[tile] != tile)
+    {
+        parents[tile] = parents[parents[tile]];
+        tile = parents[tile];
+    }
+    return tile;
+}
+
+int32_t ConnectivityMap::NewLabel()
+{
+    if (!free_labels.empty())
+    {
+        int32_t label = free_labels.back();
+        free_labels.pop_back();
+        return label;
+    }
+    bounds.push_back(Bounds{0, 0, 0, 0});
+    return bounds.size() - 1;
+}
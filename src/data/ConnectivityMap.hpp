@@ -0,0 +1,119 @@
+/******************************************************************************************************
+ * Tile Map Editor
+ * Copyright (C) 2009-2017 Brandon Whitehead (tricksterguy87[AT]gmail[DOT]com)
+ *
+ * This software is provided 'as-is', without any express or implied warranty.
+ * In no event will the authors be held liable for any damages arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * excluding commercial applications, and to alter it and redistribute it freely,
+ * subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented;
+ *    you must not claim that you wrote the original software.
+ *    An acknowledgement in your documentation and link to the original version is required.
+ *
+ * 2. Altered source versions must be plainly marked as such,
+ *    and must not be misrepresented as being the original software.
+ *
+ * 3. This notice may not be removed or altered from any source distribution.
+ ******************************************************************************************************/
+#ifndef CONNECTIVITY_MAP_HPP
+#define CONNECTIVITY_MAP_HPP
+
+#include <cstdint>
+#include <vector>
+
+#include "PathGrid.hpp"
+#include "Rectangle.hpp"
+
+/** Labels the connected regions of open tiles in a path grid so that testing if one tile can be reached from
+  * another is a single comparison, e.g. for checking every spawn point of a level can reach every exit.
+  * Labelling is a union-find pass over the grid. Edits only relabel the components touching the edited
+  * tiles, which costs the area those components cover instead of the whole map.
+  * Moves in the grid are expected to be two way, which holds for tile and direction based layers.
+  */
+class ConnectivityMap
+{
+public:
+    /** Creates an empty map. */
+    ConnectivityMap() : width(0), height(0) {}
+    /** Labels a grid.
+      * @param grid Grid to label.
+      */
+    ConnectivityMap(const PathGrid& grid);
+
+    /** Relabels the whole grid.
+      * @param grid Grid to label.
+      */
+    void Build(const PathGrid& grid);
+    /** Brings the labels up to date after tiles of the grid were edited.
+      * The whole grid is relabelled if it was resized.
+      * @param grid Grid the labels were computed from, already updated.
+      * @param area Tiles that were edited.
+      */
+    void Update(const PathGrid& grid, const Rectangle& area);
+
+    /** Gets the component of a tile.
+      * @param x X coordinate.
+      * @param y Y coordinate.
+      * @return Component label or NONE for tiles that aren't open.
+      */
+    int32_t GetComponent(uint32_t x, uint32_t y) const { return labels[y * width + x]; }
+    /** Tests if one tile can be reached from another.
+      * @param sx X coordinate of the start.
+      * @param sy Y coordinate of the start.
+      * @param gx X coordinate of the goal.
+      * @param gy Y coordinate of the goal.
+      * @return true if both tiles are in the grid, open and connected.
+      */
+    bool IsReachable(uint32_t sx, uint32_t sy, uint32_t gx, uint32_t gy) const
+    {
+        if (sx >= width || sy >= height || gx >= width || gy >= height)
+            return false;
+        int32_t start = GetComponent(sx, sy);
+        return start != NONE && start == GetComponent(gx, gy);
+    }
+    /** Gets the smallest rectangle holding every tile of a component.
+      * @param component Component label.
+      */
+    Rectangle GetComponentBounds(int32_t component) const;
+    /** Number of components, labels are below GetLabelCount() but may skip values freed by edits */
+    uint32_t GetComponentCount() const { return bounds.size() - free_labels.size(); }
+    uint32_t GetLabelCount() const { return bounds.size(); }
+    uint32_t GetWidth() const { return width; }
+    uint32_t GetHeight() const { return height; }
+
+    /** Label of tiles that aren't open */
+    static constexpr int32_t NONE = -1;
+
+private:
+    struct Bounds
+    {
+        int32_t x1, y1, x2, y2;
+    };
+
+    /** Relabels the open tiles in [x1, x2) x [y1, y2) that are unlabelled or in a component flagged in affected.
+      * Every tile connected to one of them must be inside the window.
+      */
+    void Label(const PathGrid& grid, int32_t x1, int32_t y1, int32_t x2, int32_t y2);
+    /** Finds the representative tile of a set, which is its lowest index */
+    uint32_t Find(uint32_t tile);
+    /** Takes a freed label or a new one */
+    int32_t NewLabel();
+
+    /** Dimensions in tiles */
+    uint32_t width, height;
+    /** Component of each tile */
+    std::vector<int32_t> labels;
+    /** Union-find parent of each tile, only meaningful while labelling */
+    std::vector<uint32_t> parents;
+    /** Bounds of each component, empty for free labels */
+    std::vector<Bounds> bounds;
+    /** Labels of components removed by edits */
+    std::vector<int32_t> free_labels;
+    /** Scratch flags for the components being relabelled */
+    std::vector<uint8_t> affected;
+};
+
+#endif
@@ -0,0 +1,214 @@
+/******************************************************************************************************
+ * Tile Map Editor
+ * Copyright (C) 2009-2017 Brandon Whitehead (tricksterguy87[AT]gmail[DOT]com)
+ *
+ * This software is provided 'as-is', without any express or implied warranty.
+ * In no event will the authors be held liable for any damages arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * excluding commercial applications, and to alter it and redistribute it freely,
+ * subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented;
+ *    you must not claim that you wrote the original software.
+ *    An acknowledgement in your documentation and link to the original version is required.
+ *
+ * 2. Altered source versions must be plainly marked as such,
+ *    and must not be misrepresented as being the original software.
+ *
+ * 3. This notice may not be removed or altered from any source distribution.
+ ******************************************************************************************************/
+#include "DerivedCollision.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#include "TileBasedCollisionLayer.hpp"
+
+constexpr uint32_t DerivedCollision::CHUNK_SIZE;
+
+DerivedCollision::DerivedCollision(const Map& map) : chunks_wide(0), chunks_high(0), tile_width(0), tile_height(0), layer_count(0),
+    collision_layer(nullptr), collision_type(-1)
+{
+    Build(map);
+}
+
+void DerivedCollision::Build(const Map& map)
+{
+    map.GetTileset().GetTileDimensions(tile_width, tile_height);
+    layer_count = map.GetNumLayers();
+    collision_layer = map.GetCollisionLayer();
+    collision_type = collision_layer ? collision_layer->GetType() : -1;
+    tiles = DirectionBasedCollisionLayer(map.GetWidth(), map.GetHeight());
+    chunks_wide = (tiles.GetWidth() + CHUNK_SIZE - 1) / CHUNK_SIZE;
+    chunks_high = (tiles.GetHeight() + CHUNK_SIZE - 1) / CHUNK_SIZE;
+    rectangles.assign(chunks_wide * chunks_high, std::vector<Rectangle>());
+    dirty.assign(chunks_wide * chunks_high, 0);
+    dirty_chunks.clear();
+
+    for (uint32_t chunk_y = 0; chunk_y < chunks_high; chunk_y++)
+    {
+        for (uint32_t chunk_x = 0; chunk_x < chunks_wide; chunk_x++)
+            ComputeChunk(map, chunk_x, chunk_y);
+    }
+}
+
+void DerivedCollision::Invalidate(const Rectangle& area)
+{
+    int32_t x1, y1, x2, y2;
+    area.GetCoords(x1, y1, x2, y2);
+    x1 = std::max(x1, 0);
+    y1 = std::max(y1, 0);
+    x2 = std::min(x2, (int32_t) tiles.GetWidth());
+    y2 = std::min(y2, (int32_t) tiles.GetHeight());
+    if (x1 >= x2 || y1 >= y2)
+        return;
+
+    for (uint32_t chunk_y = y1 / CHUNK_SIZE; chunk_y <= (y2 - 1) / CHUNK_SIZE; chunk_y++)
+    {
+        for (uint32_t chunk_x = x1 / CHUNK_SIZE; chunk_x <= (x2 - 1) / CHUNK_SIZE; chunk_x++)
+        {
+            uint32_t chunk = chunk_y * chunks_wide + chunk_x;
+            if (!dirty[chunk])
+            {
+                dirty[chunk] = 1;
+                dirty_chunks.push_back(chunk);
+            }
+        }
+    }
+}
+
+void DerivedCollision::Refresh(const Map& map)
+{
+    uint32_t width, height;
+    map.GetTileset().GetTileDimensions(width, height);
+    const CollisionLayer* layer = map.GetCollisionLayer();
+    if (map.GetWidth() != tiles.GetWidth() || map.GetHeight() != tiles.GetHeight() || width != tile_width || height != tile_height ||
+        map.GetNumLayers() != layer_count || layer != collision_layer || (layer ? layer->GetType() : -1) != collision_type)
+    {
+        Build(map);
+        return;
+    }
+
+    for (uint32_t chunk : dirty_chunks)
+    {
+        ComputeChunk(map, chunk % chunks_wide, chunk / chunks_wide);
+        dirty[chunk] = 0;
+    }
+    dirty_chunks.clear();
+}
+
+bool DerivedCollision::Collides(float x, float y) const
+{
+    if (tile_width == 0 || tile_height == 0)
+        return false;
+    if (tiles.Collides(x / tile_width, y / tile_height))
+        return true;
+    if (!(x >= 0 && y >= 0))
+        return false;
+
+    uint32_t chunk_x = static_cast<uint32_t>(x / tile_width) / CHUNK_SIZE;
+    uint32_t chunk_y = static_cast<uint32_t>(y / tile_height) / CHUNK_SIZE;
+    if (chunk_x >= chunks_wide || chunk_y >= chunks_high)
+        return false;
+    for (const auto& rectangle : GetRectangles(chunk_x, chunk_y))
+    {
+        if (x >= rectangle.x && x < rectangle.x + rectangle.width && y >= rectangle.y && y < rectangle.y + rectangle.height)
+            return true;
+    }
+    return false;
+}
+
+bool DerivedCollision::Overlaps(const CollisionBox& box) const
+{
+    if (tile_width == 0 || tile_height == 0 || !(box.width > 0 && box.height > 0))
+        return false;
+    CollisionBox scaled = {box.x / tile_width, box.y / tile_height, box.width / tile_width, box.height / tile_height};
+    if (tiles.Overlaps(scaled))
+        return true;
+
+    // Chunks the box touches, clamped to the map.
+    const float chunk_width = static_cast<float>(tile_width * CHUNK_SIZE);
+    const float chunk_height = static_cast<float>(tile_height * CHUNK_SIZE);
+    int32_t x1 = std::max(0.0f, std::floor(box.x / chunk_width));
+    int32_t y1 = std::max(0.0f, std::floor(box.y / chunk_height));
+    int32_t x2 = std::min(static_cast<float>(chunks_wide), std::ceil((box.x + box.width) / chunk_width));
+    int32_t y2 = std::min(static_cast<float>(chunks_high), std::ceil((box.y + box.height) / chunk_height));
+    for (int32_t chunk_y = y1; chunk_y < y2; chunk_y++)
+    {
+        for (int32_t chunk_x = x1; chunk_x < x2; chunk_x++)
+        {
+            for (const auto& rectangle : GetRectangles(chunk_x, chunk_y))
+            {
+                if (box.x < rectangle.x + rectangle.width && rectangle.x < box.x + box.width &&
+                    box.y < rectangle.y + rectangle.height && rectangle.y < box.y + box.height)
+                    return true;
+            }
+        }
+    }
+    return false;
+}
+
+void DerivedCollision::ComputeChunk(const Map& map, uint32_t chunk_x, uint32_t chunk_y)
+{
+    const Tileset& tileset = map.GetTileset();
+    const TileCollision& collision = tileset.GetTileCollision();
+    const CollisionLayer* layer = map.GetCollisionLayer();
+    const TileBasedCollisionLayer* own_tiles = dynamic_cast<const TileBasedCollisionLayer*>(layer);
+    const DirectionBasedCollisionLayer* own_directions = dynamic_cast<const DirectionBasedCollisionLayer*>(layer);
+
+    std::vector<Rectangle>& chunk_rectangles = rectangles[chunk_y * chunks_wide + chunk_x];
+    chunk_rectangles.clear();
+    const uint32_t x1 = chunk_x * CHUNK_SIZE;
+    const uint32_t y1 = chunk_y * CHUNK_SIZE;
+    const uint32_t x2 = std::min(x1 + CHUNK_SIZE, tiles.GetWidth());
+    const uint32_t y2 = std::min(y1 + CHUNK_SIZE, tiles.GetHeight());
+    for (uint32_t y = y1; y < y2; y++)
+    {
+        for (uint32_t x = x1; x < x2; x++)
+        {
+            int32_t value = DirectionBasedCollisionLayer::ALL_DIRECTIONS;
+            if (own_tiles && own_tiles->GetGrid().Get(x, y))
+                value = 0;
+            if (own_directions && x < own_directions->GetWidth() && y < own_directions->GetHeight())
+                value &= own_directions->GetGrid().Get(x, y);
+
+            for (const auto& map_layer : map.GetLayers())
+            {
+                if (x >= map_layer.GetWidth() || y >= map_layer.GetHeight())
+                    continue;
+                uint32_t tile = Resolve(tileset, map_layer.At(x, y));
+                if (tile == TiledLayerData::NULL_TILE)
+                    continue;
+                if (collision.IsBlocked(tile))
+                    value = 0;
+                value &= collision.GetDirections(tile);
+
+                for (const auto& rectangle : collision.GetRectangles(tile))
+                {
+                    int32_t left = std::max(rectangle.x, 0);
+                    int32_t top = std::max(rectangle.y, 0);
+                    int32_t right = std::min(rectangle.x + rectangle.width, (int32_t) tile_width);
+                    int32_t bottom = std::min(rectangle.y + rectangle.height, (int32_t) tile_height);
+                    if (left < right && top < bottom)
+                        chunk_rectangles.emplace_back(x * tile_width + left, y * tile_height + top, right - left, bottom - top);
+                }
+            }
+            tiles.Set(x, y, value);
+        }
+    }
+}
+
+uint32_t DerivedCollision::Resolve(const Tileset& tileset, int32_t tile)
+{
+    uint32_t id = tile;
+    if (id != TiledLayerData::NULL_TILE && (id >> 31))
+    {
+        const std::vector<AnimatedTile>& animations = tileset.GetAnimatedTiles();
+        uint32_t animation = id & ~(1u << 31);
+        if (animation >= animations.size() || animations[animation].GetFrames().empty())
+            return TiledLayerData::NULL_TILE;
+        id = animations[animation].GetFrames()[0];
+    }
+    return id;
+}
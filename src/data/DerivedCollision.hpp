@@ -0,0 +1,126 @@
+/******************************************************************************************************
+ * Tile Map Editor
+ * Copyright (C) 2009-2017 Brandon Whitehead (tricksterguy87[AT]gmail[DOT]com)
+ *
+ * This software is provided 'as-is', without any express or implied warranty.
+ * In no event will the authors be held liable for any damages arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * excluding commercial applications, and to alter it and redistribute it freely,
+ * subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented;
+ *    you must not claim that you wrote the original software.
+ *    An acknowledgement in your documentation and link to the original version is required.
+ *
+ * 2. Altered source versions must be plainly marked as such,
+ *    and must not be misrepresented as being the original software.
+ *
+ * 3. This notice may not be removed or altered from any source distribution.
+ ******************************************************************************************************/
+#ifndef DERIVED_COLLISION_HPP
+#define DERIVED_COLLISION_HPP
+
+#include <cstdint>
+#include <vector>
+
+#include "CollisionLayer.hpp"
+#include "DirectionBasedCollisionLayer.hpp"
+#include "Map.hpp"
+#include "Rectangle.hpp"
+
+/** Effective collision of a map, combining the TileCollision of every tile placed on its layers with the map's own
+  * tile or direction based collision layer, so movement checks don't have to look at every layer.
+  * Each tile keeps the directions that can be taken out of it once every layer has had its say: a tile blocked on
+  * any layer allows none and a side closed on any layer stays closed. Tile rectangles are kept in map pixels
+  * grouped by CHUNK_SIZE x CHUNK_SIZE chunk of tiles.
+  * Tile edits mark their chunks dirty with Invalidate and Refresh recomputes only those chunks.
+  */
+class DerivedCollision
+{
+public:
+    /** Creates an empty collision. */
+    DerivedCollision() : chunks_wide(0), chunks_high(0), tile_width(0), tile_height(0), layer_count(0), collision_layer(nullptr),
+        collision_type(-1) {}
+    /** Computes the collision of a map.
+      * @param map Map to compute the collision of.
+      */
+    explicit DerivedCollision(const Map& map);
+
+    /** Recomputes everything, needed after the map is resized or its tileset changes.
+      * @param map Map to compute the collision of.
+      */
+    void Build(const Map& map);
+    /** Marks tiles as edited without recomputing them yet, so a batch of edits is only recomputed once.
+      * @param area Tiles that were edited on any layer or the collision layer.
+      */
+    void Invalidate(const Rectangle& area);
+    /** Recomputes the chunks marked by Invalidate.
+      * Everything is rebuilt instead if the map or its tiles were resized, a layer was added or removed or the
+      * collision layer was replaced by one at another address or of another type. A collision layer deleted and
+      * replaced at the same address by one of the same type can't be told apart, call Build after doing that.
+      * @param map Map the collision was computed from.
+      */
+    void Refresh(const Map& map);
+    /** Recomputes the chunks holding some edited tiles.
+      * @param map Map the collision was computed from.
+      * @param area Tiles that were edited on any layer or the collision layer.
+      */
+    void Update(const Map& map, const Rectangle& area)
+    {
+        Invalidate(area);
+        Refresh(map);
+    }
+    /** Tests if any chunk is waiting for Refresh */
+    bool IsDirty() const { return !dirty_chunks.empty(); }
+
+    /** Gets the effective directions of each tile as a layer for PathGrid, DistanceField and the like */
+    const DirectionBasedCollisionLayer& GetTiles() const { return tiles; }
+    /** Tests if a tile allows no movement at all */
+    bool IsBlocked(uint32_t x, uint32_t y) const { return (tiles.At(x, y) & DirectionBasedCollisionLayer::ALL_DIRECTIONS) == 0; }
+    /** @see DirectionBasedCollisionLayer::CanMove */
+    bool CanMove(uint32_t x, uint32_t y, DirectionBasedCollisionLayer::Direction direction) const { return tiles.CanMove(x, y, direction); }
+    /** Tests if a point in map pixels is on a blocked tile or inside a tile rectangle.
+      * @param x X coordinate in pixels.
+      * @param y Y coordinate in pixels.
+      */
+    bool Collides(float x, float y) const;
+    /** Tests if a box in map pixels overlaps a blocked tile or a tile rectangle.
+      * @param box Box to test.
+      */
+    bool Overlaps(const CollisionBox& box) const;
+    /** Gets the tile rectangles of a chunk in map pixels, each is clipped to its tile */
+    const std::vector<Rectangle>& GetRectangles(uint32_t chunk_x, uint32_t chunk_y) const { return rectangles[chunk_y * chunks_wide + chunk_x]; }
+
+    uint32_t GetWidth() const { return tiles.GetWidth(); }
+    uint32_t GetHeight() const { return tiles.GetHeight(); }
+    uint32_t GetChunksWide() const { return chunks_wide; }
+    uint32_t GetChunksHigh() const { return chunks_high; }
+
+    /** Size in tiles of the chunks recomputed at once */
+    static constexpr uint32_t CHUNK_SIZE = TiledLayerData::CHUNK_SIZE;
+
+private:
+    /** Recomputes the tiles and rectangles of one chunk */
+    void ComputeChunk(const Map& map, uint32_t chunk_x, uint32_t chunk_y);
+    /** Resolves animated tiles to their first frame, returns NULL_TILE for empty tiles */
+    static uint32_t Resolve(const Tileset& tileset, int32_t tile);
+
+    /** Effective directions of each tile */
+    DirectionBasedCollisionLayer tiles;
+    /** Tile rectangles of each chunk */
+    std::vector<std::vector<Rectangle>> rectangles;
+    /** Chunks waiting for Refresh and a flag for each chunk set while it waits */
+    std::vector<uint32_t> dirty_chunks;
+    std::vector<uint8_t> dirty;
+    /** Dimensions in chunks */
+    uint32_t chunks_wide, chunks_high;
+    /** Tile dimensions of the tileset in pixels */
+    uint32_t tile_width, tile_height;
+    /** Number of layers and the collision layer with its type (-1 if none) the collision was built from */
+    uint32_t layer_count;
+    const CollisionLayer* collision_layer;
+    int32_t collision_type;
+};
+
+#endif
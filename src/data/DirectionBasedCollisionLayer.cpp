@@ -0,0 +1,99 @@
+/******************************************************************************************************
+ * Tile Map Editor
+ * Copyright (C) 2009-2017 Brandon Whitehead (tricksterguy87[AT]gmail[DOT]com)
+ *
+ * This software is provided 'as-is', without any express or implied warranty.
+ * In no event will the authors be held liable for any damages arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * excluding commercial applications, and to alter it and redistribute it freely,
+ * subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented;
+ *    you must not claim that you wrote the original software.
+ *    An acknowledgement in your documentation and link to the original version is required.
+ *
+ * 2. Altered source versions must be plainly marked as such,
+ *    and must not be misrepresented as being the original software.
+ *
+ * 3. This notice may not be removed or altered from any source distribution.
+ ******************************************************************************************************/
+#include "DirectionBasedCollisionLayer.hpp"
+
+#include "Hash.hpp"
+
+namespace
+{
+
+/** Movement for each direction */
+const int32_t STEP_X[4] = {0, 1, 0, -1};
+const int32_t STEP_Y[4] = {-1, 0, 1, 0};
+/** Bit needed in the tile moved from and in the tile moved into for each direction */
+const int32_t LEAVE_BIT[4] = {1, 2, 4, 8};
+const int32_t ENTER_BIT[4] = {4, 8, 1, 2};
+
+}
+
+constexpr int32_t DirectionBasedCollisionLayer::ALL_DIRECTIONS;
+
+DirectionBasedCollisionLayer::DirectionBasedCollisionLayer(int width, int height, const std::vector<int32_t>& data)
+    : TiledCollisionLayer(CollisionLayer::DirectionBased), grid(width, height)
+{
+    // Rows data doesn't cover are left as null tiles.
+    Clear();
+    if (width > 0)
+        grid.SetRows(0, data.size() / width, data.data());
+}
+
+DirectionBasedCollisionLayer::DirectionBasedCollisionLayer(int width, int height, const int32_t* data)
+    : TiledCollisionLayer(CollisionLayer::DirectionBased), grid(width, height)
+{
+    grid.SetRows(0, height, data);
+}
+
+DirectionBasedCollisionLayer::DirectionBasedCollisionLayer(int width, int height)
+    : TiledCollisionLayer(CollisionLayer::DirectionBased), grid(width, height)
+{
+    Clear();
+}
+
+bool DirectionBasedCollisionLayer::operator==(const DirectionBasedCollisionLayer& other) const
+{
+    if (type != other.type)
+        return false;
+    return grid == other.grid;
+}
+
+bool DirectionBasedCollisionLayer::CanMove(uint32_t x, uint32_t y, Direction direction) const
+{
+    uint8_t move = direction;
+    return ValidateMoves(x, y, &move, 1) == 1;
+}
+
+uint32_t DirectionBasedCollisionLayer::ValidateMoves(uint32_t x, uint32_t y, const uint8_t* moves, uint32_t count) const
+{
+    const uint32_t width = grid.GetWidth();
+    const uint32_t height = grid.GetHeight();
+    if (x >= width || y >= height)
+        return 0;
+
+    for (uint32_t i = 0; i < count; i++)
+    {
+        uint8_t move = moves[i];
+        if (move > West || !(grid.Get(x, y) & LEAVE_BIT[move]))
+            return i;
+        // Stepping off the left or top edge wraps around to a large value.
+        uint32_t nx = x + STEP_X[move];
+        uint32_t ny = y + STEP_Y[move];
+        if (nx >= width || ny >= height || !(grid.Get(nx, ny) & ENTER_BIT[move]))
+            return i;
+        x = nx;
+        y = ny;
+    }
+    return count;
+}
+
+uint64_t DirectionBasedCollisionLayer::ContentHash() const
+{
+    return HashCombine(type, grid.ContentHash());
+}
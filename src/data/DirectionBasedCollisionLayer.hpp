@@ -0,0 +1,135 @@
+/******************************************************************************************************
+ * Tile Map Editor
+ * Copyright (C) 2009-2017 Brandon Whitehead (tricksterguy87[AT]gmail[DOT]com)
+ *
+ * This software is provided 'as-is', without any express or implied warranty.
+ * In no event will the authors be held liable for any damages arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * excluding commercial applications, and to alter it and redistribute it freely,
+ * subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented;
+ *    you must not claim that you wrote the original software.
+ *    An acknowledgement in your documentation and link to the original version is required.
+ *
+ * 2. Altered source versions must be plainly marked as such,
+ *    and must not be misrepresented as being the original software.
+ *
+ * 3. This notice may not be removed or altered from any source distribution.
+ ******************************************************************************************************/
+#ifndef DIRECTION_BASED_COLLISION_LAYER_HPP
+#define DIRECTION_BASED_COLLISION_LAYER_HPP
+
+#include <cstdint>
+#include <vector>
+
+#include "PackedTileGrid.hpp"
+#include "TileCollisionQuery.hpp"
+#include "TiledCollisionLayer.hpp"
+
+/** A collision layer that is direction based.
+  * Collision information is defined per tile as a bitvector of the directions
+  * that can be taken out of the tile, see Direction for the bits.
+  * Moving from one tile to its neighbour needs the direction's bit set in the tile
+  * and the opposite direction's bit set in the neighbour, so clearing either side puts a wall between the tiles.
+  * The null tile (-1) has every bit set and is passable in all directions.
+  * For collision queries a tile is blocked if none of its directions are set.
+  * Tiles are stored as their four direction bits, so the null tile reads back as ALL_DIRECTIONS.
+  */
+class DirectionBasedCollisionLayer : public TiledCollisionLayer
+{
+public:
+    /** Directions of movement, tile bit for a direction is 1 << direction. */
+    enum Direction
+    {
+        North = 0,
+        East = 1,
+        South = 2,
+        West = 3,
+    };
+
+    /** Creates a collision layer with specified width, height and data.
+      * @param width Nonzero Width of the collision layer.
+      * @param height Nonzero Height of the collision layer.
+      * @param data collision info Must be width * height ints
+      */
+    DirectionBasedCollisionLayer(int width, int height, const std::vector<int32_t>& data);
+    /** Creates a collision layer with specified width, height and data.
+      * @param width Nonzero Width of the collision layer.
+      * @param height Nonzero Height of the collision layer.
+      * @param data collision info Must be width * height ints
+      */
+    DirectionBasedCollisionLayer(int width, int height, const int32_t* data);
+    /** Creates a collision layer with specified width, height and data.
+      * @param width Nonzero Width of the collision layer.
+      * @param height Nonzero Height of the collision layer.
+      */
+    DirectionBasedCollisionLayer(int width = 1, int height = 1);
+    bool operator==(const DirectionBasedCollisionLayer& other) const;
+    bool operator!=(const DirectionBasedCollisionLayer& other) const { return !(*this == other); }
+
+    /** Tests if a single step can be taken.
+      * @param x X coordinate of the tile moved from.
+      * @param y Y coordinate of the tile moved from.
+      * @param direction Direction to move.
+      * @return true if the tile and its neighbour allow the move and both are within the layer.
+      */
+    bool CanMove(uint32_t x, uint32_t y, Direction direction) const;
+    /** Checks a whole sequence of moves walking from a starting tile.
+      * @param x X coordinate of the starting tile.
+      * @param y Y coordinate of the starting tile.
+      * @param moves Directions of each step, values outside Direction fail the step.
+      * @param count Number of steps.
+      * @return number of steps taken before the first one that isn't allowed, count if all are.
+      */
+    uint32_t ValidateMoves(uint32_t x, uint32_t y, const uint8_t* moves, uint32_t count) const;
+    uint32_t ValidateMoves(uint32_t x, uint32_t y, const std::vector<uint8_t>& moves) const
+    {
+        return ValidateMoves(x, y, moves.data(), moves.size());
+    }
+
+    /** Gets the bit a direction uses within a tile */
+    static int32_t Bit(Direction direction) { return 1 << direction; }
+    /** Gets the direction opposite another */
+    static Direction Opposite(Direction direction) { return static_cast<Direction>((direction + 2) % 4); }
+
+    uint32_t GetWidth() const { return grid.GetWidth(); }
+    uint32_t GetHeight() const { return grid.GetHeight(); }
+    /** Gets the direction bits of a tile */
+    int32_t At(uint32_t x, uint32_t y) const { return PackedDirectionCollision::UnpackTile(grid.Get(x, y)); }
+    /** Sets the direction bits of a tile, bits other than the directions are dropped */
+    void Set(uint32_t x, uint32_t y, int32_t value) { grid.Set(x, y, PackedDirectionCollision::PackTile(value)); }
+    /** @return The packed direction bits of each tile */
+    const PackedDirectionCollision& GetGrid() const { return grid; }
+    /** @see TiledCollisionLayer::GetRows */
+    void GetRows(uint32_t row, uint32_t count, int32_t* data) const { grid.GetRows(row, count, data); }
+    /** @see TiledCollisionLayer::SetRows */
+    void SetRows(uint32_t row, uint32_t count, const int32_t* data) { grid.SetRows(row, count, data); }
+
+    /** @see CollisionLayer::Clear */
+    void Clear() { grid.Fill(0, 0, grid.GetWidth(), grid.GetHeight(), PackedDirectionCollision::MASK); }
+    /** @see CollisionLayer::Shift */
+    void Shift(int horizontal, int vertical, bool wrap = false) { grid.Shift(horizontal, vertical, wrap); }
+    /** @see CollisionLayer::Resize */
+    void Resize(uint32_t width, uint32_t height, bool copy = true) { grid.Resize(width, height, copy); }
+    /** @see CollisionLayer::ContentHash */
+    uint64_t ContentHash() const;
+    /** @see CollisionLayer::Collides */
+    bool Collides(float x, float y) const { return TileCollisionQuery(grid).Collides(x, y); }
+    /** @see CollisionLayer::Overlaps */
+    bool Overlaps(const CollisionBox& box) const { return TileCollisionQuery(grid).Overlaps(box); }
+    /** @see CollisionLayer::Sweep */
+    bool Sweep(const CollisionBox& box, float dx, float dy, CollisionHit& hit) const { return TileCollisionQuery(grid).Sweep(box, dx, dy, hit); }
+    /** @see CollisionLayer::Raycast */
+    bool Raycast(float x, float y, float dx, float dy, CollisionHit& hit) const { return TileCollisionQuery(grid).Raycast(x, y, dx, dy, hit); }
+
+    /** Bits for all directions */
+    static constexpr int32_t ALL_DIRECTIONS = 0xF;
+
+private:
+    /** Four direction bits per tile */
+    PackedDirectionCollision grid;
+};
+
+#endif
@@ -0,0 +1,174 @@
+/******************************************************************************************************
+ * Tile Map Editor
+ * Copyright (C) 2009-2017 Brandon Whitehead (tricksterguy87[AT]gmail[DOT]com)
+ *
+ * This software is provided 'as-is', without any express or implied warranty.
+ * In no event will the authors be held liable for any damages arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * excluding commercial applications, and to alter it and redistribute it freely,
+ * subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented;
+ *    you must not claim that you wrote the original software.
+ *    An acknowledgement in your documentation and link to the original version is required.
+ *
+ * 2. Altered source versions must be plainly marked as such,
+ *    and must not be misrepresented as being the original software.
+ *
+ * 3. This notice may not be removed or altered from any source distribution.
+ ******************************************************************************************************/
+#include "DistanceField.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+
+/** Integer division rounding down */
+int64_t FloorDivide(int64_t a, int64_t b)
+{
+    return a / b - (a % b != 0 && (a < 0) != (b < 0));
+}
+
+}
+
+DistanceField::DistanceField(const PathGrid& grid, Metric _metric) : metric(_metric), width(0), height(0)
+{
+    Build(grid);
+}
+
+void DistanceField::Build(const PathGrid& grid)
+{
+    width = grid.GetWidth();
+    height = grid.GetHeight();
+    columns.assign(width * height, 0);
+    distances.assign(width * height, 0);
+    line.resize(height);
+    nearest.resize(width);
+    starts.resize(width);
+    dirty.assign(height, 0);
+
+    if (width == 0 || height == 0)
+        return;
+    for (uint32_t x = 0; x < width; x++)
+        ComputeColumn(grid, x);
+    for (uint32_t y = 0; y < height; y++)
+        ComputeRow(y);
+}
+
+void DistanceField::Update(const PathGrid& grid, const Rectangle& area)
+{
+    if (grid.GetWidth() != width || grid.GetHeight() != height)
+    {
+        Build(grid);
+        return;
+    }
+
+    int32_t x1, y1, x2, y2;
+    area.GetCoords(x1, y1, x2, y2);
+    x1 = std::max(x1, 0);
+    x2 = std::min(x2, (int32_t) width);
+    if (x1 >= x2 || y1 >= y2)
+        return;
+
+    // Column distances only change in the edited columns but can change anywhere along them.
+    dirty.assign(height, 0);
+    for (int32_t x = x1; x < x2; x++)
+        ComputeColumn(grid, x);
+    for (uint32_t y = 0; y < height; y++)
+    {
+        if (dirty[y])
+            ComputeRow(y);
+    }
+}
+
+float DistanceField::Get(uint32_t x, uint32_t y) const
+{
+    uint32_t raw = GetRaw(x, y);
+    return metric == Euclidean ? std::sqrt(static_cast<float>(raw)) : static_cast<float>(raw);
+}
+
+void DistanceField::ComputeColumn(const PathGrid& grid, uint32_t x)
+{
+    const uint32_t infinity = width + height;
+    uint32_t previous = infinity;
+    for (uint32_t y = 0; y < height; y++)
+    {
+        previous = grid.IsOpen(x, y) ? std::min(previous + 1, infinity) : 0;
+        line[y] = previous;
+    }
+    for (uint32_t y = height - 1; y-- > 0;)
+    {
+        if (line[y + 1] < line[y])
+            line[y] = line[y + 1] + 1;
+    }
+
+    for (uint32_t y = 0; y < height; y++)
+    {
+        uint32_t& distance = columns[y * width + x];
+        if (distance != line[y])
+        {
+            distance = line[y];
+            dirty[y] = 1;
+        }
+    }
+}
+
+void DistanceField::ComputeRow(uint32_t y)
+{
+    const uint32_t* row = &columns[y * width];
+    // Lower envelope of the distance functions of each column, nearest[q] is the column nearest
+    // to the tiles from starts[q] up to starts[q + 1].
+    int64_t q = 0;
+    nearest[0] = 0;
+    starts[0] = 0;
+    for (uint32_t u = 1; u < width; u++)
+    {
+        while (q >= 0 && Distance(starts[q], nearest[q], row) > Distance(starts[q], u, row))
+            q--;
+        if (q < 0)
+        {
+            q = 0;
+            nearest[0] = u;
+        }
+        else
+        {
+            int64_t start = 1 + Separator(nearest[q], u, row);
+            if (start < width)
+            {
+                q++;
+                nearest[q] = u;
+                starts[q] = start;
+            }
+        }
+    }
+
+    uint32_t* out = &distances[y * width];
+    for (int64_t u = width - 1; u >= 0; u--)
+    {
+        out[u] = Distance(u, nearest[q], row);
+        if (u == starts[q])
+            q--;
+    }
+}
+
+int64_t DistanceField::Distance(int64_t x, int64_t i, const uint32_t* row) const
+{
+    int64_t g = row[i];
+    if (metric == Euclidean)
+        return (x - i) * (x - i) + g * g;
+    return std::max(std::abs(x - i), g);
+}
+
+int64_t DistanceField::Separator(int64_t i, int64_t u, const uint32_t* row) const
+{
+    int64_t gi = row[i];
+    int64_t gu = row[u];
+    if (metric == Euclidean)
+        return FloorDivide(u * u - i * i + gu * gu - gi * gi, 2 * (u - i));
+    if (gi <= gu)
+        return std::max(i + gu, (i + u) / 2);
+    return std::min(u - gi, (i + u) / 2);
+}
@@ -0,0 +1,118 @@
+/******************************************************************************************************
+ * Tile Map Editor
+ * Copyright (C) 2009-2017 Brandon Whitehead (tricksterguy87[AT]gmail[DOT]com)
+ *
+ * This software is provided 'as-is', without any express or implied warranty.
+ * In no event will the authors be held liable for any damages arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * excluding commercial applications, and to alter it and redistribute it freely,
+ * subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented;
+ *    you must not claim that you wrote the original software.
+ *    An acknowledgement in your documentation and link to the original version is required.
+ *
+ * 2. Altered source versions must be plainly marked as such,
+ *    and must not be misrepresented as being the original software.
+ *
+ * 3. This notice may not be removed or altered from any source distribution.
+ ******************************************************************************************************/
+#ifndef DISTANCE_FIELD_HPP
+#define DISTANCE_FIELD_HPP
+
+#include <cstdint>
+#include <vector>
+
+#include "PathGrid.hpp"
+#include "Rectangle.hpp"
+
+/** Distance from each tile of a path grid to the nearest tile that isn't open.
+  * Built with the two pass separable transform of Meijster et al. in linear time, the first pass finds the
+  * distance to the nearest blocked tile in the same column and the second combines the columns along each row.
+  * Tiles outside the grid don't count as blocked, a grid without blocked tiles has every distance
+  * at least GetWidth() + GetHeight().
+  */
+class DistanceField
+{
+public:
+    enum Metric
+    {
+        /** Straight line distance, stored squared */
+        Euclidean = 0,
+        /** max(|dx|, |dy|) the number of 8-connected steps */
+        Chebyshev = 1,
+    };
+
+    /** Creates an empty field. */
+    DistanceField(Metric metric = Euclidean) : metric(metric), width(0), height(0) {}
+    /** Computes the field of a grid.
+      * @param grid Grid to compute the field of.
+      * @param metric Distance measured.
+      */
+    DistanceField(const PathGrid& grid, Metric metric = Euclidean);
+
+    /** Recomputes the whole field.
+      * @param grid Grid to compute the field of.
+      */
+    void Build(const PathGrid& grid);
+    /** Brings the field up to date after tiles of the grid were edited. Only the columns of the area and
+      * the rows whose column distances changed are recomputed.
+      * The whole field is rebuilt if the grid was resized.
+      * @param grid Grid the field was computed from, already updated.
+      * @param area Tiles that were edited.
+      */
+    void Update(const PathGrid& grid, const Rectangle& area);
+
+    /** Gets the distance of a tile.
+      * @param x X coordinate.
+      * @param y Y coordinate.
+      * @return Distance to the nearest blocked tile, 0 for blocked tiles.
+      */
+    float Get(uint32_t x, uint32_t y) const;
+    /** Gets the distance as stored, squared for Euclidean fields.
+      * @param x X coordinate.
+      * @param y Y coordinate.
+      */
+    uint32_t GetRaw(uint32_t x, uint32_t y) const { return distances[y * width + x]; }
+    /** Tests if a tile is at least some distance from every blocked tile, i.e. a round object of that radius
+      * centered on it stays clear of walls.
+      * @param x X coordinate.
+      * @param y Y coordinate.
+      * @param distance Clearance needed in tiles.
+      */
+    bool HasClearance(uint32_t x, uint32_t y, uint32_t distance) const
+    {
+        return GetRaw(x, y) >= (metric == Euclidean ? distance * distance : distance);
+    }
+
+    Metric GetMetric() const { return metric; }
+    uint32_t GetWidth() const { return width; }
+    uint32_t GetHeight() const { return height; }
+
+private:
+    /** First pass over one column, flags the rows whose distance changed in dirty */
+    void ComputeColumn(const PathGrid& grid, uint32_t x);
+    /** Second pass over one row */
+    void ComputeRow(uint32_t y);
+    /** Distance from tile x to column i in the current row */
+    int64_t Distance(int64_t x, int64_t i, const uint32_t* row) const;
+    /** First tile to the right of both columns closer to column u than to column i, i < u */
+    int64_t Separator(int64_t i, int64_t u, const uint32_t* row) const;
+
+    Metric metric;
+    /** Dimensions in tiles */
+    uint32_t width, height;
+    /** Distance to the nearest blocked tile in the same column, stored in row order */
+    std::vector<uint32_t> columns;
+    /** Final distances */
+    std::vector<uint32_t> distances;
+    /** Scratch column for the first pass */
+    std::vector<uint32_t> line;
+    /** Scratch columns and the start of the part of the row they are nearest to for the second pass */
+    std::vector<uint32_t> nearest, starts;
+    /** Scratch flags for the rows to recompute */
+    std::vector<uint8_t> dirty;
+};
+
+#endif
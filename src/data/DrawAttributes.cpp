@@ -20,6 +20,8 @@
  ******************************************************************************************************/
 #include "DrawAttributes.hpp"
 
+#include "Hash.hpp"
+
 void DrawAttributes::GetPosition(int32_t& _x, int32_t& _y) const
 {
     _x = x;
@@ -56,6 +58,20 @@ void DrawAttributes::SetScale(float _x, float _y)
     scale_y = _y;
 }
 
+uint64_t DrawAttributes::ContentHash() const
+{
+    uint64_t hash = HashCombine(depth, x);
+    hash = HashCombine(hash, y);
+    hash = HashCombine(hash, origin_x);
+    hash = HashCombine(hash, origin_y);
+    hash = HashFloat(hash, scale_x);
+    hash = HashFloat(hash, scale_y);
+    hash = HashFloat(hash, rotation);
+    hash = HashFloat(hash, opacity);
+    hash = HashCombine(hash, blend_mode);
+    return HashCombine(hash, blend_color);
+}
+
 int ZDepthCompare(const DrawAttributes& a, const DrawAttributes& b)
 {
     return a.GetDepth() < b.GetDepth();
@@ -46,6 +46,11 @@ public:
     void SetBlendMode(uint32_t mode) { blend_mode = mode; }
     void SetBlendColor(uint32_t color) { blend_color = color; }
 
+    /** Hashes the draw attributes.
+      * @return 64 bit hash of the attributes.
+      */
+    uint64_t ContentHash() const;
+
 protected:
     /** Depth / Priority of how to draw the object */
     int32_t depth;
@@ -20,6 +20,8 @@
  ******************************************************************************************************/
 #include "Layer.hpp"
 
+#include "Hash.hpp"
+
 Layer::Layer(const std::string& _name, uint32_t width, uint32_t height, const std::vector<int32_t>& data, const DrawAttributes& attr)
     : DrawAttributes(attr), TiledLayerData(width, height, data), name(_name)
 {
@@ -34,3 +36,9 @@ Layer::Layer(const std::string& _name, uint32_t width, uint32_t height, const Dr
     : DrawAttributes(attr), TiledLayerData(width, height), name(_name)
 {
 }
+
+uint64_t Layer::ContentHash() const
+{
+    uint64_t hash = HashString(DrawAttributes::ContentHash(), name);
+    return HashCombine(hash, TiledLayerData::ContentHash());
+}
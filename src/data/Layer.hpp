@@ -57,6 +57,11 @@ public:
     std::string GetName() const { return name; }
     void SetName(const std::string& _name) { name = _name; }
 
+    /** Hashes the name, draw attributes and tile data of this layer.
+      * @return 64 bit hash of the layer contents.
+      */
+    uint64_t ContentHash() const;
+
 protected:
     /** Name for this layer */
     std::string name;
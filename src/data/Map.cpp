@@ -25,6 +25,8 @@
 #include <fstream>
 #include <cassert>
 
+#include "Hash.hpp"
+
 using namespace std;
 
 void Map::Clear()
@@ -103,3 +105,16 @@ uint32_t Map::GetHeight() const
     }
     return height;
 }
+
+uint64_t Map::ContentHash() const
+{
+    uint64_t hash = HashString(0, name);
+    hash = HashCombine(hash, tileset.ContentHash());
+    hash = HashCombine(hash, layers.size());
+    for (const auto& layer : layers)
+        hash = HashCombine(hash, layer.ContentHash());
+    hash = HashCombine(hash, backgrounds.size());
+    for (const auto& background : backgrounds)
+        hash = HashCombine(hash, background.ContentHash());
+    return HashCombine(hash, collision_layer ? collision_layer->ContentHash() : 0);
+}
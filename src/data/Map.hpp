@@ -97,6 +97,12 @@ public:
     void SetLayers(const std::vector<Layer>& _layers) { layers = _layers; }
     void SetBackgrounds(const std::vector<Background>& _backgrounds) { backgrounds = _backgrounds; }
     void SetCollisionLayer(CollisionLayer* layer) { collision_layer.reset(layer); }
+
+    /** Hashes everything that is saved with the map.
+      * Two maps with the same hash can be treated as identical, so tools can skip work on maps that haven't changed.
+      * @return 64 bit hash of the map contents.
+      */
+    uint64_t ContentHash() const;
 private:
     /** The name for this map */
     std::string name;
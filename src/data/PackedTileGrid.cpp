@@ -0,0 +1,274 @@
+/******************************************************************************************************
+ * Tile Map Editor
+ * Copyright (C) 2009-2017 Brandon Whitehead (tricksterguy87[AT]gmail[DOT]com)
+ *
+ * This software is provided 'as-is', without any express or implied warranty.
+ * In no event will the authors be held liable for any damages arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * excluding commercial applications, and to alter it and redistribute it freely,
+ * subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented;
+ *    you must not claim that you wrote the original software.
+ *    An acknowledgement in your documentation and link to the original version is required.
+ *
+ * 2. Altered source versions must be plainly marked as such,
+ *    and must not be misrepresented as being the original software.
+ *
+ * 3. This notice may not be removed or altered from any source distribution.
+ ******************************************************************************************************/
+#include "PackedTileGrid.hpp"
+
+#include <algorithm>
+#include <utility>
+
+#include "Hash.hpp"
+
+// Tile based layers only care if a tile is passable, direction based layers keep the direction bits.
+template <>
+uint32_t PackedTileGrid<1>::PackTile(int32_t value) { return value != 0; }
+
+template <>
+uint32_t PackedTileGrid<4>::PackTile(int32_t value) { return (uint32_t) value & 0xF; }
+
+template <>
+int32_t PackedTileGrid<1>::UnpackTile(uint32_t value) { return value ? -1 : 0; }
+
+template <>
+int32_t PackedTileGrid<4>::UnpackTile(uint32_t value) { return (int32_t) value; }
+
+template <uint32_t BITS>
+constexpr uint32_t PackedTileGrid<BITS>::MASK;
+
+template <uint32_t BITS>
+constexpr uint32_t PackedTileGrid<BITS>::PER_WORD;
+
+template <uint32_t BITS>
+PackedTileGrid<BITS>::PackedTileGrid(uint32_t _width, uint32_t _height) : width(_width), height(_height),
+    stride((_width + PER_WORD - 1) / PER_WORD), words(stride * _height, 0)
+{
+}
+
+template <uint32_t BITS>
+PackedTileGrid<BITS>::PackedTileGrid(const TiledLayerData& layer) : PackedTileGrid(layer.GetWidth(), layer.GetHeight())
+{
+    SetRows(0, height, layer.GetData().data());
+}
+
+template <uint32_t BITS>
+bool PackedTileGrid<BITS>::operator==(const PackedTileGrid& other) const
+{
+    return width == other.width && height == other.height && words == other.words;
+}
+
+template <uint32_t BITS>
+void PackedTileGrid<BITS>::Set(uint32_t x, uint32_t y, uint32_t value)
+{
+    if (x >= width || y >= height)
+        return;
+    uint64_t& word = words[y * stride + x / PER_WORD];
+    uint32_t shift = (x % PER_WORD) * BITS;
+    word = (word & ~((uint64_t) MASK << shift)) | ((uint64_t) (value & MASK) << shift);
+}
+
+template <uint32_t BITS>
+void PackedTileGrid<BITS>::Fill(uint32_t x, uint32_t y, uint32_t w, uint32_t h, uint32_t value)
+{
+    if (x >= width || y >= height)
+        return;
+    uint32_t x2 = x + std::min(w, width - x);
+    uint32_t y2 = y + std::min(h, height - y);
+    // Value repeated in every tile of a word.
+    uint64_t pattern = (~0ULL / MASK) * (value & MASK);
+
+    for (uint32_t j = y; j < y2; j++)
+    {
+        uint64_t* row = words.data() + j * stride;
+        for (uint32_t i = x; i < x2; i = (i / PER_WORD + 1) * PER_WORD)
+        {
+            uint32_t end = std::min(x2 - i / PER_WORD * PER_WORD, PER_WORD);
+            uint64_t mask = SpanMask(i % PER_WORD, end);
+            uint64_t& word = row[i / PER_WORD];
+            word = (word & ~mask) | (pattern & mask);
+        }
+    }
+}
+
+template <uint32_t BITS>
+bool PackedTileGrid<BITS>::Any(uint32_t x, uint32_t y, uint32_t w, uint32_t h) const
+{
+    if (x >= width || y >= height)
+        return false;
+    uint32_t x2 = x + std::min(w, width - x);
+    uint32_t y2 = y + std::min(h, height - y);
+
+    for (uint32_t j = y; j < y2; j++)
+    {
+        const uint64_t* row = words.data() + j * stride;
+        for (uint32_t i = x; i < x2; i = (i / PER_WORD + 1) * PER_WORD)
+        {
+            uint32_t end = std::min(x2 - i / PER_WORD * PER_WORD, PER_WORD);
+            if (row[i / PER_WORD] & SpanMask(i % PER_WORD, end))
+                return true;
+        }
+    }
+    return false;
+}
+
+template <uint32_t BITS>
+uint64_t PackedTileGrid<BITS>::Count() const
+{
+    uint64_t count = 0;
+    for (uint64_t word : words)
+        count += __builtin_popcountll(word);
+    return count;
+}
+
+template <uint32_t BITS>
+void PackedTileGrid<BITS>::Add(const PackedTileGrid& other)
+{
+    CheckSize(other);
+    for (uint32_t i = 0; i < words.size(); i++)
+        words[i] |= other.words[i];
+}
+
+template <uint32_t BITS>
+void PackedTileGrid<BITS>::Subtract(const PackedTileGrid& other)
+{
+    CheckSize(other);
+    for (uint32_t i = 0; i < words.size(); i++)
+        words[i] &= ~other.words[i];
+}
+
+template <uint32_t BITS>
+void PackedTileGrid<BITS>::Intersect(const PackedTileGrid& other)
+{
+    CheckSize(other);
+    for (uint32_t i = 0; i < words.size(); i++)
+        words[i] &= other.words[i];
+}
+
+template <uint32_t BITS>
+void PackedTileGrid<BITS>::Xor(const PackedTileGrid& other)
+{
+    CheckSize(other);
+    for (uint32_t i = 0; i < words.size(); i++)
+        words[i] ^= other.words[i];
+}
+
+template <uint32_t BITS>
+void PackedTileGrid<BITS>::Clear()
+{
+    std::fill(words.begin(), words.end(), 0);
+}
+
+template <uint32_t BITS>
+void PackedTileGrid<BITS>::SetRows(uint32_t row, uint32_t count, const int32_t* data)
+{
+    count = row < height ? std::min(count, height - row) : 0;
+    for (uint32_t j = row; j < row + count; j++)
+    {
+        uint64_t* dest = words.data() + j * stride;
+        for (uint32_t w = 0; w < stride; w++)
+        {
+            uint32_t begin = w * PER_WORD;
+            uint32_t end = std::min(begin + PER_WORD, width);
+            uint64_t word = 0;
+            for (uint32_t i = begin; i < end; i++)
+                word |= (uint64_t) PackTile(data[i]) << ((i - begin) * BITS);
+            dest[w] = word;
+        }
+        data += width;
+    }
+}
+
+template <uint32_t BITS>
+void PackedTileGrid<BITS>::GetRows(uint32_t row, uint32_t count, int32_t* data) const
+{
+    count = row < height ? std::min(count, height - row) : 0;
+    for (uint32_t j = row; j < row + count; j++)
+    {
+        const uint64_t* src = words.data() + j * stride;
+        for (uint32_t i = 0; i < width; i++)
+            data[i] = UnpackTile((src[i / PER_WORD] >> ((i % PER_WORD) * BITS)) & MASK);
+        data += width;
+    }
+}
+
+template <uint32_t BITS>
+void PackedTileGrid<BITS>::Unpack(TiledLayerData& layer) const
+{
+    layer.Resize(width, height, false);
+    GetRows(0, height, layer.GetData().data());
+}
+
+template <uint32_t BITS>
+void PackedTileGrid<BITS>::Resize(uint32_t new_width, uint32_t new_height, bool copy)
+{
+    if (new_width == width && new_height == height)
+        return;
+
+    PackedTileGrid resized(new_width, new_height);
+    resized.Fill(0, 0, new_width, new_height, MASK);
+    if (copy)
+    {
+        for (uint32_t y = 0; y < std::min(height, new_height); y++)
+            for (uint32_t x = 0; x < std::min(width, new_width); x++)
+                resized.Set(x, y, Get(x, y));
+    }
+    *this = std::move(resized);
+}
+
+template <uint32_t BITS>
+void PackedTileGrid<BITS>::Shift(int32_t horizontal, int32_t vertical, bool wrap)
+{
+    if ((horizontal == 0 && vertical == 0) || width == 0 || height == 0)
+        return;
+
+    PackedTileGrid shifted(width, height);
+    if (!wrap)
+        shifted.Fill(0, 0, width, height, MASK);
+    for (uint32_t y = 0; y < height; y++)
+    {
+        for (uint32_t x = 0; x < width; x++)
+        {
+            int64_t nx = (int64_t) x + horizontal;
+            int64_t ny = (int64_t) y + vertical;
+            if (wrap)
+            {
+                nx = (nx % width + width) % width;
+                ny = (ny % height + height) % height;
+            }
+            else if (nx < 0 || ny < 0 || nx >= width || ny >= height)
+            {
+                continue;
+            }
+            shifted.Set(nx, ny, Get(x, y));
+        }
+    }
+    words.swap(shifted.words);
+}
+
+template <uint32_t BITS>
+uint64_t PackedTileGrid<BITS>::ContentHash() const
+{
+    return XXHash64(words.data(), words.size() * sizeof(uint64_t), HashCombine(width, height));
+}
+
+template <uint32_t BITS>
+uint64_t PackedTileGrid<BITS>::SpanMask(uint32_t begin, uint32_t end)
+{
+    uint64_t high = end * BITS >= 64 ? ~0ULL : (1ULL << (end * BITS)) - 1;
+    return high & ~((1ULL << (begin * BITS)) - 1);
+}
+
+template <uint32_t BITS>
+void PackedTileGrid<BITS>::CheckSize(const PackedTileGrid& other) const
+{
+    if (width != other.width || height != other.height)
+        throw "Packed grids must be the same size";
+}
+
+template class PackedTileGrid<1>;
+template class PackedTileGrid<4>;
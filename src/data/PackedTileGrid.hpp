@@ -0,0 +1,178 @@
+/******************************************************************************************************
+ * Tile Map Editor
+ * Copyright (C) 2009-2017 Brandon Whitehead (tricksterguy87[AT]gmail[DOT]com)
+ *
+ * This software is provided 'as-is', without any express or implied warranty.
+ * In no event will the authors be held liable for any damages arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * excluding commercial applications, and to alter it and redistribute it freely,
+ * subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented;
+ *    you must not claim that you wrote the original software.
+ *    An acknowledgement in your documentation and link to the original version is required.
+ *
+ * 2. Altered source versions must be plainly marked as such,
+ *    and must not be misrepresented as being the original software.
+ *
+ * 3. This notice may not be removed or altered from any source distribution.
+ ******************************************************************************************************/
+#ifndef PACKED_TILE_GRID_HPP
+#define PACKED_TILE_GRID_HPP
+
+#include <cstdint>
+#include <vector>
+
+#include "TiledLayerData.hpp"
+
+/** Tile collision packed into a few bits per tile.
+  * Each row is a run of 64 bit words holding 64 / BITS tiles, tile x of a row is in word x / (64 / BITS)
+  * at bit (x % (64 / BITS)) * BITS. Rows start on a word so row and whole grid operations work a word at a time.
+  * BITS is 1 for tile based collision where a set bit is impassable, and 4 for direction based collision
+  * where the low four bits of each tile's bitvector are kept.
+  * Rows convert to and from the int32 rows the MTCL and MDCL chunks store so packed grids can be
+  * filled straight from a MapVisitor or written back out through a MapSource.
+  */
+template <uint32_t BITS>
+class PackedTileGrid
+{
+public:
+    /** Creates an empty grid.
+      * @param width Width in tiles.
+      * @param height Height in tiles.
+      */
+    PackedTileGrid(uint32_t width = 0, uint32_t height = 0);
+    /** Creates a grid from a tile based or direction based collision layer.
+      * @param layer Layer to pack.
+      */
+    PackedTileGrid(const TiledLayerData& layer);
+
+    bool operator==(const PackedTileGrid& other) const;
+    bool operator!=(const PackedTileGrid& other) const { return !(*this == other); }
+
+    /** Gets the packed value of a tile.
+      * @param x X coordinate.
+      * @param y Y coordinate.
+      * @return value of the tile, 0 if outside the grid.
+      */
+    uint32_t Get(uint32_t x, uint32_t y) const
+    {
+        if (x >= width || y >= height)
+            return 0;
+        return (words[y * stride + x / PER_WORD] >> ((x % PER_WORD) * BITS)) & MASK;
+    }
+    /** Sets the packed value of a tile, tiles outside the grid are ignored.
+      * @param x X coordinate.
+      * @param y Y coordinate.
+      * @param value Value to store, only the low BITS bits are kept.
+      */
+    void Set(uint32_t x, uint32_t y, uint32_t value);
+    /** Sets every tile in a rectangle, clipped to the grid.
+      * @param x Left of the rectangle.
+      * @param y Top of the rectangle.
+      * @param w Width of the rectangle.
+      * @param h Height of the rectangle.
+      * @param value Value to store.
+      */
+    void Fill(uint32_t x, uint32_t y, uint32_t w, uint32_t h, uint32_t value);
+    /** Tests if any tile in a rectangle is nonzero, clipped to the grid.
+      * @param x Left of the rectangle.
+      * @param y Top of the rectangle.
+      * @param w Width of the rectangle.
+      * @param h Height of the rectangle.
+      * @return true if any bit is set within the rectangle.
+      */
+    bool Any(uint32_t x, uint32_t y, uint32_t w, uint32_t h) const;
+    /** Counts the set bits in the grid, for BITS = 1 this is the number of impassable tiles.
+      * @return number of bits set.
+      */
+    uint64_t Count() const;
+
+    /** Ors another grid of the same size into this one */
+    void Add(const PackedTileGrid& other);
+    /** Clears the bits set in another grid of the same size */
+    void Subtract(const PackedTileGrid& other);
+    /** Ands another grid of the same size into this one */
+    void Intersect(const PackedTileGrid& other);
+    /** Xors another grid of the same size into this one */
+    void Xor(const PackedTileGrid& other);
+    /** Clears every tile keeping the size. */
+    void Clear();
+    /** Resizes the grid, new tiles are MASK which is what the null tile (-1) packs to.
+      * @param width New width in tiles.
+      * @param height New height in tiles.
+      * @param copy true to keep the tiles that are still inside the grid.
+      */
+    void Resize(uint32_t width, uint32_t height, bool copy = true);
+    /** Moves every tile, tiles moved off the grid are dropped and the tiles uncovered are MASK.
+      * @param horizontal Tiles to move right, negative moves left.
+      * @param vertical Tiles to move down, negative moves up.
+      * @param wrap true to wrap tiles moved off one edge around to the other.
+      */
+    void Shift(int32_t horizontal, int32_t vertical, bool wrap = false);
+    /** Hashes the dimensions and packed tiles.
+      * @return 64 bit hash of the grid.
+      */
+    uint64_t ContentHash() const;
+
+    /** Packs rows of collision data as read from a MTCL / MDCL chunk.
+      * @param row First row to set.
+      * @param count Number of rows.
+      * @param data count * width ints.
+      */
+    void SetRows(uint32_t row, uint32_t count, const int32_t* data);
+    /** Unpacks rows into the int32 form a MTCL / MDCL chunk stores.
+      * @param row First row to get.
+      * @param count Number of rows.
+      * @param data Output for count * width ints.
+      */
+    void GetRows(uint32_t row, uint32_t count, int32_t* data) const;
+    /** Unpacks the whole grid into a collision layer, resizing the layer to fit.
+      * @param layer Layer to fill.
+      */
+    void Unpack(TiledLayerData& layer) const;
+
+    uint32_t GetWidth() const { return width; }
+    uint32_t GetHeight() const { return height; }
+    /** Number of words in each row */
+    uint32_t GetStride() const { return stride; }
+    const uint64_t* GetRow(uint32_t y) const { return words.data() + y * stride; }
+
+    /** Bits stored for each tile */
+    static constexpr uint32_t MASK = (1u << BITS) - 1;
+    /** Tiles held in each word */
+    static constexpr uint32_t PER_WORD = 64 / BITS;
+
+    /** Converts a tile as a collision layer file stores it to its packed value.
+      * Tile based collision only keeps if the tile is impassable, direction based collision keeps the direction bits.
+      */
+    static uint32_t PackTile(int32_t value);
+    /** Converts a packed value back to what a collision layer file stores, -1 for impassable tiles */
+    static int32_t UnpackTile(uint32_t value);
+
+private:
+    /** Mask of the bits for tiles [begin, end) of the word holding tile begin */
+    static uint64_t SpanMask(uint32_t begin, uint32_t end);
+    /** Throws if other isn't the same size */
+    void CheckSize(const PackedTileGrid& other) const;
+
+    /** Dimensions in tiles */
+    uint32_t width, height;
+    /** Words per row */
+    uint32_t stride;
+    /** Rows of packed tiles */
+    std::vector<uint64_t> words;
+};
+
+template <> uint32_t PackedTileGrid<1>::PackTile(int32_t value);
+template <> uint32_t PackedTileGrid<4>::PackTile(int32_t value);
+template <> int32_t PackedTileGrid<1>::UnpackTile(uint32_t value);
+template <> int32_t PackedTileGrid<4>::UnpackTile(uint32_t value);
+
+/** One bit per tile, set if impassable */
+typedef PackedTileGrid<1> PackedTileCollision;
+/** Four bits per tile holding the directions allowed */
+typedef PackedTileGrid<4> PackedDirectionCollision;
+
+#endif
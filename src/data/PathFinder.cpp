@@ -0,0 +1,274 @@
+/******************************************************************************************************
+ * Tile Map Editor
+ * Copyright (C) 2009-2017 Brandon Whitehead (tricksterguy87[AT]gmail[DOT]com)
+ *
+ * This software is provided 'as-is', without any express or implied warranty.
+ * In no event will the authors be held liable for any damages arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * excluding commercial applications, and to alter it and redistribute it freely,
+ * subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented;
+ *    you must not claim that you wrote the original software.
+ *    An acknowledgement in your documentation and link to the original version is required.
+ *
+ * 2. Altered source versions must be plainly marked as such,
+ *    and must not be misrepresented as being the original software.
+ *
+ * 3. This notice may not be removed or altered from any source distribution.
+ ******************************************************************************************************/
+#include "PathFinder.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+
+#include "DirectionBasedCollisionLayer.hpp"
+
+namespace
+{
+
+const uint32_t NO_BUCKET = 0xFFFFFFFF;
+
+int32_t Sign(int32_t value)
+{
+    return (value > 0) - (value < 0);
+}
+
+}
+
+PathFinder::PathFinder(const PathGrid& _grid) : grid(_grid), generation(0), first_bucket(NO_BUCKET), last_bucket(0), expanded(0)
+{
+    Reset(grid.GetWidth() * grid.GetHeight());
+}
+
+bool PathFinder::FindPath(uint32_t sx, uint32_t sy, uint32_t gx, uint32_t gy, Path& path, Algorithm algorithm)
+{
+    path.clear();
+    uint32_t width = grid.GetWidth();
+    uint32_t height = grid.GetHeight();
+    if (sx >= width || sy >= height || gx >= width || gy >= height)
+        return false;
+    if (!Search(sy * width + sx, gy * width + gx, 0, 0, width, height, algorithm))
+        return false;
+    BuildPath(gy * width + gx, path);
+    return true;
+}
+
+bool PathFinder::FindPath(uint32_t sx, uint32_t sy, uint32_t gx, uint32_t gy, const Rectangle& bounds, Path& path)
+{
+    path.clear();
+    int32_t x1, y1, x2, y2;
+    bounds.GetCoords(x1, y1, x2, y2);
+    x1 = std::max(x1, 0);
+    y1 = std::max(y1, 0);
+    x2 = std::min(x2, (int32_t) grid.GetWidth());
+    y2 = std::min(y2, (int32_t) grid.GetHeight());
+    auto inside = [=](int32_t x, int32_t y) { return x >= x1 && x < x2 && y >= y1 && y < y2; };
+    if (!inside(sx, sy) || !inside(gx, gy))
+        return false;
+
+    uint32_t width = grid.GetWidth();
+    if (!Search(sy * width + sx, gy * width + gx, x1, y1, x2, y2, AStar))
+        return false;
+    BuildPath(gy * width + gx, path);
+    return true;
+}
+
+void PathFinder::Reset(uint32_t count)
+{
+    if (first_bucket != NO_BUCKET)
+    {
+        for (uint32_t i = first_bucket; i <= last_bucket; i++)
+            buckets[i].clear();
+    }
+    first_bucket = NO_BUCKET;
+    last_bucket = 0;
+    expanded = 0;
+
+    if (cost.size() < count)
+    {
+        cost.resize(count);
+        parent.resize(count);
+        seen.resize(count, 0);
+        closed.resize(count, 0);
+    }
+    if (++generation == 0)
+    {
+        std::fill(seen.begin(), seen.end(), 0);
+        std::fill(closed.begin(), closed.end(), 0);
+        generation = 1;
+    }
+}
+
+void PathFinder::Push(uint32_t node, uint32_t f)
+{
+    if (f >= buckets.size())
+        buckets.resize(f + 1);
+    buckets[f].push_back(node);
+    first_bucket = std::min(first_bucket, f);
+    last_bucket = std::max(last_bucket, f);
+}
+
+bool PathFinder::Pop(uint32_t& node)
+{
+    for (; first_bucket != NO_BUCKET && first_bucket <= last_bucket; first_bucket++)
+    {
+        // Nodes are left in the buckets when a cheaper way to them is found, they are closed by the time they come up.
+        std::vector<uint32_t>& bucket = buckets[first_bucket];
+        while (!bucket.empty())
+        {
+            node = bucket.back();
+            bucket.pop_back();
+            if (closed[node] != generation)
+                return true;
+        }
+    }
+    first_bucket = NO_BUCKET;
+    last_bucket = 0;
+    return false;
+}
+
+bool PathFinder::Search(uint32_t start, uint32_t goal, int32_t x1, int32_t y1, int32_t x2, int32_t y2, Algorithm algorithm)
+{
+    const uint32_t width = grid.GetWidth();
+    const bool jump = algorithm == JumpPoint && grid.IsTileBased();
+    Reset(width * grid.GetHeight());
+    if (!grid.IsOpen(start % width, start / width) || !grid.IsOpen(goal % width, goal / width))
+        return false;
+
+    Relax(start, 0, start, Distance(start, goal));
+    uint32_t node;
+    while (Pop(node))
+    {
+        closed[node] = generation;
+        expanded++;
+        if (node == goal)
+            return true;
+
+        int32_t x = node % width;
+        int32_t y = node / width;
+        if (!jump)
+        {
+            for (uint32_t d = 0; d < 4; d++)
+            {
+                if (!grid.CanMove(node, d))
+                    continue;
+                int32_t nx = x + PathGrid::STEP_X[d];
+                int32_t ny = y + PathGrid::STEP_Y[d];
+                if (nx < x1 || nx >= x2 || ny < y1 || ny >= y2)
+                    continue;
+                uint32_t next = ny * width + nx;
+                Relax(next, cost[node] + 1, node, Distance(next, goal));
+            }
+            continue;
+        }
+
+        // Paths move horizontally first so after a horizontal move every direction but back is natural,
+        // after a vertical move only going on is unless a wall behind the tile forces a turn.
+        uint32_t directions = 0xF;
+        if (parent[node] != node)
+        {
+            int32_t px = parent[node] % width;
+            int32_t py = parent[node] / width;
+            if (py == y)
+            {
+                uint32_t forward = x > px ? DirectionBasedCollisionLayer::East : DirectionBasedCollisionLayer::West;
+                directions = (1 << forward) | (1 << DirectionBasedCollisionLayer::North) | (1 << DirectionBasedCollisionLayer::South);
+            }
+            else
+            {
+                int32_t dy = Sign(y - py);
+                directions = 1 << (dy > 0 ? DirectionBasedCollisionLayer::South : DirectionBasedCollisionLayer::North);
+                if (grid.IsOpen(x - 1, y) && !grid.IsOpen(x - 1, y - dy))
+                    directions |= 1 << DirectionBasedCollisionLayer::West;
+                if (grid.IsOpen(x + 1, y) && !grid.IsOpen(x + 1, y - dy))
+                    directions |= 1 << DirectionBasedCollisionLayer::East;
+            }
+        }
+
+        for (uint32_t d = 0; d < 4; d++)
+        {
+            uint32_t next;
+            if (((directions >> d) & 1) && Jump(x, y, d, goal, next))
+                Relax(next, cost[node] + Distance(node, next), node, Distance(next, goal));
+        }
+    }
+
+    return false;
+}
+
+bool PathFinder::Jump(int32_t x, int32_t y, uint32_t direction, uint32_t goal, uint32_t& jump) const
+{
+    const int32_t width = grid.GetWidth();
+    const int32_t dx = PathGrid::STEP_X[direction];
+    if (dx == 0)
+    {
+        int32_t row;
+        if (!JumpVertical(x, y, PathGrid::STEP_Y[direction], goal, row))
+            return false;
+        jump = row * width + x;
+        return true;
+    }
+
+    // A tile on a horizontal run is a jump point if a vertical jump from it finds one.
+    int32_t row;
+    while (true)
+    {
+        x += dx;
+        if (!grid.IsOpen(x, y))
+            return false;
+        uint32_t index = y * width + x;
+        if (index == goal || JumpVertical(x, y, -1, goal, row) || JumpVertical(x, y, 1, goal, row))
+        {
+            jump = index;
+            return true;
+        }
+    }
+}
+
+bool PathFinder::JumpVertical(int32_t x, int32_t y, int32_t dy, uint32_t goal, int32_t& jump) const
+{
+    const int32_t width = grid.GetWidth();
+    while (true)
+    {
+        y += dy;
+        if (!grid.IsOpen(x, y))
+            return false;
+        // A tile is forced when one beside it opens up after being walled off beside the previous tile.
+        if ((uint32_t) (y * width + x) == goal ||
+            (grid.IsOpen(x - 1, y) && !grid.IsOpen(x - 1, y - dy)) ||
+            (grid.IsOpen(x + 1, y) && !grid.IsOpen(x + 1, y - dy)))
+        {
+            jump = y;
+            return true;
+        }
+    }
+}
+
+void PathFinder::BuildPath(uint32_t goal, Path& path) const
+{
+    const int32_t width = grid.GetWidth();
+    int32_t x = goal % width;
+    int32_t y = goal / width;
+    path.push_back(std::make_pair(x, y));
+    for (uint32_t node = goal; parent[node] != node; node = parent[node])
+    {
+        int32_t px = parent[node] % width;
+        int32_t py = parent[node] / width;
+        // Jump points are joined by straight lines.
+        while (x != px || y != py)
+        {
+            x += Sign(px - x);
+            y += Sign(py - y);
+            path.push_back(std::make_pair(x, y));
+        }
+    }
+    std::reverse(path.begin(), path.end());
+}
+
+uint32_t PathFinder::Distance(uint32_t a, uint32_t b) const
+{
+    const int32_t width = grid.GetWidth();
+    return abs((int32_t) (a % width) - (int32_t) (b % width)) + abs((int32_t) (a / width) - (int32_t) (b / width));
+}
@@ -0,0 +1,137 @@
+/******************************************************************************************************
+ * Tile Map Editor
+ * Copyright (C) 2009-2017 Brandon Whitehead (tricksterguy87[AT]gmail[DOT]com)
+ *
+ * This software is provided 'as-is', without any express or implied warranty.
+ * In no event will the authors be held liable for any damages arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * excluding commercial applications, and to alter it and redistribute it freely,
+ * subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented;
+ *    you must not claim that you wrote the original software.
+ *    An acknowledgement in your documentation and link to the original version is required.
+ *
+ * 2. Altered source versions must be plainly marked as such,
+ *    and must not be misrepresented as being the original software.
+ *
+ * 3. This notice may not be removed or altered from any source distribution.
+ ******************************************************************************************************/
+#ifndef PATH_FINDER_HPP
+#define PATH_FINDER_HPP
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "PathGrid.hpp"
+#include "Rectangle.hpp"
+
+/** Finds shortest paths on a PathGrid with A* or jump point search.
+  * All search state lives in arrays sized to the grid that are allocated once and reused by every search,
+  * a generation number marks which entries belong to the current search so nothing is cleared between searches.
+  * The open list is a bucketed priority queue indexed by f = cost + Manhattan distance, which only ever grows
+  * during a search so popping is amortized O(1).
+  * A PathFinder is not thread safe, give each thread its own sharing the same PathGrid.
+  */
+class PathFinder
+{
+public:
+    enum Algorithm
+    {
+        /** A* visiting every neighbour, works on any grid */
+        AStar = 0,
+        /** Jump point search for 4-connected grids, only expands tiles where the path can turn.
+          * Used on tile based grids, other grids fall back to A*.
+          */
+        JumpPoint = 1,
+    };
+    /** Tiles (x, y) along a path including both ends */
+    typedef std::vector<std::pair<int32_t, int32_t>> Path;
+
+    /** Creates a path finder for a grid, the grid must outlive it.
+      * @param grid Grid to search.
+      */
+    PathFinder(const PathGrid& grid);
+
+    /** Finds a shortest path between two tiles.
+      * @param sx X coordinate of the start.
+      * @param sy Y coordinate of the start.
+      * @param gx X coordinate of the goal.
+      * @param gy Y coordinate of the goal.
+      * @param path Set to the path if one is found.
+      * @param algorithm Search algorithm to use.
+      * @return true if the goal can be reached.
+      */
+    bool FindPath(uint32_t sx, uint32_t sy, uint32_t gx, uint32_t gy, Path& path, Algorithm algorithm = AStar);
+    /** Finds a shortest path between two tiles that stays within a rectangle using A*.
+      * @param bounds Tiles the path may use.
+      * @see FindPath
+      */
+    bool FindPath(uint32_t sx, uint32_t sy, uint32_t gx, uint32_t gy, const Rectangle& bounds, Path& path);
+
+    /** Number of nodes expanded by the last search */
+    uint32_t GetExpanded() const { return expanded; }
+    const PathGrid& GetGrid() const { return grid; }
+
+private:
+    friend class PathHierarchy;
+
+    /** Starts a new search invalidating every node.
+      * @param count Number of nodes the search will use.
+      */
+    void Reset(uint32_t count);
+    /** Updates a node if the cost given is better than the one it has, adding it to the open list.
+      * @return true if the node was updated.
+      */
+    bool Relax(uint32_t node, uint32_t node_cost, uint32_t from, uint32_t heuristic)
+    {
+        if (seen[node] == generation && cost[node] <= node_cost)
+            return false;
+        seen[node] = generation;
+        cost[node] = node_cost;
+        parent[node] = from;
+        Push(node, node_cost + heuristic);
+        return true;
+    }
+    /** Adds a node to the bucket for f */
+    void Push(uint32_t node, uint32_t f);
+    /** Removes the open node with the lowest f, skipping closed nodes.
+      * @return false if no open nodes are left.
+      */
+    bool Pop(uint32_t& node);
+    /** Runs A* or jump point search within [x1, x2) x [y1, y2) */
+    bool Search(uint32_t start, uint32_t goal, int32_t x1, int32_t y1, int32_t x2, int32_t y2, Algorithm algorithm);
+    /** Jumps from a tile in a direction.
+      * @param jump Set to the tile index of the jump point.
+      * @return true if a jump point was found.
+      */
+    bool Jump(int32_t x, int32_t y, uint32_t direction, uint32_t goal, uint32_t& jump) const;
+    /** Jumps vertically from a tile.
+      * @param dy -1 for north, 1 for south.
+      * @param jump Set to the row of the jump point.
+      * @return true if a jump point was found.
+      */
+    bool JumpVertical(int32_t x, int32_t y, int32_t dy, uint32_t goal, int32_t& jump) const;
+    /** Walks the parents back from the goal filling in the tiles between jump points */
+    void BuildPath(uint32_t goal, Path& path) const;
+    /** Manhattan distance between two tiles */
+    uint32_t Distance(uint32_t a, uint32_t b) const;
+
+    const PathGrid& grid;
+    /** Cost from the start, the node it was reached from, and the generation it was last seen and closed */
+    std::vector<uint32_t> cost, parent, seen, closed;
+    uint32_t generation;
+    /** Open nodes bucketed by f */
+    std::vector<std::vector<uint32_t>> buckets;
+    /** Range of buckets that may be nonempty, first is UINT32_MAX if none are */
+    uint32_t first_bucket, last_bucket;
+    /** Scratch space reused by PathHierarchy queries */
+    std::vector<uint32_t> queue, route;
+    std::vector<std::pair<uint32_t, uint32_t>> start_edges, goal_edges;
+    Path segment;
+    uint32_t expanded;
+};
+
+#endif
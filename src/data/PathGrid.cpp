@@ -0,0 +1,95 @@
+/******************************************************************************************************
+ * Tile Map Editor
+ * Copyright (C) 2009-2017 Brandon Whitehead (tricksterguy87[AT]gmail[DOT]com)
+ *
+ * This software is provided 'as-is', without any express or implied warranty.
+ * In no event will the authors be held liable for any damages arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * excluding commercial applications, and to alter it and redistribute it freely,
+ * subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented;
+ *    you must not claim that you wrote the original software.
+ *    An acknowledgement in your documentation and link to the original version is required.
+ *
+ * 2. Altered source versions must be plainly marked as such,
+ *    and must not be misrepresented as being the original software.
+ *
+ * 3. This notice may not be removed or altered from any source distribution.
+ ******************************************************************************************************/
+#include "PathGrid.hpp"
+
+#include <algorithm>
+
+#include "DirectionBasedCollisionLayer.hpp"
+#include "TileBasedCollisionLayer.hpp"
+
+const int32_t PathGrid::STEP_X[4] = {0, 1, 0, -1};
+const int32_t PathGrid::STEP_Y[4] = {-1, 0, 1, 0};
+constexpr uint8_t PathGrid::OPEN;
+
+PathGrid::PathGrid(const CollisionLayer& layer) : width(0), height(0), tile_based(false)
+{
+    Update(layer, Rectangle(0, 0, TiledLayerData::MAX_SIZE, TiledLayerData::MAX_SIZE));
+}
+
+void PathGrid::Update(const CollisionLayer& layer, const Rectangle& area)
+{
+    if (layer.GetType() != CollisionLayer::TileBased && layer.GetType() != CollisionLayer::DirectionBased)
+        throw "Paths can only be found on tile or direction based collision layers";
+
+    const TiledCollisionLayer& data = dynamic_cast<const TiledCollisionLayer&>(layer);
+    int32_t x1, y1, x2, y2;
+    area.GetCoords(x1, y1, x2, y2);
+    if (data.GetWidth() != width || data.GetHeight() != height)
+    {
+        width = data.GetWidth();
+        height = data.GetHeight();
+        tiles.assign(width * height, 0);
+        x1 = y1 = 0;
+        x2 = width;
+        y2 = height;
+    }
+    tile_based = layer.GetType() == CollisionLayer::TileBased;
+    Compute(layer, std::max(x1, 0), std::max(y1, 0), std::min(x2, (int32_t) width), std::min(y2, (int32_t) height));
+}
+
+void PathGrid::Compute(const CollisionLayer& layer, int32_t x1, int32_t y1, int32_t x2, int32_t y2)
+{
+    if (x1 >= x2 || y1 >= y2)
+        return;
+
+    // Tiles are read straight from the packed grids, a set bit is blocked for tile based collision.
+    const TileBasedCollisionLayer* blocked = dynamic_cast<const TileBasedCollisionLayer*>(&layer);
+    const DirectionBasedCollisionLayer* directions = dynamic_cast<const DirectionBasedCollisionLayer*>(&layer);
+    for (int32_t y = y1; y < y2; y++)
+    {
+        for (int32_t x = x1; x < x2; x++)
+        {
+            bool open = blocked ? blocked->GetGrid().Get(x, y) == 0 : directions->GetGrid().Get(x, y) != 0;
+            tiles[y * width + x] = open ? OPEN : 0;
+        }
+    }
+
+    // Moves out of the tiles next to the area depend on the tiles in it.
+    x1 = std::max(x1 - 1, 0);
+    y1 = std::max(y1 - 1, 0);
+    x2 = std::min(x2 + 1, (int32_t) width);
+    y2 = std::min(y2 + 1, (int32_t) height);
+    for (int32_t y = y1; y < y2; y++)
+    {
+        for (int32_t x = x1; x < x2; x++)
+        {
+            uint8_t& tile = tiles[y * width + x];
+            tile &= OPEN;
+            for (uint32_t d = 0; d < 4; d++)
+            {
+                bool move = directions ? directions->CanMove(x, y, static_cast<DirectionBasedCollisionLayer::Direction>(d)) :
+                                         (tile & OPEN) && IsOpen(x + STEP_X[d], y + STEP_Y[d]);
+                if (move)
+                    tile |= 1 << d;
+            }
+        }
+    }
+}
@@ -0,0 +1,95 @@
+/******************************************************************************************************
+ * Tile Map Editor
+ * Copyright (C) 2009-2017 Brandon Whitehead (tricksterguy87[AT]gmail[DOT]com)
+ *
+ * This software is provided 'as-is', without any express or implied warranty.
+ * In no event will the authors be held liable for any damages arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * excluding commercial applications, and to alter it and redistribute it freely,
+ * subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented;
+ *    you must not claim that you wrote the original software.
+ *    An acknowledgement in your documentation and link to the original version is required.
+ *
+ * 2. Altered source versions must be plainly marked as such,
+ *    and must not be misrepresented as being the original software.
+ *
+ * 3. This notice may not be removed or altered from any source distribution.
+ ******************************************************************************************************/
+#ifndef PATH_GRID_HPP
+#define PATH_GRID_HPP
+
+#include <cstdint>
+#include <vector>
+
+#include "CollisionLayer.hpp"
+#include "Rectangle.hpp"
+
+/** Movement graph of a tile or direction based collision layer used for pathfinding.
+  * Each tile stores the directions that can be taken out of it as bits 0 - 3 in the order of
+  * DirectionBasedCollisionLayer::Direction (north, east, south, west) and bit 4 is set if the tile is open.
+  * Movement is 4-connected with a cost of 1 per step.
+  * The grid is a snapshot, call Update with the tiles edited after the collision layer changes.
+  */
+class PathGrid
+{
+public:
+    /** Creates an empty grid. */
+    PathGrid() : width(0), height(0), tile_based(false) {}
+    /** Creates the grid for a collision layer.
+      * Tile based layers can move between any two open tiles, direction based layers follow
+      * DirectionBasedCollisionLayer::CanMove. Pixel based layers aren't supported.
+      * @param layer Layer to build the grid from.
+      */
+    PathGrid(const CollisionLayer& layer);
+
+    /** Brings part of the grid up to date after tiles of the collision layer were edited.
+      * The whole grid is rebuilt if the layer was resized.
+      * @param layer Layer the grid was built from.
+      * @param area Tiles that were edited.
+      */
+    void Update(const CollisionLayer& layer, const Rectangle& area);
+
+    uint32_t GetWidth() const { return width; }
+    uint32_t GetHeight() const { return height; }
+    /** Tests if a step can be taken.
+      * @param index Tile index, y * width + x.
+      * @param direction Direction to step in.
+      * @return true if the step stays in the grid and is allowed.
+      */
+    bool CanMove(uint32_t index, uint32_t direction) const { return (tiles[index] >> direction) & 1; }
+    /** Tests if a tile is open, tiles outside the grid aren't.
+      * @param x X coordinate.
+      * @param y Y coordinate.
+      * @return true if the tile can be stood on.
+      */
+    bool IsOpen(int32_t x, int32_t y) const
+    {
+        if ((uint32_t) x >= width || (uint32_t) y >= height)
+            return false;
+        return tiles[y * width + x] & OPEN;
+    }
+    /** Tests if moves only depend on which tiles are open, which jump point search relies on. */
+    bool IsTileBased() const { return tile_based; }
+
+    /** Horizontal and vertical step of each direction */
+    static const int32_t STEP_X[4];
+    static const int32_t STEP_Y[4];
+    /** Bit set for open tiles */
+    static constexpr uint8_t OPEN = 0x10;
+
+private:
+    /** Recomputes which tiles in [x1, x2) x [y1, y2) are open and the moves of the tiles in and around it */
+    void Compute(const CollisionLayer& layer, int32_t x1, int32_t y1, int32_t x2, int32_t y2);
+
+    /** Dimensions in tiles */
+    uint32_t width, height;
+    /** Allowed moves and OPEN for each tile */
+    std::vector<uint8_t> tiles;
+    /** Set if built from a tile based layer */
+    bool tile_based;
+};
+
+#endif
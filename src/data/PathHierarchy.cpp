@@ -0,0 +1,294 @@
+/******************************************************************************************************
+ * Tile Map Editor
+ * Copyright (C) 2009-2017 Brandon Whitehead (tricksterguy87[AT]gmail[DOT]com)
+ *
+ * This software is provided 'as-is', without any express or implied warranty.
+ * In no event will the authors be held liable for any damages arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * excluding commercial applications, and to alter it and redistribute it freely,
+ * subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented;
+ *    you must not claim that you wrote the original software.
+ *    An acknowledgement in your documentation and link to the original version is required.
+ *
+ * 2. Altered source versions must be plainly marked as such,
+ *    and must not be misrepresented as being the original software.
+ *
+ * 3. This notice may not be removed or altered from any source distribution.
+ ******************************************************************************************************/
+#include "PathHierarchy.hpp"
+
+#include <algorithm>
+
+#include "DirectionBasedCollisionLayer.hpp"
+
+constexpr uint32_t PathHierarchy::DEFAULT_CLUSTER_SIZE;
+constexpr uint32_t PathHierarchy::LONG_ENTRANCE;
+
+PathHierarchy::PathHierarchy(const PathGrid& _grid, uint32_t _cluster_size) : grid(_grid), cluster_size(_cluster_size)
+{
+    if (cluster_size == 0)
+        throw "Cluster size must be non-zero";
+
+    const uint32_t width = grid.GetWidth();
+    const uint32_t height = grid.GetHeight();
+    clusters_wide = (width + cluster_size - 1) / cluster_size;
+    clusters_high = (height + cluster_size - 1) / cluster_size;
+
+    std::vector<int32_t> node_of(width * height, -1);
+    std::vector<std::pair<uint32_t, Edge>> links;
+    for (uint32_t cx = 1; cx < clusters_wide; cx++)
+    {
+        uint32_t x = cx * cluster_size - 1;
+        for (uint32_t y = 0; y < height; y += cluster_size)
+            AddEntrances(y * width + x, width, std::min(cluster_size, height - y), DirectionBasedCollisionLayer::East, node_of, links);
+    }
+    for (uint32_t cy = 1; cy < clusters_high; cy++)
+    {
+        uint32_t y = cy * cluster_size - 1;
+        for (uint32_t x = 0; x < width; x += cluster_size)
+            AddEntrances(y * width + x, 1, std::min(cluster_size, width - x), DirectionBasedCollisionLayer::South, node_of, links);
+    }
+
+    const uint32_t clusters = clusters_wide * clusters_high;
+    first_node.assign(clusters + 1, 0);
+    for (uint32_t tile : node_tiles)
+        first_node[GetCluster(tile) + 1]++;
+    for (uint32_t i = 0; i < clusters; i++)
+        first_node[i + 1] += first_node[i];
+    cluster_nodes.resize(node_tiles.size());
+    std::vector<uint32_t> next(first_node.begin(), first_node.end() - 1);
+    for (uint32_t i = 0; i < node_tiles.size(); i++)
+        cluster_nodes[next[GetCluster(node_tiles[i])]++] = i;
+
+    // Join the entrances of each cluster.
+    PathFinder finder(grid);
+    std::vector<std::pair<uint32_t, uint32_t>> distances;
+    for (uint32_t i = 0; i < node_tiles.size(); i++)
+    {
+        ClusterDistances(finder, node_tiles[i], false, distances);
+        for (const auto& distance : distances)
+        {
+            if (distance.first != i)
+                links.push_back(std::make_pair(i, Edge{distance.first, distance.second}));
+        }
+    }
+
+    first_edge.assign(node_tiles.size() + 1, 0);
+    for (const auto& link : links)
+        first_edge[link.first + 1]++;
+    for (uint32_t i = 0; i < node_tiles.size(); i++)
+        first_edge[i + 1] += first_edge[i];
+    edges.resize(links.size());
+    next.assign(first_edge.begin(), first_edge.end() - 1);
+    for (const auto& link : links)
+        edges[next[link.first]++] = link.second;
+}
+
+bool PathHierarchy::FindPath(PathFinder& finder, uint32_t sx, uint32_t sy, uint32_t gx, uint32_t gy, PathFinder::Path& path) const
+{
+    path.clear();
+    const uint32_t width = grid.GetWidth();
+    if (!grid.IsOpen(sx, sy) || !grid.IsOpen(gx, gy))
+        return false;
+
+    const uint32_t start = sy * width + sx;
+    const uint32_t goal = gy * width + gx;
+    const uint32_t goal_cluster = GetCluster(goal);
+    if (GetCluster(start) == goal_cluster && finder.FindPath(sx, sy, gx, gy, GetClusterBounds(goal_cluster), path))
+        return true;
+
+    ClusterDistances(finder, start, false, finder.start_edges);
+    ClusterDistances(finder, goal, true, finder.goal_edges);
+
+    // Search the graph with the start and goal added as two extra nodes.
+    const uint32_t start_node = node_tiles.size();
+    const uint32_t goal_node = start_node + 1;
+    finder.Reset(goal_node + 1);
+    finder.Relax(start_node, 0, start_node, finder.Distance(start, goal));
+    uint32_t node;
+    bool found = false;
+    while (!found && finder.Pop(node))
+    {
+        finder.closed[node] = finder.generation;
+        finder.expanded++;
+        if (node == goal_node)
+        {
+            found = true;
+        }
+        else if (node == start_node)
+        {
+            for (const auto& edge : finder.start_edges)
+                finder.Relax(edge.first, edge.second, node, finder.Distance(node_tiles[edge.first], goal));
+        }
+        else
+        {
+            uint32_t node_cost = finder.cost[node];
+            for (uint32_t i = first_edge[node]; i < first_edge[node + 1]; i++)
+                finder.Relax(edges[i].to, node_cost + edges[i].cost, node, finder.Distance(node_tiles[edges[i].to], goal));
+            if (GetCluster(node_tiles[node]) != goal_cluster)
+                continue;
+            for (const auto& edge : finder.goal_edges)
+            {
+                if (edge.first == node)
+                    finder.Relax(goal_node, node_cost + edge.second, node, 0);
+            }
+        }
+    }
+    if (!found)
+        return false;
+
+    std::vector<uint32_t>& route = finder.route;
+    route.clear();
+    route.push_back(goal);
+    for (node = finder.parent[goal_node]; node != start_node; node = finder.parent[node])
+        route.push_back(node_tiles[node]);
+    route.push_back(start);
+    std::reverse(route.begin(), route.end());
+
+    // Fill in the path, entrances in different clusters are neighbours and the rest are joined by a search in their cluster.
+    path.push_back(std::make_pair(sx, sy));
+    for (uint32_t i = 1; i < route.size(); i++)
+    {
+        uint32_t from = route[i - 1];
+        uint32_t to = route[i];
+        uint32_t cluster = GetCluster(from);
+        if (cluster != GetCluster(to))
+        {
+            path.push_back(std::make_pair(to % width, to / width));
+        }
+        else if (from != to)
+        {
+            if (!finder.FindPath(from % width, from / width, to % width, to / width, GetClusterBounds(cluster), finder.segment))
+                return false;
+            path.insert(path.end(), finder.segment.begin() + 1, finder.segment.end());
+        }
+    }
+    return true;
+}
+
+void PathHierarchy::AddEntrances(uint32_t first, uint32_t step, uint32_t length, uint32_t across, std::vector<int32_t>& node_of,
+                                 std::vector<std::pair<uint32_t, Edge>>& links)
+{
+    const uint32_t offset = across == DirectionBasedCollisionLayer::East ? 1 : grid.GetWidth();
+    const uint32_t back = (across + 2) % 4;
+    const uint32_t along = step == 1 ? DirectionBasedCollisionLayer::East : DirectionBasedCollisionLayer::South;
+    // On direction based grids the tiles of a stretch may not reach each other, so one entrance can't stand in for them all.
+    auto joined = [&](uint32_t tile)
+    {
+        return grid.CanMove(tile, along) && grid.CanMove(tile + step, (along + 2) % 4);
+    };
+
+    // Bit 0 is set if the border can be crossed forwards and bit 1 if it can be crossed back.
+    uint32_t run_start = 0;
+    uint32_t run_crossings = 0;
+    auto add = [&](uint32_t i)
+    {
+        uint32_t near = GetNode(first + i * step, node_of);
+        uint32_t far = GetNode(first + i * step + offset, node_of);
+        if (run_crossings & 1)
+            links.push_back(std::make_pair(near, Edge{far, 1}));
+        if (run_crossings & 2)
+            links.push_back(std::make_pair(far, Edge{near, 1}));
+    };
+
+    for (uint32_t i = 0; i <= length; i++)
+    {
+        uint32_t crossings = 0;
+        bool split = false;
+        if (i < length)
+        {
+            uint32_t tile = first + i * step;
+            crossings = (grid.CanMove(tile, across) ? 1 : 0) | (grid.CanMove(tile + offset, back) ? 2 : 0);
+            // Neighbours along the border that can't step to each other on both sides start a new stretch.
+            split = i > 0 && !(joined(tile - step) && joined(tile - step + offset));
+        }
+        if (crossings == run_crossings && !split)
+            continue;
+
+        if (run_crossings)
+        {
+            if (i - run_start >= LONG_ENTRANCE)
+            {
+                add(run_start);
+                add(i - 1);
+            }
+            else
+            {
+                add((run_start + i - 1) / 2);
+            }
+        }
+        run_start = i;
+        run_crossings = crossings;
+    }
+}
+
+uint32_t PathHierarchy::GetNode(uint32_t tile, std::vector<int32_t>& node_of)
+{
+    if (node_of[tile] < 0)
+    {
+        node_of[tile] = node_tiles.size();
+        node_tiles.push_back(tile);
+    }
+    return node_of[tile];
+}
+
+void PathHierarchy::ClusterDistances(PathFinder& finder, uint32_t tile, bool reverse, std::vector<std::pair<uint32_t, uint32_t>>& distances) const
+{
+    const uint32_t width = grid.GetWidth();
+    const uint32_t cluster = GetCluster(tile);
+    int32_t x1, y1, x2, y2;
+    GetClusterBounds(cluster).GetCoords(x1, y1, x2, y2);
+    x2 = std::min(x2, (int32_t) width);
+    y2 = std::min(y2, (int32_t) grid.GetHeight());
+
+    finder.Reset(width * grid.GetHeight());
+    std::vector<uint32_t>& queue = finder.queue;
+    queue.clear();
+    queue.push_back(tile);
+    finder.seen[tile] = finder.generation;
+    finder.cost[tile] = 0;
+    for (uint32_t head = 0; head < queue.size(); head++)
+    {
+        uint32_t current = queue[head];
+        int32_t x = current % width;
+        int32_t y = current / width;
+        for (uint32_t d = 0; d < 4; d++)
+        {
+            int32_t nx = x + PathGrid::STEP_X[d];
+            int32_t ny = y + PathGrid::STEP_Y[d];
+            if (nx < x1 || nx >= x2 || ny < y1 || ny >= y2)
+                continue;
+            uint32_t next = ny * width + nx;
+            // Going backwards the neighbour has to be able to step onto the current tile.
+            if (reverse ? !grid.CanMove(next, (d + 2) % 4) : !grid.CanMove(current, d))
+                continue;
+            if (finder.seen[next] == finder.generation)
+                continue;
+            finder.seen[next] = finder.generation;
+            finder.cost[next] = finder.cost[current] + 1;
+            queue.push_back(next);
+        }
+    }
+
+    distances.clear();
+    for (uint32_t i = first_node[cluster]; i < first_node[cluster + 1]; i++)
+    {
+        uint32_t node = cluster_nodes[i];
+        if (finder.seen[node_tiles[node]] == finder.generation)
+            distances.push_back(std::make_pair(node, finder.cost[node_tiles[node]]));
+    }
+}
+
+uint32_t PathHierarchy::GetCluster(uint32_t tile) const
+{
+    const uint32_t width = grid.GetWidth();
+    return (tile / width / cluster_size) * clusters_wide + (tile % width) / cluster_size;
+}
+
+Rectangle PathHierarchy::GetClusterBounds(uint32_t cluster) const
+{
+    return Rectangle((cluster % clusters_wide) * cluster_size, (cluster / clusters_wide) * cluster_size, cluster_size, cluster_size);
+}
@@ -0,0 +1,102 @@
+/******************************************************************************************************
+ * Tile Map Editor
+ * Copyright (C) 2009-2017 Brandon Whitehead (tricksterguy87[AT]gmail[DOT]com)
+ *
+ * This software is provided 'as-is', without any express or implied warranty.
+ * In no event will the authors be held liable for any damages arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * excluding commercial applications, and to alter it and redistribute it freely,
+ * subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented;
+ *    you must not claim that you wrote the original software.
+ *    An acknowledgement in your documentation and link to the original version is required.
+ *
+ * 2. Altered source versions must be plainly marked as such,
+ *    and must not be misrepresented as being the original software.
+ *
+ * 3. This notice may not be removed or altered from any source distribution.
+ ******************************************************************************************************/
+#ifndef PATH_HIERARCHY_HPP
+#define PATH_HIERARCHY_HPP
+
+#include <cstdint>
+#include <vector>
+
+#include "PathFinder.hpp"
+#include "PathGrid.hpp"
+
+/** Hierarchical pathfinding (HPA*) graph for large grids.
+  * The grid is split into square clusters, each open stretch of a border between two clusters whose tiles can
+  * step to each other on both sides gets one or two entrance tiles on either side and the entrances of a cluster are joined by the length of the shortest path
+  * between them inside the cluster. Queries search this small graph then fill in the path one cluster at a time,
+  * paths are near optimal and cost a fraction of a full search on big maps.
+  * The graph is read only after it is built so it can be shared between threads each with their own PathFinder.
+  */
+class PathHierarchy
+{
+public:
+    /** Builds the graph for a grid, the grid must outlive it.
+      * @param grid Grid to build the graph for.
+      * @param cluster_size Width and height of the clusters in tiles.
+      */
+    PathHierarchy(const PathGrid& grid, uint32_t cluster_size = DEFAULT_CLUSTER_SIZE);
+
+    /** Finds a path between two tiles.
+      * @param finder Path finder for the same grid providing the search state.
+      * @param sx X coordinate of the start.
+      * @param sy Y coordinate of the start.
+      * @param gx X coordinate of the goal.
+      * @param gy Y coordinate of the goal.
+      * @param path Set to the path if one is found.
+      * @return true if the goal can be reached.
+      */
+    bool FindPath(PathFinder& finder, uint32_t sx, uint32_t sy, uint32_t gx, uint32_t gy, PathFinder::Path& path) const;
+
+    /** Number of entrance tiles in the graph */
+    uint32_t GetNodeCount() const { return node_tiles.size(); }
+    uint32_t GetClusterSize() const { return cluster_size; }
+
+    static constexpr uint32_t DEFAULT_CLUSTER_SIZE = 32;
+    /** Border stretches at least this long get an entrance at both ends instead of one in the middle */
+    static constexpr uint32_t LONG_ENTRANCE = 6;
+
+private:
+    struct Edge
+    {
+        uint32_t to, cost;
+    };
+
+    /** Adds the entrances on the border between two neighbouring tiles rows or columns.
+      * @param first Tile on the near side of the border at the start of the stretch.
+      * @param step Tile index step along the border.
+      * @param length Number of tiles along the border.
+      * @param across Direction crossing the border from the near side.
+      */
+    void AddEntrances(uint32_t first, uint32_t step, uint32_t length, uint32_t across, std::vector<int32_t>& node_of,
+                      std::vector<std::pair<uint32_t, Edge>>& links);
+    /** Gets the node for a tile creating it if needed */
+    uint32_t GetNode(uint32_t tile, std::vector<int32_t>& node_of);
+    /** Breadth first search within a tile's cluster.
+      * @param reverse true to find distances to the tile instead of from it.
+      * @param distances Set to each node of the cluster that can be reached with its distance.
+      */
+    void ClusterDistances(PathFinder& finder, uint32_t tile, bool reverse, std::vector<std::pair<uint32_t, uint32_t>>& distances) const;
+    uint32_t GetCluster(uint32_t tile) const;
+    Rectangle GetClusterBounds(uint32_t cluster) const;
+
+    const PathGrid& grid;
+    uint32_t cluster_size;
+    uint32_t clusters_wide, clusters_high;
+    /** Tile of each node */
+    std::vector<uint32_t> node_tiles;
+    /** Edges leaving each node are edges[first_edge[node], first_edge[node + 1]) */
+    std::vector<uint32_t> first_edge;
+    std::vector<Edge> edges;
+    /** Nodes of each cluster are cluster_nodes[first_node[cluster], first_node[cluster + 1]) */
+    std::vector<uint32_t> first_node;
+    std::vector<uint32_t> cluster_nodes;
+};
+
+#endif
@@ -20,12 +20,53 @@
  ******************************************************************************************************/
 #include "PixelBasedCollisionLayer.hpp"
 
+#include <algorithm>
+#include <cmath>
+
+#include "CollisionMath.hpp"
+#include "Hash.hpp"
+
+namespace
+{
+
+/** Finds when a moving box first touches a rectangle, keeping the earliest hit found so far in hit. */
+void SweepRectangle(const CollisionBox& box, float dx, float dy, const Rectangle& r, bool& found, CollisionHit& hit)
+{
+    float enter_x, exit_x, enter_y, exit_y;
+    if (!SweepAxis(box.x, box.width, dx, r.x, r.x + r.width, enter_x, exit_x) ||
+        !SweepAxis(box.y, box.height, dy, r.y, r.y + r.height, enter_y, exit_y))
+        return;
+
+    float enter = std::max(enter_x, enter_y);
+    if (enter < 0 || enter > 1 || enter >= std::min(exit_x, exit_y) || (found && enter >= hit.time))
+        return;
+
+    found = true;
+    if (enter_x >= enter_y)
+        hit = {enter, dx > 0 ? -1.0f : 1.0f, 0};
+    else
+        hit = {enter, 0, dy > 0 ? -1.0f : 1.0f};
+}
+
+/** Smallest rectangle of pixels covering everything a box touches while it moves */
+Rectangle SweptBounds(const CollisionBox& box, float dx, float dy)
+{
+    int32_t x1 = FloorCoord(std::min(box.x, box.x + dx));
+    int32_t y1 = FloorCoord(std::min(box.y, box.y + dy));
+    int32_t x2 = FloorCoord(std::max(box.x, box.x + dx) + box.width) + 1;
+    int32_t y2 = FloorCoord(std::max(box.y, box.y + dy) + box.height) + 1;
+    return Rectangle(x1, y1, x2 - x1, y2 - y1);
+}
+
+}
+
 PixelBasedCollisionLayer::PixelBasedCollisionLayer(const std::vector<Rectangle>& rectangles)
-    : CollisionLayer(CollisionLayer::PixelBased), region(rectangles)
+    : CollisionLayer(CollisionLayer::PixelBased), region(rectangles), bitmap_mode(false), region_dirty(false)
 {
 }
 
-PixelBasedCollisionLayer::PixelBasedCollisionLayer() : CollisionLayer(CollisionLayer::PixelBased)
+PixelBasedCollisionLayer::PixelBasedCollisionLayer()
+    : CollisionLayer(CollisionLayer::PixelBased), bitmap_mode(false), region_dirty(false)
 {
 }
 
@@ -33,7 +74,8 @@ bool PixelBasedCollisionLayer::operator==(const PixelBasedCollisionLayer& other)
 {
     if (type != other.type)
         return false;
-    if (region != other.region)
+    // Regions are canonical so this holds whichever way either layer is backed.
+    if (GetData() != other.GetData())
         return false;
 
     return true;
@@ -44,9 +86,152 @@ void PixelBasedCollisionLayer::Shift(int horizontal, int vertical, bool wrap)
     /// TODO handle the case of wrapping.
     /// TODO also handle out of bounds rectangles.
     region.Move(horizontal, vertical);
+    bitmap.Move(horizontal, vertical);
+}
+
+void PixelBasedCollisionLayer::Clear()
+{
+    region.Clear();
+    bitmap.Clear();
+    region_dirty = false;
+}
+
+const Region& PixelBasedCollisionLayer::GetData() const
+{
+    if (region_dirty)
+    {
+        region = bitmap.ToRegion();
+        region_dirty = false;
+    }
+    return region;
+}
+
+void PixelBasedCollisionLayer::Prepare() const
+{
+    GetData().BuildIndex();
+}
+
+void PixelBasedCollisionLayer::Add(const Rectangle& rectangle)
+{
+    if (!bitmap_mode)
+        return region.Add(rectangle);
+
+    bitmap.Expand(rectangle);
+    bitmap.Fill(rectangle);
+    region_dirty = true;
+}
+
+void PixelBasedCollisionLayer::Xor(const Rectangle& rectangle)
+{
+    if (!bitmap_mode)
+        return region.Xor(rectangle);
+
+    bitmap.Expand(rectangle);
+    bitmap.Xor(rectangle);
+    region_dirty = true;
+}
+
+void PixelBasedCollisionLayer::Subtract(const Rectangle& rectangle)
+{
+    if (!bitmap_mode)
+        return region.Subtract(rectangle);
+
+    bitmap.Fill(rectangle, false);
+    region_dirty = true;
+}
+
+void PixelBasedCollisionLayer::Intersect(const Rectangle& rectangle)
+{
+    if (!bitmap_mode)
+        return region.Intersect(rectangle);
+
+    CollisionBitmap mask(rectangle);
+    mask.Fill(rectangle);
+    bitmap.Intersect(mask);
+    region_dirty = true;
+}
+
+void PixelBasedCollisionLayer::SetBitmapMode(bool enable)
+{
+    if (enable == bitmap_mode)
+        return;
+
+    if (enable)
+    {
+        bitmap = CollisionBitmap(region);
+    }
+    else
+    {
+        GetData();
+        bitmap = CollisionBitmap();
+    }
+    bitmap_mode = enable;
 }
 
 void PixelBasedCollisionLayer::Resize(uint32_t newwidth, uint32_t newheight, bool copy)
 {
     /// TODO implement
 }
+
+bool PixelBasedCollisionLayer::Collides(float x, float y) const
+{
+    return Contains(FloorCoord(x), FloorCoord(y));
+}
+
+bool PixelBasedCollisionLayer::Overlaps(const CollisionBox& box) const
+{
+    if (!(box.width > 0 && box.height > 0))
+        return false;
+    int32_t x1 = FloorCoord(box.x);
+    int32_t y1 = FloorCoord(box.y);
+    return GetData().Intersects(Rectangle(x1, y1, CeilCoord(box.x + box.width) - x1, CeilCoord(box.y + box.height) - y1));
+}
+
+bool PixelBasedCollisionLayer::Sweep(const CollisionBox& box, float dx, float dy, CollisionHit& hit) const
+{
+    if (Overlaps(box))
+    {
+        hit = {0, 0, 0};
+        return true;
+    }
+    if (!(box.width > 0 && box.height > 0))
+        return Raycast(box.x, box.y, dx, dy, hit);
+
+    bool found = false;
+    GetData().ForEach(SweptBounds(box, dx, dy), [&](const Rectangle& r)
+    {
+        SweepRectangle(box, dx, dy, r, found, hit);
+        return false;
+    });
+    return found;
+}
+
+bool PixelBasedCollisionLayer::Raycast(float x, float y, float dx, float dy, CollisionHit& hit) const
+{
+    if (Collides(x, y))
+    {
+        hit = {0, 0, 0};
+        return true;
+    }
+
+    CollisionBox point = {x, y, 0, 0};
+    bool found = false;
+    GetData().ForEach(SweptBounds(point, dx, dy), [&](const Rectangle& r)
+    {
+        SweepRectangle(point, dx, dy, r, found, hit);
+        return false;
+    });
+    return found;
+}
+
+uint64_t PixelBasedCollisionLayer::ContentHash() const
+{
+    const std::vector<Rectangle>& rectangles = GetData().GetData();
+    uint64_t hash = HashCombine(type, rectangles.size());
+    for (const auto& rectangle : rectangles)
+    {
+        int32_t coords[4] = {rectangle.x, rectangle.y, rectangle.width, rectangle.height};
+        hash = XXHash64(coords, sizeof(coords), hash);
+    }
+    return hash;
+}
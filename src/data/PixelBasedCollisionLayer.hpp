@@ -23,12 +23,16 @@
 
 #include <vector>
 
+#include "CollisionBitmap.hpp"
 #include "CollisionLayer.hpp"
 #include "Rectangle.hpp"
 #include "Region.hpp"
 
 /** Collision layer that is pixel based.
   * Collision information is defined as a list of rectangles specifying where the player can't go.
+  * In bitmap mode the layer is backed by a CollisionBitmap instead, GetData then rebuilds the region
+  * from the bitmap the first time it is called after a change. Call Prepare after editing to do this
+  * up front before querying the layer from several threads.
   */
 class PixelBasedCollisionLayer : public CollisionLayer
 {
@@ -41,26 +45,60 @@ public:
     bool operator!=(const PixelBasedCollisionLayer& other) const { return !(*this == other); }
 
     /** @see CollisionLayer::clear */
-    virtual void Clear() { region.Clear(); }
+    virtual void Clear();
     /** @see CollisionLayer::shift */
     virtual void Shift(int horizontal, int vertical, bool wrap = false);
     /** @see CollisionLayer::resize */
     virtual void Resize(uint32_t width, uint32_t height, bool copy = true);
+    /** @see CollisionLayer::ContentHash */
+    virtual uint64_t ContentHash() const;
+    /** Rebuilds the region from the bitmap if it changed and builds the region's index.
+      * @see CollisionLayer::Prepare
+      */
+    virtual void Prepare() const;
+    /** @see CollisionLayer::Collides */
+    virtual bool Collides(float x, float y) const;
+    /** @see CollisionLayer::Overlaps */
+    virtual bool Overlaps(const CollisionBox& box) const;
+    /** @see CollisionLayer::Sweep */
+    virtual bool Sweep(const CollisionBox& box, float dx, float dy, CollisionHit& hit) const;
+    /** @see CollisionLayer::Raycast */
+    virtual bool Raycast(float x, float y, float dx, float dy, CollisionHit& hit) const;
 
-    const Region& GetData() const { return region; }
+    const Region& GetData() const;
+    const CollisionBitmap& GetBitmap() const { return bitmap; }
+    /** Tests if the pixel (x, y) is blocked.
+      * @param x X coordinate.
+      * @param y Y coordinate.
+      * @return true if the pixel is blocked.
+      */
+    bool Contains(int32_t x, int32_t y) const { return bitmap_mode ? bitmap.Get(x, y) : region.Contains(x, y); }
 
     /** @see Region::Add */
-    void Add(const Rectangle& rectangle) { region.Add(rectangle); }
+    void Add(const Rectangle& rectangle);
     /** @see Region::Xor */
-    void Xor(const Rectangle& rectangle) { region.Xor(rectangle); }
+    void Xor(const Rectangle& rectangle);
     /** @see Region::Subtract */
-    void Subtract(const Rectangle& rectangle) { region.Subtract(rectangle); }
+    void Subtract(const Rectangle& rectangle);
     /** @see Region::Intersect */
-    void Intersect(const Rectangle& rectangle) { region.Intersect(rectangle); }
+    void Intersect(const Rectangle& rectangle);
+
+    /** Switches between a Region and a CollisionBitmap backing the layer.
+      * The bitmap covers the bounds of the collision and grows when rectangles are added outside of it.
+      * @param enable true to use a bitmap.
+      */
+    void SetBitmapMode(bool enable);
+    bool IsBitmapMode() const { return bitmap_mode; }
 
 protected:
-    /** Region backing the PixelBasedCollisionLayer */
-    Region region;
+    /** Region backing the PixelBasedCollisionLayer, out of date in bitmap mode if region_dirty is set */
+    mutable Region region;
+    /** Bitmap backing the layer in bitmap mode */
+    CollisionBitmap bitmap;
+    /** Set if the bitmap is backing the layer */
+    bool bitmap_mode;
+    /** Set when the bitmap changed since region was last rebuilt */
+    mutable bool region_dirty;
 };
 
 #endif
@@ -100,5 +100,5 @@ bool Rectangle::Intersects(const Rectangle& rect, Rectangle& intersect) const
 
 int64_t Rectangle::Area() const
 {
-    return width * height;
+    return (int64_t) width * height;
 }
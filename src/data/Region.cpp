@@ -21,114 +21,275 @@
 #include "Region.hpp"
 
 #include <algorithm>
-#include <list>
-#include <set>
+#include <cstdint>
 
-#include "Logger.hpp"
-
-Region::Region(const std::vector<Rectangle>& _rectangles) : rectangles(_rectangles)
+namespace
 {
-}
 
-bool Region::operator==(const Region& r) const
+/** Boolean operations that combine two regions */
+enum Operation
 {
-    return rectangles == r.rectangles;
-}
+    UNION,
+    INTERSECT,
+    SUBTRACT,
+    XOR,
+};
 
-bool Region::Contains(int32_t x, int32_t y) const
+inline bool Keep(Operation op, bool in_a, bool in_b)
 {
-    for (const Rectangle& rectangle : rectangles)
+    switch (op)
     {
-        if (rectangle.Contains(x, y))
-            return true;
+        case UNION:
+            return in_a || in_b;
+        case INTERSECT:
+            return in_a && in_b;
+        case SUBTRACT:
+            return in_a && !in_b;
+        case XOR:
+            return in_a != in_b;
     }
     return false;
 }
 
-bool Region::Contains(const Rectangle& r) const
+/** Horizontal span [x1, x2) within a band */
+struct Span
 {
-    std::set<Rectangle> intersectSet;
-    for (const auto& inr : rectangles)
-    {
-        Rectangle overlap;
-        if (r.Intersects(inr, overlap))
-            intersectSet.insert(overlap);
-    }
+    int32_t x1, x2;
+};
 
-    // Some optimizations
-    if (intersectSet.empty())
-        return false;
-
-    std::vector<Rectangle> intersect(intersectSet.begin(), intersectSet.end());
-    int64_t total = 0;
-    for (const Rectangle& inr : intersect)
-        total += inr.Area();
-
-    // If the of the inner rectangles is less than the rectangles area then we know it doesn't cover the rectangle
-    if (total < r.Area())
-        return false;
+/** Finds the end of the band starting at rectangles[begin] */
+inline uint32_t BandEnd(const std::vector<Rectangle>& rectangles, uint32_t begin)
+{
+    uint32_t end = begin + 1;
+    while (end < rectangles.size() && rectangles[end].y == rectangles[begin].y)
+        end++;
+    return end;
+}
 
-    std::sort(intersect.begin(), intersect.end());
-    std::set<int32_t> events;
-    for (const auto& inr : intersect)
+/** Combines the spans of one band from each region.
+  * Both lists are sorted and disjoint so a single pass over their edges is enough.
+  * @param a Spans of the first region, may be empty.
+  * @param b Spans of the second region, may be empty.
+  * @param spans Resulting spans, adjacent spans are merged.
+  */
+void MergeSpans(const Rectangle* a, uint32_t na, const Rectangle* b, uint32_t nb, Operation op, std::vector<Span>& spans)
+{
+    spans.clear();
+    // Edge 2i is the left edge of span i and 2i + 1 is its right edge.
+    uint32_t i = 0, j = 0;
+    bool in_a = false, in_b = false, inside = false;
+    int32_t start = 0;
+    while (i < na * 2 || j < nb * 2)
     {
-        events.insert(inr.x);
-        events.insert(inr.x + inr.width);
-    }
+        int32_t xa = i < na * 2 ? (i % 2 ? a[i / 2].x + a[i / 2].width : a[i / 2].x) : INT32_MAX;
+        int32_t xb = j < nb * 2 ? (j % 2 ? b[j / 2].x + b[j / 2].width : b[j / 2].x) : INT32_MAX;
+        int32_t x = std::min(xa, xb);
+        if (xa == x)
+        {
+            in_a = !(i % 2);
+            i++;
+        }
+        if (xb == x)
+        {
+            in_b = !(j % 2);
+            j++;
+        }
 
-    unsigned int rptr = 0;
-    int lastevent = 0;
-    int64_t area = 0;
-    std::list<Rectangle> activeSet;
-    for (const int32_t& event : events)
-    {
-        int32_t cutlength = 0;
-        // Get Area and add it.
-        if (!activeSet.empty())
+        bool keep = Keep(op, in_a, in_b);
+        if (keep == inside)
+            continue;
+        if (keep)
         {
-            std::set<int> events;
-            for (const auto& inr : activeSet)
+            // Reopen the last span if this one starts right where it ended.
+            if (!spans.empty() && spans.back().x2 == x)
             {
-                events.insert(inr.y);
-                events.insert(inr.y + inr.height);
+                start = spans.back().x1;
+                spans.pop_back();
             }
-            int prevEvent = 0;
-            int overlap = 0;
-            for (const auto& event2 : events)
+            else
             {
-                if (overlap != 0)
-                    cutlength += event2 - prevEvent;
-
-                for (const auto& inr : activeSet)
-                {
-                    // Enter event
-                    if (inr.y == event2)
-                        overlap++;
-                    else if (inr.y + inr.height == event2)
-                        overlap--;
-                }
-                prevEvent = event2;
+                start = x;
             }
         }
+        else
+        {
+            spans.push_back({start, x});
+        }
+        inside = keep;
+    }
+}
 
-        area += cutlength * (event - lastevent);
+/** Appends the band [y1, y2) to a region, merging it into the band above if their spans match.
+  * @param out Region being built.
+  * @param last_band index in out of the first rectangle of the last band.
+  */
+void AppendBand(std::vector<Rectangle>& out, uint32_t& last_band, int32_t y1, int32_t y2, const std::vector<Span>& spans)
+{
+    if (spans.empty())
+        return;
 
-        // Leave event? remove rectangles.
-        activeSet.remove_if([&event](const Rectangle& inr)
+    if (last_band < out.size() && out[last_band].y + out[last_band].height == y1 && out.size() - last_band == spans.size())
+    {
+        bool same = true;
+        for (uint32_t i = 0; i < spans.size() && same; i++)
+            same = out[last_band + i].x == spans[i].x1 && out[last_band + i].x + out[last_band + i].width == spans[i].x2;
+        if (same)
         {
-            return inr.x + inr.width == event;
-        });
+            for (uint32_t i = last_band; i < out.size(); i++)
+                out[i].height = y2 - out[i].y;
+            return;
+        }
+    }
+
+    last_band = out.size();
+    for (const auto& span : spans)
+        out.push_back(Rectangle(span.x1, y1, span.x2 - span.x1, y2 - y1));
+}
 
-        // Enter event add rectangles to active set.
-        while (rptr < intersect.size() && intersect[rptr].x == event)
+/** Combines two banded regions, walking both band lists together and merging the spans for each stretch of y.
+  * O(n + m) in the number of rectangles, the result is banded and coalesced.
+  */
+void Combine(const std::vector<Rectangle>& a, const std::vector<Rectangle>& b, Operation op, std::vector<Rectangle>& out)
+{
+    out.clear();
+    std::vector<Span> spans;
+    uint32_t last_band = 0;
+
+    uint32_t ia = 0, ib = 0;
+    uint32_t ea = a.empty() ? 0 : BandEnd(a, 0);
+    uint32_t eb = b.empty() ? 0 : BandEnd(b, 0);
+    int32_t y = INT32_MAX;
+    if (!a.empty())
+        y = a[0].y;
+    if (!b.empty())
+        y = std::min(y, b[0].y);
+
+    while (ia < a.size() || ib < b.size())
+    {
+        // Each band is either active at y or starts below it, the next stop is the nearest band edge.
+        bool active_a = ia < a.size() && a[ia].y <= y;
+        bool active_b = ib < b.size() && b[ib].y <= y;
+        int32_t next = INT32_MAX;
+        if (ia < a.size())
+            next = std::min(next, active_a ? a[ia].y + a[ia].height : a[ia].y);
+        if (ib < b.size())
+            next = std::min(next, active_b ? b[ib].y + b[ib].height : b[ib].y);
+
+        if (active_a || active_b)
+        {
+            MergeSpans(active_a ? &a[ia] : nullptr, active_a ? ea - ia : 0, active_b ? &b[ib] : nullptr, active_b ? eb - ib : 0, op, spans);
+            AppendBand(out, last_band, y, next, spans);
+        }
+
+        y = next;
+        if (ia < a.size() && a[ia].y + a[ia].height == y)
         {
-            activeSet.push_back(intersect[rptr]);
-            rptr++;
+            ia = ea;
+            ea = ia < a.size() ? BandEnd(a, ia) : ia;
         }
-        lastevent = event;
+        if (ib < b.size() && b[ib].y + b[ib].height == y)
+        {
+            ib = eb;
+            eb = ib < b.size() ? BandEnd(b, ib) : ib;
+        }
+    }
+}
+
+/** Builds a banded region from any set of rectangles by merging halves */
+void MakeBanded(const std::vector<Rectangle>& rectangles, uint32_t begin, uint32_t end, std::vector<Rectangle>& out)
+{
+    out.clear();
+    if (end - begin == 1)
+    {
+        if (rectangles[begin].IsValid())
+            out.push_back(rectangles[begin]);
+        return;
+    }
+    if (end == begin)
+        return;
+
+    uint32_t mid = begin + (end - begin) / 2;
+    std::vector<Rectangle> left, right;
+    MakeBanded(rectangles, begin, mid, left);
+    MakeBanded(rectangles, mid, end, right);
+    Combine(left, right, UNION, out);
+}
+
+}
+
+constexpr uint32_t Region::INDEX_THRESHOLD;
+
+Region::Region(const std::vector<Rectangle>& _rectangles) : index_dirty(true)
+{
+    MakeBanded(_rectangles, 0, _rectangles.size(), rectangles);
+}
+
+Region::Region(const Rectangle& rectangle) : index_dirty(true)
+{
+    if (rectangle.IsValid())
+        rectangles.push_back(rectangle);
+}
+
+bool Region::operator==(const Region& r) const
+{
+    return rectangles == r.rectangles;
+}
+
+bool Region::Contains(int32_t x, int32_t y) const
+{
+    if (const RegionIndex* index = GetIndex())
+        return index->Contains(x, y);
+
+    for (const Rectangle& rectangle : rectangles)
+    {
+        if (rectangle.Contains(x, y))
+            return true;
+    }
+    return false;
+}
+
+void Region::Contains(const std::vector<std::pair<int32_t, int32_t>>& points, std::vector<bool>& results) const
+{
+    results.resize(points.size());
+    BuildIndex();
+    for (uint32_t i = 0; i < points.size(); i++)
+        results[i] = Contains(points[i].first, points[i].second);
+}
+
+bool Region::Contains(const Rectangle& r) const
+{
+    if (!r.IsValid())
+        return false;
+
+    int32_t x1, y1, x2, y2;
+    r.GetCoords(x1, y1, x2, y2);
+
+    // Skip the bands above r then every band down to its bottom must be touching and have one span covering it.
+    auto it = std::lower_bound(rectangles.begin(), rectangles.end(), y1, [](const Rectangle& band, int32_t y)
+    {
+        return band.y + band.height <= y;
+    });
+    uint32_t i = it - rectangles.begin();
+    int32_t y = y1;
+    while (i < rectangles.size())
+    {
+        uint32_t end = BandEnd(rectangles, i);
+        if (rectangles[i].y > y)
+            return false;
+
+        bool covered = false;
+        for (; i < end && !covered; i++)
+            covered = rectangles[i].x <= x1 && rectangles[i].x + rectangles[i].width >= x2;
+        if (!covered)
+            return false;
+
+        y = rectangles[end - 1].y + rectangles[end - 1].height;
+        if (y >= y2)
+            return true;
+        i = end;
     }
 
-    return area == r.Area();
+    return false;
 }
 
 Rectangle Region::Bounds() const
@@ -136,42 +297,37 @@ Rectangle Region::Bounds() const
     if (rectangles.empty())
         return Rectangle();
 
-    int32_t minx, miny, maxx, maxy;
-    rectangles[0].GetCoords(minx, miny, maxx, maxy);
-
+    // Bands are sorted so only x needs searching.
+    int32_t minx = rectangles[0].x;
+    int32_t maxx = rectangles[0].x + rectangles[0].width;
     for (const auto& r : rectangles)
     {
-        int32_t cix, ciy, cfx, cfy;
-        r.GetCoords(cix, ciy, cfx, cfy);
-
-        if (minx > cix)
-            minx = cix;
-        if (miny > ciy)
-            miny = ciy;
-        if (maxx > cfx)
-            maxx = cfx;
-        if (maxy > cfy)
-            maxy = cfy;
+        minx = std::min(minx, r.x);
+        maxx = std::max(maxx, r.x + r.width);
     }
+    int32_t miny = rectangles.front().y;
+    int32_t maxy = rectangles.back().y + rectangles.back().height;
 
     return Rectangle(minx, miny, maxx - minx, maxy - miny);
 }
 
 void Region::Intersect(const Rectangle& r)
 {
-    std::set<Rectangle> intersect;
-    for (const auto& inr : rectangles)
-    {
-        Rectangle overlap;
-        if (r.Intersects(inr, overlap))
-            intersect.insert(overlap);
-    }
+    Intersect(Region(r));
+}
 
-    rectangles.assign(intersect.begin(), intersect.end());
+void Region::Intersect(const Region& r)
+{
+    std::vector<Rectangle> result;
+    Combine(rectangles, r.rectangles, INTERSECT, result);
+    Assign(result);
 }
 
-bool Region::Intersects(const Rectangle& r)
+bool Region::Intersects(const Rectangle& r) const
 {
+    if (const RegionIndex* index = GetIndex())
+        return index->Intersects(r);
+
     for (const auto& inr : rectangles)
     {
         Rectangle overlap;
@@ -182,169 +338,80 @@ bool Region::Intersects(const Rectangle& r)
     return false;
 }
 
+void Region::Intersects(const std::vector<Rectangle>& probes, std::vector<bool>& results) const
+{
+    results.resize(probes.size());
+    BuildIndex();
+    for (uint32_t i = 0; i < probes.size(); i++)
+        results[i] = Intersects(probes[i]);
+}
 
-void Region::Subtract(const Rectangle& remove)
+void Region::Query(const Rectangle& r, std::vector<uint32_t>& indices) const
 {
-    std::vector<Rectangle> newRectangles = rectangles;
-    rectangles.clear();
-    for (const auto& rectangle : newRectangles)
+    indices.clear();
+    if (const RegionIndex* index = GetIndex())
+    {
+        index->Query(r, indices);
+        return;
+    }
+
+    for (uint32_t i = 0; i < rectangles.size(); i++)
     {
         Rectangle overlap;
-        // If it doesn't intersect we are ok, but if it does
-        // try to create 4 rectangles.
-        if (rectangle.Intersects(remove, overlap))
-        {
-            int32_t x1i, y1i, x1f, y1f;
-            int32_t x2i, y2i, x2f, y2f;
-
-            rectangle.GetCoords(x1i, y1i, x1f, y1f);
-            overlap.GetCoords(x2i, y2i, x2f, y2f);
-
-            Rectangle top(std::min(x1i, x2i), std::min(y1i, y2i), rectangle.width, y2i - y1i);
-            Rectangle left(std::min(x1i, x2i), std::min(y1i, y2i), x2i - x1i, rectangle.height);
-            Rectangle right(std::min(x1f, x2f), std::min(y1i, y2i), x1f - x2f, rectangle.height);
-            Rectangle bottom(std::min(x1i, x2i), std::min(y1f, y2f), rectangle.width, y1f - y2f);
-
-            if (top.IsValid())
-                Add(top);
-            if (left.IsValid())
-                Add(left);
-            if (right.IsValid())
-                Add(right);
-            if (bottom.IsValid())
-                Add(bottom);
-        }
-        else
-            rectangles.push_back(rectangle);
+        if (r.Intersects(rectangles[i], overlap))
+            indices.push_back(i);
     }
 }
 
+void Region::Subtract(const Rectangle& r)
+{
+    Subtract(Region(r));
+}
+
+void Region::Subtract(const Region& r)
+{
+    std::vector<Rectangle> result;
+    Combine(rectangles, r.rectangles, SUBTRACT, result);
+    Assign(result);
+}
+
 void Region::Move(int32_t x, int32_t y)
 {
     for (Rectangle& r : rectangles)
         r.Move(x, y);
+    index_dirty = true;
 }
 
 void Region::Add(const Rectangle& r)
 {
-    if (!Contains(r))
-        DoAdd(r);
+    Add(Region(r));
 }
 
-void Region::Xor(const Rectangle& remove)
+void Region::Add(const Region& r)
 {
-    std::vector<Rectangle> newRectangles = rectangles;
-    rectangles.clear();
-    for (const auto& rectangle : newRectangles)
-    {
-        Rectangle overlap;
-        // If it doesn't intersect we are ok, but if it does
-        // try to create 4 rectangles.
-        if (rectangle.Intersects(remove, overlap))
-        {
-            int32_t x1i, y1i, x1f, y1f;
-            int32_t x2i, y2i, x2f, y2f;
-            int32_t x3i, y3i, x3f, y3f;
-
-            rectangle.GetCoords(x1i, y1i, x1f, y1f);
-            overlap.GetCoords(x2i, y2i, x2f, y2f);
-            remove.GetCoords(x3i, y3i, x3f, y3f);
-
-            Rectangle top(std::min(x1i, x2i), std::min(y1i, y2i), rectangle.width, y2i - y1i);
-            Rectangle left(std::min(x1i, x2i), std::min(y1i, y2i), x2i - x1i, rectangle.height);
-            Rectangle right(std::min(x1f, x2f), std::min(y1i, y2i), x1f - x2f, rectangle.height);
-            Rectangle bottom(std::min(x1i, x2i), std::min(y1f, y2f), rectangle.width, y1f - y2f);
-
-            Rectangle top2(std::min(x3i, x2i), std::min(y3i, y2i), remove.width, y2i - y3i);
-            Rectangle left2(std::min(x3i, x2i), std::min(y3i, y2i), x2i - x3i, remove.height);
-            Rectangle right2(std::min(x3f, x2f), std::min(y3i, y2i), x3f - x2f, remove.height);
-            Rectangle bottom2(std::min(x3i, x2i), std::min(y3f, y2f), remove.width, y3f - y2f);
-
-            if (top.IsValid())
-                Add(top);
-            if (left.IsValid())
-                Add(left);
-            if (right.IsValid())
-                Add(right);
-            if (bottom.IsValid())
-                Add(bottom);
-
-            if (top2.IsValid())
-                Add(top2);
-            if (left2.IsValid())
-                Add(left2);
-            if (right2.IsValid())
-                Add(right2);
-            if (bottom2.IsValid())
-                Add(bottom2);
-        }
-        else
-            rectangles.push_back(rectangle);
-    }
+    std::vector<Rectangle> result;
+    Combine(rectangles, r.rectangles, UNION, result);
+    Assign(result);
 }
 
-int64_t Region::Area() const
+void Region::Xor(const Rectangle& r)
 {
-    sort(rectangles.begin(), rectangles.end());
-    std::set<int32_t> events;
-    for (const auto& inr : rectangles)
-    {
-        events.insert(inr.x);
-        events.insert(inr.x + inr.width);
-    }
-
-    unsigned int rptr = 0;
-    int lastevent = 0;
-    int64_t area = 0;
-    std::list<Rectangle> activeSet;
-    for (const auto& event : events)
-    {
-        int32_t cutlength = 0;
-        // Get Area and add it.
-        if (!activeSet.empty())
-        {
-            std::set<int32_t> events;
-            for (const auto& inr : activeSet)
-            {
-                events.insert(inr.y);
-                events.insert(inr.y + inr.height);
-            }
-            int prevEvent = 0;
-            int overlap = 0;
-            for (const auto& event2 : events)
-            {
-                if (overlap != 0)
-                    cutlength += event2 - prevEvent;
-
-                for (const auto& inr : activeSet)
-                {
-                    // Enter event
-                    if (inr.y == event2)
-                        overlap++;
-                    else if (inr.y + inr.height == event2)
-                        overlap--;
-                }
-
-                prevEvent = event2;
-            }
-        }
-        area += cutlength * (event - lastevent);
-
-        // Leave event? remove rectangles.
-        activeSet.remove_if([&event](const Rectangle& inr)
-        {
-            return inr.x + inr.width == event;
-        });
+    Xor(Region(r));
+}
 
-        // Enter event add rectangles to active set.
-        while (rptr < rectangles.size() && rectangles[rptr].x == event)
-        {
-            activeSet.push_back(rectangles[rptr]);
-            rptr++;
-        }
-        lastevent = event;
-    }
+void Region::Xor(const Region& r)
+{
+    std::vector<Rectangle> result;
+    Combine(rectangles, r.rectangles, XOR, result);
+    Assign(result);
+}
 
+int64_t Region::Area() const
+{
+    // Rectangles in a banded region never overlap.
+    int64_t area = 0;
+    for (const auto& r : rectangles)
+        area += r.Area();
     return area;
 }
 
@@ -356,16 +423,29 @@ int Region::Size() const
 void Region::Clear()
 {
     rectangles.clear();
+    index_dirty = true;
 }
 
-void Region::DoAdd(const Rectangle& r)
+void Region::BuildIndex() const
 {
-    VerboseLog("Adding rectangle(%d %d %d %d)", r.x, r.y, r.width, r.height);
-    std::vector<Rectangle>::iterator it = remove_if(rectangles.begin(), rectangles.end(),
-                                          [&r](Rectangle& inr)
+    GetIndex();
+}
+
+const RegionIndex* Region::GetIndex() const
+{
+    if (rectangles.size() < INDEX_THRESHOLD)
+        return nullptr;
+
+    if (index_dirty)
     {
-        return r.Contains(inr);
-    });
-    rectangles.erase(it, rectangles.end());
-    rectangles.push_back(r);
+        index.Build(rectangles);
+        index_dirty = false;
+    }
+    return &index;
+}
+
+void Region::Assign(std::vector<Rectangle>& banded)
+{
+    rectangles.swap(banded);
+    index_dirty = true;
 }
@@ -21,20 +21,34 @@
 #ifndef REGION_HPP
 #define REGION_HPP
 
+#include <utility>
 #include <vector>
 
 #include "Rectangle.hpp"
+#include "RegionIndex.hpp"
 
-/** Defines a region a set of rectangles.*/
+/** Defines a region a set of rectangles.
+  * The rectangles are kept y-x banded: sorted into horizontal bands that share a top and height,
+  * spans within a band are sorted and never touch, and a band never touches another with the same spans.
+  * This form is unique for a given set of points so regions compare with ==, and every boolean
+  * operation is a linear merge of two band lists.
+  *
+  * Regions with at least INDEX_THRESHOLD rectangles keep a RegionIndex for queries which is rebuilt
+  * by the first query after the region changes. Call BuildIndex before querying a region from several threads.
+  */
 class Region
 {
 public:
     /** Creates a region from the rectangles given.
-      * @param rectangles List of rectangles.
+      * @param rectangles List of rectangles, they may overlap.
       */
     Region(const std::vector<Rectangle>& rectangles);
+    /** Creates a region covering one rectangle.
+      * @param rectangle Rectangle to cover.
+      */
+    Region(const Rectangle& rectangle);
     /** Creates an empty region.*/
-    Region() {}
+    Region() : index_dirty(true) {}
 
     bool operator==(const Region& r) const;
     bool operator!=(const Region& r) const { return !(*this == r); }
@@ -46,6 +60,11 @@ public:
       * @return true if the point is contained false otherwise.
       */
     bool Contains(int32_t x, int32_t y) const;
+    /** Tests many points at once.
+      * @param points (x, y) coordinates to test.
+      * @param results set to whether each point is contained in the region.
+      */
+    void Contains(const std::vector<std::pair<int32_t, int32_t>>& points, std::vector<bool>& results) const;
     /** Test if the rectangle is fully contained in the region.
       * @param r Rectangle to test.
       * @return true if the rectangle is contained in this region false otherwise.
@@ -59,15 +78,40 @@ public:
       * @param r Rectangle to intersect this region with.
       */
     void Intersect(const Rectangle& r);
+    /** Intersects the region given with this region.
+      * @param r Region to intersect this region with.
+      */
+    void Intersect(const Region& r);
     /** Tests if the rectangle passed in intersects with any rectangle in the region.
       * @param r Rectangle to test if intersects.
       * @return true if the rectangle intersects any rectangle in the region false otherwise.
       */
-    bool Intersects(const Rectangle& r);
-    /** Subtracts the rectangle given with this region.
-      * @param r Rectangle to intersect this region with.
+    bool Intersects(const Rectangle& r) const;
+    /** Tests many rectangles at once.
+      * @param probes Rectangles to test.
+      * @param results set to whether each rectangle intersects the region.
+      */
+    void Intersects(const std::vector<Rectangle>& probes, std::vector<bool>& results) const;
+    /** Finds the rectangles in the region that intersect the rectangle given.
+      * @param r Rectangle to test.
+      * @param indices Indices into GetData() of the rectangles intersecting r.
+      */
+    void Query(const Rectangle& r, std::vector<uint32_t>& indices) const;
+    /** Visits the rectangles in the region that intersect the rectangle given without allocating.
+      * @param r Rectangle to test.
+      * @param visit Called with each rectangle intersecting r, return true to stop.
+      * @return true if visit stopped early.
+      */
+    template <typename Visit>
+    bool ForEach(const Rectangle& r, Visit visit) const;
+    /** Subtracts the rectangle given from this region.
+      * @param r Rectangle to subtract.
       */
     void Subtract(const Rectangle& r);
+    /** Subtracts the region given from this region.
+      * @param r Region to subtract.
+      */
+    void Subtract(const Region& r);
     /** Moves this region.
       * @param x Horizontal Movement.
       * @param y Vertical Movement.
@@ -77,10 +121,18 @@ public:
       * @param r Rectangle to add.
       */
     void Add(const Rectangle& r);
+    /** Adds a region to this region.
+      * @param r Region to add.
+      */
+    void Add(const Region& r);
     /** Xors this region with the rectangle given.
       * @param r Rectangle to xor with.
       */
     void Xor(const Rectangle& r);
+    /** Xors this region with the region given.
+      * @param r Region to xor with.
+      */
+    void Xor(const Region& r);
     /** Calculates the area of this region.
       * @return the area of the region.
       */
@@ -91,13 +143,42 @@ public:
     int Size() const;
     /** Clears the region.*/
     void Clear();
+    /** Brings the index up to date if the region is large enough to use one. */
+    void BuildIndex() const;
+
+    /** Number of rectangles before queries go through a RegionIndex */
+    static constexpr uint32_t INDEX_THRESHOLD = 32;
 
 private:
     /** Set of rectangles representing  this region */
-    ///TODO remove mutable, its sorted in the Area function.
-    mutable std::vector<Rectangle> rectangles;
-    /** Adds a rectangle and minimizes rectangles */
-    void DoAdd(const Rectangle& r);
+    std::vector<Rectangle> rectangles;
+    /** Spatial index over rectangles, only valid if index_dirty is false */
+    mutable RegionIndex index;
+    /** Set when rectangles change */
+    mutable bool index_dirty;
+    /** Replaces the rectangles with the result of an operation.
+      * @param banded Rectangles in banded form, swapped out.
+      */
+    void Assign(std::vector<Rectangle>& banded);
+    /** Gets the index to answer a query with, rebuilding it if out of date.
+      * @return the index or nullptr if the region should be scanned instead.
+      */
+    const RegionIndex* GetIndex() const;
 };
 
+template <typename Visit>
+bool Region::ForEach(const Rectangle& r, Visit visit) const
+{
+    if (const RegionIndex* index = GetIndex())
+        return index->ForEach(r, [this, &visit](uint32_t i) { return visit(rectangles[i]); });
+
+    Rectangle overlap;
+    for (const auto& rectangle : rectangles)
+    {
+        if (r.Intersects(rectangle, overlap) && visit(rectangle))
+            return true;
+    }
+    return false;
+}
+
 #endif
@@ -0,0 +1,128 @@
+/******************************************************************************************************
+ * Tile Map Editor
+ * Copyright (C) 2009-2017 Brandon Whitehead (tricksterguy87[AT]gmail[DOT]com)
+ *
+ * This software is provided 'as-is', without any express or implied warranty.
+ * In no event will the authors be held liable for any damages arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * excluding commercial applications, and to alter it and redistribute it freely,
+ * subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented;
+ *    you must not claim that you wrote the original software.
+ *    An acknowledgement in your documentation and link to the original version is required.
+ *
+ * 2. Altered source versions must be plainly marked as such,
+ *    and must not be misrepresented as being the original software.
+ *
+ * 3. This notice may not be removed or altered from any source distribution.
+ ******************************************************************************************************/
+#include "RegionIndex.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+
+constexpr uint32_t RegionIndex::NODE_SIZE;
+constexpr uint32_t RegionIndex::STACK_SIZE;
+
+namespace
+{
+
+/** Sort-Tile-Recursive packing, orders the entries so each run of NODE_SIZE becomes a node.
+  * Entries are sorted into vertical slices by center x, then each slice is sorted by center y.
+  */
+template <typename Iterator>
+void Pack(Iterator begin, Iterator end)
+{
+    uint32_t count = end - begin;
+    uint32_t pages = (count + RegionIndex::NODE_SIZE - 1) / RegionIndex::NODE_SIZE;
+    uint32_t slices = (uint32_t) ceil(sqrt((double) pages));
+    uint32_t slice_size = slices * RegionIndex::NODE_SIZE;
+
+    typedef typename std::iterator_traits<Iterator>::value_type Entry;
+    std::sort(begin, end, [](const Entry& a, const Entry& b) { return (int64_t) a.x1 + a.x2 < (int64_t) b.x1 + b.x2; });
+    for (uint32_t i = 0; i < count; i += slice_size)
+    {
+        Iterator slice_end = begin + std::min(count, i + slice_size);
+        std::sort(begin + i, slice_end, [](const Entry& a, const Entry& b) { return (int64_t) a.y1 + a.y2 < (int64_t) b.y1 + b.y2; });
+    }
+}
+
+}
+
+void RegionIndex::Build(const std::vector<Rectangle>& rectangles)
+{
+    Clear();
+    for (uint32_t i = 0; i < rectangles.size(); i++)
+    {
+        const Rectangle& r = rectangles[i];
+        if (r.IsValid())
+            items.push_back({r.x, r.y, r.x + r.width, r.y + r.height, i, 0});
+    }
+    if (items.empty())
+        return;
+
+    // Each level is packed then grouped into the level above until one node is left.
+    auto bound = [](const std::vector<Node>& children, uint32_t first, uint32_t count)
+    {
+        Node node = {children[first].x1, children[first].y1, children[first].x2, children[first].y2, first, count};
+        for (uint32_t i = first + 1; i < first + count; i++)
+        {
+            node.x1 = std::min(node.x1, children[i].x1);
+            node.y1 = std::min(node.y1, children[i].y1);
+            node.x2 = std::max(node.x2, children[i].x2);
+            node.y2 = std::max(node.y2, children[i].y2);
+        }
+        return node;
+    };
+
+    Pack(items.begin(), items.end());
+    for (uint32_t i = 0; i < items.size(); i += NODE_SIZE)
+        nodes.push_back(bound(items, i, std::min<uint32_t>(NODE_SIZE, items.size() - i)));
+    leaf_count = nodes.size();
+
+    uint32_t level_begin = 0;
+    uint32_t level_end = nodes.size();
+    while (level_end - level_begin > 1)
+    {
+        Pack(nodes.begin() + level_begin, nodes.begin() + level_end);
+        for (uint32_t i = level_begin; i < level_end; i += NODE_SIZE)
+        {
+            Node node = bound(nodes, i, std::min<uint32_t>(NODE_SIZE, level_end - i));
+            nodes.push_back(node);
+        }
+        level_begin = level_end;
+        level_end = nodes.size();
+    }
+}
+
+void RegionIndex::Clear()
+{
+    items.clear();
+    nodes.clear();
+    leaf_count = 0;
+}
+
+bool RegionIndex::Contains(int32_t x, int32_t y) const
+{
+    return Search([x, y](const Node& node) { return node.x1 <= x && x < node.x2 && node.y1 <= y && y < node.y2; },
+                  [](uint32_t) { return true; });
+}
+
+bool RegionIndex::Intersects(const Rectangle& r) const
+{
+    if (!r.IsValid())
+        return false;
+
+    int32_t x1, y1, x2, y2;
+    r.GetCoords(x1, y1, x2, y2);
+    return Search([=](const Node& node) { return node.x1 < x2 && x1 < node.x2 && node.y1 < y2 && y1 < node.y2; },
+                  [](uint32_t) { return true; });
+}
+
+void RegionIndex::Query(const Rectangle& r, std::vector<uint32_t>& indices) const
+{
+    ForEach(r, [&indices](uint32_t index) { indices.push_back(index); return false; });
+}
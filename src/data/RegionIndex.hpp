@@ -0,0 +1,148 @@
+/******************************************************************************************************
+ * Tile Map Editor
+ * Copyright (C) 2009-2017 Brandon Whitehead (tricksterguy87[AT]gmail[DOT]com)
+ *
+ * This software is provided 'as-is', without any express or implied warranty.
+ * In no event will the authors be held liable for any damages arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * excluding commercial applications, and to alter it and redistribute it freely,
+ * subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented;
+ *    you must not claim that you wrote the original software.
+ *    An acknowledgement in your documentation and link to the original version is required.
+ *
+ * 2. Altered source versions must be plainly marked as such,
+ *    and must not be misrepresented as being the original software.
+ *
+ * 3. This notice may not be removed or altered from any source distribution.
+ ******************************************************************************************************/
+#ifndef REGION_INDEX_HPP
+#define REGION_INDEX_HPP
+
+#include <cstdint>
+#include <vector>
+
+#include "Rectangle.hpp"
+
+/** Bulk loaded R-tree over a set of rectangles.
+  * The tree is packed with Sort-Tile-Recursive so every node is full and it is stored in flat arrays,
+  * point and rectangle queries visit O(log n + k) nodes.
+  * The index is static, rebuild it after the rectangles change.
+  */
+class RegionIndex
+{
+public:
+    RegionIndex() : leaf_count(0) {}
+
+    /** Builds the index replacing the previous one.
+      * Rectangles with no area are left out as nothing can intersect them.
+      * @param rectangles Rectangles to index.
+      */
+    void Build(const std::vector<Rectangle>& rectangles);
+    /** Empties the index */
+    void Clear();
+    /** Tests if the index has no rectangles. */
+    bool IsEmpty() const { return nodes.empty(); }
+
+    /** Tests if any rectangle contains the point (x, y).
+      * @param x X coordinate.
+      * @param y Y coordinate.
+      * @return true if the point is in a rectangle.
+      */
+    bool Contains(int32_t x, int32_t y) const;
+    /** Tests if any rectangle intersects the rectangle given.
+      * @param r Rectangle to test.
+      * @return true if any rectangle intersects r.
+      */
+    bool Intersects(const Rectangle& r) const;
+    /** Finds every rectangle intersecting the rectangle given.
+      * @param r Rectangle to test.
+      * @param indices Indices into the vector the index was built from of each rectangle intersecting r, appended to.
+      */
+    void Query(const Rectangle& r, std::vector<uint32_t>& indices) const;
+    /** Visits every rectangle intersecting the rectangle given without allocating.
+      * @param r Rectangle to test.
+      * @param visit Called with the index of each rectangle intersecting r, return true to stop.
+      * @return true if visit stopped the search.
+      */
+    template <typename Visit>
+    bool ForEach(const Rectangle& r, Visit visit) const;
+
+    /** Maximum number of children per node */
+    static constexpr uint32_t NODE_SIZE = 8;
+
+private:
+    /** Nodes pending during a search, the tree is at most 11 levels deep for 2^32 rectangles */
+    static constexpr uint32_t STACK_SIZE = 128;
+
+    /** Bounds of a node or an indexed rectangle as [x1, x2) x [y1, y2).
+      * For a node first and count are its children, for an item first is the index of the rectangle.
+      */
+    struct Node
+    {
+        int32_t x1, y1, x2, y2;
+        uint32_t first, count;
+    };
+
+    /** Visits every item the overlaps test accepts, stops early when visit returns true.
+      * @return true if stopped early.
+      */
+    template <typename Overlaps, typename Visit>
+    bool Search(Overlaps overlaps, Visit visit) const;
+
+    /** Indexed rectangles in packed order */
+    std::vector<Node> items;
+    /** Tree nodes stored level by level from the leaves up, the root is last */
+    std::vector<Node> nodes;
+    /** Number of leaf nodes, their children are in items */
+    uint32_t leaf_count;
+};
+
+template <typename Overlaps, typename Visit>
+bool RegionIndex::Search(Overlaps overlaps, Visit visit) const
+{
+    if (nodes.empty() || !overlaps(nodes.back()))
+        return false;
+
+    uint32_t stack[STACK_SIZE];
+    uint32_t top = 0;
+    stack[top++] = nodes.size() - 1;
+    while (top > 0)
+    {
+        uint32_t index = stack[--top];
+        const Node& node = nodes[index];
+        if (index < leaf_count)
+        {
+            for (uint32_t i = node.first; i < node.first + node.count; i++)
+            {
+                if (overlaps(items[i]) && visit(items[i].first))
+                    return true;
+            }
+        }
+        else
+        {
+            for (uint32_t i = node.first; i < node.first + node.count; i++)
+            {
+                if (overlaps(nodes[i]))
+                    stack[top++] = i;
+            }
+        }
+    }
+
+    return false;
+}
+
+template <typename Visit>
+bool RegionIndex::ForEach(const Rectangle& r, Visit visit) const
+{
+    if (!r.IsValid())
+        return false;
+
+    int32_t x1, y1, x2, y2;
+    r.GetCoords(x1, y1, x2, y2);
+    return Search([=](const Node& node) { return node.x1 < x2 && x1 < node.x2 && node.y1 < y2 && y1 < node.y2; }, visit);
+}
+
+#endif
@@ -20,32 +20,37 @@
  ******************************************************************************************************/
 #include "TileBasedCollisionLayer.hpp"
 
+#include "Hash.hpp"
+
 TileBasedCollisionLayer::TileBasedCollisionLayer(int width, int height, const std::vector<int32_t>& data)
-    : CollisionLayer(CollisionLayer::TileBased), TiledLayerData(width, height, data)
+    : TiledCollisionLayer(CollisionLayer::TileBased), grid(width, height)
 {
+    // Rows data doesn't cover are left as null tiles.
+    Clear();
+    if (width > 0)
+        grid.SetRows(0, data.size() / width, data.data());
 }
 
 TileBasedCollisionLayer::TileBasedCollisionLayer(int width, int height, const int32_t* data)
-    : CollisionLayer(CollisionLayer::TileBased), TiledLayerData(width, height, data)
+    : TiledCollisionLayer(CollisionLayer::TileBased), grid(width, height)
 {
+    grid.SetRows(0, height, data);
 }
 
 TileBasedCollisionLayer::TileBasedCollisionLayer(int width, int height)
-    : CollisionLayer(CollisionLayer::TileBased), TiledLayerData(width, height)
+    : TiledCollisionLayer(CollisionLayer::TileBased), grid(width, height)
 {
+    Clear();
 }
 
-bool TileBasedCollisionLayer::operator==(const TileBasedCollisionLayer& other)
+bool TileBasedCollisionLayer::operator==(const TileBasedCollisionLayer& other) const
 {
     if (type != other.type)
         return false;
-    if (width != other.width && height != other.height)
-        return false;
-    for (uint32_t i = 0; i < width * height; i++)
-    {
-        if (data[i] != other.data[i])
-            return false;
-    }
+    return grid == other.grid;
+}
 
-    return true;
+uint64_t TileBasedCollisionLayer::ContentHash() const
+{
+    return HashCombine(type, grid.ContentHash());
 }
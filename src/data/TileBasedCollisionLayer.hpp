@@ -24,14 +24,16 @@
 #include <cstdint>
 #include <vector>
 
-#include "CollisionLayer.hpp"
-#include "TiledLayerData.hpp"
+#include "PackedTileGrid.hpp"
+#include "TileCollisionQuery.hpp"
+#include "TiledCollisionLayer.hpp"
 
 /** A collision layer that is tile based.
   * Collision information is defined per tile as either -1 for impassable
-  * or 0 for passable.
+  * or 0 for passable, any other nonzero value is impassable and reads back as -1.
+  * Tiles are stored one bit each.
   */
-class TileBasedCollisionLayer : public CollisionLayer, public TiledLayerData
+class TileBasedCollisionLayer : public TiledCollisionLayer
 {
 public:
     /** Creates a collision layer with specified width, height and data.
@@ -51,15 +53,42 @@ public:
       * @param height Nonzero Height of the collision layer.
       */
     TileBasedCollisionLayer(int width = 1, int height = 1);
-    bool operator==(const TileBasedCollisionLayer& other);
-    bool operator!=(const TileBasedCollisionLayer& other) { return !(*this == other); }
+    bool operator==(const TileBasedCollisionLayer& other) const;
+    bool operator!=(const TileBasedCollisionLayer& other) const { return !(*this == other); }
+
+    uint32_t GetWidth() const { return grid.GetWidth(); }
+    uint32_t GetHeight() const { return grid.GetHeight(); }
+    /** Gets a tile as -1 for impassable or 0 for passable */
+    int32_t At(uint32_t x, uint32_t y) const { return PackedTileCollision::UnpackTile(grid.Get(x, y)); }
+    /** Sets a tile, nonzero values are impassable */
+    void Set(uint32_t x, uint32_t y, int32_t value) { grid.Set(x, y, PackedTileCollision::PackTile(value)); }
+    /** @return The packed tiles, a set bit is impassable */
+    const PackedTileCollision& GetGrid() const { return grid; }
+    /** @see TiledCollisionLayer::GetRows */
+    void GetRows(uint32_t row, uint32_t count, int32_t* data) const { grid.GetRows(row, count, data); }
+    /** @see TiledCollisionLayer::SetRows */
+    void SetRows(uint32_t row, uint32_t count, const int32_t* data) { grid.SetRows(row, count, data); }
 
     /** @see CollisionLayer::Clear */
-    void Clear() { TiledLayerData::Clear(); }
+    void Clear() { grid.Fill(0, 0, grid.GetWidth(), grid.GetHeight(), PackedTileCollision::MASK); }
     /** @see CollisionLayer::Shift */
-    void Shift(int horizontal, int vertical, bool wrap = false) { TiledLayerData::Shift(horizontal, vertical, wrap); }
+    void Shift(int horizontal, int vertical, bool wrap = false) { grid.Shift(horizontal, vertical, wrap); }
     /** @see CollisionLayer::Resize */
-    void Resize(uint32_t width, uint32_t height, bool copy = true) { TiledLayerData::Resize(width, height, copy); }
+    void Resize(uint32_t width, uint32_t height, bool copy = true) { grid.Resize(width, height, copy); }
+    /** @see CollisionLayer::ContentHash */
+    uint64_t ContentHash() const;
+    /** @see CollisionLayer::Collides */
+    bool Collides(float x, float y) const { return TileCollisionQuery(grid).Collides(x, y); }
+    /** @see CollisionLayer::Overlaps */
+    bool Overlaps(const CollisionBox& box) const { return TileCollisionQuery(grid).Overlaps(box); }
+    /** @see CollisionLayer::Sweep */
+    bool Sweep(const CollisionBox& box, float dx, float dy, CollisionHit& hit) const { return TileCollisionQuery(grid).Sweep(box, dx, dy, hit); }
+    /** @see CollisionLayer::Raycast */
+    bool Raycast(float x, float y, float dx, float dy, CollisionHit& hit) const { return TileCollisionQuery(grid).Raycast(x, y, dx, dy, hit); }
+
+private:
+    /** One bit per tile, set if impassable */
+    PackedTileCollision grid;
 };
 
 #endif
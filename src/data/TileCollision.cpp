@@ -0,0 +1,85 @@
+/******************************************************************************************************
+ * Tile Map Editor
+ * Copyright (C) 2009-2017 Brandon Whitehead (tricksterguy87[AT]gmail[DOT]com)
+ *
+ * This software is provided 'as-is', without any express or implied warranty.
+ * In no event will the authors be held liable for any damages arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * excluding commercial applications, and to alter it and redistribute it freely,
+ * subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented;
+ *    you must not claim that you wrote the original software.
+ *    An acknowledgement in your documentation and link to the original version is required.
+ *
+ * 2. Altered source versions must be plainly marked as such,
+ *    and must not be misrepresented as being the original software.
+ *
+ * 3. This notice may not be removed or altered from any source distribution.
+ ******************************************************************************************************/
+#include "TileCollision.hpp"
+
+#include "Hash.hpp"
+
+void TileCollision::SetBlocked(uint32_t tile, bool value)
+{
+    if (tile >= blocked.size())
+    {
+        if (!value)
+            return;
+        blocked.resize(tile + 1, 0);
+    }
+    blocked[tile] = value ? 1 : 0;
+}
+
+void TileCollision::SetDirections(uint32_t tile, int32_t value)
+{
+    if (tile >= directions.size())
+    {
+        if (value == DirectionBasedCollisionLayer::ALL_DIRECTIONS)
+            return;
+        directions.resize(tile + 1, DirectionBasedCollisionLayer::ALL_DIRECTIONS);
+    }
+    directions[tile] = value;
+}
+
+const std::vector<Rectangle>& TileCollision::GetRectangles(uint32_t tile) const
+{
+    static const std::vector<Rectangle> none;
+    auto found = rectangles.find(tile);
+    return found == rectangles.end() ? none : found->second;
+}
+
+void TileCollision::SetRectangles(uint32_t tile, const std::vector<Rectangle>& value)
+{
+    if (value.empty())
+        rectangles.erase(tile);
+    else
+        rectangles[tile] = value;
+}
+
+void TileCollision::Clear()
+{
+    blocked.clear();
+    directions.clear();
+    rectangles.clear();
+}
+
+uint64_t TileCollision::ContentHash() const
+{
+    uint64_t hash = XXHash64(blocked.data(), blocked.size() * sizeof(int32_t), blocked.size());
+    hash = XXHash64(directions.data(), directions.size() * sizeof(int32_t), HashCombine(hash, directions.size()));
+    hash = HashCombine(hash, rectangles.size());
+    for (const auto& tile : rectangles)
+    {
+        hash = HashCombine(hash, tile.first);
+        hash = HashCombine(hash, tile.second.size());
+        for (const auto& rectangle : tile.second)
+        {
+            int32_t coords[4] = {rectangle.x, rectangle.y, rectangle.width, rectangle.height};
+            hash = XXHash64(coords, sizeof(coords), hash);
+        }
+    }
+    return hash;
+}
@@ -0,0 +1,81 @@
+/******************************************************************************************************
+ * Tile Map Editor
+ * Copyright (C) 2009-2017 Brandon Whitehead (tricksterguy87[AT]gmail[DOT]com)
+ *
+ * This software is provided 'as-is', without any express or implied warranty.
+ * In no event will the authors be held liable for any damages arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * excluding commercial applications, and to alter it and redistribute it freely,
+ * subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented;
+ *    you must not claim that you wrote the original software.
+ *    An acknowledgement in your documentation and link to the original version is required.
+ *
+ * 2. Altered source versions must be plainly marked as such,
+ *    and must not be misrepresented as being the original software.
+ *
+ * 3. This notice may not be removed or altered from any source distribution.
+ ******************************************************************************************************/
+#ifndef TILE_COLLISION_HPP
+#define TILE_COLLISION_HPP
+
+#include <cstdint>
+#include <map>
+#include <vector>
+
+#include "DirectionBasedCollisionLayer.hpp"
+#include "Rectangle.hpp"
+
+/** Collision defined for the tiles of a tileset, applied wherever a tile is placed on the map.
+  * A tile can be blocked outright, limit the directions that can be taken out of it using the bits of
+  * DirectionBasedCollisionLayer, and be covered by rectangles given in pixels from the tile's top left.
+  * Tiles without a definition don't collide.
+  */
+class TileCollision
+{
+public:
+    /** Tests if a tile is blocked, tiles without a definition aren't */
+    bool IsBlocked(uint32_t tile) const { return tile < blocked.size() && blocked[tile] != 0; }
+    void SetBlocked(uint32_t tile, bool value);
+    /** Gets the directions that can be taken out of a tile, tiles without a definition allow all of them */
+    int32_t GetDirections(uint32_t tile) const
+    {
+        return tile < directions.size() ? directions[tile] : DirectionBasedCollisionLayer::ALL_DIRECTIONS;
+    }
+    void SetDirections(uint32_t tile, int32_t value);
+    /** Gets the rectangles covering a tile, empty for tiles without any */
+    const std::vector<Rectangle>& GetRectangles(uint32_t tile) const;
+    /** Sets the rectangles covering a tile, an empty list removes them */
+    void SetRectangles(uint32_t tile, const std::vector<Rectangle>& value);
+
+    /** Blocked flag for each tile id, as stored in the TTCI chunk */
+    const std::vector<int32_t>& GetBlocked() const { return blocked; }
+    void SetBlocked(const std::vector<int32_t>& value) { blocked = value; }
+    /** Directions for each tile id, as stored in the TDCI chunk */
+    const std::vector<int32_t>& GetDirections() const { return directions; }
+    void SetDirections(const std::vector<int32_t>& value) { directions = value; }
+    /** Rectangles of each tile that has any, as stored in the TPCI chunk */
+    const std::map<uint32_t, std::vector<Rectangle>>& GetRectangles() const { return rectangles; }
+    void SetRectangles(const std::map<uint32_t, std::vector<Rectangle>>& value) { rectangles = value; }
+
+    /** Tests if no tile has a definition */
+    bool Empty() const { return blocked.empty() && directions.empty() && rectangles.empty(); }
+    void Clear();
+
+    /** Hashes the definitions of every tile.
+      * @return 64 bit hash of the tile collision.
+      */
+    uint64_t ContentHash() const;
+
+private:
+    /** Nonzero for blocked tiles */
+    std::vector<int32_t> blocked;
+    /** Directions allowed out of each tile */
+    std::vector<int32_t> directions;
+    /** Rectangles covering each tile relative to its top left */
+    std::map<uint32_t, std::vector<Rectangle>> rectangles;
+};
+
+#endif
@@ -0,0 +1,191 @@
+/******************************************************************************************************
+ * Tile Map Editor
+ * Copyright (C) 2009-2017 Brandon Whitehead (tricksterguy87[AT]gmail[DOT]com)
+ *
+ * This software is provided 'as-is', without any express or implied warranty.
+ * In no event will the authors be held liable for any damages arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * excluding commercial applications, and to alter it and redistribute it freely,
+ * subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented;
+ *    you must not claim that you wrote the original software.
+ *    An acknowledgement in your documentation and link to the original version is required.
+ *
+ * 2. Altered source versions must be plainly marked as such,
+ *    and must not be misrepresented as being the original software.
+ *
+ * 3. This notice may not be removed or altered from any source distribution.
+ ******************************************************************************************************/
+#include "TileCollisionQuery.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#include "CollisionMath.hpp"
+
+namespace
+{
+
+int32_t Sign(float value)
+{
+    return value > 0 ? 1 : (value < 0 ? -1 : 0);
+}
+
+}
+
+bool TileCollisionQuery::AnyBlocked(int32_t x1, int32_t y1, int32_t x2, int32_t y2) const
+{
+    x1 = std::max(x1, 0);
+    y1 = std::max(y1, 0);
+    x2 = std::min(x2, (int32_t) grid_width);
+    y2 = std::min(y2, (int32_t) grid_height);
+    if (x1 >= x2 || y1 >= y2)
+        return false;
+    // Tile based collision is tested a word of tiles at a time.
+    if (tiles)
+        return tiles->Any(x1, y1, x2 - x1, y2 - y1);
+
+    for (int32_t y = y1; y < y2; y++)
+    {
+        for (int32_t x = x1; x < x2; x++)
+        {
+            if (directions->Get(x, y) == 0)
+                return true;
+        }
+    }
+    return false;
+}
+
+bool TileCollisionQuery::Collides(float x, float y) const
+{
+    return IsBlocked(FloorCoord(x), FloorCoord(y));
+}
+
+bool TileCollisionQuery::Overlaps(const CollisionBox& box) const
+{
+    if (!(box.width > 0 && box.height > 0))
+        return false;
+    return AnyBlocked(FloorCoord(box.x), FloorCoord(box.y), CeilCoord(box.x + box.width), CeilCoord(box.y + box.height));
+}
+
+bool TileCollisionQuery::Sweep(const CollisionBox& box, float dx, float dy, CollisionHit& hit) const
+{
+    if (Overlaps(box))
+    {
+        hit = {0, 0, 0};
+        return true;
+    }
+    if (!(box.width > 0 && box.height > 0))
+        return Raycast(box.x, box.y, dx, dy, hit);
+
+    const int32_t width = grid_width;
+    const int32_t height = grid_height;
+    const int32_t step_x = Sign(dx);
+    const int32_t step_y = Sign(dy);
+    // Time the leading edge enters a column or row.
+    float enter, exit;
+    auto column_time = [&](int32_t column) { SweepAxis(box.x, box.width, dx, column, column + 1, enter, exit); return enter; };
+    auto row_time = [&](int32_t row) { SweepAxis(box.y, box.height, dy, row, row + 1, enter, exit); return enter; };
+
+    // Next column and row the leading edges enter, columns and rows before the layer are skipped over.
+    int32_t cx = step_x > 0 ? std::max(CeilCoord(box.x + box.width), 0) : std::min(FloorCoord(box.x) - 1, width - 1);
+    int32_t cy = step_y > 0 ? std::max(CeilCoord(box.y + box.height), 0) : std::min(FloorCoord(box.y) - 1, height - 1);
+    float tx = step_x ? column_time(cx) : INFINITY;
+    float ty = step_y ? row_time(cy) : INFINITY;
+
+    while (std::min(tx, ty) <= 1)
+    {
+        if (tx <= ty)
+        {
+            // Rows covered when the column is entered, rows entered at the same time are checked with them.
+            float y = box.y + dy * tx;
+            int32_t y1 = step_y < 0 ? cy + 1 : FloorCoord(y);
+            int32_t y2 = step_y > 0 ? cy : CeilCoord(y + box.height);
+            if (AnyBlocked(cx, y1, cx + 1, y2))
+            {
+                hit = {tx, (float) -step_x, 0};
+                return true;
+            }
+            cx += step_x;
+            tx = (cx < 0 || cx >= width) ? INFINITY : column_time(cx);
+        }
+        else
+        {
+            float x = box.x + dx * ty;
+            int32_t x1 = step_x < 0 ? cx + 1 : FloorCoord(x);
+            int32_t x2 = step_x > 0 ? cx : CeilCoord(x + box.width);
+            if (AnyBlocked(x1, cy, x2, cy + 1))
+            {
+                hit = {ty, 0, (float) -step_y};
+                return true;
+            }
+            cy += step_y;
+            ty = (cy < 0 || cy >= height) ? INFINITY : row_time(cy);
+        }
+    }
+
+    return false;
+}
+
+bool TileCollisionQuery::Raycast(float x, float y, float dx, float dy, CollisionHit& hit) const
+{
+    int32_t cx = FloorCoord(x);
+    int32_t cy = FloorCoord(y);
+    if (IsBlocked(cx, cy))
+    {
+        hit = {0, 0, 0};
+        return true;
+    }
+
+    const int32_t width = grid_width;
+    const int32_t height = grid_height;
+    const int32_t step_x = Sign(dx);
+    const int32_t step_y = Sign(dy);
+    // Columns and rows before the layer are skipped over.
+    if (step_x > 0 && cx < -1)
+        cx = -1;
+    if (step_x < 0 && cx > width)
+        cx = width;
+    if (step_y > 0 && cy < -1)
+        cy = -1;
+    if (step_y < 0 && cy > height)
+        cy = height;
+
+    // Time of the next column and row crossing and the time between crossings.
+    float tx = step_x ? (cx + (step_x > 0) - x) / dx : INFINITY;
+    float ty = step_y ? (cy + (step_y > 0) - y) / dy : INFINITY;
+    const float delta_x = step_x ? step_x / dx : INFINITY;
+    const float delta_y = step_y ? step_y / dy : INFINITY;
+
+    while (std::min(tx, ty) <= 1)
+    {
+        if (tx <= ty)
+        {
+            cx += step_x;
+            if (step_x > 0 ? cx >= width : cx < 0)
+                return false;
+            if (IsBlocked(cx, cy))
+            {
+                hit = {tx, (float) -step_x, 0};
+                return true;
+            }
+            tx += delta_x;
+        }
+        else
+        {
+            cy += step_y;
+            if (step_y > 0 ? cy >= height : cy < 0)
+                return false;
+            if (IsBlocked(cx, cy))
+            {
+                hit = {ty, 0, (float) -step_y};
+                return true;
+            }
+            ty += delta_y;
+        }
+    }
+
+    return false;
+}
@@ -0,0 +1,80 @@
+/******************************************************************************************************
+ * Tile Map Editor
+ * Copyright (C) 2009-2017 Brandon Whitehead (tricksterguy87[AT]gmail[DOT]com)
+ *
+ * This software is provided 'as-is', without any express or implied warranty.
+ * In no event will the authors be held liable for any damages arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * excluding commercial applications, and to alter it and redistribute it freely,
+ * subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented;
+ *    you must not claim that you wrote the original software.
+ *    An acknowledgement in your documentation and link to the original version is required.
+ *
+ * 2. Altered source versions must be plainly marked as such,
+ *    and must not be misrepresented as being the original software.
+ *
+ * 3. This notice may not be removed or altered from any source distribution.
+ ******************************************************************************************************/
+#ifndef TILE_COLLISION_QUERY_HPP
+#define TILE_COLLISION_QUERY_HPP
+
+#include <cstdint>
+
+#include "CollisionLayer.hpp"
+#include "PackedTileGrid.hpp"
+
+/** Collision queries over the packed tiles of a tile or direction based collision layer.
+  * A tile is blocked if its bit is set for tile based collision, or if none of its directions are for direction based collision.
+  * Rays step through the tiles they cross with a DDA and swept boxes step their leading edge
+  * one row or column at a time, so the cost depends on the distance moved and not on the layer size.
+  */
+class TileCollisionQuery
+{
+public:
+    /** Creates a query over tile based collision, the grid must outlive the query.
+      * @param grid Tiles to query.
+      */
+    explicit TileCollisionQuery(const PackedTileCollision& grid) :
+        tiles(&grid), directions(nullptr), grid_width(grid.GetWidth()), grid_height(grid.GetHeight()) {}
+    /** Creates a query over direction based collision, the grid must outlive the query.
+      * @param grid Tiles to query.
+      */
+    explicit TileCollisionQuery(const PackedDirectionCollision& grid) :
+        tiles(nullptr), directions(&grid), grid_width(grid.GetWidth()), grid_height(grid.GetHeight()) {}
+
+    /** @see CollisionLayer::Collides */
+    bool Collides(float x, float y) const;
+    /** @see CollisionLayer::Overlaps */
+    bool Overlaps(const CollisionBox& box) const;
+    /** @see CollisionLayer::Sweep */
+    bool Sweep(const CollisionBox& box, float dx, float dy, CollisionHit& hit) const;
+    /** @see CollisionLayer::Raycast */
+    bool Raycast(float x, float y, float dx, float dy, CollisionHit& hit) const;
+
+    /** Tests if a tile is blocked, tiles outside the layer aren't.
+      * @param x Column of the tile.
+      * @param y Row of the tile.
+      * @return true if the tile is blocked.
+      */
+    bool IsBlocked(int32_t x, int32_t y) const
+    {
+        if ((uint32_t) x >= grid_width || (uint32_t) y >= grid_height)
+            return false;
+        return tiles ? tiles->Get(x, y) != 0 : directions->Get(x, y) == 0;
+    }
+    /** Tests if any tile in [x1, x2) x [y1, y2) is blocked.
+      * @return true if any tile is blocked.
+      */
+    bool AnyBlocked(int32_t x1, int32_t y1, int32_t x2, int32_t y2) const;
+
+private:
+    /** Grid queried, only one of them is set */
+    const PackedTileCollision* tiles;
+    const PackedDirectionCollision* directions;
+    uint32_t grid_width, grid_height;
+};
+
+#endif
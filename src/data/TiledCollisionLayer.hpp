@@ -0,0 +1,65 @@
+/******************************************************************************************************
+ * Tile Map Editor
+ * Copyright (C) 2009-2017 Brandon Whitehead (tricksterguy87[AT]gmail[DOT]com)
+ *
+ * This software is provided 'as-is', without any express or implied warranty.
+ * In no event will the authors be held liable for any damages arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * excluding commercial applications, and to alter it and redistribute it freely,
+ * subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented;
+ *    you must not claim that you wrote the original software.
+ *    An acknowledgement in your documentation and link to the original version is required.
+ *
+ * 2. Altered source versions must be plainly marked as such,
+ *    and must not be misrepresented as being the original software.
+ *
+ * 3. This notice may not be removed or altered from any source distribution.
+ ******************************************************************************************************/
+#ifndef TILED_COLLISION_LAYER_HPP
+#define TILED_COLLISION_LAYER_HPP
+
+#include <cstdint>
+#include <vector>
+
+#include "CollisionLayer.hpp"
+#include "TiledLayerData.hpp"
+
+/** Collision layer holding collision per tile, see TileBasedCollisionLayer and DirectionBasedCollisionLayer.
+  * Tiles are kept packed in a PackedTileGrid, files and MapVisitor see them as the int32 rows the MTCL and
+  * MDCL chunks store which are converted a row at a time.
+  */
+class TiledCollisionLayer : public CollisionLayer
+{
+public:
+    TiledCollisionLayer(Type type) : CollisionLayer(type) {}
+
+    virtual uint32_t GetWidth() const = 0;
+    virtual uint32_t GetHeight() const = 0;
+    /** Unpacks rows into the int32 form files store.
+      * @param row First row to get.
+      * @param count Number of rows.
+      * @param data Output for count * width ints.
+      */
+    virtual void GetRows(uint32_t row, uint32_t count, int32_t* data) const = 0;
+    /** Packs rows of tiles in the int32 form files store.
+      * @param row First row to set.
+      * @param count Number of rows.
+      * @param data count * width ints.
+      */
+    virtual void SetRows(uint32_t row, uint32_t count, const int32_t* data) = 0;
+
+    /** @return Every tile in the int32 form files store, row by row */
+    std::vector<int32_t> GetData() const
+    {
+        std::vector<int32_t> data(static_cast<size_t>(GetWidth()) * GetHeight());
+        GetRows(0, GetHeight(), data.data());
+        return data;
+    }
+    /** @return The tiles as a TiledLayerData for the handlers that write one */
+    TiledLayerData Unpack() const { return TiledLayerData(GetWidth(), GetHeight(), GetData()); }
+};
+
+#endif
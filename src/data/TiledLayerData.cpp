@@ -19,8 +19,13 @@
  * 3. This notice may not be removed or altered from any source distribution.
  ******************************************************************************************************/
 #include "TiledLayerData.hpp"
+#include <algorithm>
 #include <cstring>
 
+#include "Hash.hpp"
+
+constexpr uint32_t TiledLayerData::CHUNK_SIZE;
+
 TiledLayerData::TiledLayerData(uint32_t _width, uint32_t _height, const std::vector<int32_t>& _data) : width(_width), height(_height), data(_data)
 {
 }
@@ -108,3 +113,45 @@ void TiledLayerData::Clear()
 {
     data.assign(width * height, NULL_TILE);
 }
+
+bool TiledLayerData::operator==(const TiledLayerData& other) const
+{
+    if (width != other.width || height != other.height)
+        return false;
+    // Compares with memcmp for integer vectors.
+    return data == other.data;
+}
+
+uint64_t TiledLayerData::ContentHash() const
+{
+    uint64_t seed = HashCombine(width, height);
+    return XXHash64(data.data(), data.size() * sizeof(int32_t), seed);
+}
+
+uint64_t TiledLayerData::ChunkHash(uint32_t chunk_x, uint32_t chunk_y) const
+{
+    if (chunk_x >= GetChunksWide() || chunk_y >= GetChunksHigh())
+        throw "Chunk is outside of the layer";
+
+    uint32_t x = chunk_x * CHUNK_SIZE;
+    uint32_t y = chunk_y * CHUNK_SIZE;
+    uint32_t w = std::min<uint32_t>(CHUNK_SIZE, width - x);
+    uint32_t h = std::min<uint32_t>(CHUNK_SIZE, height - y);
+
+    // Gather the rows so the chunk is hashed in one pass.
+    int32_t chunk[CHUNK_SIZE * CHUNK_SIZE];
+    for (uint32_t i = 0; i < h; i++)
+        memcpy(chunk + i * w, data.data() + (y + i) * width + x, w * sizeof(int32_t));
+
+    return XXHash64(chunk, w * h * sizeof(int32_t), HashCombine(w, h));
+}
+
+void TiledLayerData::GetChunkHashes(std::vector<uint64_t>& hashes) const
+{
+    uint32_t chunks_wide = GetChunksWide();
+    uint32_t chunks_high = GetChunksHigh();
+    hashes.resize(chunks_wide * chunks_high);
+    for (uint32_t j = 0; j < chunks_high; j++)
+        for (uint32_t i = 0; i < chunks_wide; i++)
+            hashes[j * chunks_wide + i] = ChunkHash(i, j);
+}
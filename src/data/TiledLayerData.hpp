@@ -52,6 +52,8 @@ public:
 
     int32_t& operator[](const uint32_t index) { return data[index]; }
     const int32_t& operator[](const uint32_t index) const { return data[index]; }
+    bool operator==(const TiledLayerData& other) const;
+    bool operator!=(const TiledLayerData& other) const { return !(*this == other); }
 
     /** Clears the layer. */
     void Clear();
@@ -67,6 +69,25 @@ public:
       * @param copy if true then don't destroy the layer in the process if false then clear out the layer.
       */
     void Resize(uint32_t width, uint32_t height, bool copy = true);
+    /** Hashes the dimensions and tile ids of the layer.
+      * Computed on demand since the data can be edited through references, hashing runs at memory speed.
+      * @return 64 bit hash of the layer contents.
+      */
+    uint64_t ContentHash() const;
+    /** Hashes the tile ids in one CHUNK_SIZE x CHUNK_SIZE chunk of the layer.
+      * Chunks on the right and bottom edges are clipped to the layer.
+      * @param chunk_x column of the chunk.
+      * @param chunk_y row of the chunk.
+      * @return 64 bit hash of the chunk contents.
+      * @throws const char* if the chunk is outside of the layer.
+      */
+    uint64_t ChunkHash(uint32_t chunk_x, uint32_t chunk_y) const;
+    /** Hashes every chunk in the layer so that tools can find which parts of a layer changed.
+      * @param hashes Output hash for each chunk ordered row by row.
+      */
+    void GetChunkHashes(std::vector<uint64_t>& hashes) const;
+    uint32_t GetChunksWide() const { return (width + CHUNK_SIZE - 1) / CHUNK_SIZE; }
+    uint32_t GetChunksHigh() const { return (height + CHUNK_SIZE - 1) / CHUNK_SIZE; }
 
     uint32_t GetWidth() const { return width; }
     uint32_t GetHeight() const { return height; }
@@ -85,6 +106,8 @@ public:
     static constexpr uint32_t MAX_SIZE = 1024;
     /** Null tile id */
     static constexpr uint32_t NULL_TILE = 0xFFFFFFFF;
+    /** Size in tiles of the chunks hashed by ChunkHash */
+    static constexpr uint32_t CHUNK_SIZE = 16;
 
 protected:
     /** Dimensions of this layer */
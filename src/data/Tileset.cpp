@@ -1,5 +1,7 @@
 #include "Tileset.hpp"
 
+#include "Hash.hpp"
+
 constexpr uint32_t Tileset::MIN_TILE_SIZE;
 constexpr uint32_t Tileset::MAX_TILE_SIZE;
 
@@ -23,3 +25,14 @@ void Tileset::GetTileDimensions(uint32_t& width, uint32_t& height) const
     width = tile_width;
     height = tile_height;
 }
+
+uint64_t Tileset::ContentHash() const
+{
+    uint64_t hash = HashString(0, filename);
+    hash = HashCombine(hash, tile_width);
+    hash = HashCombine(hash, tile_height);
+    hash = HashCombine(hash, animated_tiles.size());
+    for (const auto& tile : animated_tiles)
+        hash = HashCombine(hash, tile.ContentHash());
+    return HashCombine(hash, collision.ContentHash());
+}
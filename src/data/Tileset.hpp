@@ -22,6 +22,7 @@
 #define TILESET_HPP
 
 #include "AnimatedTile.hpp"
+#include "TileCollision.hpp"
 
 /** This class represents a Tileset for a Map, including the AnimatedTiles */
 class Tileset {
@@ -34,6 +35,15 @@ public:
     const std::string& GetFilename() const { return filename; }
     void GetTileDimensions(uint32_t& tile_width, uint32_t& tile_height) const;
     const std::vector<AnimatedTile>& GetAnimatedTiles() const { return animated_tiles; }
+    TileCollision& GetTileCollision() { return collision; }
+    const TileCollision& GetTileCollision() const { return collision; }
+    void SetTileCollision(const TileCollision& _collision) { collision = _collision; }
+
+    /** Hashes the filename, tile dimensions, animated tiles and tile collision.
+      * The image itself is not read, only the tileset's description.
+      * @return 64 bit hash of the tileset.
+      */
+    uint64_t ContentHash() const;
     /** Minimum tile size */
     static constexpr uint32_t MIN_TILE_SIZE = 8;
     /** Maximum tile size */
@@ -45,6 +55,8 @@ private:
     uint32_t tile_width, tile_height;
     /** Animated Tiles composed from tiles in this Tileset */
     std::vector<AnimatedTile> animated_tiles;
+    /** Collision of the tiles in this Tileset */
+    TileCollision collision;
 };
 
 #endif
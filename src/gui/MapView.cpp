@@ -22,6 +22,7 @@
 
 #include "TilemapEditorApp.hpp"
 #include "Logger.hpp"
+#include "TileBitmaps.hpp"
 
 IMPLEMENT_DYNAMIC_CLASS(MapView, wxView)
 
@@ -140,13 +141,18 @@ void MapView::OnUpdate(wxView* sender, wxObject* hint)
 
         wxFileName image_file(GetDocument()->GetFilename());
         image_file.SetFullName(filename);
-        if (!image.LoadFile(image_file.GetFullPath()))
-        {
-            WarnLog("Could not load image %s\n", image_file.GetFullPath());
+        uint32_t tile_width, tile_height;
+        tileset.GetTileDimensions(tile_width, tile_height);
+        // Decoded once no matter how many open maps use the tileset, see TilesetCache.
+        std::shared_ptr<const TilesetImage> image = TilesetCache().Get(image_file.GetFullPath().ToStdString(), tile_width, tile_height);
+        if (!image)
             return;
-        }
 
-        UpdateTiles();
+        if (image != tileset_image)
+        {
+            tileset_image = image;
+            tiles = TileBitmaps::Get(tileset_image);
+        }
     }
 
     if (!update || update->GetNeedRefresh() || update->GetUpdateMap())
@@ -201,6 +207,9 @@ void MapView::TransformScreenToTile(int x, int y, int& outx, int& outy, bool bou
 
 void MapView::DrawLayer(wxGCDC& dc, const Layer& layer, unsigned int sxi, unsigned int syi, unsigned int sxf, unsigned int syf)
 {
+    if (!tiles)
+        return;
+
     Map& map = GetMap();
     const Tileset& tileset = map.GetTileset();
     uint32_t tile_width, tile_height;
@@ -251,8 +260,8 @@ void MapView::DrawLayer(wxGCDC& dc, const Layer& layer, unsigned int sxi, unsign
                 tile = animated_tiles[tile].GetCurrentFrame(clock);
             }
 
-            assert(tile < tiles.size());
-            wxBitmap& obj = tiles[tile];
+            assert(tiles && tile < tiles->size());
+            const wxBitmap& obj = (*tiles)[tile];
             gtx->DrawBitmap(obj, x, y, tile_width, tile_height);
         }
     }
@@ -277,29 +286,3 @@ void MapView::DrawLayer(wxGCDC& dc, const Layer& layer, unsigned int sxi, unsign
     ctx->EndLayer();
     ctx->PopState();
 }
-
-void MapView::UpdateTiles()
-{
-    Map& map = GetMap();
-    const Tileset& tileset = map.GetTileset();
-    uint32_t tile_width, tile_height;
-    tileset.GetTileDimensions(tile_width, tile_height);
-
-    wxSize size = image.GetSize();
-    int numTilesX = size.GetWidth() / tile_width;
-    int numTilesY = size.GetHeight() / tile_height;
-    unsigned int totalTiles = numTilesX * numTilesY;
-    if (totalTiles != tiles.size())
-    {
-        totalTiles = numTilesX * numTilesY;
-        tiles.resize(totalTiles);
-    }
-
-    for (unsigned int i = 0; i < totalTiles; i++)
-    {
-        int sx = i % numTilesX * tile_width;
-        int sy = i / numTilesX * tile_height;
-
-        tiles[i] = image.GetSubBitmap(wxRect(sx, sy, tile_width, tile_height));
-    }
-}
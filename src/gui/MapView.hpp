@@ -28,6 +28,7 @@
 #include "MapCanvas.hpp"
 #include "MapDocument.hpp"
 #include "ParallaxBackground.hpp"
+#include "TilesetCache.hpp"
 
 /**
   * This class represents a view of the map.  The user is allowed to click inside of this widget and place tiles using
@@ -64,10 +65,10 @@ public:
 private:
     MapCanvas* mapCanvas;
     void DrawLayer(wxGCDC& dc, const Layer& layer, unsigned int sxi, unsigned int syi, unsigned int sxf, unsigned int syf);
-    void UpdateTiles();
     unsigned long clock;
-    wxBitmap image;
-    std::vector<wxBitmap> tiles;
+    /** Tileset and its tiles, shared with other views of maps using the same tileset */
+    std::shared_ptr<const TilesetImage> tileset_image;
+    std::shared_ptr<const std::vector<wxBitmap>> tiles;
     std::vector<ParallaxBackground> backgrounds;
 
     inline Map& GetMap() {
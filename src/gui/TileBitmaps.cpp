@@ -0,0 +1,63 @@
+/******************************************************************************************************
+ * Tile Map Editor
+ * Copyright (C) 2009-2017 Brandon Whitehead (tricksterguy87[AT]gmail[DOT]com)
+ *
+ * This software is provided 'as-is', without any express or implied warranty.
+ * In no event will the authors be held liable for any damages arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * excluding commercial applications, and to alter it and redistribute it freely,
+ * subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented;
+ *    you must not claim that you wrote the original software.
+ *    An acknowledgement in your documentation and link to the original version is required.
+ *
+ * 2. Altered source versions must be plainly marked as such,
+ *    and must not be misrepresented as being the original software.
+ *
+ * 3. This notice may not be removed or altered from any source distribution.
+ ******************************************************************************************************/
+#include "TileBitmaps.hpp"
+
+#include <cstring>
+#include <iterator>
+#include <wx/image.h>
+
+std::map<const TilesetImage*, TileBitmaps::Entry> TileBitmaps::entries;
+
+std::shared_ptr<const std::vector<wxBitmap>> TileBitmaps::Get(const std::shared_ptr<const TilesetImage>& image)
+{
+    // The image is checked too since a new image could be allocated where an expired one was.
+    auto found = entries.find(image.get());
+    if (found != entries.end() && found->second.image.lock() == image)
+    {
+        std::shared_ptr<const std::vector<wxBitmap>> bitmaps = found->second.bitmaps.lock();
+        if (bitmaps)
+            return bitmaps;
+    }
+
+    for (auto it = entries.begin(); it != entries.end();)
+        it = it->second.bitmaps.expired() ? entries.erase(it) : std::next(it);
+
+    uint32_t tile_width, tile_height;
+    image->GetTileDimensions(tile_width, tile_height);
+    std::shared_ptr<std::vector<wxBitmap>> bitmaps = std::make_shared<std::vector<wxBitmap>>(image->GetNumTiles());
+    for (uint32_t i = 0; i < image->GetNumTiles(); i++)
+    {
+        wxImage tile(tile_width, tile_height, false);
+        tile.SetAlpha();
+        unsigned char* rgb = tile.GetData();
+        unsigned char* alpha = tile.GetAlpha();
+        const uint8_t* pixels = image->GetTile(i);
+        for (uint32_t j = 0; j < tile_width * tile_height; j++)
+        {
+            memcpy(rgb + j * 3, pixels + j * 4, 3);
+            alpha[j] = pixels[j * 4 + 3];
+        }
+        (*bitmaps)[i] = wxBitmap(tile, 32);
+    }
+
+    entries[image.get()] = {image, bitmaps};
+    return bitmaps;
+}
@@ -0,0 +1,52 @@
+/******************************************************************************************************
+ * Tile Map Editor
+ * Copyright (C) 2009-2017 Brandon Whitehead (tricksterguy87[AT]gmail[DOT]com)
+ *
+ * This software is provided 'as-is', without any express or implied warranty.
+ * In no event will the authors be held liable for any damages arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * excluding commercial applications, and to alter it and redistribute it freely,
+ * subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented;
+ *    you must not claim that you wrote the original software.
+ *    An acknowledgement in your documentation and link to the original version is required.
+ *
+ * 2. Altered source versions must be plainly marked as such,
+ *    and must not be misrepresented as being the original software.
+ *
+ * 3. This notice may not be removed or altered from any source distribution.
+ ******************************************************************************************************/
+#ifndef TILE_BITMAPS_HPP
+#define TILE_BITMAPS_HPP
+
+#include <map>
+#include <memory>
+#include <vector>
+#include <wx/bitmap.h>
+
+#include "TilesetCache.hpp"
+
+/** Bitmaps of a tileset's tiles shared by every view showing that tileset.
+  * Bitmaps are made once per TilesetImage and kept while a view holds on to them.
+  */
+class TileBitmaps {
+public:
+    /** Gets the bitmaps of each tile of a tileset.
+      * @param image Tileset from TilesetCache.
+      * @return One bitmap per tile.
+      */
+    static std::shared_ptr<const std::vector<wxBitmap>> Get(const std::shared_ptr<const TilesetImage>& image);
+
+private:
+    struct Entry
+    {
+        std::weak_ptr<const TilesetImage> image;
+        std::weak_ptr<const std::vector<wxBitmap>> bitmaps;
+    };
+    /** Only used from the gui thread so there is no locking */
+    static std::map<const TilesetImage*, Entry> entries;
+};
+
+#endif
@@ -33,9 +33,13 @@ bool TilemapEditorApp::OnInit()
 
     MapHandlerManager().Add(new BinaryMapHandler());
     MapHandlerManager().Add(new TextMapHandler());
-    //MapHandlerManager().Add(new ImageMapHandler());
+    MapHandlerManager().Add(new ProtoMapHandler());
+    MapHandlerManager().Add(new TmxMapHandler());
+    MapHandlerManager().Add(new TiledJsonMapHandler());
+    MapHandlerManager().Add(new ImageMapHandler());
+    MapHandlerManager().Add(new ImagePyramidHandler());
     //MapHandlerManager().Add(new GBAImageHandler());
-    //MapHandlerManager().Add(new GBAMapHandler());
+    MapHandlerManager().Add(new GBAMapHandler());
     //MapHandlerManager().Add(new XmlMapHandler());
 
     // Fill in the application information fields before creating wxConfig.
@@ -24,6 +24,8 @@
 
 #include "Logger.hpp"
 
+constexpr uint32_t BaseMapHandler::HEADER_SIZE;
+
 BaseMapHandler::BaseMapHandler(const std::string& _name, const std::string& _extension, const std::string& _description,
                                bool _readable, bool _writeable, const std::set<std::string>& _alternatives)
     : name(_name), extension(_extension), description(_description), readable(_readable), writeable(_writeable),
@@ -48,6 +50,16 @@ void BaseMapHandler::Load(const std::string& filename, Map& map)
     file.close();
 }
 
+void BaseMapHandler::Load(const std::string& filename, MapVisitor& visitor)
+{
+    VerboseLog("Loading %s using %s", filename.c_str(), name.c_str());
+    std::ifstream file(filename.c_str());
+    if (!file.good())
+        throw "Could not open file for reading";
+    Load(file, visitor);
+    file.close();
+}
+
 void BaseMapHandler::Save(const std::string& filename, const Map& map)
 {
     VerboseLog("Saving %s using %s", filename.c_str(), name.c_str());
@@ -59,12 +71,41 @@ void BaseMapHandler::Save(const std::string& filename, const Map& map)
     file.close();
 }
 
+void BaseMapHandler::Save(const std::string& filename, MapSource& source)
+{
+    VerboseLog("Saving %s using %s", filename.c_str(), name.c_str());
+    std::ofstream file(filename.c_str());
+    if (!file.good())
+        throw "Could not open file for writing";
+    Save(file, source);
+    file.close();
+}
+
 void BaseMapHandler::Load(std::istream& filename, Map& map)
 {
     throw "Load is not defined for this handler";
 }
 
+void BaseMapHandler::Load(std::istream& file, MapVisitor& visitor)
+{
+    Map map;
+    Load(file, map);
+    visitor.Visit(map);
+}
+
 void BaseMapHandler::Save(std::ostream& filename, const Map& map)
 {
     throw "Save is not defined for this handler";
 }
+
+void BaseMapHandler::Save(std::ostream& file, MapSource& source)
+{
+    Map map;
+    source.Read(map);
+    Save(file, map);
+}
+
+bool BaseMapHandler::Sniff(const std::string& header) const
+{
+    return false;
+}
@@ -26,6 +26,8 @@
 #include <string>
 
 #include "Map.hpp"
+#include "MapSource.hpp"
+#include "MapVisitor.hpp"
 
 /** Base class for all map handlers
   * Handlers handle loading and/or saving maps to various formats.
@@ -65,6 +67,19 @@ public:
       * @param map Map object to load the map to.
       */
     virtual void Load(std::istream& file, Map& map);
+    /** Loads a map given a filename passing what is read to a visitor
+      * @param filename Path to the file to load
+      * @param visitor Visitor to pass the map's data to.
+      */
+    virtual void Load(const std::string& filename, MapVisitor& visitor);
+    /** Loads a map given a stream object passing what is read to a visitor as it is read.
+      * Handlers that can read a layer a few rows at a time override this so maps can be
+      * processed without holding all of their tiles, the default implementation loads
+      * the whole map with Load(file, map) then visits it.
+      * @param file Stream object to load data from
+      * @param visitor Visitor to pass the map's data to.
+      */
+    virtual void Load(std::istream& file, MapVisitor& visitor);
     /** Saves a map given a filename
       * @param filename Path to the file to save to.
       * @param map Map object to save.
@@ -75,6 +90,26 @@ public:
       * @param map Map object to save.
       */
     virtual void Save(std::ostream& file, const Map& map);
+    /** Saves a map given a filename pulling the map's data from a source
+      * @param filename Path to the file to save to.
+      * @param source Source of the map's data.
+      */
+    virtual void Save(const std::string& filename, MapSource& source);
+    /** Saves a map given a stream object pulling the map's data from a source as it is written.
+      * Handlers that can write a layer a few rows at a time override this so maps too large to
+      * hold in memory can be saved, the default implementation reads the whole map from the
+      * source and saves it with Save(file, map).
+      * @param file Stream object to save data to.
+      * @param source Source of the map's data.
+      */
+    virtual void Save(std::ostream& file, MapSource& source);
+    /** Tests if the start of a file is in a format this handler can load.
+      * Used to pick a handler for files with a missing or wrong extension.
+      * The default implementation recognizes nothing.
+      * @param header The first HEADER_SIZE bytes of the file (fewer if the file is shorter).
+      * @return true if this handler recognizes the data.
+      */
+    virtual bool Sniff(const std::string& header) const;
 
     const std::string& GetName() const {
         return name;
@@ -108,6 +143,9 @@ public:
         alternatives = alts;
     }
 
+    /** Number of bytes from the start of a file passed to Sniff */
+    static constexpr uint32_t HEADER_SIZE = 64;
+
 protected:
     std::string name;
     std::string extension;
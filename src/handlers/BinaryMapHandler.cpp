@@ -21,8 +21,10 @@
 #include "BinaryMapHandler.hpp"
 
 #include <algorithm>
+#include <climits>
 #include <cstring>
 #include <fstream>
+#include <functional>
 #include <iostream>
 #include <istream>
 
@@ -105,6 +107,64 @@ void WriteDrawAttributes(ChunkStreamWriter& cs, const DrawAttributes* attr)
     cs << attr->GetBlendColor();
 }
 
+/** Writes the name and size of a chunk whose data will be written directly to the file */
+void WriteChunkHeader(std::ostream& file, const char* name, uint64_t size)
+{
+    if (size > UINT32_MAX)
+        throw "Map is too large for the binary format";
+
+    uint32_t network_size = htonl(static_cast<uint32_t>(size));
+    file.write(name, 4);
+    file.write(reinterpret_cast<const char*>(&network_size), sizeof(network_size));
+}
+
+/** Checks the tiles fit in the rest of the chunk, done before the visitor is told the size so it never allocates for a bad header */
+void CheckTiles(ChunkStreamReader& cs, uint32_t width, uint32_t height)
+{
+    if (cs.Fail() || static_cast<uint64_t>(width) * height * sizeof(int32_t) > cs.RemainingSize())
+        throw "Tile data is larger than its chunk";
+}
+
+/** Reads tiles a few rows at a time passing them on as they are read, the size must have been checked with CheckTiles */
+void ReadTiles(ChunkStreamReader& cs, uint32_t width, uint32_t height, const std::function<void(uint32_t, uint32_t, const int32_t*)>& on_rows)
+{
+    uint32_t rows = MapSource::GetRowsPerRequest(width);
+    std::vector<int32_t> buffer(width * std::min(rows, height));
+    for (uint32_t row = 0; row < height; row += rows)
+    {
+        uint32_t count = std::min(rows, height - row);
+        cs.Read(buffer.data(), count * width);
+        on_rows(row, count, buffer.data());
+    }
+}
+
+/** Reads a list of ints written with its size, the size is checked against the chunk before anything is allocated */
+void ReadInts(ChunkStreamReader& cs, std::vector<int32_t>& values)
+{
+    uint32_t count = 0;
+    cs >> count;
+    if (cs.Fail() || static_cast<uint64_t>(count) * sizeof(int32_t) > cs.RemainingSize())
+        throw "List is larger than its chunk";
+
+    values.resize(count);
+    cs.Read(values.data(), count);
+}
+
+/** Writes tiles a few rows at a time as they are read from a MapSource */
+void WriteTiles(std::ostream& file, uint32_t width, uint32_t height, const std::function<void(uint32_t, uint32_t, int32_t*)>& get_rows)
+{
+    uint32_t rows = MapSource::GetRowsPerRequest(width);
+    std::vector<int32_t> buffer(width * std::min(rows, height));
+    for (uint32_t row = 0; row < height; row += rows)
+    {
+        uint32_t count = std::min(rows, height - row);
+        get_rows(row, count, buffer.data());
+        for (uint32_t i = 0; i < count * width; i++)
+            buffer[i] = htonl(buffer[i]);
+        file.write(reinterpret_cast<const char*>(buffer.data()), count * width * sizeof(int32_t));
+    }
+}
+
 }
 
 BinaryMapHandler::BinaryMapHandler()
@@ -113,16 +173,28 @@ BinaryMapHandler::BinaryMapHandler()
 }
 
 void BinaryMapHandler::Load(const std::string& mapfile, Map& map)
+{
+    MapBuilder builder(map);
+    Load(mapfile, builder);
+}
+
+void BinaryMapHandler::Load(const std::string& mapfile, MapVisitor& visitor)
 {
     std::ifstream file(mapfile.c_str(), std::ios::binary);
     if (!file.good())
         throw "Could not open file";
 
-    Load(file, map);
+    Load(file, visitor);
     file.close();
 }
 
 void BinaryMapHandler::Save(const std::string& mapfile, const Map& map)
+{
+    MemoryMapSource source(map);
+    Save(mapfile, source);
+}
+
+void BinaryMapHandler::Save(const std::string& mapfile, MapSource& source)
 {
     EventLog l(__func__);
 
@@ -130,11 +202,23 @@ void BinaryMapHandler::Save(const std::string& mapfile, const Map& map)
     if (!file.good())
         throw "Could not open file";
 
-    Save(file, map);
+    Save(file, source);
     file.close();
 }
 
+bool BinaryMapHandler::Sniff(const std::string& header) const
+{
+    // HEAD chunk name and size followed by the major and minor version then the magic.
+    return header.size() >= 10 + MAGIC.size() && header.compare(0, 4, "HEAD") == 0 && header.compare(10, MAGIC.size(), MAGIC) == 0;
+}
+
 void BinaryMapHandler::Load(std::istream& file, Map& map)
+{
+    MapBuilder builder(map);
+    Load(file, builder);
+}
+
+void BinaryMapHandler::Load(std::istream& file, MapVisitor& visitor)
 {
     EventLog l(__func__);
 
@@ -148,27 +232,27 @@ void BinaryMapHandler::Load(std::istream& file, Map& map)
         unsigned int start = file.tellg();
 
         if (chunkname == "HEAD")
-            ReadHEAD(csr, map);
+            ReadHEAD(csr, visitor);
         else if (chunkname == "MAPP")
-            ReadMAPP(csr, map);
+            ReadMAPP(csr, visitor);
         else if (chunkname == "LYRS")
-            ReadLYRS(csr, map);
+            ReadLYRS(csr, visitor);
         else if (chunkname == "BGDS")
-            ReadBGDS(csr, map);
+            ReadBGDS(csr, visitor);
         else if (chunkname == "MTCL")
-            ReadMTCL(csr, map);
+            ReadMTCL(csr, visitor);
         else if (chunkname == "MDCL")
-            ReadMDCL(csr, map);
+            ReadMDCL(csr, visitor);
         else if (chunkname == "MPCL")
-            ReadMPCL(csr, map);
+            ReadMPCL(csr, visitor);
         else if (chunkname == "TTCI")
-            ReadTTCI(csr, map);
+            ReadTTCI(csr, visitor);
         else if (chunkname == "TDCI")
-            ReadTDCI(csr, map);
+            ReadTDCI(csr, visitor);
         else if (chunkname == "TPCI")
-            ReadTPCI(csr, map);
+            ReadTPCI(csr, visitor);
         else if (chunkname == "ANIM")
-            ReadANIM(csr, map);
+            ReadANIM(csr, visitor);
         else if (chunkname == std::string("EOM\0", 4))
             break;
         else
@@ -182,41 +266,53 @@ void BinaryMapHandler::Load(std::istream& file, Map& map)
         if (end - start != size)
             VerboseLog("Malformed Chunk or size incorrect id %s size = %d read = %d\n", chunkname.c_str(), size, end - start);
     }
+
+    visitor.OnEnd();
 }
 
 void BinaryMapHandler::Save(std::ostream& file, const Map& map)
+{
+    MemoryMapSource source(map);
+    Save(file, source);
+}
+
+void BinaryMapHandler::Save(std::ostream& file, MapSource& source)
 {
     EventLog l(__func__);
-    WriteHEAD(file, map);
-    WriteMAPP(file, map);
-    WriteLYRS(file, map);
-    if (map.GetNumBackgrounds() > 0)
-        WriteBGDS(file, map);
-    if (map.HasCollisionLayer())
+    WriteHEAD(file, source);
+    WriteMAPP(file, source);
+    WriteLYRS(file, source);
+    if (source.GetNumBackgrounds() > 0)
+        WriteBGDS(file, source);
+    MapSource::CollisionInfo collision;
+    if (source.GetCollisionInfo(collision))
     {
-        CollisionLayer* layer = map.GetCollisionLayer();
-        switch (layer->GetType())
+        switch (collision.type)
         {
             case CollisionLayer::TileBased:
-                WriteMTCL(file, map);
+                WriteMTCL(file, source);
                 break;
             case CollisionLayer::DirectionBased:
-                WriteMDCL(file, map);
+                WriteMDCL(file, source);
                 break;
             case CollisionLayer::PixelBased:
-                WriteMPCL(file, map);
+                WriteMPCL(file, source);
                 break;
             default:
-                fprintf(stderr, "Unknown Collision Type %d ignoring\n", layer->GetType());
+                fprintf(stderr, "Unknown Collision Type %d ignoring\n", collision.type);
                 break;
         }
     }
-    // The following chunk's features are not implemented at this time
-    // if (writeTTCI(file, map)) return -1;
-    // if (writeTDCI(file, map)) return -1;
-    // if (writeTPCI(file, map)) return -1;
-    if (map.GetTileset().GetAnimatedTiles().size() > 0)
-        WriteANIM(file, map);
+    const Tileset tileset = source.GetTileset();
+    const TileCollision& tile_collision = tileset.GetTileCollision();
+    if (!tile_collision.GetBlocked().empty())
+        WriteTTCI(file, source);
+    if (!tile_collision.GetDirections().empty())
+        WriteTDCI(file, source);
+    if (!tile_collision.GetRectangles().empty())
+        WriteTPCI(file, source);
+    if (tileset.GetAnimatedTiles().size() > 0)
+        WriteANIM(file, source);
 
     // Write EOM chunk
     char eom[4] = {'E', 'O', 'M', 0};
@@ -226,7 +322,7 @@ void BinaryMapHandler::Save(std::ostream& file, const Map& map)
     file.write((char*)&size, sizeof(int32_t));
 }
 
-void BinaryMapHandler::ReadHEAD(ChunkStreamReader& head, Map& map)
+void BinaryMapHandler::ReadHEAD(ChunkStreamReader& head, MapVisitor& visitor)
 {
     EventLog l(__func__);
 
@@ -254,7 +350,7 @@ void BinaryMapHandler::ReadHEAD(ChunkStreamReader& head, Map& map)
         throw "Failed to read HEAD chunk";
 }
 
-void BinaryMapHandler::WriteHEAD(std::ostream& file, const Map& map)
+void BinaryMapHandler::WriteHEAD(std::ostream& file, MapSource& source)
 {
     EventLog l(__func__);
     ChunkStreamWriter head("HEAD", ChunkStreamWriter::NO_WRITE_SIZES);
@@ -269,7 +365,7 @@ void BinaryMapHandler::WriteHEAD(std::ostream& file, const Map& map)
         throw "Failed to write the HEAD chunk";
 }
 
-void BinaryMapHandler::ReadMAPP(ChunkStreamReader& mapp, Map& map)
+void BinaryMapHandler::ReadMAPP(ChunkStreamReader& mapp, MapVisitor& visitor)
 {
     EventLog l(__func__);
 
@@ -283,21 +379,20 @@ void BinaryMapHandler::ReadMAPP(ChunkStreamReader& mapp, Map& map)
     mapp >> tile_width;
     mapp >> tile_height;
 
-    map.SetName(name);
-    map.SetTileset(Tileset(filename, tile_width, tile_height));
+    visitor.OnProperties(name, Tileset(filename, tile_width, tile_height));
 
     if (!mapp.Ok())
         throw "Failed to read MAPP chunk";
 }
 
-void BinaryMapHandler::WriteMAPP(std::ostream& file, const Map& map)
+void BinaryMapHandler::WriteMAPP(std::ostream& file, MapSource& source)
 {
     EventLog l(__func__);
     ChunkStreamWriter mapp("MAPP");
 
-    mapp << map.GetName();
+    mapp << source.GetName();
 
-    const Tileset& tileset = map.GetTileset();
+    const Tileset tileset = source.GetTileset();
     uint32_t tile_width, tile_height;
     tileset.GetTileDimensions(tile_width, tile_height);
 
@@ -311,7 +406,7 @@ void BinaryMapHandler::WriteMAPP(std::ostream& file, const Map& map)
         throw "Failed to write the MAPP chunk";
 }
 
-void BinaryMapHandler::ReadLYRS(ChunkStreamReader& lyrs, Map& map)
+void BinaryMapHandler::ReadLYRS(ChunkStreamReader& lyrs, MapVisitor& visitor)
 {
     EventLog l(__func__);
 
@@ -321,48 +416,68 @@ void BinaryMapHandler::ReadLYRS(ChunkStreamReader& lyrs, Map& map)
     lyrs >> num_layers;
     for (uint32_t i = 0; i < num_layers; i++)
     {
-        std::string name;
-        uint32_t width;
-        uint32_t height;
-        DrawAttributes attrs;
-        std::vector<int32_t> data;
+        MapSource::LayerInfo info;
 
-        lyrs >> name;
-        lyrs >> width;
-        lyrs >> height;
-        ReadDrawAttributes(lyrs, &attrs);
-        data.resize(width * height);
-        lyrs >> data;
+        lyrs >> info.name;
+        lyrs >> info.width;
+        lyrs >> info.height;
+        ReadDrawAttributes(lyrs, &info.attr);
 
-        map.Add(Layer(name, width, height, data, attrs));
+        CheckTiles(lyrs, info.width, info.height);
+        visitor.OnLayerBegin(info);
+        ReadTiles(lyrs, info.width, info.height, [&visitor](uint32_t row, uint32_t count, const int32_t* tiles)
+        {
+            visitor.OnLayerRows(row, count, tiles);
+        });
+        visitor.OnLayerEnd();
     }
 
     if (!lyrs.Ok())
         throw "Failed to read the LYRS chunk";
 }
 
-void BinaryMapHandler::WriteLYRS(std::ostream& file, const Map& map)
+void BinaryMapHandler::WriteLYRS(std::ostream& file, MapSource& source)
 {
     EventLog l(__func__);
-    ChunkStreamWriter lyrs("LYRS", ChunkStreamWriter::NO_WRITE_VECTOR_SIZES | ChunkStreamWriter::WRITE_STRING_SIZES);
 
-    lyrs << map.GetNumLayers();
-    for (const auto& layer : map.GetLayers())
+    // The chunk's size comes before its data so the layer descriptions are gathered first,
+    // then the tiles of each layer are copied from the source straight to the file.
+    uint32_t num_layers = source.GetNumLayers();
+    std::vector<std::string> headers;
+    std::vector<MapSource::LayerInfo> infos;
+    uint64_t size = sizeof(uint32_t);
+    for (uint32_t i = 0; i < num_layers; i++)
     {
-        lyrs << layer.GetName();
-        lyrs << layer.GetWidth();
-        lyrs << layer.GetHeight();
-        WriteDrawAttributes(lyrs, &layer);
-        lyrs << layer.GetData();
+        infos.push_back(source.GetLayerInfo(i));
+        const MapSource::LayerInfo& info = infos.back();
+
+        ChunkStreamWriter header("", ChunkStreamWriter::NO_WRITE_VECTOR_SIZES | ChunkStreamWriter::WRITE_STRING_SIZES);
+        header << info.name;
+        header << info.width;
+        header << info.height;
+        WriteDrawAttributes(header, &info.attr);
+
+        headers.push_back(header.Data());
+        size += headers.back().size() + static_cast<uint64_t>(info.width) * info.height * sizeof(int32_t);
+    }
+
+    WriteChunkHeader(file, "LYRS", size);
+    uint32_t network_num_layers = htonl(num_layers);
+    file.write(reinterpret_cast<const char*>(&network_num_layers), sizeof(network_num_layers));
+    for (uint32_t i = 0; i < num_layers; i++)
+    {
+        file << headers[i];
+        WriteTiles(file, infos[i].width, infos[i].height, [&source, i](uint32_t row, uint32_t count, int32_t* tiles)
+        {
+            source.GetLayerRows(i, row, count, tiles);
+        });
     }
-
-    file << lyrs;
 
     if (file.fail())
         throw "Failed to write the LYRS chunk";
 }
 
-void BinaryMapHandler::ReadBGDS(ChunkStreamReader& bgds, Map& map)
+void BinaryMapHandler::ReadBGDS(ChunkStreamReader& bgds, MapVisitor& visitor)
 {
     EventLog l(__func__);
     uint32_t num_backgrounds;
@@ -384,21 +499,22 @@ void BinaryMapHandler::ReadBGDS(ChunkStreamReader& bgds, Map& map)
         bgds >> y;
         ReadDrawAttributes(bgds, &attrs);
 
-        map.Add(Background(name, filename, mode, x, y, attrs));
+        visitor.OnBackground(Background(name, filename, mode, x, y, attrs));
     }
 
     if (!bgds.Ok())
         throw "Failed to read the BGDS chunk";
 }
 
-void BinaryMapHandler::WriteBGDS(std::ostream& file, const Map& map)
+void BinaryMapHandler::WriteBGDS(std::ostream& file, MapSource& source)
 {
     EventLog l(__func__);
     ChunkStreamWriter bgds("BGDS");
 
-    bgds << map.GetNumBackgrounds();
-    for (const auto& background : map.GetBackgrounds())
+    bgds << source.GetNumBackgrounds();
+    for (uint32_t i = 0; i < source.GetNumBackgrounds(); i++)
     {
+        const Background background = source.GetBackground(i);
         float speedx, speedy;
         background.GetSpeed(speedx, speedy);
 
@@ -416,78 +532,86 @@ void BinaryMapHandler::WriteBGDS(std::ostream& file, const Map& map)
         throw "Failed to write the BGDS chunk";
 }
 
-void BinaryMapHandler::ReadMTCL(ChunkStreamReader& mtcl, Map& map)
+void BinaryMapHandler::ReadMTCL(ChunkStreamReader& mtcl, MapVisitor& visitor)
 {
     EventLog l(__func__);
-    uint32_t width;
-    uint32_t height;
-    std::vector<int32_t> data;
+    MapSource::CollisionInfo info;
+    info.type = CollisionLayer::TileBased;
 
     mtcl >> set_flags(ChunkStreamReader::NO_READ_SIZES);
 
-    mtcl >> width;
-    mtcl >> height;
-    data.resize(width * height);
-    mtcl >> data;
-    map.SetCollisionLayer(new TileBasedCollisionLayer(width, height, data));
+    mtcl >> info.width;
+    mtcl >> info.height;
+    CheckTiles(mtcl, info.width, info.height);
+    visitor.OnCollision(info);
+    ReadTiles(mtcl, info.width, info.height, [&visitor](uint32_t row, uint32_t count, const int32_t* tiles)
+    {
+        visitor.OnCollisionRows(row, count, tiles);
+    });
 
     if (!mtcl.Ok())
         throw "Failed to read the MTCL chunk";
 }
 
-void BinaryMapHandler::WriteMTCL(std::ostream& file, const Map& map)
+void BinaryMapHandler::WriteMTCL(std::ostream& file, MapSource& source)
 {
     EventLog l(__func__);
-    ChunkStreamWriter mtcl("MTCL", ChunkStreamWriter::NO_WRITE_SIZES);
+    MapSource::CollisionInfo info;
+    source.GetCollisionInfo(info);
 
-    TileBasedCollisionLayer* layer = dynamic_cast<TileBasedCollisionLayer*>(map.GetCollisionLayer());
-    mtcl << layer->GetWidth();
-    mtcl << layer->GetHeight();
-    mtcl << layer->GetData();
-
-    file << mtcl;
+    WriteChunkHeader(file, "MTCL", 2 * sizeof(uint32_t) + static_cast<uint64_t>(info.width) * info.height * sizeof(int32_t));
+    uint32_t dimensions[2] = {htonl(info.width), htonl(info.height)};
+    file.write(reinterpret_cast<const char*>(dimensions), sizeof(dimensions));
+    WriteTiles(file, info.width, info.height, [&source](uint32_t row, uint32_t count, int32_t* data)
+    {
+        source.GetCollisionRows(row, count, data);
+    });
 
     if (file.fail())
         throw "Failed to write the MTCL chunk";
 }
 
-void BinaryMapHandler::ReadMDCL(ChunkStreamReader& mdcl, Map& map)
+void BinaryMapHandler::ReadMDCL(ChunkStreamReader& mdcl, MapVisitor& visitor)
 {
     EventLog l(__func__);
-    uint32_t width;
-    uint32_t height;
-    std::vector<int32_t> data;
+    MapSource::CollisionInfo info;
+    info.type = CollisionLayer::DirectionBased;
 
     mdcl >> set_flags(ChunkStreamReader::NO_READ_SIZES);
 
-    mdcl >> width;
-    mdcl >> height;
-    data.resize(width * height);
-    mdcl >> data;
-    map.SetCollisionLayer(new TileBasedCollisionLayer(width, height, data));
+    mdcl >> info.width;
+    mdcl >> info.height;
+    CheckTiles(mdcl, info.width, info.height);
+    visitor.OnCollision(info);
+    ReadTiles(mdcl, info.width, info.height, [&visitor](uint32_t row, uint32_t count, const int32_t* tiles)
+    {
+        visitor.OnCollisionRows(row, count, tiles);
+    });
 
     if (!mdcl.Ok())
         throw "Failed to read the MTCL chunk";
 }
 
 
-void BinaryMapHandler::WriteMDCL(std::ostream& file, const Map& map)
+void BinaryMapHandler::WriteMDCL(std::ostream& file, MapSource& source)
 {
     EventLog l(__func__);
-    ChunkStreamWriter mdcl("MDCL");
+    MapSource::CollisionInfo info;
+    source.GetCollisionInfo(info);
 
-    TileBasedCollisionLayer* layer = dynamic_cast<TileBasedCollisionLayer*>(map.GetCollisionLayer());
-    mdcl << layer->GetWidth();
-    mdcl << layer->GetHeight();
-    mdcl << layer->GetData();
-
-    file << mdcl;
+    WriteChunkHeader(file, "MDCL", 2 * sizeof(uint32_t) + static_cast<uint64_t>(info.width) * info.height * sizeof(int32_t));
+    uint32_t dimensions[2] = {htonl(info.width), htonl(info.height)};
+    file.write(reinterpret_cast<const char*>(dimensions), sizeof(dimensions));
+    WriteTiles(file, info.width, info.height, [&source](uint32_t row, uint32_t count, int32_t* data)
+    {
+        source.GetCollisionRows(row, count, data);
+    });
 
     if (file.fail())
         throw "Failed to write the MDCL chunk";
 }
 
-void BinaryMapHandler::ReadMPCL(ChunkStreamReader& mpcl, Map& map)
+void BinaryMapHandler::ReadMPCL(ChunkStreamReader& mpcl, MapVisitor& visitor)
 {
     EventLog l(__func__);
     uint32_t numrects;
@@ -511,20 +635,20 @@ void BinaryMapHandler::ReadMPCL(ChunkStreamReader& mpcl, Map& map)
         rectangles.emplace_back(x, y, width, height);
     }
 
-    map.SetCollisionLayer(new PixelBasedCollisionLayer(rectangles));
+    visitor.OnCollision({CollisionLayer::PixelBased, 0, 0});
+    visitor.OnCollisionRectangles(rectangles);
 
     if (!mpcl.Ok())
         throw "Failed to read the MPCL chunk";
 }
 
-void BinaryMapHandler::WriteMPCL(std::ostream& file, const Map& map)
+void BinaryMapHandler::WriteMPCL(std::ostream& file, MapSource& source)
 {
     EventLog l(__func__);
     ChunkStreamWriter mpcl("MPCL");
 
-    PixelBasedCollisionLayer* layer = dynamic_cast<PixelBasedCollisionLayer*>(map.GetCollisionLayer());
-    const Region& region = layer->GetData();
-    const std::vector<Rectangle> rectangles = region.GetData();
+    std::vector<Rectangle> rectangles;
+    source.GetCollisionRectangles(rectangles);
 
     mpcl << (uint32_t) rectangles.size();
     for (const auto& rectangle : rectangles)
@@ -541,51 +665,147 @@ void BinaryMapHandler::WriteMPCL(std::ostream& file, const Map& map)
         throw "Failed to write the MPCL chunk";
 }
 
-void BinaryMapHandler::ReadTTCI(ChunkStreamReader& ttci, Map& map)
+void BinaryMapHandler::ReadTTCI(ChunkStreamReader& ttci, MapVisitor& visitor)
 {
     EventLog l(__func__);
-    throw "Failed to read the TTCI chunk";
+    std::vector<int32_t> blocked;
+
+    ReadInts(ttci, blocked);
+
+    TileCollision collision;
+    collision.SetBlocked(blocked);
+    visitor.OnTileCollision(collision);
+
+    if (!ttci.Ok())
+        throw "Failed to read the TTCI chunk";
 }
 
-void BinaryMapHandler::WriteTTCI(std::ostream& file, const Map& map)
+void BinaryMapHandler::WriteTTCI(std::ostream& file, MapSource& source)
 {
     EventLog l(__func__);
-    throw "Failed to write the TTCI chunk";
+    ChunkStreamWriter ttci("TTCI", ChunkStreamWriter::WRITE_SIZES);
+
+    const Tileset tileset = source.GetTileset();
+    ttci << tileset.GetTileCollision().GetBlocked();
+
+    file << ttci;
+
+    if (file.fail())
+        throw "Failed to write the TTCI chunk";
 }
 
-void BinaryMapHandler::ReadTDCI(ChunkStreamReader& tdci, Map& map)
+void BinaryMapHandler::ReadTDCI(ChunkStreamReader& tdci, MapVisitor& visitor)
 {
     EventLog l(__func__);
-    throw "Failed to read the TDCI chunk";
+    std::vector<int32_t> directions;
+
+    ReadInts(tdci, directions);
+
+    TileCollision collision;
+    collision.SetDirections(directions);
+    visitor.OnTileCollision(collision);
+
+    if (!tdci.Ok())
+        throw "Failed to read the TDCI chunk";
 }
 
-void BinaryMapHandler::WriteTDCI(std::ostream& file, const Map& map)
+void BinaryMapHandler::WriteTDCI(std::ostream& file, MapSource& source)
 {
     EventLog l(__func__);
-    throw "Failed to write the TDCI chunk";
+    ChunkStreamWriter tdci("TDCI", ChunkStreamWriter::WRITE_SIZES);
+
+    const Tileset tileset = source.GetTileset();
+    tdci << tileset.GetTileCollision().GetDirections();
+
+    file << tdci;
+
+    if (file.fail())
+        throw "Failed to write the TDCI chunk";
 }
 
-void BinaryMapHandler::ReadTPCI(ChunkStreamReader& tpci, Map& map)
+void BinaryMapHandler::ReadTPCI(ChunkStreamReader& tpci, MapVisitor& visitor)
 {
     EventLog l(__func__);
-    throw "Failed to read the TPCI chunk";
+    uint32_t numtiles = 0;
+
+    tpci >> numtiles;
+    // Each tile takes at least its id and rectangle count.
+    if (tpci.Fail() || static_cast<uint64_t>(numtiles) * 2 * sizeof(uint32_t) > tpci.RemainingSize())
+        throw "Failed to read the TPCI chunk";
+
+    TileCollision collision;
+    for (uint32_t i = 0; i < numtiles; i++)
+    {
+        uint32_t tile = 0;
+        uint32_t numrects = 0;
+
+        tpci >> tile;
+        tpci >> numrects;
+        if (tpci.Fail() || static_cast<uint64_t>(numrects) * 4 * sizeof(uint32_t) > tpci.RemainingSize())
+            throw "Failed to read the TPCI chunk";
+
+        std::vector<Rectangle> rectangles;
+        rectangles.reserve(numrects);
+        for (uint32_t j = 0; j < numrects; j++)
+        {
+            int32_t x = 0;
+            int32_t y = 0;
+            uint32_t width = 0;
+            uint32_t height = 0;
+
+            tpci >> x;
+            tpci >> y;
+            tpci >> width;
+            tpci >> height;
+            if (tpci.Fail())
+                throw "Failed to read the TPCI chunk";
+
+            rectangles.emplace_back(x, y, width, height);
+        }
+        collision.SetRectangles(tile, rectangles);
+    }
+
+    visitor.OnTileCollision(collision);
+
+    if (!tpci.Ok())
+        throw "Failed to read the TPCI chunk";
 }
 
-void BinaryMapHandler::WriteTPCI(std::ostream& file, const Map& map)
+void BinaryMapHandler::WriteTPCI(std::ostream& file, MapSource& source)
 {
     EventLog l(__func__);
-    throw "Failed to write the TPCI chunk";
+    ChunkStreamWriter tpci("TPCI");
+
+    const Tileset tileset = source.GetTileset();
+    const std::map<uint32_t, std::vector<Rectangle>>& tiles = tileset.GetTileCollision().GetRectangles();
+
+    tpci << (uint32_t) tiles.size();
+    for (const auto& tile : tiles)
+    {
+        tpci << tile.first;
+        tpci << (uint32_t) tile.second.size();
+        for (const auto& rectangle : tile.second)
+        {
+            tpci << rectangle.x;
+            tpci << rectangle.y;
+            tpci << rectangle.width;
+            tpci << rectangle.height;
+        }
+    }
+
+    file << tpci;
+
+    if (file.fail())
+        throw "Failed to write the TPCI chunk";
 }
 
-void BinaryMapHandler::ReadANIM(ChunkStreamReader& anim, Map& map)
+void BinaryMapHandler::ReadANIM(ChunkStreamReader& anim, MapVisitor& visitor)
 {
     EventLog l(__func__);
     uint32_t num_animations;
 
     anim >> num_animations;
 
-    std::vector<AnimatedTile> tiles;
-    tiles.reserve(num_animations);
     for (uint32_t i = 0; i < num_animations; i++)
     {
         std::string name;
@@ -600,22 +820,20 @@ void BinaryMapHandler::ReadANIM(ChunkStreamReader& anim, Map& map)
         anim >> times;
         anim >> frames;
 
-        tiles.emplace_back(name, delay, static_cast<AnimatedTile::Type>(type), times, frames);
+        visitor.OnAnimation(AnimatedTile(name, delay, static_cast<AnimatedTile::Type>(type), times, frames));
     }
-    Tileset& tileset = map.GetTileset();
-    tileset.SetAnimatedTiles(tiles);
 
     if (!anim.Ok())
         throw "Failed to read the ANIM chunk";
 }
 
 
-void BinaryMapHandler::WriteANIM(std::ostream& file, const Map& map)
+void BinaryMapHandler::WriteANIM(std::ostream& file, MapSource& source)
 {
     EventLog l(__func__);
     ChunkStreamWriter anim("ANIM", ChunkStreamWriter::WRITE_SIZES);
 
-    const Tileset& tileset = map.GetTileset();
+    const Tileset tileset = source.GetTileset();
     const std::vector<AnimatedTile>& animated_tiles = tileset.GetAnimatedTiles();
 
     anim << (uint32_t) animated_tiles.size();
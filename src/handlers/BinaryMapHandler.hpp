@@ -35,35 +35,45 @@ public:
     virtual void Load(const std::string& filename, Map& map);
     /** See BaseMapHandler::Load */
     virtual void Load(std::istream& file, Map& map);
+    /** See BaseMapHandler::Load */
+    virtual void Load(const std::string& filename, MapVisitor& visitor);
+    /** See BaseMapHandler::Load, tiles are passed to the visitor as they are read */
+    virtual void Load(std::istream& file, MapVisitor& visitor);
     /** See BaseMapHandler::Save */
     virtual void Save(const std::string& filename, const Map& map);
     /** See BaseMapHandler::Save */
     virtual void Save(std::ostream& file, const Map& map);
+    /** See BaseMapHandler::Save */
+    virtual void Save(const std::string& filename, MapSource& source);
+    /** See BaseMapHandler::Save, tiles are written as they are read from the source */
+    virtual void Save(std::ostream& file, MapSource& source);
+    /** @see BaseMapHandler::Sniff */
+    virtual bool Sniff(const std::string& header) const;
 
 private:
-    void ReadHEAD(ChunkStreamReader& file, Map& map);
-    void ReadMAPP(ChunkStreamReader& file, Map& map);
-    void ReadLYRS(ChunkStreamReader& file, Map& map);
-    void ReadBGDS(ChunkStreamReader& file, Map& map);
-    void ReadMTCL(ChunkStreamReader& file, Map& map);
-    void ReadMDCL(ChunkStreamReader& file, Map& map);
-    void ReadMPCL(ChunkStreamReader& file, Map& map);
-    void ReadTTCI(ChunkStreamReader& file, Map& map);
-    void ReadTDCI(ChunkStreamReader& file, Map& map);
-    void ReadTPCI(ChunkStreamReader& file, Map& map);
-    void ReadANIM(ChunkStreamReader& file, Map& map);
+    void ReadHEAD(ChunkStreamReader& file, MapVisitor& visitor);
+    void ReadMAPP(ChunkStreamReader& file, MapVisitor& visitor);
+    void ReadLYRS(ChunkStreamReader& file, MapVisitor& visitor);
+    void ReadBGDS(ChunkStreamReader& file, MapVisitor& visitor);
+    void ReadMTCL(ChunkStreamReader& file, MapVisitor& visitor);
+    void ReadMDCL(ChunkStreamReader& file, MapVisitor& visitor);
+    void ReadMPCL(ChunkStreamReader& file, MapVisitor& visitor);
+    void ReadTTCI(ChunkStreamReader& file, MapVisitor& visitor);
+    void ReadTDCI(ChunkStreamReader& file, MapVisitor& visitor);
+    void ReadTPCI(ChunkStreamReader& file, MapVisitor& visitor);
+    void ReadANIM(ChunkStreamReader& file, MapVisitor& visitor);
 
-    void WriteHEAD(std::ostream& file, const Map& map);
-    void WriteMAPP(std::ostream& file, const Map& map);
-    void WriteLYRS(std::ostream& file, const Map& map);
-    void WriteBGDS(std::ostream& file, const Map& map);
-    void WriteMTCL(std::ostream& file, const Map& map);
-    void WriteMDCL(std::ostream& file, const Map& map);
-    void WriteMPCL(std::ostream& file, const Map& map);
-    void WriteTTCI(std::ostream& file, const Map& map);
-    void WriteTDCI(std::ostream& file, const Map& map);
-    void WriteTPCI(std::ostream& file, const Map& map);
-    void WriteANIM(std::ostream& file, const Map& map);
+    void WriteHEAD(std::ostream& file, MapSource& source);
+    void WriteMAPP(std::ostream& file, MapSource& source);
+    void WriteLYRS(std::ostream& file, MapSource& source);
+    void WriteBGDS(std::ostream& file, MapSource& source);
+    void WriteMTCL(std::ostream& file, MapSource& source);
+    void WriteMDCL(std::ostream& file, MapSource& source);
+    void WriteMPCL(std::ostream& file, MapSource& source);
+    void WriteTTCI(std::ostream& file, MapSource& source);
+    void WriteTDCI(std::ostream& file, MapSource& source);
+    void WriteTPCI(std::ostream& file, MapSource& source);
+    void WriteANIM(std::ostream& file, MapSource& source);
 };
 
 #endif
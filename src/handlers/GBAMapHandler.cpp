@@ -20,21 +20,195 @@
  ******************************************************************************************************/
 #include "GBAMapHandler.hpp"
 
-#include <iostream>
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
 #include <fstream>
-#include <wx/string.h>
-#include <wx/msgdlg.h>
+#include <functional>
+#include <string>
+#include <Magick++.h>
 
 #include "HandlerUtils.hpp"
+#include "Logger.hpp"
 
-/// TODO Rewrite this.
+namespace
+{
+/** Makes a C identifier out of a name */
+std::string Identifier(const std::string& name, const std::string& fallback)
+{
+    std::string identifier;
+    for (char c : name)
+        identifier += isalnum(static_cast<unsigned char>(c)) ? tolower(static_cast<unsigned char>(c)) : '_';
+    if (identifier.empty())
+        identifier = fallback;
+    if (isdigit(static_cast<unsigned char>(identifier[0])))
+        identifier = "_" + identifier;
+    return identifier;
+}
+
+template <typename T>
+void WriteArray(std::ostream& file, const char* type, const std::string& name, const std::vector<T>& values, uint32_t per_line)
+{
+    char buffer[16];
+    file << "const " << type << " " << name << "[" << values.size() << "] __attribute__((aligned(4))) =\n{\n";
+    for (uint32_t i = 0; i < values.size(); i++)
+    {
+        snprintf(buffer, sizeof(buffer), "0x%0*X", static_cast<int>(sizeof(T) * 2), static_cast<uint32_t>(values[i]));
+        file << (i % per_line == 0 ? "    " : " ") << buffer << ",";
+        if (i % per_line == per_line - 1 || i + 1 == values.size())
+            file << "\n";
+    }
+    file << "};\n\n";
+}
+
+void WriteLittleEndian(std::ostream& file, const std::vector<uint16_t>& values)
+{
+    for (uint16_t value : values)
+    {
+        file.put(value & 0xFF);
+        file.put(value >> 8);
+    }
+}
+
+void WriteBytes(std::ostream& file, const std::vector<uint8_t>& bytes)
+{
+    file.write(reinterpret_cast<const char*>(bytes.data()), bytes.size());
+}
+
+void WriteEntries(std::ostream& file, const GBATileExporter::Background& background)
+{
+    // Affine backgrounds use one byte per entry.
+    if (background.affine)
+        WriteBytes(file, std::vector<uint8_t>(background.entries.begin(), background.entries.end()));
+    else
+        WriteLittleEndian(file, background.entries);
+}
+
+bool HasBackgrounds(const GBATileExporter& exporter, bool affine)
+{
+    const auto& backgrounds = exporter.GetBackgrounds();
+    return std::any_of(backgrounds.begin(), backgrounds.end(), [affine](const GBATileExporter::Background& b) { return b.affine == affine; });
+}
+
+void WriteFile(const std::string& filename, const std::function<void(std::ostream&)>& write)
+{
+    std::ofstream file(filename.c_str(), std::ios::binary);
+    if (!file.good())
+        throw "Could not open file";
+    write(file);
+    if (file.fail())
+        throw "Failed to write GBA data";
+}
+}
 
-GBAMapHandler::GBAMapHandler()
-    : BaseMapHandler("GBA Map Export", "c", "Exports the map in GBA modes (0-2) format", false, false)
+GBAMapHandler::GBAMapHandler(uint32_t _mode, GBATileExporter::Bpp _bpp, Output _output)
+    : BaseMapHandler("GBA Map Export", _output == CArrays ? "c" : "bin", "Exports the map in GBA modes (0-2) format", false, true),
+      mode(_mode), bpp(_bpp), output(_output)
 {
 }
 
+int GBAMapHandler::Init()
+{
+    Magick::InitializeMagick(NULL);
+    return 0;
+}
+
+void GBAMapHandler::Export(const Map& map, GBATileExporter& exporter)
+{
+    EventLog l(__func__);
+    std::shared_ptr<const TilesetImage> image = HandlerUtils::GetTilesetImage(map);
+    if (!image)
+        throw "Could not load the map's tileset";
+
+    uint32_t tile_width, tile_height;
+    map.GetTileset().GetTileDimensions(tile_width, tile_height);
+    std::vector<uint8_t> rgba;
+    image->GetPixels(rgba);
+    exporter.SetTileset(rgba.data(), image->GetWidth(), image->GetHeight(), tile_width, tile_height, true);
+    for (const auto& layer : map.GetLayers())
+        exporter.Add(layer, map.GetTileset().GetAnimatedTiles());
+    exporter.Finish();
+
+    VerboseLog("Exported %d regular and %d affine tiles", exporter.GetNumTiles(false), exporter.GetNumTiles(true));
+}
+
+void GBAMapHandler::Save(const std::string& filename, const Map& map)
+{
+    if (output == CArrays)
+    {
+        BaseMapHandler::Save(filename, map);
+        return;
+    }
+
+    GBATileExporter exporter(mode, bpp);
+    Export(map, exporter);
+
+    std::string base = filename.substr(0, filename.rfind('.'));
+    WriteFile(base + ".pal.bin", [&](std::ostream& file) { WriteLittleEndian(file, exporter.GetPalette()); });
+    WriteFile(base + ".img.bin", [&](std::ostream& file) { WriteBytes(file, exporter.GetTiles(false)); });
+    if (HasBackgrounds(exporter, true))
+        WriteFile(base + ".affine.img.bin", [&](std::ostream& file) { WriteBytes(file, exporter.GetTiles(true)); });
+    for (uint32_t i = 0; i < exporter.GetBackgrounds().size(); i++)
+        WriteFile(base + "." + std::to_string(i) + ".map.bin", [&](std::ostream& file) { WriteEntries(file, exporter.GetBackgrounds()[i]); });
+}
+
 void GBAMapHandler::Save(std::ostream& file, const Map& map)
 {
-    BaseMapHandler::Save(file, map);
+    GBATileExporter exporter(mode, bpp);
+    Export(map, exporter);
+
+    if (output == CArrays)
+    {
+        WriteC(file, map, exporter);
+    }
+    else
+    {
+        WriteLittleEndian(file, exporter.GetPalette());
+        WriteBytes(file, exporter.GetTiles(false));
+        if (HasBackgrounds(exporter, true))
+            WriteBytes(file, exporter.GetTiles(true));
+        for (const auto& background : exporter.GetBackgrounds())
+            WriteEntries(file, background);
+    }
+
+    if (file.fail())
+        throw "Failed to write GBA data";
+}
+
+void GBAMapHandler::WriteC(std::ostream& file, const Map& map, const GBATileExporter& exporter)
+{
+    const std::string name = Identifier(map.GetName(), "map");
+    file << "// " << map.GetName() << " exported for GBA mode " << exporter.GetMode() << " (" << exporter.GetBpp() << "bpp)\n\n";
+
+    WriteArray(file, "unsigned short", name + "_palette", exporter.GetPalette(), 8);
+
+    for (bool affine : {false, true})
+    {
+        if (!HasBackgrounds(exporter, affine))
+            continue;
+
+        const std::vector<uint8_t>& bytes = exporter.GetTiles(affine);
+        std::vector<uint32_t> words(bytes.size() / 4);
+        for (uint32_t i = 0; i < words.size(); i++)
+            words[i] = bytes[i * 4] | (bytes[i * 4 + 1] << 8) | (bytes[i * 4 + 2] << 16) | (static_cast<uint32_t>(bytes[i * 4 + 3]) << 24);
+        file << "// " << exporter.GetNumTiles(affine) << " tiles\n";
+        WriteArray(file, "unsigned int", name + (affine ? "_affine_tiles" : "_tiles"), words, 8);
+    }
+
+    for (uint32_t i = 0; i < exporter.GetBackgrounds().size(); i++)
+    {
+        const auto& background = exporter.GetBackgrounds()[i];
+        const std::string map_name = name + "_" + Identifier(background.name, "layer" + std::to_string(i)) + "_map";
+        if (background.affine)
+        {
+            file << "// " << background.name << " affine " << background.width << "x" << background.height << " tiles\n";
+            WriteArray(file, "unsigned char", map_name, std::vector<uint8_t>(background.entries.begin(), background.entries.end()), 16);
+        }
+        else
+        {
+            uint32_t screenblocks = background.width * background.height / (GBATileExporter::SCREENBLOCK_SIZE * GBATileExporter::SCREENBLOCK_SIZE);
+            file << "// " << background.name << " " << background.width << "x" << background.height << " tiles in " << screenblocks << " screenblocks\n";
+            WriteArray(file, "unsigned short", map_name, background.entries, 8);
+        }
+    }
 }
@@ -21,18 +21,51 @@
 #ifndef GBA_MAP_HANDLER_HPP
 #define GBA_MAP_HANDLER_HPP
 
-#include <Magick++.h>
-
 #include "BaseMapHandler.hpp"
+#include "GBATileExporter.hpp"
 
 /** Saves each layer of the map as a background appropriate for gba modes 0-2 */
 class GBAMapHandler : public BaseMapHandler {
 public:
-    GBAMapHandler();
+    /** How the exported data is written */
+    enum Output
+    {
+        /** A .c file with const arrays for the palette, tiles and each background's map (default) */
+        CArrays = 0,
+        /** Little endian binaries, see Save */
+        RawBinary = 1,
+    };
+
+    /** Creates the handler
+      * @param mode Video mode (0-2) the backgrounds are for.
+      * @param bpp Color depth of the tiles, see GBATileExporter.
+      * @param output How the data is written.
+      */
+    GBAMapHandler(uint32_t mode = 0, GBATileExporter::Bpp bpp = GBATileExporter::Bpp4, Output output = CArrays);
 
-    /** @see BaseMapHandler::Save */
+    /** @see BaseMapHandler::Init */
+    virtual int Init();
+    /** @see BaseMapHandler::Save
+      * With RawBinary each part goes to its own file named after filename:
+      * name.pal.bin, name.img.bin, name.affine.img.bin (if there are affine backgrounds) and name.N.map.bin for each background.
+      */
+    virtual void Save(const std::string& filename, const Map& map);
+    /** @see BaseMapHandler::Save
+      * With RawBinary the palette, tiles, affine tiles (if any) then each background's map are written one after the other.
+      */
     virtual void Save(std::ostream& file, const Map& map);
 
+    uint32_t GetMode() const { return mode; }
+    GBATileExporter::Bpp GetBpp() const { return bpp; }
+    Output GetOutput() const { return output; }
+
+private:
+    void Export(const Map& map, GBATileExporter& exporter);
+    void WriteC(std::ostream& file, const Map& map, const GBATileExporter& exporter);
+
+    uint32_t mode;
+    GBATileExporter::Bpp bpp;
+    Output output;
 };
 
 #endif
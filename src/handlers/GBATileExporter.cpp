@@ -0,0 +1,492 @@
+/******************************************************************************************************
+ * Tile Map Editor
+ * Copyright (C) 2009-2017 Brandon Whitehead (tricksterguy87[AT]gmail[DOT]com)
+ *
+ * This software is provided 'as-is', without any express or implied warranty.
+ * In no event will the authors be held liable for any damages arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * excluding commercial applications, and to alter it and redistribute it freely,
+ * subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented;
+ *    you must not claim that you wrote the original software.
+ *    An acknowledgement in your documentation and link to the original version is required.
+ *
+ * 2. Altered source versions must be plainly marked as such,
+ *    and must not be misrepresented as being the original software.
+ *
+ * 3. This notice may not be removed or altered from any source distribution.
+ ******************************************************************************************************/
+#include "GBATileExporter.hpp"
+
+#include <algorithm>
+#include <iterator>
+
+#include "Logger.hpp"
+#include "Quantizer.hpp"
+
+constexpr uint32_t GBATileExporter::TILE_SIZE;
+constexpr uint32_t GBATileExporter::SCREENBLOCK_SIZE;
+constexpr uint32_t GBATileExporter::MAX_REGULAR_TILES;
+constexpr uint32_t GBATileExporter::MAX_AFFINE_TILES;
+constexpr uint16_t GBATileExporter::HFLIP;
+constexpr uint16_t GBATileExporter::VFLIP;
+constexpr uint32_t GBATileExporter::PALETTE_SHIFT;
+constexpr uint16_t GBATileExporter::TRANSPARENT;
+
+namespace
+{
+/** Number of backgrounds available in each mode */
+const uint32_t MODE_BACKGROUNDS[3] = {4, 3, 2};
+const uint32_t AFFINE_SIZES[4] = {16, 32, 64, 128};
+const uint32_t REGULAR_SIZES[2] = {32, 64};
+}
+
+GBATileExporter::GBATileExporter(uint32_t _mode, Bpp _bpp) : mode(_mode), bpp(_bpp), tileset_width(0), tileset_height(0),
+    tile_width(TILE_SIZE), tile_height(TILE_SIZE)
+{
+    if (mode > 2)
+        throw "Only GBA modes 0-2 have tiled backgrounds";
+    if (mode != 0 && bpp == Bpp4)
+    {
+        WarnLog("Mode %d has an affine background which only supports 8bpp, using 8bpp for all backgrounds", mode);
+        bpp = Bpp8;
+    }
+
+    // Tile 0 is kept blank so empty spots in the map do not need a tile of their own.
+    const TilePixels blank(TILE_SIZE * TILE_SIZE, TRANSPARENT);
+    for (TilePool* pool : {&regular_pool, &affine_pool})
+    {
+        pool->tiles.push_back(blank);
+        pool->index[Hash(blank)].push_back(0);
+    }
+}
+
+void GBATileExporter::SetTileset(const uint8_t* rgba, uint32_t width, uint32_t height, uint32_t _tile_width, uint32_t _tile_height, bool quantize)
+{
+    if (_tile_width == 0 || _tile_height == 0 || _tile_width % TILE_SIZE || _tile_height % TILE_SIZE)
+        throw "Tile dimensions must be a multiple of 8 for GBA backgrounds";
+
+    tileset_width = width;
+    tileset_height = height;
+    tile_width = _tile_width;
+    tile_height = _tile_height;
+
+    tileset.resize(width * height);
+    quantized_banks.clear();
+    for (uint32_t i = 0; i < width * height; i++)
+    {
+        const uint8_t* pixel = rgba + i * 4;
+        tileset[i] = pixel[3] < 128 ? TRANSPARENT : ToBGR555(pixel[0], pixel[1], pixel[2]);
+    }
+
+    if (quantize && !FitsPalette())
+    {
+        // Quantize in the 15 bit color space so nothing is lost converting the result.
+        std::vector<uint8_t> reduced(rgba, rgba + width * height * 4);
+        for (uint32_t i = 0; i < reduced.size(); i++)
+            reduced[i] &= (i % 4 == 3) ? 0xFF : 0xF8;
+
+        if (bpp == Bpp4)
+        {
+            TilePalettes palettes = QuantizeTiles(reduced.data(), width, height, TILE_SIZE, TILE_SIZE, 16, 15);
+            for (const auto& colors : palettes.palettes)
+            {
+                std::vector<uint16_t> bank;
+                for (uint32_t color : colors)
+                    bank.push_back(ToBGR555(color >> 16, (color >> 8) & 0xFF, color & 0xFF));
+                std::sort(bank.begin(), bank.end());
+                bank.erase(std::unique(bank.begin(), bank.end()), bank.end());
+                quantized_banks.push_back(bank);
+            }
+        }
+        else
+        {
+            QuantizeImage(reduced.data(), width, height, 255);
+        }
+        VerboseLog("Reduced the tileset's colors to fit %s", bpp == Bpp4 ? "16 palette banks" : "256 colors");
+
+        for (uint32_t i = 0; i < width * height; i++)
+        {
+            const uint8_t* pixel = &reduced[i * 4];
+            tileset[i] = pixel[3] < 128 ? TRANSPARENT : ToBGR555(pixel[0], pixel[1], pixel[2]);
+        }
+    }
+
+    // Tiles already converted came from the old image.
+    regular_pool.converted.clear();
+    affine_pool.converted.clear();
+}
+
+bool GBATileExporter::IsAffine(uint32_t background) const
+{
+    return mode == 2 || (mode == 1 && background == 2);
+}
+
+bool GBATileExporter::Add(const Layer& layer, const std::vector<AnimatedTile>& animated_tiles)
+{
+    if (backgrounds.size() >= MODE_BACKGROUNDS[mode])
+    {
+        WarnLog("Mode %d only has %d backgrounds, skipping layer %s", mode, MODE_BACKGROUNDS[mode], layer.GetName().c_str());
+        return false;
+    }
+
+    Background background;
+    background.name = layer.GetName();
+    background.affine = IsAffine(backgrounds.size());
+
+    uint32_t tiles_x = tile_width / TILE_SIZE;
+    uint32_t tiles_y = tile_height / TILE_SIZE;
+    uint32_t width = layer.GetWidth() * tiles_x;
+    uint32_t height = layer.GetHeight() * tiles_y;
+
+    if (background.affine)
+    {
+        const uint32_t* size = std::find_if(AFFINE_SIZES, AFFINE_SIZES + 4, [&](uint32_t s) { return s >= width && s >= height; });
+        if (size == AFFINE_SIZES + 4)
+            throw "Layer is too large for an affine background (at most 128x128 tiles)";
+        background.width = background.height = *size;
+    }
+    else
+    {
+        const uint32_t* size_x = std::find_if(REGULAR_SIZES, REGULAR_SIZES + 2, [&](uint32_t s) { return s >= width; });
+        const uint32_t* size_y = std::find_if(REGULAR_SIZES, REGULAR_SIZES + 2, [&](uint32_t s) { return s >= height; });
+        if (size_x == REGULAR_SIZES + 2 || size_y == REGULAR_SIZES + 2)
+            throw "Layer is too large for a regular background (at most 64x64 tiles)";
+        background.width = *size_x;
+        background.height = *size_y;
+    }
+    background.entries.resize(background.width * background.height, 0);
+
+    TilePool& pool = background.affine ? affine_pool : regular_pool;
+    uint32_t screenblocks_x = background.width / SCREENBLOCK_SIZE;
+    for (uint32_t y = 0; y < layer.GetHeight(); y++)
+    {
+        for (uint32_t x = 0; x < layer.GetWidth(); x++)
+        {
+            uint32_t tile = layer.At(x, y);
+            if (tile != TiledLayerData::NULL_TILE && (tile >> 31))
+            {
+                uint32_t animation = tile & ~(1u << 31);
+                tile = animation < animated_tiles.size() && animated_tiles[animation].GetNumFrames() ? animated_tiles[animation][0] :
+                       TiledLayerData::NULL_TILE;
+            }
+
+            const std::vector<uint16_t>& entries = Convert(pool, tile, background.affine);
+            for (uint32_t j = 0; j < tiles_y; j++)
+            {
+                for (uint32_t i = 0; i < tiles_x; i++)
+                {
+                    uint32_t tx = x * tiles_x + i;
+                    uint32_t ty = y * tiles_y + j;
+                    uint32_t offset;
+                    if (background.affine)
+                    {
+                        offset = ty * background.width + tx;
+                    }
+                    else
+                    {
+                        uint32_t screenblock = (ty / SCREENBLOCK_SIZE) * screenblocks_x + tx / SCREENBLOCK_SIZE;
+                        offset = screenblock * SCREENBLOCK_SIZE * SCREENBLOCK_SIZE + (ty % SCREENBLOCK_SIZE) * SCREENBLOCK_SIZE + tx % SCREENBLOCK_SIZE;
+                    }
+                    background.entries[offset] = entries[j * tiles_x + i];
+                }
+            }
+        }
+    }
+
+    backgrounds.push_back(background);
+    return true;
+}
+
+const std::vector<uint16_t>& GBATileExporter::Convert(TilePool& pool, uint32_t tile, bool affine)
+{
+    uint32_t columns = tileset_width / tile_width;
+    uint32_t rows = tileset_height / tile_height;
+    if (tile != TiledLayerData::NULL_TILE && tile >= columns * rows)
+    {
+        WarnLog("Tile %d is outside of the tileset, exporting it as blank", tile);
+        tile = TiledLayerData::NULL_TILE;
+    }
+
+    // Map tiles are reused a lot so each one is only cut up and looked up once.
+    auto found = pool.converted.find(tile);
+    if (found != pool.converted.end())
+        return found->second;
+
+    uint32_t tiles_x = tile_width / TILE_SIZE;
+    uint32_t tiles_y = tile_height / TILE_SIZE;
+    std::vector<uint16_t>& entries = pool.converted[tile];
+    entries.resize(tiles_x * tiles_y, 0);
+    if (tile == TiledLayerData::NULL_TILE)
+        return entries;
+
+    uint32_t left = (tile % columns) * tile_width;
+    uint32_t top = (tile / columns) * tile_height;
+    TilePixels pixels(TILE_SIZE * TILE_SIZE);
+    for (uint32_t j = 0; j < tiles_y; j++)
+    {
+        for (uint32_t i = 0; i < tiles_x; i++)
+        {
+            for (uint32_t y = 0; y < TILE_SIZE; y++)
+            {
+                const uint16_t* row = &tileset[(top + j * TILE_SIZE + y) * tileset_width + left + i * TILE_SIZE];
+                std::copy(row, row + TILE_SIZE, pixels.begin() + y * TILE_SIZE);
+            }
+            entries[j * tiles_x + i] = Find(pool, pixels, affine);
+        }
+    }
+
+    return entries;
+}
+
+uint16_t GBATileExporter::Find(TilePool& pool, const TilePixels& pixels, bool affine)
+{
+    // Flips are involutions so if a flipped copy of this tile is stored then this tile is that tile flipped back.
+    const int flips = affine ? 1 : 4;
+    for (int flip = 0; flip < flips; flip++)
+    {
+        bool horizontal = flip & 1;
+        bool vertical = flip & 2;
+        TilePixels flipped = flip ? Flip(pixels, horizontal, vertical) : pixels;
+
+        auto found = pool.index.find(Hash(flipped));
+        if (found == pool.index.end())
+            continue;
+
+        for (uint32_t id : found->second)
+        {
+            if (pool.tiles[id] == flipped)
+                return id | (horizontal ? HFLIP : 0) | (vertical ? VFLIP : 0);
+        }
+    }
+
+    uint32_t id = pool.tiles.size();
+    if (id >= (affine ? MAX_AFFINE_TILES : MAX_REGULAR_TILES))
+    {
+        WarnLog("%s backgrounds can use at most %d unique tiles", affine ? "Affine" : "Regular", affine ? MAX_AFFINE_TILES : MAX_REGULAR_TILES);
+        throw "Map uses too many unique tiles for a GBA background";
+    }
+    pool.tiles.push_back(pixels);
+    pool.index[Hash(pixels)].push_back(id);
+    return id;
+}
+
+void GBATileExporter::Finish()
+{
+    palette.clear();
+    color_index.clear();
+
+    if (bpp == Bpp4)
+    {
+        BuildPalette4();
+        for (auto& background : backgrounds)
+        {
+            for (auto& entry : background.entries)
+                entry |= regular_pool.banks[entry & (MAX_REGULAR_TILES - 1)] << PALETTE_SHIFT;
+        }
+        Pack(regular_pool, Bpp4);
+    }
+    else
+    {
+        BuildPalette8();
+        Pack(regular_pool, Bpp8);
+        Pack(affine_pool, Bpp8);
+    }
+}
+
+bool GBATileExporter::FitsPalette() const
+{
+    std::vector<TilePixels> tiles;
+    for (uint32_t top = 0; top + TILE_SIZE <= tileset_height; top += TILE_SIZE)
+    {
+        for (uint32_t left = 0; left + TILE_SIZE <= tileset_width; left += TILE_SIZE)
+        {
+            TilePixels pixels;
+            for (uint32_t y = top; y < top + TILE_SIZE; y++)
+                pixels.insert(pixels.end(), tileset.begin() + y * tileset_width + left, tileset.begin() + y * tileset_width + left + TILE_SIZE);
+            tiles.push_back(pixels);
+        }
+    }
+
+    if (bpp == Bpp4)
+    {
+        std::vector<std::vector<uint16_t>> banks;
+        std::vector<uint32_t> assignment;
+        return AssignBanks(TileColors(tiles), banks, assignment);
+    }
+
+    std::vector<uint16_t> colors(tileset);
+    std::sort(colors.begin(), colors.end());
+    colors.erase(std::unique(colors.begin(), colors.end()), colors.end());
+    colors.erase(std::remove(colors.begin(), colors.end(), TRANSPARENT), colors.end());
+    return colors.size() <= 255;
+}
+
+std::vector<std::vector<uint16_t>> GBATileExporter::TileColors(const std::vector<TilePixels>& tiles)
+{
+    std::vector<std::vector<uint16_t>> tile_colors(tiles.size());
+    for (uint32_t i = 0; i < tiles.size(); i++)
+    {
+        std::vector<uint16_t>& colors = tile_colors[i];
+        for (uint16_t color : tiles[i])
+            if (color != TRANSPARENT)
+                colors.push_back(color);
+        std::sort(colors.begin(), colors.end());
+        colors.erase(std::unique(colors.begin(), colors.end()), colors.end());
+    }
+    return tile_colors;
+}
+
+void GBATileExporter::BuildPalette4()
+{
+    std::vector<std::vector<uint16_t>> tile_colors = TileColors(regular_pool.tiles);
+    for (const auto& colors : tile_colors)
+    {
+        if (colors.size() > 15)
+            throw "A tile uses more than 15 colors and can not be exported as 4bpp";
+    }
+
+    std::vector<std::vector<uint16_t>> banks;
+    if (!AssignBanks(tile_colors, banks, regular_pool.banks))
+    {
+        // Packing is greedy so it can miss, but every quantized tile fits in the palette it was quantized to.
+        if (quantized_banks.empty())
+            throw "Tiles use too many colors to fit in 16 palette banks, export as 8bpp";
+
+        banks = quantized_banks;
+        for (uint32_t i = 0; i < tile_colors.size(); i++)
+        {
+            auto bank = std::find_if(banks.begin(), banks.end(), [&](const std::vector<uint16_t>& b)
+            {
+                return std::includes(b.begin(), b.end(), tile_colors[i].begin(), tile_colors[i].end());
+            });
+            if (bank == banks.end())
+                throw "Tiles use too many colors to fit in 16 palette banks, export as 8bpp";
+            regular_pool.banks[i] = bank - banks.begin();
+        }
+    }
+
+    palette.assign(std::max<size_t>(banks.size(), 1) * 16, 0);
+    for (uint32_t i = 0; i < banks.size(); i++)
+        std::copy(banks[i].begin(), banks[i].end(), palette.begin() + i * 16 + 1);
+}
+
+bool GBATileExporter::AssignBanks(const std::vector<std::vector<uint16_t>>& tile_colors, std::vector<std::vector<uint16_t>>& banks,
+                                  std::vector<uint32_t>& assignment)
+{
+    // Placing the tiles with the most colors first leaves the small ones to fill the gaps.
+    std::vector<uint32_t> order(tile_colors.size());
+    for (uint32_t i = 0; i < order.size(); i++)
+        order[i] = i;
+    std::stable_sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) { return tile_colors[a].size() > tile_colors[b].size(); });
+
+    banks.clear();
+    assignment.assign(tile_colors.size(), 0);
+    for (uint32_t tile : order)
+    {
+        const std::vector<uint16_t>& colors = tile_colors[tile];
+        if (colors.size() > 15)
+            return false;
+        uint32_t best = banks.size();
+        uint32_t best_added = 16;
+        for (uint32_t i = 0; i < banks.size(); i++)
+        {
+            uint32_t added = 0;
+            for (uint16_t color : colors)
+                added += !std::binary_search(banks[i].begin(), banks[i].end(), color);
+            if (banks[i].size() + added <= 15 && added < best_added)
+            {
+                best = i;
+                best_added = added;
+            }
+        }
+
+        if (best == banks.size())
+        {
+            if (banks.size() == 16)
+                return false;
+            banks.emplace_back();
+        }
+
+        std::vector<uint16_t>& bank = banks[best];
+        std::vector<uint16_t> merged;
+        std::set_union(bank.begin(), bank.end(), colors.begin(), colors.end(), std::back_inserter(merged));
+        bank.swap(merged);
+        assignment[tile] = best;
+    }
+
+    return true;
+}
+
+void GBATileExporter::BuildPalette8()
+{
+    palette.assign(1, 0);
+    for (const TilePool* pool : {&regular_pool, &affine_pool})
+    {
+        for (const auto& tile : pool->tiles)
+        {
+            for (uint16_t color : tile)
+            {
+                if (color == TRANSPARENT || color_index.count(color))
+                    continue;
+                if (palette.size() == 256)
+                    throw "Tiles use more than 255 colors and do not fit in an 8bpp palette";
+                color_index[color] = palette.size();
+                palette.push_back(color);
+            }
+        }
+    }
+}
+
+void GBATileExporter::Pack(TilePool& pool, Bpp depth)
+{
+    const uint32_t tile_bytes = TILE_SIZE * TILE_SIZE * depth / 8;
+    pool.graphics.assign(pool.tiles.size() * tile_bytes, 0);
+    for (uint32_t i = 0; i < pool.tiles.size(); i++)
+    {
+        uint8_t* out = &pool.graphics[i * tile_bytes];
+        const uint16_t* bank = depth == Bpp4 ? &palette[pool.banks[i] * 16] : NULL;
+        for (uint32_t j = 0; j < TILE_SIZE * TILE_SIZE; j++)
+        {
+            uint16_t color = pool.tiles[i][j];
+            uint8_t index = 0;
+            if (color != TRANSPARENT)
+                index = depth == Bpp4 ? std::find(bank + 1, bank + 16, color) - bank : color_index[color];
+
+            // 4bpp tiles store the left pixel of each pair in the low nibble.
+            if (depth == Bpp4)
+                out[j / 2] |= (j & 1) ? index << 4 : index;
+            else
+                out[j] = index;
+        }
+    }
+}
+
+uint64_t GBATileExporter::Hash(const TilePixels& pixels)
+{
+    // FNV-1a
+    uint64_t hash = 14695981039346656037ULL;
+    for (uint16_t color : pixels)
+    {
+        hash = (hash ^ (color & 0xFF)) * 1099511628211ULL;
+        hash = (hash ^ (color >> 8)) * 1099511628211ULL;
+    }
+    return hash;
+}
+
+GBATileExporter::TilePixels GBATileExporter::Flip(const TilePixels& pixels, bool horizontal, bool vertical)
+{
+    TilePixels flipped(pixels.size());
+    for (uint32_t y = 0; y < TILE_SIZE; y++)
+    {
+        for (uint32_t x = 0; x < TILE_SIZE; x++)
+        {
+            uint32_t fx = horizontal ? TILE_SIZE - 1 - x : x;
+            uint32_t fy = vertical ? TILE_SIZE - 1 - y : y;
+            flipped[fy * TILE_SIZE + fx] = pixels[y * TILE_SIZE + x];
+        }
+    }
+    return flipped;
+}
@@ -0,0 +1,169 @@
+/******************************************************************************************************
+ * Tile Map Editor
+ * Copyright (C) 2009-2017 Brandon Whitehead (tricksterguy87[AT]gmail[DOT]com)
+ *
+ * This software is provided 'as-is', without any express or implied warranty.
+ * In no event will the authors be held liable for any damages arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * excluding commercial applications, and to alter it and redistribute it freely,
+ * subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented;
+ *    you must not claim that you wrote the original software.
+ *    An acknowledgement in your documentation and link to the original version is required.
+ *
+ * 2. Altered source versions must be plainly marked as such,
+ *    and must not be misrepresented as being the original software.
+ *
+ * 3. This notice may not be removed or altered from any source distribution.
+ ******************************************************************************************************/
+#ifndef GBA_TILE_EXPORTER_HPP
+#define GBA_TILE_EXPORTER_HPP
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "AnimatedTile.hpp"
+#include "Layer.hpp"
+
+/** Converts layers into the data a GBA needs for tiled backgrounds (modes 0-2).
+  *
+  * Map tiles are cut into 8x8 hardware tiles which are deduplicated through a hash index,
+  * regular backgrounds also reuse tiles that are horizontal and/or vertical flips of each other.
+  * Regular background maps are 32 or 64 tiles on each axis sliced into 32x32 screenblocks,
+  * affine background maps are square (16, 32, 64 or 128 tiles) with one byte per entry.
+  *
+  * This class only deals with pixels, see GBAMapHandler for loading the tileset and writing files.
+  */
+class GBATileExporter
+{
+public:
+    /** Size of a hardware tile in pixels */
+    static constexpr uint32_t TILE_SIZE = 8;
+    /** Size of a screenblock in tiles */
+    static constexpr uint32_t SCREENBLOCK_SIZE = 32;
+    /** Maximum number of tiles regular and affine backgrounds can index */
+    static constexpr uint32_t MAX_REGULAR_TILES = 1024;
+    static constexpr uint32_t MAX_AFFINE_TILES = 256;
+    /** Screen entry bits for regular backgrounds */
+    static constexpr uint16_t HFLIP = 1 << 10;
+    static constexpr uint16_t VFLIP = 1 << 11;
+    static constexpr uint32_t PALETTE_SHIFT = 12;
+
+    enum Bpp
+    {
+        /** 16 palette banks of 15 colors, each tile uses one bank */
+        Bpp4 = 4,
+        /** One palette of 255 colors */
+        Bpp8 = 8,
+    };
+
+    /** A converted layer */
+    struct Background
+    {
+        std::string name;
+        bool affine;
+        /** Dimensions in hardware tiles after padding */
+        uint32_t width;
+        uint32_t height;
+        /** Screen entries, for regular backgrounds grouped into screenblocks (left to right then top to bottom)
+          * for affine backgrounds one tile index per entry row by row.
+          */
+        std::vector<uint16_t> entries;
+    };
+
+    /** Creates an exporter.
+      * @param mode Video mode 0, 1 or 2. Decides which layers become affine backgrounds.
+      * @param bpp Color depth of the tiles, modes 1 and 2 always use 8bpp since they share the palette with an affine background.
+      */
+    GBATileExporter(uint32_t mode = 0, Bpp bpp = Bpp4);
+
+    /** Sets the image the map's tiles are cut from.
+      * @param rgba Pixels as 4 bytes (red, green, blue, alpha) each, alpha below 128 is transparent.
+      * @param width Width of the image in pixels.
+      * @param height Height of the image in pixels.
+      * @param tile_width Width of a map tile, must be a multiple of 8.
+      * @param tile_height Height of a map tile, must be a multiple of 8.
+      * @param quantize If the tileset's colors do not fit the palette (16 banks of 15 colors for 4bpp, 255 colors for 8bpp)
+      *                 reduce them with QuantizeTiles, tilesets that already fit are left as is.
+      */
+    void SetTileset(const uint8_t* rgba, uint32_t width, uint32_t height, uint32_t tile_width, uint32_t tile_height, bool quantize = false);
+    /** Converts a layer into the next background.
+      * Animated tiles are exported as their first frame.
+      * @param layer Layer to convert.
+      * @param animated_tiles Animated tiles of the map's tileset.
+      * @return false if the mode has no backgrounds left and the layer was skipped.
+      * @throws const char* if the layer is larger than the background can be (64x64 regular, 128x128 affine hardware tiles).
+      */
+    bool Add(const Layer& layer, const std::vector<AnimatedTile>& animated_tiles = std::vector<AnimatedTile>());
+    /** Builds the palette and tile graphics once all layers are added. */
+    void Finish();
+
+    uint32_t GetMode() const { return mode; }
+    Bpp GetBpp() const { return bpp; }
+    /** @return The palette as BGR555 colors, 16 per bank for 4bpp and up to 256 for 8bpp */
+    const std::vector<uint16_t>& GetPalette() const { return palette; }
+    /** @return Tile graphics for the regular or affine backgrounds */
+    const std::vector<uint8_t>& GetTiles(bool affine = false) const { return affine ? affine_pool.graphics : regular_pool.graphics; }
+    uint32_t GetNumTiles(bool affine = false) const { return (affine ? affine_pool : regular_pool).tiles.size(); }
+    const std::vector<Background>& GetBackgrounds() const { return backgrounds; }
+
+    /** Converts an RGBA color to BGR555 */
+    static uint16_t ToBGR555(uint8_t r, uint8_t g, uint8_t b) { return (r >> 3) | ((g >> 3) << 5) | ((b >> 3) << 10); }
+
+private:
+    /** 64 BGR555 colors, TRANSPARENT for transparent pixels */
+    typedef std::vector<uint16_t> TilePixels;
+    static constexpr uint16_t TRANSPARENT = 0x8000;
+
+    /** Unique tiles used by one kind of background */
+    struct TilePool
+    {
+        std::vector<TilePixels> tiles;
+        /** Palette bank of each tile (4bpp only) */
+        std::vector<uint32_t> banks;
+        /** Hash of the tile's pixels to the indices of tiles with that hash */
+        std::unordered_map<uint64_t, std::vector<uint32_t>> index;
+        /** Map tile (after resolving animations) to its hardware tile screen entries */
+        std::unordered_map<uint32_t, std::vector<uint16_t>> converted;
+        std::vector<uint8_t> graphics;
+    };
+
+    const std::vector<uint16_t>& Convert(TilePool& pool, uint32_t tile, bool affine);
+    uint16_t Find(TilePool& pool, const TilePixels& pixels, bool affine);
+    bool FitsPalette() const;
+    void BuildPalette4();
+    void BuildPalette8();
+    void Pack(TilePool& pool, Bpp depth);
+    bool IsAffine(uint32_t background) const;
+
+    static std::vector<std::vector<uint16_t>> TileColors(const std::vector<TilePixels>& tiles);
+    /** Packs the tiles' colors into as few palette banks as it can.
+      * @return false if a tile has more than 15 colors or more than 16 banks are needed.
+      */
+    static bool AssignBanks(const std::vector<std::vector<uint16_t>>& tile_colors, std::vector<std::vector<uint16_t>>& banks,
+                            std::vector<uint32_t>& assignment);
+    static uint64_t Hash(const TilePixels& pixels);
+    static TilePixels Flip(const TilePixels& pixels, bool horizontal, bool vertical);
+
+    uint32_t mode;
+    Bpp bpp;
+    std::vector<uint16_t> tileset;
+    uint32_t tileset_width;
+    uint32_t tileset_height;
+    uint32_t tile_width;
+    uint32_t tile_height;
+    TilePool regular_pool;
+    TilePool affine_pool;
+    std::vector<uint16_t> palette;
+    /** Palette banks from quantizing the tileset (4bpp only) */
+    std::vector<std::vector<uint16_t>> quantized_banks;
+    /** Color to palette index for 8bpp */
+    std::unordered_map<uint16_t, uint8_t> color_index;
+    std::vector<Background> backgrounds;
+};
+
+#endif
@@ -20,39 +20,79 @@
  ******************************************************************************************************/
 #include "HandlerUtils.hpp"
 
+#include <algorithm>
+#include <cstring>
+
+#include "TileCompositor.hpp"
+
 /** MapToImage
   *
   * Converts a map into an ImageMagick Image
   */
 int HandlerUtils::MapToImage(const Map& map, Magick::Image& image)
 {
-    std::vector<Magick::Image> tiles;
+    std::vector<uint8_t> rgba;
+    uint32_t width, height;
+    if (HandlerUtils::MapToPixels(map, map.GetLayers(), rgba, width, height))
+        return -1;
 
-    if (HandlerUtils::GetTiles(map, tiles))
+    return HandlerUtils::PixelsToImage(rgba, width, height, image);
+}
+
+/** layerToImage
+  *
+  * Converts a layer into an ImageMagick Image
+  */
+int HandlerUtils::LayerToImage(const Map& map, const Layer& layer, Magick::Image& image)
+{
+    std::vector<uint8_t> rgba;
+    uint32_t width, height;
+    if (HandlerUtils::MapToPixels(map, std::vector<Layer>(1, layer), rgba, width, height))
         return -1;
 
-    Magick::Color color = Magick::ColorRGB(0, 0, 0);
-    color.alpha(0);
+    return HandlerUtils::PixelsToImage(rgba, width, height, image);
+}
+
+/** mapToPixels
+  *
+  * Draws layers of a map as RGBA bytes
+  */
+int HandlerUtils::MapToPixels(const Map& map, const std::vector<Layer>& layers, std::vector<uint8_t>& rgba, uint32_t& width, uint32_t& height)
+{
+    std::shared_ptr<const TilesetImage> image = HandlerUtils::GetTilesetImage(map);
+    if (!image)
+        return -1;
 
     const Tileset& tileset = map.GetTileset();
     uint32_t tile_width, tile_height;
     tileset.GetTileDimensions(tile_width, tile_height);
+    std::vector<uint8_t> tileset_rgba;
+    image->GetPixels(tileset_rgba);
+    TileCompositor compositor(tileset_rgba.data(), image->GetWidth(), image->GetHeight(), tile_width, tile_height,
+                              tileset.GetAnimatedTiles());
 
-    int width = map.GetWidth() * tile_width;
-    int height = map.GetHeight() * tile_height;
+    width = 0;
+    height = 0;
+    for (const auto& layer : layers)
+    {
+        width = std::max(width, layer.GetWidth() * tile_width);
+        height = std::max(height, layer.GetHeight() * tile_height);
+    }
+    rgba.resize(static_cast<size_t>(width) * height * 4);
+    compositor.Render(layers, 0, 0, width, height, rgba.data(), 0);
 
-    image.matte(true);
-    image.resize(Magick::Geometry(width, height));
-    image.backgroundColor(color);
-    image.erase();
+    return 0;
+}
 
+/** pixelsToImage
+  *
+  * Converts RGBA bytes to an ImageMagick Image
+  */
+int HandlerUtils::PixelsToImage(const std::vector<uint8_t>& rgba, uint32_t width, uint32_t height, Magick::Image& image)
+{
     try
     {
-        for (const auto& layer : map.GetLayers())
-        {
-            if (HandlerUtils::LayerToImage(map, layer, tiles, image))
-                return -1;
-        }
+        image = Magick::Image(width, height, "RGBA", Magick::CharPixel, rgba.data());
     }
     catch (Magick::Exception& error_)
     {
@@ -62,87 +102,122 @@ int HandlerUtils::MapToImage(const Map& map, Magick::Image& image)
     return 0;
 }
 
-/** layerToImage
+/** getTiles
   *
-  * Converts a layer into an ImageMagick Image
+  * Given a map gets the tiles for the map
   */
-int HandlerUtils::LayerToImage(const Map& map, const Layer& layer, Magick::Image& image)
+int HandlerUtils::GetTiles(const Map& map, std::vector<Magick::Image>& tiles)
 {
-    std::vector<Magick::Image> tiles;
-
-    if (HandlerUtils::GetTiles(map, tiles))
+    std::shared_ptr<const TilesetImage> image = HandlerUtils::GetTilesetImage(map);
+    if (!image)
         return -1;
 
-    Magick::Color color = Magick::ColorRGB(0, 0, 0);
-    color.alpha(0);
-    int width = map.GetWidth() * map.GetTileWidth();
-    int height = map.GetHeight() * map.GetTileHeight();
-    image.matte(true);
-    image.resize(Magick::Geometry(width, height));
-    image.backgroundColor(color);
-    image.erase();
+    uint32_t tile_width, tile_height;
+    image->GetTileDimensions(tile_width, tile_height);
+    tiles.resize(image->GetNumTiles());
+    try
+    {
+        for (uint32_t i = 0; i < image->GetNumTiles(); i++)
+            tiles[i] = Magick::Image(tile_width, tile_height, "RGBA", Magick::CharPixel, image->GetTile(i));
+    }
+    catch (Magick::Exception& error_)
+    {
+        return -1;
+    }
 
-    return HandlerUtils::LayerToImage(map, layer, tiles, image);
+    return 0;
 }
 
-/** getTiles
+/** loadTileset
   *
-  * Given a map gets the tiles for the map
+  * Loads a tileset into the image passed in.
   */
-int HandlerUtils::GetTiles(const Map& map, std::vector<Magick::Image>& tiles)
+int HandlerUtils::LoadTileset(const Map& map, Magick::Image& image)
 {
-    Magick::Image tileset(Magick::Geometry(32, 32), Magick::ColorRGB(1, 1, 1));
-
-    if (HandlerUtils::LoadTileset(map, tileset))
+    const std::string& filename = map.GetTileset().GetFilename();
+    if (filename.empty())
         return -1;
 
-    int numTilesX = tileset.columns() / map.GetTileWidth();
-    int numTilesY = tileset.rows() / map.GetTileHeight();
-    tiles.reserve(numTilesX * numTilesY);
-    for (int i = 0; i < numTilesY; i++)
+    try
     {
-        for (int j = 0; j < numTilesX; j++)
-        {
-            Magick::Geometry dim(map.GetTileWidth(), map.GetTileHeight(), j * map.GetTileWidth(), i * map.GetTileHeight());
-            int index = i * numTilesX + j;
-            tiles[index] = tileset;
-            tiles[index].crop(dim);
-        }
+        image.read(filename);
+    }
+    catch (Magick::Exception& error_)
+    {
+        return -1;
     }
+
     return 0;
 }
 
 /** loadTileset
   *
-  * Loads a tileset into the image passed in.
+  * Loads the pixels of the tileset as RGBA bytes.
   */
-int HandlerUtils::LoadTileset(const Map& map, Magick::Image& image)
+int HandlerUtils::LoadTileset(const Map& map, std::vector<uint8_t>& rgba, uint32_t& width, uint32_t& height)
 {
-    if (map.GetFilename().empty())
+    std::shared_ptr<const TilesetImage> image = HandlerUtils::GetTilesetImage(map);
+    if (!image)
         return -1;
 
-    image.read(/*RESOURCE_POOL +*/ map.GetFilename());
+    image->GetPixels(rgba);
+    width = image->GetWidth();
+    height = image->GetHeight();
+    return 0;
+}
+
+/** getTilesetImage
+  *
+  * Gets the map's tileset through the cache.
+  */
+std::shared_ptr<const TilesetImage> HandlerUtils::GetTilesetImage(const Map& map)
+{
+    const Tileset& tileset = map.GetTileset();
+    if (tileset.GetFilename().empty())
+        return nullptr;
+
+    uint32_t tile_width, tile_height;
+    tileset.GetTileDimensions(tile_width, tile_height);
+    return TilesetCache().Get(tileset.GetFilename(), tile_width, tile_height);
+}
+
+/** loadImage
+  *
+  * Loads the pixels of an image as RGBA bytes.
+  */
+int HandlerUtils::LoadImage(const std::string& filename, std::vector<uint8_t>& rgba, uint32_t& width, uint32_t& height)
+{
+    Magick::Image image;
+    try
+    {
+        image.read(filename);
+        width = image.columns();
+        height = image.rows();
+        rgba.resize(width * height * 4);
+        image.write(0, 0, width, height, "RGBA", Magick::CharPixel, rgba.data());
+    }
+    catch (Magick::Exception& error_)
+    {
+        return -1;
+    }
 
     return 0;
 }
 
-/** layerToImage
+/** saveImage
   *
-  * Converts a layer into an ImageMagick Image
+  * Saves RGBA bytes as an image.
   */
-int HandlerUtils::LayerToImage(const Map& map, const Layer& layer, std::vector<Magick::Image>& tiles,
-                               Magick::Image& image)
+int HandlerUtils::SaveImage(const std::string& filename, const std::vector<uint8_t>& rgba, uint32_t width, uint32_t height)
 {
-    for (unsigned int i = 0; i < map.GetHeight(); i++)
+    try
     {
-        for (unsigned int j = 0; j < map.GetWidth(); j++)
-        {
-            int index = i * map.GetWidth() + j;
-            int tile = layer[index];
-            if (tile == -1)
-                continue;
-            image.composite(tiles[tile], j * map.GetTileWidth(), i * map.GetTileHeight(), Magick::AtopCompositeOp);
-        }
+        Magick::Image image(width, height, "RGBA", Magick::CharPixel, rgba.data());
+        image.write(filename);
+    }
+    catch (Magick::Exception& error_)
+    {
+        return -1;
     }
 
     return 0;
@@ -154,19 +229,36 @@ int HandlerUtils::LayerToImage(const Map& map, const Layer& layer, std::vector<M
   */
 int HandlerUtils::GetTiles(const Map& map, Magick::Image& tileset, std::vector<Magick::Image>& tiles)
 {
-    int numTilesX = tileset.columns() / map.GetTileWidth();
-    int numTilesY = tileset.rows() / map.GetTileHeight();
-    tiles.reserve(numTilesX * numTilesY);
-    for (int i = 0; i < numTilesY; i++)
+    uint32_t tile_width, tile_height;
+    map.GetTileset().GetTileDimensions(tile_width, tile_height);
+
+    // Read the pixels out once instead of copying the whole tileset into every tile to crop it.
+    uint32_t width = tileset.columns();
+    uint32_t height = tileset.rows();
+    std::vector<uint8_t> rgba(static_cast<size_t>(width) * height * 4);
+    std::vector<uint8_t> tile(tile_width * tile_height * 4);
+    const uint32_t row_bytes = tile_width * 4;
+
+    uint32_t numTilesX = width / tile_width;
+    uint32_t numTilesY = height / tile_height;
+    tiles.resize(numTilesX * numTilesY);
+    try
     {
-        for (int j = 0; j < numTilesX; j++)
+        tileset.write(0, 0, width, height, "RGBA", Magick::CharPixel, rgba.data());
+        for (uint32_t i = 0; i < numTilesY; i++)
         {
-            Magick::Geometry dim(map.GetTileWidth(), map.GetTileHeight(), j * map.GetTileWidth(), i * map.GetTileHeight());
-            int index = i * numTilesX + j;
-            tiles[index] = tileset;
-            tiles[index].crop(dim);
+            for (uint32_t j = 0; j < numTilesX; j++)
+            {
+                for (uint32_t row = 0; row < tile_height; row++)
+                    memcpy(&tile[row * row_bytes], &rgba[((i * tile_height + row) * width + j * tile_width) * 4], row_bytes);
+                tiles[i * numTilesX + j] = Magick::Image(tile_width, tile_height, "RGBA", Magick::CharPixel, tile.data());
+            }
         }
     }
+    catch (Magick::Exception& error_)
+    {
+        return -1;
+    }
 
     return 0;
 }
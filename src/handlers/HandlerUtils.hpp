@@ -21,9 +21,11 @@
 #ifndef HANDLER_UTILS_HPP
 #define HANDLER_UTILS_HPP
 
+#include <memory>
 #include <Magick++.h>
 
 #include "Map.hpp"
+#include "TilesetCache.hpp"
 
 /** Utilities for loading/saving files.*/
 class HandlerUtils {
@@ -41,12 +43,58 @@ public:
       * @return nonzero on failure 0 on success.
       */
     static int LayerToImage(const Map& map, const Layer& layer, Magick::Image& image);
+    /** Draws layers of a map as RGBA bytes using a thread per core, see TileCompositor::Render.
+      * @param map Map object, its tileset is used to draw the layers.
+      * @param layers Layers to draw.
+      * @param rgba Where to store the pixels, 4 bytes (red, green, blue, alpha) each.
+      * @param width Width of the result in pixels, big enough for the widest layer.
+      * @param height Height of the result in pixels, big enough for the tallest layer.
+      * @return nonzero on failure 0 on success.
+      */
+    static int MapToPixels(const Map& map, const std::vector<Layer>& layers, std::vector<uint8_t>& rgba, uint32_t& width, uint32_t& height);
+    /** Converts RGBA bytes to an Magick::Image.
+      * @param rgba Pixels as 4 bytes (red, green, blue, alpha) each.
+      * @param width Width of the image in pixels.
+      * @param height Height of the image in pixels.
+      * @param image Image object to store the result.
+      * @return nonzero on failure 0 on success.
+      */
+    static int PixelsToImage(const std::vector<uint8_t>& rgba, uint32_t width, uint32_t height, Magick::Image& image);
     /** Loads the map tileset to an Magick::Image.
       * @param map Map object.
       * @param image Image object to store the result.
       * @return nonzero on failure 0 on success.
       */
     static int LoadTileset(const Map& map, Magick::Image& image);
+    /** Gets the map's tileset from TilesetCache, decoding it only if it is not already loaded.
+      * @param map Map object.
+      * @return The tileset or nullptr if it could not be loaded.
+      */
+    static std::shared_ptr<const TilesetImage> GetTilesetImage(const Map& map);
+    /** Loads the map tileset's pixels.
+      * @param map Map object.
+      * @param rgba Where to store the pixels, 4 bytes (red, green, blue, alpha) each.
+      * @param width Width of the tileset in pixels.
+      * @param height Height of the tileset in pixels.
+      * @return nonzero on failure 0 on success.
+      */
+    static int LoadTileset(const Map& map, std::vector<uint8_t>& rgba, uint32_t& width, uint32_t& height);
+    /** Loads an image's pixels.
+      * @param filename Path to the image.
+      * @param rgba Where to store the pixels, 4 bytes (red, green, blue, alpha) each.
+      * @param width Width of the image in pixels.
+      * @param height Height of the image in pixels.
+      * @return nonzero on failure 0 on success.
+      */
+    static int LoadImage(const std::string& filename, std::vector<uint8_t>& rgba, uint32_t& width, uint32_t& height);
+    /** Saves pixels as an image, the format is picked from the filename's extension.
+      * @param filename Path to save the image to.
+      * @param rgba Pixels as 4 bytes (red, green, blue, alpha) each.
+      * @param width Width of the image in pixels.
+      * @param height Height of the image in pixels.
+      * @return nonzero on failure 0 on success.
+      */
+    static int SaveImage(const std::string& filename, const std::vector<uint8_t>& rgba, uint32_t width, uint32_t height);
     /** Gets the tiles from the map to Magick::Images.
       * @param map Map object.
       * @param tiles Where to store the resulting images.
@@ -62,7 +110,6 @@ public:
     static int GetTiles(const Map& map, Magick::Image& tileset, std::vector<Magick::Image>& tiles);
 
 private:
-    static int LayerToImage(const Map& map, const Layer& layer, std::vector<Magick::Image>& tiles, Magick::Image& image);
     HandlerUtils() {};                             // Private constructor
     HandlerUtils(const HandlerUtils&);             // Prevent copy-construction
     HandlerUtils& operator=(const HandlerUtils&);  // Prevent assignment
@@ -27,7 +27,11 @@
 #include "GBAImageHandler.hpp"
 #include "GBAMapHandler.hpp"
 #include "ImageMapHandler.hpp"
+#include "ImagePyramidHandler.hpp"
+#include "ProtoMapHandler.hpp"
 #include "TextMapHandler.hpp"
+#include "TiledJsonMapHandler.hpp"
+#include "TmxMapHandler.hpp"
 #include "XmlMapHandler.hpp"
 
 #endif
@@ -23,12 +23,14 @@
 #include <Magick++.h>
 
 #include "HandlerUtils.hpp"
+#include "Logger.hpp"
+#include "TileImporter.hpp"
 
 using namespace Magick;
 
-/// TODO Is Imagemagick really necessary to use here?
-
-ImageMapHandler::ImageMapHandler() : BaseMapHandler("Map Image Writer", "png", "Exports the map as an image", false, false)
+ImageMapHandler::ImageMapHandler(uint32_t _tile_width, uint32_t _tile_height, const std::string& _tileset) :
+    BaseMapHandler("Map Image", "png", "Exports the map as an image or imports a map from an image"),
+    tile_width(_tile_width), tile_height(_tile_height), tileset(_tileset)
 {
     alternatives.insert("bmp");
     alternatives.insert("jpg");
@@ -40,10 +42,93 @@ int ImageMapHandler::Init()
     return 0;
 }
 
+void ImageMapHandler::Load(const std::string& filename, Map& map)
+{
+    VerboseLog("Loading %s using %s", filename.c_str(), name.c_str());
+    std::vector<uint8_t> rgba;
+    uint32_t width, height;
+    if (HandlerUtils::LoadImage(filename, rgba, width, height))
+        throw "Could not read image";
+
+    TileImporter importer(tile_width, tile_height);
+    if (!tileset.empty())
+    {
+        std::vector<uint8_t> tileset_rgba;
+        uint32_t tileset_width, tileset_height;
+        if (HandlerUtils::LoadImage(tileset, tileset_rgba, tileset_width, tileset_height))
+            throw "Could not read tileset image";
+        importer.SetTileset(tileset_rgba.data(), tileset_width, tileset_height);
+    }
+
+    std::string::size_type slash = filename.find_last_of("/\\");
+    std::string::size_type dot = filename.rfind('.');
+    if (dot == std::string::npos || (slash != std::string::npos && dot < slash))
+        dot = filename.size();
+    std::string base = slash == std::string::npos ? filename.substr(0, dot) : filename.substr(slash + 1, dot - slash - 1);
+
+    Layer layer = importer.Import(base, rgba.data(), width, height);
+
+    std::string tileset_filename = tileset;
+    if (tileset.empty() || importer.GetNumNewTiles() > 0)
+    {
+        tileset_filename = filename.substr(0, dot) + "-tileset.png";
+        importer.GetTileset(rgba, width, height);
+        if (HandlerUtils::SaveImage(tileset_filename, rgba, width, height))
+            throw "Could not save the generated tileset";
+        if (!tileset.empty())
+            WarnLog("%u tiles were not found in %s, the tileset with them added was saved to %s",
+                    importer.GetNumNewTiles(), tileset.c_str(), tileset_filename.c_str());
+    }
+
+    map.Clear();
+    map.SetName(base);
+    map.SetTileset(Tileset(tileset_filename, tile_width, tile_height));
+    map.Add(layer);
+}
+
+void ImageMapHandler::Load(std::istream& file, Map& map)
+{
+    throw "Images can only be imported from a file";
+}
+
+void ImageMapHandler::Load(const std::string& filename, MapVisitor& visitor)
+{
+    Map map;
+    Load(filename, map);
+    visitor.Visit(map);
+}
+
+void ImageMapHandler::Save(const std::string& filename, const Map& map)
+{
+    VerboseLog("Saving %s using %s", filename.c_str(), name.c_str());
+    Image image;
+    if (HandlerUtils::MapToImage(map, image))
+        throw "Failed to convert map to an image";
+    try
+    {
+        image.write(filename);
+    }
+    catch (Magick::Exception& error_)
+    {
+        throw "Could not write image";
+    }
+}
+
 void ImageMapHandler::Save(std::ostream& file, const Map& map)
 {
     Image image;
     if (HandlerUtils::MapToImage(map, image))
         throw "Failed to convert map to an image";
-    // image.write(file);
+
+    Blob blob;
+    try
+    {
+        image.magick("PNG");
+        image.write(&blob);
+    }
+    catch (Magick::Exception& error_)
+    {
+        throw "Could not write image";
+    }
+    file.write(static_cast<const char*>(blob.data()), blob.length());
 }
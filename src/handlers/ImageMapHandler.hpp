@@ -23,15 +23,47 @@
 
 #include "BaseMapHandler.hpp"
 
-/** Saves the entire map as an image */
+/** Saves the entire map as an image and imports images of maps.
+  *
+  * Importing cuts the image into tiles and matches them against a tileset (see TileImporter),
+  * the map gets a single layer. Tiles that are not in the tileset are saved along with the tileset's
+  * tiles to name-tileset.png next to the image, which becomes the map's tileset.
+  */
 class ImageMapHandler : public BaseMapHandler {
 public:
-    ImageMapHandler();
+    /** Creates the handler
+      * @param tile_width Width of the tiles in imported images.
+      * @param tile_height Height of the tiles in imported images.
+      * @param tileset Tileset image to match imported tiles against, if empty a tileset is built from the image.
+      */
+    ImageMapHandler(uint32_t tile_width = 8, uint32_t tile_height = 8, const std::string& tileset = "");
 
-    /** See BaseMapHandler::Init */
+    /** @see BaseMapHandler::Init */
     virtual int Init();
-    /** @see BaseMapHandler::Save */
+    /** @see BaseMapHandler::Load */
+    virtual void Load(const std::string& filename, Map& map);
+    /** @see BaseMapHandler::Load
+      * Images can only be imported given a filename since the generated tileset is saved next to it.
+      */
+    virtual void Load(std::istream& file, Map& map);
+    /** @see BaseMapHandler::Load */
+    virtual void Load(const std::string& filename, MapVisitor& visitor);
+    /** @see BaseMapHandler::Save
+      * The image format is picked from filename's extension.
+      */
+    virtual void Save(const std::string& filename, const Map& map);
+    /** @see BaseMapHandler::Save
+      * Saves the image as a png.
+      */
     virtual void Save(std::ostream& file, const Map& map);
+
+    void SetTileDimensions(uint32_t width, uint32_t height) { tile_width = width; tile_height = height; }
+    void SetTileset(const std::string& filename) { tileset = filename; }
+
+private:
+    uint32_t tile_width;
+    uint32_t tile_height;
+    std::string tileset;
 };
 
 #endif
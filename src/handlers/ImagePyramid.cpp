@@ -0,0 +1,200 @@
+/******************************************************************************************************
+ * Tile Map Editor
+ * Copyright (C) 2009-2017 Brandon Whitehead (tricksterguy87[AT]gmail[DOT]com)
+ *
+ * This software is provided 'as-is', without any express or implied warranty.
+ * In no event will the authors be held liable for any damages arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * excluding commercial applications, and to alter it and redistribute it freely,
+ * subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented;
+ *    you must not claim that you wrote the original software.
+ *    An acknowledgement in your documentation and link to the original version is required.
+ *
+ * 2. Altered source versions must be plainly marked as such,
+ *    and must not be misrepresented as being the original software.
+ *
+ * 3. This notice may not be removed or altered from any source distribution.
+ ******************************************************************************************************/
+#include "ImagePyramid.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <mutex>
+#include <thread>
+
+constexpr uint32_t ImagePyramid::DEFAULT_TILE_SIZE;
+
+ImagePyramid::ImagePyramid(const TileCompositor& _compositor, const std::vector<Layer>& _layers, uint32_t _tile_size) :
+    compositor(_compositor), layers(_layers), tile_size(_tile_size), width(0), height(0), max_zoom(0)
+{
+    // Downsample averages 2x2 blocks of a child tile into a quarter of its parent.
+    if (tile_size == 0 || tile_size % 2)
+        throw "Tile size must be even and non-zero";
+
+    uint32_t tile_width, tile_height;
+    compositor.GetTileDimensions(tile_width, tile_height);
+    for (const auto& layer : layers)
+    {
+        width = std::max(width, layer.GetWidth() * tile_width);
+        height = std::max(height, layer.GetHeight() * tile_height);
+    }
+
+    while ((static_cast<uint64_t>(tile_size) << max_zoom) < std::max(width, height))
+        max_zoom++;
+
+    SetRegion(0, 0, width, height);
+}
+
+void ImagePyramid::SetRegion(uint32_t x, uint32_t y, uint32_t region_w, uint32_t region_h)
+{
+    region_x = std::min(x, width);
+    region_y = std::min(y, height);
+    region_width = std::min(region_w, width - region_x);
+    region_height = std::min(region_h, height - region_y);
+}
+
+bool ImagePyramid::Overlaps(uint32_t zoom, uint32_t x, uint32_t y) const
+{
+    // Size of the tile in full size pixels.
+    uint64_t size = static_cast<uint64_t>(tile_size) << (max_zoom - zoom);
+    return region_width > 0 && region_height > 0 &&
+           x * size < region_x + region_width && (x + 1) * size > region_x &&
+           y * size < region_y + region_height && (y + 1) * size > region_y;
+}
+
+void ImagePyramid::Render(const TileCallback& callback, bool pyramid, uint32_t threads) const
+{
+    if (threads == 0)
+        threads = std::max(std::thread::hardware_concurrency(), 1u);
+
+    // Split the work at the first level with a few subtrees per thread, each worker renders whole subtrees
+    // and the levels above the split are put together from their results afterwards.
+    uint32_t split = 0;
+    std::vector<std::pair<uint32_t, uint32_t>> jobs;
+    if (Overlaps(0, 0, 0))
+        jobs.push_back(std::make_pair(0, 0));
+    while (split < max_zoom && (!pyramid || jobs.size() < threads * 4))
+    {
+        std::vector<std::pair<uint32_t, uint32_t>> children;
+        for (const auto& job : jobs)
+            for (uint32_t j = 0; j < 2; j++)
+                for (uint32_t i = 0; i < 2; i++)
+                    if (Overlaps(split + 1, job.first * 2 + i, job.second * 2 + j))
+                        children.push_back(std::make_pair(job.first * 2 + i, job.second * 2 + j));
+        jobs.swap(children);
+        split++;
+    }
+
+    threads = std::min<uint32_t>(threads, jobs.size());
+    std::vector<std::vector<uint8_t>> results(pyramid ? jobs.size() : 0);
+    std::atomic<uint32_t> next(0);
+    std::mutex error_mutex;
+    std::exception_ptr error;
+
+    auto worker = [&]()
+    {
+        std::vector<uint8_t> rgba;
+        for (uint32_t i = next++; i < jobs.size(); i = next++)
+        {
+            try
+            {
+                RenderTile(split, jobs[i].first, jobs[i].second, pyramid ? results[i] : rgba, callback);
+            }
+            catch (...)
+            {
+                // Exceptions can't leave a thread, keep the first one to rethrow once all workers are joined.
+                std::lock_guard<std::mutex> lock(error_mutex);
+                if (!error)
+                    error = std::current_exception();
+                next = jobs.size();
+            }
+        }
+    };
+
+    std::vector<std::thread> pool;
+    for (uint32_t i = 1; i < threads; i++)
+        pool.emplace_back(worker);
+    worker();
+    for (auto& thread : pool)
+        thread.join();
+
+    if (error)
+        std::rethrow_exception(error);
+    if (!pyramid)
+        return;
+
+    // The remaining levels hold few enough tiles to do on this thread.
+    for (uint32_t zoom = split; zoom > 0; zoom--)
+    {
+        std::vector<std::pair<uint32_t, uint32_t>> parents;
+        std::vector<std::vector<uint8_t>> parent_results;
+        for (uint32_t i = 0; i < jobs.size(); i++)
+        {
+            std::pair<uint32_t, uint32_t> parent(jobs[i].first / 2, jobs[i].second / 2);
+            auto found = std::find(parents.begin(), parents.end(), parent);
+            if (found == parents.end())
+            {
+                parents.push_back(parent);
+                parent_results.push_back(std::vector<uint8_t>(static_cast<size_t>(tile_size) * tile_size * 4, 0));
+                found = parents.end() - 1;
+            }
+            Downsample(results[i], jobs[i].first % 2, jobs[i].second % 2, parent_results[found - parents.begin()]);
+        }
+        for (uint32_t i = 0; i < parents.size(); i++)
+            callback(zoom - 1, parents[i].first, parents[i].second, parent_results[i]);
+        jobs.swap(parents);
+        results.swap(parent_results);
+    }
+}
+
+void ImagePyramid::RenderTile(uint32_t zoom, uint32_t x, uint32_t y, std::vector<uint8_t>& rgba, const TileCallback& callback) const
+{
+    rgba.resize(static_cast<size_t>(tile_size) * tile_size * 4);
+    if (zoom == max_zoom)
+    {
+        compositor.Render(layers, x * tile_size, y * tile_size, tile_size, tile_size, rgba.data());
+    }
+    else
+    {
+        std::fill(rgba.begin(), rgba.end(), 0);
+        std::vector<uint8_t> child;
+        for (uint32_t j = 0; j < 2; j++)
+        {
+            for (uint32_t i = 0; i < 2; i++)
+            {
+                if (!Overlaps(zoom + 1, x * 2 + i, y * 2 + j))
+                    continue;
+                RenderTile(zoom + 1, x * 2 + i, y * 2 + j, child, callback);
+                Downsample(child, i, j, rgba);
+            }
+        }
+    }
+    callback(zoom, x, y, rgba);
+}
+
+void ImagePyramid::Downsample(const std::vector<uint8_t>& child, uint32_t quadrant_x, uint32_t quadrant_y, std::vector<uint8_t>& parent) const
+{
+    const uint32_t half = tile_size / 2;
+    const size_t stride = tile_size * 4;
+    for (uint32_t y = 0; y < half; y++)
+    {
+        const uint8_t* top = &child[y * 2 * stride];
+        const uint8_t* bottom = top + stride;
+        uint8_t* dest = &parent[((quadrant_y * half + y) * tile_size + quadrant_x * half) * 4];
+        for (uint32_t x = 0; x < half; x++, top += 8, bottom += 8, dest += 4)
+        {
+            // Colors are weighted by alpha so transparent pixels don't darken the edges of what is drawn.
+            uint32_t alpha = top[3] + top[7] + bottom[3] + bottom[7];
+            for (uint32_t c = 0; c < 3; c++)
+            {
+                uint32_t sum = top[c] * top[3] + top[c + 4] * top[7] + bottom[c] * bottom[3] + bottom[c + 4] * bottom[7];
+                dest[c] = alpha ? (sum + alpha / 2) / alpha : 0;
+            }
+            dest[3] = (alpha + 2) / 4;
+        }
+    }
+}
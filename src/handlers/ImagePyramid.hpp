@@ -0,0 +1,95 @@
+/******************************************************************************************************
+ * Tile Map Editor
+ * Copyright (C) 2009-2017 Brandon Whitehead (tricksterguy87[AT]gmail[DOT]com)
+ *
+ * This software is provided 'as-is', without any express or implied warranty.
+ * In no event will the authors be held liable for any damages arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * excluding commercial applications, and to alter it and redistribute it freely,
+ * subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented;
+ *    you must not claim that you wrote the original software.
+ *    An acknowledgement in your documentation and link to the original version is required.
+ *
+ * 2. Altered source versions must be plainly marked as such,
+ *    and must not be misrepresented as being the original software.
+ *
+ * 3. This notice may not be removed or altered from any source distribution.
+ ******************************************************************************************************/
+#ifndef IMAGE_PYRAMID_HPP
+#define IMAGE_PYRAMID_HPP
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include "Layer.hpp"
+#include "TileCompositor.hpp"
+
+/** Renders a map as fixed size image tiles, optionally with zoomed out levels (a slippy map pyramid).
+  *
+  * Only a few tiles are in memory at once so maps far too large to fit in a single image can be exported.
+  * Zoom level GetMaxZoom() is the map at full size and each level below it is half the size of the one above,
+  * at zoom 0 the whole map fits in one tile. Tile (x, y) at a zoom covers pixels starting at (x, y) * tile_size
+  * of that level, tiles past the map's right and bottom edges are padded with transparent pixels.
+  * Tiles that are completely outside the map (or the region set with SetRegion) are not rendered.
+  */
+class ImagePyramid
+{
+public:
+    /** Called with each finished tile, from any of the worker threads.
+      * The pixels are tile_size * tile_size * 4 bytes (red, green, blue, alpha) and only valid during the call.
+      */
+    typedef std::function<void(uint32_t zoom, uint32_t x, uint32_t y, const std::vector<uint8_t>& rgba)> TileCallback;
+
+    /** Default size of a tile in pixels */
+    static constexpr uint32_t DEFAULT_TILE_SIZE = 256;
+
+    /** Creates a pyramid for some layers.
+      * @param compositor Compositor with the layers' tileset, must outlive this object.
+      * @param layers Layers to draw, see TileCompositor::Render. Must outlive this object.
+      * @param tile_size Size of a tile in pixels, must be even since each tile is halved into its parent.
+      */
+    ImagePyramid(const TileCompositor& compositor, const std::vector<Layer>& layers, uint32_t tile_size = DEFAULT_TILE_SIZE);
+
+    /** Only renders tiles that overlap a region of the map.
+      * @param x Left of the region in pixels.
+      * @param y Top of the region in pixels.
+      * @param width Width of the region in pixels.
+      * @param height Height of the region in pixels.
+      */
+    void SetRegion(uint32_t x, uint32_t y, uint32_t width, uint32_t height);
+    /** Renders the tiles.
+      * @param callback Called with each tile as it is finished, a tile is always passed after the tiles it was made from.
+      * @param pyramid If false only the full size tiles (zoom GetMaxZoom()) are rendered.
+      * @param threads Number of threads to render with, 0 for one per core.
+      */
+    void Render(const TileCallback& callback, bool pyramid = true, uint32_t threads = 0) const;
+
+    /** @return Zoom level of the full size tiles */
+    uint32_t GetMaxZoom() const { return max_zoom; }
+    uint32_t GetTileSize() const { return tile_size; }
+    /** @return Size of the map in pixels */
+    uint32_t GetWidth() const { return width; }
+    uint32_t GetHeight() const { return height; }
+
+private:
+    /** Tests if a tile at zoom overlaps the region */
+    bool Overlaps(uint32_t zoom, uint32_t x, uint32_t y) const;
+    /** Renders a tile and everything below it in the pyramid into rgba */
+    void RenderTile(uint32_t zoom, uint32_t x, uint32_t y, std::vector<uint8_t>& rgba, const TileCallback& callback) const;
+    /** Shrinks a tile by half into a quarter of parent */
+    void Downsample(const std::vector<uint8_t>& child, uint32_t quadrant_x, uint32_t quadrant_y, std::vector<uint8_t>& parent) const;
+
+    const TileCompositor& compositor;
+    const std::vector<Layer>& layers;
+    uint32_t tile_size;
+    uint32_t width, height;
+    uint32_t max_zoom;
+    /** Region to render, clipped to the map */
+    uint32_t region_x, region_y, region_width, region_height;
+};
+
+#endif
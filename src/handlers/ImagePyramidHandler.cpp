@@ -0,0 +1,91 @@
+/******************************************************************************************************
+ * Tile Map Editor
+ * Copyright (C) 2009-2017 Brandon Whitehead (tricksterguy87[AT]gmail[DOT]com)
+ *
+ * This software is provided 'as-is', without any express or implied warranty.
+ * In no event will the authors be held liable for any damages arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * excluding commercial applications, and to alter it and redistribute it freely,
+ * subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented;
+ *    you must not claim that you wrote the original software.
+ *    An acknowledgement in your documentation and link to the original version is required.
+ *
+ * 2. Altered source versions must be plainly marked as such,
+ *    and must not be misrepresented as being the original software.
+ *
+ * 3. This notice may not be removed or altered from any source distribution.
+ ******************************************************************************************************/
+#include "ImagePyramidHandler.hpp"
+
+#include <mutex>
+#include <set>
+#include <Magick++.h>
+#include <wx/filename.h>
+
+#include "HandlerUtils.hpp"
+#include "Logger.hpp"
+#include "TileCompositor.hpp"
+
+ImagePyramidHandler::ImagePyramidHandler(uint32_t _tile_size, bool _pyramid, uint32_t _threads) :
+    BaseMapHandler("Map Image Tiles", "tiles", "Exports the map as a directory of image tiles for web map viewers", false, true),
+    tile_size(_tile_size), pyramid(_pyramid), threads(_threads), region_x(0), region_y(0), region_width(0), region_height(0)
+{
+}
+
+int ImagePyramidHandler::Init()
+{
+    Magick::InitializeMagick(NULL);
+    return 0;
+}
+
+void ImagePyramidHandler::SetRegion(uint32_t x, uint32_t y, uint32_t width, uint32_t height)
+{
+    region_x = x;
+    region_y = y;
+    region_width = width;
+    region_height = height;
+}
+
+void ImagePyramidHandler::Save(const std::string& filename, const Map& map)
+{
+    EventLog l(__func__);
+    VerboseLog("Saving %s using %s", filename.c_str(), name.c_str());
+    std::shared_ptr<const TilesetImage> image = HandlerUtils::GetTilesetImage(map);
+    if (!image)
+        throw "Could not load the map's tileset";
+
+    const Tileset& tileset = map.GetTileset();
+    uint32_t tile_width, tile_height;
+    tileset.GetTileDimensions(tile_width, tile_height);
+    std::vector<uint8_t> rgba;
+    image->GetPixels(rgba);
+    TileCompositor compositor(rgba.data(), image->GetWidth(), image->GetHeight(), tile_width, tile_height,
+                              tileset.GetAnimatedTiles());
+
+    ImagePyramid image_pyramid(compositor, map.GetLayers(), tile_size);
+    if (region_width > 0 && region_height > 0)
+        image_pyramid.SetRegion(region_x, region_y, region_width, region_height);
+
+    std::mutex directory_mutex;
+    std::set<std::string> directories;
+    image_pyramid.Render([&](uint32_t zoom, uint32_t x, uint32_t y, const std::vector<uint8_t>& rgba)
+    {
+        std::string directory = filename + "/" + std::to_string(zoom) + "/" + std::to_string(x);
+        {
+            std::lock_guard<std::mutex> lock(directory_mutex);
+            if (directories.insert(directory).second && !wxFileName::Mkdir(directory, wxS_DIR_DEFAULT, wxPATH_MKDIR_FULL))
+                throw "Could not create directory for image tiles";
+        }
+        if (HandlerUtils::SaveImage(directory + "/" + std::to_string(y) + ".png", rgba, tile_size, tile_size))
+            throw "Could not write image tile";
+    }, pyramid, threads);
+    VerboseLog("Saved zoom levels 0-%d", image_pyramid.GetMaxZoom());
+}
+
+void ImagePyramidHandler::Save(std::ostream& file, const Map& map)
+{
+    throw "Image tiles can only be saved to a directory";
+}
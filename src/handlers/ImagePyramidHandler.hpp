@@ -0,0 +1,63 @@
+/******************************************************************************************************
+ * Tile Map Editor
+ * Copyright (C) 2009-2017 Brandon Whitehead (tricksterguy87[AT]gmail[DOT]com)
+ *
+ * This software is provided 'as-is', without any express or implied warranty.
+ * In no event will the authors be held liable for any damages arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * excluding commercial applications, and to alter it and redistribute it freely,
+ * subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented;
+ *    you must not claim that you wrote the original software.
+ *    An acknowledgement in your documentation and link to the original version is required.
+ *
+ * 2. Altered source versions must be plainly marked as such,
+ *    and must not be misrepresented as being the original software.
+ *
+ * 3. This notice may not be removed or altered from any source distribution.
+ ******************************************************************************************************/
+#ifndef IMAGE_PYRAMID_HANDLER_HPP
+#define IMAGE_PYRAMID_HANDLER_HPP
+
+#include "BaseMapHandler.hpp"
+#include "ImagePyramid.hpp"
+
+/** Saves the map as a directory of png tiles laid out as zoom/x/y.png for web map viewers.
+  * Tiles are written as soon as they are rendered so maps too large for MapToImage can be exported, see ImagePyramid.
+  */
+class ImagePyramidHandler : public BaseMapHandler {
+public:
+    /** Creates the handler
+      * @param tile_size Size of the image tiles in pixels.
+      * @param pyramid If true zoomed out levels are saved as well, otherwise only the full size tiles.
+      * @param threads Number of threads to render with, 0 for one per core.
+      */
+    ImagePyramidHandler(uint32_t tile_size = ImagePyramid::DEFAULT_TILE_SIZE, bool pyramid = true, uint32_t threads = 0);
+
+    /** @see BaseMapHandler::Init */
+    virtual int Init();
+    /** @see BaseMapHandler::Save
+      * filename is the directory the tiles are saved in.
+      */
+    virtual void Save(const std::string& filename, const Map& map);
+    /** @see BaseMapHandler::Save
+      * Not supported since the tiles are separate files.
+      */
+    virtual void Save(std::ostream& file, const Map& map);
+
+    /** Only saves tiles overlapping a region of the map, in pixels. A width or height of 0 saves the whole map. */
+    void SetRegion(uint32_t x, uint32_t y, uint32_t width, uint32_t height);
+
+    uint32_t GetTileSize() const { return tile_size; }
+    bool IsPyramid() const { return pyramid; }
+
+private:
+    uint32_t tile_size;
+    bool pyramid;
+    uint32_t threads;
+    uint32_t region_x, region_y, region_width, region_height;
+};
+
+#endif
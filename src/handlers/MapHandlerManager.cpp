@@ -23,6 +23,7 @@
 #include <algorithm>
 #include <cctype>
 #include <cstdio>
+#include <fstream>
 //#include <boost/filesystem.hpp>
 
 std::string GetExtension(const std::string& filename, std::string::size_type& idx)
@@ -48,11 +49,28 @@ std::string ConvertFilename(const std::string& filename)
 void MapHandlerManager::Add(BaseMapHandler* handler)
 {
     handlers.emplace(handler->GetName(), std::unique_ptr<BaseMapHandler>(handler));
+    Reindex();
 }
 
 void MapHandlerManager::Remove(const std::string& name)
 {
     handlers.erase(name);
+    Reindex();
+}
+
+void MapHandlerManager::Reindex()
+{
+    extension_index.clear();
+
+    // Main extensions are added first so they win over alternative extensions, emplace keeps the first handler seen.
+    for (const auto& name_handler : handlers)
+        extension_index.emplace(name_handler.second->GetExtension(), name_handler.second.get());
+
+    for (const auto& name_handler : handlers)
+    {
+        for (const auto& extension : name_handler.second->GetAltExtensions())
+            extension_index.emplace(extension, name_handler.second.get());
+    }
 }
 
 void MapHandlerManager::Load(const std::string& file, Map& map, const std::string& name)
@@ -60,7 +78,8 @@ void MapHandlerManager::Load(const std::string& file, Map& map, const std::strin
     std::string::size_type idx;
     std::string filename = ConvertFilename(file);
     std::string extension = GetExtension(filename, idx);
-    std::transform(filename.begin() + idx, filename.end(), filename.begin() + idx, (int (*)(int))std::tolower);
+    if (idx != std::string::npos)
+        std::transform(filename.begin() + idx, filename.end(), filename.begin() + idx, (int (*)(int))std::tolower);
 
     BaseMapHandler* handler = NULL;
 
@@ -68,7 +87,20 @@ void MapHandlerManager::Load(const std::string& file, Map& map, const std::strin
         handler = FindHandlerByName(name);
 
     if (!handler)
+    {
+        std::string header(BaseMapHandler::HEADER_SIZE, '\0');
+        std::ifstream stream(filename.c_str(), std::ios::binary);
+        stream.read(&header[0], header.size());
+        header.resize(stream.gcount());
+
         handler = FindHandlerByExtension(extension);
+        if (!header.empty() && (!handler || !handler->Sniff(header)))
+        {
+            BaseMapHandler* content_handler = FindHandlerByContent(header);
+            if (content_handler)
+                handler = content_handler;
+        }
+    }
 
     if (!handler)
         throw "Handler not found for extension";
@@ -78,11 +110,26 @@ void MapHandlerManager::Load(const std::string& file, Map& map, const std::strin
 }
 
 void MapHandlerManager::Save(const std::string& file, Map& map, const std::string& name)
+{
+    std::string filename = file;
+    BaseMapHandler* handler = FindSaveHandler(filename, name);
+    handler->Save(filename, map);
+}
+
+void MapHandlerManager::Save(const std::string& file, MapSource& source, const std::string& name)
+{
+    std::string filename = file;
+    BaseMapHandler* handler = FindSaveHandler(filename, name);
+    handler->Save(filename, source);
+}
+
+BaseMapHandler* MapHandlerManager::FindSaveHandler(std::string& filename, const std::string& name)
 {
     std::string::size_type idx;
-    std::string filename = ConvertFilename(file);
+    filename = ConvertFilename(filename);
     std::string extension = GetExtension(filename, idx);
-    transform(filename.begin() + idx, filename.end(), filename.begin() + idx, (int (*)(int))std::tolower);
+    if (idx != std::string::npos)
+        std::transform(filename.begin() + idx, filename.end(), filename.begin() + idx, (int (*)(int))std::tolower);
 
     BaseMapHandler* handler = NULL;
 
@@ -95,25 +142,24 @@ void MapHandlerManager::Save(const std::string& file, Map& map, const std::strin
     if (!handler)
         throw "Handler not found for extension";
 
-    handler->Save(filename, map);
+    return handler;
 }
 
 BaseMapHandler* MapHandlerManager::FindHandlerByExtension(const std::string& extension)
 {
-    // Check all main extensions
-    for (const auto& name_handler : handlers)
-    {
-        const auto& handler = name_handler.second;
-        if (extension == handler->GetExtension())
-            return handler.get();
-    }
+    const auto& found = extension_index.find(extension);
+    if (found == extension_index.end())
+        return NULL;
+
+    return found->second;
+}
 
-    // Check all alternative extensions for each handler
+BaseMapHandler* MapHandlerManager::FindHandlerByContent(const std::string& header)
+{
     for (const auto& name_handler : handlers)
     {
         const auto& handler = name_handler.second;
-        const std::set<std::string> extensions = handler->GetAltExtensions();
-        if (extensions.find(extension) != extensions.end())
+        if (handler->CanRead() && handler->Sniff(header))
             return handler.get();
     }
 
@@ -24,6 +24,7 @@
 #include <list>
 #include <map>
 #include <string>
+#include <unordered_map>
 
 #include "BaseMapHandler.hpp"
 
@@ -46,15 +47,25 @@ public:
       * @param handler Name of handler to use to save the file.
       */
     void Save(const std::string& filename, Map& map, const std::string& handler = "");
+    /** Handles saving a map pulling its data from a source.
+      * @see Save for how the handler is chosen.
+      * @param filename Filepath to save to.
+      * @param source Source of the map's data.
+      * @param handler Name of handler to use to save the file.
+      */
+    void Save(const std::string& filename, MapSource& source, const std::string& handler = "");
     /** Handles loading a map from the filesystem.
       * @see save for a description of how its loaded.
+      * If no handler is passed in and the handler for the extension does not recognize the
+      * contents of the file then the first handler that does recognize it is used instead.
       * @param filename Filepath to load from.
       * @param map Map to load.
       * @param handler Optional Name of handler to use to load the file.
       */
     void Load(const std::string& filename, Map& map, const std::string& handler = "");
     /** Registers a handler with MapHandlerManager.
-      * If two handlers handle the same main extension then the one that is added first will be used.
+      * If two handlers handle the same extension then the one whose name sorts first will be used.
+      * Main extensions take priority over alternative extensions.
       * @param handler Handler to add.
       * @note This class will own the pointer once added.
       */
@@ -75,6 +86,16 @@ public:
       * @note The pointer returned is owned by this class
       */
     BaseMapHandler* FindHandlerByExtension(const std::string& extension);
+    /** Finds a readable handler that recognizes the start of a file.
+      * @param header The first BaseMapHandler::HEADER_SIZE bytes of the file.
+      * @return The handler or NULL if not found.
+      * @note The pointer returned is owned by this class
+      */
+    BaseMapHandler* FindHandlerByContent(const std::string& header);
+    /** Rebuilds the extension lookup table.
+      * Must be called if the extensions of an already added handler are changed.
+      */
+    void Reindex();
     /** Gets all of the handlers able to load files
       * @return The list of readable handlers.
       * @note The pointers are returned are owned by this class
@@ -92,7 +113,10 @@ public:
     std::list<BaseMapHandler*> GetHandlers();
 
 private:
+    BaseMapHandler* FindSaveHandler(std::string& filename, const std::string& name);
+
     std::map<std::string, std::unique_ptr<BaseMapHandler>> handlers;
+    std::unordered_map<std::string, BaseMapHandler*> extension_index;
     MapHandlerManager() {};                                  // Private constructor
     MapHandlerManager(const MapHandlerManager&);             // Prevent copy-construction
     MapHandlerManager& operator=(const MapHandlerManager&);  // Prevent assignment
@@ -0,0 +1,124 @@
+/******************************************************************************************************
+ * Tile Map Editor
+ * Copyright (C) 2009-2017 Brandon Whitehead (tricksterguy87[AT]gmail[DOT]com)
+ *
+ * This software is provided 'as-is', without any express or implied warranty.
+ * In no event will the authors be held liable for any damages arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * excluding commercial applications, and to alter it and redistribute it freely,
+ * subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented;
+ *    you must not claim that you wrote the original software.
+ *    An acknowledgement in your documentation and link to the original version is required.
+ *
+ * 2. Altered source versions must be plainly marked as such,
+ *    and must not be misrepresented as being the original software.
+ *
+ * 3. This notice may not be removed or altered from any source distribution.
+ ******************************************************************************************************/
+#include "MapSource.hpp"
+
+#include <algorithm>
+
+#include "DirectionBasedCollisionLayer.hpp"
+#include "PixelBasedCollisionLayer.hpp"
+#include "TileBasedCollisionLayer.hpp"
+
+constexpr uint32_t MapSource::ROW_BUFFER_SIZE;
+
+uint32_t MapSource::GetRowsPerRequest(uint32_t width)
+{
+    return std::max(1u, ROW_BUFFER_SIZE / std::max(1u, width));
+}
+
+void MapSource::Read(Map& map)
+{
+    map.SetName(GetName());
+    map.SetTileset(GetTileset());
+
+    for (uint32_t i = 0; i < GetNumLayers(); i++)
+    {
+        LayerInfo info = GetLayerInfo(i);
+        Layer layer(info.name, info.width, info.height, info.attr);
+        if (info.width && info.height)
+            GetLayerRows(i, 0, info.height, layer.GetData().data());
+        map.Add(layer);
+    }
+
+    for (uint32_t i = 0; i < GetNumBackgrounds(); i++)
+        map.Add(GetBackground(i));
+
+    CollisionInfo info;
+    if (!GetCollisionInfo(info))
+        return;
+
+    if (info.type == CollisionLayer::PixelBased)
+    {
+        std::vector<Rectangle> rectangles;
+        GetCollisionRectangles(rectangles);
+        map.SetCollisionLayer(new PixelBasedCollisionLayer(rectangles));
+    }
+    else
+    {
+        TiledCollisionLayer* layer;
+        if (info.type == CollisionLayer::DirectionBased)
+            layer = new DirectionBasedCollisionLayer(info.width, info.height);
+        else
+            layer = new TileBasedCollisionLayer(info.width, info.height);
+        map.SetCollisionLayer(layer);
+        if (info.width && info.height)
+        {
+            std::vector<int32_t> rows(static_cast<size_t>(info.width) * info.height);
+            GetCollisionRows(0, info.height, rows.data());
+            layer->SetRows(0, info.height, rows.data());
+        }
+    }
+}
+
+MapSource::LayerInfo MemoryMapSource::GetLayerInfo(uint32_t index)
+{
+    const Layer& layer = map.GetLayer(index);
+    return {layer.GetName(), layer.GetWidth(), layer.GetHeight(), layer};
+}
+
+void MemoryMapSource::GetLayerRows(uint32_t index, uint32_t row, uint32_t count, int32_t* tiles)
+{
+    const Layer& layer = map.GetLayer(index);
+    const int32_t* start = layer.GetData().data() + row * layer.GetWidth();
+    std::copy(start, start + count * layer.GetWidth(), tiles);
+}
+
+bool MemoryMapSource::GetCollisionInfo(CollisionInfo& info)
+{
+    if (!map.HasCollisionLayer())
+        return false;
+
+    CollisionLayer* layer = map.GetCollisionLayer();
+    info.type = layer->GetType();
+    info.width = info.height = 0;
+    TiledCollisionLayer* data = dynamic_cast<TiledCollisionLayer*>(layer);
+    if (data)
+    {
+        info.width = data->GetWidth();
+        info.height = data->GetHeight();
+    }
+    return true;
+}
+
+void MemoryMapSource::GetCollisionRows(uint32_t row, uint32_t count, int32_t* data)
+{
+    const TiledCollisionLayer* layer = dynamic_cast<const TiledCollisionLayer*>(map.GetCollisionLayer());
+    if (!layer)
+        throw "Collision layer is not tile based";
+    layer->GetRows(row, count, data);
+}
+
+void MemoryMapSource::GetCollisionRectangles(std::vector<Rectangle>& rectangles)
+{
+    const PixelBasedCollisionLayer* layer = dynamic_cast<const PixelBasedCollisionLayer*>(map.GetCollisionLayer());
+    if (!layer)
+        throw "Collision layer is not pixel based";
+    rectangles = layer->GetData().GetData();
+}
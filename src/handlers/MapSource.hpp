@@ -0,0 +1,126 @@
+/******************************************************************************************************
+ * Tile Map Editor
+ * Copyright (C) 2009-2017 Brandon Whitehead (tricksterguy87[AT]gmail[DOT]com)
+ *
+ * This software is provided 'as-is', without any express or implied warranty.
+ * In no event will the authors be held liable for any damages arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * excluding commercial applications, and to alter it and redistribute it freely,
+ * subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented;
+ *    you must not claim that you wrote the original software.
+ *    An acknowledgement in your documentation and link to the original version is required.
+ *
+ * 2. Altered source versions must be plainly marked as such,
+ *    and must not be misrepresented as being the original software.
+ *
+ * 3. This notice may not be removed or altered from any source distribution.
+ ******************************************************************************************************/
+#ifndef MAP_SOURCE_HPP
+#define MAP_SOURCE_HPP
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "Map.hpp"
+#include "Rectangle.hpp"
+
+/** Pull based source of a map's data for saving maps that are not in memory as a Map.
+  * Handlers first ask for the map's properties and layer descriptions, then for the tiles of
+  * each layer a few rows at a time, so a map generated on the fly or read from a database
+  * can be saved in any format without ever holding all of its tiles.
+  *
+  * Layers are requested in order and the rows of a layer from top to bottom, however a handler
+  * may ask for the descriptions more than once.  Backgrounds, animations and collision
+  * rectangles are small and are returned whole.
+  */
+class MapSource
+{
+public:
+    /** Description of a layer without its tiles */
+    struct LayerInfo
+    {
+        std::string name;
+        uint32_t width;
+        uint32_t height;
+        DrawAttributes attr;
+    };
+
+    /** Description of the collision layer without its data */
+    struct CollisionInfo
+    {
+        CollisionLayer::Type type;
+        /** Dimensions in tiles, unused for PixelBased */
+        uint32_t width;
+        uint32_t height;
+    };
+
+    virtual ~MapSource() {}
+
+    virtual std::string GetName() = 0;
+    /** Gets the tileset including its animated tiles */
+    virtual Tileset GetTileset() = 0;
+    virtual uint32_t GetNumLayers() = 0;
+    virtual LayerInfo GetLayerInfo(uint32_t index) = 0;
+    /** Gets rows of tiles from a layer.
+      * @param index Index of the layer.
+      * @param row First row to get.
+      * @param count Number of rows to get.
+      * @param tiles Where to store the count * width tile ids.
+      */
+    virtual void GetLayerRows(uint32_t index, uint32_t row, uint32_t count, int32_t* tiles) = 0;
+    virtual uint32_t GetNumBackgrounds() { return 0; }
+    virtual Background GetBackground(uint32_t index) { throw "Source has no backgrounds"; }
+    /** Gets the description of the collision layer.
+      * @param info Set to the collision layer's description.
+      * @return true if the map has a collision layer.
+      */
+    virtual bool GetCollisionInfo(CollisionInfo& info) { return false; }
+    /** Gets rows of a TileBased or DirectionBased collision layer.
+      * @see GetLayerRows
+      */
+    virtual void GetCollisionRows(uint32_t row, uint32_t count, int32_t* data) { throw "Source has no tile collision layer"; }
+    /** Gets the rectangles of a PixelBased collision layer */
+    virtual void GetCollisionRectangles(std::vector<Rectangle>& rectangles) { throw "Source has no pixel collision layer"; }
+
+    /** Reads everything from the source into a Map.
+      * Used to save to formats that need the whole map at once.
+      * @param map Map to read into.
+      */
+    void Read(Map& map);
+
+    /** Gets how many rows handlers should request at a time to keep their buffers around ROW_BUFFER_SIZE tiles.
+      * @param width Width of the layer.
+      * @return Number of rows, at least 1.
+      */
+    static uint32_t GetRowsPerRequest(uint32_t width);
+
+    /** Number of tiles handlers should buffer */
+    static constexpr uint32_t ROW_BUFFER_SIZE = 16384;
+};
+
+/** MapSource for a map that is already in memory */
+class MemoryMapSource : public MapSource
+{
+public:
+    explicit MemoryMapSource(const Map& _map) : map(_map) {}
+
+    std::string GetName() { return map.GetName(); }
+    Tileset GetTileset() { return map.GetTileset(); }
+    uint32_t GetNumLayers() { return map.GetNumLayers(); }
+    LayerInfo GetLayerInfo(uint32_t index);
+    void GetLayerRows(uint32_t index, uint32_t row, uint32_t count, int32_t* tiles);
+    uint32_t GetNumBackgrounds() { return map.GetNumBackgrounds(); }
+    Background GetBackground(uint32_t index) { return map.GetBackground(index); }
+    bool GetCollisionInfo(CollisionInfo& info);
+    void GetCollisionRows(uint32_t row, uint32_t count, int32_t* data);
+    void GetCollisionRectangles(std::vector<Rectangle>& rectangles);
+
+private:
+    const Map& map;
+};
+
+#endif
@@ -0,0 +1,148 @@
+/******************************************************************************************************
+ * Tile Map Editor
+ * Copyright (C) 2009-2017 Brandon Whitehead (tricksterguy87[AT]gmail[DOT]com)
+ *
+ * This software is provided 'as-is', without any express or implied warranty.
+ * In no event will the authors be held liable for any damages arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * excluding commercial applications, and to alter it and redistribute it freely,
+ * subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented;
+ *    you must not claim that you wrote the original software.
+ *    An acknowledgement in your documentation and link to the original version is required.
+ *
+ * 2. Altered source versions must be plainly marked as such,
+ *    and must not be misrepresented as being the original software.
+ *
+ * 3. This notice may not be removed or altered from any source distribution.
+ ******************************************************************************************************/
+#include "MapVisitor.hpp"
+
+#include <algorithm>
+
+#include "DirectionBasedCollisionLayer.hpp"
+#include "PixelBasedCollisionLayer.hpp"
+#include "TileBasedCollisionLayer.hpp"
+
+void MapVisitor::Visit(const Map& map)
+{
+    MemoryMapSource source(map);
+    Tileset tileset = map.GetTileset();
+    tileset.SetAnimatedTiles(std::vector<AnimatedTile>());
+    tileset.SetTileCollision(TileCollision());
+    OnProperties(map.GetName(), tileset);
+
+    for (uint32_t i = 0; i < map.GetNumLayers(); i++)
+    {
+        const Layer& layer = map.GetLayer(i);
+        OnLayerBegin(source.GetLayerInfo(i));
+        if (!layer.GetData().empty())
+            OnLayerRows(0, layer.GetHeight(), layer.GetData().data());
+        OnLayerEnd();
+    }
+
+    for (const auto& background : map.GetBackgrounds())
+        OnBackground(background);
+
+    MapSource::CollisionInfo info;
+    if (source.GetCollisionInfo(info))
+    {
+        OnCollision(info);
+        if (info.type == CollisionLayer::PixelBased)
+        {
+            std::vector<Rectangle> rectangles;
+            source.GetCollisionRectangles(rectangles);
+            OnCollisionRectangles(rectangles);
+        }
+        else if (info.width && info.height)
+        {
+            std::vector<int32_t> rows = dynamic_cast<const TiledCollisionLayer*>(map.GetCollisionLayer())->GetData();
+            OnCollisionRows(0, info.height, rows.data());
+        }
+    }
+
+    if (!map.GetTileset().GetTileCollision().Empty())
+        OnTileCollision(map.GetTileset().GetTileCollision());
+
+    for (const auto& tile : map.GetTileset().GetAnimatedTiles())
+        OnAnimation(tile);
+
+    OnEnd();
+}
+
+void MapBuilder::OnProperties(const std::string& name, const Tileset& tileset)
+{
+    map.SetName(name);
+    map.SetTileset(tileset);
+}
+
+void MapBuilder::OnLayerBegin(const MapSource::LayerInfo& info)
+{
+    map.Add(Layer(info.name, info.width, info.height, info.attr));
+}
+
+void MapBuilder::OnLayerRows(uint32_t row, uint32_t count, const int32_t* tiles)
+{
+    CopyRows(map.GetLayers().back(), row, count, tiles);
+}
+
+void MapBuilder::OnBackground(const Background& background)
+{
+    map.Add(background);
+}
+
+void MapBuilder::OnCollision(const MapSource::CollisionInfo& info)
+{
+    collision = NULL;
+    if (info.type == CollisionLayer::PixelBased)
+        return;
+
+    if (info.type == CollisionLayer::DirectionBased)
+    {
+        DirectionBasedCollisionLayer* layer = new DirectionBasedCollisionLayer(info.width, info.height);
+        map.SetCollisionLayer(layer);
+        collision = layer;
+        return;
+    }
+
+    TileBasedCollisionLayer* layer = new TileBasedCollisionLayer(info.width, info.height);
+    map.SetCollisionLayer(layer);
+    collision = layer;
+}
+
+void MapBuilder::OnCollisionRows(uint32_t row, uint32_t count, const int32_t* data)
+{
+    if (collision)
+        collision->SetRows(row, count, data);
+}
+
+void MapBuilder::OnCollisionRectangles(const std::vector<Rectangle>& rectangles)
+{
+    map.SetCollisionLayer(new PixelBasedCollisionLayer(rectangles));
+}
+
+void MapBuilder::OnTileCollision(const TileCollision& collision)
+{
+    TileCollision& tiles = map.GetTileset().GetTileCollision();
+    if (!collision.GetBlocked().empty())
+        tiles.SetBlocked(collision.GetBlocked());
+    if (!collision.GetDirections().empty())
+        tiles.SetDirections(collision.GetDirections());
+    if (!collision.GetRectangles().empty())
+        tiles.SetRectangles(collision.GetRectangles());
+}
+
+void MapBuilder::OnAnimation(const AnimatedTile& tile)
+{
+    map.Add(tile);
+}
+
+void MapBuilder::CopyRows(TiledLayerData& layer, uint32_t row, uint32_t count, const int32_t* tiles)
+{
+    if (row >= layer.GetHeight())
+        return;
+    count = std::min(count, layer.GetHeight() - row);
+    std::copy(tiles, tiles + count * layer.GetWidth(), layer.GetData().begin() + row * layer.GetWidth());
+}
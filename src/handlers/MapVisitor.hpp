@@ -0,0 +1,110 @@
+/******************************************************************************************************
+ * Tile Map Editor
+ * Copyright (C) 2009-2017 Brandon Whitehead (tricksterguy87[AT]gmail[DOT]com)
+ *
+ * This software is provided 'as-is', without any express or implied warranty.
+ * In no event will the authors be held liable for any damages arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * excluding commercial applications, and to alter it and redistribute it freely,
+ * subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented;
+ *    you must not claim that you wrote the original software.
+ *    An acknowledgement in your documentation and link to the original version is required.
+ *
+ * 2. Altered source versions must be plainly marked as such,
+ *    and must not be misrepresented as being the original software.
+ *
+ * 3. This notice may not be removed or altered from any source distribution.
+ ******************************************************************************************************/
+#ifndef MAP_VISITOR_HPP
+#define MAP_VISITOR_HPP
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "Map.hpp"
+#include "MapSource.hpp"
+#include "Rectangle.hpp"
+#include "TiledCollisionLayer.hpp"
+
+/** Receives a map's data as a handler reads it, so maps can be processed in a single pass
+  * (counting tile usage, validating) without loading them into a Map.
+  *
+  * OnProperties is always called first and OnEnd last, everything else is called in the order
+  * it appears in the file.  The tiles of a layer are given a few rows at a time between
+  * OnLayerBegin and OnLayerEnd, the buffers passed are only valid during the call.
+  * All methods do nothing by default so visitors only override what they need.
+  */
+class MapVisitor
+{
+public:
+    virtual ~MapVisitor() {}
+
+    /** Called first with the map's name and tileset, tile collision is given to OnTileCollision and
+      * animated tiles to OnAnimation */
+    virtual void OnProperties(const std::string& name, const Tileset& tileset) {}
+    /** Called at the start of each layer */
+    virtual void OnLayerBegin(const MapSource::LayerInfo& info) {}
+    /** Called with the tiles of the current layer.
+      * @param row First row given.
+      * @param count Number of rows given.
+      * @param tiles count * width tile ids.
+      */
+    virtual void OnLayerRows(uint32_t row, uint32_t count, const int32_t* tiles) {}
+    /** Called after all of the rows of the current layer */
+    virtual void OnLayerEnd() {}
+    virtual void OnBackground(const Background& background) {}
+    /** Called at the start of the collision layer.
+      * The data of TileBased and DirectionBased layers follows as calls to OnCollisionRows,
+      * PixelBased layers are followed by a call to OnCollisionRectangles.
+      */
+    virtual void OnCollision(const MapSource::CollisionInfo& info) {}
+    /** @see OnLayerRows */
+    virtual void OnCollisionRows(uint32_t row, uint32_t count, const int32_t* data) {}
+    virtual void OnCollisionRectangles(const std::vector<Rectangle>& rectangles) {}
+    /** Called with the collision of the tileset's tiles.
+      * Formats storing the blocked tiles, directions and rectangles apart call this once for each with the rest empty.
+      */
+    virtual void OnTileCollision(const TileCollision& collision) {}
+    virtual void OnAnimation(const AnimatedTile& tile) {}
+    /** Called after the whole map has been read */
+    virtual void OnEnd() {}
+
+    /** Calls this visitor's methods with the contents of a map.
+      * Used to visit formats that can only be read whole.
+      * @param map Map to visit.
+      */
+    void Visit(const Map& map);
+};
+
+/** MapVisitor that builds a Map from what is read */
+class MapBuilder : public MapVisitor
+{
+public:
+    /** Creates the builder
+      * @param _map Map to add what is read to.
+      */
+    explicit MapBuilder(Map& _map) : map(_map), collision(NULL) {}
+
+    void OnProperties(const std::string& name, const Tileset& tileset);
+    void OnLayerBegin(const MapSource::LayerInfo& info);
+    void OnLayerRows(uint32_t row, uint32_t count, const int32_t* tiles);
+    void OnBackground(const Background& background);
+    void OnCollision(const MapSource::CollisionInfo& info);
+    void OnCollisionRows(uint32_t row, uint32_t count, const int32_t* data);
+    void OnCollisionRectangles(const std::vector<Rectangle>& rectangles);
+    void OnTileCollision(const TileCollision& collision);
+    void OnAnimation(const AnimatedTile& tile);
+
+private:
+    /** Copies rows into a layer, rows past the layer's height are dropped */
+    static void CopyRows(TiledLayerData& layer, uint32_t row, uint32_t count, const int32_t* tiles);
+
+    Map& map;
+    TiledCollisionLayer* collision;
+};
+
+#endif
@@ -0,0 +1,330 @@
+/******************************************************************************************************
+ * Tile Map Editor
+ * Copyright (C) 2009-2017 Brandon Whitehead (tricksterguy87[AT]gmail[DOT]com)
+ *
+ * This software is provided 'as-is', without any express or implied warranty.
+ * In no event will the authors be held liable for any damages arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * excluding commercial applications, and to alter it and redistribute it freely,
+ * subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented;
+ *    you must not claim that you wrote the original software.
+ *    An acknowledgement in your documentation and link to the original version is required.
+ *
+ * 2. Altered source versions must be plainly marked as such,
+ *    and must not be misrepresented as being the original software.
+ *
+ * 3. This notice may not be removed or altered from any source distribution.
+ ******************************************************************************************************/
+#include "ProtoMapHandler.hpp"
+
+#include <fstream>
+#include <iterator>
+#include <string>
+
+#include <google/protobuf/arena.h>
+
+#include "DirectionBasedCollisionLayer.hpp"
+#include "Logger.hpp"
+#include "PixelBasedCollisionLayer.hpp"
+#include "TileBasedCollisionLayer.hpp"
+#include "TileMap.pb.h"
+
+static const uint32_t MAJOR = 1;
+static const uint32_t MINOR = 0;
+
+namespace
+{
+
+/** Size of a value once zig-zag varint encoded */
+uint32_t VarintSize(int32_t value)
+{
+    uint32_t zigzag = (static_cast<uint32_t>(value) << 1) ^ static_cast<uint32_t>(value >> 31);
+    uint32_t size = 1;
+    while (zigzag >= 0x80)
+    {
+        zigzag >>= 7;
+        size++;
+    }
+    return size;
+}
+
+void ReadDrawAttributes(const tilemap::DrawAttributes& message, DrawAttributes& attr)
+{
+    attr.SetDepth(message.depth());
+    attr.SetPosition(message.x(), message.y());
+    attr.SetOrigin(message.origin_x(), message.origin_y());
+    attr.SetScale(message.scale_x(), message.scale_y());
+    attr.SetRotation(message.rotation());
+    attr.SetOpacity(message.opacity());
+    attr.SetBlendMode(message.blend_mode());
+    attr.SetBlendColor(message.blend_color());
+}
+
+void WriteDrawAttributes(tilemap::DrawAttributes* message, const DrawAttributes& attr)
+{
+    int32_t x, y;
+    float fx, fy;
+
+    message->set_depth(attr.GetDepth());
+    attr.GetPosition(x, y);
+    message->set_x(x);
+    message->set_y(y);
+    attr.GetOrigin(x, y);
+    message->set_origin_x(x);
+    message->set_origin_y(y);
+    attr.GetScale(fx, fy);
+    message->set_scale_x(fx);
+    message->set_scale_y(fy);
+    message->set_rotation(attr.GetRotation());
+    message->set_opacity(attr.GetOpacity());
+    message->set_blend_mode(attr.GetBlendMode());
+    message->set_blend_color(attr.GetBlendColor());
+}
+
+}
+
+ProtoMapHandler::ProtoMapHandler(DeltaEncoding delta) :
+    BaseMapHandler("Protobuf Format", "pb", "Exports the map as a protocol buffer message"), delta_encoding(delta)
+{
+}
+
+void ProtoMapHandler::Load(const std::string& mapfile, Map& map)
+{
+    std::ifstream file(mapfile.c_str(), std::ios::binary);
+    if (!file.good())
+        throw "Could not open file";
+
+    Load(file, map);
+    file.close();
+}
+
+void ProtoMapHandler::Save(const std::string& mapfile, const Map& map)
+{
+    std::ofstream file(mapfile.c_str(), std::ios::binary);
+    if (!file.good())
+        throw "Could not open file";
+
+    Save(file, map);
+    file.close();
+}
+
+void ProtoMapHandler::Load(std::istream& file, Map& map)
+{
+    EventLog l(__func__);
+
+    // Parsing from a flat buffer is much faster than through a stream adaptor.
+    std::string buffer((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+    google::protobuf::Arena arena;
+    tilemap::Map* message = google::protobuf::Arena::CreateMessage<tilemap::Map>(&arena);
+    if (!message->ParseFromString(buffer))
+        throw "Failed to parse protobuf map";
+
+    if (message->major_version() > MAJOR)
+        throw "Incorrect major version";
+
+    map.SetName(message->name());
+
+    const tilemap::Tileset& tileset_message = message->tileset();
+    Tileset tileset(tileset_message.filename(), tileset_message.tile_width(), tileset_message.tile_height());
+    for (const auto& animation : tileset_message.animated_tiles())
+    {
+        std::vector<int32_t> frames(animation.frames().begin(), animation.frames().end());
+        tileset.Add(AnimatedTile(animation.name(), animation.delay(), static_cast<AnimatedTile::Type>(animation.type()),
+                                 animation.times(), frames));
+    }
+    map.SetTileset(tileset);
+
+    std::vector<int32_t> data;
+    for (const auto& layer_message : message->layers())
+    {
+        DrawAttributes attr;
+        ReadDrawAttributes(layer_message.attributes(), attr);
+        ReadData(layer_message.data(), data);
+        map.Add(Layer(layer_message.name(), layer_message.data().width(), layer_message.data().height(), data, attr));
+    }
+
+    for (const auto& background_message : message->backgrounds())
+    {
+        DrawAttributes attr;
+        ReadDrawAttributes(background_message.attributes(), attr);
+        map.Add(Background(background_message.name(), background_message.filename(), background_message.mode(),
+                           background_message.speed_x(), background_message.speed_y(), attr));
+    }
+
+    if (message->has_collision())
+    {
+        const tilemap::CollisionLayer& collision = message->collision();
+        switch (collision.type())
+        {
+            case tilemap::CollisionLayer::TILE_BASED:
+                ReadData(collision.data(), data);
+                map.SetCollisionLayer(new TileBasedCollisionLayer(collision.data().width(), collision.data().height(), data));
+                break;
+            case tilemap::CollisionLayer::DIRECTION_BASED:
+                ReadData(collision.data(), data);
+                map.SetCollisionLayer(new DirectionBasedCollisionLayer(collision.data().width(), collision.data().height(), data));
+                break;
+            case tilemap::CollisionLayer::PIXEL_BASED:
+            {
+                std::vector<Rectangle> rectangles;
+                rectangles.reserve(collision.rectangles_size());
+                for (const auto& rectangle : collision.rectangles())
+                    rectangles.emplace_back(rectangle.x(), rectangle.y(), rectangle.width(), rectangle.height());
+                map.SetCollisionLayer(new PixelBasedCollisionLayer(rectangles));
+                break;
+            }
+            default:
+                WarnLog("Unknown Collision Type %d ignoring", collision.type());
+                break;
+        }
+    }
+}
+
+void ProtoMapHandler::Save(std::ostream& file, const Map& map)
+{
+    EventLog l(__func__);
+
+    google::protobuf::Arena arena;
+    tilemap::Map* message = google::protobuf::Arena::CreateMessage<tilemap::Map>(&arena);
+
+    message->set_major_version(MAJOR);
+    message->set_minor_version(MINOR);
+    message->set_name(map.GetName());
+
+    const Tileset& tileset = map.GetTileset();
+    uint32_t tile_width, tile_height;
+    tileset.GetTileDimensions(tile_width, tile_height);
+    tilemap::Tileset* tileset_message = message->mutable_tileset();
+    tileset_message->set_filename(tileset.GetFilename());
+    tileset_message->set_tile_width(tile_width);
+    tileset_message->set_tile_height(tile_height);
+    for (const auto& animation : tileset.GetAnimatedTiles())
+    {
+        tilemap::AnimatedTile* animation_message = tileset_message->add_animated_tiles();
+        animation_message->set_name(animation.GetName());
+        animation_message->set_delay(animation.GetDelay());
+        animation_message->set_type(static_cast<tilemap::AnimatedTile::Type>(animation.GetType()));
+        animation_message->set_times(animation.GetTimes());
+        animation_message->mutable_frames()->Add(animation.GetFrames().begin(), animation.GetFrames().end());
+    }
+
+    for (const auto& layer : map.GetLayers())
+    {
+        tilemap::Layer* layer_message = message->add_layers();
+        layer_message->set_name(layer.GetName());
+        WriteDrawAttributes(layer_message->mutable_attributes(), layer);
+        WriteData(layer_message->mutable_data(), layer);
+    }
+
+    for (const auto& background : map.GetBackgrounds())
+    {
+        float speed_x, speed_y;
+        background.GetSpeed(speed_x, speed_y);
+
+        tilemap::Background* background_message = message->add_backgrounds();
+        background_message->set_name(background.GetName());
+        background_message->set_filename(background.GetFilename());
+        background_message->set_mode(background.GetMode());
+        background_message->set_speed_x(speed_x);
+        background_message->set_speed_y(speed_y);
+        WriteDrawAttributes(background_message->mutable_attributes(), background);
+    }
+
+    if (map.HasCollisionLayer())
+    {
+        CollisionLayer* layer = map.GetCollisionLayer();
+        tilemap::CollisionLayer* collision = message->mutable_collision();
+        switch (layer->GetType())
+        {
+            case CollisionLayer::TileBased:
+            case CollisionLayer::DirectionBased:
+                collision->set_type(layer->GetType() == CollisionLayer::TileBased ? tilemap::CollisionLayer::TILE_BASED :
+                                    tilemap::CollisionLayer::DIRECTION_BASED);
+                WriteData(collision->mutable_data(), dynamic_cast<TiledCollisionLayer*>(layer)->Unpack());
+                break;
+            case CollisionLayer::PixelBased:
+            {
+                collision->set_type(tilemap::CollisionLayer::PIXEL_BASED);
+                const Region& region = dynamic_cast<PixelBasedCollisionLayer*>(layer)->GetData();
+                for (const auto& rectangle : region.GetData())
+                {
+                    tilemap::Rectangle* rectangle_message = collision->add_rectangles();
+                    rectangle_message->set_x(rectangle.x);
+                    rectangle_message->set_y(rectangle.y);
+                    rectangle_message->set_width(rectangle.width);
+                    rectangle_message->set_height(rectangle.height);
+                }
+                break;
+            }
+            default:
+                WarnLog("Unknown Collision Type %d ignoring", layer->GetType());
+                message->clear_collision();
+                break;
+        }
+    }
+
+    if (!message->SerializeToOstream(&file))
+        throw "Failed to write protobuf map";
+}
+
+void ProtoMapHandler::ReadData(const tilemap::TiledData& message, std::vector<int32_t>& data)
+{
+    if (message.width() == 0 || message.height() == 0 || message.width() > TiledLayerData::MAX_SIZE || message.height() > TiledLayerData::MAX_SIZE)
+        throw "Invalid layer dimensions";
+    if (static_cast<uint64_t>(message.tiles_size()) != static_cast<uint64_t>(message.width()) * message.height())
+        throw "Tile data size does not match layer dimensions";
+
+    data.assign(message.tiles().begin(), message.tiles().end());
+    if (message.encoding() == tilemap::TiledData::DELTA)
+    {
+        // Unsigned so that deltas between far apart ids wrap instead of overflowing.
+        uint32_t previous = 0;
+        for (auto& tile : data)
+        {
+            previous += static_cast<uint32_t>(tile);
+            tile = static_cast<int32_t>(previous);
+        }
+    }
+}
+
+void ProtoMapHandler::WriteData(tilemap::TiledData* message, const TiledLayerData& layer)
+{
+    const std::vector<int32_t>& data = layer.GetData();
+    message->set_width(layer.GetWidth());
+    message->set_height(layer.GetHeight());
+
+    bool delta = delta_encoding == AlwaysDelta;
+    if (delta_encoding == AutoDelta)
+    {
+        uint32_t previous = 0;
+        uint64_t raw_size = 0, delta_size = 0;
+        for (const auto& tile : data)
+        {
+            raw_size += VarintSize(tile);
+            delta_size += VarintSize(static_cast<int32_t>(static_cast<uint32_t>(tile) - previous));
+            previous = static_cast<uint32_t>(tile);
+        }
+        delta = delta_size < raw_size;
+    }
+
+    google::protobuf::RepeatedField<int32_t>* tiles = message->mutable_tiles();
+    if (!delta)
+    {
+        message->set_encoding(tilemap::TiledData::RAW);
+        tiles->Add(data.begin(), data.end());
+        return;
+    }
+
+    message->set_encoding(tilemap::TiledData::DELTA);
+    tiles->Reserve(data.size());
+    uint32_t previous = 0;
+    for (const auto& tile : data)
+    {
+        tiles->AddAlreadyReserved(static_cast<int32_t>(static_cast<uint32_t>(tile) - previous));
+        previous = static_cast<uint32_t>(tile);
+    }
+}
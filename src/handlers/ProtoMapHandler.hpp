@@ -0,0 +1,69 @@
+/******************************************************************************************************
+ * Tile Map Editor
+ * Copyright (C) 2009-2017 Brandon Whitehead (tricksterguy87[AT]gmail[DOT]com)
+ *
+ * This software is provided 'as-is', without any express or implied warranty.
+ * In no event will the authors be held liable for any damages arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * excluding commercial applications, and to alter it and redistribute it freely,
+ * subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented;
+ *    you must not claim that you wrote the original software.
+ *    An acknowledgement in your documentation and link to the original version is required.
+ *
+ * 2. Altered source versions must be plainly marked as such,
+ *    and must not be misrepresented as being the original software.
+ *
+ * 3. This notice may not be removed or altered from any source distribution.
+ ******************************************************************************************************/
+#ifndef PROTO_MAP_HANDLER_HPP
+#define PROTO_MAP_HANDLER_HPP
+
+#include "BaseMapHandler.hpp"
+
+namespace tilemap
+{
+class TiledData;
+}
+
+class TiledLayerData;
+
+/** Saves the map as a protocol buffer message see TileMap.proto for the format */
+class ProtoMapHandler : public BaseMapHandler {
+public:
+    /** Controls how the tile ids of layers and collision layers are stored */
+    enum DeltaEncoding
+    {
+        /** Tile ids are stored as is */
+        NoDelta = 0,
+        /** The difference between consecutive tile ids are stored */
+        AlwaysDelta = 1,
+        /** Picks whichever of the above is smaller per layer (default) */
+        AutoDelta = 2,
+    };
+
+    /** Creates the handler
+      * @param delta How tile ids are stored.
+      */
+    ProtoMapHandler(DeltaEncoding delta = AutoDelta);
+    /** @see BaseMapHandler::Load */
+    virtual void Load(const std::string& filename, Map& map);
+    /** @see BaseMapHandler::Load */
+    virtual void Load(std::istream& file, Map& map);
+    /** @see BaseMapHandler::Save */
+    virtual void Save(const std::string& filename, const Map& map);
+    /** @see BaseMapHandler::Save */
+    virtual void Save(std::ostream& file, const Map& map);
+
+    DeltaEncoding GetDeltaEncoding() const { return delta_encoding; }
+    void SetDeltaEncoding(DeltaEncoding delta) { delta_encoding = delta; }
+
+private:
+    void ReadData(const tilemap::TiledData& message, std::vector<int32_t>& data);
+    void WriteData(tilemap::TiledData* message, const TiledLayerData& layer);
+    DeltaEncoding delta_encoding;
+};
+
+#endif
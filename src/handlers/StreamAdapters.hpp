@@ -0,0 +1,83 @@
+/******************************************************************************************************
+ * Tile Map Editor
+ * Copyright (C) 2009-2017 Brandon Whitehead (tricksterguy87[AT]gmail[DOT]com)
+ *
+ * This software is provided 'as-is', without any express or implied warranty.
+ * In no event will the authors be held liable for any damages arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * excluding commercial applications, and to alter it and redistribute it freely,
+ * subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented;
+ *    you must not claim that you wrote the original software.
+ *    An acknowledgement in your documentation and link to the original version is required.
+ *
+ * 2. Altered source versions must be plainly marked as such,
+ *    and must not be misrepresented as being the original software.
+ *
+ * 3. This notice may not be removed or altered from any source distribution.
+ ******************************************************************************************************/
+#ifndef STREAM_ADAPTERS_HPP
+#define STREAM_ADAPTERS_HPP
+
+#include <istream>
+#include <ostream>
+#include <wx/stream.h>
+
+/** Reads from a std::istream through the wxInputStream interface */
+class wxFInputStream : public wxInputStream
+{
+public:
+    wxFInputStream(std::istream& _stream) : stream(_stream)
+    {
+    }
+
+protected:
+    size_t OnSysRead(void* buffer, size_t bufsize)
+    {
+        if (stream.bad())
+        {
+            m_lasterror = wxSTREAM_READ_ERROR;
+            return 0;
+        }
+        else if (stream.eof())
+        {
+            m_lasterror = wxSTREAM_EOF;
+            return 0;
+        }
+
+        stream.read(reinterpret_cast<char*>(buffer), bufsize);
+        return stream.gcount();
+    }
+
+private:
+    std::istream& stream;
+};
+
+/** Writes to a std::ostream through the wxOutputStream interface */
+class wxFOutputStream : public wxOutputStream
+{
+public:
+    wxFOutputStream(std::ostream& _stream) : stream(_stream)
+    {
+    }
+
+protected:
+    size_t OnSysWrite(const void* buffer, size_t bufsize)
+    {
+        if (stream.bad())
+        {
+            m_lasterror = wxSTREAM_WRITE_ERROR;
+            return 0;
+        }
+
+        stream.write(reinterpret_cast<const char*>(buffer), bufsize);
+        return bufsize;
+    }
+
+private:
+    std::ostream& stream;
+};
+
+#endif
@@ -22,6 +22,8 @@
 
 #include <algorithm>
 #include <fstream>
+#include <functional>
+#include <memory>
 #include <string>
 #include <wx/msgdlg.h>
 #include <wx/string.h>
@@ -52,20 +54,109 @@ void WriteDrawAttributes(std::ostream& file, const DrawAttributes* attr)
     file << "blend_color: " << std::uppercase << std::hex << attr->GetBlendColor() << std::dec << std::nouppercase << "\n";
     file << "priority: " << attr->GetDepth() << "\n";
 }
+
+/** Writes "data: " lines a few rows at a time as they are read from a MapSource */
+void WriteRows(std::ostream& file, uint32_t width, uint32_t height, const std::function<void(uint32_t, uint32_t, int32_t*)>& get_rows)
+{
+    uint32_t rows = MapSource::GetRowsPerRequest(width);
+    std::vector<int32_t> buffer(width * std::min(rows, height));
+    for (uint32_t row = 0; row < height; row += rows)
+    {
+        uint32_t count = std::min(rows, height - row);
+        get_rows(row, count, buffer.data());
+        for (uint32_t i = 0; i < count; i++)
+        {
+            file << "data: ";
+            for (uint32_t j = 0; j < width; j++)
+                file << buffer[i * width + j] << " ";
+            file << "\n";
+        }
+    }
+}
+
+/** Collects tiles from "data: " lines and passes them on a few complete rows at a time */
+class RowBuffer
+{
+public:
+    RowBuffer(uint32_t _width, uint32_t _height, const std::function<void(uint32_t, uint32_t, const int32_t*)>& _emit) :
+        width(_width), height(_height), rows(MapSource::GetRowsPerRequest(_width)), row(0), total(0), emit(_emit) {}
+    /** Adds the next tile, tiles past the end of the layer are counted but dropped */
+    void Add(int32_t tile)
+    {
+        if (++total > static_cast<uint64_t>(width) * height)
+            return;
+        buffer.push_back(tile);
+        if (buffer.size() == static_cast<size_t>(rows) * width)
+            Flush();
+    }
+    /** Passes on any buffered rows padding an incomplete row with -1
+      * @return The number of tiles added.
+      */
+    uint64_t Finish()
+    {
+        if (width && buffer.size() % width)
+            buffer.resize(buffer.size() + width - buffer.size() % width, -1);
+        Flush();
+        return total;
+    }
+private:
+    void Flush()
+    {
+        if (buffer.empty())
+            return;
+        uint32_t count = buffer.size() / width;
+        emit(row, count, buffer.data());
+        row += count;
+        buffer.clear();
+    }
+    uint32_t width;
+    uint32_t height;
+    uint32_t rows;
+    uint32_t row;
+    uint64_t total;
+    std::function<void(uint32_t, uint32_t, const int32_t*)> emit;
+    std::vector<int32_t> buffer;
+};
+
+/** Starts the collision layer once its data begins, only tile and direction based layers can be stored as text */
+std::unique_ptr<RowBuffer> BeginCollision(MapVisitor& visitor, int32_t type, uint32_t width, uint32_t height)
+{
+    MapSource::CollisionInfo info;
+    info.type = type == CollisionLayer::DirectionBased ? CollisionLayer::DirectionBased : CollisionLayer::TileBased;
+    info.width = width;
+    info.height = height;
+    visitor.OnCollision(info);
+    return std::unique_ptr<RowBuffer>(new RowBuffer(width, height, [&visitor](uint32_t row, uint32_t count, const int32_t* tiles)
+    {
+        visitor.OnCollisionRows(row, count, tiles);
+    }));
+}
 }
 
 TextMapHandler::TextMapHandler() : BaseMapHandler("Text Format", "txt", "Export the map as a text file")
 {
 }
 
+bool TextMapHandler::Sniff(const std::string& header) const
+{
+    // Properties section always comes first.
+    return header.compare(0, 11, "Properties\n") == 0 || header.compare(0, 12, "Properties\r\n") == 0;
+}
+
 void TextMapHandler::Load(std::istream& file, Map& map)
+{
+    MapBuilder builder(map);
+    Load(file, builder);
+}
+
+void TextMapHandler::Load(std::istream& file, MapVisitor& visitor)
 {
     std::string line;
     std::getline(file, line);
 
     VerboseLog("%s Read line %s", __func__, line.c_str());
     if (line == "Properties")
-        ReadProperties(file, map);
+        ReadProperties(file, visitor);
     else
         throw "Properties must come first in txt file";
 
@@ -73,20 +164,21 @@ void TextMapHandler::Load(std::istream& file, Map& map)
     {
         VerboseLog("%s Read line %s", __func__, line.c_str());
         if (line == "Layers")
-            ReadLayers(file, map);
+            ReadLayers(file, visitor);
         else if (line == "Backgrounds")
-            ReadBackgrounds(file, map);
+            ReadBackgrounds(file, visitor);
         else if (line == "Collision")
-            ReadCollision(file, map);
+            ReadCollision(file, visitor);
         else if (line == "Animations")
-            ReadAnimations(file, map);
+            ReadAnimations(file, visitor);
         else if (!line.empty())
             throw "Unknown type found in file line: " + line;
     }
+    visitor.OnEnd();
     VerboseLog("Done Loading");
 }
 
-void TextMapHandler::ReadProperties(std::istream& file, Map& map)
+void TextMapHandler::ReadProperties(std::istream& file, MapVisitor& visitor)
 {
     VerboseLog("Reading Properties");
     std::string line;
@@ -135,12 +227,11 @@ void TextMapHandler::ReadProperties(std::istream& file, Map& map)
     tile_width = std::min(Tileset::MAX_TILE_SIZE, std::max(Tileset::MIN_TILE_SIZE, tile_width));
     tile_height = std::min(Tileset::MAX_TILE_SIZE, std::max(Tileset::MIN_TILE_SIZE, tile_height));
 
-    map.SetName(name);
-    map.SetTileset(Tileset(tileset, tile_width, tile_height));
+    visitor.OnProperties(name, Tileset(tileset, tile_width, tile_height));
     VerboseLog("Done Reading Properties");
 }
 
-void TextMapHandler::ReadLayers(std::istream& file, Map& map)
+void TextMapHandler::ReadLayers(std::istream& file, MapVisitor& visitor)
 {
     VerboseLog("Reading Layers");
     std::string line;
@@ -151,7 +242,7 @@ void TextMapHandler::ReadLayers(std::istream& file, Map& map)
         std::string name;
         DrawAttributes attr;
         uint32_t width = 0, height = 0;
-        std::vector<int32_t> data;
+        std::unique_ptr<RowBuffer> data;
 
         while (!line.empty())
         {
@@ -162,6 +253,10 @@ void TextMapHandler::ReadLayers(std::istream& file, Map& map)
             if (!scanner.Next(property))
                 throw "Could not parse line: " + line;
 
+            // Tiles are passed on as they are read so the layer has to be described before its data.
+            if (data && property != "data:")
+                throw "Layer properties must come before its data line: " + line;
+
             if (property == "name:")
             {
                 if (!scanner.NextLine(name))
@@ -235,16 +330,23 @@ void TextMapHandler::ReadLayers(std::istream& file, Map& map)
                     throw "Could not parse width";
                 if (!scanner.Next(height))
                     throw "Could not parse height";
-                data.reserve(width * height);
             }
             else if (property == "data:")
             {
+                if (!data)
+                {
+                    visitor.OnLayerBegin({name, width, height, attr});
+                    data.reset(new RowBuffer(width, height, [&visitor](uint32_t row, uint32_t count, const int32_t* tiles)
+                    {
+                        visitor.OnLayerRows(row, count, tiles);
+                    }));
+                }
                 while (scanner.HasMoreTokens())
                 {
                     int32_t element;
                     if (!scanner.Next(element))
                         throw "Could not parse data";
-                    data.push_back(element);
+                    data->Add(element);
                 }
             }
             else
@@ -254,18 +356,19 @@ void TextMapHandler::ReadLayers(std::istream& file, Map& map)
             std::getline(file, line);
         }
 
-        if (data.size() != width * height)
-            WarnLog("Incorrect number of tile entries for layer %s got %d expected %d", name.c_str(), data.size(), width * height);
-
-        Layer layer(name, width, height, data, attr);
-        map.Add(layer);
+        if (!data)
+            visitor.OnLayerBegin({name, width, height, attr});
+        unsigned long long size = data ? data->Finish() : 0;
+        if (size != static_cast<unsigned long long>(width) * height)
+            WarnLog("Incorrect number of tile entries for layer %s got %llu expected %llu", name.c_str(), size, static_cast<unsigned long long>(width) * height);
+        visitor.OnLayerEnd();
 
         std::getline(file, line);
     }
     VerboseLog("Done Reading Layers");
 }
 
-void TextMapHandler::ReadBackgrounds(std::istream& file, Map& map)
+void TextMapHandler::ReadBackgrounds(std::istream& file, MapVisitor& visitor)
 {
     VerboseLog("Reading Backgrounds");
     std::string line;
@@ -379,14 +482,14 @@ void TextMapHandler::ReadBackgrounds(std::istream& file, Map& map)
             std::getline(file, line);
         }
 
-        map.Add(Background(name, filename, mode, speedx, speedy, attr));
+        visitor.OnBackground(Background(name, filename, mode, speedx, speedy, attr));
 
         std::getline(file, line);
     }
     VerboseLog("Done Reading Backgrounds");
 }
 
-void TextMapHandler::ReadAnimations(std::istream& file, Map& map)
+void TextMapHandler::ReadAnimations(std::istream& file, MapVisitor& visitor)
 {
     VerboseLog("Reading Animations");
     std::string line;
@@ -445,20 +548,20 @@ void TextMapHandler::ReadAnimations(std::istream& file, Map& map)
             }
             std::getline(file, line);
         }
-        map.Add(AnimatedTile(name, delay, static_cast<AnimatedTile::Type>(type), times, frames));
+        visitor.OnAnimation(AnimatedTile(name, delay, static_cast<AnimatedTile::Type>(type), times, frames));
 
         std::getline(file, line);
     }
     VerboseLog("Done Reading Animations");
 }
 
-void TextMapHandler::ReadCollision(std::istream& file, Map& map)
+void TextMapHandler::ReadCollision(std::istream& file, MapVisitor& visitor)
 {
     VerboseLog("Reading Collision Layer");
 
     int32_t type = 0;
     uint32_t width = 0, height = 0;
-    std::vector<int32_t> data;
+    std::unique_ptr<RowBuffer> data;
 
     std::string line;
     std::getline(file, line);
@@ -472,6 +575,9 @@ void TextMapHandler::ReadCollision(std::istream& file, Map& map)
         if (!scanner.Next(property))
             throw "Could not parse line: " + line;
 
+        if (data && property != "data:")
+            throw "Collision layer properties must come before its data line: " + line;
+
         if (property == "type:")
         {
             if (!scanner.Next(type))
@@ -483,16 +589,17 @@ void TextMapHandler::ReadCollision(std::istream& file, Map& map)
                 throw "Could not parse width";
             if (!scanner.Next(height))
                 throw "Could not parse height";
-            data.reserve(width * height);
         }
         else if (property == "data:")
         {
+            if (!data)
+                data = BeginCollision(visitor, type, width, height);
             while (scanner.HasMoreTokens())
             {
                 int32_t element;
                 if (!scanner.Next(element))
                     throw "Could not parse data";
-                data.push_back(element);
+                data->Add(element);
             }
         }
         else
@@ -502,11 +609,11 @@ void TextMapHandler::ReadCollision(std::istream& file, Map& map)
         std::getline(file, line);
     }
 
-    if (data.size() != width * height)
-        WarnLog("Incorrect number of tile entries for collision layer got %d expected %d", data.size(), width * height);
-
-    CollisionLayer* layer = new TileBasedCollisionLayer(width, height, data);
-    map.SetCollisionLayer(layer);
+    if (!data)
+        data = BeginCollision(visitor, type, width, height);
+    unsigned long long size = data->Finish();
+    if (size != static_cast<unsigned long long>(width) * height)
+        WarnLog("Incorrect number of tile entries for collision layer got %llu expected %llu", size, static_cast<unsigned long long>(width) * height);
 
     std::getline(file, line);
     VerboseLog("Done Reading Collision Layer");
@@ -514,38 +621,42 @@ void TextMapHandler::ReadCollision(std::istream& file, Map& map)
 
 void TextMapHandler::Save(std::ostream& file, const Map& map)
 {
-    const Tileset& tileset = map.GetTileset();
+    MemoryMapSource source(map);
+    Save(file, source);
+}
+
+void TextMapHandler::Save(std::ostream& file, MapSource& source)
+{
+    const Tileset tileset = source.GetTileset();
     uint32_t tile_width, tile_height;
     tileset.GetTileDimensions(tile_width, tile_height);
 
     file << "Properties\n";
-    file << "name: " << map.GetName() << "\n";
+    file << "name: " << source.GetName() << "\n";
     file << "tileset: " << tileset.GetFilename() << "\n";
     file << "tile_dimensions: " << tile_width << " " << tile_height << "\n\n";
 
     file << "Layers\n";
-    for (const auto& layer : map.GetLayers())
+    for (uint32_t i = 0; i < source.GetNumLayers(); i++)
     {
-        file << "name: " << layer.GetName() << "\n";
-        file << "dimensions: " << layer.GetWidth() << " " << layer.GetHeight() << "\n";
-        WriteDrawAttributes(file, &layer);
-
-        for (unsigned int i = 0; i < layer.GetHeight(); i++)
+        MapSource::LayerInfo layer = source.GetLayerInfo(i);
+        file << "name: " << layer.name << "\n";
+        file << "dimensions: " << layer.width << " " << layer.height << "\n";
+        WriteDrawAttributes(file, &layer.attr);
+        WriteRows(file, layer.width, layer.height, [&source, i](uint32_t row, uint32_t count, int32_t* tiles)
         {
-            file << "data: ";
-            for (unsigned int j = 0; j < layer.GetWidth(); j++)
-                file << layer[i * layer.GetWidth() + j] << " ";
-            file << "\n";
-        }
+            source.GetLayerRows(i, row, count, tiles);
+        });
         file << "\n";
     }
     file << "\n";
 
-    const std::vector<Background>& backgrounds = map.GetBackgrounds();
-    if (!backgrounds.empty())
+    uint32_t num_backgrounds = source.GetNumBackgrounds();
+    if (num_backgrounds > 0)
         file << "Backgrounds\n";
-    for (const auto& background : backgrounds)
+    for (uint32_t i = 0; i < num_backgrounds; i++)
     {
+        const Background background = source.GetBackground(i);
         float spx, spy;
         background.GetSpeed(spx, spy);
         file << "name: " << background.GetName() << "\n";
@@ -574,21 +685,24 @@ void TextMapHandler::Save(std::ostream& file, const Map& map)
     }
     file << "\n";
 
-    if (map.HasCollisionLayer())
+    MapSource::CollisionInfo collision;
+    if (source.GetCollisionInfo(collision))
     {
-        file << "Collision\n";
-        TileBasedCollisionLayer* collLayer = dynamic_cast<TileBasedCollisionLayer*>(map.GetCollisionLayer());
-        std::vector<int32_t>& collMap = collLayer->GetData();
-        file << "type: " << collLayer->GetType() << "\n";
-        file << "dimensions: " << collLayer->GetWidth() << " " << collLayer->GetHeight() << "\n";
-        for (unsigned int i = 0; i < collLayer->GetHeight(); i++)
+        if (collision.type == CollisionLayer::PixelBased)
         {
-            file << "data: ";
-            for (unsigned int j = 0; j < collLayer->GetWidth(); j++)
-                file << collMap[i * collLayer->GetWidth() + j] << " ";
+            WarnLog("Pixel based collision layers can not be saved in the text format, skipping");
+        }
+        else
+        {
+            file << "Collision\n";
+            file << "type: " << collision.type << "\n";
+            file << "dimensions: " << collision.width << " " << collision.height << "\n";
+            WriteRows(file, collision.width, collision.height, [&source](uint32_t row, uint32_t count, int32_t* data)
+            {
+                source.GetCollisionRows(row, count, data);
+            });
             file << "\n";
         }
-        file << "\n";
     }
     file << "\n";
 }
@@ -31,15 +31,21 @@ public:
     TextMapHandler();
     /** @see BaseMapHandler::Load */
     virtual void Load(std::istream& file, Map& map);
+    /** @see BaseMapHandler::Load, tiles are passed to the visitor as they are read */
+    virtual void Load(std::istream& file, MapVisitor& visitor);
     /** @see BaseMapHandler::Save */
     virtual void Save(std::ostream& file, const Map& map);
+    /** @see BaseMapHandler::Save, tiles are written as they are read from the source */
+    virtual void Save(std::ostream& file, MapSource& source);
+    /** @see BaseMapHandler::Sniff */
+    virtual bool Sniff(const std::string& header) const;
 
 private:
-    void ReadProperties(std::istream& file, Map& map);
-    void ReadLayers(std::istream& file, Map& map);
-    void ReadBackgrounds(std::istream& file, Map& map);
-    void ReadAnimations(std::istream& file, Map& map);
-    void ReadCollision(std::istream& file, Map& map);
+    void ReadProperties(std::istream& file, MapVisitor& visitor);
+    void ReadLayers(std::istream& file, MapVisitor& visitor);
+    void ReadBackgrounds(std::istream& file, MapVisitor& visitor);
+    void ReadAnimations(std::istream& file, MapVisitor& visitor);
+    void ReadCollision(std::istream& file, MapVisitor& visitor);
 };
 
 #endif
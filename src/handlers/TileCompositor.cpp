@@ -0,0 +1,296 @@
+/******************************************************************************************************
+ * Tile Map Editor
+ * Copyright (C) 2009-2017 Brandon Whitehead (tricksterguy87[AT]gmail[DOT]com)
+ *
+ * This software is provided 'as-is', without any express or implied warranty.
+ * In no event will the authors be held liable for any damages arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * excluding commercial applications, and to alter it and redistribute it freely,
+ * subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented;
+ *    you must not claim that you wrote the original software.
+ *    An acknowledgement in your documentation and link to the original version is required.
+ *
+ * 2. Altered source versions must be plainly marked as such,
+ *    and must not be misrepresented as being the original software.
+ *
+ * 3. This notice may not be removed or altered from any source distribution.
+ ******************************************************************************************************/
+#include "TileCompositor.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <thread>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define COMPOSITOR_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace
+{
+
+/** x / 255 rounded, exact for x <= 255 * 255 */
+inline uint32_t Divide255(uint32_t x)
+{
+    x += 128;
+    return (x + (x >> 8)) >> 8;
+}
+
+/** Draws premultiplied pixels over premultiplied pixels, dest = src + dest * (255 - src alpha) / 255 */
+void BlendScalar(const uint8_t* src, uint8_t* dest, uint32_t count)
+{
+    for (uint32_t i = 0; i < count * 4; i += 4)
+    {
+        uint32_t inverse = 255 - src[i + 3];
+        for (uint32_t c = 0; c < 4; c++)
+            dest[i + c] = src[i + c] + Divide255(dest[i + c] * inverse);
+    }
+}
+
+/** Scales premultiplied pixels by a factor per channel then draws them like BlendScalar */
+void BlendScaledScalar(const uint8_t* src, uint8_t* dest, uint32_t count, const uint8_t* factors)
+{
+    for (uint32_t i = 0; i < count * 4; i += 4)
+    {
+        uint8_t scaled[4];
+        for (uint32_t c = 0; c < 4; c++)
+            scaled[c] = Divide255(src[i + c] * factors[c]);
+        BlendScalar(scaled, dest + i, 1);
+    }
+}
+
+#ifdef COMPOSITOR_SSE2
+bool HasSSE2()
+{
+    static const bool supported = __builtin_cpu_supports("sse2");
+    return supported;
+}
+
+/** Blends two pixels unpacked to 16 bits per channel, same arithmetic as BlendScalar */
+__attribute__((target("sse2")))
+inline __m128i Divide255(__m128i x)
+{
+    x = _mm_add_epi16(x, _mm_set1_epi16(128));
+    return _mm_srli_epi16(_mm_add_epi16(x, _mm_srli_epi16(x, 8)), 8);
+}
+
+__attribute__((target("sse2")))
+inline __m128i Blend2(__m128i src, __m128i dest)
+{
+    __m128i alpha = _mm_shufflehi_epi16(_mm_shufflelo_epi16(src, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+    __m128i inverse = _mm_sub_epi16(_mm_set1_epi16(255), alpha);
+    // At most 255 * 255 + 128 so none of this overflows 16 bits.
+    return _mm_add_epi16(src, Divide255(_mm_mullo_epi16(dest, inverse)));
+}
+
+__attribute__((target("sse2")))
+void BlendSSE2(const uint8_t* src, uint8_t* dest, uint32_t count)
+{
+    const __m128i zero = _mm_setzero_si128();
+    uint32_t i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * 4));
+        __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dest + i * 4));
+        __m128i low = Blend2(_mm_unpacklo_epi8(s, zero), _mm_unpacklo_epi8(d, zero));
+        __m128i high = Blend2(_mm_unpackhi_epi8(s, zero), _mm_unpackhi_epi8(d, zero));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dest + i * 4), _mm_packus_epi16(low, high));
+    }
+    BlendScalar(src + i * 4, dest + i * 4, count - i);
+}
+
+__attribute__((target("sse2")))
+void BlendScaledSSE2(const uint8_t* src, uint8_t* dest, uint32_t count, const uint8_t* factors)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i scale = _mm_setr_epi16(factors[0], factors[1], factors[2], factors[3], factors[0], factors[1], factors[2], factors[3]);
+    uint32_t i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * 4));
+        __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dest + i * 4));
+        __m128i low = Divide255(_mm_mullo_epi16(_mm_unpacklo_epi8(s, zero), scale));
+        __m128i high = Divide255(_mm_mullo_epi16(_mm_unpackhi_epi8(s, zero), scale));
+        low = Blend2(low, _mm_unpacklo_epi8(d, zero));
+        high = Blend2(high, _mm_unpackhi_epi8(d, zero));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dest + i * 4), _mm_packus_epi16(low, high));
+    }
+    BlendScaledScalar(src + i * 4, dest + i * 4, count - i, factors);
+}
+#endif
+
+void Blend(const uint8_t* src, uint8_t* dest, uint32_t count)
+{
+#ifdef COMPOSITOR_SSE2
+    if (HasSSE2())
+        return BlendSSE2(src, dest, count);
+#endif
+    BlendScalar(src, dest, count);
+}
+
+void BlendScaled(const uint8_t* src, uint8_t* dest, uint32_t count, const uint8_t* factors)
+{
+#ifdef COMPOSITOR_SSE2
+    if (HasSSE2())
+        return BlendScaledSSE2(src, dest, count, factors);
+#endif
+    BlendScaledScalar(src, dest, count, factors);
+}
+
+void Unpremultiply(uint8_t* rgba, size_t count)
+{
+    for (size_t i = 0; i < count * 4; i += 4)
+    {
+        uint32_t alpha = rgba[i + 3];
+        if (alpha == 255)
+            continue;
+        for (uint32_t c = 0; c < 3; c++)
+            rgba[i + c] = alpha ? std::min(255U, (rgba[i + c] * 255 + alpha / 2) / alpha) : 0;
+    }
+}
+
+}
+
+TileCompositor::TileCompositor(const uint8_t* rgba, uint32_t width, uint32_t height, uint32_t _tile_width, uint32_t _tile_height,
+                               const std::vector<AnimatedTile>& animated_tiles) : tile_width(_tile_width), tile_height(_tile_height)
+{
+    if (tile_width == 0 || tile_height == 0)
+        throw "Tile dimensions must be non-zero";
+
+    uint32_t columns = width / tile_width;
+    uint32_t rows = height / tile_height;
+    const uint32_t row_bytes = tile_width * 4;
+    atlas.resize(columns * rows * row_bytes * tile_height);
+    kinds.resize(columns * rows);
+
+    uint8_t* dest = atlas.data();
+    for (uint32_t tile = 0; tile < kinds.size(); tile++)
+    {
+        uint32_t x = tile % columns * tile_width;
+        uint32_t y = tile / columns * tile_height;
+        bool opaque = true, transparent = true;
+        for (uint32_t j = 0; j < tile_height; j++)
+        {
+            const uint8_t* src = rgba + ((y + j) * width + x) * 4;
+            for (uint32_t i = 0; i < row_bytes; i += 4, dest += 4)
+            {
+                uint32_t alpha = src[i + 3];
+                opaque = opaque && alpha == 255;
+                transparent = transparent && alpha == 0;
+                for (uint32_t c = 0; c < 3; c++)
+                    dest[c] = Divide255(src[i + c] * alpha);
+                dest[3] = alpha;
+            }
+        }
+        kinds[tile] = transparent ? Transparent : (opaque ? Opaque : Translucent);
+    }
+
+    for (const auto& animation : animated_tiles)
+        first_frames.push_back(animation.GetNumFrames() ? animation[0] : TiledLayerData::NULL_TILE);
+}
+
+void TileCompositor::Render(const std::vector<Layer>& layers, uint32_t x, uint32_t y, uint32_t width, uint32_t height, uint8_t* rgba,
+                            uint32_t threads) const
+{
+    if (width == 0 || height == 0)
+        return;
+
+    std::vector<LayerPass> passes;
+    for (const auto& layer : layers)
+        passes.push_back(LayerPass(layer));
+    std::stable_sort(passes.begin(), passes.end(), [](const LayerPass& a, const LayerPass& b) { return ZDepthCompare(*a.layer, *b.layer); });
+
+    // Each band is a row of tiles so every pixel is drawn by exactly one thread and the result does not
+    // depend on how many threads there are, the band being drawn also stays in cache for every layer.
+    uint32_t first_band = y / tile_height;
+    uint32_t bands = (y + height - 1) / tile_height - first_band + 1;
+    if (threads == 0)
+        threads = std::max(std::thread::hardware_concurrency(), 1u);
+    threads = std::min(threads, bands);
+
+    std::atomic<uint32_t> next(0);
+    auto worker = [&]()
+    {
+        for (uint32_t band = next++; band < bands; band = next++)
+        {
+            uint32_t tile_y = first_band + band;
+            uint32_t top = std::max(tile_y * tile_height, y) - y;
+            uint32_t bottom = std::min((tile_y + 1) * tile_height, y + height) - y;
+            uint8_t* rows = rgba + static_cast<size_t>(top) * width * 4;
+            memset(rows, 0, static_cast<size_t>(bottom - top) * width * 4);
+            for (const auto& pass : passes)
+                Draw(pass, tile_y, x, y, width, height, rgba);
+            Unpremultiply(rows, static_cast<size_t>(bottom - top) * width);
+        }
+    };
+
+    std::vector<std::thread> pool;
+    for (uint32_t i = 1; i < threads; i++)
+        pool.emplace_back(worker);
+    worker();
+    for (auto& thread : pool)
+        thread.join();
+}
+
+TileCompositor::LayerPass::LayerPass(const Layer& _layer) : layer(&_layer)
+{
+    // Opacity scales alpha, the blend color (red in the low byte like wxColour::SetRGBA) multiplies the colors
+    // and its alpha scales alpha as well. Factors are for premultiplied pixels so colors get the alpha scale too.
+    float opacity = std::min(std::max(layer->GetOpacity(), 0.0f), 100.0f);
+    uint32_t color = layer->GetBlendColor();
+    uint32_t alpha = Divide255((color >> 24) * static_cast<uint32_t>(opacity * 255 / 100 + 0.5f));
+    for (uint32_t c = 0; c < 3; c++)
+        factors[c] = Divide255(((color >> (c * 8)) & 0xFF) * alpha);
+    factors[3] = alpha;
+    scaled = factors[0] != 255 || factors[1] != 255 || factors[2] != 255 || factors[3] != 255;
+}
+
+uint32_t TileCompositor::Resolve(uint32_t tile) const
+{
+    if (tile != TiledLayerData::NULL_TILE && (tile >> 31))
+    {
+        uint32_t animation = tile & ~(1u << 31);
+        tile = animation < first_frames.size() ? first_frames[animation] : TiledLayerData::NULL_TILE;
+    }
+    return tile < kinds.size() ? tile : TiledLayerData::NULL_TILE;
+}
+
+void TileCompositor::Draw(const LayerPass& pass, uint32_t tile_y, uint32_t x, uint32_t y, uint32_t width, uint32_t height, uint8_t* rgba) const
+{
+    const Layer& layer = *pass.layer;
+    if (tile_y >= layer.GetHeight() || pass.factors[3] == 0)
+        return;
+
+    // Rows of the tile inside the region.
+    uint32_t top = std::max(tile_y * tile_height, y);
+    uint32_t bottom = std::min((tile_y + 1) * tile_height, y + height);
+    uint32_t last_x = std::min((x + width - 1) / tile_width, layer.GetWidth() - 1);
+    const uint32_t tile_bytes = tile_width * tile_height * 4;
+
+    for (uint32_t tile_x = x / tile_width; tile_x <= last_x; tile_x++)
+    {
+        uint32_t tile = Resolve(layer.At(tile_x, tile_y));
+        if (tile == TiledLayerData::NULL_TILE || kinds[tile] == Transparent)
+            continue;
+
+        uint32_t left = std::max(tile_x * tile_width, x);
+        uint32_t right = std::min((tile_x + 1) * tile_width, x + width);
+        uint32_t count = right - left;
+        const uint8_t* src = &atlas[tile * tile_bytes] + (left - tile_x * tile_width) * 4;
+        for (uint32_t j = top; j < bottom; j++)
+        {
+            const uint8_t* src_row = src + (j - tile_y * tile_height) * tile_width * 4;
+            uint8_t* dest_row = rgba + ((static_cast<size_t>(j) - y) * width + left - x) * 4;
+            if (pass.scaled)
+                BlendScaled(src_row, dest_row, count, pass.factors);
+            else if (kinds[tile] == Opaque)
+                memcpy(dest_row, src_row, count * 4);
+            else
+                Blend(src_row, dest_row, count);
+        }
+    }
+}
@@ -0,0 +1,104 @@
+/******************************************************************************************************
+ * Tile Map Editor
+ * Copyright (C) 2009-2017 Brandon Whitehead (tricksterguy87[AT]gmail[DOT]com)
+ *
+ * This software is provided 'as-is', without any express or implied warranty.
+ * In no event will the authors be held liable for any damages arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * excluding commercial applications, and to alter it and redistribute it freely,
+ * subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented;
+ *    you must not claim that you wrote the original software.
+ *    An acknowledgement in your documentation and link to the original version is required.
+ *
+ * 2. Altered source versions must be plainly marked as such,
+ *    and must not be misrepresented as being the original software.
+ *
+ * 3. This notice may not be removed or altered from any source distribution.
+ ******************************************************************************************************/
+#ifndef TILE_COMPOSITOR_HPP
+#define TILE_COMPOSITOR_HPP
+
+#include <cstdint>
+#include <vector>
+
+#include "AnimatedTile.hpp"
+#include "Layer.hpp"
+
+/** Draws layers into plain RGBA buffers.
+  *
+  * The tileset is cut once into an atlas of premultiplied tiles stored one after the other, layers are
+  * then drawn a row of tiles at a time with alpha blending (SSE2 on x86 processors that support it).
+  * Rows of tiles that are fully opaque are copied and fully transparent tiles are skipped.
+  * The output is split into bands a row of tiles high that are drawn in parallel, the result is the
+  * same no matter how many threads are used.
+  *
+  * This class only deals with pixels, see HandlerUtils::MapToImage for turning a map into an image.
+  */
+class TileCompositor
+{
+public:
+    /** Cuts the tileset into tiles, partial tiles at the edges are ignored.
+      * @param rgba Pixels of the tileset as 4 bytes (red, green, blue, alpha) each.
+      * @param width Width of the tileset in pixels.
+      * @param height Height of the tileset in pixels.
+      * @param tile_width Width of a tile in pixels.
+      * @param tile_height Height of a tile in pixels.
+      * @param animated_tiles Animated tiles of the tileset, they are drawn as their first frame.
+      */
+    TileCompositor(const uint8_t* rgba, uint32_t width, uint32_t height, uint32_t tile_width, uint32_t tile_height,
+                   const std::vector<AnimatedTile>& animated_tiles = std::vector<AnimatedTile>());
+
+    /** Draws layers into a region of the map.
+      * Layers are drawn in order of depth (see ZDepthCompare), layers of the same depth in the order given.
+      * Each layer's opacity scales its alpha and its blend color (0xAABBGGRR like wxColour::SetRGBA) multiplies
+      * its pixels, the default of 0xFFFFFFFF leaves them as they are.
+      * @param layers Layers to draw.
+      * @param x Left of the region in pixels.
+      * @param y Top of the region in pixels.
+      * @param width Width of the region in pixels.
+      * @param height Height of the region in pixels.
+      * @param rgba Where to store the region's pixels, width * height * 4 bytes, parts no tile covers are transparent.
+      * @param threads Number of threads to draw with, 0 for one per core.
+      */
+    void Render(const std::vector<Layer>& layers, uint32_t x, uint32_t y, uint32_t width, uint32_t height, uint8_t* rgba,
+                uint32_t threads = 1) const;
+
+    uint32_t GetNumTiles() const { return kinds.size(); }
+    void GetTileDimensions(uint32_t& width, uint32_t& height) const { width = tile_width; height = tile_height; }
+
+private:
+    /** How a tile is drawn */
+    enum Kind
+    {
+        Transparent = 0,
+        Opaque = 1,
+        Translucent = 2,
+    };
+
+    /** A layer and how its pixels are scaled for its opacity and blend color */
+    struct LayerPass
+    {
+        explicit LayerPass(const Layer& layer);
+
+        const Layer* layer;
+        uint8_t factors[4];
+        /** False if all of the factors are 255 */
+        bool scaled;
+    };
+
+    /** Resolves animated tiles to their first frame, returns NULL_TILE for tiles not in the tileset */
+    uint32_t Resolve(uint32_t tile) const;
+    void Draw(const LayerPass& pass, uint32_t tile_y, uint32_t x, uint32_t y, uint32_t width, uint32_t height, uint8_t* rgba) const;
+
+    uint32_t tile_width;
+    uint32_t tile_height;
+    /** Premultiplied pixels of each tile one after the other */
+    std::vector<uint8_t> atlas;
+    std::vector<uint8_t> kinds;
+    std::vector<uint32_t> first_frames;
+};
+
+#endif
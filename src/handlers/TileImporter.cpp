@@ -0,0 +1,200 @@
+/******************************************************************************************************
+ * Tile Map Editor
+ * Copyright (C) 2009-2017 Brandon Whitehead (tricksterguy87[AT]gmail[DOT]com)
+ *
+ * This software is provided 'as-is', without any express or implied warranty.
+ * In no event will the authors be held liable for any damages arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * excluding commercial applications, and to alter it and redistribute it freely,
+ * subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented;
+ *    you must not claim that you wrote the original software.
+ *    An acknowledgement in your documentation and link to the original version is required.
+ *
+ * 2. Altered source versions must be plainly marked as such,
+ *    and must not be misrepresented as being the original software.
+ *
+ * 3. This notice may not be removed or altered from any source distribution.
+ ******************************************************************************************************/
+#include "TileImporter.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+#include "Hash.hpp"
+
+constexpr uint8_t TileImporter::HFLIP;
+constexpr uint8_t TileImporter::VFLIP;
+constexpr uint32_t TileImporter::DEFAULT_COLUMNS;
+
+TileImporter::TileImporter(uint32_t _tile_width, uint32_t _tile_height, bool _match_flips) : tile_width(_tile_width),
+    tile_height(_tile_height), match_flips(_match_flips), num_tileset_tiles(0), tileset_columns(0), num_tiles(0),
+    scratch(_tile_width * _tile_height * 4)
+{
+    if (tile_width == 0 || tile_height == 0)
+        throw "Tile dimensions must be non-zero";
+}
+
+void TileImporter::SetTileset(const uint8_t* rgba, uint32_t width, uint32_t height)
+{
+    tiles.clear();
+    index.clear();
+    num_tiles = 0;
+    tileset_columns = width / tile_width;
+    num_tileset_tiles = tileset_columns * (height / tile_height);
+
+    std::vector<uint8_t> block(tile_width * tile_height * 4);
+    tiles.reserve(num_tileset_tiles * block.size());
+    for (uint32_t y = 0; y + tile_height <= height; y += tile_height)
+    {
+        for (uint32_t x = 0; x + tile_width <= width; x += tile_width)
+        {
+            // Transparent tiles are kept so the numbering matches the tileset.
+            Extract(rgba, width, height, x, y, block.data());
+            Add(block.data());
+        }
+    }
+}
+
+Layer TileImporter::Import(const std::string& name, const uint8_t* rgba, uint32_t width, uint32_t height)
+{
+    if (width == 0 || height == 0)
+        throw "Image to import is empty";
+
+    uint32_t layer_width = (width + tile_width - 1) / tile_width;
+    uint32_t layer_height = (height + tile_height - 1) / tile_height;
+    std::vector<int32_t> data(layer_width * layer_height, -1);
+    flips.assign(data.size(), 0);
+
+    std::vector<uint8_t> block(tile_width * tile_height * 4);
+    for (uint32_t j = 0; j < layer_height; j++)
+    {
+        for (uint32_t i = 0; i < layer_width; i++)
+        {
+            if (!Extract(rgba, width, height, i * tile_width, j * tile_height, block.data()))
+                continue;
+
+            uint32_t spot = j * layer_width + i;
+            data[spot] = Find(block.data(), flips[spot]);
+            if (data[spot] == -1)
+                data[spot] = Add(block.data());
+        }
+    }
+
+    return Layer(name, layer_width, layer_height, data);
+}
+
+void TileImporter::GetTileset(std::vector<uint8_t>& rgba, uint32_t& width, uint32_t& height) const
+{
+    uint32_t columns = tileset_columns ? tileset_columns : std::max(1U, std::min(DEFAULT_COLUMNS, num_tiles));
+    uint32_t rows = (num_tiles + columns - 1) / columns;
+    width = columns * tile_width;
+    height = rows * tile_height;
+    rgba.assign(width * height * 4, 0);
+
+    const uint32_t row_bytes = tile_width * 4;
+    const uint32_t tile_bytes = row_bytes * tile_height;
+    for (uint32_t tile = 0; tile < num_tiles; tile++)
+    {
+        uint32_t x = tile % columns * tile_width;
+        uint32_t y = tile / columns * tile_height;
+        for (uint32_t row = 0; row < tile_height; row++)
+            memcpy(&rgba[((y + row) * width + x) * 4], &tiles[tile * tile_bytes + row * row_bytes], row_bytes);
+    }
+}
+
+bool TileImporter::Extract(const uint8_t* rgba, uint32_t width, uint32_t height, uint32_t x, uint32_t y, uint8_t* block) const
+{
+    const uint32_t row_bytes = tile_width * 4;
+    uint32_t copy_width = std::min(tile_width, width - x);
+    uint32_t copy_height = std::min(tile_height, height - y);
+    if (copy_width < tile_width || copy_height < tile_height)
+        memset(block, 0, row_bytes * tile_height);
+
+    bool opaque = false;
+    for (uint32_t row = 0; row < copy_height; row++)
+    {
+        const uint8_t* src = rgba + ((y + row) * width + x) * 4;
+        uint8_t* dest = block + row * row_bytes;
+        memcpy(dest, src, copy_width * 4);
+        for (uint32_t i = 3; !opaque && i < copy_width * 4; i += 4)
+            opaque = dest[i] != 0;
+    }
+    return opaque;
+}
+
+void TileImporter::Flip(const uint8_t* tile, uint8_t flip, uint8_t* out) const
+{
+    for (uint32_t y = 0; y < tile_height; y++)
+    {
+        uint32_t src_y = (flip & VFLIP) ? tile_height - 1 - y : y;
+        const uint8_t* src = tile + src_y * tile_width * 4;
+        uint8_t* dest = out + y * tile_width * 4;
+        if (flip & HFLIP)
+        {
+            for (uint32_t x = 0; x < tile_width; x++)
+                memcpy(dest + x * 4, src + (tile_width - 1 - x) * 4, 4);
+        }
+        else
+        {
+            memcpy(dest, src, tile_width * 4);
+        }
+    }
+}
+
+int32_t TileImporter::Find(const uint8_t* block, uint8_t& flip)
+{
+    const uint32_t tile_bytes = tile_width * tile_height * 4;
+    auto found = index.find(XXHash64(block, tile_bytes));
+    if (found == index.end())
+        return -1;
+
+    // Entries are checked against the pixels so a hash collision can never give the wrong tile,
+    // an unflipped match is preferred over a flipped one.
+    int32_t match = -1;
+    for (uint32_t entry : found->second)
+    {
+        const uint8_t* tile = &tiles[(entry >> 2) * tile_bytes];
+        uint8_t entry_flip = entry & 3;
+        if (entry_flip == 0)
+        {
+            if (memcmp(tile, block, tile_bytes) == 0)
+            {
+                flip = 0;
+                return entry >> 2;
+            }
+        }
+        else if (match == -1)
+        {
+            Flip(tile, entry_flip, scratch.data());
+            if (memcmp(scratch.data(), block, tile_bytes) == 0)
+            {
+                match = entry >> 2;
+                flip = entry_flip;
+            }
+        }
+    }
+    return match;
+}
+
+uint32_t TileImporter::Add(const uint8_t* block)
+{
+    const uint32_t tile_bytes = tile_width * tile_height * 4;
+    uint32_t id = num_tiles++;
+    tiles.insert(tiles.end(), block, block + tile_bytes);
+    index[XXHash64(block, tile_bytes)].push_back(id << 2);
+
+    if (match_flips)
+    {
+        for (uint8_t flip : {HFLIP, VFLIP, uint8_t(HFLIP | VFLIP)})
+        {
+            Flip(block, flip, scratch.data());
+            // Symmetric tiles would only add entries that can never win over the unflipped one.
+            if (memcmp(scratch.data(), block, tile_bytes) != 0)
+                index[XXHash64(scratch.data(), tile_bytes)].push_back(id << 2 | flip);
+        }
+    }
+    return id;
+}
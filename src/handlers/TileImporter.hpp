@@ -0,0 +1,114 @@
+/******************************************************************************************************
+ * Tile Map Editor
+ * Copyright (C) 2009-2017 Brandon Whitehead (tricksterguy87[AT]gmail[DOT]com)
+ *
+ * This software is provided 'as-is', without any express or implied warranty.
+ * In no event will the authors be held liable for any damages arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * excluding commercial applications, and to alter it and redistribute it freely,
+ * subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented;
+ *    you must not claim that you wrote the original software.
+ *    An acknowledgement in your documentation and link to the original version is required.
+ *
+ * 2. Altered source versions must be plainly marked as such,
+ *    and must not be misrepresented as being the original software.
+ *
+ * 3. This notice may not be removed or altered from any source distribution.
+ ******************************************************************************************************/
+#ifndef TILE_IMPORTER_HPP
+#define TILE_IMPORTER_HPP
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "Layer.hpp"
+
+/** Rebuilds layers from images of a map (screenshots, old assets) by matching tile sized blocks to a tileset.
+  *
+  * Every block is hashed with XXH64 and looked up in a hash index of the tileset's tiles so matching
+  * costs the same no matter how large the tileset is. Blocks not in the tileset are added to it,
+  * the resulting tileset (the original tiles followed by the new ones) is available from GetTileset.
+  * Fully transparent blocks become empty (-1) spots in the layer.
+  *
+  * Layers have no way to flip a tile so flip matching is off by default, when on a block matching a
+  * flipped tile reuses that tile and the flip is reported through GetFlips for formats that can store it.
+  *
+  * This class only deals with pixels, see ImageMapHandler for reading and writing the images.
+  */
+class TileImporter
+{
+public:
+    /** Flip flags returned by GetFlips */
+    static constexpr uint8_t HFLIP = 1;
+    static constexpr uint8_t VFLIP = 2;
+
+    /** Creates an importer.
+      * @param tile_width Width of a tile in pixels.
+      * @param tile_height Height of a tile in pixels.
+      * @param match_flips Also match blocks that are a horizontal and/or vertical flip of a tile.
+      */
+    TileImporter(uint32_t tile_width = 8, uint32_t tile_height = 8, bool match_flips = false);
+
+    /** Sets the tileset to match against, replacing any tiles from previous imports.
+      * Tiles are numbered left to right then top to bottom, partial tiles at the edges are ignored.
+      * @param rgba Pixels as 4 bytes (red, green, blue, alpha) each.
+      * @param width Width of the image in pixels.
+      * @param height Height of the image in pixels.
+      */
+    void SetTileset(const uint8_t* rgba, uint32_t width, uint32_t height);
+    /** Cuts an image into tiles and matches each to the tileset.
+      * Partial blocks at the right and bottom edges are padded with transparent pixels.
+      * @param name Name of the layer.
+      * @param rgba Pixels as 4 bytes (red, green, blue, alpha) each.
+      * @param width Width of the image in pixels.
+      * @param height Height of the image in pixels.
+      * @return The layer, one tile per block.
+      */
+    Layer Import(const std::string& name, const uint8_t* rgba, uint32_t width, uint32_t height);
+
+    /** @return Flip flags for each tile of the last imported layer, all 0 unless matching flips */
+    const std::vector<uint8_t>& GetFlips() const { return flips; }
+    /** @return Number of tiles including ones added by imports */
+    uint32_t GetNumTiles() const { return num_tiles; }
+    /** @return Number of tiles added by imports */
+    uint32_t GetNumNewTiles() const { return num_tiles - num_tileset_tiles; }
+    /** Builds the tileset image, the original tileset's layout is kept and new tiles are added in rows below it.
+      * @param rgba Where to store the pixels, 4 bytes (red, green, blue, alpha) each.
+      * @param width Width of the image in pixels.
+      * @param height Height of the image in pixels.
+      */
+    void GetTileset(std::vector<uint8_t>& rgba, uint32_t& width, uint32_t& height) const;
+
+    /** Number of tiles per row in a tileset built from scratch */
+    static constexpr uint32_t DEFAULT_COLUMNS = 16;
+
+private:
+    /** Copies a block of the image into block, returns false if the block is fully transparent */
+    bool Extract(const uint8_t* rgba, uint32_t width, uint32_t height, uint32_t x, uint32_t y, uint8_t* block) const;
+    /** Copies tile with the given flips applied into out */
+    void Flip(const uint8_t* tile, uint8_t flip, uint8_t* out) const;
+    int32_t Find(const uint8_t* block, uint8_t& flip);
+    uint32_t Add(const uint8_t* block);
+
+    uint32_t tile_width;
+    uint32_t tile_height;
+    bool match_flips;
+    /** Tiles in the original tileset and its columns */
+    uint32_t num_tileset_tiles;
+    uint32_t tileset_columns;
+    uint32_t num_tiles;
+    /** Pixels of each tile one after the other */
+    std::vector<uint8_t> tiles;
+    /** Hash of the tile's pixels (flipped if the flags say so) to tile index and flip flags packed as index << 2 | flags */
+    std::unordered_map<uint64_t, std::vector<uint32_t>> index;
+    std::vector<uint8_t> flips;
+    /** Scratch space for flipped tiles */
+    std::vector<uint8_t> scratch;
+};
+
+#endif
@@ -0,0 +1,519 @@
+/******************************************************************************************************
+ * Tile Map Editor
+ * Copyright (C) 2009-2017 Brandon Whitehead (tricksterguy87[AT]gmail[DOT]com)
+ *
+ * This software is provided 'as-is', without any express or implied warranty.
+ * In no event will the authors be held liable for any damages arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * excluding commercial applications, and to alter it and redistribute it freely,
+ * subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented;
+ *    you must not claim that you wrote the original software.
+ *    An acknowledgement in your documentation and link to the original version is required.
+ *
+ * 2. Altered source versions must be plainly marked as such,
+ *    and must not be misrepresented as being the original software.
+ *
+ * 3. This notice may not be removed or altered from any source distribution.
+ ******************************************************************************************************/
+#include "TiledJsonMapHandler.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#include "DirectionBasedCollisionLayer.hpp"
+#include "Logger.hpp"
+#include "PixelBasedCollisionLayer.hpp"
+#include "TileBasedCollisionLayer.hpp"
+
+namespace
+{
+
+/** Members a Tiled map can start with, Tiled writes members in alphabetical order */
+const char* MAP_KEYS[] =
+{
+    "backgroundcolor", "class", "compressionlevel", "editorsettings", "height", "hexsidelength", "infinite", "layers",
+    "nextlayerid", "nextobjectid", "orientation", "parallaxoriginx", "parallaxoriginy", "properties", "renderorder",
+    "staggeraxis", "staggerindex", "tiledversion", "tileheight", "tilesets", "tilewidth", "type", "version", "width",
+};
+
+}
+
+TiledJsonMapHandler::TiledJsonMapHandler(Encoding encoding)
+    : TiledMapHandler("Tiled JSON Format", "tmj", "Tiled map editor json format", encoding, {"json"})
+{
+}
+
+bool TiledJsonMapHandler::Sniff(const std::string& header) const
+{
+    std::string::size_type start = header.compare(0, 3, "\xEF\xBB\xBF") == 0 ? 3 : 0;
+    start = header.find_first_not_of(" \t\r\n", start);
+    if (start == std::string::npos || header[start] != '{')
+        return false;
+
+    start = header.find_first_not_of(" \t\r\n", start + 1);
+    if (start == std::string::npos || header[start] != '"')
+        return false;
+
+    std::string::size_type end = header.find('"', start + 1);
+    if (end == std::string::npos)
+        return false;
+
+    std::string key = header.substr(start + 1, end - start - 1);
+    for (const char* map_key : MAP_KEYS)
+    {
+        if (key == map_key)
+            return true;
+    }
+    return false;
+}
+
+void TiledJsonMapHandler::Load(std::istream& file, Map& map)
+{
+    EventLog l(__func__);
+
+    JsonValue root = JsonValue::Parse(file);
+    if (!root.IsObject())
+        throw "Tiled JSON map must be an object";
+    if (root.Has("type") && root.Get("type").AsString() != "map")
+        throw "Tiled JSON file is not a map";
+
+    if (root.Get("orientation").AsString() != "orthogonal")
+        WarnLog("Only orthogonal maps are supported, map will be loaded as orthogonal");
+
+    LoadState state;
+    state.tile_width = root.Get("tilewidth").AsInt(state.tile_width);
+    state.tile_height = root.Get("tileheight").AsInt(state.tile_height);
+    map.SetTileset(Tileset("", state.tile_width, state.tile_height));
+
+    Properties properties;
+    ReadProperties(root, properties);
+    map.SetName(GetProperty(properties, "name"));
+
+    const std::vector<JsonValue>& tilesets = root.Get("tilesets").GetElements();
+    if (!tilesets.empty())
+        ReadTileset(tilesets[0], state, map);
+    if (tilesets.size() > 1)
+        WarnLog("Only the first tileset is used, tile ids of later tilesets are relative to the first");
+
+    for (const auto& layer : root.Get("layers").GetElements())
+        ReadLayer(layer, state, map, 0, 0, 1.0f);
+}
+
+void TiledJsonMapHandler::ReadTileset(const JsonValue& value, LoadState& state, Map& map)
+{
+    state.first_gid = std::max<int64_t>(1, value.Get("firstgid").AsInt(1));
+
+    if (value.Has("source"))
+    {
+        // External tilesets would have to be loaded relative to the map, keep the reference.
+        WarnLog("External tileset %s is not loaded, using it as the tileset image", value.Get("source").AsString().c_str());
+        map.SetTileset(Tileset(value.Get("source").AsString(), state.tile_width, state.tile_height));
+        return;
+    }
+
+    Tileset tileset(value.Get("image").AsString(), value.Get("tilewidth").AsInt(state.tile_width),
+                    value.Get("tileheight").AsInt(state.tile_height));
+
+    for (const auto& tile : value.Get("tiles").GetElements())
+    {
+        std::vector<int32_t> frames;
+        double duration = 0;
+        for (const auto& frame : tile.Get("animation").GetElements())
+        {
+            frames.push_back(frame.Get("tileid").AsInt());
+            duration = frame.Get("duration").AsNumber(duration);
+        }
+
+        // Tiled allows a duration per frame, only the last is kept.
+        if (!frames.empty())
+            tileset.Add(AnimatedTile("Tile " + FormatNumber(tile.Get("id").AsNumber()), DurationToDelay(duration), AnimatedTile::Normal, -1, frames));
+    }
+
+    map.SetTileset(tileset);
+}
+
+void TiledJsonMapHandler::ReadLayer(const JsonValue& value, LoadState& state, Map& map, int32_t offset_x, int32_t offset_y, float opacity)
+{
+    std::string type = value.Get("type").AsString();
+    std::string name = value.Get("name").AsString();
+    offset_x += std::lround(value.Get("offsetx").AsNumber());
+    offset_y += std::lround(value.Get("offsety").AsNumber());
+    opacity *= value.Get("opacity").AsNumber(1);
+
+    Properties properties;
+    ReadProperties(value, properties);
+    std::string collision = GetProperty(properties, "collision");
+
+    if (type == "group")
+    {
+        for (const auto& layer : value.Get("layers").GetElements())
+            ReadLayer(layer, state, map, offset_x, offset_y, opacity);
+        return;
+    }
+
+    DrawAttributes attr(0);
+    ReadAttributeProperties(properties, attr);
+    attr.SetPosition(offset_x, offset_y);
+    attr.SetOpacity(opacity * 100);
+
+    if (type == "tilelayer")
+    {
+        std::string encoding = value.Get("encoding").AsString();
+        std::string compression = value.Get("compression").AsString();
+
+        std::vector<Chunk> chunks;
+        if (value.Has("chunks"))
+        {
+            for (const auto& chunk_value : value.Get("chunks").GetElements())
+            {
+                chunks.emplace_back();
+                Chunk& chunk = chunks.back();
+                InitChunk(chunk, chunk_value.Get("x").AsNumber(), chunk_value.Get("y").AsNumber(),
+                          chunk_value.Get("width").AsNumber(), chunk_value.Get("height").AsNumber());
+                ReadData(chunk_value.Get("data"), state, encoding, compression, chunk.tiles);
+            }
+        }
+        else
+        {
+            chunks.emplace_back();
+            Chunk& chunk = chunks.back();
+            InitChunk(chunk, 0, 0, value.Get("width").AsNumber(), value.Get("height").AsNumber());
+            ReadData(value.Get("data"), state, encoding, compression, chunk.tiles);
+        }
+
+        TiledLayerData tiles;
+        int32_t x, y;
+        MergeChunks(chunks, tiles, x, y);
+
+        if (collision == "tile" || collision == "direction")
+            MoveToOrigin(tiles, x, y);
+        if (collision == "tile")
+        {
+            map.SetCollisionLayer(new TileBasedCollisionLayer(tiles.GetWidth(), tiles.GetHeight(), tiles.GetData()));
+            return;
+        }
+        if (collision == "direction")
+        {
+            map.SetCollisionLayer(new DirectionBasedCollisionLayer(tiles.GetWidth(), tiles.GetHeight(), tiles.GetData()));
+            return;
+        }
+
+        attr.SetPosition(offset_x + x * static_cast<int32_t>(state.tile_width), offset_y + y * static_cast<int32_t>(state.tile_height));
+        map.Add(Layer(name, tiles.GetWidth(), tiles.GetHeight(), tiles.GetData(), attr));
+    }
+    else if (type == "imagelayer")
+    {
+        uint32_t mode = value.Get("repeatx").AsBool() || value.Get("repeaty").AsBool() ? Background::Repeating : Background::Once;
+
+        DrawAttributes back_attr(-1);
+        ReadAttributeProperties(properties, back_attr);
+        back_attr.SetPosition(offset_x, offset_y);
+        back_attr.SetOpacity(opacity * 100);
+        map.Add(Background(name, value.Get("image").AsString(), ParseNumber(GetProperty(properties, "mode"), mode),
+                           ParseNumber(GetProperty(properties, "speed_x")), ParseNumber(GetProperty(properties, "speed_y")), back_attr));
+    }
+    else if (type == "objectgroup")
+    {
+        if (collision != "pixel")
+        {
+            VerboseLog("Skipping object group %s", name.c_str());
+            return;
+        }
+
+        std::vector<Rectangle> rectangles;
+        for (const auto& object : value.Get("objects").GetElements())
+        {
+            Rectangle rectangle(std::lround(object.Get("x").AsNumber()) + offset_x, std::lround(object.Get("y").AsNumber()) + offset_y,
+                                std::lround(object.Get("width").AsNumber()), std::lround(object.Get("height").AsNumber()));
+            // Points, polygons and polylines have no size.
+            if (rectangle.IsValid())
+                rectangles.push_back(rectangle);
+        }
+        map.SetCollisionLayer(new PixelBasedCollisionLayer(rectangles));
+    }
+}
+
+void TiledJsonMapHandler::ReadData(const JsonValue& value, LoadState& state, const std::string& encoding, const std::string& compression,
+                                   std::vector<int32_t>& tiles)
+{
+    if (encoding == "base64")
+    {
+        DecodeData(value.AsString(), encoding, compression, state, tiles);
+        return;
+    }
+
+    const std::vector<double>& gids = value.GetNumbers();
+    // An empty layer may have been parsed as a plain array.
+    if (gids.size() != tiles.size())
+        throw "Tile data size does not match layer dimensions";
+    for (uint32_t i = 0; i < gids.size(); i++)
+        tiles[i] = GidToTile(static_cast<uint32_t>(gids[i]), state);
+}
+
+void TiledJsonMapHandler::ReadProperties(const JsonValue& value, Properties& properties)
+{
+    for (const auto& property : value.Get("properties").GetElements())
+    {
+        const JsonValue& property_value = property.Get("value");
+        std::string text;
+        switch (property_value.GetType())
+        {
+            case JsonValue::Bool:
+                text = property_value.AsBool() ? "true" : "false";
+                break;
+            case JsonValue::Number:
+                text = FormatNumber(property_value.AsNumber());
+                break;
+            default:
+                text = property_value.AsString();
+                break;
+        }
+        std::string type = property.Has("type") ? property.Get("type").AsString() : "string";
+        properties.push_back({property.Get("name").AsString(), type, text});
+    }
+}
+
+void TiledJsonMapHandler::WriteProperties(JsonValue& value, const Properties& properties)
+{
+    if (properties.empty())
+        return;
+
+    JsonValue& list = value.Set("properties", JsonValue::Make(JsonValue::Array));
+    for (const auto& property : properties)
+    {
+        JsonValue& element = list.Add(JsonValue::Make(JsonValue::Object));
+        element.Set("name", property.name);
+        element.Set("type", property.type);
+        if (property.type == "int" || property.type == "float")
+            element.Set("value", ParseNumber(property.value));
+        else if (property.type == "bool")
+            element.Set("value", property.value == "true");
+        else
+            element.Set("value", property.value);
+    }
+}
+
+void TiledJsonMapHandler::Save(std::ostream& file, const Map& map)
+{
+    EventLog l(__func__);
+
+    uint32_t tile_width, tile_height;
+    map.GetTileset().GetTileDimensions(tile_width, tile_height);
+    uint32_t num_layers = map.GetNumBackgrounds() + map.GetNumLayers() + (map.HasCollisionLayer() ? 1 : 0);
+
+    // Members are added in alphabetical order like Tiled does.
+    JsonValue root = JsonValue::Make(JsonValue::Object);
+    root.Set("compressionlevel", -1);
+    root.Set("height", std::max(map.GetHeight(), 1u));
+    root.Set("infinite", false);
+
+    // Backgrounds are drawn behind the layers and Tiled draws in document order.
+    JsonValue& layers = root.Set("layers", JsonValue::Make(JsonValue::Array));
+    uint32_t id = 1;
+    for (const auto& background : map.GetBackgrounds())
+        layers.Add(WriteBackground(id++, background));
+    for (const auto& layer : map.GetLayers())
+        layers.Add(WriteLayer(id++, layer.GetName(), layer, layer, Properties()));
+    if (map.HasCollisionLayer())
+    {
+        JsonValue collision = WriteCollision(id++, map);
+        if (!collision.IsNull())
+            layers.Add(collision);
+    }
+
+    root.Set("nextlayerid", num_layers + 1);
+    root.Set("nextobjectid", NextObjectId(map));
+    root.Set("orientation", "orthogonal");
+    if (!map.GetName().empty())
+        WriteProperties(root, {{"name", "string", map.GetName()}});
+    root.Set("renderorder", "right-down");
+    root.Set("tileheight", tile_height);
+    root.Set("tilesets", JsonValue::Make(JsonValue::Array)).Add(WriteTileset(map));
+    root.Set("tilewidth", tile_width);
+    root.Set("type", "map");
+    root.Set("version", FORMAT_VERSION);
+    root.Set("width", std::max(map.GetWidth(), 1u));
+
+    root.Write(file, 1);
+    file << "\n";
+    if (!file)
+        throw "Could not save Tiled JSON file";
+}
+
+JsonValue TiledJsonMapHandler::WriteTileset(const Map& map)
+{
+    const Tileset& tileset = map.GetTileset();
+    uint32_t tile_width, tile_height;
+    tileset.GetTileDimensions(tile_width, tile_height);
+
+    std::string name = tileset.GetFilename();
+    std::string::size_type slash = name.find_last_of("/\\");
+    if (slash != std::string::npos)
+        name = name.substr(slash + 1);
+    name = name.substr(0, name.rfind('.'));
+
+    JsonValue value = JsonValue::Make(JsonValue::Object);
+    value.Set("firstgid", 1);
+    value.Set("image", tileset.GetFilename());
+    value.Set("name", name);
+    value.Set("tileheight", tile_height);
+
+    // Tiled attaches animations to a tile, use the first frame's tile.
+    JsonValue tiles = JsonValue::Make(JsonValue::Array);
+    std::set<int32_t> animated;
+    for (const auto& animation : tileset.GetAnimatedTiles())
+    {
+        if (animation.GetFrames().empty() || !animated.insert(animation.GetFrames()[0]).second)
+        {
+            WarnLog("Skipping animation %s Tiled can only have one animation per tile", animation.GetName().c_str());
+            continue;
+        }
+
+        JsonValue& tile = tiles.Add(JsonValue::Make(JsonValue::Object));
+        JsonValue& frames = tile.Set("animation", JsonValue::Make(JsonValue::Array));
+        for (const auto frame_id : animation.GetFrames())
+        {
+            JsonValue& frame = frames.Add(JsonValue::Make(JsonValue::Object));
+            frame.Set("duration", DelayToDuration(animation.GetDelay()));
+            frame.Set("tileid", frame_id);
+        }
+        tile.Set("id", animation.GetFrames()[0]);
+    }
+    if (tiles.Size())
+        value.Set("tiles", tiles);
+    value.Set("tilewidth", tile_width);
+
+    return value;
+}
+
+JsonValue TiledJsonMapHandler::WriteLayer(uint32_t id, const std::string& name, const TiledLayerData& layer,
+                                          const DrawAttributes& attr, const Properties& extra)
+{
+    int32_t x, y;
+    attr.GetPosition(x, y);
+
+    JsonValue value = JsonValue::Make(JsonValue::Object);
+    if (*GetCompressionName())
+        value.Set("compression", GetCompressionName());
+    if (encoding == Csv)
+    {
+        JsonValue& data = value.Set("data", JsonValue::Make(JsonValue::NumberArray));
+        std::vector<double>& gids = data.GetNumbers();
+        gids.reserve(layer.GetData().size());
+        for (const auto tile : layer.GetData())
+            gids.push_back(TileToGid(tile));
+    }
+    else
+    {
+        value.Set("data", EncodeData(layer));
+        value.Set("encoding", GetEncodingName());
+    }
+    value.Set("height", layer.GetHeight());
+    value.Set("id", id);
+    value.Set("name", name);
+    if (x != 0)
+        value.Set("offsetx", x);
+    if (y != 0)
+        value.Set("offsety", y);
+    value.Set("opacity", attr.GetOpacity() / 100);
+
+    Properties properties = extra;
+    WriteAttributeProperties(attr, properties);
+    WriteProperties(value, properties);
+
+    value.Set("type", "tilelayer");
+    value.Set("visible", true);
+    value.Set("width", layer.GetWidth());
+    value.Set("x", 0);
+    value.Set("y", 0);
+    return value;
+}
+
+JsonValue TiledJsonMapHandler::WriteBackground(uint32_t id, const Background& background)
+{
+    int32_t x, y;
+    float speed_x, speed_y;
+    background.GetPosition(x, y);
+    background.GetSpeed(speed_x, speed_y);
+    bool repeat = (background.GetMode() & Background::Repeating) != 0;
+
+    JsonValue value = JsonValue::Make(JsonValue::Object);
+    value.Set("id", id);
+    value.Set("image", background.GetFilename());
+    value.Set("name", background.GetName());
+    if (x != 0)
+        value.Set("offsetx", x);
+    if (y != 0)
+        value.Set("offsety", y);
+    value.Set("opacity", background.GetOpacity() / 100);
+
+    Properties properties = {{"mode", "int", FormatNumber(background.GetMode())}};
+    if (speed_x != 0 || speed_y != 0)
+    {
+        properties.push_back({"speed_x", "float", FormatNumber(speed_x)});
+        properties.push_back({"speed_y", "float", FormatNumber(speed_y)});
+    }
+    WriteAttributeProperties(background, properties, -1);
+    WriteProperties(value, properties);
+
+    value.Set("repeatx", repeat);
+    value.Set("repeaty", repeat);
+    value.Set("type", "imagelayer");
+    value.Set("visible", true);
+    value.Set("x", 0);
+    value.Set("y", 0);
+    return value;
+}
+
+JsonValue TiledJsonMapHandler::WriteCollision(uint32_t id, const Map& map)
+{
+    CollisionLayer* layer = map.GetCollisionLayer();
+    switch (layer->GetType())
+    {
+        case CollisionLayer::TileBased:
+        case CollisionLayer::DirectionBased:
+        {
+            const char* type = layer->GetType() == CollisionLayer::TileBased ? "tile" : "direction";
+            DrawAttributes attr(0);
+            attr.SetOpacity(50);
+            return WriteLayer(id, "Collision", dynamic_cast<TiledCollisionLayer*>(layer)->Unpack(), attr, {{"collision", "string", type}});
+        }
+        case CollisionLayer::PixelBased:
+        {
+            JsonValue value = JsonValue::Make(JsonValue::Object);
+            value.Set("draworder", "topdown");
+            value.Set("id", id);
+            value.Set("name", "Collision");
+
+            JsonValue& objects = value.Set("objects", JsonValue::Make(JsonValue::Array));
+            uint32_t object_id = 1;
+            for (const auto& rectangle : dynamic_cast<PixelBasedCollisionLayer*>(layer)->GetData().GetData())
+            {
+                JsonValue& object = objects.Add(JsonValue::Make(JsonValue::Object));
+                object.Set("height", rectangle.height);
+                object.Set("id", object_id++);
+                object.Set("name", "");
+                object.Set("rotation", 0);
+                object.Set("visible", true);
+                object.Set("width", rectangle.width);
+                object.Set("x", rectangle.x);
+                object.Set("y", rectangle.y);
+            }
+
+            value.Set("opacity", 1);
+            WriteProperties(value, {{"collision", "string", "pixel"}});
+            value.Set("type", "objectgroup");
+            value.Set("visible", true);
+            value.Set("x", 0);
+            value.Set("y", 0);
+            return value;
+        }
+        default:
+            WarnLog("Unknown Collision Type %d ignoring", layer->GetType());
+            return JsonValue();
+    }
+}
@@ -0,0 +1,57 @@
+/******************************************************************************************************
+ * Tile Map Editor
+ * Copyright (C) 2009-2017 Brandon Whitehead (tricksterguy87[AT]gmail[DOT]com)
+ *
+ * This software is provided 'as-is', without any express or implied warranty.
+ * In no event will the authors be held liable for any damages arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * excluding commercial applications, and to alter it and redistribute it freely,
+ * subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented;
+ *    you must not claim that you wrote the original software.
+ *    An acknowledgement in your documentation and link to the original version is required.
+ *
+ * 2. Altered source versions must be plainly marked as such,
+ *    and must not be misrepresented as being the original software.
+ *
+ * 3. This notice may not be removed or altered from any source distribution.
+ ******************************************************************************************************/
+#ifndef TILED_JSON_MAP_HANDLER_HPP
+#define TILED_JSON_MAP_HANDLER_HPP
+
+#include "Json.hpp"
+#include "TiledMapHandler.hpp"
+
+/** Handler for Tiled's json format (.tmj, older versions of Tiled used .json)
+  * @see TiledMapHandler for how maps are converted
+  */
+class TiledJsonMapHandler : public TiledMapHandler {
+public:
+    /** Creates the handler
+      * @param encoding How tile data is written.
+      */
+    TiledJsonMapHandler(Encoding encoding = Csv);
+    /** @see BaseMapHandler::Load */
+    virtual void Load(std::istream& file, Map& map);
+    /** @see BaseMapHandler::Save */
+    virtual void Save(std::ostream& file, const Map& map);
+    /** @see BaseMapHandler::Sniff */
+    virtual bool Sniff(const std::string& header) const;
+
+private:
+    void ReadTileset(const JsonValue& value, LoadState& state, Map& map);
+    void ReadLayer(const JsonValue& value, LoadState& state, Map& map, int32_t offset_x, int32_t offset_y, float opacity);
+    void ReadData(const JsonValue& value, LoadState& state, const std::string& encoding, const std::string& compression,
+                  std::vector<int32_t>& tiles);
+    JsonValue WriteTileset(const Map& map);
+    JsonValue WriteLayer(uint32_t id, const std::string& name, const TiledLayerData& layer,
+                         const DrawAttributes& attr, const Properties& properties);
+    JsonValue WriteBackground(uint32_t id, const Background& background);
+    JsonValue WriteCollision(uint32_t id, const Map& map);
+    static void ReadProperties(const JsonValue& value, Properties& properties);
+    static void WriteProperties(JsonValue& value, const Properties& properties);
+};
+
+#endif
@@ -0,0 +1,403 @@
+/******************************************************************************************************
+ * Tile Map Editor
+ * Copyright (C) 2009-2017 Brandon Whitehead (tricksterguy87[AT]gmail[DOT]com)
+ *
+ * This software is provided 'as-is', without any express or implied warranty.
+ * In no event will the authors be held liable for any damages arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * excluding commercial applications, and to alter it and redistribute it freely,
+ * subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented;
+ *    you must not claim that you wrote the original software.
+ *    An acknowledgement in your documentation and link to the original version is required.
+ *
+ * 2. Altered source versions must be plainly marked as such,
+ *    and must not be misrepresented as being the original software.
+ *
+ * 3. This notice may not be removed or altered from any source distribution.
+ ******************************************************************************************************/
+#include "TiledMapHandler.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <locale>
+#include <sstream>
+
+#include "Base64.hpp"
+#include "Compression.hpp"
+#include "Logger.hpp"
+#include "PixelBasedCollisionLayer.hpp"
+
+const char* TiledMapHandler::FORMAT_VERSION = "1.10";
+
+namespace
+{
+
+/** Gid bits Tiled uses for flipping and rotating tiles */
+constexpr uint32_t GID_FLAGS = 0xF0000000;
+/** Length of an animation frame for converting to and from milliseconds */
+constexpr double FRAME_MS = 1000.0 / 60.0;
+/** Furthest a chunk may be from the origin in tiles, keeps the merged bounds of a layer within int32 */
+constexpr double MAX_CHUNK_OFFSET = static_cast<double>(TiledLayerData::MAX_SIZE) * TiledLayerData::MAX_SIZE;
+
+void AppendUnsigned(std::string& out, uint32_t value)
+{
+    char buffer[12];
+    char* end = buffer + sizeof(buffer);
+    char* ptr = end;
+    do
+    {
+        *--ptr = '0' + value % 10;
+        value /= 10;
+    } while (value);
+    out.append(ptr, end);
+}
+
+}
+
+TiledMapHandler::TiledMapHandler(const std::string& name, const std::string& extension, const std::string& description,
+                                 Encoding _encoding, const std::set<std::string>& alternatives)
+    : BaseMapHandler(name, extension, description, true, true, alternatives), encoding(_encoding)
+{
+}
+
+int32_t TiledMapHandler::GidToTile(uint32_t gid, LoadState& state)
+{
+    if (gid & GID_FLAGS)
+    {
+        if (!state.dropped_flags)
+            WarnLog("Tile flip and rotation flags are not supported and were dropped");
+        state.dropped_flags = true;
+        gid &= ~GID_FLAGS;
+    }
+
+    if (gid < state.first_gid)
+        return -1;
+    return static_cast<int32_t>(gid - state.first_gid);
+}
+
+void TiledMapHandler::DecodeData(const std::string& text, const std::string& encoding, const std::string& compression,
+                                 LoadState& state, std::vector<int32_t>& tiles)
+{
+    size_t count = 0;
+
+    if (encoding == "csv")
+    {
+        if (!compression.empty())
+            throw "csv tile data can not be compressed";
+
+        const char* ptr = text.c_str();
+        const char* end = ptr + text.size();
+        while (ptr < end)
+        {
+            if (*ptr == ',' || *ptr == ' ' || *ptr == '\n' || *ptr == '\r' || *ptr == '\t')
+            {
+                ptr++;
+                continue;
+            }
+            if (*ptr < '0' || *ptr > '9')
+                throw "Invalid character in csv tile data";
+
+            uint64_t gid = 0;
+            while (ptr < end && *ptr >= '0' && *ptr <= '9')
+            {
+                gid = gid * 10 + (*ptr++ - '0');
+                if (gid > 0xFFFFFFFFULL)
+                    throw "Tile id out of range in csv tile data";
+            }
+
+            if (count >= tiles.size())
+                throw "Tile data size does not match layer dimensions";
+            tiles[count++] = GidToTile(static_cast<uint32_t>(gid), state);
+        }
+    }
+    else if (encoding == "base64")
+    {
+        std::vector<uint8_t> bytes;
+        if (!Base64Decode(text, bytes))
+            throw "Invalid base64 tile data";
+
+        // Gids may be split across the blocks handed out by the decompressor.
+        uint8_t partial[4];
+        size_t partial_size = 0;
+        auto sink = [&](const uint8_t* data, size_t size) -> bool
+        {
+            for (size_t i = 0; i < size; i++)
+            {
+                partial[partial_size++] = data[i];
+                if (partial_size < 4)
+                    continue;
+
+                partial_size = 0;
+                if (count >= tiles.size())
+                    return false;
+                uint32_t gid = partial[0] | (partial[1] << 8) | (partial[2] << 16) | (static_cast<uint32_t>(partial[3]) << 24);
+                tiles[count++] = GidToTile(gid, state);
+            }
+            return true;
+        };
+
+        bool ok;
+        if (compression.empty())
+            ok = sink(bytes.data(), bytes.size());
+        else if (compression == "zlib" || compression == "gzip")
+            ok = ZlibDecompress(bytes.data(), bytes.size(), sink);
+        else
+            throw "Unsupported tile data compression";
+
+        if (!ok || partial_size != 0)
+            throw "Tile data size does not match layer dimensions";
+    }
+    else
+    {
+        throw "Unsupported tile data encoding";
+    }
+
+    if (count != tiles.size())
+        throw "Tile data size does not match layer dimensions";
+}
+
+std::string TiledMapHandler::EncodeData(const TiledLayerData& layer) const
+{
+    const std::vector<int32_t>& tiles = layer.GetData();
+    std::string out;
+
+    if (encoding == Csv)
+    {
+        out.reserve(tiles.size() * 4 + 2);
+        out += '\n';
+        for (uint32_t i = 0; i < tiles.size(); i++)
+        {
+            AppendUnsigned(out, TileToGid(tiles[i]));
+            if (i + 1 == tiles.size())
+                out += '\n';
+            else if ((i + 1) % layer.GetWidth() == 0)
+                out += ",\n";
+            else
+                out += ',';
+        }
+        return out;
+    }
+
+    std::vector<uint8_t> bytes(tiles.size() * 4);
+    for (uint32_t i = 0; i < tiles.size(); i++)
+    {
+        uint32_t gid = TileToGid(tiles[i]);
+        bytes[i * 4] = gid & 0xFF;
+        bytes[i * 4 + 1] = (gid >> 8) & 0xFF;
+        bytes[i * 4 + 2] = (gid >> 16) & 0xFF;
+        bytes[i * 4 + 3] = gid >> 24;
+    }
+
+    if (encoding == Base64Zlib || encoding == Base64Gzip)
+    {
+        std::vector<uint8_t> compressed;
+        ZlibCompress(bytes.data(), bytes.size(), compressed, encoding == Base64Gzip);
+        bytes.swap(compressed);
+    }
+
+    return Base64Encode(bytes.data(), bytes.size());
+}
+
+const char* TiledMapHandler::GetEncodingName() const
+{
+    return encoding == Csv ? "csv" : "base64";
+}
+
+const char* TiledMapHandler::GetCompressionName() const
+{
+    switch (encoding)
+    {
+        case Base64Zlib:
+            return "zlib";
+        case Base64Gzip:
+            return "gzip";
+        default:
+            return "";
+    }
+}
+
+void TiledMapHandler::InitChunk(Chunk& chunk, double x, double y, double width, double height)
+{
+    // Written so that NaN fails every check.
+    if (!(width >= 1 && width <= TiledLayerData::MAX_SIZE && height >= 1 && height <= TiledLayerData::MAX_SIZE))
+        throw "Invalid layer dimensions";
+    if (!(std::abs(x) <= MAX_CHUNK_OFFSET && std::abs(y) <= MAX_CHUNK_OFFSET))
+        throw "Chunk position is out of range";
+
+    chunk.x = static_cast<int32_t>(x);
+    chunk.y = static_cast<int32_t>(y);
+    chunk.width = static_cast<uint32_t>(width);
+    chunk.height = static_cast<uint32_t>(height);
+    chunk.tiles.resize(static_cast<uint64_t>(chunk.width) * chunk.height);
+}
+
+void TiledMapHandler::MergeChunks(const std::vector<Chunk>& chunks, TiledLayerData& data, int32_t& x, int32_t& y)
+{
+    if (chunks.empty())
+    {
+        data = TiledLayerData(1, 1);
+        x = y = 0;
+        return;
+    }
+
+    int32_t min_x = chunks[0].x, min_y = chunks[0].y;
+    int32_t max_x = chunks[0].x + chunks[0].width, max_y = chunks[0].y + chunks[0].height;
+    for (const auto& chunk : chunks)
+    {
+        min_x = std::min(min_x, chunk.x);
+        min_y = std::min(min_y, chunk.y);
+        max_x = std::max(max_x, chunk.x + static_cast<int32_t>(chunk.width));
+        max_y = std::max(max_y, chunk.y + static_cast<int32_t>(chunk.height));
+    }
+
+    uint32_t width = max_x - min_x;
+    uint32_t height = max_y - min_y;
+    if (static_cast<uint64_t>(width) * height > static_cast<uint64_t>(TiledLayerData::MAX_SIZE) * TiledLayerData::MAX_SIZE * 16)
+        throw "Infinite layer is too large";
+
+    data = TiledLayerData(width, height);
+    std::vector<int32_t>& tiles = data.GetData();
+    for (const auto& chunk : chunks)
+    {
+        for (uint32_t row = 0; row < chunk.height; row++)
+        {
+            const int32_t* src = chunk.tiles.data() + row * chunk.width;
+            int32_t* dest = tiles.data() + (chunk.y - min_y + row) * width + (chunk.x - min_x);
+            memcpy(dest, src, chunk.width * sizeof(int32_t));
+        }
+    }
+
+    x = min_x;
+    y = min_y;
+}
+
+void TiledMapHandler::MoveToOrigin(TiledLayerData& data, int32_t x, int32_t y)
+{
+    if (x == 0 && y == 0)
+        return;
+
+    int32_t width = std::max(static_cast<int32_t>(data.GetWidth()) + x, 1);
+    int32_t height = std::max(static_cast<int32_t>(data.GetHeight()) + y, 1);
+    if (static_cast<uint64_t>(width) * height > static_cast<uint64_t>(TiledLayerData::MAX_SIZE) * TiledLayerData::MAX_SIZE * 16)
+        throw "Infinite layer is too large";
+
+    // Only copy where the tiles overlap the moved layer, tiles entirely left of or above the origin leave it empty.
+    int32_t end_x = std::min(width, static_cast<int32_t>(data.GetWidth()) + x);
+    int32_t end_y = std::min(height, static_cast<int32_t>(data.GetHeight()) + y);
+    TiledLayerData moved(width, height);
+    for (int32_t j = std::max(y, 0); j < end_y; j++)
+        for (int32_t i = std::max(x, 0); i < end_x; i++)
+            moved.GetData()[j * width + i] = data.GetData()[(j - y) * data.GetWidth() + (i - x)];
+    data = moved;
+}
+
+uint32_t TiledMapHandler::NextObjectId(const Map& map)
+{
+    const PixelBasedCollisionLayer* layer = map.HasCollisionLayer() ? dynamic_cast<const PixelBasedCollisionLayer*>(map.GetCollisionLayer()) : nullptr;
+    return layer ? layer->GetData().GetData().size() + 1 : 1;
+}
+
+void TiledMapHandler::WriteAttributeProperties(const DrawAttributes& attr, Properties& properties, int32_t default_depth)
+{
+    int32_t origin_x, origin_y;
+    float scale_x, scale_y;
+    attr.GetOrigin(origin_x, origin_y);
+    attr.GetScale(scale_x, scale_y);
+
+    if (attr.GetDepth() != default_depth)
+        properties.push_back({"depth", "int", FormatNumber(attr.GetDepth())});
+    if (origin_x != 0 || origin_y != 0)
+    {
+        properties.push_back({"origin_x", "int", FormatNumber(origin_x)});
+        properties.push_back({"origin_y", "int", FormatNumber(origin_y)});
+    }
+    if (scale_x != 1 || scale_y != 1)
+    {
+        properties.push_back({"scale_x", "float", FormatNumber(scale_x)});
+        properties.push_back({"scale_y", "float", FormatNumber(scale_y)});
+    }
+    if (attr.GetRotation() != 0)
+        properties.push_back({"rotation", "float", FormatNumber(attr.GetRotation())});
+    if (attr.GetBlendMode() != 0)
+        properties.push_back({"blend_mode", "int", FormatNumber(attr.GetBlendMode())});
+    if (attr.GetBlendColor() != 0xFFFFFFFF)
+        properties.push_back({"blend_color", "string", FormatNumber(attr.GetBlendColor())});
+}
+
+void TiledMapHandler::ReadAttributeProperties(const Properties& properties, DrawAttributes& attr)
+{
+    int32_t origin_x, origin_y;
+    float scale_x, scale_y;
+    attr.GetOrigin(origin_x, origin_y);
+    attr.GetScale(scale_x, scale_y);
+
+    attr.SetDepth(ParseNumber(GetProperty(properties, "depth"), attr.GetDepth()));
+    attr.SetOrigin(ParseNumber(GetProperty(properties, "origin_x"), origin_x), ParseNumber(GetProperty(properties, "origin_y"), origin_y));
+    attr.SetScale(ParseNumber(GetProperty(properties, "scale_x"), scale_x), ParseNumber(GetProperty(properties, "scale_y"), scale_y));
+    attr.SetRotation(ParseNumber(GetProperty(properties, "rotation"), attr.GetRotation()));
+    attr.SetBlendMode(ParseNumber(GetProperty(properties, "blend_mode"), attr.GetBlendMode()));
+    attr.SetBlendColor(ParseNumber(GetProperty(properties, "blend_color"), attr.GetBlendColor()));
+}
+
+std::string TiledMapHandler::GetProperty(const Properties& properties, const std::string& name, const std::string& def)
+{
+    for (const auto& property : properties)
+    {
+        if (property.name == name)
+            return property.value;
+    }
+    return def;
+}
+
+std::string TiledMapHandler::FormatNumber(double value)
+{
+    if (value == std::floor(value) && std::fabs(value) < 4294967296.0)
+    {
+        std::string out;
+        if (value < 0)
+            out += '-';
+        AppendUnsigned(out, static_cast<uint32_t>(std::fabs(value)));
+        return out;
+    }
+
+    // Everything stored as a fraction is a float so use the fewest digits that read back as the same float.
+    std::ostringstream stream;
+    stream.imbue(std::locale::classic());
+    for (int precision : {6, 9, 17})
+    {
+        stream.str("");
+        stream.precision(precision);
+        stream << value;
+        if (static_cast<float>(ParseNumber(stream.str())) == static_cast<float>(value))
+            break;
+    }
+    return stream.str();
+}
+
+double TiledMapHandler::ParseNumber(const std::string& text, double def)
+{
+    if (text.empty())
+        return def;
+
+    std::istringstream stream(text);
+    stream.imbue(std::locale::classic());
+    double value;
+    stream >> value;
+    if (stream.fail() || !stream.eof())
+        return def;
+    return value;
+}
+
+int32_t TiledMapHandler::DurationToDelay(double duration)
+{
+    return std::max(1L, std::lround(duration / FRAME_MS));
+}
+
+int32_t TiledMapHandler::DelayToDuration(int32_t delay)
+{
+    return std::lround(delay * FRAME_MS);
+}
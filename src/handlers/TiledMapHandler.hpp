@@ -0,0 +1,162 @@
+/******************************************************************************************************
+ * Tile Map Editor
+ * Copyright (C) 2009-2017 Brandon Whitehead (tricksterguy87[AT]gmail[DOT]com)
+ *
+ * This software is provided 'as-is', without any express or implied warranty.
+ * In no event will the authors be held liable for any damages arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * excluding commercial applications, and to alter it and redistribute it freely,
+ * subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented;
+ *    you must not claim that you wrote the original software.
+ *    An acknowledgement in your documentation and link to the original version is required.
+ *
+ * 2. Altered source versions must be plainly marked as such,
+ *    and must not be misrepresented as being the original software.
+ *
+ * 3. This notice may not be removed or altered from any source distribution.
+ ******************************************************************************************************/
+#ifndef TILED_MAP_HANDLER_HPP
+#define TILED_MAP_HANDLER_HPP
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "BaseMapHandler.hpp"
+
+/** Shared parts of the handlers for the Tiled map editor's (mapeditor.org) TMX and JSON formats.
+  *
+  * Tiled stores global tile ids (gids) where 0 is no tile and tile n of the first tileset is firstgid + n,
+  * the top bits of a gid are flip flags which have no equivalent here and are dropped.
+  * Only the first tileset is used, gids of later tilesets are taken relative to the first one.
+  *
+  * Things Tiled has no equivalent for are stored as custom properties so maps round trip:
+  * the map name, DrawAttributes other than position and opacity, background modes and speeds.
+  * Collision layers are a tile layer or an object group with a "collision" property set to
+  * "tile", "direction" or "pixel", tile collision values are stored as value + 1 like tile ids.
+  */
+class TiledMapHandler : public BaseMapHandler {
+public:
+    /** Controls how the tile data of layers is written */
+    enum Encoding
+    {
+        /** Comma separated gids (plain arrays in JSON) */
+        Csv = 0,
+        /** Little endian 32 bit gids encoded as base64 */
+        Base64 = 1,
+        /** Base64 of zlib compressed gids */
+        Base64Zlib = 2,
+        /** Base64 of gzip compressed gids */
+        Base64Gzip = 3,
+    };
+
+    Encoding GetEncoding() const { return encoding; }
+    void SetEncoding(Encoding _encoding) { encoding = _encoding; }
+
+protected:
+    TiledMapHandler(const std::string& name, const std::string& extension, const std::string& description,
+                    Encoding encoding, const std::set<std::string>& alternatives = std::set<std::string>());
+
+    /** State kept while loading a single file */
+    struct LoadState
+    {
+        uint32_t first_gid = 1;
+        uint32_t tile_width = Tileset::MIN_TILE_SIZE;
+        uint32_t tile_height = Tileset::MIN_TILE_SIZE;
+        bool dropped_flags = false;
+    };
+
+    /** Rectangle of tiles in a layer, a finite layer is a single chunk */
+    struct Chunk
+    {
+        int32_t x = 0;
+        int32_t y = 0;
+        uint32_t width = 0;
+        uint32_t height = 0;
+        std::vector<int32_t> tiles;
+    };
+
+    /** A custom property, values are stored as they are written in the file */
+    struct Property
+    {
+        std::string name;
+        std::string type;
+        std::string value;
+    };
+    typedef std::vector<Property> Properties;
+
+    /** Converts a gid to a tile id, 0 (no tile) becomes -1 */
+    static int32_t GidToTile(uint32_t gid, LoadState& state);
+    /** Converts a tile id to a gid, negative ids become 0 (no tile) */
+    static uint32_t TileToGid(int32_t tile) { return tile < 0 ? 0 : static_cast<uint32_t>(tile) + 1; }
+
+    /** Decodes tile data straight into tile ids without any intermediate copies of the gids.
+      * @param text Contents of the data.
+      * @param encoding "csv" or "base64".
+      * @param compression "", "zlib" or "gzip".
+      * @param state Load state for converting gids.
+      * @param tiles Where to store the tile ids, must already be sized to the number of tiles expected.
+      */
+    static void DecodeData(const std::string& text, const std::string& encoding, const std::string& compression,
+                           LoadState& state, std::vector<int32_t>& tiles);
+    /** Encodes tile data in this handler's encoding.
+      * @param layer Data to encode.
+      * @return The text for the data, for Csv one row per line.
+      */
+    std::string EncodeData(const TiledLayerData& layer) const;
+    /** Name of the encoding to write in the file */
+    const char* GetEncodingName() const;
+    /** Name of the compression to write in the file, empty for none */
+    const char* GetCompressionName() const;
+
+    /** Sets the position and size of a chunk as read from the file and allocates its tiles.
+      * @throws const char* if the size is outside 1 to TiledLayerData::MAX_SIZE or the position is far enough from the origin to overflow when merged.
+      */
+    static void InitChunk(Chunk& chunk, double x, double y, double width, double height);
+    /** Combines the chunks of a layer into a single rectangle of tiles, tiles not covered by any chunk are -1.
+      * @param chunks Chunks to combine.
+      * @param data Where to store the combined tiles.
+      * @param x Set to the left of the rectangle in tiles.
+      * @param y Set to the top of the rectangle in tiles.
+      */
+    static void MergeChunks(const std::vector<Chunk>& chunks, TiledLayerData& data, int32_t& x, int32_t& y);
+    /** Moves merged tiles placed at tile (x, y) onto a layer starting at the origin, as collision layers have no position of their own.
+      * Tiles left of or above the origin are dropped and the uncovered tiles are -1.
+      * @param data Merged tiles to move.
+      * @param x Left of the tiles in tiles as returned by MergeChunks.
+      * @param y Top of the tiles in tiles as returned by MergeChunks.
+      */
+    static void MoveToOrigin(TiledLayerData& data, int32_t x, int32_t y);
+    /** Id to write as nextobjectid, objects are only written for a pixel based collision layer with ids starting at 1 */
+    static uint32_t NextObjectId(const Map& map);
+
+    /** Adds properties for the draw attributes with no Tiled equivalent that are not the defaults
+      * @param attr Attributes to write.
+      * @param properties Where to add the properties.
+      * @param default_depth Depth that is not written, layers default to 0 and backgrounds to -1.
+      */
+    static void WriteAttributeProperties(const DrawAttributes& attr, Properties& properties, int32_t default_depth = 0);
+    /** Reads the draw attributes stored by WriteAttributeProperties */
+    static void ReadAttributeProperties(const Properties& properties, DrawAttributes& attr);
+    /** Finds a property's value, returns def if not present */
+    static std::string GetProperty(const Properties& properties, const std::string& name, const std::string& def = "");
+
+    /** Formats a number independent of the current locale */
+    static std::string FormatNumber(double value);
+    /** Parses a number independent of the current locale, returns def if the text is not a number */
+    static double ParseNumber(const std::string& text, double def = 0);
+
+    /** Converts between Tiled's animation frame durations in milliseconds and AnimatedTile delays in frames */
+    static int32_t DurationToDelay(double duration);
+    static int32_t DelayToDuration(int32_t delay);
+
+    /** Version of the Tiled format written */
+    static const char* FORMAT_VERSION;
+
+    Encoding encoding;
+};
+
+#endif
@@ -0,0 +1,195 @@
+/******************************************************************************************************
+ * Tile Map Editor
+ * Copyright (C) 2009-2017 Brandon Whitehead (tricksterguy87[AT]gmail[DOT]com)
+ *
+ * This software is provided 'as-is', without any express or implied warranty.
+ * In no event will the authors be held liable for any damages arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * excluding commercial applications, and to alter it and redistribute it freely,
+ * subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented;
+ *    you must not claim that you wrote the original software.
+ *    An acknowledgement in your documentation and link to the original version is required.
+ *
+ * 2. Altered source versions must be plainly marked as such,
+ *    and must not be misrepresented as being the original software.
+ *
+ * 3. This notice may not be removed or altered from any source distribution.
+ ******************************************************************************************************/
+#include "TilesetCache.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+#include <tuple>
+#include <sys/stat.h>
+
+#include "HandlerUtils.hpp"
+#include "Logger.hpp"
+
+namespace
+{
+/** Modification time of a file or 0 if it can't be read */
+time_t ModificationTime(const std::string& filename)
+{
+    struct stat info;
+    if (stat(filename.c_str(), &info) != 0)
+        return 0;
+    return info.st_mtime;
+}
+}
+
+constexpr size_t TilesetCache::DEFAULT_CAPACITY;
+
+TilesetImage::TilesetImage(std::vector<uint8_t>& rgba, uint32_t _width, uint32_t _height, uint32_t _tile_width, uint32_t _tile_height) :
+    width(_width), height(_height), tile_width(_tile_width), tile_height(_tile_height), num_tiles(0)
+{
+    if (tile_width == 0 || tile_height == 0)
+        throw "Tile dimensions must be non-zero";
+
+    pixels.swap(rgba);
+    uint32_t columns = width / tile_width;
+    num_tiles = columns * (height / tile_height);
+    const uint32_t row_bytes = tile_width * 4;
+    tiles.resize(static_cast<size_t>(num_tiles) * row_bytes * tile_height);
+
+    uint8_t* dest = tiles.data();
+    for (uint32_t tile = 0; tile < num_tiles; tile++)
+    {
+        uint32_t x = tile % columns * tile_width;
+        uint32_t y = tile / columns * tile_height;
+        for (uint32_t row = 0; row < tile_height; row++, dest += row_bytes)
+            memcpy(dest, &pixels[(static_cast<size_t>(y + row) * width + x) * 4], row_bytes);
+    }
+
+    // The tiles hold every pixel, don't keep a second copy.
+    if (width % tile_width == 0 && height % tile_height == 0)
+        std::vector<uint8_t>().swap(pixels);
+}
+
+void TilesetImage::GetPixels(std::vector<uint8_t>& rgba) const
+{
+    if (!pixels.empty())
+    {
+        rgba = pixels;
+        return;
+    }
+
+    rgba.resize(static_cast<size_t>(width) * height * 4);
+    uint32_t columns = width / tile_width;
+    const uint32_t row_bytes = tile_width * 4;
+    const uint8_t* src = tiles.data();
+    for (uint32_t tile = 0; tile < num_tiles; tile++)
+    {
+        uint32_t x = tile % columns * tile_width;
+        uint32_t y = tile / columns * tile_height;
+        for (uint32_t row = 0; row < tile_height; row++, src += row_bytes)
+            memcpy(&rgba[(static_cast<size_t>(y + row) * width + x) * 4], src, row_bytes);
+    }
+}
+
+bool TilesetCache::Key::operator<(const Key& other) const
+{
+    return std::tie(filename, tile_width, tile_height) < std::tie(other.filename, other.tile_width, other.tile_height);
+}
+
+TilesetCache::TilesetCache() : recent_size(0), capacity(DEFAULT_CAPACITY), loader(&HandlerUtils::LoadImage), num_loads(0)
+{
+}
+
+std::shared_ptr<const TilesetImage> TilesetCache::Get(const std::string& filename, uint32_t tile_width, uint32_t tile_height)
+{
+    const Key key = {filename, tile_width, tile_height};
+    time_t modified = ModificationTime(filename);
+    Loader load;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto found = entries.find(key);
+        if (found != entries.end() && found->second.modified == modified)
+        {
+            std::shared_ptr<const TilesetImage> image = found->second.image.lock();
+            if (image)
+            {
+                Touch(image);
+                return image;
+            }
+        }
+        load = loader;
+    }
+
+    // Decoding is done without holding the lock so other tilesets can be loaded at the same time.
+    std::vector<uint8_t> rgba;
+    uint32_t width, height;
+    if (load(filename, rgba, width, height))
+    {
+        WarnLog("Could not load tileset image %s", filename.c_str());
+        return nullptr;
+    }
+    std::shared_ptr<const TilesetImage> image = std::make_shared<TilesetImage>(rgba, width, height, tile_width, tile_height);
+
+    std::lock_guard<std::mutex> lock(mutex);
+    num_loads++;
+    for (auto it = entries.begin(); it != entries.end();)
+        it = it->second.image.expired() ? entries.erase(it) : std::next(it);
+    Entry& entry = entries[key];
+    // Another thread may have loaded it in the meantime, hand out the same image.
+    std::shared_ptr<const TilesetImage> cached = entry.image.lock();
+    if (cached && entry.modified == modified)
+    {
+        Touch(cached);
+        return cached;
+    }
+    entry.modified = modified;
+    entry.image = image;
+    Touch(image);
+    return image;
+}
+
+void TilesetCache::Clear()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    entries.clear();
+    recent.clear();
+    recent_size = 0;
+}
+
+void TilesetCache::SetCapacity(size_t bytes)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    capacity = bytes;
+    Touch(nullptr);
+}
+
+void TilesetCache::Touch(const std::shared_ptr<const TilesetImage>& image)
+{
+    if (image)
+    {
+        auto found = std::find(recent.begin(), recent.end(), image);
+        if (found != recent.end())
+        {
+            recent.splice(recent.begin(), recent, found);
+        }
+        else
+        {
+            recent.push_front(image);
+            recent_size += image->GetSize();
+        }
+    }
+
+    while (recent_size > capacity)
+    {
+        recent_size -= recent.back()->GetSize();
+        recent.pop_back();
+    }
+}
+
+void TilesetCache::SetLoader(const Loader& _loader)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    loader = _loader;
+    entries.clear();
+    recent.clear();
+    recent_size = 0;
+}
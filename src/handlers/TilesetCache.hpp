@@ -0,0 +1,139 @@
+/******************************************************************************************************
+ * Tile Map Editor
+ * Copyright (C) 2009-2017 Brandon Whitehead (tricksterguy87[AT]gmail[DOT]com)
+ *
+ * This software is provided 'as-is', without any express or implied warranty.
+ * In no event will the authors be held liable for any damages arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * excluding commercial applications, and to alter it and redistribute it freely,
+ * subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented;
+ *    you must not claim that you wrote the original software.
+ *    An acknowledgement in your documentation and link to the original version is required.
+ *
+ * 2. Altered source versions must be plainly marked as such,
+ *    and must not be misrepresented as being the original software.
+ *
+ * 3. This notice may not be removed or altered from any source distribution.
+ ******************************************************************************************************/
+#ifndef TILESET_CACHE_HPP
+#define TILESET_CACHE_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <ctime>
+#include <functional>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/** A decoded tileset image and its tiles, shared through TilesetCache. */
+class TilesetImage
+{
+public:
+    /** Cuts an image into tiles, partial tiles at the edges are ignored.
+      * @param rgba Pixels as 4 bytes (red, green, blue, alpha) each, the contents are taken.
+      * @param width Width of the image in pixels.
+      * @param height Height of the image in pixels.
+      * @param tile_width Width of a tile in pixels.
+      * @param tile_height Height of a tile in pixels.
+      */
+    TilesetImage(std::vector<uint8_t>& rgba, uint32_t width, uint32_t height, uint32_t tile_width, uint32_t tile_height);
+
+    /** Copies the pixels of the whole image, 4 bytes (red, green, blue, alpha) each.
+      * Only the tiles are kept when they cover the image, so this rebuilds the image from them.
+      */
+    void GetPixels(std::vector<uint8_t>& rgba) const;
+    uint32_t GetWidth() const { return width; }
+    uint32_t GetHeight() const { return height; }
+    void GetTileDimensions(uint32_t& _tile_width, uint32_t& _tile_height) const { _tile_width = tile_width; _tile_height = tile_height; }
+    uint32_t GetNumTiles() const { return num_tiles; }
+    /** @return Pixels of a tile, tile_width * tile_height * 4 bytes row by row */
+    const uint8_t* GetTile(uint32_t tile) const { return &tiles[static_cast<size_t>(tile) * tile_width * tile_height * 4]; }
+    /** @return Bytes of pixels held */
+    size_t GetSize() const { return pixels.size() + tiles.size(); }
+
+private:
+    /** Pixels of the whole image, empty if the tiles cover all of it */
+    std::vector<uint8_t> pixels;
+    uint32_t width, height;
+    uint32_t tile_width, tile_height;
+    uint32_t num_tiles;
+    /** Pixels of each tile one after the other */
+    std::vector<uint8_t> tiles;
+};
+
+/** Process wide cache of decoded tileset images.
+  * Images are keyed by path, modification time and tile dimensions and are kept while something holds on to them,
+  * so maps and exporters sharing a tileset decode it once and an edited image is reloaded. The most recently used
+  * images are also kept up to a size limit, so converting maps one after another decodes their tileset once.
+  * Safe to use from multiple threads.
+  */
+class TilesetCache {
+public:
+    /** Default bytes of recently used images kept when nothing holds on to them */
+    static constexpr size_t DEFAULT_CAPACITY = 64 * 1024 * 1024;
+
+    static TilesetCache& Instance() {
+        static TilesetCache singleton;
+        return singleton;
+    }
+
+    /** Decodes an image, see HandlerUtils::LoadImage for the parameters. Returns nonzero on failure. */
+    typedef std::function<int(const std::string& filename, std::vector<uint8_t>& rgba, uint32_t& width, uint32_t& height)> Loader;
+
+    /** Gets a tileset image, decoding it if it is not cached or the file changed since it was.
+      * @param filename Path to the image.
+      * @param tile_width Width of a tile in pixels.
+      * @param tile_height Height of a tile in pixels.
+      * @return The image or nullptr if it could not be loaded.
+      */
+    std::shared_ptr<const TilesetImage> Get(const std::string& filename, uint32_t tile_width, uint32_t tile_height);
+    /** Forgets all cached images, images still in use stay valid. */
+    void Clear();
+    /** Sets how many bytes of recently used images are kept when nothing holds on to them, 0 only keeps images in use. */
+    void SetCapacity(size_t bytes);
+    /** Replaces how images are decoded, by default HandlerUtils::LoadImage. */
+    void SetLoader(const Loader& _loader);
+    /** @return Number of images decoded so far */
+    uint64_t GetNumLoads() const { return num_loads; }
+
+private:
+    struct Key
+    {
+        std::string filename;
+        uint32_t tile_width, tile_height;
+        bool operator<(const Key& other) const;
+    };
+    struct Entry
+    {
+        time_t modified;
+        std::weak_ptr<const TilesetImage> image;
+    };
+
+    /** Marks an image as the most recently used and drops the least recently used over capacity, the lock must be held. */
+    void Touch(const std::shared_ptr<const TilesetImage>& image);
+
+    std::mutex mutex;
+    std::map<Key, Entry> entries;
+    /** Most recently used images first */
+    std::list<std::shared_ptr<const TilesetImage>> recent;
+    size_t recent_size;
+    size_t capacity;
+    Loader loader;
+    std::atomic<uint64_t> num_loads;
+    TilesetCache();
+    TilesetCache(const TilesetCache&);             // Prevent copy-construction
+    TilesetCache& operator=(const TilesetCache&);  // Prevent assignment
+};
+
+inline TilesetCache& TilesetCache() {
+    return TilesetCache::Instance();
+}
+
+#endif
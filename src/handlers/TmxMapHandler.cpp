@@ -0,0 +1,515 @@
+/******************************************************************************************************
+ * Tile Map Editor
+ * Copyright (C) 2009-2017 Brandon Whitehead (tricksterguy87[AT]gmail[DOT]com)
+ *
+ * This software is provided 'as-is', without any express or implied warranty.
+ * In no event will the authors be held liable for any damages arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * excluding commercial applications, and to alter it and redistribute it freely,
+ * subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented;
+ *    you must not claim that you wrote the original software.
+ *    An acknowledgement in your documentation and link to the original version is required.
+ *
+ * 2. Altered source versions must be plainly marked as such,
+ *    and must not be misrepresented as being the original software.
+ *
+ * 3. This notice may not be removed or altered from any source distribution.
+ ******************************************************************************************************/
+#include "TmxMapHandler.hpp"
+
+#include <cmath>
+#include <wx/string.h>
+#include <wx/xml/xml.h>
+
+#include "DirectionBasedCollisionLayer.hpp"
+#include "Logger.hpp"
+#include "PixelBasedCollisionLayer.hpp"
+#include "StreamAdapters.hpp"
+#include "TileBasedCollisionLayer.hpp"
+
+namespace
+{
+
+std::string GetAttribute(wxXmlNode* node, const char* name, const std::string& def = "")
+{
+    return node->GetAttribute(name, def).ToStdString();
+}
+
+wxXmlNode* AddElement(wxXmlNode* parent, const char* name)
+{
+    wxXmlNode* node = new wxXmlNode(wxXML_ELEMENT_NODE, name);
+    if (parent)
+        parent->AddChild(node);
+    return node;
+}
+
+wxXmlNode* FindChild(wxXmlNode* node, const char* name)
+{
+    for (wxXmlNode* child = node->GetChildren(); child; child = child->GetNext())
+    {
+        if (child->GetName() == name)
+            return child;
+    }
+    return NULL;
+}
+
+}
+
+TmxMapHandler::TmxMapHandler(Encoding encoding)
+    : TiledMapHandler("Tiled TMX Format", "tmx", "Tiled map editor xml format", encoding)
+{
+}
+
+bool TmxMapHandler::Sniff(const std::string& header) const
+{
+    std::string::size_type start = header.compare(0, 3, "\xEF\xBB\xBF") == 0 ? 3 : 0;
+    start = header.find_first_not_of(" \t\r\n", start);
+    if (start == std::string::npos || header.compare(start, 5, "<?xml") != 0)
+        return false;
+
+    std::string::size_type root = header.find("<map", start + 5);
+    return root != std::string::npos && (root + 4 == header.size() || std::string(" \t\r\n>").find(header[root + 4]) != std::string::npos);
+}
+
+void TmxMapHandler::Load(std::istream& file, Map& map)
+{
+    EventLog l(__func__);
+
+    wxXmlDocument doc;
+    wxFInputStream fis(file);
+    if (!doc.Load(dynamic_cast<wxInputStream&>(fis)))
+        throw "Could not open TMX file";
+
+    wxXmlNode* root = doc.GetRoot();
+    if (root == NULL || root->GetName() != "map")
+        throw "map must be the root node in a TMX file";
+
+    if (GetAttribute(root, "orientation", "orthogonal") != "orthogonal")
+        WarnLog("Only orthogonal maps are supported, map will be loaded as orthogonal");
+
+    LoadState state;
+    state.tile_width = ParseNumber(GetAttribute(root, "tilewidth"), state.tile_width);
+    state.tile_height = ParseNumber(GetAttribute(root, "tileheight"), state.tile_height);
+    map.SetTileset(Tileset("", state.tile_width, state.tile_height));
+
+    bool read_tileset = false;
+    for (wxXmlNode* child = root->GetChildren(); child; child = child->GetNext())
+    {
+        std::string name = child->GetName().ToStdString();
+        VerboseLog("%s Got node %s", __func__, name.c_str());
+        if (name == "properties")
+        {
+            Properties properties;
+            ReadProperties(root, properties);
+            map.SetName(GetProperty(properties, "name"));
+        }
+        else if (name == "tileset")
+        {
+            if (read_tileset)
+                WarnLog("Only the first tileset is used, tile ids of later tilesets are relative to the first");
+            else
+                ReadTileset(child, state, map);
+            read_tileset = true;
+        }
+        else if (name == "layer" || name == "imagelayer" || name == "objectgroup" || name == "group")
+        {
+            ReadLayer(child, state, map, 0, 0, 1.0f);
+        }
+    }
+}
+
+void TmxMapHandler::ReadTileset(wxXmlNode* node, LoadState& state, Map& map)
+{
+    state.first_gid = std::max(1.0, ParseNumber(GetAttribute(node, "firstgid"), 1));
+
+    if (node->HasAttribute("source"))
+    {
+        // External tilesets (.tsx) would have to be loaded relative to the map, keep the reference.
+        WarnLog("External tileset %s is not loaded, using it as the tileset image", GetAttribute(node, "source").c_str());
+        map.SetTileset(Tileset(GetAttribute(node, "source"), state.tile_width, state.tile_height));
+        return;
+    }
+
+    uint32_t tile_width = ParseNumber(GetAttribute(node, "tilewidth"), state.tile_width);
+    uint32_t tile_height = ParseNumber(GetAttribute(node, "tileheight"), state.tile_height);
+    wxXmlNode* image = FindChild(node, "image");
+    Tileset tileset(image ? GetAttribute(image, "source") : "", tile_width, tile_height);
+
+    for (wxXmlNode* tile = node->GetChildren(); tile; tile = tile->GetNext())
+    {
+        wxXmlNode* animation = tile->GetName() == "tile" ? FindChild(tile, "animation") : NULL;
+        if (!animation)
+            continue;
+
+        std::vector<int32_t> frames;
+        double duration = 0;
+        for (wxXmlNode* frame = animation->GetChildren(); frame; frame = frame->GetNext())
+        {
+            if (frame->GetName() != "frame")
+                continue;
+            frames.push_back(ParseNumber(GetAttribute(frame, "tileid")));
+            duration = ParseNumber(GetAttribute(frame, "duration"), duration);
+        }
+
+        // Tiled allows a duration per frame, only the last is kept.
+        if (!frames.empty())
+            tileset.Add(AnimatedTile("Tile " + GetAttribute(tile, "id"), DurationToDelay(duration), AnimatedTile::Normal, -1, frames));
+    }
+
+    map.SetTileset(tileset);
+}
+
+void TmxMapHandler::ReadLayer(wxXmlNode* node, LoadState& state, Map& map, int32_t offset_x, int32_t offset_y, float opacity)
+{
+    std::string type = node->GetName().ToStdString();
+    std::string name = GetAttribute(node, "name");
+    offset_x += std::lround(ParseNumber(GetAttribute(node, "offsetx")));
+    offset_y += std::lround(ParseNumber(GetAttribute(node, "offsety")));
+    opacity *= ParseNumber(GetAttribute(node, "opacity"), 1);
+
+    Properties properties;
+    ReadProperties(node, properties);
+    std::string collision = GetProperty(properties, "collision");
+
+    if (type == "group")
+    {
+        for (wxXmlNode* child = node->GetChildren(); child; child = child->GetNext())
+            ReadLayer(child, state, map, offset_x, offset_y, opacity);
+        return;
+    }
+
+    DrawAttributes attr(0);
+    ReadAttributeProperties(properties, attr);
+    attr.SetPosition(offset_x, offset_y);
+    attr.SetOpacity(opacity * 100);
+
+    if (type == "layer")
+    {
+        wxXmlNode* data = FindChild(node, "data");
+        if (!data)
+            throw "Tile layer is missing its data";
+
+        std::vector<Chunk> chunks;
+        ReadData(data, state, ParseNumber(GetAttribute(node, "width")), ParseNumber(GetAttribute(node, "height")), chunks);
+
+        TiledLayerData tiles;
+        int32_t x, y;
+        MergeChunks(chunks, tiles, x, y);
+
+        if (collision == "tile" || collision == "direction")
+            MoveToOrigin(tiles, x, y);
+        if (collision == "tile")
+        {
+            map.SetCollisionLayer(new TileBasedCollisionLayer(tiles.GetWidth(), tiles.GetHeight(), tiles.GetData()));
+            return;
+        }
+        if (collision == "direction")
+        {
+            map.SetCollisionLayer(new DirectionBasedCollisionLayer(tiles.GetWidth(), tiles.GetHeight(), tiles.GetData()));
+            return;
+        }
+
+        attr.SetPosition(offset_x + x * static_cast<int32_t>(state.tile_width), offset_y + y * static_cast<int32_t>(state.tile_height));
+        map.Add(Layer(name, tiles.GetWidth(), tiles.GetHeight(), tiles.GetData(), attr));
+    }
+    else if (type == "imagelayer")
+    {
+        wxXmlNode* image = FindChild(node, "image");
+        uint32_t mode = GetAttribute(node, "repeatx") == "1" || GetAttribute(node, "repeaty") == "1" ? Background::Repeating : Background::Once;
+
+        DrawAttributes back_attr(-1);
+        ReadAttributeProperties(properties, back_attr);
+        back_attr.SetPosition(offset_x, offset_y);
+        back_attr.SetOpacity(opacity * 100);
+        map.Add(Background(name, image ? GetAttribute(image, "source") : "", ParseNumber(GetProperty(properties, "mode"), mode),
+                           ParseNumber(GetProperty(properties, "speed_x")), ParseNumber(GetProperty(properties, "speed_y")), back_attr));
+    }
+    else if (type == "objectgroup")
+    {
+        if (collision != "pixel")
+        {
+            VerboseLog("Skipping object group %s", name.c_str());
+            return;
+        }
+
+        std::vector<Rectangle> rectangles;
+        for (wxXmlNode* object = node->GetChildren(); object; object = object->GetNext())
+        {
+            if (object->GetName() != "object")
+                continue;
+            Rectangle rectangle(std::lround(ParseNumber(GetAttribute(object, "x"))) + offset_x, std::lround(ParseNumber(GetAttribute(object, "y"))) + offset_y,
+                                std::lround(ParseNumber(GetAttribute(object, "width"))), std::lround(ParseNumber(GetAttribute(object, "height"))));
+            // Points, polygons and polylines have no size.
+            if (rectangle.IsValid())
+                rectangles.push_back(rectangle);
+        }
+        map.SetCollisionLayer(new PixelBasedCollisionLayer(rectangles));
+    }
+}
+
+void TmxMapHandler::ReadData(wxXmlNode* node, LoadState& state, double width, double height, std::vector<Chunk>& chunks)
+{
+    std::string encoding = GetAttribute(node, "encoding");
+    std::string compression = GetAttribute(node, "compression");
+
+    if (FindChild(node, "chunk"))
+    {
+        for (wxXmlNode* child = node->GetChildren(); child; child = child->GetNext())
+        {
+            if (child->GetName() != "chunk")
+                continue;
+
+            chunks.emplace_back();
+            Chunk& chunk = chunks.back();
+            InitChunk(chunk, ParseNumber(GetAttribute(child, "x")), ParseNumber(GetAttribute(child, "y")),
+                      ParseNumber(GetAttribute(child, "width")), ParseNumber(GetAttribute(child, "height")));
+            DecodeData(child->GetNodeContent().ToStdString(), encoding, compression, state, chunk.tiles);
+        }
+        return;
+    }
+
+    chunks.emplace_back();
+    Chunk& chunk = chunks.back();
+    InitChunk(chunk, 0, 0, width, height);
+
+    if (!encoding.empty())
+    {
+        DecodeData(node->GetNodeContent().ToStdString(), encoding, compression, state, chunk.tiles);
+        return;
+    }
+
+    // Deprecated unencoded format with a tile element per tile.
+    uint32_t count = 0;
+    for (wxXmlNode* tile = node->GetChildren(); tile; tile = tile->GetNext())
+    {
+        if (tile->GetName() != "tile")
+            continue;
+        if (count >= chunk.tiles.size())
+            throw "Tile data size does not match layer dimensions";
+        chunk.tiles[count++] = GidToTile(ParseNumber(GetAttribute(tile, "gid")), state);
+    }
+    if (count != chunk.tiles.size())
+        throw "Tile data size does not match layer dimensions";
+}
+
+void TmxMapHandler::ReadProperties(wxXmlNode* node, Properties& properties)
+{
+    wxXmlNode* list = FindChild(node, "properties");
+    if (!list)
+        return;
+
+    for (wxXmlNode* property = list->GetChildren(); property; property = property->GetNext())
+    {
+        if (property->GetName() != "property")
+            continue;
+        // Multiline string values are stored as the element's text.
+        std::string value = property->HasAttribute("value") ? GetAttribute(property, "value") : property->GetNodeContent().ToStdString();
+        properties.push_back({GetAttribute(property, "name"), GetAttribute(property, "type", "string"), value});
+    }
+}
+
+void TmxMapHandler::WriteProperties(wxXmlNode* node, const Properties& properties)
+{
+    if (properties.empty())
+        return;
+
+    wxXmlNode* list = AddElement(node, "properties");
+    for (const auto& property : properties)
+    {
+        wxXmlNode* element = AddElement(list, "property");
+        element->AddAttribute("name", property.name);
+        if (property.type != "string")
+            element->AddAttribute("type", property.type);
+        element->AddAttribute("value", property.value);
+    }
+}
+
+void TmxMapHandler::Save(std::ostream& file, const Map& map)
+{
+    EventLog l(__func__);
+
+    uint32_t tile_width, tile_height;
+    map.GetTileset().GetTileDimensions(tile_width, tile_height);
+    uint32_t num_layers = map.GetNumBackgrounds() + map.GetNumLayers() + (map.HasCollisionLayer() ? 1 : 0);
+
+    wxXmlNode* root = AddElement(NULL, "map");
+    root->AddAttribute("version", FORMAT_VERSION);
+    root->AddAttribute("orientation", "orthogonal");
+    root->AddAttribute("renderorder", "right-down");
+    root->AddAttribute("width", FormatNumber(std::max(map.GetWidth(), 1u)));
+    root->AddAttribute("height", FormatNumber(std::max(map.GetHeight(), 1u)));
+    root->AddAttribute("tilewidth", FormatNumber(tile_width));
+    root->AddAttribute("tileheight", FormatNumber(tile_height));
+    root->AddAttribute("infinite", "0");
+    root->AddAttribute("nextlayerid", FormatNumber(num_layers + 1));
+    root->AddAttribute("nextobjectid", FormatNumber(NextObjectId(map)));
+
+    if (!map.GetName().empty())
+        WriteProperties(root, {{"name", "string", map.GetName()}});
+
+    WriteTileset(root, map);
+
+    // Backgrounds are drawn behind the layers and Tiled draws in document order.
+    uint32_t id = 1;
+    for (const auto& background : map.GetBackgrounds())
+        WriteBackground(root, id++, background);
+    for (const auto& layer : map.GetLayers())
+        WriteLayer(root, id++, layer.GetName(), layer, layer, Properties());
+    if (map.HasCollisionLayer())
+        WriteCollision(root, id++, map);
+
+    wxXmlDocument doc;
+    doc.SetRoot(root);
+    wxFOutputStream fos(file);
+    if (!doc.Save(dynamic_cast<wxOutputStream&>(fos)))
+        throw "Could not save TMX file";
+}
+
+void TmxMapHandler::WriteTileset(wxXmlNode* root, const Map& map)
+{
+    const Tileset& tileset = map.GetTileset();
+    uint32_t tile_width, tile_height;
+    tileset.GetTileDimensions(tile_width, tile_height);
+
+    std::string name = tileset.GetFilename();
+    std::string::size_type slash = name.find_last_of("/\\");
+    if (slash != std::string::npos)
+        name = name.substr(slash + 1);
+    name = name.substr(0, name.rfind('.'));
+
+    wxXmlNode* node = AddElement(root, "tileset");
+    node->AddAttribute("firstgid", "1");
+    node->AddAttribute("name", name);
+    node->AddAttribute("tilewidth", FormatNumber(tile_width));
+    node->AddAttribute("tileheight", FormatNumber(tile_height));
+
+    wxXmlNode* image = AddElement(node, "image");
+    image->AddAttribute("source", tileset.GetFilename());
+
+    // Tiled attaches animations to a tile, use the first frame's tile.
+    std::set<int32_t> animated;
+    for (const auto& animation : tileset.GetAnimatedTiles())
+    {
+        if (animation.GetFrames().empty() || !animated.insert(animation.GetFrames()[0]).second)
+        {
+            WarnLog("Skipping animation %s Tiled can only have one animation per tile", animation.GetName().c_str());
+            continue;
+        }
+
+        wxXmlNode* tile = AddElement(node, "tile");
+        tile->AddAttribute("id", FormatNumber(animation.GetFrames()[0]));
+        wxXmlNode* frames = AddElement(tile, "animation");
+        for (const auto frame_id : animation.GetFrames())
+        {
+            wxXmlNode* frame = AddElement(frames, "frame");
+            frame->AddAttribute("tileid", FormatNumber(frame_id));
+            frame->AddAttribute("duration", FormatNumber(DelayToDuration(animation.GetDelay())));
+        }
+    }
+}
+
+void TmxMapHandler::WriteLayer(wxXmlNode* root, uint32_t id, const std::string& name, const TiledLayerData& layer,
+                               const DrawAttributes& attr, const Properties& extra)
+{
+    int32_t x, y;
+    attr.GetPosition(x, y);
+
+    wxXmlNode* node = AddElement(root, "layer");
+    node->AddAttribute("id", FormatNumber(id));
+    node->AddAttribute("name", name);
+    node->AddAttribute("width", FormatNumber(layer.GetWidth()));
+    node->AddAttribute("height", FormatNumber(layer.GetHeight()));
+    if (attr.GetOpacity() != 100)
+        node->AddAttribute("opacity", FormatNumber(attr.GetOpacity() / 100));
+    if (x != 0)
+        node->AddAttribute("offsetx", FormatNumber(x));
+    if (y != 0)
+        node->AddAttribute("offsety", FormatNumber(y));
+
+    Properties properties = extra;
+    WriteAttributeProperties(attr, properties);
+    WriteProperties(node, properties);
+
+    wxXmlNode* data = AddElement(node, "data");
+    data->AddAttribute("encoding", GetEncodingName());
+    if (*GetCompressionName())
+        data->AddAttribute("compression", GetCompressionName());
+    data->AddChild(new wxXmlNode(wxXML_TEXT_NODE, "", EncodeData(layer)));
+}
+
+void TmxMapHandler::WriteBackground(wxXmlNode* root, uint32_t id, const Background& background)
+{
+    int32_t x, y;
+    float speed_x, speed_y;
+    background.GetPosition(x, y);
+    background.GetSpeed(speed_x, speed_y);
+
+    wxXmlNode* node = AddElement(root, "imagelayer");
+    node->AddAttribute("id", FormatNumber(id));
+    node->AddAttribute("name", background.GetName());
+    if (background.GetOpacity() != 100)
+        node->AddAttribute("opacity", FormatNumber(background.GetOpacity() / 100));
+    if (x != 0)
+        node->AddAttribute("offsetx", FormatNumber(x));
+    if (y != 0)
+        node->AddAttribute("offsety", FormatNumber(y));
+    if (background.GetMode() & Background::Repeating)
+    {
+        node->AddAttribute("repeatx", "1");
+        node->AddAttribute("repeaty", "1");
+    }
+
+    Properties properties = {{"mode", "int", FormatNumber(background.GetMode())}};
+    if (speed_x != 0 || speed_y != 0)
+    {
+        properties.push_back({"speed_x", "float", FormatNumber(speed_x)});
+        properties.push_back({"speed_y", "float", FormatNumber(speed_y)});
+    }
+    WriteAttributeProperties(background, properties, -1);
+    WriteProperties(node, properties);
+
+    wxXmlNode* image = AddElement(node, "image");
+    image->AddAttribute("source", background.GetFilename());
+}
+
+void TmxMapHandler::WriteCollision(wxXmlNode* root, uint32_t id, const Map& map)
+{
+    CollisionLayer* layer = map.GetCollisionLayer();
+    switch (layer->GetType())
+    {
+        case CollisionLayer::TileBased:
+        case CollisionLayer::DirectionBased:
+        {
+            const char* type = layer->GetType() == CollisionLayer::TileBased ? "tile" : "direction";
+            DrawAttributes attr(0);
+            attr.SetOpacity(50);
+            WriteLayer(root, id, "Collision", dynamic_cast<TiledCollisionLayer*>(layer)->Unpack(), attr, {{"collision", "string", type}});
+            break;
+        }
+        case CollisionLayer::PixelBased:
+        {
+            wxXmlNode* node = AddElement(root, "objectgroup");
+            node->AddAttribute("id", FormatNumber(id));
+            node->AddAttribute("name", "Collision");
+            WriteProperties(node, {{"collision", "string", "pixel"}});
+
+            uint32_t object_id = 1;
+            for (const auto& rectangle : dynamic_cast<PixelBasedCollisionLayer*>(layer)->GetData().GetData())
+            {
+                wxXmlNode* object = AddElement(node, "object");
+                object->AddAttribute("id", FormatNumber(object_id++));
+                object->AddAttribute("x", FormatNumber(rectangle.x));
+                object->AddAttribute("y", FormatNumber(rectangle.y));
+                object->AddAttribute("width", FormatNumber(rectangle.width));
+                object->AddAttribute("height", FormatNumber(rectangle.height));
+            }
+            break;
+        }
+        default:
+            WarnLog("Unknown Collision Type %d ignoring", layer->GetType());
+            break;
+    }
+}
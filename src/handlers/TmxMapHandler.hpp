@@ -0,0 +1,57 @@
+/******************************************************************************************************
+ * Tile Map Editor
+ * Copyright (C) 2009-2017 Brandon Whitehead (tricksterguy87[AT]gmail[DOT]com)
+ *
+ * This software is provided 'as-is', without any express or implied warranty.
+ * In no event will the authors be held liable for any damages arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * excluding commercial applications, and to alter it and redistribute it freely,
+ * subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented;
+ *    you must not claim that you wrote the original software.
+ *    An acknowledgement in your documentation and link to the original version is required.
+ *
+ * 2. Altered source versions must be plainly marked as such,
+ *    and must not be misrepresented as being the original software.
+ *
+ * 3. This notice may not be removed or altered from any source distribution.
+ ******************************************************************************************************/
+#ifndef TMX_MAP_HANDLER_HPP
+#define TMX_MAP_HANDLER_HPP
+
+#include <wx/xml/xml.h>
+
+#include "TiledMapHandler.hpp"
+
+/** Handler for Tiled's xml based .tmx format
+  * @see TiledMapHandler for how maps are converted
+  */
+class TmxMapHandler : public TiledMapHandler {
+public:
+    /** Creates the handler
+      * @param encoding How tile data is written.
+      */
+    TmxMapHandler(Encoding encoding = Csv);
+    /** @see BaseMapHandler::Load */
+    virtual void Load(std::istream& file, Map& map);
+    /** @see BaseMapHandler::Save */
+    virtual void Save(std::ostream& file, const Map& map);
+    /** @see BaseMapHandler::Sniff */
+    virtual bool Sniff(const std::string& header) const;
+
+private:
+    static void ReadProperties(wxXmlNode* node, Properties& properties);
+    static void WriteProperties(wxXmlNode* node, const Properties& properties);
+    void ReadTileset(wxXmlNode* node, LoadState& state, Map& map);
+    void ReadLayer(wxXmlNode* node, LoadState& state, Map& map, int32_t offset_x, int32_t offset_y, float opacity);
+    void ReadData(wxXmlNode* node, LoadState& state, double width, double height, std::vector<Chunk>& chunks);
+    void WriteTileset(wxXmlNode* root, const Map& map);
+    void WriteLayer(wxXmlNode* root, uint32_t id, const std::string& name, const TiledLayerData& layer,
+                    const DrawAttributes& attr, const Properties& properties);
+    void WriteBackground(wxXmlNode* root, uint32_t id, const Background& background);
+    void WriteCollision(wxXmlNode* root, uint32_t id, const Map& map);
+};
+
+#endif
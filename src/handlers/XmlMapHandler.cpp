@@ -34,68 +34,48 @@
 #include <wx/wfstream.h>
 #include <wx/xml/xml.h>
 
+#include "Base64.hpp"
+#include "Compression.hpp"
 #include "TileBasedCollisionLayer.hpp"
 #include "Logger.hpp"
 #include "Scanner.hpp"
+#include "StreamAdapters.hpp"
 
-class wxFInputStream : public wxInputStream
+XmlMapHandler::XmlMapHandler(Encoding _encoding, Compression _compression)
+    : BaseMapHandler("Xml Format", "xml", "Exports the map as an xml file"), encoding(Decimal), compression(NoCompression)
 {
-public:
-    wxFInputStream(std::istream& _stream) : stream(_stream)
-    {
-    }
-
-protected:
-    size_t OnSysRead(void* buffer, size_t bufsize)
-    {
-        if (stream.bad())
-        {
-            m_lasterror = wxSTREAM_READ_ERROR;
-            return 0;
-        }
-        else if (stream.eof())
-        {
-            m_lasterror = wxSTREAM_EOF;
-            return 0;
-        }
-
-        stream.read(reinterpret_cast<char*>(buffer), bufsize);
-        return stream.gcount();
-    }
-
-private:
-    std::istream& stream;
-};
+    SetEncoding(_encoding, _compression);
+}
 
-class wxFOutputStream : public wxOutputStream
+void XmlMapHandler::SetEncoding(Encoding _encoding, Compression _compression)
 {
-public:
-    wxFOutputStream(std::ostream& _stream) : stream(_stream)
-    {
-    }
-
-protected:
-    size_t OnSysWrite(const void* buffer, size_t bufsize)
-    {
-        if (stream.bad())
-        {
-            m_lasterror = wxSTREAM_WRITE_ERROR;
-            return 0;
-        }
-
-        stream.write(reinterpret_cast<const char*>(buffer), bufsize);
-        return bufsize;
-    }
+    if (_encoding == Decimal && _compression != NoCompression)
+        throw "Compression requires the base64 encoding";
 
-private:
-    std::ostream& stream;
-};
+    encoding = _encoding;
+    compression = _compression;
+}
 
-XmlMapHandler::XmlMapHandler() : BaseMapHandler("Xml Format", "xml", "Exports the map as an xml file")
+bool XmlMapHandler::Sniff(const std::string& header) const
 {
+    // Skip any byte order mark and leading whitespace.
+    std::string::size_type start = header.compare(0, 3, "\xEF\xBB\xBF") == 0 ? 3 : 0;
+    start = header.find_first_not_of(" \t\r\n", start);
+    if (start == std::string::npos || header.compare(start, 5, "<?xml") != 0)
+        return false;
+
+    // Other formats are also xml so the root element must be Map.
+    std::string::size_type root = header.find("<Map", start + 5);
+    return root != std::string::npos && (root + 4 == header.size() || std::string(" \t\r\n>").find(header[root + 4]) != std::string::npos);
 }
 
 void XmlMapHandler::Load(std::istream& file, Map& map)
+{
+    MapBuilder builder(map);
+    Load(file, builder);
+}
+
+void XmlMapHandler::Load(std::istream& file, MapVisitor& visitor)
 {
     wxXmlDocument doc;
     wxFInputStream fis(file);
@@ -107,23 +87,25 @@ void XmlMapHandler::Load(std::istream& file, Map& map)
     if (child != NULL && child->GetName() != "Properties")
         throw "Properties must be the first node in the XML file";
 
-    ReadProperties(child, map);
+    ReadProperties(child, visitor);
     while ((child = child->GetNext()))
     {
         std::string name = child->GetName().ToStdString();
         VerboseLog("%s Got node %s", __func__, name.c_str());
 
         if (name == "Layer")
-            ReadLayer(child, map);
+            ReadLayer(child, visitor);
         else if (name == "Background")
-            ReadBackground(child, map);
+            ReadBackground(child, visitor);
         else if (name == "Collision")
-            ReadCollision(child, map);
+            ReadCollision(child, visitor);
         else if (name == "Animation")
-            ReadAnimation(child, map);
+            ReadAnimation(child, visitor);
         else
             throw "Unknown element found in file " + name;
     }
+
+    visitor.OnEnd();
 }
 
 void XmlMapHandler::Save(std::ostream& file, const Map& map)
@@ -152,7 +134,7 @@ void XmlMapHandler::Save(std::ostream& file, const Map& map)
     delete fos;
 }
 
-void XmlMapHandler::ReadProperties(wxXmlNode* root, Map& map)
+void XmlMapHandler::ReadProperties(wxXmlNode* root, MapVisitor& visitor)
 {
     VerboseLog("Reading Properties");
 
@@ -186,21 +168,22 @@ void XmlMapHandler::ReadProperties(wxXmlNode* root, Map& map)
         child = child->GetNext();
     }
 
-    map.SetName(name);
-    map.SetTileset(Tileset(tileset, tile_width, tile_height));
+    visitor.OnProperties(name, Tileset(tileset, tile_width, tile_height));
     VerboseLog("Done Reading Properties");
 }
 
-void XmlMapHandler::ReadLayer(wxXmlNode* root, Map& map)
+void XmlMapHandler::ReadLayer(wxXmlNode* root, MapVisitor& visitor)
 {
     VerboseLog("Reading a Layer");
 
     wxXmlNode* child = root->GetChildren();
     std::string name;
-    uint32_t width;
-    uint32_t height;
+    uint32_t width = 0;
+    uint32_t height = 0;
+    bool has_dimensions = false;
     DrawAttributes attr;
     std::vector<int32_t> data;
+    wxXmlNode* data_node = NULL;
 
     while (child)
     {
@@ -219,16 +202,12 @@ void XmlMapHandler::ReadLayer(wxXmlNode* root, Map& map)
                 throw "Could not parse width";
             if (!scanner.Next(height))
                 throw "Could not parse height";
+            has_dimensions = true;
         }
         else if (property == "Data")
         {
-            while (scanner.HasMoreTokens())
-            {
-                int32_t element;
-                if (!scanner.Next(element))
-                    throw "Could not parse data";
-                data.push_back(element);
-            }
+            // Decoded after the loop since compressed data needs the dimensions, which may come after it.
+            data_node = child;
         }
         else if (property == "Position")
         {
@@ -300,15 +279,22 @@ void XmlMapHandler::ReadLayer(wxXmlNode* root, Map& map)
         child = child->GetNext();
     }
 
-    if (data.size() != width * height)
+    if (!has_dimensions)
+        throw "Layer is missing its dimensions";
+    if (data_node)
+        ReadData(data_node, static_cast<size_t>(width) * height, data);
+    if (data.size() != static_cast<size_t>(width) * height)
         throw "Incorrect number of tile entries for layer";
 
-    map.Add(Layer(name, width, height, data, attr));
+    visitor.OnLayerBegin({name, width, height, attr});
+    if (height)
+        visitor.OnLayerRows(0, height, data.data());
+    visitor.OnLayerEnd();
 
     VerboseLog("Done Reading Layer");
 }
 
-void XmlMapHandler::ReadBackground(wxXmlNode* root, Map& map)
+void XmlMapHandler::ReadBackground(wxXmlNode* root, MapVisitor& visitor)
 {
     VerboseLog("Reading a background");
     wxXmlNode* child = root->GetChildren();
@@ -416,12 +402,12 @@ void XmlMapHandler::ReadBackground(wxXmlNode* root, Map& map)
         child = child->GetNext();
     }
 
-    map.Add(Background(name, filename, mode, speedx, speedy, attr));
+    visitor.OnBackground(Background(name, filename, mode, speedx, speedy, attr));
 
     VerboseLog("Done Reading a Background");
 }
 
-void XmlMapHandler::ReadAnimation(wxXmlNode* root, Map& map)
+void XmlMapHandler::ReadAnimation(wxXmlNode* root, MapVisitor& visitor)
 {
     VerboseLog("Reading an animation");
     wxXmlNode* child = root->GetChildren();
@@ -476,18 +462,20 @@ void XmlMapHandler::ReadAnimation(wxXmlNode* root, Map& map)
         child = child->GetNext();
     }
 
-    map.Add(AnimatedTile(name, delay, static_cast<AnimatedTile::Type>(type), times, frames));
+    visitor.OnAnimation(AnimatedTile(name, delay, static_cast<AnimatedTile::Type>(type), times, frames));
     VerboseLog("Done Reading an Animation");
 }
 
-void XmlMapHandler::ReadCollision(wxXmlNode* root, Map& map)
+void XmlMapHandler::ReadCollision(wxXmlNode* root, MapVisitor& visitor)
 {
     VerboseLog("Reading Collision Layer");
     wxXmlNode* child = root->GetChildren();
 
     int32_t type = -1;
     uint32_t width = 0, height = 0;
+    bool has_dimensions = false;
     std::vector<int32_t> data;
+    wxXmlNode* data_node = NULL;
 
     /// TODO this is correct for now when more types are implemented handle them
     while (child)
@@ -508,16 +496,12 @@ void XmlMapHandler::ReadCollision(wxXmlNode* root, Map& map)
                 throw "Could not parse width";
             if (!scanner.Next(height))
                 throw "Could not parse height";
+            has_dimensions = true;
         }
-        else if (child->GetName() == "Data")
+        else if (property == "Data")
         {
-            while (scanner.HasMoreTokens())
-            {
-                int32_t element;
-                if (!scanner.Next(element))
-                    throw "Could not parse data";
-                data.push_back(element);
-            }
+            // Decoded after the loop since compressed data needs the dimensions, which may come after it.
+            data_node = child;
         }
         else
         {
@@ -527,11 +511,20 @@ void XmlMapHandler::ReadCollision(wxXmlNode* root, Map& map)
         child = child->GetNext();
     }
 
-    if (data.size() != width * height)
+    if (!has_dimensions)
+        throw "Collision layer is missing its dimensions";
+    if (data_node)
+        ReadData(data_node, static_cast<size_t>(width) * height, data);
+    if (data.size() != static_cast<size_t>(width) * height)
         throw "Incorrect number of tile entries for collision layer";
 
-    TileBasedCollisionLayer* clayer = new TileBasedCollisionLayer(width, height, data);
-    map.SetCollisionLayer(clayer);
+    MapSource::CollisionInfo info;
+    info.type = type == CollisionLayer::DirectionBased ? CollisionLayer::DirectionBased : CollisionLayer::TileBased;
+    info.width = width;
+    info.height = height;
+    visitor.OnCollision(info);
+    if (height)
+        visitor.OnCollisionRows(0, height, data.data());
 
     VerboseLog("Done Reading Collision Layer");
 }
@@ -561,17 +554,7 @@ void XmlMapHandler::WriteLayer(wxXmlNode* root, const Map& map, const Layer& lay
     VerboseLog("Writing a Layer");
     wxXmlNode* node = new wxXmlNode(root, wxXML_ELEMENT_NODE, "Layer");
 
-    wxString layerdata = "\n";
-    for (unsigned int i = 0; i < layer.GetHeight(); i++)
-    {
-        layerdata << "\t\t\t";
-        for (unsigned int j = 0; j < layer.GetWidth(); j++)
-            layerdata << layer.At(j, i) << ", ";
-        layerdata << "\n";
-    }
-
-    wxXmlNode* data = new wxXmlNode(node, wxXML_ELEMENT_NODE, "Data");
-    new wxXmlNode(data, wxXML_TEXT_NODE, "", layerdata);
+    WriteData(node, layer);
 
     wxXmlNode* dimensions = new wxXmlNode(node, wxXML_ELEMENT_NODE, "Dimensions");
     new wxXmlNode(dimensions, wxXML_TEXT_NODE, "", wxString::Format("%i, %i", layer.GetWidth(), layer.GetHeight()));
@@ -639,25 +622,17 @@ void XmlMapHandler::WriteAnimation(wxXmlNode* root, const Map& map, const Animat
 void XmlMapHandler::WriteCollision(wxXmlNode* root, const Map& map)
 {
     VerboseLog("Writing Collision Layer");
-    TileBasedCollisionLayer* layer = dynamic_cast<TileBasedCollisionLayer*>(map.GetCollisionLayer());
+    const CollisionLayer* collision = map.GetCollisionLayer();
+    const TiledCollisionLayer* layer = dynamic_cast<const TiledCollisionLayer*>(collision);
     wxXmlNode* layern = new wxXmlNode(root, wxXML_ELEMENT_NODE, "Collision");
 
-    wxString layerdata = "\n";
-    for (unsigned int i = 0; i < layer->GetHeight(); i++)
-    {
-        layerdata << "\t\t\t";
-        for (unsigned int j = 0; j < layer->GetWidth(); j++) layerdata << layer->At(j, i) << ", ";
-        layerdata << "\n";
-    }
-
-    wxXmlNode* data = new wxXmlNode(layern, wxXML_ELEMENT_NODE, "Data");
-    new wxXmlNode(data, wxXML_TEXT_NODE, "", layerdata);
+    WriteData(layern, layer->Unpack());
 
     wxXmlNode* dimensions = new wxXmlNode(layern, wxXML_ELEMENT_NODE, "Dimensions");
     new wxXmlNode(dimensions, wxXML_TEXT_NODE, "", wxString::Format("%i, %i", layer->GetWidth(), layer->GetHeight()));
 
     wxXmlNode* type = new wxXmlNode(layern, wxXML_ELEMENT_NODE, "Type");
-    new wxXmlNode(type, wxXML_TEXT_NODE, "", wxString::Format("%i", layer->GetType()));
+    new wxXmlNode(type, wxXML_TEXT_NODE, "", wxString::Format("%i", collision->GetType()));
 
     VerboseLog("Done Writing Collision Layer");
 }
@@ -696,3 +671,96 @@ void XmlMapHandler::WriteAttributes(wxXmlNode* root, const DrawAttributes& attr)
 
     VerboseLog("Done Writing Attributes");
 }
+
+void XmlMapHandler::ReadData(wxXmlNode* node, size_t size, std::vector<int32_t>& data)
+{
+    std::string content = node->GetNodeContent().ToStdString();
+    std::string encoding_attr = node->GetAttribute("encoding", "").ToStdString();
+    std::string compression_attr = node->GetAttribute("compression", "").ToStdString();
+
+    if (encoding_attr.empty())
+    {
+        if (!compression_attr.empty())
+            throw "Compressed data must be base64 encoded";
+
+        Scanner scanner(content);
+        while (scanner.HasMoreTokens())
+        {
+            int32_t element;
+            if (!scanner.Next(element))
+                throw "Could not parse data";
+            data.push_back(element);
+        }
+        return;
+    }
+
+    if (encoding_attr != "base64")
+        throw "Unknown data encoding " + encoding_attr;
+
+    std::vector<uint8_t> bytes;
+    if (!Base64Decode(content, bytes))
+        throw "Could not decode base64 data";
+
+    if (compression_attr.empty())
+    {
+        if (!UnpackLittleEndian(bytes, data))
+            throw "Incorrect size for base64 data";
+    }
+    else if (compression_attr == "rle")
+    {
+        if (!RleDecode(bytes, size, data))
+            throw "Could not decompress rle data";
+    }
+    else if (compression_attr == "lz")
+    {
+        std::vector<uint8_t> decompressed;
+        if (!LzDecompress(bytes, size * sizeof(int32_t), decompressed) || !UnpackLittleEndian(decompressed, data))
+            throw "Could not decompress lz data";
+    }
+    else
+    {
+        throw "Unknown data compression " + compression_attr;
+    }
+}
+
+void XmlMapHandler::WriteData(wxXmlNode* root, const TiledLayerData& layer)
+{
+    wxXmlNode* data = new wxXmlNode(root, wxXML_ELEMENT_NODE, "Data");
+
+    if (encoding == Decimal)
+    {
+        wxString layerdata = "\n";
+        for (unsigned int i = 0; i < layer.GetHeight(); i++)
+        {
+            layerdata << "\t\t\t";
+            for (unsigned int j = 0; j < layer.GetWidth(); j++)
+                layerdata << layer.At(j, i) << ", ";
+            layerdata << "\n";
+        }
+        new wxXmlNode(data, wxXML_TEXT_NODE, "", layerdata);
+        return;
+    }
+
+    std::vector<uint8_t> bytes;
+    switch (compression)
+    {
+        case RleCompression:
+            RleEncode(layer.GetData(), bytes);
+            data->AddAttribute("compression", "rle");
+            break;
+        case LzCompression:
+        {
+            std::vector<uint8_t> raw;
+            PackLittleEndian(layer.GetData(), raw);
+            LzCompress(raw, bytes);
+            data->AddAttribute("compression", "lz");
+            break;
+        }
+        default:
+            PackLittleEndian(layer.GetData(), bytes);
+            break;
+    }
+    data->AddAttribute("encoding", "base64");
+
+    new wxXmlNode(data, wxXML_TEXT_NODE, "", "\n\t\t\t" + Base64Encode(bytes.data(), bytes.size()) + "\n");
+}
@@ -28,24 +28,62 @@
 /** Saves the map as an xml file see documentation for format */
 class XmlMapHandler : public BaseMapHandler {
 public:
-    XmlMapHandler();
+    /** Controls how the Data of layers and collision layers is written.
+      * The encoding used is stored as an attribute on the Data element so any encoding can be read back.
+      */
+    enum Encoding
+    {
+        /** Whitespace separated decimal numbers (default) */
+        Decimal = 0,
+        /** Little endian 32 bit ints encoded as base64 */
+        Base64 = 1,
+    };
+    /** Compression applied to the data before base64 encoding it */
+    enum Compression
+    {
+        NoCompression = 0,
+        /** Run length encoded (run length, value) pairs */
+        RleCompression = 1,
+        /** LZ77 compressed @see LzCompress */
+        LzCompression = 2,
+    };
+
+    /** Creates the handler
+      * @param encoding How Data elements are written.
+      * @param compression How Data elements are compressed, only allowed with the Base64 encoding.
+      */
+    XmlMapHandler(Encoding encoding = Decimal, Compression compression = NoCompression);
     /** @see BaseMapHandler::Load */
     virtual void Load(std::istream& file, Map& map);
+    /** @see BaseMapHandler::Load, the whole document is parsed before anything is passed to the visitor */
+    virtual void Load(std::istream& file, MapVisitor& visitor);
     /** @see BaseMapHandler::Save */
     virtual void Save(std::ostream& file, const Map& map);
+    /** @see BaseMapHandler::Sniff */
+    virtual bool Sniff(const std::string& header) const;
+
+    Encoding GetEncoding() const { return encoding; }
+    Compression GetCompression() const { return compression; }
+    void SetEncoding(Encoding _encoding, Compression _compression = NoCompression);
 
 private:
-    void ReadProperties(wxXmlNode* root, Map& map);
-    void ReadLayer(wxXmlNode* root, Map& map);
-    void ReadBackground(wxXmlNode* root, Map& map);
-    void ReadAnimation(wxXmlNode* root, Map& map);
-    void ReadCollision(wxXmlNode* root, Map& map);
+    void ReadProperties(wxXmlNode* root, MapVisitor& visitor);
+    void ReadLayer(wxXmlNode* root, MapVisitor& visitor);
+    void ReadBackground(wxXmlNode* root, MapVisitor& visitor);
+    void ReadAnimation(wxXmlNode* root, MapVisitor& visitor);
+    void ReadCollision(wxXmlNode* root, MapVisitor& visitor);
     void WriteProperties(wxXmlNode* root, const Map& map);
     void WriteLayer(wxXmlNode* root, const Map& map, const Layer& layer);
     void WriteBackground(wxXmlNode* root, const Map& map, const Background& background);
     void WriteAnimation(wxXmlNode* root, const Map& map, const AnimatedTile& animatedTile);
     void WriteCollision(wxXmlNode* root, const Map& map);
     void WriteAttributes(wxXmlNode* root, const DrawAttributes& attr);
+    /** Reads a Data element, size is the number of tiles given by the Dimensions */
+    void ReadData(wxXmlNode* node, size_t size, std::vector<int32_t>& data);
+    void WriteData(wxXmlNode* root, const TiledLayerData& layer);
+
+    Encoding encoding;
+    Compression compression;
 };
 
 #endif
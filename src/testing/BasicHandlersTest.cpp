@@ -81,3 +81,38 @@ BOOST_AUTO_TEST_CASE(TestLoadFail)
 
     BOOST_CHECK_THROW(MapHandlerManager().Load("testout3.ZZYNAS", map), const char*);
 }
+
+BOOST_AUTO_TEST_CASE(TestFindHandlerByContent)
+{
+    std::string binary_header("HEAD\0\0\0\x10\x02\x00TRICKSTERGUY87", 24);
+    BaseMapHandler* handler = MapHandlerManager().FindHandlerByContent(binary_header);
+    BOOST_REQUIRE(handler != nullptr);
+    BOOST_CHECK_EQUAL(handler->GetName(), "Official Map Format");
+
+    handler = MapHandlerManager().FindHandlerByContent("Properties\nName \"map\"\n");
+    BOOST_REQUIRE(handler != nullptr);
+    BOOST_CHECK_EQUAL(handler->GetName(), "Text Format");
+
+    handler = MapHandlerManager().FindHandlerByContent("zzyzz");
+    BOOST_REQUIRE(handler == nullptr);
+}
+
+BOOST_AUTO_TEST_CASE(TestLoadMisnamed)
+{
+    Map map, map2, map3;
+    map.SetName("misnamed");
+    map.SetTileset(Tileset("tileset.png"));
+    map.Add(Layer("layer 1", 5, 5));
+    for (int i = 0; i < 25; i++) map.GetLayer(0)[i] = i;
+
+    MapHandlerManager().Save("testout4.txt", map, "Official Map Format");
+    MapHandlerManager().Load("testout4.txt", map2);
+    MapHandlerManager().Save("testout4", map, "Text Format");
+    MapHandlerManager().Load("testout4", map3);
+
+    const std::vector<int32_t>& data = map.GetLayer(0).GetData();
+    const std::vector<int32_t>& data2 = map2.GetLayer(0).GetData();
+    const std::vector<int32_t>& data3 = map3.GetLayer(0).GetData();
+    BOOST_CHECK_EQUAL_COLLECTIONS(data2.begin(), data2.end(), data.begin(), data.end());
+    BOOST_CHECK_EQUAL_COLLECTIONS(data3.begin(), data3.end(), data.begin(), data.end());
+}
@@ -23,6 +23,7 @@
 #include <sstream>
 #include "Map.hpp"
 #include "BinaryMapHandler.hpp"
+#include "DirectionBasedCollisionLayer.hpp"
 #include "TileBasedCollisionLayer.hpp"
 
 const char binary_data[] = {
@@ -195,3 +196,122 @@ BOOST_AUTO_TEST_CASE(BinaryMapHandlerSave)
 
     BOOST_CHECK_EQUAL_COLLECTIONS(expected.begin(), expected.end(), actual.begin(), actual.end());
 }
+
+BOOST_AUTO_TEST_CASE(BinaryMapHandlerDirectionCollision)
+{
+    BinaryMapHandler handler;
+    Map map;
+
+    std::stringstream file(map_data_binary_file);
+    std::stringstream out;
+    Map loaded;
+    try
+    {
+        handler.Load(file, map);
+        map.SetCollisionLayer(new DirectionBasedCollisionLayer(2, 2, {0xF, 0x5, 0x2, 0x0}));
+        handler.Save(out, map);
+        handler.Load(out, loaded);
+    }
+    catch (const char* s)
+    {
+        BOOST_FAIL(s);
+        return;
+    }
+
+    BOOST_REQUIRE(loaded.HasCollisionLayer());
+    BOOST_CHECK_EQUAL(loaded.GetCollisionLayer()->GetType(), CollisionLayer::DirectionBased);
+    DirectionBasedCollisionLayer* clayer = dynamic_cast<DirectionBasedCollisionLayer*>(loaded.GetCollisionLayer());
+    BOOST_REQUIRE(clayer);
+    BOOST_CHECK(*clayer == *dynamic_cast<DirectionBasedCollisionLayer*>(map.GetCollisionLayer()));
+}
+
+BOOST_AUTO_TEST_CASE(BinaryMapHandlerTileCollision)
+{
+    BinaryMapHandler handler;
+    Map map;
+
+    std::stringstream file(map_data_binary_file);
+    std::stringstream out;
+    Map loaded;
+    try
+    {
+        handler.Load(file, map);
+        TileCollision& collision = map.GetTileset().GetTileCollision();
+        collision.SetBlocked(3, true);
+        collision.SetDirections(5, 0x5);
+        collision.SetRectangles(2, {Rectangle(0, 16, 32, 16), Rectangle(4, 4, 2, 2)});
+        collision.SetRectangles(7, {Rectangle(1, 2, 3, 4)});
+        handler.Save(out, map);
+        handler.Load(out, loaded);
+    }
+    catch (const char* s)
+    {
+        BOOST_FAIL(s);
+        return;
+    }
+
+    const TileCollision& collision = loaded.GetTileset().GetTileCollision();
+    BOOST_CHECK(collision.IsBlocked(3));
+    BOOST_CHECK(!collision.IsBlocked(2));
+    BOOST_CHECK_EQUAL(collision.GetDirections(5), 0x5);
+    BOOST_CHECK_EQUAL(collision.GetDirections(4), DirectionBasedCollisionLayer::ALL_DIRECTIONS);
+    BOOST_CHECK(collision.GetRectangles() == map.GetTileset().GetTileCollision().GetRectangles());
+    BOOST_CHECK_EQUAL(loaded.ContentHash(), map.ContentHash());
+}
+
+BOOST_AUTO_TEST_CASE(BinaryMapHandlerTruncatedTileCollision)
+{
+    BinaryMapHandler handler;
+
+    // Counts larger than the chunk are rejected before anything is allocated.
+    const std::string chunks[] = {
+        std::string("TTCI\x00\x00\x00\x08\x40\x00\x00\x00\x00\x00\x00\x01", 16),
+        std::string("TDCI\x00\x00\x00\x08\x40\x00\x00\x00\x00\x00\x00\x0f", 16),
+        std::string("TPCI\x00\x00\x00\x0c\x40\x00\x00\x00\x00\x00\x00\x03\x00\x00\x00\x01", 20),
+        std::string("TPCI\x00\x00\x00\x0c\x00\x00\x00\x01\x00\x00\x00\x03\x10\x00\x00\x00", 20),
+        // Ends part way through a rectangle.
+        std::string("TPCI\x00\x00\x00\x1c\x00\x00\x00\x01\x00\x00\x00\x03\x00\x00\x00\x01\x00\x00\x00\x04", 24),
+    };
+    for (const auto& chunk : chunks)
+    {
+        std::stringstream file(chunk);
+        Map map;
+        BOOST_CHECK_THROW(handler.Load(file, map), const char*);
+    }
+}
+
+namespace
+{
+
+/** Counts the layers and collision layers a handler starts */
+class SizeRecorder : public MapVisitor
+{
+public:
+    void OnLayerBegin(const MapSource::LayerInfo& info) override { layers++; }
+    void OnCollision(const MapSource::CollisionInfo& info) override { collisions++; }
+
+    int layers = 0;
+    int collisions = 0;
+};
+
+}
+
+BOOST_AUTO_TEST_CASE(BinaryMapHandlerTruncatedTiles)
+{
+    BinaryMapHandler handler;
+
+    // 65536x65536 headers in chunks far too small for the tiles fail before the visitor hears of them.
+    const std::string chunks[] = {
+        std::string("LYRS\x00\x00\x00\x3d\x00\x00\x00\x01\x00\x00\x00\x01" "A" "\x00\x01\x00\x00\x00\x01\x00\x00", 25) + std::string(44, '\0'),
+        std::string("MTCL\x00\x00\x00\x08\x00\x01\x00\x00\x00\x01\x00\x00", 16),
+        std::string("MDCL\x00\x00\x00\x08\x00\x01\x00\x00\x00\x01\x00\x00", 16),
+    };
+    for (const auto& chunk : chunks)
+    {
+        std::stringstream file(chunk);
+        SizeRecorder recorder;
+        BOOST_CHECK_THROW(handler.Load(file, recorder), const char*);
+        BOOST_CHECK_EQUAL(recorder.layers, 0);
+        BOOST_CHECK_EQUAL(recorder.collisions, 0);
+    }
+}
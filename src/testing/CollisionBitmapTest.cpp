@@ -0,0 +1,184 @@
+/******************************************************************************************************
+ * Tile Map Editor
+ * Copyright (C) 2009-2017 Brandon Whitehead (tricksterguy87[AT]gmail[DOT]com)
+ *
+ * This software is provided 'as-is', without any express or implied warranty.
+ * In no event will the authors be held liable for any damages arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * excluding commercial applications, and to alter it and redistribute it freely,
+ * subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented;
+ *    you must not claim that you wrote the original software.
+ *    An acknowledgement in your documentation and link to the original version is required.
+ *
+ * 2. Altered source versions must be plainly marked as such,
+ *    and must not be misrepresented as being the original software.
+ *
+ * 3. This notice may not be removed or altered from any source distribution.
+ ******************************************************************************************************/
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/auto_unit_test.hpp>
+#include <atomic>
+#include <cstdlib>
+#include <thread>
+#include "CollisionBitmap.hpp"
+#include "PixelBasedCollisionLayer.hpp"
+
+namespace
+{
+
+Rectangle RandomRectangle()
+{
+    return Rectangle(rand() % 200 - 20, rand() % 100 - 10, 1 + rand() % 90, 1 + rand() % 40);
+}
+
+}
+
+BOOST_AUTO_TEST_CASE(TestBitmapFill)
+{
+    CollisionBitmap bitmap(Rectangle(-10, -5, 150, 20));
+    bitmap.Fill(Rectangle(60, 0, 10, 3));
+    BOOST_CHECK(bitmap.Get(60, 0));
+    BOOST_CHECK(bitmap.Get(69, 2));
+    BOOST_CHECK(!bitmap.Get(70, 2));
+    BOOST_CHECK(!bitmap.Get(59, 0));
+    BOOST_CHECK(!bitmap.Get(60, 3));
+    BOOST_CHECK_EQUAL(bitmap.Count(), 30);
+
+    // Clipped to the bounds.
+    bitmap.Fill(Rectangle(-100, -100, 500, 500));
+    BOOST_CHECK_EQUAL(bitmap.Count(), 150 * 20);
+    BOOST_CHECK(!bitmap.Get(140, 0));
+    BOOST_CHECK(!bitmap.Get(-11, 0));
+
+    bitmap.Fill(Rectangle(0, 0, 64, 1), false);
+    bitmap.Set(5, 0, true);
+    BOOST_CHECK_EQUAL(bitmap.Count(), 150 * 20 - 63);
+    BOOST_CHECK(bitmap.ToRegion().Area() == bitmap.Count());
+}
+
+BOOST_AUTO_TEST_CASE(TestBitmapRegionRoundTrip)
+{
+    srand(99);
+    for (int test = 0; test < 20; test++)
+    {
+        std::vector<Rectangle> rectangles;
+        for (int i = 0; i < 10; i++)
+            rectangles.push_back(RandomRectangle());
+        Region region(rectangles);
+        CollisionBitmap bitmap(region);
+        BOOST_CHECK(bitmap.GetBounds() == region.Bounds());
+        BOOST_CHECK_EQUAL(bitmap.Count(), region.Area());
+        BOOST_CHECK(bitmap.ToRegion() == region);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(TestBitmapOperations)
+{
+    // Bitmaps with bounds that don't line up on words give the same answers as regions.
+    srand(7);
+    Rectangle bounds(-20, -10, 290, 150);
+    for (int test = 0; test < 20; test++)
+    {
+        std::vector<Rectangle> a, b;
+        for (int i = 0; i < 8; i++)
+        {
+            a.push_back(RandomRectangle());
+            b.push_back(RandomRectangle());
+        }
+        Region ra(a), rb(b);
+        CollisionBitmap ba(bounds);
+        for (const auto& r : ra.GetData())
+            ba.Fill(r);
+        CollisionBitmap bb(rb);
+
+        Region ru = ra, ri = ra, rs = ra, rx = ra;
+        ru.Add(rb);
+        ri.Intersect(rb);
+        rs.Subtract(rb);
+        rx.Xor(rb);
+
+        CollisionBitmap bu = ba, bi = ba, bs = ba, bx = ba;
+        bu.Add(bb);
+        bi.Intersect(bb);
+        bs.Subtract(bb);
+        bx.Xor(bb);
+
+        BOOST_CHECK(bu.ToRegion() == ru);
+        BOOST_CHECK(bi.ToRegion() == ri);
+        BOOST_CHECK(bs.ToRegion() == rs);
+        BOOST_CHECK(bx.ToRegion() == rx);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(TestBitmapExpand)
+{
+    CollisionBitmap bitmap;
+    BOOST_CHECK(!bitmap.Get(0, 0));
+    bitmap.Expand(Rectangle(10, 10, 5, 5));
+    bitmap.Fill(Rectangle(10, 10, 5, 5));
+    bitmap.Expand(Rectangle(-70, 0, 5, 5));
+    BOOST_CHECK(bitmap.GetBounds() == Rectangle(-70, 0, 85, 15));
+    BOOST_CHECK(bitmap.Get(14, 14));
+    BOOST_CHECK_EQUAL(bitmap.Count(), 25);
+
+    bitmap.Move(-10, -10);
+    BOOST_CHECK(bitmap.Get(0, 0));
+    BOOST_CHECK(!bitmap.Get(14, 14));
+}
+
+BOOST_AUTO_TEST_CASE(TestLayerBitmapMode)
+{
+    PixelBasedCollisionLayer layer({Rectangle(0, 0, 16, 8), Rectangle(-32, 40, 8, 8)});
+    PixelBasedCollisionLayer regions = layer;
+
+    layer.SetBitmapMode(true);
+    BOOST_CHECK(layer.IsBitmapMode());
+    BOOST_CHECK(layer == regions);
+    BOOST_CHECK_EQUAL(layer.ContentHash(), regions.ContentHash());
+
+    layer.Add(Rectangle(100, 100, 10, 10));
+    layer.Subtract(Rectangle(0, 0, 4, 4));
+    layer.Xor(Rectangle(-32, 40, 16, 4));
+    regions.Add(Rectangle(100, 100, 10, 10));
+    regions.Subtract(Rectangle(0, 0, 4, 4));
+    regions.Xor(Rectangle(-32, 40, 16, 4));
+    BOOST_CHECK(layer.Contains(105, 105));
+    BOOST_CHECK(!layer.Contains(1, 1));
+    BOOST_CHECK(layer.Contains(-20, 41));
+    BOOST_CHECK(layer == regions);
+
+    layer.Intersect(Rectangle(-40, 0, 60, 60));
+    regions.Intersect(Rectangle(-40, 0, 60, 60));
+    BOOST_CHECK(!layer.Contains(105, 105));
+    BOOST_CHECK(layer == regions);
+
+    layer.SetBitmapMode(false);
+    BOOST_CHECK(layer.GetData() == regions.GetData());
+}
+
+BOOST_AUTO_TEST_CASE(TestLayerBitmapModePrepare)
+{
+    // Enough rectangles for the region to use an index.
+    PixelBasedCollisionLayer layer;
+    layer.SetBitmapMode(true);
+    for (int32_t i = 0; i < 64; i++)
+        layer.Add(Rectangle(i * 4, i * 3, 2, 2));
+    layer.Prepare();
+
+    // Queries after Prepare only read, so they are safe from several threads.
+    std::vector<std::thread> threads;
+    std::atomic<int> hits(0);
+    for (int32_t t = 0; t < 4; t++)
+        threads.emplace_back([&]()
+        {
+            for (int32_t i = 0; i < 64; i++)
+                hits += layer.Overlaps({i * 4.0f, i * 3.0f, 1.0f, 1.0f});
+        });
+    for (auto& thread : threads)
+        thread.join();
+    BOOST_CHECK_EQUAL(hits, 4 * 64);
+    BOOST_CHECK_EQUAL(layer.GetData().GetData().size(), 64);
+}
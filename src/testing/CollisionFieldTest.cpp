@@ -0,0 +1,237 @@
+/******************************************************************************************************
+ * Tile Map Editor
+ * Copyright (C) 2009-2017 Brandon Whitehead (tricksterguy87[AT]gmail[DOT]com)
+ *
+ * This software is provided 'as-is', without any express or implied warranty.
+ * In no event will the authors be held liable for any damages arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * excluding commercial applications, and to alter it and redistribute it freely,
+ * subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented;
+ *    you must not claim that you wrote the original software.
+ *    An acknowledgement in your documentation and link to the original version is required.
+ *
+ * 2. Altered source versions must be plainly marked as such,
+ *    and must not be misrepresented as being the original software.
+ *
+ * 3. This notice may not be removed or altered from any source distribution.
+ ******************************************************************************************************/
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/auto_unit_test.hpp>
+#include <algorithm>
+#include <cstdlib>
+#include <map>
+#include "ConnectivityMap.hpp"
+#include "DirectionBasedCollisionLayer.hpp"
+#include "DistanceField.hpp"
+#include "PathFinder.hpp"
+#include "TileBasedCollisionLayer.hpp"
+
+namespace
+{
+
+/** Distance to the nearest blocked tile by checking every tile */
+uint32_t BruteDistance(const PathGrid& grid, int32_t x, int32_t y, DistanceField::Metric metric)
+{
+    uint32_t best = grid.GetWidth() + grid.GetHeight();
+    best = metric == DistanceField::Euclidean ? best * best : best;
+    for (int32_t j = 0; j < (int32_t) grid.GetHeight(); j++)
+    {
+        for (int32_t i = 0; i < (int32_t) grid.GetWidth(); i++)
+        {
+            if (grid.IsOpen(i, j))
+                continue;
+            uint32_t dx = std::abs(i - x), dy = std::abs(j - y);
+            best = std::min(best, metric == DistanceField::Euclidean ? dx * dx + dy * dy : std::max(dx, dy));
+        }
+    }
+    return best;
+}
+
+/** Checks two labellings split the tiles into the same components */
+bool SameComponents(const ConnectivityMap& a, const ConnectivityMap& b)
+{
+    if (a.GetComponentCount() != b.GetComponentCount())
+        return false;
+    std::map<int32_t, int32_t> a_to_b;
+    for (uint32_t y = 0; y < a.GetHeight(); y++)
+    {
+        for (uint32_t x = 0; x < a.GetWidth(); x++)
+        {
+            int32_t la = a.GetComponent(x, y), lb = b.GetComponent(x, y);
+            if ((la == ConnectivityMap::NONE) != (lb == ConnectivityMap::NONE))
+                return false;
+            if (la == ConnectivityMap::NONE)
+                continue;
+            if (!a_to_b.count(la))
+                a_to_b[la] = lb;
+            if (a_to_b[la] != lb || !a.GetComponentBounds(la).Contains(x, y))
+                return false;
+        }
+    }
+    return true;
+}
+
+TileBasedCollisionLayer RandomLayer(uint32_t width, uint32_t height, int percent_blocked)
+{
+    TileBasedCollisionLayer layer(width, height, std::vector<int32_t>(width * height, 0));
+    for (uint32_t i = 0; i < width * height; i++)
+    {
+        if (rand() % 100 < percent_blocked)
+            layer.Set(i % width, i / width, -1);
+    }
+    return layer;
+}
+
+}
+
+BOOST_AUTO_TEST_CASE(TestDistanceField)
+{
+    TileBasedCollisionLayer layer(7, 5, std::vector<int32_t>(35, 0));
+    layer.Set(2, 1, -1);
+    PathGrid grid(layer);
+
+    DistanceField euclidean(grid);
+    BOOST_CHECK_EQUAL(euclidean.GetRaw(2, 1), 0u);
+    BOOST_CHECK_EQUAL(euclidean.GetRaw(3, 1), 1u);
+    BOOST_CHECK_EQUAL(euclidean.GetRaw(6, 4), 25u);
+    BOOST_CHECK_CLOSE(euclidean.Get(6, 4), 5.0f, 0.001f);
+    BOOST_CHECK(euclidean.HasClearance(6, 4, 5));
+    BOOST_CHECK(!euclidean.HasClearance(6, 4, 6));
+
+    DistanceField chebyshev(grid, DistanceField::Chebyshev);
+    BOOST_CHECK_EQUAL(chebyshev.GetRaw(2, 1), 0u);
+    BOOST_CHECK_EQUAL(chebyshev.GetRaw(3, 2), 1u);
+    BOOST_CHECK_EQUAL(chebyshev.GetRaw(6, 4), 4u);
+    BOOST_CHECK_EQUAL(chebyshev.GetRaw(0, 4), 3u);
+
+    // Nothing blocked.
+    layer.Set(2, 1, 0);
+    grid.Update(layer, Rectangle(2, 1, 1, 1));
+    chebyshev.Update(grid, Rectangle(2, 1, 1, 1));
+    BOOST_CHECK_GE(chebyshev.GetRaw(2, 1), 12u);
+}
+
+BOOST_AUTO_TEST_CASE(TestDistanceFieldMatchesBruteForce)
+{
+    srand(11);
+    for (int map = 0; map < 6; map++)
+    {
+        TileBasedCollisionLayer layer = RandomLayer(20 + map * 5, 15 + map * 3, 2 + map * 4);
+        PathGrid grid(layer);
+        DistanceField euclidean(grid), chebyshev(grid, DistanceField::Chebyshev);
+        for (int edit = 0; edit < 10; edit++)
+        {
+            for (uint32_t y = 0; y < grid.GetHeight(); y++)
+            {
+                for (uint32_t x = 0; x < grid.GetWidth(); x++)
+                {
+                    BOOST_REQUIRE_EQUAL(euclidean.GetRaw(x, y), BruteDistance(grid, x, y, DistanceField::Euclidean));
+                    BOOST_REQUIRE_EQUAL(chebyshev.GetRaw(x, y), BruteDistance(grid, x, y, DistanceField::Chebyshev));
+                }
+            }
+
+            Rectangle area(rand() % layer.GetWidth(), rand() % layer.GetHeight(), 1 + rand() % 4, 1 + rand() % 4);
+            int32_t x1, y1, x2, y2;
+            area.GetCoords(x1, y1, x2, y2);
+            for (int32_t y = y1; y < std::min(y2, (int32_t) layer.GetHeight()); y++)
+            {
+                for (int32_t x = x1; x < std::min(x2, (int32_t) layer.GetWidth()); x++)
+                    layer.Set(x, y, rand() % 2 ? -1 : 0);
+            }
+            grid.Update(layer, area);
+            euclidean.Update(grid, area);
+            chebyshev.Update(grid, area);
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(TestConnectivity)
+{
+    // Two rooms split by a wall down column 3.
+    TileBasedCollisionLayer layer(7, 4, std::vector<int32_t>(28, 0));
+    for (uint32_t y = 0; y < 4; y++)
+        layer.Set(3, y, -1);
+    PathGrid grid(layer);
+    ConnectivityMap connectivity(grid);
+    BOOST_CHECK_EQUAL(connectivity.GetComponentCount(), 2u);
+    BOOST_CHECK(connectivity.IsReachable(0, 0, 2, 3));
+    BOOST_CHECK(!connectivity.IsReachable(0, 0, 6, 3));
+    BOOST_CHECK(!connectivity.IsReachable(0, 0, 3, 0));
+    BOOST_CHECK(!connectivity.IsReachable(0, 0, 7, 0));
+    BOOST_CHECK(connectivity.GetComponentBounds(connectivity.GetComponent(5, 1)) == Rectangle(4, 0, 3, 4));
+
+    // Open a door.
+    layer.Set(3, 2, 0);
+    grid.Update(layer, Rectangle(3, 2, 1, 1));
+    connectivity.Update(grid, Rectangle(3, 2, 1, 1));
+    BOOST_CHECK_EQUAL(connectivity.GetComponentCount(), 1u);
+    BOOST_CHECK(connectivity.IsReachable(0, 0, 6, 3));
+    BOOST_CHECK(connectivity.GetComponentBounds(connectivity.GetComponent(0, 0)) == Rectangle(0, 0, 7, 4));
+
+    // Close it and cut off the top left corner.
+    layer.Set(3, 2, -1);
+    layer.Set(0, 1, -1);
+    layer.Set(1, 0, -1);
+    grid.Update(layer, Rectangle(0, 0, 4, 3));
+    connectivity.Update(grid, Rectangle(0, 0, 4, 3));
+    BOOST_CHECK_EQUAL(connectivity.GetComponentCount(), 3u);
+    BOOST_CHECK(!connectivity.IsReachable(0, 0, 2, 3));
+    BOOST_CHECK(connectivity.IsReachable(0, 0, 0, 0));
+    BOOST_CHECK(!connectivity.IsReachable(2, 3, 6, 3));
+    BOOST_CHECK(SameComponents(connectivity, ConnectivityMap(grid)));
+}
+
+BOOST_AUTO_TEST_CASE(TestConnectivityDirections)
+{
+    // Walls between columns 1 and 2 on both rows.
+    DirectionBasedCollisionLayer layer(4, 2, std::vector<int32_t>(8, DirectionBasedCollisionLayer::ALL_DIRECTIONS));
+    const int32_t no_east = DirectionBasedCollisionLayer::ALL_DIRECTIONS & ~DirectionBasedCollisionLayer::Bit(DirectionBasedCollisionLayer::East);
+    layer.Set(1, 0, no_east);
+    layer.Set(1, 1, no_east);
+    PathGrid grid(layer);
+    ConnectivityMap connectivity(grid);
+    BOOST_CHECK_EQUAL(connectivity.GetComponentCount(), 2u);
+    BOOST_CHECK(!connectivity.IsReachable(0, 0, 3, 1));
+
+    layer.Set(1, 1, DirectionBasedCollisionLayer::ALL_DIRECTIONS);
+    grid.Update(layer, Rectangle(1, 1, 1, 1));
+    connectivity.Update(grid, Rectangle(1, 1, 1, 1));
+    BOOST_CHECK(connectivity.IsReachable(0, 0, 3, 1));
+}
+
+BOOST_AUTO_TEST_CASE(TestConnectivityMatchesSearch)
+{
+    srand(13);
+    for (int map = 0; map < 6; map++)
+    {
+        TileBasedCollisionLayer layer = RandomLayer(30 + map * 5, 25 + map * 3, 25 + map * 4);
+        PathGrid grid(layer);
+        ConnectivityMap connectivity(grid);
+        for (int edit = 0; edit < 30; edit++)
+        {
+            Rectangle area(rand() % layer.GetWidth(), rand() % layer.GetHeight(), 1 + rand() % 5, 1 + rand() % 5);
+            int32_t x1, y1, x2, y2;
+            area.GetCoords(x1, y1, x2, y2);
+            for (int32_t y = y1; y < std::min(y2, (int32_t) layer.GetHeight()); y++)
+            {
+                for (int32_t x = x1; x < std::min(x2, (int32_t) layer.GetWidth()); x++)
+                    layer.Set(x, y, rand() % 100 < 25 + map * 4 ? -1 : 0);
+            }
+            grid.Update(layer, area);
+            connectivity.Update(grid, area);
+            BOOST_REQUIRE(SameComponents(connectivity, ConnectivityMap(grid)));
+        }
+
+        PathFinder finder(grid);
+        PathFinder::Path path;
+        for (int i = 0; i < 100; i++)
+        {
+            uint32_t sx = rand() % grid.GetWidth(), sy = rand() % grid.GetHeight();
+            uint32_t gx = rand() % grid.GetWidth(), gy = rand() % grid.GetHeight();
+            BOOST_REQUIRE_EQUAL(connectivity.IsReachable(sx, sy, gx, gy), finder.FindPath(sx, sy, gx, gy, path));
+        }
+    }
+}
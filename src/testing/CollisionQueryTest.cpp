@@ -0,0 +1,194 @@
+/******************************************************************************************************
+ * Tile Map Editor
+ * Copyright (C) 2009-2017 Brandon Whitehead (tricksterguy87[AT]gmail[DOT]com)
+ *
+ * This software is provided 'as-is', without any express or implied warranty.
+ * In no event will the authors be held liable for any damages arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * excluding commercial applications, and to alter it and redistribute it freely,
+ * subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented;
+ *    you must not claim that you wrote the original software.
+ *    An acknowledgement in your documentation and link to the original version is required.
+ *
+ * 2. Altered source versions must be plainly marked as such,
+ *    and must not be misrepresented as being the original software.
+ *
+ * 3. This notice may not be removed or altered from any source distribution.
+ ******************************************************************************************************/
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/auto_unit_test.hpp>
+#include <cstdlib>
+#include "DirectionBasedCollisionLayer.hpp"
+#include "PixelBasedCollisionLayer.hpp"
+#include "TileBasedCollisionLayer.hpp"
+
+namespace
+{
+
+float RandomFloat(float low, float high)
+{
+    return low + (high - low) * (rand() / (float) RAND_MAX);
+}
+
+/** Layer with a wall at column 5 from row 2 to 7 */
+TileBasedCollisionLayer WallLayer()
+{
+    TileBasedCollisionLayer layer(10, 10, std::vector<int32_t>(100, 0));
+    for (uint32_t y = 2; y < 8; y++)
+        layer.Set(5, y, -1);
+    return layer;
+}
+
+}
+
+BOOST_AUTO_TEST_CASE(TestTileCollisionPointAndBox)
+{
+    TileBasedCollisionLayer layer = WallLayer();
+    BOOST_CHECK(layer.Collides(5.5f, 2.0f));
+    BOOST_CHECK(!layer.Collides(4.99f, 3.0f));
+    BOOST_CHECK(!layer.Collides(5.5f, 8.0f));
+    BOOST_CHECK(!layer.Collides(-1.0f, -1.0f));
+
+    BOOST_CHECK(layer.Overlaps({4.5f, 3.0f, 1.0f, 1.0f}));
+    // Touching the wall isn't overlapping it.
+    BOOST_CHECK(!layer.Overlaps({4.0f, 3.0f, 1.0f, 1.0f}));
+    BOOST_CHECK(!layer.Overlaps({5.0f, 8.0f, 2.0f, 1.0f}));
+    BOOST_CHECK(!layer.Overlaps({4.5f, 3.0f, 0.0f, 1.0f}));
+}
+
+BOOST_AUTO_TEST_CASE(TestTileCollisionSweep)
+{
+    TileBasedCollisionLayer layer = WallLayer();
+    CollisionHit hit;
+
+    BOOST_REQUIRE(layer.Sweep({1.0f, 3.5f, 1.0f, 1.0f}, 8.0f, 0.0f, hit));
+    BOOST_CHECK_CLOSE(hit.time, 0.375f, 0.001f);
+    BOOST_CHECK_EQUAL(hit.normal_x, -1.0f);
+    BOOST_CHECK_EQUAL(hit.normal_y, 0.0f);
+
+    BOOST_REQUIRE(layer.Sweep({8.0f, 4.0f, 0.5f, 0.5f}, -4.0f, 0.0f, hit));
+    BOOST_CHECK_CLOSE(hit.time, 0.5f, 0.001f);
+    BOOST_CHECK_EQUAL(hit.normal_x, 1.0f);
+
+    // Falling onto the top of the wall.
+    BOOST_REQUIRE(layer.Sweep({5.25f, 0.0f, 0.5f, 1.0f}, 0.0f, 4.0f, hit));
+    BOOST_CHECK_CLOSE(hit.time, 0.25f, 0.001f);
+    BOOST_CHECK_EQUAL(hit.normal_y, -1.0f);
+
+    // Sliding along the wall and passing below it.
+    BOOST_CHECK(!layer.Sweep({4.0f, 2.0f, 1.0f, 1.0f}, 0.0f, 6.0f, hit));
+    BOOST_CHECK(!layer.Sweep({1.0f, 8.0f, 1.0f, 1.0f}, 8.0f, 0.0f, hit));
+    // Stopping short.
+    BOOST_CHECK(!layer.Sweep({1.0f, 3.5f, 1.0f, 1.0f}, 1.9f, 0.0f, hit));
+
+    // Entering the corner tile diagonally.
+    BOOST_REQUIRE(layer.Sweep({4.0f, 0.0f, 1.0f, 1.0f}, 2.0f, 2.0f, hit));
+    BOOST_CHECK_CLOSE(hit.time, 0.5f, 0.001f);
+
+    // Starting inside.
+    BOOST_REQUIRE(layer.Sweep({5.0f, 3.0f, 1.0f, 1.0f}, 1.0f, 0.0f, hit));
+    BOOST_CHECK_EQUAL(hit.time, 0.0f);
+}
+
+BOOST_AUTO_TEST_CASE(TestTileCollisionRaycast)
+{
+    TileBasedCollisionLayer layer = WallLayer();
+    CollisionHit hit;
+
+    BOOST_REQUIRE(layer.Raycast(0.5f, 4.5f, 9.0f, 0.0f, hit));
+    BOOST_CHECK_CLOSE(hit.time, 0.5f, 0.001f);
+    BOOST_CHECK_EQUAL(hit.normal_x, -1.0f);
+
+    BOOST_REQUIRE(layer.Raycast(5.5f, 9.5f, 0.0f, -9.0f, hit));
+    BOOST_CHECK_CLOSE(hit.time, 1.5f / 9.0f, 0.001f);
+    BOOST_CHECK_EQUAL(hit.normal_y, 1.0f);
+
+    BOOST_CHECK(!layer.Raycast(0.5f, 0.5f, 9.0f, 1.0f, hit));
+    // From outside the layer.
+    BOOST_REQUIRE(layer.Raycast(-100.0f, 4.5f, 200.0f, 0.0f, hit));
+    BOOST_CHECK_CLOSE(hit.time, 105.0f / 200.0f, 0.001f);
+    BOOST_CHECK(!layer.Raycast(-100.0f, 40.5f, 200.0f, 0.0f, hit));
+}
+
+BOOST_AUTO_TEST_CASE(TestDirectionCollisionQueries)
+{
+    DirectionBasedCollisionLayer layer(4, 4);
+    layer.Set(2, 1, 0);
+    CollisionHit hit;
+    BOOST_CHECK(layer.Collides(2.5f, 1.5f));
+    BOOST_CHECK(!layer.Collides(1.5f, 1.5f));
+    BOOST_REQUIRE(layer.Raycast(0.5f, 1.5f, 3.0f, 0.0f, hit));
+    BOOST_CHECK_CLOSE(hit.time, 0.5f, 0.001f);
+}
+
+BOOST_AUTO_TEST_CASE(TestPixelCollisionQueries)
+{
+    PixelBasedCollisionLayer layer({Rectangle(10, 0, 4, 20)});
+    CollisionHit hit;
+    BOOST_CHECK(layer.Collides(10.0f, 5.5f));
+    BOOST_CHECK(!layer.Collides(9.9f, 5.5f));
+    BOOST_CHECK(layer.Overlaps({8.0f, 2.0f, 2.5f, 1.0f}));
+    BOOST_CHECK(!layer.Overlaps({8.0f, 2.0f, 2.0f, 1.0f}));
+
+    BOOST_REQUIRE(layer.Sweep({0.0f, 5.0f, 2.0f, 2.0f}, 16.0f, 0.0f, hit));
+    BOOST_CHECK_CLOSE(hit.time, 0.5f, 0.001f);
+    BOOST_CHECK_EQUAL(hit.normal_x, -1.0f);
+    BOOST_CHECK(!layer.Sweep({0.0f, 20.0f, 2.0f, 2.0f}, 16.0f, 0.0f, hit));
+
+    BOOST_REQUIRE(layer.Raycast(30.0f, 5.0f, -20.0f, 0.0f, hit));
+    BOOST_CHECK_CLOSE(hit.time, 0.8f, 0.001f);
+    BOOST_CHECK_EQUAL(hit.normal_x, 1.0f);
+}
+
+BOOST_AUTO_TEST_CASE(TestCollisionQueriesAgree)
+{
+    // Tile layer and pixel layer with one pixel per blocked tile answer every query the same.
+    srand(3);
+    const uint32_t size = 24;
+    TileBasedCollisionLayer tiles(size, size, std::vector<int32_t>(size * size, 0));
+    std::vector<Rectangle> rectangles;
+    for (uint32_t y = 0; y < size; y++)
+    {
+        for (uint32_t x = 0; x < size; x++)
+        {
+            if (rand() % 6 == 0)
+            {
+                tiles.Set(x, y, -1);
+                rectangles.push_back(Rectangle(x, y, 1, 1));
+            }
+        }
+    }
+    PixelBasedCollisionLayer pixels(rectangles);
+
+    for (uint32_t i = 0; i < 2000; i++)
+    {
+        CollisionBox box = {RandomFloat(-4, size + 4), RandomFloat(-4, size + 4), RandomFloat(0.1f, 3), RandomFloat(0.1f, 3)};
+        float dx = RandomFloat(-10, 10);
+        float dy = RandomFloat(-10, 10);
+
+        BOOST_REQUIRE_EQUAL(tiles.Collides(box.x, box.y), pixels.Collides(box.x, box.y));
+        BOOST_REQUIRE_EQUAL(tiles.Overlaps(box), pixels.Overlaps(box));
+
+        CollisionHit tile_hit, pixel_hit;
+        bool tile_found = tiles.Sweep(box, dx, dy, tile_hit);
+        BOOST_REQUIRE_EQUAL(tile_found, pixels.Sweep(box, dx, dy, pixel_hit));
+        if (tile_found)
+        {
+            BOOST_REQUIRE_SMALL(tile_hit.time - pixel_hit.time, 1e-4f);
+            BOOST_REQUIRE_EQUAL(tile_hit.normal_x, pixel_hit.normal_x);
+            BOOST_REQUIRE_EQUAL(tile_hit.normal_y, pixel_hit.normal_y);
+        }
+
+        tile_found = tiles.Raycast(box.x, box.y, dx, dy, tile_hit);
+        BOOST_REQUIRE_EQUAL(tile_found, pixels.Raycast(box.x, box.y, dx, dy, pixel_hit));
+        if (tile_found)
+        {
+            BOOST_REQUIRE_SMALL(tile_hit.time - pixel_hit.time, 1e-4f);
+            BOOST_REQUIRE_EQUAL(tile_hit.normal_x, pixel_hit.normal_x);
+            BOOST_REQUIRE_EQUAL(tile_hit.normal_y, pixel_hit.normal_y);
+        }
+    }
+}
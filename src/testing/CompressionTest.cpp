@@ -0,0 +1,172 @@
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/auto_unit_test.hpp>
+#include <cstdlib>
+#include "Base64.hpp"
+#include "Compression.hpp"
+
+namespace
+{
+
+std::vector<uint8_t> MakeBytes(const std::string& str)
+{
+    return std::vector<uint8_t>(str.begin(), str.end());
+}
+
+}
+
+BOOST_AUTO_TEST_CASE(TestBase64Encode)
+{
+    std::vector<uint8_t> data = MakeBytes("Many hands make light work.");
+    BOOST_CHECK_EQUAL(Base64Encode(data.data(), data.size()), "TWFueSBoYW5kcyBtYWtlIGxpZ2h0IHdvcmsu");
+
+    BOOST_CHECK_EQUAL(Base64Encode(nullptr, 0), "");
+    data = MakeBytes("f");
+    BOOST_CHECK_EQUAL(Base64Encode(data.data(), data.size()), "Zg==");
+    data = MakeBytes("fo");
+    BOOST_CHECK_EQUAL(Base64Encode(data.data(), data.size()), "Zm8=");
+    data = MakeBytes("foo");
+    BOOST_CHECK_EQUAL(Base64Encode(data.data(), data.size()), "Zm9v");
+}
+
+BOOST_AUTO_TEST_CASE(TestBase64Decode)
+{
+    std::vector<uint8_t> actual;
+    std::vector<uint8_t> expected = MakeBytes("Many hands make light work.");
+
+    BOOST_REQUIRE(Base64Decode("TWFueSBoYW5kcyBtYWtlIGxpZ2h0IHdvcmsu", actual));
+    BOOST_CHECK_EQUAL_COLLECTIONS(actual.begin(), actual.end(), expected.begin(), expected.end());
+
+    BOOST_REQUIRE(Base64Decode("\n\t TWFueSBoYW5k\ncyBtYWtlIGxp Z2h0IHdvcmsu\n", actual));
+    BOOST_CHECK_EQUAL_COLLECTIONS(actual.begin(), actual.end(), expected.begin(), expected.end());
+
+    expected = MakeBytes("fo");
+    BOOST_REQUIRE(Base64Decode("Zm8=", actual));
+    BOOST_CHECK_EQUAL_COLLECTIONS(actual.begin(), actual.end(), expected.begin(), expected.end());
+
+    BOOST_CHECK(!Base64Decode("Zm8", actual));
+    BOOST_CHECK(!Base64Decode("Zm=v", actual));
+    BOOST_CHECK(!Base64Decode("TWFueSBoYW5kcyBtYWtl*GxpZ2h0IHdvcmsu", actual));
+}
+
+BOOST_AUTO_TEST_CASE(TestBase64RoundTrip)
+{
+    // Sizes around the 12 byte blocks handled by the vectorized paths.
+    for (size_t size = 0; size < 100; size++)
+    {
+        std::vector<uint8_t> data(size);
+        for (auto& byte : data)
+            byte = rand() % 256;
+
+        std::vector<uint8_t> actual;
+        BOOST_REQUIRE(Base64Decode(Base64Encode(data.data(), data.size()), actual));
+        BOOST_CHECK_EQUAL_COLLECTIONS(actual.begin(), actual.end(), data.begin(), data.end());
+    }
+}
+
+BOOST_AUTO_TEST_CASE(TestRle)
+{
+    std::vector<int32_t> data = {-1, -1, -1, -1, 5, 5, 7, -1};
+    std::vector<uint8_t> encoded;
+    RleEncode(data, encoded);
+    BOOST_CHECK_EQUAL(encoded.size(), 4 * 8);
+
+    std::vector<int32_t> actual;
+    BOOST_REQUIRE(RleDecode(encoded, data.size(), actual));
+    BOOST_CHECK_EQUAL_COLLECTIONS(actual.begin(), actual.end(), data.begin(), data.end());
+
+    // Too few or too many values.
+    BOOST_CHECK(!RleDecode(encoded, data.size() + 1, actual));
+    BOOST_CHECK(!RleDecode(encoded, data.size() - 1, actual));
+
+    encoded.pop_back();
+    BOOST_CHECK(!RleDecode(encoded, data.size(), actual));
+
+    // A single huge run is rejected without expanding it.
+    std::vector<uint8_t> bomb;
+    PackLittleEndian({0x7FFFFFFF, 1, 0x7FFFFFFF, 1}, bomb);
+    BOOST_CHECK(!RleDecode(bomb, 64 * 64, actual));
+    BOOST_CHECK(actual.empty());
+}
+
+BOOST_AUTO_TEST_CASE(TestLzRoundTrip)
+{
+    std::vector<int32_t> layer(64 * 64, -1);
+    for (size_t i = 0; i < layer.size(); i += 7)
+        layer[i] = rand() % 16;
+
+    std::vector<uint8_t> raw;
+    PackLittleEndian(layer, raw);
+
+    std::vector<uint8_t> compressed;
+    LzCompress(raw, compressed);
+    BOOST_CHECK(compressed.size() < raw.size());
+
+    std::vector<uint8_t> decompressed;
+    BOOST_REQUIRE(LzDecompress(compressed, raw.size(), decompressed));
+    BOOST_CHECK_EQUAL_COLLECTIONS(decompressed.begin(), decompressed.end(), raw.begin(), raw.end());
+
+    std::vector<int32_t> actual;
+    BOOST_REQUIRE(UnpackLittleEndian(decompressed, actual));
+    BOOST_CHECK_EQUAL_COLLECTIONS(actual.begin(), actual.end(), layer.begin(), layer.end());
+
+    // Incompressible and tiny inputs.
+    for (size_t size : {0, 1, 3, 4, 5, 300})
+    {
+        std::vector<uint8_t> data(size);
+        for (auto& byte : data)
+            byte = rand() % 256;
+        LzCompress(data, compressed);
+        BOOST_REQUIRE(LzDecompress(compressed, data.size(), decompressed));
+        BOOST_CHECK_EQUAL_COLLECTIONS(decompressed.begin(), decompressed.end(), data.begin(), data.end());
+    }
+}
+
+BOOST_AUTO_TEST_CASE(TestLzMalformed)
+{
+    std::vector<uint8_t> out;
+    // Match offset pointing before the start of the output.
+    BOOST_CHECK(!LzDecompress({0x10, 'a', 0x05, 0x00}, 16, out));
+    // Truncated literals.
+    BOOST_CHECK(!LzDecompress({0x50, 'a', 'b'}, 16, out));
+    // Long match expanding past the expected size.
+    std::vector<uint8_t> bomb = {0x1F, 'a', 0x01, 0x00};
+    bomb.insert(bomb.end(), 64, 0xFF);
+    bomb.push_back(0x00);
+    BOOST_CHECK(!LzDecompress(bomb, 1024, out));
+    BOOST_CHECK(LzDecompress(bomb, 1 + 15 + 64 * 255 + 4, out));
+    BOOST_CHECK_EQUAL(out.size(), 1 + 15 + 64 * 255 + 4);
+    // Literals past the expected size.
+    BOOST_CHECK(!LzDecompress({0x30, 'a', 'b', 'c'}, 2, out));
+}
+
+BOOST_AUTO_TEST_CASE(TestZlibRoundTrip)
+{
+    std::vector<int32_t> layer(128 * 128, -1);
+    for (size_t i = 0; i < layer.size(); i += 5)
+        layer[i] = rand() % 64;
+
+    std::vector<uint8_t> raw;
+    PackLittleEndian(layer, raw);
+
+    for (bool gzip : {false, true})
+    {
+        std::vector<uint8_t> compressed;
+        ZlibCompress(raw.data(), raw.size(), compressed, gzip);
+        BOOST_CHECK(compressed.size() < raw.size());
+        BOOST_CHECK_EQUAL(compressed[0], gzip ? 0x1f : 0x78);
+
+        std::vector<uint8_t> decompressed;
+        BOOST_REQUIRE(ZlibDecompress(compressed, decompressed));
+        BOOST_CHECK_EQUAL_COLLECTIONS(decompressed.begin(), decompressed.end(), raw.begin(), raw.end());
+
+        // Truncated data fails.
+        compressed.resize(compressed.size() / 2);
+        BOOST_CHECK(!ZlibDecompress(compressed, decompressed));
+    }
+
+    std::vector<uint8_t> empty, compressed, decompressed;
+    ZlibCompress(empty.data(), 0, compressed);
+    BOOST_REQUIRE(ZlibDecompress(compressed, decompressed));
+    BOOST_CHECK(decompressed.empty());
+    BOOST_CHECK(!ZlibDecompress({'n', 'o', 'p', 'e'}, decompressed));
+}
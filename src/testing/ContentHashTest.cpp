@@ -0,0 +1,136 @@
+/******************************************************************************************************
+ * Tile Map Editor
+ * Copyright (C) 2009-2017 Brandon Whitehead (tricksterguy87[AT]gmail[DOT]com)
+ *
+ * This software is provided 'as-is', without any express or implied warranty.
+ * In no event will the authors be held liable for any damages arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * excluding commercial applications, and to alter it and redistribute it freely,
+ * subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented;
+ *    you must not claim that you wrote the original software.
+ *    An acknowledgement in your documentation and link to the original version is required.
+ *
+ * 2. Altered source versions must be plainly marked as such,
+ *    and must not be misrepresented as being the original software.
+ *
+ * 3. This notice may not be removed or altered from any source distribution.
+ ******************************************************************************************************/
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/auto_unit_test.hpp>
+#include <vector>
+#include "Map.hpp"
+#include "PixelBasedCollisionLayer.hpp"
+#include "TileBasedCollisionLayer.hpp"
+
+namespace
+{
+
+Map MakeMap()
+{
+    Map map("Test");
+    map.SetTileset(Tileset("tileset.png", 8, 8));
+    map.Add(AnimatedTile("Water", 10, AnimatedTile::Normal, -1, {1, 2, 3}));
+
+    std::vector<int32_t> data(40 * 20);
+    for (uint32_t i = 0; i < data.size(); i++)
+        data[i] = i % 7;
+    map.Add(Layer("Ground", 40, 20, data));
+    map.Add(Background("Sky", "sky.png", Background::Camera, 1.5f, 0));
+    map.SetCollisionLayer(new TileBasedCollisionLayer(40, 20));
+    return map;
+}
+
+}
+
+BOOST_AUTO_TEST_CASE(TestMapContentHashStable)
+{
+    Map a = MakeMap();
+    Map b = MakeMap();
+    BOOST_CHECK_EQUAL(a.ContentHash(), b.ContentHash());
+    BOOST_CHECK_EQUAL(a.ContentHash(), a.ContentHash());
+}
+
+BOOST_AUTO_TEST_CASE(TestMapContentHashChanges)
+{
+    const uint64_t original = MakeMap().ContentHash();
+
+    Map map = MakeMap();
+    map.GetLayer(0)[25] = 100;
+    BOOST_CHECK_NE(map.ContentHash(), original);
+
+    map = MakeMap();
+    map.GetLayer(0).SetOpacity(50);
+    BOOST_CHECK_NE(map.ContentHash(), original);
+
+    map = MakeMap();
+    map.GetLayer(0).SetName("Ground2");
+    BOOST_CHECK_NE(map.ContentHash(), original);
+
+    map = MakeMap();
+    map.GetBackground(0).SetSpeed(1.5f, 1);
+    BOOST_CHECK_NE(map.ContentHash(), original);
+
+    map = MakeMap();
+    map.Add(AnimatedTile("Lava", 10, AnimatedTile::Normal, -1, {4, 5}));
+    BOOST_CHECK_NE(map.ContentHash(), original);
+
+    map = MakeMap();
+    map.SetCollisionLayer(new PixelBasedCollisionLayer({Rectangle(0, 0, 8, 8)}));
+    BOOST_CHECK_NE(map.ContentHash(), original);
+
+    map = MakeMap();
+    map.SetCollisionLayer(nullptr);
+    BOOST_CHECK_NE(map.ContentHash(), original);
+}
+
+BOOST_AUTO_TEST_CASE(TestLayerHashDimensions)
+{
+    // Same tiles in a different shape must not hash the same.
+    std::vector<int32_t> data(16, 3);
+    BOOST_CHECK_NE(TiledLayerData(4, 4, data).ContentHash(), TiledLayerData(8, 2, data).ContentHash());
+}
+
+BOOST_AUTO_TEST_CASE(TestChunkHashes)
+{
+    // 40x20 is 3x2 chunks with the last column and row clipped.
+    TiledLayerData layer(40, 20);
+    std::vector<uint64_t> before;
+    layer.GetChunkHashes(before);
+    BOOST_REQUIRE_EQUAL(before.size(), 6);
+
+    layer.Set(35, 18, 5);
+    std::vector<uint64_t> after;
+    layer.GetChunkHashes(after);
+    BOOST_REQUIRE_EQUAL(after.size(), 6);
+    for (uint32_t i = 0; i < 6; i++)
+    {
+        if (i == 5)
+            BOOST_CHECK_NE(before[i], after[i]);
+        else
+            BOOST_CHECK_EQUAL(before[i], after[i]);
+    }
+    BOOST_CHECK_EQUAL(after[5], layer.ChunkHash(2, 1));
+    BOOST_CHECK_THROW(layer.ChunkHash(3, 0), const char*);
+    BOOST_CHECK_THROW(layer.ChunkHash(0, 2), const char*);
+}
+
+BOOST_AUTO_TEST_CASE(TestTileBasedCollisionLayerEquality)
+{
+    std::vector<int32_t> data(16, 0);
+    const TileBasedCollisionLayer a(4, 4, data);
+    TileBasedCollisionLayer b(4, 4, data);
+    BOOST_CHECK(a == b);
+    BOOST_CHECK_EQUAL(a.ContentHash(), b.ContentHash());
+
+    b.Set(3, 3, -1);
+    BOOST_CHECK(a != b);
+    BOOST_CHECK_NE(a.ContentHash(), b.ContentHash());
+
+    // Only one dimension differing used to compare equal.
+    const TileBasedCollisionLayer c(4, 2, std::vector<int32_t>(8, 0));
+    const TileBasedCollisionLayer d(4, 4, std::vector<int32_t>(16, 0));
+    BOOST_CHECK(c != d);
+}
@@ -0,0 +1,166 @@
+/******************************************************************************************************
+ * Tile Map Editor
+ * Copyright (C) 2009-2017 Brandon Whitehead (tricksterguy87[AT]gmail[DOT]com)
+ *
+ * This software is provided 'as-is', without any express or implied warranty.
+ * In no event will the authors be held liable for any damages arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * excluding commercial applications, and to alter it and redistribute it freely,
+ * subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented;
+ *    you must not claim that you wrote the original software.
+ *    An acknowledgement in your documentation and link to the original version is required.
+ *
+ * 2. Altered source versions must be plainly marked as such,
+ *    and must not be misrepresented as being the original software.
+ *
+ * 3. This notice may not be removed or altered from any source distribution.
+ ******************************************************************************************************/
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/auto_unit_test.hpp>
+#include <cstdlib>
+#include "DerivedCollision.hpp"
+#include "Map.hpp"
+#include "TileBasedCollisionLayer.hpp"
+
+namespace
+{
+
+const int32_t NO_EAST = DirectionBasedCollisionLayer::ALL_DIRECTIONS & ~DirectionBasedCollisionLayer::Bit(DirectionBasedCollisionLayer::East);
+
+/** Map of 8x8 tiles where tile 1 is blocked, tile 2 is walled on its east side and tile 3 has its bottom half solid */
+Map CollisionMap(uint32_t width, uint32_t height)
+{
+    Map map;
+    map.GetTileset().SetTileDimensions(8, 8);
+    TileCollision& collision = map.GetTileset().GetTileCollision();
+    collision.SetBlocked(1, true);
+    collision.SetDirections(2, NO_EAST);
+    collision.SetRectangles(3, {Rectangle(0, 4, 8, 4)});
+    map.Add(Layer("ground", width, height, std::vector<int32_t>(width * height, 0)));
+    map.Add(Layer("objects", width, height));
+    return map;
+}
+
+bool SameCollision(const DerivedCollision& a, const DerivedCollision& b)
+{
+    if (!(a.GetTiles() == b.GetTiles()) || a.GetChunksWide() != b.GetChunksWide() || a.GetChunksHigh() != b.GetChunksHigh())
+        return false;
+    for (uint32_t y = 0; y < a.GetChunksHigh(); y++)
+    {
+        for (uint32_t x = 0; x < a.GetChunksWide(); x++)
+        {
+            if (a.GetRectangles(x, y) != b.GetRectangles(x, y))
+                return false;
+        }
+    }
+    return true;
+}
+
+}
+
+BOOST_AUTO_TEST_CASE(TestDerivedCollisionCombinesLayers)
+{
+    Map map = CollisionMap(20, 20);
+    Layer& objects = map.GetLayer(1);
+    objects.Set(2, 2, 1);
+    objects.Set(5, 5, 2);
+    objects.Set(17, 17, 3);
+    map.SetCollisionLayer(new TileBasedCollisionLayer(20, 20, std::vector<int32_t>(400, 0)));
+    dynamic_cast<TileBasedCollisionLayer*>(map.GetCollisionLayer())->Set(9, 9, -1);
+
+    DerivedCollision collision(map);
+    BOOST_CHECK(collision.IsBlocked(2, 2));
+    BOOST_CHECK(collision.IsBlocked(9, 9));
+    BOOST_CHECK(!collision.IsBlocked(5, 5));
+    BOOST_CHECK(!collision.CanMove(5, 5, DirectionBasedCollisionLayer::East));
+    BOOST_CHECK(!collision.CanMove(6, 5, DirectionBasedCollisionLayer::West));
+    BOOST_CHECK(collision.CanMove(5, 5, DirectionBasedCollisionLayer::North));
+    BOOST_CHECK(!collision.CanMove(1, 2, DirectionBasedCollisionLayer::East));
+
+    // Pixel queries, the rectangle of tile 3 at (17, 17) covers pixels (136, 140) to (144, 144).
+    BOOST_CHECK(collision.Collides(20, 20));
+    BOOST_CHECK(!collision.Collides(28, 20));
+    BOOST_CHECK(collision.Collides(140, 141));
+    BOOST_CHECK(!collision.Collides(140, 139));
+    BOOST_CHECK(collision.Overlaps({130, 130, 8, 11}));
+    BOOST_CHECK(!collision.Overlaps({130, 130, 5, 9}));
+    BOOST_CHECK_EQUAL(collision.GetRectangles(1, 1).size(), 1u);
+    BOOST_CHECK(collision.GetRectangles(1, 1)[0] == Rectangle(136, 140, 8, 4));
+    BOOST_CHECK(collision.GetRectangles(0, 0).empty());
+
+    // Animated tiles use their first frame.
+    map.Add(AnimatedTile("blocked", 1, AnimatedTile::Normal, -1, {1, 0}));
+    objects.Set(12, 3, 1u << 31);
+    collision.Update(map, Rectangle(12, 3, 1, 1));
+    BOOST_CHECK(collision.IsBlocked(12, 3));
+}
+
+BOOST_AUTO_TEST_CASE(TestDerivedCollisionUpdate)
+{
+    Map map = CollisionMap(50, 37);
+    DerivedCollision collision(map);
+    srand(17);
+    for (int edit = 0; edit < 200; edit++)
+    {
+        Layer& layer = map.GetLayer(rand() % 2);
+        Rectangle area(rand() % 50, rand() % 37, 1 + rand() % 4, 1 + rand() % 4);
+        for (int32_t y = area.y; y < std::min(area.y + area.height, 37); y++)
+        {
+            for (int32_t x = area.x; x < std::min(area.x + area.width, 50); x++)
+                layer.Set(x, y, rand() % 5 - 1);
+        }
+
+        // Batch some edits before refreshing.
+        collision.Invalidate(area);
+        BOOST_CHECK(collision.IsDirty());
+        if (edit % 3 == 0)
+        {
+            collision.Refresh(map);
+            BOOST_REQUIRE(!collision.IsDirty());
+            BOOST_REQUIRE(SameCollision(collision, DerivedCollision(map)));
+        }
+    }
+
+    // Resizing rebuilds everything.
+    map.GetLayer(0).Resize(60, 40);
+    collision.Update(map, Rectangle(0, 0, 1, 1));
+    BOOST_CHECK_EQUAL(collision.GetWidth(), 60u);
+    BOOST_CHECK(SameCollision(collision, DerivedCollision(map)));
+}
+
+BOOST_AUTO_TEST_CASE(TestDerivedCollisionRefreshLayers)
+{
+    Map map = CollisionMap(20, 10);
+    DerivedCollision collision(map);
+
+    // Adding a layer rebuilds without any Invalidate.
+    Layer walls("walls", 20, 10, std::vector<int32_t>(20 * 10, 0));
+    walls.Set(4, 5, 1);
+    map.Add(walls);
+    collision.Refresh(map);
+    BOOST_CHECK(collision.IsBlocked(4, 5));
+    BOOST_CHECK(SameCollision(collision, DerivedCollision(map)));
+
+    // So does setting or replacing the collision layer.
+    TileBasedCollisionLayer* tiles = new TileBasedCollisionLayer(20, 10, std::vector<int32_t>(20 * 10, 0));
+    tiles->Set(7, 2, -1);
+    map.SetCollisionLayer(tiles);
+    collision.Refresh(map);
+    BOOST_CHECK(collision.IsBlocked(7, 2));
+    BOOST_CHECK(SameCollision(collision, DerivedCollision(map)));
+
+    std::vector<int32_t> directions(20 * 10, DirectionBasedCollisionLayer::ALL_DIRECTIONS);
+    directions[3 * 20 + 9] = NO_EAST;
+    map.SetCollisionLayer(new DirectionBasedCollisionLayer(20, 10, directions));
+    collision.Refresh(map);
+    BOOST_CHECK(!collision.IsBlocked(7, 2));
+    BOOST_CHECK(!collision.CanMove(9, 3, DirectionBasedCollisionLayer::East));
+    BOOST_CHECK(SameCollision(collision, DerivedCollision(map)));
+
+    map.SetCollisionLayer(nullptr);
+    collision.Refresh(map);
+    BOOST_CHECK(collision.CanMove(9, 3, DirectionBasedCollisionLayer::East));
+}
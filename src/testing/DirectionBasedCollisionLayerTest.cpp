@@ -0,0 +1,105 @@
+/******************************************************************************************************
+ * Tile Map Editor
+ * Copyright (C) 2009-2017 Brandon Whitehead (tricksterguy87[AT]gmail[DOT]com)
+ *
+ * This software is provided 'as-is', without any express or implied warranty.
+ * In no event will the authors be held liable for any damages arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * excluding commercial applications, and to alter it and redistribute it freely,
+ * subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented;
+ *    you must not claim that you wrote the original software.
+ *    An acknowledgement in your documentation and link to the original version is required.
+ *
+ * 2. Altered source versions must be plainly marked as such,
+ *    and must not be misrepresented as being the original software.
+ *
+ * 3. This notice may not be removed or altered from any source distribution.
+ ******************************************************************************************************/
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/auto_unit_test.hpp>
+#include "DirectionBasedCollisionLayer.hpp"
+
+namespace
+{
+
+const int32_t N = 1 << DirectionBasedCollisionLayer::North;
+const int32_t E = 1 << DirectionBasedCollisionLayer::East;
+const int32_t S = 1 << DirectionBasedCollisionLayer::South;
+const int32_t W = 1 << DirectionBasedCollisionLayer::West;
+
+}
+
+BOOST_AUTO_TEST_CASE(TestDirectionCanMove)
+{
+    // 3x2 layer
+    // [E   ] [E|W ] [W|S]
+    // [all ] [0   ] [N  ]
+    DirectionBasedCollisionLayer layer(3, 2, {E, E | W, W | S, N | E | S | W, 0, N});
+
+    BOOST_CHECK(layer.CanMove(0, 0, DirectionBasedCollisionLayer::East));
+    BOOST_CHECK(layer.CanMove(1, 0, DirectionBasedCollisionLayer::West));
+    BOOST_CHECK(layer.CanMove(2, 0, DirectionBasedCollisionLayer::South));
+    BOOST_CHECK(layer.CanMove(2, 1, DirectionBasedCollisionLayer::North));
+    // Tile (0, 0) can't be left going south and (0, 1) can't be entered from the south of (0, 0).
+    BOOST_CHECK(!layer.CanMove(0, 0, DirectionBasedCollisionLayer::South));
+    // (0, 1) allows leaving north but (0, 0) doesn't allow entering from the south.
+    BOOST_CHECK(!layer.CanMove(0, 1, DirectionBasedCollisionLayer::North));
+    // (1, 1) blocks everything.
+    BOOST_CHECK(!layer.CanMove(0, 1, DirectionBasedCollisionLayer::East));
+    // Edges of the layer.
+    BOOST_CHECK(!layer.CanMove(0, 1, DirectionBasedCollisionLayer::West));
+    BOOST_CHECK(!layer.CanMove(0, 1, DirectionBasedCollisionLayer::South));
+    BOOST_CHECK(!layer.CanMove(3, 0, DirectionBasedCollisionLayer::West));
+}
+
+BOOST_AUTO_TEST_CASE(TestDirectionNullTilePassable)
+{
+    DirectionBasedCollisionLayer layer(4, 4);
+    BOOST_CHECK_EQUAL(layer.GetType(), CollisionLayer::DirectionBased);
+    for (uint32_t y = 0; y < 4; y++)
+    {
+        for (uint32_t x = 0; x < 4; x++)
+        {
+            BOOST_CHECK_EQUAL(layer.CanMove(x, y, DirectionBasedCollisionLayer::East), x < 3);
+            BOOST_CHECK_EQUAL(layer.CanMove(x, y, DirectionBasedCollisionLayer::North), y > 0);
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(TestDirectionValidateMoves)
+{
+    DirectionBasedCollisionLayer layer(4, 4);
+    // Wall between columns 1 and 2 except on the bottom row.
+    for (uint32_t y = 0; y < 3; y++)
+    {
+        layer.Set(1, y, N | S | W);
+        layer.Set(2, y, N | E | S);
+    }
+
+    const uint8_t east = DirectionBasedCollisionLayer::East;
+    const uint8_t south = DirectionBasedCollisionLayer::South;
+    const uint8_t north = DirectionBasedCollisionLayer::North;
+    std::vector<uint8_t> blocked = {east, east, east};
+    BOOST_CHECK_EQUAL(layer.ValidateMoves(0, 0, blocked), 1u);
+
+    std::vector<uint8_t> around = {east, south, south, south, east, east, north, north, north};
+    BOOST_CHECK_EQUAL(layer.ValidateMoves(0, 0, around), around.size());
+    BOOST_CHECK_EQUAL(layer.ValidateMoves(0, 0, around.data(), 4), 4u);
+
+    std::vector<uint8_t> off_map = {south, south, south, south};
+    BOOST_CHECK_EQUAL(layer.ValidateMoves(0, 0, off_map), 3u);
+    std::vector<uint8_t> invalid = {south, 7};
+    BOOST_CHECK_EQUAL(layer.ValidateMoves(0, 0, invalid), 1u);
+    BOOST_CHECK_EQUAL(layer.ValidateMoves(4, 0, invalid), 0u);
+    BOOST_CHECK_EQUAL(layer.ValidateMoves(0, 0, std::vector<uint8_t>()), 0u);
+}
+
+BOOST_AUTO_TEST_CASE(TestDirectionOpposite)
+{
+    BOOST_CHECK_EQUAL(DirectionBasedCollisionLayer::Opposite(DirectionBasedCollisionLayer::North), DirectionBasedCollisionLayer::South);
+    BOOST_CHECK_EQUAL(DirectionBasedCollisionLayer::Opposite(DirectionBasedCollisionLayer::West), DirectionBasedCollisionLayer::East);
+    BOOST_CHECK_EQUAL(DirectionBasedCollisionLayer::Bit(DirectionBasedCollisionLayer::West), W);
+}
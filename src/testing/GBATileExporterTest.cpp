@@ -0,0 +1,202 @@
+/******************************************************************************************************
+ * Tile Map Editor
+ * Copyright (C) 2009-2017 Brandon Whitehead (tricksterguy87[AT]gmail[DOT]com)
+ *
+ * This software is provided 'as-is', without any express or implied warranty.
+ * In no event will the authors be held liable for any damages arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * excluding commercial applications, and to alter it and redistribute it freely,
+ * subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented;
+ *    you must not claim that you wrote the original software.
+ *    An acknowledgement in your documentation and link to the original version is required.
+ *
+ * 2. Altered source versions must be plainly marked as such,
+ *    and must not be misrepresented as being the original software.
+ *
+ * 3. This notice may not be removed or altered from any source distribution.
+ ******************************************************************************************************/
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/auto_unit_test.hpp>
+#include "GBATileExporter.hpp"
+
+namespace
+{
+
+/** An RGBA image made of 8x8 tiles side by side */
+class TestTileset
+{
+public:
+    TestTileset(uint32_t tiles, uint32_t size = 8) : width(tiles * size), height(size), pixels(width * height * 4, 0) {}
+
+    void Set(uint32_t x, uint32_t y, uint8_t r, uint8_t g, uint8_t b)
+    {
+        uint8_t* pixel = &pixels[(y * width + x) * 4];
+        pixel[0] = r;
+        pixel[1] = g;
+        pixel[2] = b;
+        pixel[3] = 255;
+    }
+
+    /** Draws an L shape so flips can be told apart */
+    void DrawL(uint32_t tile, bool hflip, bool vflip)
+    {
+        for (uint32_t i = 0; i < 8; i++)
+        {
+            uint32_t x0 = hflip ? 7 : 0;
+            uint32_t y = vflip ? 7 - i : i;
+            Set(tile * 8 + x0, y, 255, 0, 0);
+            Set(tile * 8 + (hflip ? 7 - i : i), vflip ? 0 : 7, 0, 0, 255);
+        }
+    }
+
+    uint32_t width, height;
+    std::vector<uint8_t> pixels;
+};
+
+}
+
+BOOST_AUTO_TEST_CASE(GBATileExporterFlips)
+{
+    TestTileset tileset(4);
+    tileset.DrawL(0, false, false);
+    tileset.DrawL(1, true, false);
+    tileset.DrawL(2, false, true);
+    tileset.DrawL(3, true, true);
+
+    GBATileExporter exporter;
+    exporter.SetTileset(tileset.pixels.data(), tileset.width, tileset.height, 8, 8);
+    BOOST_REQUIRE(exporter.Add(Layer("Flips", 5, 1, {0, 1, 3, 2, -1})));
+    exporter.Finish();
+
+    // The blank tile and one L.
+    BOOST_CHECK_EQUAL(exporter.GetNumTiles(), 2);
+    const auto& entries = exporter.GetBackgrounds()[0].entries;
+    BOOST_CHECK_EQUAL(entries[0], 1);
+    BOOST_CHECK_EQUAL(entries[1], 1 | GBATileExporter::HFLIP);
+    BOOST_CHECK_EQUAL(entries[2], 1 | GBATileExporter::HFLIP | GBATileExporter::VFLIP);
+    BOOST_CHECK_EQUAL(entries[3], 1 | GBATileExporter::VFLIP);
+    BOOST_CHECK_EQUAL(entries[4], 0);
+}
+
+BOOST_AUTO_TEST_CASE(GBATileExporterScreenblocks)
+{
+    TestTileset tileset(2);
+    tileset.DrawL(1, false, false);
+
+    GBATileExporter exporter;
+    exporter.SetTileset(tileset.pixels.data(), tileset.width, tileset.height, 8, 8);
+    Layer layer("Wide", 40, 8);
+    layer.Set(35, 1, 1);
+    layer.Set(2, 7, 1);
+    exporter.Add(layer);
+    exporter.Finish();
+
+    const auto& background = exporter.GetBackgrounds()[0];
+    BOOST_CHECK(!background.affine);
+    BOOST_CHECK_EQUAL(background.width, 64);
+    BOOST_CHECK_EQUAL(background.height, 32);
+    BOOST_REQUIRE_EQUAL(background.entries.size(), 2 * 32 * 32);
+    BOOST_CHECK_EQUAL(background.entries[1024 + 1 * 32 + 3], 1);
+    BOOST_CHECK_EQUAL(background.entries[7 * 32 + 2], 1);
+    BOOST_CHECK_EQUAL(std::count(background.entries.begin(), background.entries.end(), 1), 2);
+}
+
+BOOST_AUTO_TEST_CASE(GBATileExporter4bpp)
+{
+    // Two tiles with different colors get different palette banks once they do not fit in one.
+    TestTileset tileset(2);
+    for (uint32_t i = 0; i < 15; i++)
+    {
+        tileset.Set(i % 8, i / 8, i * 8, 0, 0);
+        tileset.Set(8 + i % 8, i / 8, 0, i * 8, 0);
+    }
+
+    GBATileExporter exporter(0, GBATileExporter::Bpp4);
+    exporter.SetTileset(tileset.pixels.data(), tileset.width, tileset.height, 8, 8);
+    exporter.Add(Layer("Colors", 2, 1, {0, 1}));
+    exporter.Finish();
+
+    BOOST_REQUIRE_EQUAL(exporter.GetNumTiles(), 3);
+    BOOST_CHECK_EQUAL(exporter.GetPalette().size(), 32);
+    const auto& entries = exporter.GetBackgrounds()[0].entries;
+    BOOST_CHECK_EQUAL(entries[0] >> GBATileExporter::PALETTE_SHIFT, 0);
+    BOOST_CHECK_EQUAL(entries[1] >> GBATileExporter::PALETTE_SHIFT, 1);
+
+    // 32 bytes per tile, the left pixel of each pair is the low nibble.
+    const auto& tiles = exporter.GetTiles();
+    BOOST_REQUIRE_EQUAL(tiles.size(), 3 * 32);
+    const uint8_t* first = &tiles[32];
+    const auto& palette = exporter.GetPalette();
+    BOOST_CHECK_EQUAL(palette[first[0] & 0xF], GBATileExporter::ToBGR555(0, 0, 0));
+    BOOST_CHECK_EQUAL(palette[first[0] >> 4], GBATileExporter::ToBGR555(8, 0, 0));
+    BOOST_CHECK_EQUAL(palette[first[7] & 0xF], GBATileExporter::ToBGR555(112, 0, 0));
+    BOOST_CHECK_EQUAL(first[7] >> 4, 0);
+    BOOST_CHECK_EQUAL(first[8], 0);
+}
+
+BOOST_AUTO_TEST_CASE(GBATileExporterAffine)
+{
+    TestTileset tileset(2);
+    tileset.DrawL(0, false, false);
+    tileset.DrawL(1, true, false);
+
+    // Mode 2 only has affine backgrounds which can not flip tiles.
+    GBATileExporter exporter(2, GBATileExporter::Bpp4);
+    exporter.SetTileset(tileset.pixels.data(), tileset.width, tileset.height, 8, 8);
+    BOOST_CHECK_EQUAL(exporter.GetBpp(), GBATileExporter::Bpp8);
+    BOOST_CHECK(exporter.Add(Layer("A", 20, 3, std::vector<int32_t>(60, 1))));
+    BOOST_CHECK(exporter.Add(Layer("B", 2, 1, {0, 1})));
+    BOOST_CHECK(!exporter.Add(Layer("C", 1, 1)));
+    exporter.Finish();
+
+    BOOST_CHECK_EQUAL(exporter.GetNumTiles(true), 3);
+    BOOST_CHECK_EQUAL(exporter.GetTiles(true).size(), 3 * 64);
+    BOOST_CHECK_EQUAL(exporter.GetPalette().size(), 3);
+    const auto& background = exporter.GetBackgrounds()[0];
+    BOOST_CHECK(background.affine);
+    BOOST_CHECK_EQUAL(background.width, 32);
+    BOOST_CHECK_EQUAL(background.entries[2 * 32 + 19], 1);
+    BOOST_CHECK_EQUAL(background.entries[3 * 32], 0);
+    BOOST_CHECK_EQUAL(exporter.GetBackgrounds()[1].width, 16);
+}
+
+BOOST_AUTO_TEST_CASE(GBATileExporterLargeTiles)
+{
+    // A 16x16 map tile becomes 2x2 hardware tiles.
+    TestTileset tileset(1, 16);
+    tileset.DrawL(0, false, false);
+    tileset.DrawL(1, true, false);
+
+    GBATileExporter exporter;
+    exporter.SetTileset(tileset.pixels.data(), tileset.width, tileset.height, 16, 16);
+    exporter.Add(Layer("Big", 2, 1, {0, -1}));
+    exporter.Finish();
+
+    BOOST_CHECK_EQUAL(exporter.GetNumTiles(), 2);
+    const auto& entries = exporter.GetBackgrounds()[0].entries;
+    BOOST_CHECK_EQUAL(entries[0], 1);
+    BOOST_CHECK_EQUAL(entries[1], 1 | GBATileExporter::HFLIP);
+    BOOST_CHECK_EQUAL(entries[32], 0);
+    BOOST_CHECK_EQUAL(entries[2], 0);
+
+    BOOST_CHECK_THROW(exporter.SetTileset(tileset.pixels.data(), tileset.width, tileset.height, 12, 12), const char*);
+}
+
+BOOST_AUTO_TEST_CASE(GBATileExporterRegularSizes)
+{
+    TestTileset tileset(1);
+    tileset.DrawL(0, false, false);
+
+    // Regular backgrounds are padded to 32 or 64 tiles per axis, there is no 96 wide background.
+    GBATileExporter exporter;
+    exporter.SetTileset(tileset.pixels.data(), tileset.width, tileset.height, 8, 8);
+    BOOST_CHECK(exporter.Add(Layer("A", 40, 20)));
+    BOOST_CHECK_EQUAL(exporter.GetBackgrounds()[0].width, 64);
+    BOOST_CHECK_EQUAL(exporter.GetBackgrounds()[0].height, 32);
+    BOOST_CHECK_EQUAL(exporter.GetBackgrounds()[0].entries.size(), 64 * 32);
+    BOOST_CHECK_THROW(exporter.Add(Layer("B", 65, 1)), const char*);
+    BOOST_CHECK_THROW(exporter.Add(Layer("C", 1, 70)), const char*);
+}
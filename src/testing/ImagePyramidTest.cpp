@@ -0,0 +1,169 @@
+/******************************************************************************************************
+ * Tile Map Editor
+ * Copyright (C) 2009-2017 Brandon Whitehead (tricksterguy87[AT]gmail[DOT]com)
+ *
+ * This software is provided 'as-is', without any express or implied warranty.
+ * In no event will the authors be held liable for any damages arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * excluding commercial applications, and to alter it and redistribute it freely,
+ * subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented;
+ *    you must not claim that you wrote the original software.
+ *    An acknowledgement in your documentation and link to the original version is required.
+ *
+ * 2. Altered source versions must be plainly marked as such,
+ *    and must not be misrepresented as being the original software.
+ *
+ * 3. This notice may not be removed or altered from any source distribution.
+ ******************************************************************************************************/
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/auto_unit_test.hpp>
+#include <map>
+#include <mutex>
+#include <stdexcept>
+#include <tuple>
+#include "ImagePyramid.hpp"
+
+namespace
+{
+
+typedef std::tuple<uint32_t, uint32_t, uint32_t> TileKey;
+
+/** Collects the tiles passed to the callback */
+class TileCollector
+{
+public:
+    ImagePyramid::TileCallback Callback()
+    {
+        return [this](uint32_t zoom, uint32_t x, uint32_t y, const std::vector<uint8_t>& rgba)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            BOOST_CHECK(tiles.find(TileKey(zoom, x, y)) == tiles.end());
+            tiles[TileKey(zoom, x, y)] = rgba;
+        };
+    }
+
+    std::map<TileKey, std::vector<uint8_t>> tiles;
+
+private:
+    std::mutex mutex;
+};
+
+/** Two 8x8 tiles, opaque white and opaque black */
+std::vector<uint8_t> Tileset()
+{
+    std::vector<uint8_t> rgba(16 * 8 * 4, 0);
+    for (uint32_t y = 0; y < 8; y++)
+    {
+        for (uint32_t x = 0; x < 8; x++)
+        {
+            uint8_t* pixel = &rgba[(y * 16 + x) * 4];
+            pixel[0] = pixel[1] = pixel[2] = 255;
+            pixel[3] = 255;
+            rgba[(y * 16 + x + 8) * 4 + 3] = 255;
+        }
+    }
+    return rgba;
+}
+
+/** A checkerboard of the two tiles */
+Layer Checkerboard(uint32_t width, uint32_t height)
+{
+    std::vector<int32_t> data(width * height);
+    for (uint32_t i = 0; i < data.size(); i++)
+        data[i] = (i % width + i / width) % 2;
+    return Layer("", width, height, data);
+}
+
+}
+
+BOOST_AUTO_TEST_CASE(TestPyramidLevels)
+{
+    // 40x24 pixels with 16 pixel image tiles, so 3x2 full size tiles and zoom levels 0-2.
+    std::vector<uint8_t> tileset = Tileset();
+    TileCompositor compositor(tileset.data(), 16, 8, 8, 8);
+    std::vector<Layer> layers(1, Checkerboard(5, 3));
+    ImagePyramid pyramid(compositor, layers, 16);
+    BOOST_CHECK_EQUAL(pyramid.GetWidth(), 40);
+    BOOST_CHECK_EQUAL(pyramid.GetHeight(), 24);
+    BOOST_REQUIRE_EQUAL(pyramid.GetMaxZoom(), 2);
+
+    TileCollector collector;
+    pyramid.Render(collector.Callback(), true, 3);
+    BOOST_CHECK_EQUAL(collector.tiles.size(), 6 + 2 + 1);
+    BOOST_REQUIRE(collector.tiles.count(TileKey(2, 2, 1)));
+    BOOST_REQUIRE(collector.tiles.count(TileKey(1, 0, 0)));
+    BOOST_REQUIRE(collector.tiles.count(TileKey(0, 0, 0)));
+
+    // Full size tile (2, 1) has map pixels 32-39 by 16-23 then padding.
+    const std::vector<uint8_t>& corner = collector.tiles[TileKey(2, 2, 1)];
+    BOOST_CHECK_EQUAL(corner[3], 255);
+    BOOST_CHECK_EQUAL(corner[0], 255);
+    BOOST_CHECK_EQUAL(corner[8 * 4 + 3], 0);
+
+    // Each zoomed out pixel averages a 2x2 block inside one map tile.
+    const std::vector<uint8_t>& zoomed = collector.tiles[TileKey(1, 0, 0)];
+    BOOST_CHECK_EQUAL(zoomed[0], 255);
+    BOOST_CHECK_EQUAL(zoomed[4 * 4], 0);
+    BOOST_CHECK_EQUAL(zoomed[4 * 4 + 3], 255);
+    // Partly covered pixels are not darkened by the transparent padding.
+    const std::vector<uint8_t>& top = collector.tiles[TileKey(0, 0, 0)];
+    BOOST_CHECK_EQUAL(top[(0 * 16 + 5) * 4 + 3], 255);
+    BOOST_CHECK_EQUAL(top[(0 * 16 + 10) * 4 + 3], 0);
+}
+
+BOOST_AUTO_TEST_CASE(TestPyramidSingleThreadMatches)
+{
+    std::vector<uint8_t> tileset = Tileset();
+    TileCompositor compositor(tileset.data(), 16, 8, 8, 8);
+    std::vector<Layer> layers(1, Checkerboard(37, 21));
+    ImagePyramid pyramid(compositor, layers, 32);
+
+    TileCollector serial, parallel;
+    pyramid.Render(serial.Callback(), true, 1);
+    pyramid.Render(parallel.Callback(), true, 4);
+    BOOST_CHECK(serial.tiles == parallel.tiles);
+    BOOST_CHECK_EQUAL(serial.tiles.size(), 10 * 6 + 5 * 3 + 3 * 2 + 2 + 1);
+}
+
+BOOST_AUTO_TEST_CASE(TestPyramidRegion)
+{
+    std::vector<uint8_t> tileset = Tileset();
+    TileCompositor compositor(tileset.data(), 16, 8, 8, 8);
+    std::vector<Layer> layers(1, Checkerboard(64, 64));
+    ImagePyramid pyramid(compositor, layers, 64);
+    BOOST_REQUIRE_EQUAL(pyramid.GetMaxZoom(), 3);
+
+    // Straddles full size tiles (1, 1) to (2, 1).
+    pyramid.SetRegion(100, 70, 50, 20);
+    TileCollector full;
+    pyramid.Render(full.Callback(), false);
+    BOOST_CHECK_EQUAL(full.tiles.size(), 2);
+    BOOST_CHECK(full.tiles.count(TileKey(3, 1, 1)));
+    BOOST_CHECK(full.tiles.count(TileKey(3, 2, 1)));
+
+    TileCollector levels;
+    pyramid.Render(levels.Callback(), true);
+    BOOST_CHECK_EQUAL(levels.tiles.size(), 2 + 2 + 1 + 1);
+    BOOST_CHECK(levels.tiles.count(TileKey(2, 1, 0)));
+}
+
+BOOST_AUTO_TEST_CASE(TestPyramidErrors)
+{
+    std::vector<uint8_t> tileset = Tileset();
+    TileCompositor compositor(tileset.data(), 16, 8, 8, 8);
+    std::vector<Layer> layers(1, Checkerboard(16, 16));
+    BOOST_CHECK_THROW(ImagePyramid(compositor, layers, 15), const char*);
+
+    // Any exception from the callback reaches the caller whichever thread it was thrown on.
+    ImagePyramid pyramid(compositor, layers, 16);
+    auto callback = [&pyramid](uint32_t zoom, uint32_t, uint32_t, const std::vector<uint8_t>&)
+    {
+        if (zoom == pyramid.GetMaxZoom())
+            throw std::runtime_error("callback failed");
+    };
+    BOOST_CHECK_THROW(pyramid.Render(callback, true, 4), std::runtime_error);
+    BOOST_CHECK_THROW(pyramid.Render(callback, false, 1), std::runtime_error);
+}
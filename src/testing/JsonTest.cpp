@@ -0,0 +1,91 @@
+/******************************************************************************************************
+ * Tile Map Editor
+ * Copyright (C) 2009-2017 Brandon Whitehead (tricksterguy87[AT]gmail[DOT]com)
+ *
+ * This software is provided 'as-is', without any express or implied warranty.
+ * In no event will the authors be held liable for any damages arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * excluding commercial applications, and to alter it and redistribute it freely,
+ * subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented;
+ *    you must not claim that you wrote the original software.
+ *    An acknowledgement in your documentation and link to the original version is required.
+ *
+ * 2. Altered source versions must be plainly marked as such,
+ *    and must not be misrepresented as being the original software.
+ *
+ * 3. This notice may not be removed or altered from any source distribution.
+ ******************************************************************************************************/
+#define BOOST_TEST_DYN_LINK
+#include <sstream>
+#include <boost/test/auto_unit_test.hpp>
+#include "Json.hpp"
+
+BOOST_AUTO_TEST_CASE(JsonParse)
+{
+    JsonValue value = JsonValue::Parse(
+        "{\"name\": \"A\\\"\\u00e9\\ud83d\\ude00\", \"numbers\": [1, -2.5, 3e2, 0.1], \"mixed\": [1, \"two\", null],"
+        " \"nested\": {\"flag\": true, \"empty\": []}}");
+
+    BOOST_REQUIRE(value.IsObject());
+    BOOST_CHECK_EQUAL(value.Size(), 4);
+    BOOST_CHECK_EQUAL(value.Get("name").AsString(), "A\"\xC3\xA9\xF0\x9F\x98\x80");
+
+    const JsonValue& numbers = value.Get("numbers");
+    BOOST_CHECK_EQUAL(numbers.GetType(), JsonValue::NumberArray);
+    std::vector<double> expected = {1, -2.5, 300, 0.1};
+    BOOST_CHECK_EQUAL_COLLECTIONS(numbers.GetNumbers().begin(), numbers.GetNumbers().end(), expected.begin(), expected.end());
+
+    const JsonValue& mixed = value.Get("mixed");
+    BOOST_CHECK_EQUAL(mixed.GetType(), JsonValue::Array);
+    BOOST_REQUIRE_EQUAL(mixed.Size(), 3);
+    BOOST_CHECK_EQUAL(mixed.GetElements()[0].AsInt(), 1);
+    BOOST_CHECK_EQUAL(mixed.GetElements()[1].AsString(), "two");
+    BOOST_CHECK(mixed.GetElements()[2].IsNull());
+
+    BOOST_CHECK(value.Get("nested").Get("flag").AsBool());
+    BOOST_CHECK(value.Get("nested").Get("empty").IsArray());
+    BOOST_CHECK(value.Get("missing").IsNull());
+    BOOST_CHECK(!value.Has("missing"));
+}
+
+BOOST_AUTO_TEST_CASE(JsonWriteRoundTrip)
+{
+    JsonValue value = JsonValue::Make(JsonValue::Object);
+    value.Set("name", "line\nbreak\t\x01");
+    value.Set("big", 4294967295u);
+    value.Set("fraction", 0.1);
+    value.Set("negative", -12);
+    JsonValue& numbers = value.Set("numbers", JsonValue::Make(JsonValue::NumberArray));
+    for (int i = 0; i < 100; i++)
+        numbers.Add(i * 7 - 50);
+    value.Set("list", JsonValue::Make(JsonValue::Array)).Add(JsonValue::Make(JsonValue::Object)).Set("x", false);
+
+    for (int indent : {0, 2})
+    {
+        std::stringstream out;
+        value.Write(out, indent);
+        JsonValue loaded = JsonValue::Parse(out);
+
+        BOOST_CHECK_EQUAL(loaded.Get("name").AsString(), "line\nbreak\t\x01");
+        BOOST_CHECK_EQUAL(loaded.Get("big").AsInt(), 4294967295LL);
+        BOOST_CHECK_EQUAL(loaded.Get("fraction").AsNumber(), 0.1);
+        BOOST_CHECK_EQUAL(loaded.Get("negative").AsInt(), -12);
+        const std::vector<double>& actual = loaded.Get("numbers").GetNumbers();
+        BOOST_CHECK_EQUAL_COLLECTIONS(actual.begin(), actual.end(), numbers.GetNumbers().begin(), numbers.GetNumbers().end());
+        BOOST_REQUIRE_EQUAL(loaded.Get("list").Size(), 1);
+        BOOST_CHECK(loaded.Get("list").GetElements()[0].Get("x").GetType() == JsonValue::Bool);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(JsonParseFail)
+{
+    BOOST_CHECK_THROW(JsonValue::Parse(""), const char*);
+    BOOST_CHECK_THROW(JsonValue::Parse("{\"a\": }"), const char*);
+    BOOST_CHECK_THROW(JsonValue::Parse("[1, 2,]"), const char*);
+    BOOST_CHECK_THROW(JsonValue::Parse("\"unterminated"), const char*);
+    BOOST_CHECK_THROW(JsonValue::Parse("{} trailing"), const char*);
+    BOOST_CHECK_THROW(JsonValue::Parse(std::string(10000, '[')), const char*);
+}
@@ -0,0 +1,185 @@
+/******************************************************************************************************
+ * Tile Map Editor
+ * Copyright (C) 2009-2017 Brandon Whitehead (tricksterguy87[AT]gmail[DOT]com)
+ *
+ * This software is provided 'as-is', without any express or implied warranty.
+ * In no event will the authors be held liable for any damages arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * excluding commercial applications, and to alter it and redistribute it freely,
+ * subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented;
+ *    you must not claim that you wrote the original software.
+ *    An acknowledgement in your documentation and link to the original version is required.
+ *
+ * 2. Altered source versions must be plainly marked as such,
+ *    and must not be misrepresented as being the original software.
+ *
+ * 3. This notice may not be removed or altered from any source distribution.
+ ******************************************************************************************************/
+#define BOOST_TEST_DYN_LINK
+#include <sstream>
+#include <boost/test/auto_unit_test.hpp>
+#include "BinaryMapHandler.hpp"
+#include "MapSource.hpp"
+#include "PixelBasedCollisionLayer.hpp"
+#include "ProtoMapHandler.hpp"
+#include "TextMapHandler.hpp"
+#include "TileBasedCollisionLayer.hpp"
+
+namespace
+{
+
+/** Generates tiles from their coordinates and checks they are requested in order */
+class GeneratedMapSource : public MapSource
+{
+public:
+    GeneratedMapSource(uint32_t _width, uint32_t _height) : width(_width), height(_height), next_layer(0), next_row(0), max_tiles(0) {}
+
+    std::string GetName() { return "Generated"; }
+    Tileset GetTileset()
+    {
+        Tileset tileset("tiles.png", 16, 16);
+        tileset.Add(AnimatedTile("Water", 4, AnimatedTile::Normal, -1, {1, 2, 3}));
+        return tileset;
+    }
+    uint32_t GetNumLayers() { return 2; }
+    LayerInfo GetLayerInfo(uint32_t index)
+    {
+        DrawAttributes attr(index);
+        attr.SetPosition(index * 8, 0);
+        return {index == 0 ? "Ground" : "Top", width, height, attr};
+    }
+    void GetLayerRows(uint32_t index, uint32_t row, uint32_t count, int32_t* tiles)
+    {
+        BOOST_REQUIRE_EQUAL(index, next_layer);
+        BOOST_REQUIRE_EQUAL(row, next_row);
+        next_row = row + count;
+        if (next_row == height)
+        {
+            next_layer++;
+            next_row = 0;
+        }
+        max_tiles = std::max(max_tiles, count * width);
+
+        for (uint32_t y = row; y < row + count; y++)
+            for (uint32_t x = 0; x < width; x++)
+                *tiles++ = Tile(index, x, y);
+    }
+    uint32_t GetNumBackgrounds() { return 1; }
+    Background GetBackground(uint32_t index) { return Background("Sky", "sky.png", Background::Camera, 1.0f, 0.0f); }
+    bool GetCollisionInfo(CollisionInfo& info)
+    {
+        info.type = CollisionLayer::TileBased;
+        info.width = width;
+        info.height = height;
+        return true;
+    }
+    void GetCollisionRows(uint32_t row, uint32_t count, int32_t* data)
+    {
+        for (uint32_t y = row; y < row + count; y++)
+            for (uint32_t x = 0; x < width; x++)
+                *data++ = (x + y) % 2;
+    }
+
+    static int32_t Tile(uint32_t index, uint32_t x, uint32_t y) { return (x * 7 + y * 13 + index) % 97 - 1; }
+
+    uint32_t width, height;
+    uint32_t next_layer, next_row;
+    uint32_t max_tiles;
+};
+
+void CheckGenerated(const Map& map, uint32_t width, uint32_t height)
+{
+    BOOST_CHECK_EQUAL(map.GetName(), "Generated");
+    BOOST_CHECK_EQUAL(map.GetTileset().GetFilename(), "tiles.png");
+    BOOST_CHECK_EQUAL(map.GetTileset().GetAnimatedTiles().size(), 1);
+    BOOST_REQUIRE_EQUAL(map.GetNumLayers(), 2);
+    for (uint32_t i = 0; i < 2; i++)
+    {
+        const Layer& layer = map.GetLayer(i);
+        BOOST_REQUIRE_EQUAL(layer.GetWidth(), width);
+        BOOST_REQUIRE_EQUAL(layer.GetHeight(), height);
+        BOOST_CHECK_EQUAL(layer.GetDepth(), i);
+        bool same = true;
+        for (uint32_t y = 0; y < height; y++)
+            for (uint32_t x = 0; x < width; x++)
+                same = same && layer.At(x, y) == GeneratedMapSource::Tile(i, x, y);
+        BOOST_CHECK(same);
+    }
+    BOOST_REQUIRE_EQUAL(map.GetNumBackgrounds(), 1);
+    BOOST_CHECK_EQUAL(map.GetBackground(0).GetName(), "Sky");
+    BOOST_REQUIRE(map.HasCollisionLayer());
+    TileBasedCollisionLayer* collision = dynamic_cast<TileBasedCollisionLayer*>(map.GetCollisionLayer());
+    BOOST_REQUIRE(collision != nullptr);
+    BOOST_CHECK_EQUAL(collision->At(3, 4), -1);
+    BOOST_CHECK_EQUAL(collision->At(3, 5), 0);
+}
+
+}
+
+BOOST_AUTO_TEST_CASE(MapSourceStreamingSave)
+{
+    const uint32_t width = 1000, height = 70;
+    BinaryMapHandler binary;
+    TextMapHandler text;
+
+    for (BaseMapHandler* handler : std::initializer_list<BaseMapHandler*>{&binary, &text})
+    {
+        GeneratedMapSource source(width, height);
+        std::stringstream out;
+        Map loaded;
+        try
+        {
+            handler->Save(out, source);
+            handler->Load(out, loaded);
+        }
+        catch (const char* s)
+        {
+            BOOST_FAIL(s);
+            return;
+        }
+
+        // Tiles should have been pulled a few rows at a time.
+        BOOST_CHECK_EQUAL(source.next_layer, 2);
+        BOOST_CHECK_LE(source.max_tiles, std::max(width, MapSource::ROW_BUFFER_SIZE));
+        CheckGenerated(loaded, width, height);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(MapSourceDefaultSave)
+{
+    // Handlers that do not stream read the whole map from the source.
+    ProtoMapHandler proto;
+    BaseMapHandler& handler = proto;
+    GeneratedMapSource source(40, 30);
+    std::stringstream out;
+    Map loaded;
+    handler.Save(out, source);
+    handler.Load(out, loaded);
+    CheckGenerated(loaded, 40, 30);
+}
+
+BOOST_AUTO_TEST_CASE(MemoryMapSourceSave)
+{
+    // Saving a Map goes through MemoryMapSource so the output must be the same either way.
+    std::vector<Rectangle> rectangles = {Rectangle(0, 0, 16, 8), Rectangle(-32, 40, 8, 8)};
+    Map map("Memory");
+    map.Add(Layer("A", 20, 10, std::vector<int32_t>(200, 5)));
+    map.SetCollisionLayer(new PixelBasedCollisionLayer(rectangles));
+
+    BinaryMapHandler handler;
+    MemoryMapSource source(map);
+    std::stringstream from_map, from_source;
+    handler.Save(from_map, map);
+    handler.Save(from_source, source);
+    BOOST_CHECK(from_map.str() == from_source.str());
+
+    Map copy;
+    source.Read(copy);
+    BOOST_REQUIRE_EQUAL(copy.GetNumLayers(), 1);
+    BOOST_CHECK(copy.GetLayer(0).GetData() == map.GetLayer(0).GetData());
+    BOOST_REQUIRE(copy.HasCollisionLayer());
+    BOOST_CHECK(*dynamic_cast<PixelBasedCollisionLayer*>(copy.GetCollisionLayer()) == *dynamic_cast<PixelBasedCollisionLayer*>(map.GetCollisionLayer()));
+}
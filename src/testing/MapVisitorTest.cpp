@@ -0,0 +1,184 @@
+/******************************************************************************************************
+ * Tile Map Editor
+ * Copyright (C) 2009-2017 Brandon Whitehead (tricksterguy87[AT]gmail[DOT]com)
+ *
+ * This software is provided 'as-is', without any express or implied warranty.
+ * In no event will the authors be held liable for any damages arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * excluding commercial applications, and to alter it and redistribute it freely,
+ * subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented;
+ *    you must not claim that you wrote the original software.
+ *    An acknowledgement in your documentation and link to the original version is required.
+ *
+ * 2. Altered source versions must be plainly marked as such,
+ *    and must not be misrepresented as being the original software.
+ *
+ * 3. This notice may not be removed or altered from any source distribution.
+ ******************************************************************************************************/
+#define BOOST_TEST_DYN_LINK
+#include <algorithm>
+#include <map>
+#include <sstream>
+#include <boost/test/auto_unit_test.hpp>
+#include "BinaryMapHandler.hpp"
+#include "MapVisitor.hpp"
+#include "ProtoMapHandler.hpp"
+#include "TextMapHandler.hpp"
+#include "TileBasedCollisionLayer.hpp"
+#include "XmlMapHandler.hpp"
+
+namespace
+{
+
+/** Counts how often each tile is used without keeping any layer around */
+class TileCounter : public MapVisitor
+{
+public:
+    TileCounter() : layers(0), row(0), max_tiles(0), width(0), collision_tiles(0), animations(0), ended(false) {}
+
+    void OnLayerBegin(const MapSource::LayerInfo& info)
+    {
+        layers++;
+        row = 0;
+        width = info.width;
+    }
+    void OnLayerRows(uint32_t _row, uint32_t count, const int32_t* tiles)
+    {
+        BOOST_REQUIRE_EQUAL(_row, row);
+        row += count;
+        max_tiles = std::max(max_tiles, count * width);
+        for (uint32_t i = 0; i < count * width; i++)
+            counts[tiles[i]]++;
+    }
+    void OnCollisionRows(uint32_t _row, uint32_t count, const int32_t* data)
+    {
+        for (uint32_t i = 0; i < count * width; i++)
+            collision_tiles += data[i] != 0;
+    }
+    void OnCollision(const MapSource::CollisionInfo& info) { width = info.width; }
+    void OnAnimation(const AnimatedTile& tile) { animations++; }
+    void OnEnd() { ended = true; }
+
+    std::map<int32_t, uint32_t> counts;
+    uint32_t layers, row, max_tiles, width;
+    uint32_t collision_tiles;
+    uint32_t animations;
+    bool ended;
+};
+
+Map MakeMap(uint32_t width, uint32_t height)
+{
+    Map map("Visited");
+    map.SetTileset(Tileset("tiles.png", 8, 8));
+    map.Add(AnimatedTile("Lava", 2, AnimatedTile::Reverse, 3, {4, 5}));
+    for (uint32_t i = 0; i < 2; i++)
+    {
+        std::vector<int32_t> data(width * height);
+        for (uint32_t j = 0; j < data.size(); j++)
+            data[j] = (j * (i + 3)) % 11 - 1;
+        map.Add(Layer(i == 0 ? "Bottom" : "Top", width, height, data, DrawAttributes(i)));
+    }
+    std::vector<int32_t> collision(width * height, 0);
+    for (uint32_t j = 0; j < collision.size(); j += 5)
+        collision[j] = -1;
+    map.SetCollisionLayer(new TileBasedCollisionLayer(width, height, collision));
+    return map;
+}
+
+void CheckCounts(const TileCounter& counter, const Map& map)
+{
+    std::map<int32_t, uint32_t> expected;
+    for (const auto& layer : map.GetLayers())
+        for (int32_t tile : layer.GetData())
+            expected[tile]++;
+    const TileBasedCollisionLayer* collision = dynamic_cast<const TileBasedCollisionLayer*>(map.GetCollisionLayer());
+    const std::vector<int32_t> collision_data = collision->GetData();
+    uint32_t collision_tiles = std::count_if(collision_data.begin(), collision_data.end(), [](int32_t v) { return v != 0; });
+
+    BOOST_CHECK(counter.ended);
+    BOOST_CHECK_EQUAL(counter.layers, map.GetNumLayers());
+    BOOST_CHECK_EQUAL(counter.animations, 1);
+    BOOST_CHECK(counter.counts == expected);
+    BOOST_CHECK_EQUAL(counter.collision_tiles, collision_tiles);
+}
+
+}
+
+BOOST_AUTO_TEST_CASE(MapVisitorStreamingLoad)
+{
+    const uint32_t width = 900, height = 60;
+    Map map = MakeMap(width, height);
+    BinaryMapHandler binary;
+    TextMapHandler text;
+    XmlMapHandler xml;
+
+    for (BaseMapHandler* handler : std::initializer_list<BaseMapHandler*>{&binary, &text, &xml})
+    {
+        std::stringstream file;
+        TileCounter counter;
+        try
+        {
+            handler->Save(file, map);
+            handler->Load(file, counter);
+        }
+        catch (const char* s)
+        {
+            BOOST_FAIL(s);
+            return;
+        }
+
+        CheckCounts(counter, map);
+        // Xml has to parse the whole document first so only the other formats are bounded.
+        if (handler != &xml)
+            BOOST_CHECK_LE(counter.max_tiles, std::max(width, MapSource::ROW_BUFFER_SIZE));
+    }
+}
+
+BOOST_AUTO_TEST_CASE(MapVisitorDefaultLoad)
+{
+    // Handlers that do not stream load the whole map then visit it.
+    Map map = MakeMap(30, 20);
+    ProtoMapHandler proto;
+    BaseMapHandler& handler = proto;
+    std::stringstream file;
+    TileCounter counter;
+    handler.Save(file, map);
+    handler.Load(file, counter);
+    CheckCounts(counter, map);
+}
+
+BOOST_AUTO_TEST_CASE(MapVisitorBuilder)
+{
+    Map map = MakeMap(25, 15);
+    Map copy;
+    MapBuilder builder(copy);
+    builder.Visit(map);
+
+    BOOST_CHECK_EQUAL(copy.GetName(), map.GetName());
+    BOOST_CHECK_EQUAL(copy.GetTileset().GetAnimatedTiles().size(), 1);
+    BOOST_REQUIRE_EQUAL(copy.GetNumLayers(), 2);
+    for (uint32_t i = 0; i < 2; i++)
+    {
+        BOOST_CHECK_EQUAL(copy.GetLayer(i).GetName(), map.GetLayer(i).GetName());
+        BOOST_CHECK_EQUAL(copy.GetLayer(i).GetDepth(), map.GetLayer(i).GetDepth());
+        BOOST_CHECK(copy.GetLayer(i).GetData() == map.GetLayer(i).GetData());
+    }
+    BOOST_REQUIRE(copy.HasCollisionLayer());
+    BOOST_CHECK(dynamic_cast<TileBasedCollisionLayer*>(copy.GetCollisionLayer())->GetData() ==
+                dynamic_cast<TileBasedCollisionLayer*>(map.GetCollisionLayer())->GetData());
+}
+
+BOOST_AUTO_TEST_CASE(MapVisitorTextShortLayer)
+{
+    // Missing tiles in a text layer are left empty.
+    std::stringstream file("Properties\nname: Short\ntileset: a.png\ntile_dimensions: 8 8\n\n"
+                           "Layers\nname: A\ndimensions: 3 2\ndata: 1 2 3\ndata: 4\n\n\n");
+    TextMapHandler handler;
+    Map map;
+    handler.Load(file, map);
+    BOOST_REQUIRE_EQUAL(map.GetNumLayers(), 1);
+    BOOST_CHECK(map.GetLayer(0).GetData() == std::vector<int32_t>({1, 2, 3, 4, -1, -1}));
+}
@@ -0,0 +1,162 @@
+/******************************************************************************************************
+ * Tile Map Editor
+ * Copyright (C) 2009-2017 Brandon Whitehead (tricksterguy87[AT]gmail[DOT]com)
+ *
+ * This software is provided 'as-is', without any express or implied warranty.
+ * In no event will the authors be held liable for any damages arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * excluding commercial applications, and to alter it and redistribute it freely,
+ * subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented;
+ *    you must not claim that you wrote the original software.
+ *    An acknowledgement in your documentation and link to the original version is required.
+ *
+ * 2. Altered source versions must be plainly marked as such,
+ *    and must not be misrepresented as being the original software.
+ *
+ * 3. This notice may not be removed or altered from any source distribution.
+ ******************************************************************************************************/
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/auto_unit_test.hpp>
+#include <cstdlib>
+#include "PackedTileGrid.hpp"
+#include "DirectionBasedCollisionLayer.hpp"
+#include "TileBasedCollisionLayer.hpp"
+
+BOOST_AUTO_TEST_CASE(TestPackedTileFill)
+{
+    PackedTileCollision grid(100, 10);
+    BOOST_CHECK_EQUAL(grid.GetStride(), 2u);
+    grid.Fill(60, 2, 10, 3, 1);
+    BOOST_CHECK_EQUAL(grid.Get(60, 2), 1u);
+    BOOST_CHECK_EQUAL(grid.Get(69, 4), 1u);
+    BOOST_CHECK_EQUAL(grid.Get(70, 4), 0u);
+    BOOST_CHECK_EQUAL(grid.Get(60, 5), 0u);
+    BOOST_CHECK_EQUAL(grid.Count(), 30u);
+    BOOST_CHECK(grid.Any(0, 0, 61, 3));
+    BOOST_CHECK(!grid.Any(0, 0, 60, 10));
+    BOOST_CHECK(!grid.Any(70, 0, 100, 10));
+
+    // Clipped to the grid.
+    grid.Fill(0, 0, 500, 500, 1);
+    BOOST_CHECK_EQUAL(grid.Count(), 1000u);
+    BOOST_CHECK_EQUAL(grid.Get(100, 0), 0u);
+    grid.Set(99, 9, 0);
+    BOOST_CHECK_EQUAL(grid.Count(), 999u);
+}
+
+BOOST_AUTO_TEST_CASE(TestPackedDirectionFill)
+{
+    PackedDirectionCollision grid(40, 3);
+    BOOST_CHECK_EQUAL(grid.GetStride(), 3u);
+    grid.Fill(10, 0, 25, 2, 0x5);
+    grid.Set(12, 1, 0xA);
+    BOOST_CHECK_EQUAL(grid.Get(9, 0), 0u);
+    BOOST_CHECK_EQUAL(grid.Get(10, 0), 0x5u);
+    BOOST_CHECK_EQUAL(grid.Get(34, 1), 0x5u);
+    BOOST_CHECK_EQUAL(grid.Get(35, 1), 0u);
+    BOOST_CHECK_EQUAL(grid.Get(12, 1), 0xAu);
+    BOOST_CHECK_EQUAL(grid.Count(), 50u * 2);
+    BOOST_CHECK(!grid.Any(0, 2, 40, 1));
+}
+
+BOOST_AUTO_TEST_CASE(TestPackedTileLayerRoundTrip)
+{
+    srand(7);
+    TiledLayerData layer(77, 13);
+    for (uint32_t i = 0; i < 77 * 13; i++)
+        layer.Set(i, rand() % 3 == 0 ? -1 : 0);
+
+    PackedTileCollision grid(layer);
+    for (uint32_t y = 0; y < 13; y++)
+        for (uint32_t x = 0; x < 77; x++)
+            BOOST_REQUIRE_EQUAL(grid.Get(x, y), layer.At(x, y) ? 1u : 0u);
+
+    TiledLayerData unpacked;
+    grid.Unpack(unpacked);
+    BOOST_CHECK(unpacked == layer);
+
+    // Rows as stored in MTCL chunks.
+    std::vector<int32_t> rows(77 * 4);
+    grid.GetRows(5, 4, rows.data());
+    BOOST_CHECK(std::equal(rows.begin(), rows.end(), layer.GetData().begin() + 5 * 77));
+    PackedTileCollision streamed(77, 13);
+    for (uint32_t y = 0; y < 13; y += 4)
+        streamed.SetRows(y, 4, layer.GetData().data() + y * 77);
+    BOOST_CHECK(streamed == grid);
+
+    // The collision layer keeps the same packed form.
+    TileBasedCollisionLayer collision(77, 13, layer.GetData());
+    BOOST_CHECK(collision.GetGrid() == grid);
+    BOOST_CHECK(collision.GetData() == layer.GetData());
+}
+
+BOOST_AUTO_TEST_CASE(TestPackedDirectionLayerRoundTrip)
+{
+    srand(11);
+    TiledLayerData layer(30, 7);
+    for (uint32_t i = 0; i < 30 * 7; i++)
+        layer.Set(i, rand() % 16);
+
+    PackedDirectionCollision grid(layer);
+    BOOST_CHECK_EQUAL(grid.Get(3, 4), (uint32_t) layer.At(3, 4));
+    TiledLayerData unpacked;
+    grid.Unpack(unpacked);
+    BOOST_CHECK(unpacked == layer);
+
+    DirectionBasedCollisionLayer collision(30, 7, layer.GetData());
+    BOOST_CHECK(collision.GetGrid() == grid);
+    BOOST_CHECK(collision.GetData() == layer.GetData());
+}
+
+BOOST_AUTO_TEST_CASE(TestPackedLayerShiftResize)
+{
+    TileBasedCollisionLayer layer(70, 3, std::vector<int32_t>(70 * 3, 0));
+    layer.Set(0, 0, -1);
+    layer.Set(69, 2, -1);
+
+    layer.Shift(1, 0, true);
+    BOOST_CHECK_EQUAL(layer.At(1, 0), -1);
+    BOOST_CHECK_EQUAL(layer.At(0, 2), -1);
+    BOOST_CHECK_EQUAL(layer.At(0, 0), 0);
+
+    // Uncovered tiles get the null tile like TiledLayerData::Shift.
+    layer.Shift(0, 1, false);
+    BOOST_CHECK_EQUAL(layer.At(1, 1), -1);
+    BOOST_CHECK_EQUAL(layer.At(5, 0), -1);
+    BOOST_CHECK_EQUAL(layer.At(5, 1), 0);
+
+    layer.Resize(2, 2);
+    BOOST_CHECK_EQUAL(layer.GetWidth(), 2u);
+    BOOST_CHECK_EQUAL(layer.GetHeight(), 2u);
+    BOOST_CHECK_EQUAL(layer.At(1, 1), -1);
+    BOOST_CHECK_EQUAL(layer.At(0, 1), 0);
+    BOOST_CHECK_EQUAL(layer.GetGrid().Count(), 3u);
+}
+
+BOOST_AUTO_TEST_CASE(TestPackedTileBulk)
+{
+    PackedTileCollision a(70, 5), b(70, 5);
+    a.Fill(0, 0, 40, 5, 1);
+    b.Fill(30, 0, 40, 5, 1);
+
+    PackedTileCollision add = a, subtract = a, intersect = a, xored = a;
+    add.Add(b);
+    subtract.Subtract(b);
+    intersect.Intersect(b);
+    xored.Xor(b);
+    BOOST_CHECK_EQUAL(add.Count(), 70u * 5);
+    BOOST_CHECK_EQUAL(subtract.Count(), 30u * 5);
+    BOOST_CHECK_EQUAL(intersect.Count(), 10u * 5);
+    BOOST_CHECK_EQUAL(xored.Count(), 60u * 5);
+    BOOST_CHECK(!subtract.Any(30, 0, 40, 5));
+    BOOST_CHECK(intersect.Any(39, 4, 1, 1));
+
+    a.Clear();
+    BOOST_CHECK_EQUAL(a.Count(), 0u);
+
+    PackedTileCollision other(71, 5);
+    BOOST_CHECK_THROW(a.Add(other), const char*);
+}
@@ -0,0 +1,198 @@
+/******************************************************************************************************
+ * Tile Map Editor
+ * Copyright (C) 2009-2017 Brandon Whitehead (tricksterguy87[AT]gmail[DOT]com)
+ *
+ * This software is provided 'as-is', without any express or implied warranty.
+ * In no event will the authors be held liable for any damages arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * excluding commercial applications, and to alter it and redistribute it freely,
+ * subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented;
+ *    you must not claim that you wrote the original software.
+ *    An acknowledgement in your documentation and link to the original version is required.
+ *
+ * 2. Altered source versions must be plainly marked as such,
+ *    and must not be misrepresented as being the original software.
+ *
+ * 3. This notice may not be removed or altered from any source distribution.
+ ******************************************************************************************************/
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/auto_unit_test.hpp>
+#include <cstdlib>
+#include "DirectionBasedCollisionLayer.hpp"
+#include "PathFinder.hpp"
+#include "PathHierarchy.hpp"
+#include "PixelBasedCollisionLayer.hpp"
+#include "TileBasedCollisionLayer.hpp"
+
+namespace
+{
+
+/** Checks a path starts and ends where it should and every step is allowed */
+bool ValidPath(const PathGrid& grid, const PathFinder::Path& path, int32_t sx, int32_t sy, int32_t gx, int32_t gy)
+{
+    if (path.empty() || path.front() != std::make_pair(sx, sy) || path.back() != std::make_pair(gx, gy))
+        return false;
+    for (uint32_t i = 1; i < path.size(); i++)
+    {
+        bool allowed = false;
+        for (uint32_t d = 0; d < 4; d++)
+        {
+            if (path[i - 1].first + PathGrid::STEP_X[d] == path[i].first && path[i - 1].second + PathGrid::STEP_Y[d] == path[i].second)
+                allowed = grid.CanMove(path[i - 1].second * grid.GetWidth() + path[i - 1].first, d);
+        }
+        if (!allowed)
+            return false;
+    }
+    return true;
+}
+
+TileBasedCollisionLayer RandomLayer(uint32_t width, uint32_t height, int percent_blocked)
+{
+    TileBasedCollisionLayer layer(width, height, std::vector<int32_t>(width * height, 0));
+    for (uint32_t i = 0; i < width * height; i++)
+    {
+        if (rand() % 100 < percent_blocked)
+            layer.Set(i % width, i / width, -1);
+    }
+    return layer;
+}
+
+}
+
+BOOST_AUTO_TEST_CASE(TestPathAroundWall)
+{
+    // Wall down column 4 with a gap at the bottom.
+    TileBasedCollisionLayer layer(8, 8, std::vector<int32_t>(64, 0));
+    for (uint32_t y = 0; y < 7; y++)
+        layer.Set(4, y, -1);
+    PathGrid grid(layer);
+    PathFinder finder(grid);
+
+    PathFinder::Path path;
+    BOOST_REQUIRE(finder.FindPath(1, 1, 6, 1, path));
+    BOOST_CHECK(ValidPath(grid, path, 1, 1, 6, 1));
+    BOOST_CHECK_EQUAL(path.size(), 18u);
+
+    BOOST_REQUIRE(finder.FindPath(1, 1, 6, 1, path, PathFinder::JumpPoint));
+    BOOST_CHECK(ValidPath(grid, path, 1, 1, 6, 1));
+    BOOST_CHECK_EQUAL(path.size(), 18u);
+
+    BOOST_REQUIRE(finder.FindPath(2, 2, 2, 2, path, PathFinder::JumpPoint));
+    BOOST_CHECK_EQUAL(path.size(), 1u);
+    BOOST_CHECK(!finder.FindPath(1, 1, 4, 0, path));
+    BOOST_CHECK(!finder.FindPath(1, 1, 8, 0, path));
+    // Can't leave the bounds given.
+    BOOST_CHECK(!finder.FindPath(1, 1, 6, 1, Rectangle(0, 0, 8, 7), path));
+}
+
+BOOST_AUTO_TEST_CASE(TestPathDirections)
+{
+    // Wall between (1, 1) and (2, 1) so going east along row 1 has to go around through row 0.
+    DirectionBasedCollisionLayer layer(5, 2, std::vector<int32_t>(10, DirectionBasedCollisionLayer::ALL_DIRECTIONS));
+    layer.Set(1, 1, DirectionBasedCollisionLayer::ALL_DIRECTIONS & ~DirectionBasedCollisionLayer::Bit(DirectionBasedCollisionLayer::East));
+    PathGrid grid(layer);
+    BOOST_CHECK(!grid.IsTileBased());
+    PathFinder finder(grid);
+
+    PathFinder::Path path;
+    BOOST_REQUIRE(finder.FindPath(0, 1, 3, 1, path, PathFinder::JumpPoint));
+    BOOST_CHECK(ValidPath(grid, path, 0, 1, 3, 1));
+    BOOST_CHECK_EQUAL(path.size(), 6u);
+
+    PathHierarchy hierarchy(grid, 2);
+    BOOST_REQUIRE(hierarchy.FindPath(finder, 0, 1, 3, 1, path));
+    BOOST_CHECK(ValidPath(grid, path, 0, 1, 3, 1));
+
+    PixelBasedCollisionLayer pixels;
+    BOOST_CHECK_THROW(PathGrid grid(pixels), const char*);
+}
+
+BOOST_AUTO_TEST_CASE(TestPathHierarchyDirections)
+{
+    // The right cluster's top row can't step south, so the entrance in row 0 doesn't lead to (3, 1).
+    DirectionBasedCollisionLayer layer(4, 2, std::vector<int32_t>(8, DirectionBasedCollisionLayer::ALL_DIRECTIONS));
+    const int32_t no_south = DirectionBasedCollisionLayer::ALL_DIRECTIONS & ~DirectionBasedCollisionLayer::Bit(DirectionBasedCollisionLayer::South);
+    layer.Set(2, 0, no_south);
+    layer.Set(3, 0, no_south);
+    PathGrid grid(layer);
+    PathFinder finder(grid);
+    PathHierarchy hierarchy(grid, 2);
+
+    PathFinder::Path path;
+    BOOST_REQUIRE(finder.FindPath(0, 1, 3, 1, path));
+    BOOST_REQUIRE(hierarchy.FindPath(finder, 0, 1, 3, 1, path));
+    BOOST_CHECK(ValidPath(grid, path, 0, 1, 3, 1));
+
+    srand(7);
+    for (int map = 0; map < 4; map++)
+    {
+        DirectionBasedCollisionLayer random(30, 30, std::vector<int32_t>(900, DirectionBasedCollisionLayer::ALL_DIRECTIONS));
+        for (uint32_t i = 0; i < 900; i++)
+        {
+            if (rand() % 100 < 40)
+                random.Set(i % 30, i / 30, rand() % 16);
+        }
+        PathGrid random_grid(random);
+        PathFinder random_finder(random_grid);
+        PathHierarchy random_hierarchy(random_grid, 4 + map);
+        PathFinder::Path astar, hpa;
+        for (int i = 0; i < 60; i++)
+        {
+            uint32_t sx = rand() % 30, sy = rand() % 30, gx = rand() % 30, gy = rand() % 30;
+            bool found = random_finder.FindPath(sx, sy, gx, gy, astar);
+            BOOST_REQUIRE_EQUAL(random_hierarchy.FindPath(random_finder, sx, sy, gx, gy, hpa), found);
+            if (found)
+                BOOST_REQUIRE(ValidPath(random_grid, hpa, sx, sy, gx, gy));
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(TestPathBlockedEnds)
+{
+    TileBasedCollisionLayer layer(4, 4, std::vector<int32_t>(16, 0));
+    layer.Set(1, 1, -1);
+    PathGrid grid(layer);
+    PathFinder finder(grid);
+    PathHierarchy hierarchy(grid, 2);
+
+    // Both algorithms refuse to start or end on a blocked tile, even when the start is the goal.
+    PathFinder::Path path;
+    const uint32_t ends[][4] = {{1, 1, 1, 1}, {1, 1, 3, 3}, {3, 3, 1, 1}};
+    for (const auto& end : ends)
+    {
+        BOOST_CHECK(!finder.FindPath(end[0], end[1], end[2], end[3], path));
+        BOOST_CHECK(!finder.FindPath(end[0], end[1], end[2], end[3], path, PathFinder::JumpPoint));
+        BOOST_CHECK(!hierarchy.FindPath(finder, end[0], end[1], end[2], end[3], path));
+    }
+}
+
+BOOST_AUTO_TEST_CASE(TestPathAlgorithmsAgree)
+{
+    srand(5);
+    for (int map = 0; map < 6; map++)
+    {
+        TileBasedCollisionLayer layer = RandomLayer(50 + map * 7, 40 + map * 5, 25 + map * 3);
+        PathGrid grid(layer);
+        PathFinder finder(grid);
+        PathHierarchy hierarchy(grid, 8 + map);
+        PathFinder::Path astar, jump, hpa;
+        for (int i = 0; i < 60; i++)
+        {
+            uint32_t sx = rand() % grid.GetWidth(), sy = rand() % grid.GetHeight();
+            uint32_t gx = rand() % grid.GetWidth(), gy = rand() % grid.GetHeight();
+            bool found = finder.FindPath(sx, sy, gx, gy, astar);
+            BOOST_REQUIRE_EQUAL(finder.FindPath(sx, sy, gx, gy, jump, PathFinder::JumpPoint), found);
+            BOOST_REQUIRE_EQUAL(hierarchy.FindPath(finder, sx, sy, gx, gy, hpa), found);
+            if (!found)
+                continue;
+            BOOST_REQUIRE(ValidPath(grid, astar, sx, sy, gx, gy));
+            BOOST_REQUIRE(ValidPath(grid, jump, sx, sy, gx, gy));
+            BOOST_REQUIRE(ValidPath(grid, hpa, sx, sy, gx, gy));
+            BOOST_REQUIRE_EQUAL(jump.size(), astar.size());
+            BOOST_REQUIRE_GE(hpa.size(), astar.size());
+        }
+    }
+}
@@ -0,0 +1,204 @@
+/******************************************************************************************************
+ * TileMapEditor
+ * Copyright (C) 2015 Brandon Whitehead (tricksterguy87[AT]gmail[DOT]com)
+ *
+ * This software is provided 'as-is', without any express or implied warranty.
+ * In no event will the authors be held liable for any damages arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * excluding commercial applications, and to alter it and redistribute it freely,
+ * subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented;
+ *    you must not claim that you wrote the original software.
+ *    An acknowledgement in your documentation and link to the original version is required.
+ *
+ * 2. Altered source versions must be plainly marked as such,
+ *    and must not be misrepresented as being the original software.
+ *
+ * 3. This notice may not be removed or altered from any source distribution.
+ ******************************************************************************************************/
+#define BOOST_TEST_DYN_LINK
+#include <climits>
+#include <sstream>
+#include <boost/test/auto_unit_test.hpp>
+#include "Map.hpp"
+#include "PixelBasedCollisionLayer.hpp"
+#include "ProtoMapHandler.hpp"
+#include "TileBasedCollisionLayer.hpp"
+#include "TileMap.pb.h"
+
+BOOST_AUTO_TEST_CASE(ProtoMapHandlerRoundTrip)
+{
+    std::vector<int32_t> data(32 * 16, -1);
+    for (size_t i = 0; i < data.size(); i += 3)
+        data[i] = i % 40;
+    data[5] = INT_MIN;
+    data[6] = INT_MAX;
+    std::vector<int32_t> collision(32 * 16, 0);
+    collision[17] = -1;
+
+    DrawAttributes attr(3);
+    attr.SetPosition(32, -24);
+    attr.SetOrigin(10, 12);
+    attr.SetScale(3.0f, 5.0f);
+    attr.SetRotation(92.0f);
+    attr.SetOpacity(50.0f);
+    attr.SetBlendMode(2);
+    attr.SetBlendColor(0xFEFDFCFA);
+
+    Map map("HELLO WORLD");
+    Tileset tileset("011-PortTown01.png", 32, 16);
+    tileset.Add(AnimatedTile("Water", 3, AnimatedTile::Ping, -1, {0, 1, 2, 3}));
+    map.SetTileset(tileset);
+    map.Add(Layer("A", 32, 16, data, attr));
+    map.Add(Background("B", "003-StarlitSky01.png", 6, 2, 4, attr));
+    map.SetCollisionLayer(new TileBasedCollisionLayer(32, 16, collision));
+
+    for (const auto delta : {ProtoMapHandler::NoDelta, ProtoMapHandler::AlwaysDelta, ProtoMapHandler::AutoDelta})
+    {
+        ProtoMapHandler handler(delta);
+        Map loaded;
+        std::stringstream out;
+        try
+        {
+            handler.Save(out, map);
+            handler.Load(out, loaded);
+        }
+        catch (const char* s)
+        {
+            BOOST_FAIL(s);
+            return;
+        }
+
+        BOOST_CHECK_EQUAL(loaded.GetName(), "HELLO WORLD");
+        uint32_t tile_width, tile_height;
+        loaded.GetTileset().GetTileDimensions(tile_width, tile_height);
+        BOOST_CHECK_EQUAL(loaded.GetTileset().GetFilename(), "011-PortTown01.png");
+        BOOST_CHECK_EQUAL(tile_width, 32);
+        BOOST_CHECK_EQUAL(tile_height, 16);
+
+        const std::vector<AnimatedTile>& animated_tiles = loaded.GetTileset().GetAnimatedTiles();
+        BOOST_REQUIRE_EQUAL(animated_tiles.size(), 1);
+        BOOST_CHECK_EQUAL(animated_tiles[0].GetName(), "Water");
+        BOOST_CHECK_EQUAL(animated_tiles[0].GetDelay(), 3);
+        BOOST_CHECK_EQUAL(animated_tiles[0].GetType(), AnimatedTile::Ping);
+        BOOST_CHECK_EQUAL(animated_tiles[0].GetTimes(), -1);
+        BOOST_CHECK_EQUAL(animated_tiles[0].GetNumFrames(), 4);
+
+        BOOST_REQUIRE_EQUAL(loaded.GetNumLayers(), 1);
+        const Layer& layer = loaded.GetLayer(0);
+        const std::vector<int32_t>& actualData = layer.GetData();
+        BOOST_CHECK_EQUAL(layer.GetName(), "A");
+        BOOST_CHECK_EQUAL(layer.GetWidth(), 32);
+        BOOST_CHECK_EQUAL(layer.GetHeight(), 16);
+        BOOST_CHECK_EQUAL_COLLECTIONS(actualData.begin(), actualData.end(), data.begin(), data.end());
+
+        int32_t x, y;
+        float sx, sy;
+        layer.GetPosition(x, y);
+        layer.GetScale(sx, sy);
+        BOOST_CHECK_EQUAL(layer.GetDepth(), 3);
+        BOOST_CHECK_EQUAL(x, 32);
+        BOOST_CHECK_EQUAL(y, -24);
+        BOOST_CHECK_EQUAL(sx, 3.0f);
+        BOOST_CHECK_EQUAL(sy, 5.0f);
+        BOOST_CHECK_EQUAL(layer.GetRotation(), 92.0f);
+        BOOST_CHECK_EQUAL(layer.GetOpacity(), 50.0f);
+        BOOST_CHECK_EQUAL(layer.GetBlendMode(), 2);
+        BOOST_CHECK_EQUAL(layer.GetBlendColor(), 0xFEFDFCFAU);
+
+        BOOST_REQUIRE_EQUAL(loaded.GetNumBackgrounds(), 1);
+        const Background& background = loaded.GetBackground(0);
+        background.GetSpeed(sx, sy);
+        BOOST_CHECK_EQUAL(background.GetName(), "B");
+        BOOST_CHECK_EQUAL(background.GetFilename(), "003-StarlitSky01.png");
+        BOOST_CHECK_EQUAL(background.GetMode(), 6);
+        BOOST_CHECK_EQUAL(sx, 2.0f);
+        BOOST_CHECK_EQUAL(sy, 4.0f);
+
+        BOOST_REQUIRE(loaded.HasCollisionLayer());
+        TileBasedCollisionLayer* clayer = dynamic_cast<TileBasedCollisionLayer*>(loaded.GetCollisionLayer());
+        BOOST_REQUIRE(clayer != nullptr);
+        const std::vector<int32_t>& actualCollision = clayer->GetData();
+        BOOST_CHECK_EQUAL_COLLECTIONS(actualCollision.begin(), actualCollision.end(), collision.begin(), collision.end());
+    }
+}
+
+BOOST_AUTO_TEST_CASE(ProtoMapHandlerPixelCollision)
+{
+    std::vector<Rectangle> rectangles = {Rectangle(0, 0, 16, 8), Rectangle(-32, 40, 8, 8)};
+    Map map("Pixels");
+    map.SetCollisionLayer(new PixelBasedCollisionLayer(rectangles));
+
+    ProtoMapHandler handler;
+    Map loaded;
+    std::stringstream out;
+    handler.Save(out, map);
+    handler.Load(out, loaded);
+
+    BOOST_REQUIRE(loaded.HasCollisionLayer());
+    PixelBasedCollisionLayer* clayer = dynamic_cast<PixelBasedCollisionLayer*>(loaded.GetCollisionLayer());
+    BOOST_REQUIRE(clayer != nullptr);
+    BOOST_CHECK(*clayer == *dynamic_cast<PixelBasedCollisionLayer*>(map.GetCollisionLayer()));
+}
+
+BOOST_AUTO_TEST_CASE(ProtoMapHandlerDeltaEncoding)
+{
+    // Ascending tile ids as produced by importing an image are cheaper as deltas.
+    std::vector<int32_t> data(64 * 64);
+    for (size_t i = 0; i < data.size(); i++)
+        data[i] = 1000 + i;
+
+    Map map("Delta");
+    map.Add(Layer("A", 64, 64, data));
+
+    std::stringstream raw, delta, automatic;
+    ProtoMapHandler(ProtoMapHandler::NoDelta).Save(raw, map);
+    ProtoMapHandler(ProtoMapHandler::AlwaysDelta).Save(delta, map);
+    ProtoMapHandler(ProtoMapHandler::AutoDelta).Save(automatic, map);
+
+    BOOST_CHECK_LT(delta.str().size(), raw.str().size());
+    BOOST_CHECK_EQUAL(automatic.str().size(), delta.str().size());
+}
+
+BOOST_AUTO_TEST_CASE(ProtoMapHandlerLoadFail)
+{
+    ProtoMapHandler handler;
+    Map map;
+    std::stringstream garbage(std::string("\xff\xff\xff\xff\x0f", 5));
+    BOOST_CHECK_THROW(handler.Load(garbage, map), const char*);
+}
+
+BOOST_AUTO_TEST_CASE(ProtoMapHandlerLoadBadDimensions)
+{
+    Map map("Dimensions");
+    map.Add(Layer("A", 4, 4, std::vector<int32_t>(16, 1)));
+    std::stringstream out;
+    ProtoMapHandler().Save(out, map);
+
+    tilemap::Map message;
+    BOOST_REQUIRE(message.ParseFromString(out.str()));
+    tilemap::TiledData* data = message.mutable_layers(0)->mutable_data();
+    data->clear_tiles();
+    for (uint32_t i = 0; i < 65536; i++)
+        data->add_tiles(1);
+
+    // 65536 * 65537 wraps to 65536 in 32 bits, the others have as many tiles as claimed but are larger than a layer can be.
+    const uint32_t dimensions[][2] = {{65536, 65537}, {65536, 1}, {1, 65536}};
+    for (const auto& dimension : dimensions)
+    {
+        data->set_width(dimension[0]);
+        data->set_height(dimension[1]);
+        std::stringstream bad(message.SerializeAsString());
+        Map loaded;
+        BOOST_CHECK_THROW(ProtoMapHandler().Load(bad, loaded), const char*);
+    }
+
+    data->clear_tiles();
+    data->set_width(0);
+    data->set_height(0);
+    std::stringstream empty(message.SerializeAsString());
+    Map loaded;
+    BOOST_CHECK_THROW(ProtoMapHandler().Load(empty, loaded), const char*);
+}
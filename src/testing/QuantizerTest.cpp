@@ -0,0 +1,133 @@
+/******************************************************************************************************
+ * Tile Map Editor
+ * Copyright (C) 2009-2017 Brandon Whitehead (tricksterguy87[AT]gmail[DOT]com)
+ *
+ * This software is provided 'as-is', without any express or implied warranty.
+ * In no event will the authors be held liable for any damages arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * excluding commercial applications, and to alter it and redistribute it freely,
+ * subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented;
+ *    you must not claim that you wrote the original software.
+ *    An acknowledgement in your documentation and link to the original version is required.
+ *
+ * 2. Altered source versions must be plainly marked as such,
+ *    and must not be misrepresented as being the original software.
+ *
+ * 3. This notice may not be removed or altered from any source distribution.
+ ******************************************************************************************************/
+#define BOOST_TEST_DYN_LINK
+#include <chrono>
+#include <cstdlib>
+#include <set>
+#include <boost/test/auto_unit_test.hpp>
+#include "Quantizer.hpp"
+
+namespace
+{
+
+uint32_t PixelColor(const std::vector<uint8_t>& rgba, uint32_t index)
+{
+    return (rgba[index * 4] << 16) | (rgba[index * 4 + 1] << 8) | rgba[index * 4 + 2];
+}
+
+}
+
+BOOST_AUTO_TEST_CASE(TestMedianCut)
+{
+    // Few enough colors are kept as is.
+    std::vector<ColorCount> colors = {{0xFF0000, 3}, {0x00FF00, 1}};
+    std::vector<uint32_t> palette = MedianCut(colors, 4);
+    BOOST_CHECK(palette == std::vector<uint32_t>({0xFF0000, 0x00FF00}));
+
+    // Two clusters of reds and blues become one color each, weighted by their counts.
+    colors = {{0xF00000, 1}, {0xFE0000, 3}, {0x0000F0, 2}, {0x0000FE, 2}};
+    palette = MedianCut(colors, 2);
+    BOOST_REQUIRE_EQUAL(palette.size(), 2);
+    std::set<uint32_t> result(palette.begin(), palette.end());
+    BOOST_CHECK(result.count(0xFB0000));
+    BOOST_CHECK(result.count(0x0000F7));
+}
+
+BOOST_AUTO_TEST_CASE(TestNearestColor)
+{
+    std::vector<uint32_t> palette;
+    for (uint32_t i = 0; i < 15; i++)
+        palette.push_back(i * 0x111111);
+
+    uint32_t distance;
+    BOOST_CHECK_EQUAL(NearestColor(palette, 0x000000, &distance), 0);
+    BOOST_CHECK_EQUAL(distance, 0);
+    BOOST_CHECK_EQUAL(NearestColor(palette, 0xEEEEEE), 14);
+    BOOST_CHECK_EQUAL(NearestColor(palette, 0x343434, &distance), 3);
+    BOOST_CHECK_EQUAL(distance, 3 * 1 * 1);
+    BOOST_CHECK_EQUAL(NearestColor({0x102030}, 0xFFFFFF), 0);
+}
+
+BOOST_AUTO_TEST_CASE(TestQuantizeTiles)
+{
+    // 4 tiles, the left two use reds the right two use blues, each tile has 8 shades.
+    const uint32_t width = 32, height = 8;
+    std::vector<uint8_t> rgba(width * height * 4, 0);
+    for (uint32_t y = 0; y < height; y++)
+    {
+        for (uint32_t x = 0; x < width; x++)
+        {
+            uint8_t* pixel = &rgba[(y * width + x) * 4];
+            uint8_t shade = 128 + y * 16 + (x / 8) % 2 * 4;
+            pixel[x < 16 ? 0 : 2] = shade;
+            pixel[3] = x % 8 == 0 ? 0 : 255;
+        }
+    }
+
+    TilePalettes result = QuantizeTiles(rgba.data(), width, height, 8, 8, 2, 16);
+    BOOST_REQUIRE_EQUAL(result.tile_palettes.size(), 4);
+    BOOST_CHECK_EQUAL(result.tile_palettes[0], result.tile_palettes[1]);
+    BOOST_CHECK_EQUAL(result.tile_palettes[2], result.tile_palettes[3]);
+    BOOST_CHECK_NE(result.tile_palettes[0], result.tile_palettes[2]);
+
+    // 16 shades fit exactly so nothing changes.
+    for (uint32_t y = 0; y < height; y++)
+        BOOST_CHECK_EQUAL(PixelColor(rgba, y * width + 9), static_cast<uint32_t>((132 + y * 16) << 16));
+
+    // Transparent pixels are left alone.
+    BOOST_CHECK_EQUAL(rgba[3], 0);
+    BOOST_CHECK_EQUAL(PixelColor(rgba, 0), 0x800000);
+}
+
+BOOST_AUTO_TEST_CASE(TestQuantizeLargeTileset)
+{
+    // A 4096 tile tileset of noise reduced to 16 palettes of 15 colors.
+    const uint32_t width = 64 * 8, height = 64 * 8;
+    std::vector<uint8_t> rgba(width * height * 4);
+    srand(1234);
+    for (uint32_t i = 0; i < width * height; i++)
+    {
+        uint32_t tile = (i / width / 8) * 64 + (i % width) / 8;
+        rgba[i * 4] = (tile * 37) % 256 + rand() % 16;
+        rgba[i * 4 + 1] = (tile * 91) % 240 + rand() % 16;
+        rgba[i * 4 + 2] = rand() % 256;
+        rgba[i * 4 + 3] = 255;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    TilePalettes result = QuantizeTiles(rgba.data(), width, height, 8, 8, 16, 15);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    BOOST_TEST_MESSAGE("Quantized 4096 tiles in " << seconds << "s");
+
+    BOOST_REQUIRE_EQUAL(result.palettes.size(), 16);
+    for (const auto& palette : result.palettes)
+        BOOST_CHECK_LE(palette.size(), 15);
+
+    // Every pixel now uses its tile's palette.
+    bool ok = true;
+    for (uint32_t i = 0; i < width * height; i++)
+    {
+        uint32_t tile = (i / width / 8) * 64 + (i % width) / 8;
+        const auto& palette = result.palettes[result.tile_palettes[tile]];
+        ok = ok && std::find(palette.begin(), palette.end(), PixelColor(rgba, i)) != palette.end();
+    }
+    BOOST_CHECK(ok);
+}
@@ -0,0 +1,119 @@
+/******************************************************************************************************
+ * Tile Map Editor
+ * Copyright (C) 2009-2017 Brandon Whitehead (tricksterguy87[AT]gmail[DOT]com)
+ *
+ * This software is provided 'as-is', without any express or implied warranty.
+ * In no event will the authors be held liable for any damages arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * excluding commercial applications, and to alter it and redistribute it freely,
+ * subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented;
+ *    you must not claim that you wrote the original software.
+ *    An acknowledgement in your documentation and link to the original version is required.
+ *
+ * 2. Altered source versions must be plainly marked as such,
+ *    and must not be misrepresented as being the original software.
+ *
+ * 3. This notice may not be removed or altered from any source distribution.
+ ******************************************************************************************************/
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/auto_unit_test.hpp>
+#include <algorithm>
+#include <cstdlib>
+#include <vector>
+#include "Region.hpp"
+#include "RegionIndex.hpp"
+
+namespace
+{
+
+std::vector<Rectangle> RandomRectangles(uint32_t count)
+{
+    std::vector<Rectangle> rectangles;
+    for (uint32_t i = 0; i < count; i++)
+        rectangles.push_back(Rectangle(rand() % 1000 - 100, rand() % 1000 - 100, rand() % 40, rand() % 40));
+    return rectangles;
+}
+
+}
+
+BOOST_AUTO_TEST_CASE(TestRegionIndexMatchesScan)
+{
+    srand(42);
+    std::vector<Rectangle> rectangles = RandomRectangles(2000);
+    RegionIndex index;
+    index.Build(rectangles);
+
+    for (int i = 0; i < 500; i++)
+    {
+        int32_t x = rand() % 1100 - 150;
+        int32_t y = rand() % 1100 - 150;
+        bool contains = false;
+        for (const auto& r : rectangles)
+            contains |= r.Contains(x, y);
+        BOOST_CHECK_EQUAL(index.Contains(x, y), contains);
+
+        Rectangle probe(x, y, rand() % 60, rand() % 60);
+        std::vector<uint32_t> expected;
+        for (uint32_t j = 0; j < rectangles.size(); j++)
+        {
+            Rectangle overlap;
+            if (probe.Intersects(rectangles[j], overlap))
+                expected.push_back(j);
+        }
+        std::vector<uint32_t> actual;
+        index.Query(probe, actual);
+        std::sort(actual.begin(), actual.end());
+        BOOST_CHECK(actual == expected);
+        BOOST_CHECK_EQUAL(index.Intersects(probe), !expected.empty());
+    }
+}
+
+BOOST_AUTO_TEST_CASE(TestRegionIndexEmpty)
+{
+    RegionIndex index;
+    BOOST_CHECK(index.IsEmpty());
+    BOOST_CHECK(!index.Contains(0, 0));
+
+    // Rectangles without area are left out.
+    index.Build({Rectangle(0, 0, 0, 10), Rectangle(0, 0, 10, -1)});
+    BOOST_CHECK(index.IsEmpty());
+    BOOST_CHECK(!index.Intersects(Rectangle(0, 0, 20, 20)));
+}
+
+BOOST_AUTO_TEST_CASE(TestRegionIndexRebuilt)
+{
+    // Enough rectangles for the region to use an index.
+    std::vector<Rectangle> rectangles;
+    for (int32_t i = 0; i < 64; i++)
+        rectangles.push_back(Rectangle(i * 20, 0, 10, 10));
+    Region region(rectangles);
+
+    BOOST_CHECK(region.Contains(5, 5));
+    BOOST_CHECK(!region.Contains(15, 5));
+
+    region.Move(10, 0);
+    BOOST_CHECK(!region.Contains(5, 5));
+    BOOST_CHECK(region.Contains(15, 5));
+
+    region.Subtract(Rectangle(0, 0, 40, 10));
+    BOOST_CHECK(!region.Intersects(Rectangle(0, 0, 40, 10)));
+    BOOST_CHECK(region.Intersects(Rectangle(0, 0, 60, 10)));
+
+    std::vector<uint32_t> indices;
+    region.Query(Rectangle(0, 0, 100, 10), indices);
+    BOOST_CHECK_EQUAL(indices.size(), 3);
+
+    std::vector<std::pair<int32_t, int32_t>> points = {{5, 5}, {55, 5}, {65, 5}, {55, 50}};
+    std::vector<bool> results;
+    region.Contains(points, results);
+    const std::vector<bool> expected = {false, true, false, false};
+    BOOST_CHECK(results == expected);
+
+    std::vector<bool> hits;
+    region.Intersects({Rectangle(45, 0, 10, 10), Rectangle(60, 0, 10, 10)}, hits);
+    BOOST_CHECK(hits[0]);
+    BOOST_CHECK(!hits[1]);
+}
@@ -20,6 +20,7 @@
  ******************************************************************************************************/
 #define BOOST_TEST_DYN_LINK
 #include <boost/test/auto_unit_test.hpp>
+#include <cstdlib>
 #include <sstream>
 #include "Logger.hpp"
 #include "Region.hpp"
@@ -439,3 +440,162 @@ BOOST_AUTO_TEST_CASE(RegionXor4Formed)
     BOOST_CHECK(r2.Contains(Rectangle(20, 0, 10, 30)));
     BOOST_CHECK_EQUAL(r2.Size(), 4);
 }
+
+BOOST_AUTO_TEST_CASE(RegionArea)
+{
+    // 11
+    // 1X2
+    //  22
+    Region r1({Rectangle(0, 0, 20, 20), Rectangle(10, 10, 20, 20)});
+    BOOST_CHECK_EQUAL(r1.Area(), 700);
+
+    // Duplicates, containment and empty rectangles add nothing.
+    Region r2({Rectangle(0, 0, 10, 10), Rectangle(0, 0, 10, 10), Rectangle(2, 2, 4, 4), Rectangle(50, 50, 0, 10)});
+    BOOST_CHECK_EQUAL(r2.Area(), 100);
+
+    BOOST_CHECK_EQUAL(Region().Area(), 0);
+
+    // Larger than 32 bits.
+    Region r3({Rectangle(0, 0, 100000, 100000), Rectangle(-100000, 0, 100000, 100000)});
+    BOOST_CHECK_EQUAL(r3.Area(), 20000000000LL);
+}
+
+BOOST_AUTO_TEST_CASE(RegionContainsCovered)
+{
+    // Covered by pieces without any single rectangle containing it.
+    Region r1({Rectangle(0, 0, 10, 20), Rectangle(10, 0, 10, 10), Rectangle(5, 10, 15, 10)});
+    BOOST_CHECK(r1.Contains(Rectangle(0, 0, 20, 20)));
+    BOOST_CHECK(r1.Contains(Rectangle(3, 3, 14, 14)));
+
+    // Overlapping pieces adding up to the area but leaving a hole.
+    Region r2({Rectangle(0, 0, 10, 20), Rectangle(5, 0, 10, 20), Rectangle(10, 0, 10, 10)});
+    BOOST_CHECK(!r2.Contains(Rectangle(0, 0, 20, 20)));
+    BOOST_CHECK(r2.Contains(Rectangle(0, 0, 20, 10)));
+}
+
+BOOST_AUTO_TEST_CASE(RegionAreaRandom)
+{
+    // Compare with counting covered cells on a small grid.
+    srand(1234);
+    for (int test = 0; test < 50; test++)
+    {
+        std::vector<Rectangle> rectangles;
+        bool grid[32][32] = {};
+        for (int i = 0; i < 12; i++)
+        {
+            Rectangle r(rand() % 24, rand() % 24, 1 + rand() % 8, 1 + rand() % 8);
+            rectangles.push_back(r);
+            for (int y = r.y; y < r.y + r.height; y++)
+                for (int x = r.x; x < r.x + r.width; x++)
+                    grid[y][x] = true;
+        }
+
+        int64_t expected = 0;
+        for (int y = 0; y < 32; y++)
+            for (int x = 0; x < 32; x++)
+                expected += grid[y][x];
+
+        BOOST_CHECK_EQUAL(Region(rectangles).Area(), expected);
+    }
+}
+
+namespace
+{
+
+/** Marks each cell of a 40x40 grid the region covers */
+void Rasterize(const Region& region, bool grid[40][40])
+{
+    for (int y = 0; y < 40; y++)
+        for (int x = 0; x < 40; x++)
+            grid[y][x] = region.Contains(x, y);
+}
+
+Rectangle RandomRectangle()
+{
+    return Rectangle(rand() % 30, rand() % 30, 1 + rand() % 10, 1 + rand() % 10);
+}
+
+}
+
+BOOST_AUTO_TEST_CASE(RegionCanonical)
+{
+    // The same area built different ways gives the same rectangles.
+    Region r1({Rectangle(0, 0, 10, 10), Rectangle(10, 0, 10, 10)});
+    Region r2({Rectangle(0, 0, 20, 5), Rectangle(0, 5, 20, 5)});
+    Region r3;
+    r3.Add(Rectangle(5, 0, 15, 10));
+    r3.Add(Rectangle(0, 0, 10, 10));
+    BOOST_CHECK(r1 == r2);
+    BOOST_CHECK(r1 == r3);
+    BOOST_REQUIRE_EQUAL(r1.Size(), 1);
+    BOOST_CHECK(r1.GetData()[0] == Rectangle(0, 0, 20, 10));
+
+    // Undoing an operation gives back the original region.
+    Region r4 = r1;
+    r4.Xor(Rectangle(5, 5, 30, 30));
+    r4.Xor(Rectangle(5, 5, 30, 30));
+    BOOST_CHECK(r4 == r1);
+
+    BOOST_CHECK(Region(Rectangle(0, 0, 0, 5)) == Region());
+}
+
+BOOST_AUTO_TEST_CASE(RegionBanded)
+{
+    // 11
+    // 1122
+    //   22
+    Region r({Rectangle(0, 0, 20, 20), Rectangle(20, 10, 20, 20)});
+    const std::vector<Rectangle> expected = {Rectangle(0, 0, 20, 10), Rectangle(0, 10, 40, 10), Rectangle(20, 20, 20, 10)};
+    BOOST_CHECK(r.GetData() == expected);
+    BOOST_CHECK(r.Bounds() == Rectangle(0, 0, 40, 30));
+    BOOST_CHECK(r.Contains(Rectangle(5, 5, 30, 10)) == false);
+    BOOST_CHECK(r.Contains(Rectangle(5, 10, 30, 10)));
+    BOOST_CHECK(r.Contains(Rectangle(25, 12, 5, 15)));
+}
+
+BOOST_AUTO_TEST_CASE(RegionOperationsRandom)
+{
+    srand(4401);
+    for (int test = 0; test < 100; test++)
+    {
+        std::vector<Rectangle> a, b;
+        for (int i = 0; i < 6; i++)
+        {
+            a.push_back(RandomRectangle());
+            b.push_back(RandomRectangle());
+        }
+        Region ra(a), rb(b);
+        bool ga[40][40], gb[40][40];
+        Rasterize(ra, ga);
+        Rasterize(rb, gb);
+
+        Region results[4] = {ra, ra, ra, ra};
+        results[0].Add(rb);
+        results[1].Intersect(rb);
+        results[2].Subtract(rb);
+        results[3].Xor(rb);
+
+        for (int op = 0; op < 4; op++)
+        {
+            bool grid[40][40];
+            Rasterize(results[op], grid);
+            int64_t area = 0;
+            bool same = true;
+            for (int y = 0; y < 40; y++)
+            {
+                for (int x = 0; x < 40; x++)
+                {
+                    bool expected = op == 0 ? ga[y][x] || gb[y][x] : op == 1 ? ga[y][x] && gb[y][x] :
+                                    op == 2 ? ga[y][x] && !gb[y][x] : ga[y][x] != gb[y][x];
+                    same &= grid[y][x] == expected;
+                    area += expected;
+                }
+            }
+            BOOST_CHECK(same);
+            BOOST_CHECK_EQUAL(results[op].Area(), area);
+
+            // Rebuilding from its own rectangles must not change a banded region.
+            BOOST_CHECK(Region(results[op].GetData()) == results[op]);
+        }
+    }
+}
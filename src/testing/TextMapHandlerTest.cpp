@@ -80,8 +80,8 @@ const char* map_data_txt_file =
     "Collision\n"
     "type: 0\n"
     "dimensions: 2 2\n"
-    "data: 1 0\n"
-    "data: 1 1\n"
+    "data: -1 0\n"
+    "data: -1 -1\n"
     "\n";
 
 BOOST_AUTO_TEST_CASE(TextMapHandlerLoad)
@@ -186,7 +186,7 @@ BOOST_AUTO_TEST_CASE(TextMapHandlerLoad)
 
     TileBasedCollisionLayer* clayer = dynamic_cast<TileBasedCollisionLayer*>(map.GetCollisionLayer());
     actualData = clayer->GetData();
-    expectedData = {1, 0, 1, 1};
+    expectedData = {-1, 0, -1, -1};
     BOOST_CHECK_EQUAL(clayer->GetWidth(), 2);
     BOOST_CHECK_EQUAL(clayer->GetHeight(), 2);
     BOOST_CHECK_EQUAL_COLLECTIONS(actualData.begin(), actualData.end(), expectedData.begin(), expectedData.end());
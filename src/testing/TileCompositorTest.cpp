@@ -0,0 +1,159 @@
+/******************************************************************************************************
+ * Tile Map Editor
+ * Copyright (C) 2009-2017 Brandon Whitehead (tricksterguy87[AT]gmail[DOT]com)
+ *
+ * This software is provided 'as-is', without any express or implied warranty.
+ * In no event will the authors be held liable for any damages arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * excluding commercial applications, and to alter it and redistribute it freely,
+ * subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented;
+ *    you must not claim that you wrote the original software.
+ *    An acknowledgement in your documentation and link to the original version is required.
+ *
+ * 2. Altered source versions must be plainly marked as such,
+ *    and must not be misrepresented as being the original software.
+ *
+ * 3. This notice may not be removed or altered from any source distribution.
+ ******************************************************************************************************/
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/auto_unit_test.hpp>
+#include <chrono>
+#include "TileCompositor.hpp"
+
+namespace
+{
+
+/** A tileset of 8x8 tiles side by side each filled with one color */
+std::vector<uint8_t> SolidTiles(const std::vector<uint32_t>& colors)
+{
+    uint32_t width = colors.size() * 8;
+    std::vector<uint8_t> rgba(width * 8 * 4);
+    for (uint32_t y = 0; y < 8; y++)
+    {
+        for (uint32_t x = 0; x < width; x++)
+        {
+            uint32_t color = colors[x / 8];
+            for (uint32_t c = 0; c < 4; c++)
+                rgba[(y * width + x) * 4 + c] = color >> (24 - c * 8);
+        }
+    }
+    return rgba;
+}
+
+uint32_t Pixel(const std::vector<uint8_t>& rgba, uint32_t width, uint32_t x, uint32_t y)
+{
+    const uint8_t* pixel = &rgba[(y * width + x) * 4];
+    return (pixel[0] << 24) | (pixel[1] << 16) | (pixel[2] << 8) | pixel[3];
+}
+
+}
+
+BOOST_AUTO_TEST_CASE(TestRenderLayers)
+{
+    // Opaque red, half transparent blue and fully transparent.
+    std::vector<uint8_t> tileset = SolidTiles({0xFF0000FF, 0x0000FF80, 0x00000000});
+    TileCompositor compositor(tileset.data(), 24, 8, 8, 8);
+    BOOST_CHECK_EQUAL(compositor.GetNumTiles(), 3);
+
+    std::vector<Layer> layers;
+    layers.push_back(Layer("Bottom", 3, 1, std::vector<int32_t>({0, 0, -1})));
+    layers.push_back(Layer("Top", 3, 1, std::vector<int32_t>({1, 2, 1})));
+
+    std::vector<uint8_t> rgba(24 * 8 * 4);
+    compositor.Render(layers, 0, 0, 24, 8, rgba.data());
+    BOOST_CHECK_EQUAL(Pixel(rgba, 24, 0, 0), 0x7F0080FF);
+    BOOST_CHECK_EQUAL(Pixel(rgba, 24, 7, 7), 0x7F0080FF);
+    BOOST_CHECK_EQUAL(Pixel(rgba, 24, 8, 0), 0xFF0000FF);
+    BOOST_CHECK_EQUAL(Pixel(rgba, 24, 16, 3), 0x0000FF80);
+}
+
+BOOST_AUTO_TEST_CASE(TestRenderRegion)
+{
+    std::vector<uint8_t> tileset = SolidTiles({0xFF0000FF, 0x00FF00FF, 0x0000FFFF});
+    AnimatedTile animation("Water", 1, AnimatedTile::Normal, -1, std::vector<int32_t>({2, 1}));
+    TileCompositor compositor(tileset.data(), 24, 8, 8, 8, std::vector<AnimatedTile>(1, animation));
+
+    // Animated tiles have the top bit set and are drawn as their first frame.
+    std::vector<Layer> layers;
+    layers.push_back(Layer("", 2, 2, std::vector<int32_t>({0, 1, static_cast<int32_t>(0x80000000), 5})));
+
+    // A region straddling all four tiles and going past the layer's edge.
+    std::vector<uint8_t> rgba(10 * 14 * 4);
+    compositor.Render(layers, 4, 4, 10, 14, rgba.data());
+    BOOST_CHECK_EQUAL(Pixel(rgba, 10, 0, 0), 0xFF0000FF);
+    BOOST_CHECK_EQUAL(Pixel(rgba, 10, 4, 0), 0x00FF00FF);
+    BOOST_CHECK_EQUAL(Pixel(rgba, 10, 3, 4), 0x0000FFFF);
+    // Tile 5 is not in the tileset.
+    BOOST_CHECK_EQUAL(Pixel(rgba, 10, 4, 4), 0);
+    BOOST_CHECK_EQUAL(Pixel(rgba, 10, 0, 11), 0x0000FFFF);
+    BOOST_CHECK_EQUAL(Pixel(rgba, 10, 0, 12), 0);
+}
+
+BOOST_AUTO_TEST_CASE(TestRenderLargeMap)
+{
+    std::vector<uint8_t> tileset = SolidTiles({0xFF0000FF, 0x00FF0080, 0x0000FFFF, 0x00000000});
+    std::vector<int32_t> data(256 * 256);
+    for (uint32_t i = 0; i < data.size(); i++)
+        data[i] = i % 5 == 4 ? -1 : i % 4;
+    std::vector<Layer> layers(3, Layer("", 256, 256, data));
+
+    TileCompositor compositor(tileset.data(), 32, 8, 8, 8);
+    std::vector<uint8_t> rgba(2048 * 2048 * 4);
+    auto start = std::chrono::steady_clock::now();
+    compositor.Render(layers, 0, 0, 2048, 2048, rgba.data());
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    BOOST_TEST_MESSAGE("Rendered a 2048x2048 map with 3 layers in " << seconds << "s");
+
+    BOOST_CHECK_EQUAL(Pixel(rgba, 2048, 0, 0), 0xFF0000FF);
+    BOOST_CHECK_EQUAL(Pixel(rgba, 2048, 24, 0), 0x00000000);
+}
+
+BOOST_AUTO_TEST_CASE(TestRenderDepthAndBlending)
+{
+    std::vector<uint8_t> tileset = SolidTiles({0xFF0000FF, 0x00FF00FF, 0xFFFFFFFF});
+    TileCompositor compositor(tileset.data(), 24, 8, 8, 8);
+
+    // Drawn by depth, Under goes first even though it is last.
+    std::vector<Layer> layers;
+    layers.push_back(Layer("Over", 3, 1, std::vector<int32_t>({1, 1, 2}), DrawAttributes(1)));
+    layers.push_back(Layer("Under", 3, 1, std::vector<int32_t>({0, 0, 0}), DrawAttributes(0)));
+    layers[0].SetOpacity(50);
+    std::vector<uint8_t> rgba(24 * 8 * 4);
+    compositor.Render(layers, 0, 0, 24, 8, rgba.data());
+    BOOST_CHECK_EQUAL(Pixel(rgba, 24, 0, 0), 0x7F8000FF);
+
+    // Blend color is 0xAABBGGRR, keep red and halve green.
+    layers[0].SetOpacity(100);
+    layers[0].SetBlendColor(0xFF0080FF);
+    compositor.Render(layers, 0, 0, 24, 8, rgba.data());
+    BOOST_CHECK_EQUAL(Pixel(rgba, 24, 8, 0), 0x008000FF);
+    BOOST_CHECK_EQUAL(Pixel(rgba, 24, 16, 0), 0xFF8000FF);
+}
+
+BOOST_AUTO_TEST_CASE(TestRenderThreadsMatch)
+{
+    std::vector<uint8_t> tileset = SolidTiles({0xFF000080, 0x00FF00C0, 0x0000FF40, 0x123456FF});
+    std::vector<int32_t> data(61 * 47);
+    for (uint32_t i = 0; i < data.size(); i++)
+        data[i] = (i * 7) % 5 - 1;
+    std::vector<Layer> layers(3, Layer("", 61, 47, data));
+    layers[1].SetOpacity(37.5f);
+    layers[2].SetBlendColor(0xC08040FF);
+    layers[2].SetDepth(-1);
+
+    TileCompositor compositor(tileset.data(), 32, 8, 8, 8);
+    std::vector<uint8_t> serial(61 * 8 * 47 * 8 * 4), parallel(serial.size());
+    compositor.Render(layers, 0, 0, 61 * 8, 47 * 8, serial.data(), 1);
+    compositor.Render(layers, 0, 0, 61 * 8, 47 * 8, parallel.data(), 4);
+    BOOST_CHECK(serial == parallel);
+
+    // Bands that don't line up with the rows of tiles.
+    std::vector<uint8_t> region(100 * 50 * 4), region_parallel(region.size());
+    compositor.Render(layers, 3, 5, 100, 50, region.data(), 1);
+    compositor.Render(layers, 3, 5, 100, 50, region_parallel.data(), 3);
+    BOOST_CHECK(region == region_parallel);
+    BOOST_CHECK(std::equal(region.begin(), region.begin() + 400, serial.begin() + (5 * 61 * 8 + 3) * 4));
+}
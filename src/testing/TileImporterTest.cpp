@@ -0,0 +1,192 @@
+/******************************************************************************************************
+ * Tile Map Editor
+ * Copyright (C) 2009-2017 Brandon Whitehead (tricksterguy87[AT]gmail[DOT]com)
+ *
+ * This software is provided 'as-is', without any express or implied warranty.
+ * In no event will the authors be held liable for any damages arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * excluding commercial applications, and to alter it and redistribute it freely,
+ * subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented;
+ *    you must not claim that you wrote the original software.
+ *    An acknowledgement in your documentation and link to the original version is required.
+ *
+ * 2. Altered source versions must be plainly marked as such,
+ *    and must not be misrepresented as being the original software.
+ *
+ * 3. This notice may not be removed or altered from any source distribution.
+ ******************************************************************************************************/
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/auto_unit_test.hpp>
+#include <chrono>
+#include "Hash.hpp"
+#include "TileImporter.hpp"
+
+namespace
+{
+
+/** An RGBA image to draw 8x8 tiles into */
+class TestImage
+{
+public:
+    TestImage(uint32_t _width, uint32_t _height) : width(_width), height(_height), pixels(width * height * 4, 0) {}
+
+    void Set(uint32_t x, uint32_t y, uint8_t r, uint8_t g, uint8_t b)
+    {
+        uint8_t* pixel = &pixels[(y * width + x) * 4];
+        pixel[0] = r;
+        pixel[1] = g;
+        pixel[2] = b;
+        pixel[3] = 255;
+    }
+
+    void Fill(uint32_t tx, uint32_t ty, uint8_t r, uint8_t g, uint8_t b)
+    {
+        for (uint32_t y = 0; y < 8; y++)
+            for (uint32_t x = 0; x < 8; x++)
+                Set(tx * 8 + x, ty * 8 + y, r, g, b);
+    }
+
+    /** Draws an L shape so flips can be told apart */
+    void DrawL(uint32_t tx, uint32_t ty, bool hflip, bool vflip)
+    {
+        for (uint32_t i = 0; i < 8; i++)
+        {
+            Set(tx * 8 + (hflip ? 7 : 0), ty * 8 + (vflip ? 7 - i : i), 255, 0, 0);
+            Set(tx * 8 + (hflip ? 7 - i : i), ty * 8 + (vflip ? 0 : 7), 0, 0, 255);
+        }
+    }
+
+    uint32_t width, height;
+    std::vector<uint8_t> pixels;
+};
+
+}
+
+BOOST_AUTO_TEST_CASE(TestXXHash64)
+{
+    // Reference values from the xxHash test suite.
+    BOOST_CHECK_EQUAL(XXHash64("", 0), 0xEF46DB3751D8E999ULL);
+    BOOST_CHECK_EQUAL(XXHash64("abc", 3), 0x44BC2CF5AD770999ULL);
+    std::string text = "Nobody inspects the spammish repetition";
+    BOOST_CHECK_EQUAL(XXHash64(text.data(), text.size()), 0xFBCEA83C8A378BF1ULL);
+}
+
+BOOST_AUTO_TEST_CASE(TestImportMatchesTileset)
+{
+    TestImage tileset(24, 8);
+    tileset.Fill(0, 0, 255, 0, 0);
+    tileset.Fill(1, 0, 0, 255, 0);
+    tileset.DrawL(2, 0, false, false);
+
+    TestImage image(32, 16);
+    image.DrawL(0, 0, false, false);
+    image.Fill(1, 0, 0, 255, 0);
+    image.Fill(2, 0, 255, 0, 0);
+    image.Fill(0, 1, 0, 255, 0);
+    image.DrawL(2, 1, false, false);
+    // Tile (1, 1) is left transparent and (3, 0) and (3, 1) are new.
+    image.Fill(3, 0, 0, 0, 255);
+    image.Fill(3, 1, 0, 0, 255);
+
+    TileImporter importer;
+    importer.SetTileset(tileset.pixels.data(), tileset.width, tileset.height);
+    Layer layer = importer.Import("Screenshot", image.pixels.data(), image.width, image.height);
+
+    BOOST_CHECK_EQUAL(layer.GetName(), "Screenshot");
+    BOOST_REQUIRE_EQUAL(layer.GetWidth(), 4);
+    BOOST_REQUIRE_EQUAL(layer.GetHeight(), 2);
+    std::vector<int32_t> expected = {2, 1, 0, 3, 1, -1, 2, 3};
+    for (uint32_t i = 0; i < expected.size(); i++)
+        BOOST_CHECK_EQUAL(layer.At(i % 4, i / 4), expected[i]);
+    BOOST_CHECK_EQUAL(importer.GetNumTiles(), 4);
+    BOOST_CHECK_EQUAL(importer.GetNumNewTiles(), 1);
+
+    // The new tile goes on a row of its own below the tileset's.
+    std::vector<uint8_t> rgba;
+    uint32_t width, height;
+    importer.GetTileset(rgba, width, height);
+    BOOST_REQUIRE_EQUAL(width, 24);
+    BOOST_REQUIRE_EQUAL(height, 16);
+    BOOST_CHECK(std::equal(tileset.pixels.begin(), tileset.pixels.end(), rgba.begin()));
+    BOOST_CHECK_EQUAL(rgba[(8 * width) * 4 + 2], 255);
+    BOOST_CHECK_EQUAL(rgba[(8 * width + 8) * 4 + 3], 0);
+}
+
+BOOST_AUTO_TEST_CASE(TestImportBuildsTileset)
+{
+    // 10x10 pixels so the right and bottom blocks are partial.
+    TestImage image(10, 10);
+    image.Fill(0, 0, 255, 0, 0);
+    image.Set(9, 9, 0, 255, 0);
+
+    TileImporter importer;
+    Layer layer = importer.Import("", image.pixels.data(), image.width, image.height);
+    BOOST_REQUIRE_EQUAL(layer.GetWidth(), 2);
+    BOOST_REQUIRE_EQUAL(layer.GetHeight(), 2);
+    BOOST_CHECK_EQUAL(layer.At(0, 0), 0);
+    BOOST_CHECK_EQUAL(layer.At(1, 0), -1);
+    BOOST_CHECK_EQUAL(layer.At(0, 1), -1);
+    BOOST_CHECK_EQUAL(layer.At(1, 1), 1);
+    BOOST_CHECK_EQUAL(importer.GetNumNewTiles(), 2);
+
+    // Importing the same picture again reuses the tiles.
+    layer = importer.Import("", image.pixels.data(), image.width, image.height);
+    BOOST_CHECK_EQUAL(layer.At(1, 1), 1);
+    BOOST_CHECK_EQUAL(importer.GetNumTiles(), 2);
+
+    std::vector<uint8_t> rgba;
+    uint32_t width, height;
+    importer.GetTileset(rgba, width, height);
+    BOOST_CHECK_EQUAL(width, 16);
+    BOOST_CHECK_EQUAL(height, 8);
+    BOOST_CHECK_EQUAL(rgba[(1 * width + 9) * 4 + 1], 255);
+}
+
+BOOST_AUTO_TEST_CASE(TestImportFlips)
+{
+    TestImage tileset(8, 8);
+    tileset.DrawL(0, 0, false, false);
+
+    TestImage image(32, 8);
+    image.DrawL(0, 0, false, false);
+    image.DrawL(1, 0, true, false);
+    image.DrawL(2, 0, false, true);
+    image.DrawL(3, 0, true, true);
+
+    TileImporter flipped(8, 8, true);
+    flipped.SetTileset(tileset.pixels.data(), tileset.width, tileset.height);
+    Layer layer = flipped.Import("", image.pixels.data(), image.width, image.height);
+    for (uint32_t i = 0; i < 4; i++)
+        BOOST_CHECK_EQUAL(layer.At(i, 0), 0);
+    std::vector<uint8_t> expected = {0, TileImporter::HFLIP, TileImporter::VFLIP, TileImporter::HFLIP | TileImporter::VFLIP};
+    BOOST_CHECK(flipped.GetFlips() == expected);
+    BOOST_CHECK_EQUAL(flipped.GetNumNewTiles(), 0);
+
+    TileImporter unflipped;
+    unflipped.SetTileset(tileset.pixels.data(), tileset.width, tileset.height);
+    layer = unflipped.Import("", image.pixels.data(), image.width, image.height);
+    for (uint32_t i = 0; i < 4; i++)
+        BOOST_CHECK_EQUAL(layer.At(i, 0), static_cast<int32_t>(i));
+    BOOST_CHECK_EQUAL(unflipped.GetNumNewTiles(), 3);
+}
+
+BOOST_AUTO_TEST_CASE(TestImportLargeImage)
+{
+    // 2048x2048 image drawn from 256 different tiles.
+    TestImage image(2048, 2048);
+    for (uint32_t ty = 0; ty < 256; ty++)
+        for (uint32_t tx = 0; tx < 256; tx++)
+            image.Fill(tx, ty, (tx * 7 + ty * 13) & 0xFF, 0, 0);
+
+    TileImporter importer;
+    auto start = std::chrono::steady_clock::now();
+    Layer layer = importer.Import("", image.pixels.data(), image.width, image.height);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    BOOST_TEST_MESSAGE("Imported 65536 tiles in " << seconds << "s");
+
+    BOOST_CHECK_EQUAL(importer.GetNumTiles(), 256);
+    BOOST_CHECK_EQUAL(layer.At(0, 0), layer.At(13, 249));
+}
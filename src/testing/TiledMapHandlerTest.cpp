@@ -0,0 +1,427 @@
+/******************************************************************************************************
+ * Tile Map Editor
+ * Copyright (C) 2009-2017 Brandon Whitehead (tricksterguy87[AT]gmail[DOT]com)
+ *
+ * This software is provided 'as-is', without any express or implied warranty.
+ * In no event will the authors be held liable for any damages arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * excluding commercial applications, and to alter it and redistribute it freely,
+ * subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented;
+ *    you must not claim that you wrote the original software.
+ *    An acknowledgement in your documentation and link to the original version is required.
+ *
+ * 2. Altered source versions must be plainly marked as such,
+ *    and must not be misrepresented as being the original software.
+ *
+ * 3. This notice may not be removed or altered from any source distribution.
+ ******************************************************************************************************/
+#define BOOST_TEST_DYN_LINK
+#include <memory>
+#include <sstream>
+#include <boost/test/auto_unit_test.hpp>
+#include "Map.hpp"
+#include "PixelBasedCollisionLayer.hpp"
+#include "TileBasedCollisionLayer.hpp"
+#include "TiledJsonMapHandler.hpp"
+#include "TmxMapHandler.hpp"
+
+namespace
+{
+
+std::vector<std::shared_ptr<TiledMapHandler>> AllTiledHandlers()
+{
+    std::vector<std::shared_ptr<TiledMapHandler>> handlers;
+    for (const auto encoding : {TiledMapHandler::Csv, TiledMapHandler::Base64, TiledMapHandler::Base64Zlib, TiledMapHandler::Base64Gzip})
+    {
+        handlers.emplace_back(new TmxMapHandler(encoding));
+        handlers.emplace_back(new TiledJsonMapHandler(encoding));
+    }
+    return handlers;
+}
+
+}
+
+BOOST_AUTO_TEST_CASE(TiledMapHandlerRoundTrip)
+{
+    std::vector<int32_t> data(32 * 16, -1);
+    for (size_t i = 0; i < data.size(); i += 3)
+        data[i] = i % 40;
+    std::vector<int32_t> collision(32 * 16, 0);
+    collision[17] = -1;
+
+    DrawAttributes attr(3);
+    attr.SetPosition(32, -24);
+    attr.SetOrigin(10, 12);
+    attr.SetScale(3.0f, 5.0f);
+    attr.SetRotation(92.5f);
+    attr.SetOpacity(50.0f);
+    attr.SetBlendMode(2);
+    attr.SetBlendColor(0xFEFDFCFA);
+
+    Map map("HELLO WORLD");
+    Tileset tileset("011-PortTown01.png", 32, 16);
+    tileset.Add(AnimatedTile("Water", 3, AnimatedTile::Normal, -1, {4, 5, 6, 7}));
+    map.SetTileset(tileset);
+    map.Add(Layer("A", 32, 16, data, attr));
+    map.Add(Background("B", "003-StarlitSky01.png", Background::Repeating | Background::Autoscroll, 2, 4.5));
+    map.SetCollisionLayer(new TileBasedCollisionLayer(32, 16, collision));
+
+    for (const auto& handler : AllTiledHandlers())
+    {
+        BOOST_TEST_MESSAGE(handler->GetName() << " encoding " << handler->GetEncoding());
+        Map loaded;
+        std::stringstream out;
+        try
+        {
+            handler->Save(out, map);
+            BOOST_CHECK(handler->Sniff(out.str().substr(0, BaseMapHandler::HEADER_SIZE)));
+            handler->Load(out, loaded);
+        }
+        catch (const char* s)
+        {
+            BOOST_FAIL(s);
+            return;
+        }
+
+        BOOST_CHECK_EQUAL(loaded.GetName(), "HELLO WORLD");
+        uint32_t tile_width, tile_height;
+        loaded.GetTileset().GetTileDimensions(tile_width, tile_height);
+        BOOST_CHECK_EQUAL(loaded.GetTileset().GetFilename(), "011-PortTown01.png");
+        BOOST_CHECK_EQUAL(tile_width, 32);
+        BOOST_CHECK_EQUAL(tile_height, 16);
+
+        const std::vector<AnimatedTile>& animated_tiles = loaded.GetTileset().GetAnimatedTiles();
+        BOOST_REQUIRE_EQUAL(animated_tiles.size(), 1);
+        BOOST_CHECK_EQUAL(animated_tiles[0].GetDelay(), 3);
+        BOOST_CHECK_EQUAL(animated_tiles[0].GetNumFrames(), 4);
+        BOOST_CHECK_EQUAL(animated_tiles[0].GetFrames()[3], 7);
+
+        BOOST_REQUIRE_EQUAL(loaded.GetNumLayers(), 1);
+        const Layer& layer = loaded.GetLayer(0);
+        const std::vector<int32_t>& actualData = layer.GetData();
+        BOOST_CHECK_EQUAL(layer.GetName(), "A");
+        BOOST_CHECK_EQUAL(layer.GetWidth(), 32);
+        BOOST_CHECK_EQUAL(layer.GetHeight(), 16);
+        BOOST_CHECK_EQUAL_COLLECTIONS(actualData.begin(), actualData.end(), data.begin(), data.end());
+
+        int32_t x, y;
+        float sx, sy;
+        layer.GetPosition(x, y);
+        layer.GetScale(sx, sy);
+        BOOST_CHECK_EQUAL(layer.GetDepth(), 3);
+        BOOST_CHECK_EQUAL(x, 32);
+        BOOST_CHECK_EQUAL(y, -24);
+        BOOST_CHECK_EQUAL(sx, 3.0f);
+        BOOST_CHECK_EQUAL(sy, 5.0f);
+        BOOST_CHECK_EQUAL(layer.GetRotation(), 92.5f);
+        BOOST_CHECK_EQUAL(layer.GetOpacity(), 50.0f);
+        BOOST_CHECK_EQUAL(layer.GetBlendMode(), 2);
+        BOOST_CHECK_EQUAL(layer.GetBlendColor(), 0xFEFDFCFAU);
+
+        BOOST_REQUIRE_EQUAL(loaded.GetNumBackgrounds(), 1);
+        const Background& background = loaded.GetBackground(0);
+        background.GetSpeed(sx, sy);
+        BOOST_CHECK_EQUAL(background.GetName(), "B");
+        BOOST_CHECK_EQUAL(background.GetFilename(), "003-StarlitSky01.png");
+        BOOST_CHECK_EQUAL(background.GetMode(), Background::Repeating | Background::Autoscroll);
+        BOOST_CHECK_EQUAL(background.GetDepth(), -1);
+        BOOST_CHECK_EQUAL(sx, 2.0f);
+        BOOST_CHECK_EQUAL(sy, 4.5f);
+
+        BOOST_REQUIRE(loaded.HasCollisionLayer());
+        TileBasedCollisionLayer* clayer = dynamic_cast<TileBasedCollisionLayer*>(loaded.GetCollisionLayer());
+        BOOST_REQUIRE(clayer != nullptr);
+        const std::vector<int32_t>& actualCollision = clayer->GetData();
+        BOOST_CHECK_EQUAL_COLLECTIONS(actualCollision.begin(), actualCollision.end(), collision.begin(), collision.end());
+    }
+}
+
+BOOST_AUTO_TEST_CASE(TiledMapHandlerPixelCollision)
+{
+    std::vector<Rectangle> rectangles = {Rectangle(0, 0, 16, 8), Rectangle(-32, 40, 8, 8)};
+    Map map("Pixels");
+    map.SetCollisionLayer(new PixelBasedCollisionLayer(rectangles));
+
+    for (const auto& handler : AllTiledHandlers())
+    {
+        Map loaded;
+        std::stringstream out;
+        handler->Save(out, map);
+        handler->Load(out, loaded);
+
+        BOOST_REQUIRE(loaded.HasCollisionLayer());
+        PixelBasedCollisionLayer* clayer = dynamic_cast<PixelBasedCollisionLayer*>(loaded.GetCollisionLayer());
+        BOOST_REQUIRE(clayer != nullptr);
+        BOOST_CHECK(*clayer == *dynamic_cast<PixelBasedCollisionLayer*>(map.GetCollisionLayer()));
+    }
+
+    std::stringstream tmx, json;
+    TmxMapHandler().Save(tmx, map);
+    TiledJsonMapHandler().Save(json, map);
+    BOOST_CHECK(tmx.str().find("nextobjectid=\"3\"") != std::string::npos);
+    BOOST_CHECK(json.str().find("\"nextobjectid\": 3") != std::string::npos);
+}
+
+BOOST_AUTO_TEST_CASE(TmxMapHandlerLoadChunkedCollision)
+{
+    // Chunks are placed by their offsets, the one left of the origin is dropped.
+    std::stringstream file(
+        "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+        "<map version=\"1.10\" orientation=\"orthogonal\" renderorder=\"right-down\" width=\"4\" height=\"3\" tilewidth=\"16\" tileheight=\"16\" infinite=\"1\">\n"
+        " <layer id=\"1\" name=\"Collision\" width=\"4\" height=\"3\">\n"
+        "  <properties>\n"
+        "   <property name=\"collision\" value=\"tile\"/>\n"
+        "  </properties>\n"
+        "  <data encoding=\"csv\">\n"
+        "   <chunk x=\"2\" y=\"1\" width=\"2\" height=\"2\">\n1,2,\n3,1\n</chunk>\n"
+        "   <chunk x=\"-1\" y=\"2\" width=\"2\" height=\"1\">\n4,2\n</chunk>\n"
+        "  </data>\n"
+        " </layer>\n"
+        "</map>\n");
+
+    TmxMapHandler handler;
+    Map map;
+    try
+    {
+        handler.Load(file, map);
+    }
+    catch (const char* s)
+    {
+        BOOST_FAIL(s);
+        return;
+    }
+
+    BOOST_REQUIRE(map.HasCollisionLayer());
+    TileBasedCollisionLayer* clayer = dynamic_cast<TileBasedCollisionLayer*>(map.GetCollisionLayer());
+    BOOST_REQUIRE(clayer != nullptr);
+    BOOST_CHECK_EQUAL(clayer->GetWidth(), 4);
+    BOOST_CHECK_EQUAL(clayer->GetHeight(), 3);
+    // Tile collision is stored as blocked or not, so every nonzero gid reads back as -1.
+    std::vector<int32_t> expected = {-1, -1, -1, -1, -1, -1, 0, -1, -1, -1, -1, 0};
+    const std::vector<int32_t>& actual = clayer->GetData();
+    BOOST_CHECK_EQUAL_COLLECTIONS(actual.begin(), actual.end(), expected.begin(), expected.end());
+}
+
+BOOST_AUTO_TEST_CASE(TmxMapHandlerLoadNegativeCollision)
+{
+    // Every chunk is left of the origin, so the collision layer is left with no tiles from the file.
+    std::stringstream file(
+        "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+        "<map version=\"1.10\" orientation=\"orthogonal\" renderorder=\"right-down\" width=\"4\" height=\"2\" tilewidth=\"16\" tileheight=\"16\" infinite=\"1\">\n"
+        " <layer id=\"1\" name=\"Collision\" width=\"4\" height=\"2\">\n"
+        "  <properties>\n"
+        "   <property name=\"collision\" value=\"tile\"/>\n"
+        "  </properties>\n"
+        "  <data encoding=\"csv\">\n"
+        "   <chunk x=\"-4\" y=\"0\" width=\"2\" height=\"2\">\n1,1,\n1,1\n</chunk>\n"
+        "  </data>\n"
+        " </layer>\n"
+        "</map>\n");
+
+    TmxMapHandler handler;
+    Map map;
+    try
+    {
+        handler.Load(file, map);
+    }
+    catch (const char* s)
+    {
+        BOOST_FAIL(s);
+        return;
+    }
+
+    BOOST_REQUIRE(map.HasCollisionLayer());
+    TileBasedCollisionLayer* clayer = dynamic_cast<TileBasedCollisionLayer*>(map.GetCollisionLayer());
+    BOOST_REQUIRE(clayer != nullptr);
+    BOOST_CHECK_EQUAL(clayer->GetWidth(), 1);
+    BOOST_CHECK_EQUAL(clayer->GetHeight(), 2);
+    std::vector<int32_t> expected = {-1, -1};
+    const std::vector<int32_t>& actual = clayer->GetData();
+    BOOST_CHECK_EQUAL_COLLECTIONS(actual.begin(), actual.end(), expected.begin(), expected.end());
+}
+
+BOOST_AUTO_TEST_CASE(TmxMapHandlerLoadTiled)
+{
+    // Infinite map with chunks, a group, a later firstgid and a flipped tile as saved by Tiled.
+    std::stringstream file(
+        "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+        "<map version=\"1.10\" orientation=\"orthogonal\" renderorder=\"right-down\" width=\"4\" height=\"2\" tilewidth=\"16\" tileheight=\"16\" infinite=\"1\">\n"
+        " <properties>\n"
+        "  <property name=\"name\" value=\"Tiled\"/>\n"
+        " </properties>\n"
+        " <tileset firstgid=\"5\" name=\"tiles\" tilewidth=\"16\" tileheight=\"16\">\n"
+        "  <image source=\"tiles.png\" width=\"64\" height=\"64\"/>\n"
+        "  <tile id=\"1\">\n"
+        "   <animation>\n"
+        "    <frame tileid=\"1\" duration=\"100\"/>\n"
+        "    <frame tileid=\"2\" duration=\"100\"/>\n"
+        "   </animation>\n"
+        "  </tile>\n"
+        " </tileset>\n"
+        " <group id=\"2\" name=\"Group\" offsetx=\"8\" opacity=\"0.5\">\n"
+        "  <layer id=\"1\" name=\"Ground\" width=\"4\" height=\"2\">\n"
+        "   <data encoding=\"csv\">\n"
+        "    <chunk x=\"-2\" y=\"0\" width=\"2\" height=\"1\">\n5,6\n</chunk>\n"
+        "    <chunk x=\"0\" y=\"1\" width=\"2\" height=\"1\">\n0,2147483655\n</chunk>\n"
+        "   </data>\n"
+        "  </layer>\n"
+        " </group>\n"
+        " <layer id=\"3\" name=\"Legacy\" width=\"2\" height=\"1\">\n"
+        "  <data>\n"
+        "   <tile gid=\"6\"/>\n"
+        "   <tile/>\n"
+        "  </data>\n"
+        " </layer>\n"
+        "</map>\n");
+
+    TmxMapHandler handler;
+    Map map;
+    try
+    {
+        handler.Load(file, map);
+    }
+    catch (const char* s)
+    {
+        BOOST_FAIL(s);
+        return;
+    }
+
+    BOOST_CHECK_EQUAL(map.GetName(), "Tiled");
+    BOOST_CHECK_EQUAL(map.GetTileset().GetFilename(), "tiles.png");
+    const std::vector<AnimatedTile>& animated_tiles = map.GetTileset().GetAnimatedTiles();
+    BOOST_REQUIRE_EQUAL(animated_tiles.size(), 1);
+    BOOST_CHECK_EQUAL(animated_tiles[0].GetDelay(), 6);
+    BOOST_CHECK_EQUAL(animated_tiles[0].GetNumFrames(), 2);
+
+    BOOST_REQUIRE_EQUAL(map.GetNumLayers(), 2);
+    const Layer& layer = map.GetLayer(0);
+    std::vector<int32_t> expected = {0, 1, -1, -1, -1, -1, -1, 2};
+    const std::vector<int32_t>& actual = layer.GetData();
+    BOOST_CHECK_EQUAL(layer.GetName(), "Ground");
+    BOOST_CHECK_EQUAL(layer.GetWidth(), 4);
+    BOOST_CHECK_EQUAL(layer.GetHeight(), 2);
+    BOOST_CHECK_EQUAL_COLLECTIONS(actual.begin(), actual.end(), expected.begin(), expected.end());
+
+    int32_t x, y;
+    layer.GetPosition(x, y);
+    BOOST_CHECK_EQUAL(x, 8 - 2 * 16);
+    BOOST_CHECK_EQUAL(y, 0);
+    BOOST_CHECK_EQUAL(layer.GetOpacity(), 50.0f);
+
+    expected = {1, -1};
+    const std::vector<int32_t>& legacy = map.GetLayer(1).GetData();
+    BOOST_CHECK_EQUAL_COLLECTIONS(legacy.begin(), legacy.end(), expected.begin(), expected.end());
+}
+
+BOOST_AUTO_TEST_CASE(TiledJsonMapHandlerLoadTiled)
+{
+    std::stringstream file(
+        "{ \"compressionlevel\":-1, \"height\":1, \"infinite\":false,\n"
+        "  \"layers\":[{ \"data\":[5, 0, 7], \"height\":1, \"id\":1, \"name\":\"Ground\", \"opacity\":1,\n"
+        "      \"properties\":[{ \"name\":\"depth\", \"type\":\"int\", \"value\":4 }],\n"
+        "      \"type\":\"tilelayer\", \"visible\":true, \"width\":3, \"x\":0, \"y\":0 },\n"
+        "    { \"id\":2, \"name\":\"Walls\", \"objects\":[{ \"height\":8, \"id\":1, \"width\":16, \"x\":4.4, \"y\":8 },\n"
+        "        { \"id\":2, \"point\":true, \"x\":1, \"y\":1 }], \"opacity\":1,\n"
+        "      \"properties\":[{ \"name\":\"collision\", \"type\":\"string\", \"value\":\"pixel\" }],\n"
+        "      \"type\":\"objectgroup\", \"visible\":true, \"x\":0, \"y\":0 }],\n"
+        "  \"nextlayerid\":3, \"nextobjectid\":3, \"orientation\":\"orthogonal\", \"renderorder\":\"right-down\",\n"
+        "  \"tiledversion\":\"1.10.2\", \"tileheight\":8,\n"
+        "  \"tilesets\":[{ \"firstgid\":5, \"image\":\"tiles.png\", \"name\":\"tiles\", \"tileheight\":8, \"tilewidth\":8 }],\n"
+        "  \"tilewidth\":8, \"type\":\"map\", \"version\":\"1.10\", \"width\":3 }\n");
+
+    TiledJsonMapHandler handler;
+    BOOST_CHECK(handler.Sniff(file.str().substr(0, BaseMapHandler::HEADER_SIZE)));
+
+    Map map;
+    try
+    {
+        handler.Load(file, map);
+    }
+    catch (const char* s)
+    {
+        BOOST_FAIL(s);
+        return;
+    }
+
+    BOOST_REQUIRE_EQUAL(map.GetNumLayers(), 1);
+    std::vector<int32_t> expected = {0, -1, 2};
+    const std::vector<int32_t>& actual = map.GetLayer(0).GetData();
+    BOOST_CHECK_EQUAL_COLLECTIONS(actual.begin(), actual.end(), expected.begin(), expected.end());
+    BOOST_CHECK_EQUAL(map.GetLayer(0).GetDepth(), 4);
+
+    BOOST_REQUIRE(map.HasCollisionLayer());
+    PixelBasedCollisionLayer* clayer = dynamic_cast<PixelBasedCollisionLayer*>(map.GetCollisionLayer());
+    BOOST_REQUIRE(clayer != nullptr);
+    BOOST_REQUIRE_EQUAL(clayer->GetData().GetData().size(), 1);
+    BOOST_CHECK(clayer->GetData().GetData()[0] == Rectangle(4, 8, 16, 8));
+}
+
+BOOST_AUTO_TEST_CASE(TiledMapHandlerSniff)
+{
+    TmxMapHandler tmx;
+    TiledJsonMapHandler json;
+    BOOST_CHECK(tmx.Sniff("<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n<map version=\"1.10\""));
+    BOOST_CHECK(!tmx.Sniff("<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n<Map Version=\"1.0\""));
+    BOOST_CHECK(!tmx.Sniff("{\"height\":4"));
+    BOOST_CHECK(json.Sniff("\xEF\xBB\xBF{ \"compressionlevel\":-1"));
+    BOOST_CHECK(!json.Sniff("{ \"name\":\"not a map\""));
+    BOOST_CHECK(!json.Sniff("<?xml version=\"1.0\"?>"));
+}
+
+BOOST_AUTO_TEST_CASE(TiledMapHandlerLoadFail)
+{
+    TmxMapHandler tmx;
+    TiledJsonMapHandler json;
+    Map map;
+
+    std::stringstream short_data("<?xml version=\"1.0\"?><map><layer width=\"2\" height=\"2\"><data encoding=\"csv\">1,2,3</data></layer></map>");
+    BOOST_CHECK_THROW(tmx.Load(short_data, map), const char*);
+    std::stringstream zstd("<?xml version=\"1.0\"?><map><layer width=\"1\" height=\"1\"><data encoding=\"base64\" compression=\"zstd\">AAAA</data></layer></map>");
+    BOOST_CHECK_THROW(tmx.Load(zstd, map), const char*);
+    std::stringstream bad_json("{\"layers\":[{\"type\":\"tilelayer\",\"width\":2,\"height\":1,\"data\":[1]}]}");
+    BOOST_CHECK_THROW(json.Load(bad_json, map), const char*);
+    std::stringstream truncated("{\"layers\":[");
+    BOOST_CHECK_THROW(json.Load(truncated, map), const char*);
+}
+
+BOOST_AUTO_TEST_CASE(TiledMapHandlerLoadBadChunks)
+{
+    TmxMapHandler tmx;
+    TiledJsonMapHandler json;
+
+    // Negative, zero and huge sizes and positions that overflow when merged are rejected before anything is allocated.
+    const char* tmx_chunks[] = {
+        "<chunk x=\"0\" y=\"0\" width=\"-1\" height=\"16\"></chunk>",
+        "<chunk x=\"0\" y=\"0\" width=\"0\" height=\"16\"></chunk>",
+        "<chunk x=\"0\" y=\"0\" width=\"65536\" height=\"65536\"></chunk>",
+        "<chunk x=\"2147483647\" y=\"0\" width=\"1\" height=\"1\">1</chunk>",
+    };
+    for (const char* chunk : tmx_chunks)
+    {
+        std::stringstream file(std::string("<?xml version=\"1.0\"?><map infinite=\"1\"><layer width=\"1\" height=\"1\"><data encoding=\"csv\">") + chunk + "</data></layer></map>");
+        Map map;
+        BOOST_CHECK_THROW(tmx.Load(file, map), const char*);
+    }
+    std::stringstream huge_tmx("<?xml version=\"1.0\"?><map><layer width=\"4294967295\" height=\"4294967295\"><data encoding=\"csv\">1</data></layer></map>");
+    Map tmx_map;
+    BOOST_CHECK_THROW(tmx.Load(huge_tmx, tmx_map), const char*);
+
+    const char* json_chunks[] = {
+        "{\"x\":0,\"y\":0,\"width\":-1,\"height\":16,\"data\":[]}",
+        "{\"x\":0,\"y\":0,\"width\":0,\"height\":16,\"data\":[]}",
+        "{\"x\":0,\"y\":0,\"width\":65536,\"height\":65536,\"data\":[]}",
+        "{\"x\":-2147483648,\"y\":0,\"width\":1,\"height\":1,\"data\":[1]}",
+    };
+    for (const char* chunk : json_chunks)
+    {
+        std::stringstream file(std::string("{\"layers\":[{\"type\":\"tilelayer\",\"chunks\":[") + chunk + "]}]}");
+        Map map;
+        BOOST_CHECK_THROW(json.Load(file, map), const char*);
+    }
+    std::stringstream huge_json("{\"layers\":[{\"type\":\"tilelayer\",\"width\":-65536,\"height\":-65536,\"data\":[1]}]}");
+    Map json_map;
+    BOOST_CHECK_THROW(json.Load(huge_json, json_map), const char*);
+}
@@ -0,0 +1,142 @@
+/******************************************************************************************************
+ * Tile Map Editor
+ * Copyright (C) 2009-2017 Brandon Whitehead (tricksterguy87[AT]gmail[DOT]com)
+ *
+ * This software is provided 'as-is', without any express or implied warranty.
+ * In no event will the authors be held liable for any damages arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * excluding commercial applications, and to alter it and redistribute it freely,
+ * subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented;
+ *    you must not claim that you wrote the original software.
+ *    An acknowledgement in your documentation and link to the original version is required.
+ *
+ * 2. Altered source versions must be plainly marked as such,
+ *    and must not be misrepresented as being the original software.
+ *
+ * 3. This notice may not be removed or altered from any source distribution.
+ ******************************************************************************************************/
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/auto_unit_test.hpp>
+#include <cstdio>
+#include <fstream>
+#include <utime.h>
+#include "HandlerUtils.hpp"
+#include "TilesetCache.hpp"
+
+namespace
+{
+
+/** Replaces the cache's loader with one making a 16x8 image for the duration of a test */
+class FakeLoader
+{
+public:
+    FakeLoader() : loads(0)
+    {
+        TilesetCache().SetLoader([this](const std::string& filename, std::vector<uint8_t>& rgba, uint32_t& width, uint32_t& height)
+        {
+            if (filename.find("missing") != std::string::npos)
+                return -1;
+            loads++;
+            width = 16;
+            height = 8;
+            rgba.assign(width * height * 4, 0);
+            for (uint32_t i = 0; i < width * height; i++)
+                rgba[i * 4] = i % width;
+            return 0;
+        });
+    }
+    ~FakeLoader()
+    {
+        TilesetCache().SetLoader(&HandlerUtils::LoadImage);
+    }
+
+    int loads;
+};
+
+}
+
+BOOST_AUTO_TEST_CASE(TestTilesetCacheShares)
+{
+    FakeLoader loader;
+    std::shared_ptr<const TilesetImage> first = TilesetCache().Get("tiles.png", 8, 8);
+    std::shared_ptr<const TilesetImage> second = TilesetCache().Get("tiles.png", 8, 8);
+    BOOST_REQUIRE(first);
+    BOOST_CHECK(first == second);
+    BOOST_CHECK_EQUAL(loader.loads, 1);
+
+    BOOST_CHECK_EQUAL(first->GetNumTiles(), 2);
+    BOOST_CHECK_EQUAL(first->GetTile(1)[0], 8);
+    BOOST_CHECK_EQUAL(first->GetTile(1)[(7 * 8 + 7) * 4], 15);
+
+    // Different tile dimensions are a different entry.
+    std::shared_ptr<const TilesetImage> small = TilesetCache().Get("tiles.png", 4, 4);
+    BOOST_CHECK(small != first);
+    BOOST_CHECK_EQUAL(small->GetNumTiles(), 8);
+    BOOST_CHECK_EQUAL(loader.loads, 2);
+
+    BOOST_CHECK(!TilesetCache().Get("missing.png", 8, 8));
+}
+
+BOOST_AUTO_TEST_CASE(TestTilesetCacheReleases)
+{
+    FakeLoader loader;
+    TilesetCache().Get("tiles.png", 8, 8);
+    TilesetCache().Get("tiles.png", 8, 8);
+    // Nothing held on to it but it was recently used.
+    BOOST_CHECK_EQUAL(loader.loads, 1);
+
+    // Each image is 512 bytes, only the most recently used one fits.
+    TilesetCache().SetCapacity(600);
+    TilesetCache().Get("other.png", 8, 8);
+    TilesetCache().Get("other.png", 8, 8);
+    BOOST_CHECK_EQUAL(loader.loads, 2);
+    TilesetCache().Get("tiles.png", 8, 8);
+    BOOST_CHECK_EQUAL(loader.loads, 3);
+
+    // Nothing held on to it so it was decoded twice.
+    TilesetCache().SetCapacity(0);
+    TilesetCache().Get("tiles.png", 8, 8);
+    TilesetCache().Get("tiles.png", 8, 8);
+    BOOST_CHECK_EQUAL(loader.loads, 5);
+    TilesetCache().SetCapacity(TilesetCache::DEFAULT_CAPACITY);
+}
+
+BOOST_AUTO_TEST_CASE(TestTilesetCachePixels)
+{
+    FakeLoader loader;
+    std::vector<uint8_t> rgba;
+    // The tiles cover the image so only they are kept.
+    std::shared_ptr<const TilesetImage> whole = TilesetCache().Get("tiles.png", 8, 8);
+    BOOST_CHECK_EQUAL(whole->GetSize(), 16 * 8 * 4);
+    whole->GetPixels(rgba);
+    BOOST_REQUIRE_EQUAL(rgba.size(), 16 * 8 * 4);
+    for (uint32_t i = 0; i < 16 * 8; i++)
+        BOOST_CHECK_EQUAL(rgba[i * 4], i % 16);
+
+    // Partial tiles at the edges are only in the full image.
+    std::shared_ptr<const TilesetImage> partial = TilesetCache().Get("tiles.png", 6, 6);
+    BOOST_CHECK_EQUAL(partial->GetNumTiles(), 2);
+    partial->GetPixels(rgba);
+    BOOST_REQUIRE_EQUAL(rgba.size(), 16 * 8 * 4);
+    BOOST_CHECK_EQUAL(rgba[15 * 4], 15);
+}
+
+BOOST_AUTO_TEST_CASE(TestTilesetCacheReloadsChanged)
+{
+    FakeLoader loader;
+    const char* filename = "tileset_cache_test.png";
+    std::ofstream(filename) << "not really a png";
+
+    std::shared_ptr<const TilesetImage> first = TilesetCache().Get(filename, 8, 8);
+    BOOST_CHECK(TilesetCache().Get(filename, 8, 8) == first);
+
+    struct utimbuf times = {1000, 1000};
+    utime(filename, &times);
+    std::shared_ptr<const TilesetImage> second = TilesetCache().Get(filename, 8, 8);
+    BOOST_CHECK(second != first);
+    BOOST_CHECK_EQUAL(loader.loads, 2);
+    remove(filename);
+}
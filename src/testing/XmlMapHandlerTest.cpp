@@ -195,7 +195,7 @@ BOOST_AUTO_TEST_CASE(XmlMapHandlerTestLoad)
     BOOST_REQUIRE(map.HasCollisionLayer());
     TileBasedCollisionLayer* clayer = dynamic_cast<TileBasedCollisionLayer*>(map.GetCollisionLayer());
     actualData = clayer->GetData();
-    expectedData = {1, 0, 1, 1};
+    expectedData = {-1, 0, -1, -1};
     BOOST_CHECK_EQUAL(clayer->GetWidth(), 2);
     BOOST_CHECK_EQUAL(clayer->GetHeight(), 2);
     BOOST_CHECK_EQUAL_COLLECTIONS(actualData.begin(), actualData.end(), expectedData.begin(), expectedData.end());
@@ -233,3 +233,140 @@ BOOST_AUTO_TEST_CASE(XmlMapHandlerTestSave)
         //BOOST_CHECK_EQUAL(expectedLine, actualLine);
     }
 }
+
+BOOST_AUTO_TEST_CASE(XmlMapHandlerTestLoadBase64)
+{
+    const char* base64_data =
+        "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+        "<Map>\n"
+        "   <Properties>\n"
+        "       <Name>HELLO WORLD</Name>\n"
+        "       <Tileset>011-PortTown01.png</Tileset>\n"
+        "       <TileDimensions>32, 32</TileDimensions>\n"
+        "   </Properties>\n"
+        "   <Layer>\n"
+        "       <Name>A</Name>\n"
+        "       <Dimensions>2, 2</Dimensions>\n"
+        "       <Data encoding=\"base64\">\n"
+        "           MgAAAEYAAABGAAAAPAAAAA==\n"
+        "       </Data>\n"
+        "   </Layer>\n"
+        "   <Collision>\n"
+        "       <Type>0</Type>\n"
+        "       <Dimensions>2, 2</Dimensions>\n"
+        "       <Data encoding=\"base64\">AQAAAAAAAAABAAAAAQAAAA==</Data>\n"
+        "   </Collision>\n"
+        "</Map>\n";
+
+    XmlMapHandler handler;
+    Map map;
+
+    std::stringstream file(base64_data);
+    try
+    {
+        handler.Load(file, map);
+    }
+    catch (const char* s)
+    {
+        BOOST_FAIL(s);
+        return;
+    }
+
+    BOOST_REQUIRE_EQUAL(map.GetNumLayers(), 1);
+    const std::vector<int32_t>& actualData = map.GetLayer(0).GetData();
+    std::vector<int32_t> expectedData = {50, 70, 70, 60};
+    BOOST_CHECK_EQUAL_COLLECTIONS(actualData.begin(), actualData.end(), expectedData.begin(), expectedData.end());
+
+    BOOST_REQUIRE(map.HasCollisionLayer());
+    TileBasedCollisionLayer* clayer = dynamic_cast<TileBasedCollisionLayer*>(map.GetCollisionLayer());
+    const std::vector<int32_t>& actualCollision = clayer->GetData();
+    expectedData = {-1, 0, -1, -1};
+    BOOST_CHECK_EQUAL_COLLECTIONS(actualCollision.begin(), actualCollision.end(), expectedData.begin(), expectedData.end());
+}
+
+BOOST_AUTO_TEST_CASE(XmlMapHandlerTestDataBeforeDimensions)
+{
+    // Compressed data is decoded once the whole layer is read so it can come before the dimensions.
+    std::stringstream file(
+        "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+        "<Map>\n"
+        "   <Properties>\n"
+        "       <Name>Order</Name>\n"
+        "   </Properties>\n"
+        "   <Layer>\n"
+        "       <Name>A</Name>\n"
+        "       <Data encoding=\"base64\" compression=\"rle\">AQAAADIAAAACAAAARgAAAAEAAAA8AAAA</Data>\n"
+        "       <Dimensions>2, 2</Dimensions>\n"
+        "   </Layer>\n"
+        "</Map>\n");
+
+    XmlMapHandler handler;
+    Map map;
+    try
+    {
+        handler.Load(file, map);
+    }
+    catch (const char* s)
+    {
+        BOOST_FAIL(s);
+        return;
+    }
+
+    BOOST_REQUIRE_EQUAL(map.GetNumLayers(), 1);
+    const std::vector<int32_t>& actualData = map.GetLayer(0).GetData();
+    std::vector<int32_t> expectedData = {50, 70, 70, 60};
+    BOOST_CHECK_EQUAL_COLLECTIONS(actualData.begin(), actualData.end(), expectedData.begin(), expectedData.end());
+
+    // Missing dimensions or data that doesn't match them fail instead of loading an empty layer.
+    std::stringstream missing("<?xml version=\"1.0\"?><Map><Properties><Name>Bad</Name></Properties><Layer><Name>A</Name><Data encoding=\"base64\"></Data></Layer></Map>");
+    Map missing_map;
+    BOOST_CHECK_THROW(handler.Load(missing, missing_map), const char*);
+    std::stringstream missing_collision("<?xml version=\"1.0\"?><Map><Properties><Name>Bad</Name></Properties><Collision><Type>0</Type><Data encoding=\"base64\"></Data></Collision></Map>");
+    Map missing_collision_map;
+    BOOST_CHECK_THROW(handler.Load(missing_collision, missing_collision_map), const char*);
+    std::stringstream short_data("<?xml version=\"1.0\"?><Map><Properties><Name>Bad</Name></Properties><Layer><Name>A</Name><Dimensions>2, 2</Dimensions><Data encoding=\"base64\">MgAAAEYAAABGAAAA</Data></Layer></Map>");
+    Map short_map;
+    BOOST_CHECK_THROW(handler.Load(short_data, short_map), const char*);
+}
+
+BOOST_AUTO_TEST_CASE(XmlMapHandlerTestEncodingRoundTrip)
+{
+    std::vector<int32_t> data(32 * 16, -1);
+    for (size_t i = 0; i < data.size(); i += 3)
+        data[i] = i % 40;
+    std::vector<int32_t> collision(32 * 16, 0);
+    collision[17] = -1;
+
+    Map map("Encoded");
+    map.Add(Layer("A", 32, 16, data));
+    map.SetCollisionLayer(new TileBasedCollisionLayer(32, 16, collision));
+
+    for (const auto compression : {XmlMapHandler::NoCompression, XmlMapHandler::RleCompression, XmlMapHandler::LzCompression})
+    {
+        XmlMapHandler handler(XmlMapHandler::Base64, compression);
+        Map loaded;
+        std::stringstream out;
+        try
+        {
+            handler.Save(out, map);
+            handler.Load(out, loaded);
+        }
+        catch (const char* s)
+        {
+            BOOST_FAIL(s);
+            return;
+        }
+
+        BOOST_REQUIRE_EQUAL(loaded.GetNumLayers(), 1);
+        const std::vector<int32_t>& actualData = loaded.GetLayer(0).GetData();
+        BOOST_CHECK_EQUAL_COLLECTIONS(actualData.begin(), actualData.end(), data.begin(), data.end());
+
+        BOOST_REQUIRE(loaded.HasCollisionLayer());
+        TileBasedCollisionLayer* clayer = dynamic_cast<TileBasedCollisionLayer*>(loaded.GetCollisionLayer());
+        const std::vector<int32_t>& actualCollision = clayer->GetData();
+        BOOST_CHECK_EQUAL_COLLECTIONS(actualCollision.begin(), actualCollision.end(), collision.begin(), collision.end());
+    }
+
+    BOOST_CHECK_THROW(XmlMapHandler().SetEncoding(XmlMapHandler::Decimal, XmlMapHandler::LzCompression), const char*);
+    BOOST_CHECK_THROW(XmlMapHandler(XmlMapHandler::Decimal, XmlMapHandler::RleCompression), const char*);
+}
@@ -0,0 +1,172 @@
+/******************************************************************************************************
+ * Tile Map Editor
+ * Copyright (C) 2009-2017 Brandon Whitehead (tricksterguy87[AT]gmail[DOT]com)
+ *
+ * This software is provided 'as-is', without any express or implied warranty.
+ * In no event will the authors be held liable for any damages arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * excluding commercial applications, and to alter it and redistribute it freely,
+ * subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented;
+ *    you must not claim that you wrote the original software.
+ *    An acknowledgement in your documentation and link to the original version is required.
+ *
+ * 2. Altered source versions must be plainly marked as such,
+ *    and must not be misrepresented as being the original software.
+ *
+ * 3. This notice may not be removed or altered from any source distribution.
+ ******************************************************************************************************/
+/** Benchmark for the pathfinders.
+  * Builds a random map of wall rectangles and times A*, jump point search and HPA* on the same random requests.
+  */
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+#include <getopt.h>
+
+#include "PathFinder.hpp"
+#include "PathHierarchy.hpp"
+#include "TileBasedCollisionLayer.hpp"
+
+namespace
+{
+
+struct Options
+{
+    uint32_t size = 1024;
+    uint32_t requests = 500;
+    uint32_t cluster_size = PathHierarchy::DEFAULT_CLUSTER_SIZE;
+    uint32_t walls = 4000;
+    uint32_t seed = 1;
+};
+
+struct Request
+{
+    uint32_t sx, sy, gx, gy;
+};
+
+void Usage(const char* program)
+{
+    printf("Usage: %s [options]\n"
+           "Times A*, jump point search and HPA* on random requests over a random map.\n\n"
+           "  -s N  Width and height of the map in tiles (default: 1024)\n"
+           "  -n N  Number of path requests (default: 500)\n"
+           "  -w N  Number of wall rectangles (default: 4000)\n"
+           "  -c N  HPA* cluster size (default: %u)\n"
+           "  -r N  Random seed (default: 1)\n"
+           "  -h    Show this message\n", program, PathHierarchy::DEFAULT_CLUSTER_SIZE);
+}
+
+double Milliseconds(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+template <typename Search>
+void Run(const char* name, const std::vector<Request>& requests, PathFinder& finder, Search search)
+{
+    PathFinder::Path path;
+    uint32_t found = 0;
+    uint64_t length = 0;
+    uint64_t expanded = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (const auto& request : requests)
+    {
+        if (search(request, path))
+        {
+            found++;
+            length += path.size() - 1;
+        }
+        expanded += finder.GetExpanded();
+    }
+    double ms = Milliseconds(start);
+    printf("%-8s %10.2f ms %10.1f us/path %8u found %12.1f avg length %12.1f avg expanded\n", name, ms,
+           1000 * ms / requests.size(), found, found ? (double) length / found : 0.0, (double) expanded / requests.size());
+}
+
+}
+
+int main(int argc, char** argv)
+{
+    Options options;
+    int option;
+    while ((option = getopt(argc, argv, "s:n:w:c:r:h")) != -1)
+    {
+        switch (option)
+        {
+            case 's':
+                options.size = strtoul(optarg, NULL, 10);
+                break;
+            case 'n':
+                options.requests = strtoul(optarg, NULL, 10);
+                break;
+            case 'w':
+                options.walls = strtoul(optarg, NULL, 10);
+                break;
+            case 'c':
+                options.cluster_size = strtoul(optarg, NULL, 10);
+                break;
+            case 'r':
+                options.seed = strtoul(optarg, NULL, 10);
+                break;
+            default:
+                Usage(argv[0]);
+                return option == 'h' ? 0 : 1;
+        }
+    }
+    if (options.size == 0 || options.cluster_size == 0)
+    {
+        Usage(argv[0]);
+        return 1;
+    }
+
+    std::mt19937 random(options.seed);
+    const uint32_t size = options.size;
+    TileBasedCollisionLayer layer(size, size, std::vector<int32_t>(size * size, 0));
+    for (uint32_t i = 0; i < options.walls; i++)
+    {
+        // Thin walls of varying length so paths have to wind around them.
+        uint32_t x = random() % size;
+        uint32_t y = random() % size;
+        bool horizontal = random() % 2;
+        uint32_t length = 4 + random() % 40;
+        for (uint32_t j = 0; j < length; j++)
+            layer.Set(std::min(size - 1, x + (horizontal ? j : 0)), std::min(size - 1, y + (horizontal ? 0 : j)), -1);
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    PathGrid grid(layer);
+    printf("grid     %10.2f ms\n", Milliseconds(start));
+    start = std::chrono::steady_clock::now();
+    PathHierarchy hierarchy(grid, options.cluster_size);
+    printf("hpa*     %10.2f ms to build %u nodes\n", Milliseconds(start), hierarchy.GetNodeCount());
+
+    std::vector<Request> requests;
+    while (requests.size() < options.requests)
+    {
+        Request request = {(uint32_t) (random() % size), (uint32_t) (random() % size), (uint32_t) (random() % size), (uint32_t) (random() % size)};
+        if (grid.IsOpen(request.sx, request.sy) && grid.IsOpen(request.gx, request.gy))
+            requests.push_back(request);
+    }
+
+    PathFinder finder(grid);
+    Run("a*", requests, finder, [&](const Request& r, PathFinder::Path& path)
+    {
+        return finder.FindPath(r.sx, r.sy, r.gx, r.gy, path);
+    });
+    Run("jps", requests, finder, [&](const Request& r, PathFinder::Path& path)
+    {
+        return finder.FindPath(r.sx, r.sy, r.gx, r.gy, path, PathFinder::JumpPoint);
+    });
+    Run("hpa*", requests, finder, [&](const Request& r, PathFinder::Path& path)
+    {
+        return hierarchy.FindPath(finder, r.sx, r.sy, r.gx, r.gy, path);
+    });
+
+    return 0;
+}
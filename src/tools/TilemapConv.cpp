@@ -0,0 +1,482 @@
+/******************************************************************************************************
+ * Tile Map Editor
+ * Copyright (C) 2009-2017 Brandon Whitehead (tricksterguy87[AT]gmail[DOT]com)
+ *
+ * This software is provided 'as-is', without any express or implied warranty.
+ * In no event will the authors be held liable for any damages arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * excluding commercial applications, and to alter it and redistribute it freely,
+ * subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented;
+ *    you must not claim that you wrote the original software.
+ *    An acknowledgement in your documentation and link to the original version is required.
+ *
+ * 2. Altered source versions must be plainly marked as such,
+ *    and must not be misrepresented as being the original software.
+ *
+ * 3. This notice may not be removed or altered from any source distribution.
+ ******************************************************************************************************/
+/** Command line tool for converting maps between any of the formats registered with MapHandlerManager.
+  * Runs without initializing the wxWidgets gui so that it can be used in asset pipelines.
+  */
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <fstream>
+
+#include <dirent.h>
+#include <getopt.h>
+#include <glob.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+
+#include <wx/init.h>
+
+#include "BinaryMapHandler.hpp"
+#include "GBAMapHandler.hpp"
+#include "ImagePyramidHandler.hpp"
+#include "Logger.hpp"
+#include "Map.hpp"
+#include "MapHandlerManager.hpp"
+#include "ProtoMapHandler.hpp"
+#include "TextMapHandler.hpp"
+#include "TiledJsonMapHandler.hpp"
+#include "TmxMapHandler.hpp"
+#include "XmlMapHandler.hpp"
+
+namespace
+{
+
+struct Job
+{
+    std::string input;
+    /** Path of the output file relative to the output directory without its extension */
+    std::string output_stem;
+};
+
+struct Result
+{
+    bool ok = false;
+    /** The output was left alone as the map has not changed since it was written */
+    bool skipped = false;
+    std::string error;
+    double load_ms = 0;
+    double save_ms = 0;
+    uint64_t input_bytes = 0;
+    uint64_t output_bytes = 0;
+};
+
+struct Options
+{
+    std::string format;
+    std::string output_dir;
+    unsigned int jobs = 0;
+    bool recursive = false;
+    bool quiet = false;
+    bool skip_unchanged = false;
+};
+
+void Usage(const char* program)
+{
+    printf("Usage: %s -t FORMAT [options] INPUT...\n"
+           "Converts maps between formats, INPUT can be a file, a directory or a glob pattern.\n\n"
+           "  -t FORMAT  Output format given as a handler name or extension\n"
+           "  -o DIR     Directory to write converted files to (default: next to input)\n"
+           "  -j N       Number of worker threads (default: number of cores)\n"
+           "  -r         Search directories recursively\n"
+           "  -q         Only report failures and the summary\n"
+           "  -s         Skip maps whose contents have not changed since the output was written\n"
+           "  -l         List the available formats\n"
+           "  -h         Show this message\n", program);
+}
+
+void ListHandlers()
+{
+    for (const auto& handler : MapHandlerManager().GetHandlers())
+    {
+        printf("%-24s .%-6s %s%s  %s\n", handler->GetName().c_str(), handler->GetExtension().c_str(),
+               handler->CanRead() ? "r" : "-", handler->CanWrite() ? "w" : "-", handler->GetDescription().c_str());
+    }
+}
+
+uint64_t FileSize(const std::string& path)
+{
+    struct stat info;
+    if (stat(path.c_str(), &info) != 0)
+        return 0;
+    return info.st_size;
+}
+
+bool IsDirectory(const std::string& path)
+{
+    struct stat info;
+    return stat(path.c_str(), &info) == 0 && S_ISDIR(info.st_mode);
+}
+
+std::string StripExtension(const std::string& path)
+{
+    std::string::size_type dot = path.rfind('.');
+    std::string::size_type slash = path.rfind('/');
+    if (dot == std::string::npos || (slash != std::string::npos && dot < slash))
+        return path;
+    return path.substr(0, dot);
+}
+
+std::string BaseName(const std::string& path)
+{
+    std::string::size_type slash = path.rfind('/');
+    return slash == std::string::npos ? path : path.substr(slash + 1);
+}
+
+/** Tests if a readable handler is registered for the file's extension */
+bool IsMapFile(const std::string& path)
+{
+    std::string::size_type dot = path.rfind('.');
+    if (dot == std::string::npos)
+        return false;
+
+    std::string extension = path.substr(dot + 1);
+    std::transform(extension.begin(), extension.end(), extension.begin(), (int (*)(int))std::tolower);
+    BaseMapHandler* handler = MapHandlerManager().FindHandlerByExtension(extension);
+    return handler && handler->CanRead();
+}
+
+void ScanDirectory(const std::string& dir, const std::string& relative, bool recursive, std::vector<Job>& jobs)
+{
+    DIR* handle = opendir(dir.c_str());
+    if (!handle)
+    {
+        fprintf(stderr, "Could not open directory %s\n", dir.c_str());
+        return;
+    }
+
+    std::vector<std::string> entries;
+    while (struct dirent* entry = readdir(handle))
+    {
+        std::string name = entry->d_name;
+        if (name != "." && name != "..")
+            entries.push_back(name);
+    }
+    closedir(handle);
+    std::sort(entries.begin(), entries.end());
+
+    for (const auto& name : entries)
+    {
+        std::string path = dir + "/" + name;
+        std::string relative_path = relative.empty() ? name : relative + "/" + name;
+        if (IsDirectory(path))
+        {
+            if (recursive)
+                ScanDirectory(path, relative_path, recursive, jobs);
+        }
+        else if (IsMapFile(path))
+        {
+            jobs.push_back({path, StripExtension(relative_path)});
+        }
+    }
+}
+
+void AddInput(const std::string& input, bool recursive, std::vector<Job>& jobs)
+{
+    if (IsDirectory(input))
+    {
+        ScanDirectory(input, "", recursive, jobs);
+        return;
+    }
+
+    glob_t matches;
+    if (glob(input.c_str(), GLOB_NOSORT, NULL, &matches) != 0)
+    {
+        // Let the worker report it if the file does not exist.
+        jobs.push_back({input, StripExtension(BaseName(input))});
+        return;
+    }
+
+    std::vector<std::string> paths(matches.gl_pathv, matches.gl_pathv + matches.gl_pathc);
+    globfree(&matches);
+    std::sort(paths.begin(), paths.end());
+
+    for (const auto& path : paths)
+    {
+        if (IsDirectory(path))
+            ScanDirectory(path, "", recursive, jobs);
+        else
+            jobs.push_back({path, StripExtension(BaseName(path))});
+    }
+}
+
+/** Creates every missing directory leading up to the file path given */
+void MakeParentDirectories(const std::string& path)
+{
+    for (std::string::size_type slash = path.find('/', 1); slash != std::string::npos; slash = path.find('/', slash + 1))
+        mkdir(path.substr(0, slash).c_str(), 0755);
+}
+
+/** Path of the file recording the content hash of the map an output was written from */
+std::string HashPath(const std::string& output)
+{
+    return output + ".hash";
+}
+
+bool IsUnchanged(const std::string& output, uint64_t hash)
+{
+    std::ifstream file(HashPath(output).c_str());
+    unsigned long long stored;
+    if (!(file >> std::hex >> stored))
+        return false;
+    return stored == hash && FileSize(output) > 0;
+}
+
+void WriteHash(const std::string& output, uint64_t hash)
+{
+    std::ofstream file(HashPath(output).c_str());
+    file << std::hex << (unsigned long long) hash << "\n";
+}
+
+double Milliseconds(std::chrono::steady_clock::duration duration)
+{
+    return std::chrono::duration<double, std::milli>(duration).count();
+}
+
+Result Convert(const Job& job, const std::string& output, BaseMapHandler* handler, bool skip_unchanged)
+{
+    Result result;
+    try
+    {
+        Map map;
+        auto start = std::chrono::steady_clock::now();
+        MapHandlerManager().Load(job.input, map);
+        auto loaded = std::chrono::steady_clock::now();
+        uint64_t hash = skip_unchanged ? map.ContentHash() : 0;
+        if (skip_unchanged && IsUnchanged(output, hash))
+        {
+            result.skipped = true;
+        }
+        else
+        {
+            handler->Save(output, map);
+            if (skip_unchanged)
+                WriteHash(output, hash);
+        }
+        auto saved = std::chrono::steady_clock::now();
+
+        result.ok = true;
+        result.load_ms = Milliseconds(loaded - start);
+        result.save_ms = Milliseconds(saved - loaded);
+        result.input_bytes = FileSize(job.input);
+        result.output_bytes = FileSize(output);
+    }
+    catch (const char* error)
+    {
+        result.error = error;
+    }
+    catch (const std::string& error)
+    {
+        result.error = error;
+    }
+    catch (const std::exception& error)
+    {
+        result.error = error.what();
+    }
+    return result;
+}
+
+}
+
+int main(int argc, char** argv)
+{
+    // Only the base library is needed, no gui is initialized.
+    wxInitializer initializer;
+    if (!initializer.IsOk())
+    {
+        fprintf(stderr, "Failed to initialize wxWidgets\n");
+        return EXIT_FAILURE;
+    }
+
+    logger->SetLogTarget(&std::cerr);
+    logger->SetLogLevel(LogLevel::WARNING_LEVEL);
+
+    MapHandlerManager().Add(new BinaryMapHandler());
+    MapHandlerManager().Add(new TextMapHandler());
+    MapHandlerManager().Add(new XmlMapHandler());
+    MapHandlerManager().Add(new ProtoMapHandler());
+    MapHandlerManager().Add(new TmxMapHandler());
+    MapHandlerManager().Add(new TiledJsonMapHandler());
+    MapHandlerManager().Add(new GBAMapHandler());
+    MapHandlerManager().Add(new ImagePyramidHandler());
+
+    Options options;
+    int opt;
+    while ((opt = getopt(argc, argv, "t:o:j:rsqlh")) != -1)
+    {
+        switch (opt)
+        {
+            case 't':
+                options.format = optarg;
+                break;
+            case 'o':
+                options.output_dir = optarg;
+                break;
+            case 'j':
+                options.jobs = std::max(atoi(optarg), 1);
+                break;
+            case 'r':
+                options.recursive = true;
+                break;
+            case 's':
+                options.skip_unchanged = true;
+                break;
+            case 'q':
+                options.quiet = true;
+                break;
+            case 'l':
+                ListHandlers();
+                return EXIT_SUCCESS;
+            case 'h':
+                Usage(argv[0]);
+                return EXIT_SUCCESS;
+            default:
+                Usage(argv[0]);
+                return EXIT_FAILURE;
+        }
+    }
+
+    if (options.format.empty() || optind >= argc)
+    {
+        Usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    BaseMapHandler* handler = MapHandlerManager().FindHandlerByName(options.format);
+    if (!handler)
+        handler = MapHandlerManager().FindHandlerByExtension(options.format);
+    if (!handler || !handler->CanWrite())
+    {
+        fprintf(stderr, "No handler can write format %s, use -l to list formats\n", options.format.c_str());
+        return EXIT_FAILURE;
+    }
+
+    std::vector<Job> jobs;
+    for (int i = optind; i < argc; i++)
+        AddInput(argv[i], options.recursive, jobs);
+
+    if (jobs.empty())
+    {
+        fprintf(stderr, "No input files found\n");
+        return EXIT_FAILURE;
+    }
+
+    // Inputs sharing a name, from different directories or in different formats, would overwrite each other.
+    std::vector<std::string> outputs(jobs.size());
+    std::map<std::string, unsigned int> writers;
+    for (unsigned int i = 0; i < jobs.size(); i++)
+    {
+        const Job& job = jobs[i];
+        std::string stem = options.output_dir.empty() ? StripExtension(job.input) : options.output_dir + "/" + job.output_stem;
+        outputs[i] = stem + "." + handler->GetExtension();
+        if (outputs[i] == job.input)
+        {
+            fprintf(stderr, "Skipping %s as it is already in format %s\n", job.input.c_str(), options.format.c_str());
+            outputs[i].clear();
+            continue;
+        }
+
+        auto writer = writers.insert(std::make_pair(outputs[i], i));
+        if (!writer.second)
+        {
+            fprintf(stderr, "%s and %s would both be written to %s\n", jobs[writer.first->second].input.c_str(), job.input.c_str(),
+                    outputs[i].c_str());
+            return EXIT_FAILURE;
+        }
+    }
+
+    if (!options.output_dir.empty())
+    {
+        for (const auto& output : outputs)
+        {
+            if (!output.empty())
+                MakeParentDirectories(output);
+        }
+    }
+
+    unsigned int threads = options.jobs ? options.jobs : std::max(std::thread::hardware_concurrency(), 1u);
+    threads = std::min<unsigned int>(threads, jobs.size());
+
+    std::vector<Result> results(jobs.size());
+    std::atomic<unsigned int> next(0);
+    std::mutex print_mutex;
+
+    auto worker = [&]()
+    {
+        for (unsigned int i = next++; i < jobs.size(); i = next++)
+        {
+            if (outputs[i].empty())
+                continue;
+
+            results[i] = Convert(jobs[i], outputs[i], handler, options.skip_unchanged);
+            const Result& result = results[i];
+
+            std::lock_guard<std::mutex> lock(print_mutex);
+            if (!result.ok)
+                fprintf(stderr, "FAIL %s: %s\n", jobs[i].input.c_str(), result.error.c_str());
+            else if (result.skipped && !options.quiet)
+                printf("%s -> %s  unchanged\n", jobs[i].input.c_str(), outputs[i].c_str());
+            else if (!options.quiet)
+                printf("%s -> %s  load %.2f ms  save %.2f ms  %llu -> %llu bytes\n", jobs[i].input.c_str(), outputs[i].c_str(),
+                       result.load_ms, result.save_ms, (unsigned long long) result.input_bytes, (unsigned long long) result.output_bytes);
+        }
+    };
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> pool;
+    for (unsigned int i = 1; i < threads; i++)
+        pool.emplace_back(worker);
+    worker();
+    for (auto& thread : pool)
+        thread.join();
+    double elapsed_ms = Milliseconds(std::chrono::steady_clock::now() - start);
+
+    unsigned int converted = 0, failed = 0, skipped = 0;
+    uint64_t input_bytes = 0, output_bytes = 0;
+    double cpu_ms = 0;
+    for (unsigned int i = 0; i < results.size(); i++)
+    {
+        if (outputs[i].empty())
+            continue;
+
+        const Result& result = results[i];
+        if (!result.ok)
+        {
+            failed++;
+            continue;
+        }
+        if (result.skipped)
+        {
+            skipped++;
+            continue;
+        }
+        converted++;
+        input_bytes += result.input_bytes;
+        output_bytes += result.output_bytes;
+        cpu_ms += result.load_ms + result.save_ms;
+    }
+
+    double seconds = std::max(elapsed_ms / 1000.0, 1e-9);
+    printf("Converted %u files (%u failed, %u unchanged) in %.2f ms using %u threads\n", converted, failed, skipped, elapsed_ms, threads);
+    printf("Throughput %.1f files/s  %.2f MiB/s read  %.2f MiB/s written  average %.2f ms per file\n",
+           converted / seconds, input_bytes / seconds / (1024 * 1024), output_bytes / seconds / (1024 * 1024),
+           converted ? cpu_ms / converted : 0.0);
+
+    return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
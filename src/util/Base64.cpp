@@ -0,0 +1,262 @@
+/******************************************************************************************************
+ * Tile Map Editor
+ * Copyright (C) 2009-2017 Brandon Whitehead (tricksterguy87[AT]gmail[DOT]com)
+ *
+ * This software is provided 'as-is', without any express or implied warranty.
+ * In no event will the authors be held liable for any damages arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * excluding commercial applications, and to alter it and redistribute it freely,
+ * subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented;
+ *    you must not claim that you wrote the original software.
+ *    An acknowledgement in your documentation and link to the original version is required.
+ *
+ * 2. Altered source versions must be plainly marked as such,
+ *    and must not be misrepresented as being the original software.
+ *
+ * 3. This notice may not be removed or altered from any source distribution.
+ ******************************************************************************************************/
+#include "Base64.hpp"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define BASE64_SSSE3
+#include <tmmintrin.h>
+#endif
+
+namespace
+{
+
+const char encode_table[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+/** Maps a character to its 6 bit value or INVALID */
+struct DecodeTable
+{
+    static constexpr uint8_t INVALID = 0xFF;
+
+    DecodeTable()
+    {
+        for (int i = 0; i < 256; i++)
+            values[i] = INVALID;
+        for (int i = 0; i < 64; i++)
+            values[static_cast<uint8_t>(encode_table[i])] = i;
+    }
+
+    uint8_t operator[](char c) const { return values[static_cast<uint8_t>(c)]; }
+
+    uint8_t values[256];
+};
+
+const DecodeTable decode_table;
+
+bool IsWhitespace(char c)
+{
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+/** Encodes size bytes (a multiple of 3) returns the number of characters written */
+size_t EncodeScalar(const uint8_t* in, size_t size, char* out)
+{
+    char* start = out;
+    for (size_t i = 0; i + 3 <= size; i += 3)
+    {
+        uint32_t group = (in[i] << 16) | (in[i + 1] << 8) | in[i + 2];
+        *out++ = encode_table[(group >> 18) & 0x3F];
+        *out++ = encode_table[(group >> 12) & 0x3F];
+        *out++ = encode_table[(group >> 6) & 0x3F];
+        *out++ = encode_table[group & 0x3F];
+    }
+    return out - start;
+}
+
+/** Decodes size characters (a multiple of 4) the last group may be padded.
+  * @return number of bytes written or -1 on invalid input.
+  */
+long DecodeScalar(const char* in, size_t size, uint8_t* out)
+{
+    uint8_t* start = out;
+    for (size_t i = 0; i < size; i += 4)
+    {
+        uint8_t a = decode_table[in[i]];
+        uint8_t b = decode_table[in[i + 1]];
+        uint8_t c = decode_table[in[i + 2]];
+        uint8_t d = decode_table[in[i + 3]];
+
+        bool last = i + 4 == size;
+        int padding = 0;
+        if (last && in[i + 3] == '=')
+        {
+            padding = (in[i + 2] == '=') ? 2 : 1;
+            d = 0;
+            if (padding == 2)
+                c = 0;
+        }
+
+        if (a == DecodeTable::INVALID || b == DecodeTable::INVALID || c == DecodeTable::INVALID || d == DecodeTable::INVALID)
+            return -1;
+
+        uint32_t group = (a << 18) | (b << 12) | (c << 6) | d;
+        *out++ = (group >> 16) & 0xFF;
+        if (padding < 2)
+            *out++ = (group >> 8) & 0xFF;
+        if (padding < 1)
+            *out++ = group & 0xFF;
+    }
+    return out - start;
+}
+
+#ifdef BASE64_SSSE3
+bool HasSSSE3()
+{
+    static const bool supported = __builtin_cpu_supports("ssse3");
+    return supported;
+}
+
+/** Encodes 12 bytes at a time into 16 characters while 16 bytes are readable.
+  * Algorithm from W. Mula and D. Lemire "Faster Base64 Encoding and Decoding using AVX2 Instructions"
+  * @return number of input bytes consumed (a multiple of 3).
+  */
+__attribute__((target("ssse3")))
+size_t EncodeSSSE3(const uint8_t* in, size_t size, char* out)
+{
+    const __m128i shuffle = _mm_set_epi8(10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1);
+    const __m128i shift_lut = _mm_setr_epi8('a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+                                            '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '+' - 62,
+                                            '/' - 63, 'A', 0, 0);
+    size_t i = 0;
+    for (; i + 16 <= size; i += 12)
+    {
+        __m128i input = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+        input = _mm_shuffle_epi8(input, shuffle);
+
+        // Split each group of 3 bytes into 4 6 bit indices.
+        const __m128i t0 = _mm_and_si128(input, _mm_set1_epi32(0x0fc0fc00));
+        const __m128i t1 = _mm_mulhi_epu16(t0, _mm_set1_epi32(0x04000040));
+        const __m128i t2 = _mm_and_si128(input, _mm_set1_epi32(0x003f03f0));
+        const __m128i t3 = _mm_mullo_epi16(t2, _mm_set1_epi32(0x01000010));
+        const __m128i indices = _mm_or_si128(t1, t3);
+
+        // Translate indices to ascii by adding an offset looked up per range.
+        __m128i reduced = _mm_subs_epu8(indices, _mm_set1_epi8(51));
+        const __m128i less = _mm_cmpgt_epi8(_mm_set1_epi8(26), indices);
+        reduced = _mm_or_si128(reduced, _mm_and_si128(less, _mm_set1_epi8(13)));
+        const __m128i result = _mm_add_epi8(_mm_shuffle_epi8(shift_lut, reduced), indices);
+
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out), result);
+        out += 16;
+    }
+    return i;
+}
+
+/** Decodes 16 characters at a time into 12 bytes stopping at the first block containing an invalid character.
+  * The output buffer must have 4 bytes of slack as 16 bytes are stored per block.
+  * @return number of input characters consumed (a multiple of 4).
+  */
+__attribute__((target("ssse3")))
+size_t DecodeSSSE3(const char* in, size_t size, uint8_t* out)
+{
+    const __m128i lut_lo = _mm_setr_epi8(0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11,
+                                         0x11, 0x11, 0x13, 0x1A, 0x1B, 0x1B, 0x1B, 0x1A);
+    const __m128i lut_hi = _mm_setr_epi8(0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08,
+                                         0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10);
+    const __m128i lut_roll = _mm_setr_epi8(0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0);
+    const __m128i pack = _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1);
+    const __m128i nibble_mask = _mm_set1_epi8(0x0f);
+
+    size_t i = 0;
+    for (; i + 16 <= size; i += 16)
+    {
+        const __m128i input = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+        const __m128i hi_nibbles = _mm_and_si128(_mm_srli_epi32(input, 4), nibble_mask);
+        const __m128i lo_nibbles = _mm_and_si128(input, nibble_mask);
+
+        // Validate, any character outside the alphabet has a bit in common in both tables.
+        const __m128i lo = _mm_shuffle_epi8(lut_lo, lo_nibbles);
+        const __m128i hi = _mm_shuffle_epi8(lut_hi, hi_nibbles);
+        if (_mm_movemask_epi8(_mm_cmpgt_epi8(_mm_and_si128(lo, hi), _mm_setzero_si128())))
+            break;
+
+        const __m128i eq_slash = _mm_cmpeq_epi8(input, _mm_set1_epi8('/'));
+        const __m128i roll = _mm_shuffle_epi8(lut_roll, _mm_add_epi8(eq_slash, hi_nibbles));
+        const __m128i values = _mm_add_epi8(input, roll);
+
+        // Pack 4 6 bit values into 3 bytes.
+        const __m128i merged = _mm_maddubs_epi16(values, _mm_set1_epi32(0x01400140));
+        const __m128i packed = _mm_shuffle_epi8(_mm_madd_epi16(merged, _mm_set1_epi32(0x00011000)), pack);
+
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out), packed);
+        out += 12;
+    }
+    return i;
+}
+#endif
+
+}
+
+std::string Base64Encode(const uint8_t* data, size_t size)
+{
+    std::string out((size + 2) / 3 * 4, '=');
+    char* dest = &out[0];
+
+    size_t consumed = 0;
+#ifdef BASE64_SSSE3
+    if (HasSSSE3())
+        consumed = EncodeSSSE3(data, size, dest);
+#endif
+    size_t whole = size - (size - consumed) % 3;
+    dest += consumed / 3 * 4;
+    dest += EncodeScalar(data + consumed, whole - consumed, dest);
+
+    // Remaining 1 or 2 bytes, the rest of the group is already padding.
+    size_t remaining = size - whole;
+    if (remaining > 0)
+    {
+        uint32_t group = data[whole] << 16;
+        if (remaining == 2)
+            group |= data[whole + 1] << 8;
+        dest[0] = encode_table[(group >> 18) & 0x3F];
+        dest[1] = encode_table[(group >> 12) & 0x3F];
+        if (remaining == 2)
+            dest[2] = encode_table[(group >> 6) & 0x3F];
+    }
+
+    return out;
+}
+
+bool Base64Decode(const std::string& text, std::vector<uint8_t>& out)
+{
+    std::string compact;
+    compact.reserve(text.size());
+    for (char c : text)
+    {
+        if (!IsWhitespace(c))
+            compact.push_back(c);
+    }
+
+    out.clear();
+    if (compact.size() % 4 != 0)
+        return false;
+    if (compact.empty())
+        return true;
+
+    // Extra 4 bytes of slack for the vectorized decoder.
+    out.resize(compact.size() / 4 * 3 + 4);
+
+    size_t consumed = 0;
+#ifdef BASE64_SSSE3
+    // The final group may contain padding so it is always left for the scalar decoder.
+    if (HasSSSE3())
+        consumed = DecodeSSSE3(compact.data(), compact.size() - 4, out.data());
+#endif
+
+    long written = DecodeScalar(compact.data() + consumed, compact.size() - consumed, out.data() + consumed / 4 * 3);
+    if (written < 0)
+    {
+        out.clear();
+        return false;
+    }
+
+    out.resize(consumed / 4 * 3 + written);
+    return true;
+}
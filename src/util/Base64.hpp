@@ -0,0 +1,43 @@
+/******************************************************************************************************
+ * Tile Map Editor
+ * Copyright (C) 2009-2017 Brandon Whitehead (tricksterguy87[AT]gmail[DOT]com)
+ *
+ * This software is provided 'as-is', without any express or implied warranty.
+ * In no event will the authors be held liable for any damages arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * excluding commercial applications, and to alter it and redistribute it freely,
+ * subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented;
+ *    you must not claim that you wrote the original software.
+ *    An acknowledgement in your documentation and link to the original version is required.
+ *
+ * 2. Altered source versions must be plainly marked as such,
+ *    and must not be misrepresented as being the original software.
+ *
+ * 3. This notice may not be removed or altered from any source distribution.
+ ******************************************************************************************************/
+#ifndef BASE64_HPP
+#define BASE64_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/** Encodes binary data as base64 (RFC 4648 alphabet with '=' padding).
+  * On x86 processors supporting SSSE3 the bulk of the data is encoded 12 bytes at a time.
+  * @param data Bytes to encode.
+  * @param size Number of bytes to encode.
+  * @return The base64 encoded text.
+  */
+std::string Base64Encode(const uint8_t* data, size_t size);
+/** Decodes base64 text, whitespace in the text is ignored.
+  * @param text Base64 encoded text.
+  * @param out Where to store the decoded bytes, any existing contents are replaced.
+  * @return true if the text was valid base64 false otherwise.
+  */
+bool Base64Decode(const std::string& text, std::vector<uint8_t>& out);
+
+#endif
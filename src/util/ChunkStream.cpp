@@ -132,6 +132,18 @@ ChunkStreamReader& ChunkStreamReader::operator>>(std::string& val)
     return *this;
 }
 
+ChunkStreamReader& ChunkStreamReader::Read(int32_t* values, uint32_t count)
+{
+    stream.read(reinterpret_cast<char*>(values), count * sizeof(int32_t));
+    for (uint32_t i = 0; i < count; i++)
+        values[i] = ntohl(values[i]);
+    VerboseLog("Reading %zd ints size: %zd bytes", count, count * sizeof(int32_t));
+    consumed_size += count * sizeof(int32_t);
+    if (consumed_size > size)
+        DebugFatalLog("Read past end of chunk %s %zd bytes read out of %zd", name.c_str(), consumed_size, size);
+    return *this;
+}
+
 ChunkStreamReader& ChunkStreamReader::operator>>(ChunkStreamReader& (*pf)(ChunkStreamReader&))
 {
     return pf(*this);
@@ -45,14 +45,19 @@ public:
     ChunkStreamReader& operator>>(float& val);
     ChunkStreamReader& operator>>(std::string& val);
     ChunkStreamReader& operator>>(ChunkStreamReader& (*pf)(ChunkStreamReader&));
+    /** Reads count ints at once, faster than reading them one at a time */
+    ChunkStreamReader& Read(int32_t* values, uint32_t count);
     void SetFlags(uint32_t _flags) { flags = _flags; }
     void SetWidth(uint32_t _width) { width = _width; }
     const std::string& Name() const { return name; }
     uint32_t Size() const { return size; }
     uint32_t ConsumedSize() const { return consumed_size; }
+    uint32_t RemainingSize() const { return consumed_size < size ? size - consumed_size : 0; }
     uint32_t Flags() const { return flags; }
     uint32_t Width() const { return width; }
     bool Ok() const { return !stream.fail() && consumed_size == size; }
+    /** Tests if a read failed or went past the end of the chunk, unlike Ok this can be checked before the chunk is fully read */
+    bool Fail() const { return stream.fail() || consumed_size > size; }
     enum
     {
         NO_READ_STRING_SIZES = 0,
@@ -0,0 +1,297 @@
+/******************************************************************************************************
+ * Tile Map Editor
+ * Copyright (C) 2009-2017 Brandon Whitehead (tricksterguy87[AT]gmail[DOT]com)
+ *
+ * This software is provided 'as-is', without any express or implied warranty.
+ * In no event will the authors be held liable for any damages arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * excluding commercial applications, and to alter it and redistribute it freely,
+ * subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented;
+ *    you must not claim that you wrote the original software.
+ *    An acknowledgement in your documentation and link to the original version is required.
+ *
+ * 2. Altered source versions must be plainly marked as such,
+ *    and must not be misrepresented as being the original software.
+ *
+ * 3. This notice may not be removed or altered from any source distribution.
+ ******************************************************************************************************/
+#include "Compression.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <zlib.h>
+
+namespace
+{
+
+/** Shortest match worth encoding */
+constexpr uint32_t MIN_MATCH = 4;
+/** Farthest back a match can reference */
+constexpr uint32_t MAX_OFFSET = 0xFFFF;
+constexpr uint32_t HASH_BITS = 14;
+/** Size of the buffer zlib inflates into before handing the bytes off */
+constexpr size_t INFLATE_BLOCK_SIZE = 16384;
+
+uint32_t Read32(const uint8_t* ptr)
+{
+    uint32_t value;
+    memcpy(&value, ptr, sizeof(value));
+    return value;
+}
+
+uint32_t Hash(uint32_t sequence)
+{
+    return (sequence * 2654435761U) >> (32 - HASH_BITS);
+}
+
+void WriteLength(std::vector<uint8_t>& out, uint32_t length)
+{
+    while (length >= 255)
+    {
+        out.push_back(255);
+        length -= 255;
+    }
+    out.push_back(length);
+}
+
+bool ReadLength(const std::vector<uint8_t>& data, size_t& pos, uint32_t& length)
+{
+    uint8_t byte;
+    do
+    {
+        if (pos >= data.size())
+            return false;
+        byte = data[pos++];
+        length += byte;
+    } while (byte == 255);
+    return true;
+}
+
+void WriteSequence(std::vector<uint8_t>& out, const uint8_t* literals, uint32_t num_literals, uint32_t offset, uint32_t match_length)
+{
+    uint32_t match_code = match_length == 0 ? 0 : match_length - MIN_MATCH;
+    uint8_t token = (std::min(num_literals, 15U) << 4) | std::min(match_code, 15U);
+    out.push_back(token);
+    if (num_literals >= 15)
+        WriteLength(out, num_literals - 15);
+    out.insert(out.end(), literals, literals + num_literals);
+
+    // The final sequence of the block only has literals.
+    if (match_length == 0)
+        return;
+
+    out.push_back(offset & 0xFF);
+    out.push_back(offset >> 8);
+    if (match_code >= 15)
+        WriteLength(out, match_code - 15);
+}
+
+}
+
+void PackLittleEndian(const std::vector<int32_t>& values, std::vector<uint8_t>& out)
+{
+    out.resize(values.size() * 4);
+    for (size_t i = 0; i < values.size(); i++)
+    {
+        uint32_t value = values[i];
+        out[i * 4] = value & 0xFF;
+        out[i * 4 + 1] = (value >> 8) & 0xFF;
+        out[i * 4 + 2] = (value >> 16) & 0xFF;
+        out[i * 4 + 3] = (value >> 24) & 0xFF;
+    }
+}
+
+bool UnpackLittleEndian(const std::vector<uint8_t>& data, std::vector<int32_t>& values)
+{
+    if (data.size() % 4 != 0)
+        return false;
+
+    values.resize(data.size() / 4);
+    for (size_t i = 0; i < values.size(); i++)
+    {
+        const uint8_t* ptr = data.data() + i * 4;
+        values[i] = static_cast<int32_t>(ptr[0] | (ptr[1] << 8) | (ptr[2] << 16) | (static_cast<uint32_t>(ptr[3]) << 24));
+    }
+    return true;
+}
+
+void RleEncode(const std::vector<int32_t>& values, std::vector<uint8_t>& out)
+{
+    std::vector<int32_t> pairs;
+    for (size_t i = 0; i < values.size();)
+    {
+        size_t run = 1;
+        while (i + run < values.size() && values[i + run] == values[i])
+            run++;
+        pairs.push_back(run);
+        pairs.push_back(values[i]);
+        i += run;
+    }
+    PackLittleEndian(pairs, out);
+}
+
+bool RleDecode(const std::vector<uint8_t>& data, size_t size, std::vector<int32_t>& values)
+{
+    std::vector<int32_t> pairs;
+    if (!UnpackLittleEndian(data, pairs) || pairs.size() % 2 != 0)
+        return false;
+
+    values.clear();
+    for (size_t i = 0; i < pairs.size(); i += 2)
+    {
+        if (pairs[i] <= 0 || static_cast<size_t>(pairs[i]) > size - values.size())
+            return false;
+        values.insert(values.end(), pairs[i], pairs[i + 1]);
+    }
+    return values.size() == size;
+}
+
+void LzCompress(const std::vector<uint8_t>& data, std::vector<uint8_t>& out)
+{
+    out.clear();
+    out.reserve(data.size() / 2 + 16);
+
+    const uint8_t* src = data.data();
+    const uint32_t size = data.size();
+    // Positions + 1 of the last time a 4 byte sequence was seen, 0 for never.
+    std::vector<uint32_t> table(1 << HASH_BITS, 0);
+
+    uint32_t anchor = 0;
+    uint32_t i = 0;
+    while (i + MIN_MATCH <= size)
+    {
+        uint32_t sequence = Read32(src + i);
+        uint32_t hash = Hash(sequence);
+        uint32_t candidate = table[hash];
+        table[hash] = i + 1;
+
+        if (candidate == 0 || i + 1 - candidate > MAX_OFFSET || Read32(src + candidate - 1) != sequence)
+        {
+            i++;
+            continue;
+        }
+
+        candidate--;
+        uint32_t length = MIN_MATCH;
+        while (i + length < size && src[candidate + length] == src[i + length])
+            length++;
+
+        WriteSequence(out, src + anchor, i - anchor, i - candidate, length);
+        i += length;
+        anchor = i;
+    }
+
+    WriteSequence(out, src + anchor, size - anchor, 0, 0);
+}
+
+bool LzDecompress(const std::vector<uint8_t>& data, size_t max_size, std::vector<uint8_t>& out)
+{
+    out.clear();
+    size_t pos = 0;
+    while (pos < data.size())
+    {
+        uint8_t token = data[pos++];
+
+        uint32_t num_literals = token >> 4;
+        if (num_literals == 15 && !ReadLength(data, pos, num_literals))
+            return false;
+        if (num_literals > data.size() - pos || num_literals > max_size - out.size())
+            return false;
+        out.insert(out.end(), data.begin() + pos, data.begin() + pos + num_literals);
+        pos += num_literals;
+
+        // Literals only sequence ends the block.
+        if (pos == data.size())
+            break;
+
+        if (pos + 2 > data.size())
+            return false;
+        uint32_t offset = data[pos] | (data[pos + 1] << 8);
+        pos += 2;
+
+        uint32_t match_length = token & 0xF;
+        if (match_length == 15 && !ReadLength(data, pos, match_length))
+            return false;
+        match_length += MIN_MATCH;
+
+        if (offset == 0 || offset > out.size() || match_length > max_size - out.size())
+            return false;
+
+        // Matches may overlap the bytes being written so copy one at a time.
+        size_t from = out.size() - offset;
+        out.reserve(out.size() + match_length);
+        for (uint32_t j = 0; j < match_length; j++)
+            out.push_back(out[from + j]);
+    }
+    return true;
+}
+
+void ZlibCompress(const uint8_t* data, size_t size, std::vector<uint8_t>& out, bool gzip)
+{
+    z_stream stream;
+    memset(&stream, 0, sizeof(stream));
+    // 15 window bits for zlib, adding 16 writes a gzip wrapper instead.
+    if (deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, gzip ? 15 + 16 : 15, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+        throw "Failed to initialize zlib";
+
+    out.resize(deflateBound(&stream, size) + (gzip ? 18 : 0));
+    stream.next_in = const_cast<Bytef*>(data);
+    stream.avail_in = size;
+    stream.next_out = out.data();
+    stream.avail_out = out.size();
+    int status = deflate(&stream, Z_FINISH);
+    out.resize(stream.total_out);
+    deflateEnd(&stream);
+
+    if (status != Z_STREAM_END)
+        throw "Failed to compress data";
+}
+
+bool ZlibDecompress(const uint8_t* data, size_t size, const std::function<bool(const uint8_t*, size_t)>& sink)
+{
+    z_stream stream;
+    memset(&stream, 0, sizeof(stream));
+    // 15 window bits, adding 32 detects either a zlib or gzip header.
+    if (inflateInit2(&stream, 15 + 32) != Z_OK)
+        return false;
+
+    uint8_t block[INFLATE_BLOCK_SIZE];
+    stream.next_in = const_cast<Bytef*>(data);
+    stream.avail_in = size;
+
+    int status = Z_OK;
+    while (status == Z_OK)
+    {
+        stream.next_out = block;
+        stream.avail_out = sizeof(block);
+        status = inflate(&stream, Z_NO_FLUSH);
+        if (status != Z_OK && status != Z_STREAM_END)
+            break;
+
+        size_t produced = sizeof(block) - stream.avail_out;
+        if (produced > 0 && !sink(block, produced))
+        {
+            status = Z_DATA_ERROR;
+            break;
+        }
+        // No progress possible means the input was truncated.
+        if (status == Z_OK && produced == 0 && stream.avail_in == 0)
+            status = Z_BUF_ERROR;
+    }
+    inflateEnd(&stream);
+
+    return status == Z_STREAM_END;
+}
+
+bool ZlibDecompress(const std::vector<uint8_t>& data, std::vector<uint8_t>& out)
+{
+    out.clear();
+    return ZlibDecompress(data.data(), data.size(), [&out](const uint8_t* block, size_t size) -> bool
+    {
+        out.insert(out.end(), block, block + size);
+        return true;
+    });
+}
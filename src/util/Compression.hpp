@@ -0,0 +1,97 @@
+/******************************************************************************************************
+ * Tile Map Editor
+ * Copyright (C) 2009-2017 Brandon Whitehead (tricksterguy87[AT]gmail[DOT]com)
+ *
+ * This software is provided 'as-is', without any express or implied warranty.
+ * In no event will the authors be held liable for any damages arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * excluding commercial applications, and to alter it and redistribute it freely,
+ * subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented;
+ *    you must not claim that you wrote the original software.
+ *    An acknowledgement in your documentation and link to the original version is required.
+ *
+ * 2. Altered source versions must be plainly marked as such,
+ *    and must not be misrepresented as being the original software.
+ *
+ * 3. This notice may not be removed or altered from any source distribution.
+ ******************************************************************************************************/
+#ifndef COMPRESSION_HPP
+#define COMPRESSION_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+/** Serializes 32 bit values as little endian bytes.
+  * @param values Values to serialize.
+  * @param out Where to store the bytes (4 per value).
+  */
+void PackLittleEndian(const std::vector<int32_t>& values, std::vector<uint8_t>& out);
+/** Deserializes little endian bytes into 32 bit values.
+  * @param data Bytes to read, must be a multiple of 4 bytes.
+  * @param values Where to store the values.
+  * @return true on success false if the size is not a multiple of 4.
+  */
+bool UnpackLittleEndian(const std::vector<uint8_t>& data, std::vector<int32_t>& values);
+
+/** Run length encodes values as pairs of (run length, value).
+  * Each pair is stored as two little endian 32 bit integers.
+  * @param values Values to encode.
+  * @param out Where to store the encoded bytes.
+  */
+void RleEncode(const std::vector<int32_t>& values, std::vector<uint8_t>& out);
+/** Decodes data from RleEncode.
+  * Runs are checked against the expected size before anything is allocated, so a few bytes can't
+  * expand into a huge buffer.
+  * @param data Encoded bytes.
+  * @param size Number of values the data must decode to.
+  * @param values Where to store the decoded values.
+  * @return true on success false if the data is malformed or doesn't decode to size values.
+  */
+bool RleDecode(const std::vector<uint8_t>& data, size_t size, std::vector<int32_t>& values);
+
+/** Compresses bytes using LZ77 with a hash table match finder.
+  * The output is a sequence of (literals, match) pairs laid out like an LZ4 block:
+  * a token byte holding the literal length and match length in its high and low nibbles,
+  * extra length bytes, the literals, then a 16 bit little endian match offset.
+  * @param data Bytes to compress.
+  * @param out Where to store the compressed bytes.
+  */
+void LzCompress(const std::vector<uint8_t>& data, std::vector<uint8_t>& out);
+/** Decompresses data from LzCompress.
+  * Stops as soon as the output would grow past max_size, so long runs of length bytes can't
+  * expand into a huge buffer.
+  * @param data Compressed bytes.
+  * @param max_size Most bytes the data may decompress to.
+  * @param out Where to store the decompressed bytes.
+  * @return true on success false if the data is malformed or decompresses to more than max_size bytes.
+  */
+bool LzDecompress(const std::vector<uint8_t>& data, size_t max_size, std::vector<uint8_t>& out);
+
+/** Compresses bytes with zlib's deflate.
+  * @param data Bytes to compress.
+  * @param size Number of bytes to compress.
+  * @param out Where to store the compressed bytes.
+  * @param gzip If true a gzip header and trailer are written instead of a zlib one.
+  */
+void ZlibCompress(const uint8_t* data, size_t size, std::vector<uint8_t>& out, bool gzip = false);
+/** Decompresses zlib or gzip data (detected from the header) a block at a time.
+  * The whole decompressed data is never held in memory at once.
+  * @param data Compressed bytes.
+  * @param size Number of compressed bytes.
+  * @param sink Called with each block of decompressed bytes, return false to stop with an error.
+  * @return true on success false if the data is malformed or the sink returned false.
+  */
+bool ZlibDecompress(const uint8_t* data, size_t size, const std::function<bool(const uint8_t*, size_t)>& sink);
+/** Decompresses zlib or gzip data (detected from the header).
+  * @param data Compressed bytes.
+  * @param out Where to store the decompressed bytes.
+  * @return true on success false if the data is malformed.
+  */
+bool ZlibDecompress(const std::vector<uint8_t>& data, std::vector<uint8_t>& out);
+
+#endif
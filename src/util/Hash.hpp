@@ -0,0 +1,59 @@
+/******************************************************************************************************
+ * Tile Map Editor
+ * Copyright (C) 2009-2017 Brandon Whitehead (tricksterguy87[AT]gmail[DOT]com)
+ *
+ * This software is provided 'as-is', without any express or implied warranty.
+ * In no event will the authors be held liable for any damages arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * excluding commercial applications, and to alter it and redistribute it freely,
+ * subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented;
+ *    you must not claim that you wrote the original software.
+ *    An acknowledgement in your documentation and link to the original version is required.
+ *
+ * 2. Altered source versions must be plainly marked as such,
+ *    and must not be misrepresented as being the original software.
+ *
+ * 3. This notice may not be removed or altered from any source distribution.
+ ******************************************************************************************************/
+#ifndef HASH_HPP
+#define HASH_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/** Hashes a block of memory with xxHash (XXH64).
+  * Matches the reference implementation's output so hashes can be compared with other tools.
+  * @param data Bytes to hash.
+  * @param size Number of bytes to hash.
+  * @param seed Seed for the hash.
+  * @return The 64 bit hash.
+  */
+uint64_t XXHash64(const void* data, size_t size, uint64_t seed = 0);
+
+/** Mixes a value into a running hash.
+  * @param seed Hash so far.
+  * @param value Value to mix in.
+  * @return The new hash.
+  */
+uint64_t HashCombine(uint64_t seed, uint64_t value);
+
+/** Mixes a string into a running hash.
+  * The length is mixed in first so that consecutive strings can not run together.
+  * @param seed Hash so far.
+  * @param str String to mix in.
+  * @return The new hash.
+  */
+uint64_t HashString(uint64_t seed, const std::string& str);
+
+/** Mixes a float into a running hash, 0 and -0 hash the same.
+  * @param seed Hash so far.
+  * @param value Value to mix in.
+  * @return The new hash.
+  */
+uint64_t HashFloat(uint64_t seed, float value);
+
+#endif
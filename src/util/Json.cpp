@@ -0,0 +1,578 @@
+/******************************************************************************************************
+ * Tile Map Editor
+ * Copyright (C) 2009-2017 Brandon Whitehead (tricksterguy87[AT]gmail[DOT]com)
+ *
+ * This software is provided 'as-is', without any express or implied warranty.
+ * In no event will the authors be held liable for any damages arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * excluding commercial applications, and to alter it and redistribute it freely,
+ * subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented;
+ *    you must not claim that you wrote the original software.
+ *    An acknowledgement in your documentation and link to the original version is required.
+ *
+ * 2. Altered source versions must be plainly marked as such,
+ *    and must not be misrepresented as being the original software.
+ *
+ * 3. This notice may not be removed or altered from any source distribution.
+ ******************************************************************************************************/
+#include "Json.hpp"
+
+#include <cctype>
+#include <cmath>
+#include <cstdio>
+#include <iterator>
+#include <locale>
+#include <sstream>
+
+namespace
+{
+
+/** Deepest nesting of arrays and objects accepted, keeps malicious input from overflowing the stack */
+constexpr int MAX_DEPTH = 512;
+
+const JsonValue null_value;
+
+void AppendUtf8(std::string& out, uint32_t codepoint)
+{
+    if (codepoint < 0x80)
+    {
+        out += static_cast<char>(codepoint);
+    }
+    else if (codepoint < 0x800)
+    {
+        out += static_cast<char>(0xC0 | (codepoint >> 6));
+        out += static_cast<char>(0x80 | (codepoint & 0x3F));
+    }
+    else if (codepoint < 0x10000)
+    {
+        out += static_cast<char>(0xE0 | (codepoint >> 12));
+        out += static_cast<char>(0x80 | ((codepoint >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (codepoint & 0x3F));
+    }
+    else
+    {
+        out += static_cast<char>(0xF0 | (codepoint >> 18));
+        out += static_cast<char>(0x80 | ((codepoint >> 12) & 0x3F));
+        out += static_cast<char>(0x80 | ((codepoint >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (codepoint & 0x3F));
+    }
+}
+
+void AppendString(std::string& out, const std::string& value)
+{
+    static const char hex[] = "0123456789abcdef";
+    out += '"';
+    for (const char ch : value)
+    {
+        switch (ch)
+        {
+            case '"':
+                out += "\\\"";
+                break;
+            case '\\':
+                out += "\\\\";
+                break;
+            case '\n':
+                out += "\\n";
+                break;
+            case '\r':
+                out += "\\r";
+                break;
+            case '\t':
+                out += "\\t";
+                break;
+            default:
+                if (static_cast<unsigned char>(ch) < 0x20)
+                {
+                    out += "\\u00";
+                    out += hex[ch >> 4];
+                    out += hex[ch & 0xF];
+                }
+                else
+                {
+                    out += ch;
+                }
+                break;
+        }
+    }
+    out += '"';
+}
+
+void AppendNumber(std::string& out, double value)
+{
+    // Integers (nearly all numbers in a map) skip the slow floating point formatting.
+    if (value == std::floor(value) && std::fabs(value) < 9007199254740992.0)
+    {
+        int64_t integer = static_cast<int64_t>(value);
+        char buffer[24];
+        char* end = buffer + sizeof(buffer);
+        char* ptr = end;
+        uint64_t magnitude = integer < 0 ? -static_cast<uint64_t>(integer) : integer;
+        do
+        {
+            *--ptr = '0' + magnitude % 10;
+            magnitude /= 10;
+        } while (magnitude);
+        if (integer < 0)
+            *--ptr = '-';
+        out.append(ptr, end);
+        return;
+    }
+
+    if (!std::isfinite(value))
+        throw "Can not write infinity or NaN as JSON";
+
+    // Shortest of 15 or 17 significant digits that reads back as the same value, always with '.' as the decimal point.
+    std::ostringstream stream;
+    stream.imbue(std::locale::classic());
+    for (int precision : {15, 17})
+    {
+        stream.str("");
+        stream.precision(precision);
+        stream << value;
+        std::istringstream check(stream.str());
+        check.imbue(std::locale::classic());
+        double read = 0;
+        check >> read;
+        if (read == value)
+            break;
+    }
+    out += stream.str();
+}
+
+void AppendNewline(std::string& out, int indent, int depth)
+{
+    if (indent <= 0)
+        return;
+    out += '\n';
+    out.append(indent * depth, ' ');
+}
+
+}
+
+/** Recursive descent parser producing JsonValues */
+class JsonParser
+{
+public:
+    JsonParser(const std::string& _text) : text(_text), pos(0) {}
+
+    JsonValue ParseDocument()
+    {
+        JsonValue value;
+        ParseValue(value, 0);
+        SkipWhitespace();
+        if (pos != text.size())
+            throw "Unexpected text after JSON value";
+        return value;
+    }
+
+private:
+    void SkipWhitespace()
+    {
+        while (pos < text.size() && (text[pos] == ' ' || text[pos] == '\t' || text[pos] == '\n' || text[pos] == '\r'))
+            pos++;
+    }
+
+    bool Consume(char ch)
+    {
+        SkipWhitespace();
+        if (pos < text.size() && text[pos] == ch)
+        {
+            pos++;
+            return true;
+        }
+        return false;
+    }
+
+    void Expect(const char* literal)
+    {
+        for (const char* ch = literal; *ch; ch++, pos++)
+        {
+            if (pos >= text.size() || text[pos] != *ch)
+                throw "Invalid JSON literal";
+        }
+    }
+
+    void ParseValue(JsonValue& value, int depth)
+    {
+        if (depth > MAX_DEPTH)
+            throw "JSON nested too deeply";
+
+        SkipWhitespace();
+        if (pos >= text.size())
+            throw "Unexpected end of JSON";
+
+        switch (text[pos])
+        {
+            case '{':
+                ParseObject(value, depth);
+                break;
+            case '[':
+                ParseArray(value, depth);
+                break;
+            case '"':
+                value.type = JsonValue::String;
+                ParseString(value.string);
+                break;
+            case 't':
+                Expect("true");
+                value = JsonValue(true);
+                break;
+            case 'f':
+                Expect("false");
+                value = JsonValue(false);
+                break;
+            case 'n':
+                Expect("null");
+                value = JsonValue();
+                break;
+            default:
+                value = JsonValue(ParseNumber());
+                break;
+        }
+    }
+
+    void ParseObject(JsonValue& value, int depth)
+    {
+        value.type = JsonValue::Object;
+        pos++;
+        if (Consume('}'))
+            return;
+
+        do
+        {
+            SkipWhitespace();
+            if (pos >= text.size() || text[pos] != '"')
+                throw "Expected JSON object key";
+
+            value.members.emplace_back();
+            ParseString(value.members.back().first);
+            if (!Consume(':'))
+                throw "Expected ':' after JSON object key";
+            ParseValue(value.members.back().second, depth + 1);
+        } while (Consume(','));
+
+        if (!Consume('}'))
+            throw "Expected ',' or '}' in JSON object";
+    }
+
+    void ParseArray(JsonValue& value, int depth)
+    {
+        value.type = JsonValue::NumberArray;
+        pos++;
+        if (Consume(']'))
+            return;
+
+        do
+        {
+            SkipWhitespace();
+            if (value.type == JsonValue::NumberArray && pos < text.size() && (text[pos] == '-' || (text[pos] >= '0' && text[pos] <= '9')))
+            {
+                value.numbers.push_back(ParseNumber());
+                continue;
+            }
+
+            // Not all numbers, unpack what was read so far.
+            if (value.type == JsonValue::NumberArray)
+            {
+                value.type = JsonValue::Array;
+                value.elements.reserve(value.numbers.size() + 1);
+                for (const double number : value.numbers)
+                    value.elements.emplace_back(number);
+                value.numbers.clear();
+                value.numbers.shrink_to_fit();
+            }
+            value.elements.emplace_back();
+            ParseValue(value.elements.back(), depth + 1);
+        } while (Consume(','));
+
+        if (!Consume(']'))
+            throw "Expected ',' or ']' in JSON array";
+    }
+
+    double ParseNumber()
+    {
+        size_t start = pos;
+        bool negative = pos < text.size() && text[pos] == '-';
+        if (negative)
+            pos++;
+
+        // Fast path for integers.
+        uint64_t integer = 0;
+        size_t digits = 0;
+        while (pos < text.size() && text[pos] >= '0' && text[pos] <= '9')
+        {
+            integer = integer * 10 + (text[pos] - '0');
+            pos++;
+            digits++;
+        }
+        if (digits == 0)
+            throw "Invalid JSON value";
+
+        bool fraction = pos < text.size() && (text[pos] == '.' || text[pos] == 'e' || text[pos] == 'E');
+        if (!fraction && digits < 19)
+            return negative ? -static_cast<double>(integer) : static_cast<double>(integer);
+
+        // Numbers with fractions or exponents are rare, read them locale independently.
+        while (pos < text.size() && (isdigit(text[pos]) || text[pos] == '.' || text[pos] == 'e' || text[pos] == 'E' ||
+                                     text[pos] == '+' || text[pos] == '-'))
+            pos++;
+        std::istringstream stream(text.substr(start, pos - start));
+        stream.imbue(std::locale::classic());
+        double value;
+        stream >> value;
+        if (stream.fail() || !stream.eof())
+            throw "Invalid JSON number";
+        return value;
+    }
+
+    uint32_t ParseHex4()
+    {
+        if (pos + 4 > text.size())
+            throw "Invalid JSON unicode escape";
+
+        uint32_t value = 0;
+        for (int i = 0; i < 4; i++)
+        {
+            char ch = text[pos++];
+            value <<= 4;
+            if (ch >= '0' && ch <= '9')
+                value |= ch - '0';
+            else if (ch >= 'a' && ch <= 'f')
+                value |= ch - 'a' + 10;
+            else if (ch >= 'A' && ch <= 'F')
+                value |= ch - 'A' + 10;
+            else
+                throw "Invalid JSON unicode escape";
+        }
+        return value;
+    }
+
+    void ParseString(std::string& out)
+    {
+        pos++;
+        while (true)
+        {
+            // Copy runs without escapes in one go.
+            size_t end = text.find_first_of("\"\\", pos);
+            if (end == std::string::npos)
+                throw "Unterminated JSON string";
+            out.append(text, pos, end - pos);
+            pos = end + 1;
+
+            if (text[end] == '"')
+                return;
+
+            if (pos >= text.size())
+                throw "Unterminated JSON string";
+            char escape = text[pos++];
+            switch (escape)
+            {
+                case '"':
+                case '\\':
+                case '/':
+                    out += escape;
+                    break;
+                case 'b':
+                    out += '\b';
+                    break;
+                case 'f':
+                    out += '\f';
+                    break;
+                case 'n':
+                    out += '\n';
+                    break;
+                case 'r':
+                    out += '\r';
+                    break;
+                case 't':
+                    out += '\t';
+                    break;
+                case 'u':
+                {
+                    uint32_t codepoint = ParseHex4();
+                    if (codepoint >= 0xD800 && codepoint < 0xDC00)
+                    {
+                        Expect("\\u");
+                        uint32_t low = ParseHex4();
+                        if (low < 0xDC00 || low >= 0xE000)
+                            throw "Invalid JSON surrogate pair";
+                        codepoint = 0x10000 + ((codepoint - 0xD800) << 10) + (low - 0xDC00);
+                    }
+                    AppendUtf8(out, codepoint);
+                    break;
+                }
+                default:
+                    throw "Invalid JSON escape";
+            }
+        }
+    }
+
+    const std::string& text;
+    size_t pos;
+};
+
+JsonValue JsonValue::Make(Type type)
+{
+    JsonValue value;
+    value.type = type;
+    return value;
+}
+
+size_t JsonValue::Size() const
+{
+    switch (type)
+    {
+        case Array:
+            return elements.size();
+        case NumberArray:
+            return numbers.size();
+        case Object:
+            return members.size();
+        default:
+            return 0;
+    }
+}
+
+const JsonValue& JsonValue::Get(const std::string& key) const
+{
+    for (const auto& member : members)
+    {
+        if (member.first == key)
+            return member.second;
+    }
+    return null_value;
+}
+
+bool JsonValue::Has(const std::string& key) const
+{
+    for (const auto& member : members)
+    {
+        if (member.first == key)
+            return true;
+    }
+    return false;
+}
+
+JsonValue& JsonValue::Add(const JsonValue& value)
+{
+    if (type == NumberArray && value.type == Number)
+    {
+        numbers.push_back(value.number);
+        return *this;
+    }
+
+    if (type == NumberArray)
+    {
+        type = Array;
+        for (const double number : numbers)
+            elements.emplace_back(number);
+        numbers.clear();
+    }
+    else if (type != Array)
+    {
+        throw "Can only add elements to a JSON array";
+    }
+
+    elements.push_back(value);
+    return elements.back();
+}
+
+JsonValue& JsonValue::Set(const std::string& key, const JsonValue& value)
+{
+    if (type != Object)
+        throw "Can only set members of a JSON object";
+
+    for (auto& member : members)
+    {
+        if (member.first == key)
+        {
+            member.second = value;
+            return member.second;
+        }
+    }
+
+    members.emplace_back(key, value);
+    return members.back().second;
+}
+
+JsonValue JsonValue::Parse(const std::string& text)
+{
+    JsonParser parser(text);
+    return parser.ParseDocument();
+}
+
+JsonValue JsonValue::Parse(std::istream& stream)
+{
+    std::string text((std::istreambuf_iterator<char>(stream)), std::istreambuf_iterator<char>());
+    return Parse(text);
+}
+
+void JsonValue::Write(std::ostream& out, int indent) const
+{
+    std::string text;
+    Write(text, indent, 0);
+    if (indent > 0)
+        text += '\n';
+    out.write(text.data(), text.size());
+}
+
+void JsonValue::Write(std::string& out, int indent, int depth) const
+{
+    switch (type)
+    {
+        case Null:
+            out += "null";
+            break;
+        case Bool:
+            out += number != 0 ? "true" : "false";
+            break;
+        case Number:
+            AppendNumber(out, number);
+            break;
+        case String:
+            AppendString(out, string);
+            break;
+        case NumberArray:
+            out += '[';
+            for (size_t i = 0; i < numbers.size(); i++)
+            {
+                if (i)
+                    out += ',';
+                AppendNumber(out, numbers[i]);
+            }
+            out += ']';
+            break;
+        case Array:
+            out += '[';
+            for (size_t i = 0; i < elements.size(); i++)
+            {
+                if (i)
+                    out += ',';
+                AppendNewline(out, indent, depth + 1);
+                elements[i].Write(out, indent, depth + 1);
+            }
+            if (!elements.empty())
+                AppendNewline(out, indent, depth);
+            out += ']';
+            break;
+        case Object:
+            out += '{';
+            for (size_t i = 0; i < members.size(); i++)
+            {
+                if (i)
+                    out += ',';
+                AppendNewline(out, indent, depth + 1);
+                AppendString(out, members[i].first);
+                out += indent > 0 ? ": " : ":";
+                members[i].second.Write(out, indent, depth + 1);
+            }
+            if (!members.empty())
+                AppendNewline(out, indent, depth);
+            out += '}';
+            break;
+    }
+}
@@ -0,0 +1,131 @@
+/******************************************************************************************************
+ * Tile Map Editor
+ * Copyright (C) 2009-2017 Brandon Whitehead (tricksterguy87[AT]gmail[DOT]com)
+ *
+ * This software is provided 'as-is', without any express or implied warranty.
+ * In no event will the authors be held liable for any damages arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * excluding commercial applications, and to alter it and redistribute it freely,
+ * subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented;
+ *    you must not claim that you wrote the original software.
+ *    An acknowledgement in your documentation and link to the original version is required.
+ *
+ * 2. Altered source versions must be plainly marked as such,
+ *    and must not be misrepresented as being the original software.
+ *
+ * 3. This notice may not be removed or altered from any source distribution.
+ ******************************************************************************************************/
+#ifndef JSON_HPP
+#define JSON_HPP
+
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+/** A parsed JSON value.
+  * Arrays made up entirely of numbers are stored packed as a NumberArray, since tile data is
+  * thousands of numbers and a full JsonValue per number would be wasteful.
+  */
+class JsonValue
+{
+public:
+    enum Type
+    {
+        Null = 0,
+        Bool = 1,
+        Number = 2,
+        String = 3,
+        /** Array of arbitrary values */
+        Array = 4,
+        /** Array containing only numbers */
+        NumberArray = 5,
+        Object = 6,
+    };
+
+    JsonValue() : type(Null), number(0) {}
+    JsonValue(bool value) : type(Bool), number(value) {}
+    JsonValue(int32_t value) : type(Number), number(value) {}
+    JsonValue(uint32_t value) : type(Number), number(value) {}
+    JsonValue(int64_t value) : type(Number), number(static_cast<double>(value)) {}
+    JsonValue(double value) : type(Number), number(value) {}
+    JsonValue(const char* value) : type(String), number(0), string(value) {}
+    JsonValue(const std::string& value) : type(String), number(0), string(value) {}
+    /** Creates an empty value of the type given */
+    static JsonValue Make(Type type);
+
+    Type GetType() const { return type; }
+    bool IsNull() const { return type == Null; }
+    bool IsNumber() const { return type == Number; }
+    bool IsString() const { return type == String; }
+    bool IsArray() const { return type == Array || type == NumberArray; }
+    bool IsObject() const { return type == Object; }
+
+    bool AsBool(bool def = false) const { return type == Bool ? number != 0 : def; }
+    double AsNumber(double def = 0) const { return type == Number ? number : def; }
+    int64_t AsInt(int64_t def = 0) const { return type == Number ? static_cast<int64_t>(number) : def; }
+    /** Gets the string value or an empty string if this is not a String */
+    const std::string& AsString() const { return string; }
+
+    /** Number of elements of an array or members of an object */
+    size_t Size() const;
+    /** Elements of an Array (empty for a NumberArray) */
+    const std::vector<JsonValue>& GetElements() const { return elements; }
+    /** Elements of a NumberArray (empty for an Array) */
+    const std::vector<double>& GetNumbers() const { return numbers; }
+    std::vector<double>& GetNumbers() { return numbers; }
+    /** Members of an Object in the order they appear */
+    const std::vector<std::pair<std::string, JsonValue>>& GetMembers() const { return members; }
+
+    /** Finds a member of an Object.
+      * @param key Name of the member.
+      * @return The member's value, or a Null value if there is no such member.
+      */
+    const JsonValue& Get(const std::string& key) const;
+    bool Has(const std::string& key) const;
+
+    /** Appends an element to an Array.
+      * @return The added element.
+      */
+    JsonValue& Add(const JsonValue& value);
+    /** Adds a member to an Object, replacing any member with the same key.
+      * @return The added member.
+      */
+    JsonValue& Set(const std::string& key, const JsonValue& value);
+
+    /** Parses JSON text.
+      * @param text Text to parse.
+      * @return The parsed value.
+      * @throws const char* describing the error if the text is not valid JSON.
+      */
+    static JsonValue Parse(const std::string& text);
+    /** Parses a JSON document from a stream.
+      * @see Parse
+      */
+    static JsonValue Parse(std::istream& stream);
+    /** Writes this value as JSON text.
+      * @param out Stream to write to.
+      * @param indent Spaces to indent nested values by, 0 writes everything on one line.
+      *               Number arrays are always written on one line.
+      */
+    void Write(std::ostream& out, int indent = 0) const;
+
+private:
+    void Write(std::string& out, int indent, int depth) const;
+
+    Type type;
+    double number;
+    std::string string;
+    std::vector<JsonValue> elements;
+    std::vector<double> numbers;
+    std::vector<std::pair<std::string, JsonValue>> members;
+
+    friend class JsonParser;
+};
+
+#endif
@@ -0,0 +1,455 @@
+/******************************************************************************************************
+ * Tile Map Editor
+ * Copyright (C) 2009-2017 Brandon Whitehead (tricksterguy87[AT]gmail[DOT]com)
+ *
+ * This software is provided 'as-is', without any express or implied warranty.
+ * In no event will the authors be held liable for any damages arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * excluding commercial applications, and to alter it and redistribute it freely,
+ * subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented;
+ *    you must not claim that you wrote the original software.
+ *    An acknowledgement in your documentation and link to the original version is required.
+ *
+ * 2. Altered source versions must be plainly marked as such,
+ *    and must not be misrepresented as being the original software.
+ *
+ * 3. This notice may not be removed or altered from any source distribution.
+ ******************************************************************************************************/
+#include "Quantizer.hpp"
+
+#include <algorithm>
+#include <functional>
+#include <unordered_map>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define QUANTIZER_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace
+{
+
+uint32_t Channel(uint32_t color, uint32_t axis) { return (color >> (16 - axis * 8)) & 0xFF; }
+
+/** A palette laid out for comparing against four entries at a time.
+  * Red and green are interleaved as 16 bit pairs and blue is paired with 0 so
+  * a multiply-add of the differences gives the squared distance of each entry.
+  */
+class PaletteLanes
+{
+public:
+    explicit PaletteLanes(const std::vector<uint32_t>& palette) : size(palette.size())
+    {
+        uint32_t padded = (size + 3) / 4 * 4;
+        // Padding entries are far enough away they are never picked.
+        rg.assign(padded * 2, 0x3FFF);
+        b0.assign(padded * 2, 0);
+        for (uint32_t i = 0; i < size; i++)
+        {
+            rg[i * 2] = Channel(palette[i], 0);
+            rg[i * 2 + 1] = Channel(palette[i], 1);
+            b0[i * 2] = Channel(palette[i], 2);
+        }
+    }
+
+    uint32_t Nearest(uint32_t color, uint32_t& distance) const;
+
+private:
+    uint32_t NearestScalar(uint32_t color, uint32_t& distance) const;
+#ifdef QUANTIZER_SSE2
+    uint32_t NearestSSE2(uint32_t color, uint32_t& distance) const;
+#endif
+
+    uint32_t size;
+    std::vector<int16_t> rg;
+    std::vector<int16_t> b0;
+};
+
+#ifdef QUANTIZER_SSE2
+bool HasSSE2()
+{
+    static const bool supported = __builtin_cpu_supports("sse2");
+    return supported;
+}
+
+__attribute__((target("sse2")))
+uint32_t PaletteLanes::NearestSSE2(uint32_t color, uint32_t& distance) const
+{
+    const __m128i query_rg = _mm_set1_epi32(Channel(color, 0) | (Channel(color, 1) << 16));
+    const __m128i query_b = _mm_set1_epi32(Channel(color, 2));
+    __m128i best = _mm_set1_epi32(0x7FFFFFFF);
+    __m128i best_index = _mm_setzero_si128();
+    __m128i index = _mm_setr_epi32(0, 1, 2, 3);
+    const __m128i four = _mm_set1_epi32(4);
+
+    for (uint32_t i = 0; i < rg.size(); i += 8)
+    {
+        __m128i drg = _mm_sub_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(&rg[i])), query_rg);
+        __m128i db = _mm_sub_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(&b0[i])), query_b);
+        __m128i dist = _mm_add_epi32(_mm_madd_epi16(drg, drg), _mm_madd_epi16(db, db));
+
+        __m128i less = _mm_cmplt_epi32(dist, best);
+        best = _mm_or_si128(_mm_and_si128(less, dist), _mm_andnot_si128(less, best));
+        best_index = _mm_or_si128(_mm_and_si128(less, index), _mm_andnot_si128(less, best_index));
+        index = _mm_add_epi32(index, four);
+    }
+
+    int32_t dists[4], indices[4];
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dists), best);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(indices), best_index);
+    uint32_t lane = 0;
+    for (uint32_t i = 1; i < 4; i++)
+    {
+        if (dists[i] < dists[lane] || (dists[i] == dists[lane] && indices[i] < indices[lane]))
+            lane = i;
+    }
+    distance = dists[lane];
+    return indices[lane];
+}
+#endif
+
+uint32_t PaletteLanes::NearestScalar(uint32_t color, uint32_t& distance) const
+{
+    int32_t r = Channel(color, 0), g = Channel(color, 1), b = Channel(color, 2);
+    uint32_t best = 0;
+    distance = UINT32_MAX;
+    for (uint32_t i = 0; i < size; i++)
+    {
+        int32_t dr = rg[i * 2] - r, dg = rg[i * 2 + 1] - g, db = b0[i * 2] - b;
+        uint32_t dist = dr * dr + dg * dg + db * db;
+        if (dist < distance)
+        {
+            distance = dist;
+            best = i;
+        }
+    }
+    return best;
+}
+
+uint32_t PaletteLanes::Nearest(uint32_t color, uint32_t& distance) const
+{
+#ifdef QUANTIZER_SSE2
+    if (HasSSE2())
+        return NearestSSE2(color, distance);
+#endif
+    return NearestScalar(color, distance);
+}
+
+/** Per tile histogram, the colors are also laid out like PaletteLanes so four of them
+  * can be compared against a palette entry at a time.
+  */
+struct TileColors
+{
+    std::vector<ColorCount> colors;
+    std::vector<int16_t> rg;
+    std::vector<int16_t> b0;
+    uint64_t pixels;
+
+    void Finish()
+    {
+        uint32_t padded = (colors.size() + 3) / 4 * 4;
+        rg.assign(padded * 2, 0);
+        b0.assign(padded * 2, 0);
+        pixels = 0;
+        for (uint32_t i = 0; i < colors.size(); i++)
+        {
+            rg[i * 2] = Channel(colors[i].color, 0);
+            rg[i * 2 + 1] = Channel(colors[i].color, 1);
+            b0[i * 2] = Channel(colors[i].color, 2);
+            pixels += colors[i].count;
+        }
+    }
+};
+
+/** Sum of the squared distances of the tile's pixels to their closest palette color.
+  * Stops early once the error reaches limit since the caller only wants the best palette.
+  */
+uint64_t ErrorScalar(const TileColors& tile, const std::vector<uint32_t>& palette, uint64_t limit)
+{
+    uint64_t error = 0;
+    for (uint32_t i = 0; i < tile.colors.size() && error < limit; i++)
+    {
+        int32_t r = tile.rg[i * 2], g = tile.rg[i * 2 + 1], b = tile.b0[i * 2];
+        uint32_t best = UINT32_MAX;
+        for (uint32_t color : palette)
+        {
+            int32_t dr = Channel(color, 0) - r, dg = Channel(color, 1) - g, db = Channel(color, 2) - b;
+            best = std::min<uint32_t>(best, dr * dr + dg * dg + db * db);
+        }
+        error += static_cast<uint64_t>(best) * tile.colors[i].count;
+    }
+    return error;
+}
+
+#ifdef QUANTIZER_SSE2
+__attribute__((target("sse2")))
+uint64_t ErrorSSE2(const TileColors& tile, const std::vector<uint32_t>& palette, uint64_t limit)
+{
+    uint64_t error = 0;
+    int32_t distances[4];
+    for (uint32_t i = 0; i < tile.colors.size() && error < limit; i += 4)
+    {
+        const __m128i colors_rg = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&tile.rg[i * 2]));
+        const __m128i colors_b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&tile.b0[i * 2]));
+        __m128i best = _mm_set1_epi32(0x7FFFFFFF);
+        for (uint32_t color : palette)
+        {
+            __m128i drg = _mm_sub_epi16(colors_rg, _mm_set1_epi32(Channel(color, 0) | (Channel(color, 1) << 16)));
+            __m128i db = _mm_sub_epi16(colors_b, _mm_set1_epi32(Channel(color, 2)));
+            __m128i dist = _mm_add_epi32(_mm_madd_epi16(drg, drg), _mm_madd_epi16(db, db));
+            __m128i less = _mm_cmplt_epi32(dist, best);
+            best = _mm_or_si128(_mm_and_si128(less, dist), _mm_andnot_si128(less, best));
+        }
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(distances), best);
+        for (uint32_t j = 0; j < 4 && i + j < tile.colors.size(); j++)
+            error += static_cast<uint64_t>(distances[j]) * tile.colors[i + j].count;
+    }
+    return error;
+}
+#endif
+
+uint64_t Error(const TileColors& tile, const std::vector<uint32_t>& palette, uint64_t limit = UINT64_MAX)
+{
+#ifdef QUANTIZER_SSE2
+    if (HasSSE2())
+        return ErrorSSE2(tile, palette, limit);
+#endif
+    return ErrorScalar(tile, palette, limit);
+}
+
+ColorCount Average(std::vector<ColorCount>::const_iterator begin, std::vector<ColorCount>::const_iterator end)
+{
+    uint64_t sum[3] = {0, 0, 0};
+    uint64_t total = 0;
+    for (auto it = begin; it != end; ++it)
+    {
+        for (uint32_t axis = 0; axis < 3; axis++)
+            sum[axis] += static_cast<uint64_t>(Channel(it->color, axis)) * it->count;
+        total += it->count;
+    }
+    if (total == 0)
+        return {begin->color, 0};
+
+    uint32_t color = 0;
+    for (uint32_t axis = 0; axis < 3; axis++)
+        color |= ((sum[axis] + total / 2) / total) << (16 - axis * 8);
+    return {color, static_cast<uint32_t>(std::min<uint64_t>(total, UINT32_MAX))};
+}
+
+}
+
+std::vector<uint32_t> MedianCut(std::vector<ColorCount> colors, uint32_t max_colors)
+{
+    std::vector<uint32_t> palette;
+    if (colors.size() <= max_colors)
+    {
+        for (const auto& color : colors)
+            if (std::find(palette.begin(), palette.end(), color.color) == palette.end())
+                palette.push_back(color.color);
+        return palette;
+    }
+    if (max_colors == 0)
+        return palette;
+
+    // Boxes are ranges of the colors vector.
+    struct Box
+    {
+        uint32_t begin, end;
+        uint32_t axis;
+        uint32_t range;
+    };
+    auto measure = [&colors](Box& box)
+    {
+        uint32_t low[3] = {255, 255, 255}, high[3] = {0, 0, 0};
+        for (uint32_t i = box.begin; i < box.end; i++)
+        {
+            for (uint32_t axis = 0; axis < 3; axis++)
+            {
+                low[axis] = std::min(low[axis], Channel(colors[i].color, axis));
+                high[axis] = std::max(high[axis], Channel(colors[i].color, axis));
+            }
+        }
+        box.axis = 0;
+        for (uint32_t axis = 1; axis < 3; axis++)
+            if (high[axis] - low[axis] > high[box.axis] - low[box.axis])
+                box.axis = axis;
+        box.range = high[box.axis] - low[box.axis];
+    };
+
+    std::vector<Box> boxes(1, Box{0, static_cast<uint32_t>(colors.size()), 0, 0});
+    measure(boxes[0]);
+    while (boxes.size() < max_colors)
+    {
+        auto widest = std::max_element(boxes.begin(), boxes.end(), [](const Box& a, const Box& b) { return a.range < b.range; });
+        if (widest->range == 0)
+            break;
+
+        Box box = *widest;
+        auto begin = colors.begin() + box.begin, end = colors.begin() + box.end;
+        uint32_t axis = box.axis;
+
+        // Channels are 8 bits so the weighted median is found with a histogram instead of sorting the box.
+        uint64_t histogram[256] = {0};
+        uint64_t total = 0;
+        for (auto it = begin; it != end; ++it)
+        {
+            histogram[Channel(it->color, axis)] += it->count;
+            total += it->count;
+        }
+
+        // Split at the weighted median keeping at least one color on each side.
+        uint32_t first = 0, last = 255;
+        while (!histogram[first])
+            first++;
+        while (!histogram[last])
+            last--;
+        uint64_t seen = 0;
+        uint32_t median = first;
+        for (uint32_t value = first; value < last; value++)
+        {
+            seen += histogram[value];
+            if (histogram[value])
+                median = value;
+            if (seen * 2 >= total)
+                break;
+        }
+
+        uint32_t split = std::partition(begin, end, [axis, median](const ColorCount& c) { return Channel(c.color, axis) <= median; }) - colors.begin();
+
+        Box low{box.begin, split, 0, 0}, high{split, box.end, 0, 0};
+        measure(low);
+        measure(high);
+        *widest = low;
+        boxes.push_back(high);
+    }
+
+    for (const auto& box : boxes)
+        palette.push_back(Average(colors.begin() + box.begin, colors.begin() + box.end).color);
+    return palette;
+}
+
+uint32_t NearestColor(const std::vector<uint32_t>& palette, uint32_t color, uint32_t* distance)
+{
+    uint32_t dist;
+    uint32_t index = PaletteLanes(palette).Nearest(color, dist);
+    if (distance)
+        *distance = dist;
+    return index;
+}
+
+TilePalettes QuantizeTiles(uint8_t* rgba, uint32_t width, uint32_t height, uint32_t tile_width, uint32_t tile_height,
+                           uint32_t num_palettes, uint32_t palette_size)
+{
+    TilePalettes result;
+    if (width == 0 || height == 0 || tile_width == 0 || tile_height == 0 || num_palettes == 0)
+        return result;
+
+    const uint32_t columns = (width + tile_width - 1) / tile_width;
+    const uint32_t rows = (height + tile_height - 1) / tile_height;
+    auto for_each_pixel = [&](uint32_t tile, const std::function<void(uint8_t*)>& f)
+    {
+        uint32_t left = (tile % columns) * tile_width, top = (tile / columns) * tile_height;
+        for (uint32_t y = top; y < std::min(top + tile_height, height); y++)
+            for (uint32_t x = left; x < std::min(left + tile_width, width); x++)
+                if (rgba[(y * width + x) * 4 + 3] >= 128)
+                    f(&rgba[(y * width + x) * 4]);
+    };
+
+    std::vector<TileColors> tiles(columns * rows);
+    std::vector<ColorCount> means;
+    std::unordered_map<uint32_t, uint32_t> counts;
+    for (uint32_t i = 0; i < tiles.size(); i++)
+    {
+        counts.clear();
+        for_each_pixel(i, [&counts](uint8_t* pixel) { counts[(pixel[0] << 16) | (pixel[1] << 8) | pixel[2]]++; });
+        for (const auto& count : counts)
+            tiles[i].colors.push_back({count.first, count.second});
+        std::sort(tiles[i].colors.begin(), tiles[i].colors.end(), [](const ColorCount& a, const ColorCount& b) { return a.color < b.color; });
+        tiles[i].Finish();
+        if (tiles[i].pixels)
+            means.push_back(Average(tiles[i].colors.begin(), tiles[i].colors.end()));
+    }
+
+    // Start by grouping tiles with similar average colors.
+    std::vector<uint32_t> centers = MedianCut(means, num_palettes);
+    if (centers.empty())
+        centers.push_back(0);
+    PaletteLanes center_lanes(centers);
+    result.tile_palettes.resize(tiles.size());
+    uint32_t distance;
+    for (uint32_t i = 0; i < tiles.size(); i++)
+        result.tile_palettes[i] = tiles[i].pixels ? center_lanes.Nearest(Average(tiles[i].colors.begin(), tiles[i].colors.end()).color, distance) : 0;
+
+    const uint32_t MAX_ITERATIONS = 8;
+    std::vector<PaletteLanes> lanes;
+    for (uint32_t iteration = 0; iteration < MAX_ITERATIONS; iteration++)
+    {
+        // Colors shared by tiles are repeated rather than merged, median cut does not mind.
+        std::vector<std::vector<ColorCount>> histograms(centers.size());
+        for (uint32_t i = 0; i < tiles.size(); i++)
+        {
+            auto& histogram = histograms[result.tile_palettes[i]];
+            histogram.insert(histogram.end(), tiles[i].colors.begin(), tiles[i].colors.end());
+        }
+
+        result.palettes.resize(centers.size());
+        lanes.clear();
+        for (uint32_t i = 0; i < centers.size(); i++)
+        {
+            result.palettes[i] = MedianCut(std::move(histograms[i]), palette_size);
+            lanes.emplace_back(result.palettes[i]);
+        }
+
+        if (centers.size() == 1)
+            break;
+
+        bool changed = false;
+        for (uint32_t i = 0; i < tiles.size(); i++)
+        {
+            if (tiles[i].pixels == 0)
+                continue;
+            uint32_t best = result.tile_palettes[i];
+            uint64_t best_error = Error(tiles[i], result.palettes[best]);
+            for (uint32_t j = 0; j < centers.size() && best_error; j++)
+            {
+                if (j == best || result.palettes[j].empty())
+                    continue;
+                uint64_t error = Error(tiles[i], result.palettes[j], best_error);
+                if (error < best_error)
+                {
+                    best = j;
+                    best_error = error;
+                }
+            }
+            changed = changed || best != result.tile_palettes[i];
+            result.tile_palettes[i] = best;
+        }
+        if (!changed)
+            break;
+    }
+
+    // Tiles may have moved after the palettes were last built but each still has a palette at least as good.
+    for (uint32_t i = 0; i < tiles.size(); i++)
+    {
+        const PaletteLanes& palette = lanes[result.tile_palettes[i]];
+        const std::vector<uint32_t>& colors = result.palettes[result.tile_palettes[i]];
+        for_each_pixel(i, [&](uint8_t* pixel)
+        {
+            uint32_t color = colors[palette.Nearest((pixel[0] << 16) | (pixel[1] << 8) | pixel[2], distance)];
+            pixel[0] = color >> 16;
+            pixel[1] = (color >> 8) & 0xFF;
+            pixel[2] = color & 0xFF;
+        });
+    }
+
+    return result;
+}
+
+std::vector<uint32_t> QuantizeImage(uint8_t* rgba, uint32_t width, uint32_t height, uint32_t max_colors)
+{
+    TilePalettes result = QuantizeTiles(rgba, width, height, width, height, 1, max_colors);
+    return result.palettes.empty() ? std::vector<uint32_t>() : result.palettes[0];
+}
@@ -0,0 +1,87 @@
+/******************************************************************************************************
+ * Tile Map Editor
+ * Copyright (C) 2009-2017 Brandon Whitehead (tricksterguy87[AT]gmail[DOT]com)
+ *
+ * This software is provided 'as-is', without any express or implied warranty.
+ * In no event will the authors be held liable for any damages arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * excluding commercial applications, and to alter it and redistribute it freely,
+ * subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented;
+ *    you must not claim that you wrote the original software.
+ *    An acknowledgement in your documentation and link to the original version is required.
+ *
+ * 2. Altered source versions must be plainly marked as such,
+ *    and must not be misrepresented as being the original software.
+ *
+ * 3. This notice may not be removed or altered from any source distribution.
+ ******************************************************************************************************/
+#ifndef QUANTIZER_HPP
+#define QUANTIZER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/** Colors in this file are packed as 0xRRGGBB. */
+
+/** A color and how many pixels use it */
+struct ColorCount
+{
+    uint32_t color;
+    uint32_t count;
+};
+
+/** Palettes built by QuantizeTiles */
+struct TilePalettes
+{
+    /** Each palette has at most palette_size colors */
+    std::vector<std::vector<uint32_t>> palettes;
+    /** Palette each tile uses, tiles are numbered left to right then top to bottom */
+    std::vector<uint32_t> tile_palettes;
+};
+
+/** Reduces a set of colors using median cut.
+  * Boxes of colors are split at the weighted median of their longest axis until there are max_colors boxes,
+  * each box then becomes the weighted average of its colors.
+  * If there are already at most max_colors colors they are returned unchanged.
+  * @param colors Colors to reduce with their pixel counts, a color may appear more than once.
+  * @param max_colors Maximum size of the palette.
+  * @return The palette.
+  */
+std::vector<uint32_t> MedianCut(std::vector<ColorCount> colors, uint32_t max_colors);
+
+/** Finds the color in a palette closest to a color (squared RGB distance).
+  * On x86 processors supporting SSE2 four palette entries are compared at a time.
+  * @param palette Palette to search, must not be empty.
+  * @param color Color to look up.
+  * @param distance If not NULL stores the squared distance to the closest color.
+  * @return Index of the closest color.
+  */
+uint32_t NearestColor(const std::vector<uint32_t>& palette, uint32_t color, uint32_t* distance = NULL);
+
+/** Builds a set of shared palettes for an image made of tiles (such as a tileset) and remaps it to them.
+  * Tiles are grouped by color and each group gets a median cut palette, tiles are then moved to the
+  * palette that represents them best and the palettes rebuilt until the groups settle.
+  * Transparent pixels (alpha below 128) are ignored and left as is.
+  * @param rgba Pixels as 4 bytes (red, green, blue, alpha) each, opaque pixels are replaced with the closest
+  *             color in their tile's palette.
+  * @param width Width of the image in pixels.
+  * @param height Height of the image in pixels.
+  * @param tile_width Width of a tile, tiles on the right and bottom edges may be partial.
+  * @param tile_height Height of a tile.
+  * @param num_palettes Maximum number of palettes (16 for the GBA).
+  * @param palette_size Maximum colors in a palette (15 for the GBA, index 0 is transparent).
+  * @return The palettes and which one each tile uses.
+  */
+TilePalettes QuantizeTiles(uint8_t* rgba, uint32_t width, uint32_t height, uint32_t tile_width, uint32_t tile_height,
+                           uint32_t num_palettes, uint32_t palette_size);
+
+/** Reduces an image to a single palette and remaps it, @see QuantizeTiles.
+  * @return The palette.
+  */
+std::vector<uint32_t> QuantizeImage(uint8_t* rgba, uint32_t width, uint32_t height, uint32_t max_colors);
+
+#endif